@@ -0,0 +1,176 @@
+#include "Benchmark.h"
+#include "LeviathanString.h"
+
+namespace LeviathanBenchmarks
+{
+	static const void* volatile gConsumeSink = nullptr;
+
+	// Returns the median of the values. Reorders the values.
+	static double Median(std::vector<double>& values)
+	{
+		if (values.empty())
+		{
+			return 0.0;
+		}
+
+		const size_t middle = values.size() / 2;
+		std::nth_element(values.begin(), values.begin() + middle, values.end());
+		const double upper = values[middle];
+		if ((values.size() % 2) != 0)
+		{
+			return upper;
+		}
+
+		const double lower = *std::max_element(values.begin(), values.begin() + middle);
+		return 0.5 * (lower + upper);
+	}
+
+	// Escapes the string for use as a JSON string value.
+	static std::string EscapeJson(std::string_view string)
+	{
+		std::string escaped = {};
+		escaped.reserve(string.size());
+		for (const char character : string)
+		{
+			switch (character)
+			{
+			case '"':
+				escaped += "\\\"";
+				break;
+			case '\\':
+				escaped += "\\\\";
+				break;
+			case '\n':
+				escaped += "\\n";
+				break;
+			default:
+				escaped += character;
+				break;
+			}
+		}
+		return escaped;
+	}
+
+	uint64_t ReadCycleCounter()
+	{
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+		return static_cast<uint64_t>(__rdtsc());
+#else
+		return 0;
+#endif
+	}
+
+	void Consume(const void* data)
+	{
+		gConsumeSink = data;
+	}
+
+	Harness::Harness(const BenchmarkSettings& settings)
+		: Settings(settings)
+	{
+		if (Settings.Repetitions == 0)
+		{
+			Settings.Repetitions = 1;
+		}
+	}
+
+	bool Harness::IsEnabled(std::string_view name) const
+	{
+		return (Settings.Filter.empty() || (name.find(Settings.Filter) != std::string_view::npos));
+	}
+
+	void Harness::AddMetric(std::string_view benchmarkName, std::string_view metricName, const double value)
+	{
+		for (auto it = Results.rbegin(); it != Results.rend(); ++it)
+		{
+			if (it->Name == benchmarkName)
+			{
+				it->Metrics.emplace_back(BenchmarkMetric{ std::string(metricName), value });
+				return;
+			}
+		}
+	}
+
+	void Harness::PrintSummary() const
+	{
+		std::cout << LeviathanCore::String::Printf("%-48s %14s %14s %12s %12s %12s", "Benchmark", "Min (ns)", "Median (ns)", "StdDev (%)", "ns/op", "cycles/op").c_str() << '\n';
+		for (const BenchmarkResult& result : Results)
+		{
+			const double stdDevPercent = (result.MeanNanoseconds > 0.0) ? (100.0 * result.StdDevNanoseconds / result.MeanNanoseconds) : 0.0;
+			std::cout << LeviathanCore::String::Printf("%-48s %14.0f %14.0f %12.2f %12.3f %12.3f", result.Name.c_str(), result.MinNanoseconds, result.MedianNanoseconds,
+				stdDevPercent, result.NanosecondsPerOperation, result.CyclesPerOperation).c_str() << '\n';
+
+			for (const BenchmarkMetric& metric : result.Metrics)
+			{
+				std::cout << LeviathanCore::String::Printf("    %-44s %g", metric.Name.c_str(), metric.Value).c_str() << '\n';
+			}
+		}
+	}
+
+	bool Harness::WriteJson(std::string_view file) const
+	{
+		std::ofstream ofStream(std::string(file), std::ios::out);
+		if (!ofStream)
+		{
+			return false;
+		}
+
+		ofStream << "{\n";
+		ofStream << LeviathanCore::String::Printf("  \"warmupRepetitions\": %zu,\n  \"repetitions\": %zu,\n", Settings.WarmupRepetitions, Settings.Repetitions).c_str();
+		ofStream << "  \"benchmarks\": [\n";
+
+		for (size_t i = 0; i < Results.size(); ++i)
+		{
+			const BenchmarkResult& result = Results[i];
+			ofStream << "    {\n";
+			ofStream << "      \"name\": \"" << EscapeJson(result.Name) << "\",\n";
+			ofStream << LeviathanCore::String::Printf("      \"operationsPerRepetition\": %zu,\n", result.OperationsPerRepetition).c_str();
+			ofStream << LeviathanCore::String::Printf("      \"repetitions\": %zu,\n", result.Repetitions).c_str();
+			ofStream << LeviathanCore::String::Printf("      \"minNs\": %.3f,\n", result.MinNanoseconds).c_str();
+			ofStream << LeviathanCore::String::Printf("      \"medianNs\": %.3f,\n", result.MedianNanoseconds).c_str();
+			ofStream << LeviathanCore::String::Printf("      \"meanNs\": %.3f,\n", result.MeanNanoseconds).c_str();
+			ofStream << LeviathanCore::String::Printf("      \"stdDevNs\": %.3f,\n", result.StdDevNanoseconds).c_str();
+			ofStream << LeviathanCore::String::Printf("      \"nsPerOp\": %.6f,\n", result.NanosecondsPerOperation).c_str();
+			ofStream << LeviathanCore::String::Printf("      \"cyclesPerOp\": %.6f,\n", result.CyclesPerOperation).c_str();
+			ofStream << "      \"metrics\": {";
+
+			for (size_t j = 0; j < result.Metrics.size(); ++j)
+			{
+				ofStream << ((j == 0) ? " " : ", ") << "\"" << EscapeJson(result.Metrics[j].Name) << "\": " << LeviathanCore::String::Printf("%.9g", result.Metrics[j].Value).c_str();
+			}
+
+			ofStream << ((result.Metrics.empty()) ? "}\n" : " }\n");
+			ofStream << ((i + 1 < Results.size()) ? "    },\n" : "    }\n");
+		}
+
+		ofStream << "  ]\n}\n";
+
+		return ofStream.good();
+	}
+
+	BenchmarkResult& Harness::AddResult(std::string_view name, const size_t operationsPerRepetition, std::vector<double>& nanoseconds, std::vector<double>& cycles)
+	{
+		BenchmarkResult& result = Results.emplace_back();
+		result.Name = name;
+		result.OperationsPerRepetition = operationsPerRepetition;
+		result.Repetitions = nanoseconds.size();
+
+		const double count = static_cast<double>(nanoseconds.size());
+		result.MinNanoseconds = *std::min_element(nanoseconds.begin(), nanoseconds.end());
+		result.MeanNanoseconds = std::accumulate(nanoseconds.begin(), nanoseconds.end(), 0.0) / count;
+
+		double sumSquaredDeviation = 0.0;
+		for (const double sample : nanoseconds)
+		{
+			sumSquaredDeviation += (sample - result.MeanNanoseconds) * (sample - result.MeanNanoseconds);
+		}
+		result.StdDevNanoseconds = (nanoseconds.size() > 1) ? std::sqrt(sumSquaredDeviation / (count - 1.0)) : 0.0;
+
+		result.MedianNanoseconds = Median(nanoseconds);
+		const double operations = static_cast<double>((operationsPerRepetition > 0) ? operationsPerRepetition : 1);
+		result.NanosecondsPerOperation = result.MedianNanoseconds / operations;
+		result.CyclesPerOperation = Median(cycles) / operations;
+
+		return result;
+	}
+}
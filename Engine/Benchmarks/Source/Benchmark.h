@@ -0,0 +1,104 @@
+#pragma once
+
+namespace LeviathanBenchmarks
+{
+	struct BenchmarkSettings
+	{
+		// Number of untimed repetitions run before measuring to warm caches and branch predictors.
+		size_t WarmupRepetitions = 2;
+		// Number of timed repetitions statistics are computed from.
+		size_t Repetitions = 15;
+		// Only benchmarks whose name contains the filter are run. An empty filter runs every benchmark.
+		std::string Filter = {};
+	};
+
+	// A named value attached to a benchmark result such as a max error or an element count.
+	struct BenchmarkMetric
+	{
+		std::string Name = {};
+		double Value = 0.0;
+	};
+
+	struct BenchmarkResult
+	{
+		std::string Name = {};
+		size_t OperationsPerRepetition = 0;
+		size_t Repetitions = 0;
+		double MinNanoseconds = 0.0;
+		double MedianNanoseconds = 0.0;
+		double MeanNanoseconds = 0.0;
+		double StdDevNanoseconds = 0.0;
+		// Derived from the median repetition.
+		double NanosecondsPerOperation = 0.0;
+		// Time stamp counter cycles per operation derived from the median repetition. 0 when no cycle counter is available.
+		double CyclesPerOperation = 0.0;
+		std::vector<BenchmarkMetric> Metrics = {};
+	};
+
+	// Returns the value of the processor time stamp counter or 0 if the platform does not expose one.
+	uint64_t ReadCycleCounter();
+
+	// Forces the compiler to assume the memory pointed to is read so that the computation producing it is not optimized away.
+	void Consume(const void* data);
+
+	class Harness
+	{
+	private:
+		BenchmarkSettings Settings = {};
+		std::vector<BenchmarkResult> Results = {};
+
+	public:
+		Harness(const BenchmarkSettings& settings);
+
+		// Returns true if the benchmark name passes the settings filter.
+		bool IsEnabled(std::string_view name) const;
+
+		// Times the function over the configured repetitions. The function must perform operationsPerRepetition operations each call.
+		// Returns the recorded result or nullptr if the benchmark was filtered out.
+		template <typename Function>
+		BenchmarkResult* Run(std::string_view name, const size_t operationsPerRepetition, Function&& function)
+		{
+			if (!IsEnabled(name))
+			{
+				return nullptr;
+			}
+
+			for (size_t i = 0; i < Settings.WarmupRepetitions; ++i)
+			{
+				function();
+			}
+
+			std::vector<double> nanoseconds(Settings.Repetitions, 0.0);
+			std::vector<double> cycles(Settings.Repetitions, 0.0);
+			for (size_t i = 0; i < Settings.Repetitions; ++i)
+			{
+				const auto startTime = std::chrono::steady_clock::now();
+				const uint64_t startCycles = ReadCycleCounter();
+
+				function();
+
+				const uint64_t endCycles = ReadCycleCounter();
+				const auto endTime = std::chrono::steady_clock::now();
+
+				nanoseconds[i] = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count());
+				cycles[i] = static_cast<double>(endCycles - startCycles);
+			}
+
+			return &AddResult(name, operationsPerRepetition, nanoseconds, cycles);
+		}
+
+		// Attaches a metric to the most recent result with the benchmark name. Does nothing if the benchmark was filtered out.
+		void AddMetric(std::string_view benchmarkName, std::string_view metricName, const double value);
+
+		// Prints a human readable table of every result to standard output.
+		void PrintSummary() const;
+
+		// Writes every result as JSON to the file. Returns true if successful otherwise, false.
+		bool WriteJson(std::string_view file) const;
+
+		inline const std::vector<BenchmarkResult>& GetResults() const { return Results; }
+
+	private:
+		BenchmarkResult& AddResult(std::string_view name, const size_t operationsPerRepetition, std::vector<double>& nanoseconds, std::vector<double>& cycles);
+	};
+}
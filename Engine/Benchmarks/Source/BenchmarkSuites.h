@@ -0,0 +1,87 @@
+#pragma once
+
+namespace LeviathanBenchmarks
+{
+	class Harness;
+
+	// MathTypes, MathLibrary and FastMath throughput, with FastMath timed next to libm.
+	void RunMathBenchmarks(Harness& harness);
+
+	// SparseArray, Serialize and Callback.
+	void RunCoreBenchmarks(Harness& harness);
+
+	// Scalar and batched bounding volume intersection tests.
+	void RunBoundingVolumeBenchmarks(Harness& harness);
+
+	// Renderer frustum culling stage on the calling thread and on the job system.
+	void RunVisibilityBenchmarks(Harness& harness);
+
+	// DynamicAABBTree updates and queries over moving objects compared against brute force tests.
+	void RunSpatialBenchmarks(Harness& harness);
+
+	// TransformHierarchy world matrix updates over 1M nodes with 10% dirty on the calling thread and on the job system.
+	void RunHierarchyBenchmarks(Harness& harness);
+
+	// TriangleBVH build time and single ray and packet query throughput on a 1M triangle mesh.
+	void RunRayTracingBenchmarks(Harness& harness);
+
+	// Render command recording, sorting and execution for 100k draws on the calling thread and on the job system, and redundant state filtering of a
+	// lighting frame and a random command stream.
+	void RunRenderCommandBenchmarks(Harness& harness);
+
+	// Render world creation, incremental transform updates and id stable destruction of 100k renderables, and draw list building on the calling thread
+	// and on the job system.
+	void RunRenderWorldBenchmarks(Harness& harness);
+
+	// Instance batch building for 50k copies of one mesh and for mixed meshes and materials, and CPU submission cost of 50k copies drawn one object at a
+	// time compared against instanced draws, on the calling thread and on the job system.
+	void RunInstanceBatchingBenchmarks(Harness& harness);
+
+	// Upload ring allocation over simulated frames with a lagging gpu.
+	void RunUploadRingBenchmarks(Harness& harness);
+
+	// Clustered light assignment of 10k point and spot lights on the calling thread and on the job system, timed next to testing every light against
+	// every cluster.
+	void RunClusteredLightingBenchmarks(Harness& harness);
+
+	// Point and spot light influence culling of 20k visible objects against 320 lights on the calling thread and on the job system, with the lighting
+	// draws skipped.
+	void RunLightInfluenceBenchmarks(Harness& harness);
+
+	// Software occlusion culling of 20k objects behind wall occluders: occluder rasterization, object tests and draw list building with and without
+	// occlusion on the calling thread and on the job system.
+	void RunOcclusionCullingBenchmarks(Harness& harness);
+
+	// Quadric simplification of a 261k triangle sphere with a texture seam to a quarter of its triangles and into a chain of levels of detail, and
+	// level of detail selection for 20k copies by projected error.
+	void RunMeshSimplificationBenchmarks(Harness& harness);
+
+	// Meshlet building for a 4.2M triangle torus, and cluster frustum and back face culling with index buffer compaction on the calling thread and on
+	// the job system.
+	void RunMeshletBenchmarks(Harness& harness);
+
+	// Render graph compilation of a 100 pass deferred frame with culled debug passes.
+	void RunRenderGraphBenchmarks(Harness& harness);
+
+	// Shader cache lookups and source tree hashing for 256 shaders sharing headers through relative includes.
+	void RunShaderCacheBenchmarks(Harness& harness);
+
+	// Shader permutation lookups for a 4096 draw frame over a 5 bit feature key.
+	void RunShaderPermutationBenchmarks(Harness& harness);
+
+	// Upload queue creation of 2048 mixed buffers and textures requested from every job thread under a 1 MiB frame budget.
+	void RunUploadQueueBenchmarks(Harness& harness);
+
+	// Texture streaming of 1024 textures for a camera flying past 4096 objects under a 128 MiB pool, and mip chain building of a streamable texture.
+	void RunTextureStreamingBenchmarks(Harness& harness);
+
+	// Gpu memory tracking of 8192 buffers, textures and cubemaps churned and used frame by frame under total and texture budgets.
+	void RunGpuMemoryBenchmarks(Harness& harness);
+
+	// Equirectangular to cubemap conversion of a 4k HDR environment on 1 to every hardware thread, cubemap file loading and float to half conversion.
+	void RunEnvironmentCubemapBenchmarks(Harness& harness);
+
+	// Image based lighting bakes of a 256 texel environment on 1 to every hardware thread with the time of each stage, BRDF lookup table integration
+	// and baked file loading.
+	void RunImageBasedLightingBenchmarks(Harness& harness);
+}
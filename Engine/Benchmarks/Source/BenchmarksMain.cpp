@@ -0,0 +1,77 @@
+#include "Benchmark.h"
+#include "BenchmarkSuites.h"
+#include "Logging.h"
+
+// Usage: LeviathanBenchmarks [--filter <substring>] [--repetitions <count>] [--warmup <count>] [--json <file>]
+int main(int argc, char* argv[])
+{
+	LeviathanBenchmarks::BenchmarkSettings settings = {};
+	std::string jsonFile = {};
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string_view argument = argv[i];
+		const bool hasValue = (i + 1 < argc);
+
+		if ((argument == "--filter") && hasValue)
+		{
+			settings.Filter = argv[++i];
+		}
+		else if ((argument == "--repetitions") && hasValue)
+		{
+			settings.Repetitions = static_cast<size_t>(std::strtoull(argv[++i], nullptr, 10));
+		}
+		else if ((argument == "--warmup") && hasValue)
+		{
+			settings.WarmupRepetitions = static_cast<size_t>(std::strtoull(argv[++i], nullptr, 10));
+		}
+		else if ((argument == "--json") && hasValue)
+		{
+			jsonFile = argv[++i];
+		}
+		else
+		{
+			LEVIATHAN_LOG("Unknown argument %s. Usage: LeviathanBenchmarks [--filter <substring>] [--repetitions <count>] [--warmup <count>] [--json <file>]", argv[i]);
+			return 1;
+		}
+	}
+
+	LeviathanBenchmarks::Harness harness(settings);
+	LeviathanBenchmarks::RunMathBenchmarks(harness);
+	LeviathanBenchmarks::RunCoreBenchmarks(harness);
+	LeviathanBenchmarks::RunBoundingVolumeBenchmarks(harness);
+	LeviathanBenchmarks::RunVisibilityBenchmarks(harness);
+	LeviathanBenchmarks::RunSpatialBenchmarks(harness);
+	LeviathanBenchmarks::RunHierarchyBenchmarks(harness);
+	LeviathanBenchmarks::RunRayTracingBenchmarks(harness);
+	LeviathanBenchmarks::RunRenderCommandBenchmarks(harness);
+	LeviathanBenchmarks::RunRenderWorldBenchmarks(harness);
+	LeviathanBenchmarks::RunInstanceBatchingBenchmarks(harness);
+	LeviathanBenchmarks::RunUploadRingBenchmarks(harness);
+	LeviathanBenchmarks::RunClusteredLightingBenchmarks(harness);
+	LeviathanBenchmarks::RunLightInfluenceBenchmarks(harness);
+	LeviathanBenchmarks::RunOcclusionCullingBenchmarks(harness);
+	LeviathanBenchmarks::RunMeshSimplificationBenchmarks(harness);
+	LeviathanBenchmarks::RunMeshletBenchmarks(harness);
+	LeviathanBenchmarks::RunRenderGraphBenchmarks(harness);
+	LeviathanBenchmarks::RunShaderCacheBenchmarks(harness);
+	LeviathanBenchmarks::RunShaderPermutationBenchmarks(harness);
+	LeviathanBenchmarks::RunUploadQueueBenchmarks(harness);
+	LeviathanBenchmarks::RunTextureStreamingBenchmarks(harness);
+	LeviathanBenchmarks::RunGpuMemoryBenchmarks(harness);
+	LeviathanBenchmarks::RunEnvironmentCubemapBenchmarks(harness);
+	LeviathanBenchmarks::RunImageBasedLightingBenchmarks(harness);
+
+	harness.PrintSummary();
+
+	if (!jsonFile.empty())
+	{
+		if (!harness.WriteJson(jsonFile))
+		{
+			LEVIATHAN_LOG("Failed to write benchmark results to %s.", jsonFile.c_str());
+			return 1;
+		}
+	}
+
+	return 0;
+}
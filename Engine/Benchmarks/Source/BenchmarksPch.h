@@ -0,0 +1,40 @@
+#pragma once
+
+// Standard library.
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <type_traits>
+#include <cassert>
+#include <chrono>
+#include <array>
+#include <fstream>
+#include <filesystem>
+#include <cmath>
+#include <bit>
+#include <cstdarg>
+#include <cstring>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Cycle counter intrinsics.
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// GLM.
+#include "GLM_1.0.1/glm.hpp"
+#include "GLM_1.0.1/gtc/matrix_transform.hpp"
+#include "GLM_1.0.1/gtc/quaternion.hpp"
@@ -0,0 +1,177 @@
+#include "BenchmarkSuites.h"
+#include "Benchmark.h"
+#include "TestFixtures.h"
+#include "MathTypes.h"
+#include "MathLibrary.h"
+#include "BoundingVolumes.h"
+
+namespace LeviathanBenchmarks
+{
+	static constexpr size_t BoundingVolumeCount = 100003;
+	static constexpr float SceneHalfSize = 500.0f;
+	static constexpr float FarPlane = 400.0f;
+
+	static double CountPasses(const std::vector<uint8_t>& results)
+	{
+		return static_cast<double>(std::count(results.begin(), results.end(), static_cast<uint8_t>(1)));
+	}
+
+	void RunBoundingVolumeBenchmarks(Harness& harness)
+	{
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> positionDistribution(-SceneHalfSize, SceneHalfSize);
+		std::uniform_real_distribution<float> sizeDistribution(0.1f, 8.0f);
+
+		LeviathanCore::BoundingVolumes::SphereArray spheres = {};
+		LeviathanCore::BoundingVolumes::AABBArray aabbs = {};
+		for (size_t i = 0; i < BoundingVolumeCount; ++i)
+		{
+			const LeviathanCore::MathTypes::Vector3 center(positionDistribution(random), positionDistribution(random), positionDistribution(random));
+			const LeviathanCore::MathTypes::Vector3 halfExtents(sizeDistribution(random), sizeDistribution(random), sizeDistribution(random));
+			spheres.Add(LeviathanCore::BoundingVolumes::Sphere{ center, halfExtents.Length() });
+			aabbs.Add(LeviathanCore::BoundingVolumes::AABB{ center - halfExtents, center + halfExtents });
+		}
+
+		const LeviathanCore::MathTypes::Matrix4x4 viewProjection = LeviathanTestFixtures::MakeViewProjection(FarPlane);
+		const LeviathanCore::BoundingVolumes::Frustum frustum = LeviathanCore::BoundingVolumes::Frustum::FromViewProjection(viewProjection);
+		const LeviathanCore::BoundingVolumes::SphereSoA sphereView = spheres.View();
+		const LeviathanCore::BoundingVolumes::AABBSoA aabbView = aabbs.View();
+		std::vector<uint8_t> results(BoundingVolumeCount, 0);
+
+		harness.Run("BoundingVolumes.Frustum.FromViewProjection", 1, [&]()
+			{
+				const LeviathanCore::BoundingVolumes::Frustum extracted = LeviathanCore::BoundingVolumes::Frustum::FromViewProjection(viewProjection);
+				Consume(&extracted);
+			});
+
+		harness.Run("BoundingVolumes.FrustumSpheres.Scalar", BoundingVolumeCount, [&]()
+			{
+				for (size_t i = 0; i < BoundingVolumeCount; ++i)
+				{
+					results[i] = frustum.Intersects(spheres.Get(i)) ? 1 : 0;
+				}
+				Consume(results.data());
+			});
+
+		if (harness.Run("BoundingVolumes.FrustumSpheres.Batch", BoundingVolumeCount, [&]()
+			{
+				LeviathanCore::BoundingVolumes::TestFrustumSpheres(frustum, sphereView, 0, BoundingVolumeCount, results.data());
+				Consume(results.data());
+			}))
+		{
+			harness.AddMetric("BoundingVolumes.FrustumSpheres.Batch", "visible", CountPasses(results));
+		}
+
+		harness.Run("BoundingVolumes.FrustumAABBs.Scalar", BoundingVolumeCount, [&]()
+			{
+				for (size_t i = 0; i < BoundingVolumeCount; ++i)
+				{
+					results[i] = frustum.Intersects(aabbs.Get(i)) ? 1 : 0;
+				}
+				Consume(results.data());
+			});
+
+		if (harness.Run("BoundingVolumes.FrustumAABBs.Batch", BoundingVolumeCount, [&]()
+			{
+				LeviathanCore::BoundingVolumes::TestFrustumAABBs(frustum, aabbView, 0, BoundingVolumeCount, results.data());
+				Consume(results.data());
+			}))
+		{
+			harness.AddMetric("BoundingVolumes.FrustumAABBs.Batch", "visible", CountPasses(results));
+		}
+
+		const LeviathanCore::BoundingVolumes::AABB query{ LeviathanCore::MathTypes::Vector3(-100.0f, -100.0f, -100.0f),
+			LeviathanCore::MathTypes::Vector3(100.0f, 100.0f, 100.0f) };
+
+		harness.Run("BoundingVolumes.AABBAABBs.Scalar", BoundingVolumeCount, [&]()
+			{
+				for (size_t i = 0; i < BoundingVolumeCount; ++i)
+				{
+					results[i] = query.Intersects(aabbs.Get(i)) ? 1 : 0;
+				}
+				Consume(results.data());
+			});
+
+		harness.Run("BoundingVolumes.AABBAABBs.Batch", BoundingVolumeCount, [&]()
+			{
+				LeviathanCore::BoundingVolumes::TestAABBAABBs(query, aabbView, 0, BoundingVolumeCount, results.data());
+				Consume(results.data());
+			});
+
+		harness.Run("BoundingVolumes.AABBSpheres.Scalar", BoundingVolumeCount, [&]()
+			{
+				for (size_t i = 0; i < BoundingVolumeCount; ++i)
+				{
+					results[i] = spheres.Get(i).Intersects(query) ? 1 : 0;
+				}
+				Consume(results.data());
+			});
+
+		harness.Run("BoundingVolumes.AABBSpheres.Batch", BoundingVolumeCount, [&]()
+			{
+				LeviathanCore::BoundingVolumes::TestAABBSpheres(query, sphereView, 0, BoundingVolumeCount, results.data());
+				Consume(results.data());
+			});
+
+		const LeviathanCore::BoundingVolumes::Sphere querySphere{ LeviathanCore::MathTypes::Vector3(20.0f, -10.0f, 5.0f), 150.0f };
+
+		harness.Run("BoundingVolumes.SphereAABBs.Scalar", BoundingVolumeCount, [&]()
+			{
+				for (size_t i = 0; i < BoundingVolumeCount; ++i)
+				{
+					results[i] = querySphere.Intersects(aabbs.Get(i)) ? 1 : 0;
+				}
+				Consume(results.data());
+			});
+
+		harness.Run("BoundingVolumes.SphereAABBs.Batch", BoundingVolumeCount, [&]()
+			{
+				LeviathanCore::BoundingVolumes::TestSphereAABBs(querySphere, aabbView, 0, BoundingVolumeCount, results.data());
+				Consume(results.data());
+			});
+
+		const LeviathanCore::BoundingVolumes::Cone queryCone{ LeviathanCore::MathTypes::Vector3(-50.0f, 0.0f, -50.0f),
+			LeviathanCore::MathTypes::Vector3(1.0f, 0.2f, 1.0f).AsNormalizedSafe(), LeviathanCore::MathLibrary::DegreesToRadians(30.0f), 400.0f };
+
+		harness.Run("BoundingVolumes.ConeAABBs.Scalar", BoundingVolumeCount, [&]()
+			{
+				for (size_t i = 0; i < BoundingVolumeCount; ++i)
+				{
+					results[i] = queryCone.Intersects(aabbs.Get(i)) ? 1 : 0;
+				}
+				Consume(results.data());
+			});
+
+		if (harness.Run("BoundingVolumes.ConeAABBs.Batch", BoundingVolumeCount, [&]()
+			{
+				LeviathanCore::BoundingVolumes::TestConeAABBs(queryCone, aabbView, 0, BoundingVolumeCount, results.data());
+				Consume(results.data());
+			}))
+		{
+			harness.AddMetric("BoundingVolumes.ConeAABBs.Batch", "hits", CountPasses(results));
+		}
+
+		const LeviathanCore::BoundingVolumes::Ray ray{ LeviathanCore::MathTypes::Vector3(-SceneHalfSize, -3.0f, 2.0f),
+			LeviathanCore::MathTypes::Vector3(1.0f, 0.01f, -0.005f).AsNormalizedSafe() };
+		const float rayLength = 2.0f * SceneHalfSize;
+		std::vector<float> distances(BoundingVolumeCount, 0.0f);
+
+		harness.Run("BoundingVolumes.RayAABBs.Scalar", BoundingVolumeCount, [&]()
+			{
+				for (size_t i = 0; i < BoundingVolumeCount; ++i)
+				{
+					results[i] = ray.Intersects(aabbs.Get(i), rayLength, distances[i]) ? 1 : 0;
+				}
+				Consume(results.data());
+			});
+
+		if (harness.Run("BoundingVolumes.RayAABBs.Batch", BoundingVolumeCount, [&]()
+			{
+				LeviathanCore::BoundingVolumes::TestRayAABBs(ray, rayLength, aabbView, 0, BoundingVolumeCount, results.data(), distances.data());
+				Consume(results.data());
+			}))
+		{
+			harness.AddMetric("BoundingVolumes.RayAABBs.Batch", "hits", CountPasses(results));
+		}
+	}
+}
@@ -0,0 +1,141 @@
+#include "BenchmarkSuites.h"
+#include "Benchmark.h"
+#include "TestFixtures.h"
+#include "MathTypes.h"
+#include "BoundingVolumes.h"
+#include "JobSystem.h"
+#include "LightTypes.h"
+#include "ClusteredLighting.h"
+
+namespace LeviathanBenchmarks
+{
+	static constexpr size_t ClusteredPointLightCount = 8000;
+	static constexpr size_t ClusteredSpotLightCount = 2000;
+
+	struct ClusteredLightScene
+	{
+		LeviathanRenderer::ClusterView View = {};
+		std::vector<LeviathanRenderer::LightTypes::PointLight> PointLights = {};
+		std::vector<LeviathanRenderer::LightTypes::SpotLight> SpotLights = {};
+	};
+
+	// Camera slightly above the origin looking down +z with a 60 degree vertical field of view. Lights with radii of 1 to 20 units are scattered over a
+	// box enclosing the first 600 units of the frustum and some space behind the camera. Lights are bright enough for the radius to bound their
+	// influence.
+	static ClusteredLightScene MakeClusteredLightScene()
+	{
+		ClusteredLightScene scene = {};
+		scene.View.ViewMatrix = LeviathanCore::MathTypes::Matrix4x4::View(LeviathanCore::MathTypes::Vector3(0.0f, 10.0f, -20.0f),
+			LeviathanCore::MathTypes::Euler(0.0f, 0.0f, 0.0f));
+		scene.View.FovYRadians = 1.0471975512f;
+		scene.View.AspectRatio = 16.0f / 9.0f;
+		scene.View.NearZ = 0.1f;
+		scene.View.FarZ = 800.0f;
+
+		std::mt19937 random(9753);
+		std::uniform_real_distribution<float> horizontalDistribution(-400.0f, 400.0f);
+		std::uniform_real_distribution<float> verticalDistribution(-250.0f, 250.0f);
+		std::uniform_real_distribution<float> depthDistribution(-50.0f, 600.0f);
+		std::uniform_real_distribution<float> radiusDistribution(1.0f, 20.0f);
+		std::uniform_real_distribution<float> unitDistribution(-1.0f, 1.0f);
+		std::uniform_real_distribution<float> coneAngleDistribution(LeviathanCore::MathLibrary::DegreesToRadians(5.0f), LeviathanCore::MathLibrary::DegreesToRadians(70.0f));
+
+		scene.PointLights.resize(ClusteredPointLightCount);
+		for (LeviathanRenderer::LightTypes::PointLight& light : scene.PointLights)
+		{
+			light.Position = LeviathanCore::MathTypes::Vector3(horizontalDistribution(random), verticalDistribution(random), depthDistribution(random));
+			light.Brightness = 4.0f;
+			light.Radius = radiusDistribution(random);
+		}
+
+		scene.SpotLights.resize(ClusteredSpotLightCount);
+		for (LeviathanRenderer::LightTypes::SpotLight& light : scene.SpotLights)
+		{
+			light.Position = LeviathanCore::MathTypes::Vector3(horizontalDistribution(random), verticalDistribution(random), depthDistribution(random));
+			light.Direction = LeviathanCore::MathTypes::Vector3(unitDistribution(random), unitDistribution(random), unitDistribution(random)).AsNormalizedSafe();
+			light.OuterConeAngleRadians = coneAngleDistribution(random);
+			light.Brightness = 4.0f;
+			light.Radius = radiusDistribution(random);
+		}
+		return scene;
+	}
+
+	static void RunClusterAssignmentBenchmarks(Harness& harness, const std::string_view threadingName, const ClusteredLightScene& scene)
+	{
+		const size_t lightCount = scene.PointLights.size() + scene.SpotLights.size();
+		const std::string name = "ClusteredLighting.Assign." + std::to_string(lightCount) + "." + std::string(threadingName);
+
+		LeviathanRenderer::ClusteredLightCulling culling = {};
+		if (harness.Run(name, lightCount, [&]()
+			{
+				culling.Build(scene.View, scene.PointLights.data(), scene.PointLights.size(), scene.SpotLights.data(), scene.SpotLights.size());
+				Consume(culling.GetLightIndices());
+			}))
+		{
+			uint32_t maxClusterLights = 0;
+			size_t emptyClusters = 0;
+			for (size_t cluster = 0; cluster < culling.GetClusterCount(); ++cluster)
+			{
+				maxClusterLights = std::max(maxClusterLights, culling.GetClusters()[cluster].Count);
+				emptyClusters += (culling.GetClusters()[cluster].Count == 0) ? 1 : 0;
+			}
+
+			harness.AddMetric(name, "clusters", static_cast<double>(culling.GetClusterCount()));
+			harness.AddMetric(name, "lightIndices", static_cast<double>(culling.GetLightIndexCount()));
+			harness.AddMetric(name, "averageClusterLights", static_cast<double>(culling.GetLightIndexCount()) / static_cast<double>(culling.GetClusterCount()));
+			harness.AddMetric(name, "maxClusterLights", static_cast<double>(maxClusterLights));
+			harness.AddMetric(name, "emptyClusters", static_cast<double>(emptyClusters));
+			harness.AddMetric(name, "threads", static_cast<double>(LeviathanCore::JobSystem::GetThreadCount()));
+		}
+	}
+
+	// Tests every light against every cluster with the batched sphere box test, the cost the slice and row levels of the cluster assignment avoid.
+	static void RunBruteForceAssignmentBenchmark(Harness& harness, const ClusteredLightScene& scene)
+	{
+		const size_t lightCount = scene.PointLights.size() + scene.SpotLights.size();
+		const std::string name = "ClusteredLighting.Assign." + std::to_string(lightCount) + ".BruteForce";
+
+		LeviathanRenderer::ClusteredLightCulling culling = {};
+		culling.Build(scene.View, scene.PointLights.data(), scene.PointLights.size(), scene.SpotLights.data(), scene.SpotLights.size());
+		LeviathanCore::BoundingVolumes::SphereArray lightBounds = {};
+		for (size_t light = 0; light < lightCount; ++light)
+		{
+			lightBounds.Add(culling.GetLightBounds(light));
+		}
+		const LeviathanCore::BoundingVolumes::SphereSoA lightView = lightBounds.View();
+
+		std::vector<uint8_t> results(lightCount, 0);
+		size_t lightIndexCount = 0;
+		if (harness.Run(name, lightCount, [&]()
+			{
+				lightIndexCount = 0;
+				for (uint32_t slice = 0; slice < culling.GetSliceCount(); ++slice)
+				{
+					for (uint32_t tileY = 0; tileY < culling.GetTileCountY(); ++tileY)
+					{
+						for (uint32_t tileX = 0; tileX < culling.GetTileCountX(); ++tileX)
+						{
+							LeviathanCore::BoundingVolumes::TestAABBSpheres(culling.GetClusterBounds(tileX, tileY, slice), lightView, 0, lightCount, results.data());
+							lightIndexCount += std::count(results.begin(), results.end(), static_cast<uint8_t>(1));
+						}
+					}
+				}
+				Consume(&lightIndexCount);
+			}))
+		{
+			harness.AddMetric(name, "lightIndices", static_cast<double>(lightIndexCount));
+		}
+	}
+
+	void RunClusteredLightingBenchmarks(Harness& harness)
+	{
+		const ClusteredLightScene scene = MakeClusteredLightScene();
+
+		RunBruteForceAssignmentBenchmark(harness, scene);
+
+		LeviathanTestFixtures::RunSingleThreadAndJobSystem(0, [&](const std::string_view threadingName)
+			{
+				RunClusterAssignmentBenchmarks(harness, threadingName, scene);
+			});
+	}
+}
@@ -0,0 +1,191 @@
+#include "BenchmarkSuites.h"
+#include "Benchmark.h"
+#include "DataStructures.h"
+#include "Serialize.h"
+#include "Callback.h"
+
+namespace LeviathanBenchmarks
+{
+	static constexpr size_t SparseArrayMaxID = 65536;
+	static constexpr size_t SerializeUIntCount = 1 << 20;
+	static constexpr size_t CallbackCallCount = 65536;
+	static constexpr size_t CallbackListenerCount = 8;
+
+	struct SparseArrayValue
+	{
+		float Position[3] = { 0.0f, 0.0f, 0.0f };
+		uint32_t Flags = 0;
+	};
+
+	static uint64_t gCallbackAccumulator = 0;
+
+	static void CallbackListener0(uint32_t value) { gCallbackAccumulator += value; }
+	static void CallbackListener1(uint32_t value) { gCallbackAccumulator ^= value; }
+	static void CallbackListener2(uint32_t value) { gCallbackAccumulator += value << 1; }
+	static void CallbackListener3(uint32_t value) { gCallbackAccumulator ^= value << 2; }
+	static void CallbackListener4(uint32_t value) { gCallbackAccumulator += value << 3; }
+	static void CallbackListener5(uint32_t value) { gCallbackAccumulator ^= value << 4; }
+	static void CallbackListener6(uint32_t value) { gCallbackAccumulator += value << 5; }
+	static void CallbackListener7(uint32_t value) { gCallbackAccumulator ^= value << 6; }
+
+	using CallbackListenerType = void(*)(uint32_t);
+	static constexpr std::array<CallbackListenerType, CallbackListenerCount> CallbackListeners =
+	{
+		&CallbackListener0, &CallbackListener1, &CallbackListener2, &CallbackListener3,
+		&CallbackListener4, &CallbackListener5, &CallbackListener6, &CallbackListener7
+	};
+
+	static void RunSparseArrayBenchmarks(Harness& harness)
+	{
+		// Shuffled ids so that sparse lookups do not walk memory linearly.
+		std::vector<size_t> ids(SparseArrayMaxID, 0);
+		std::iota(ids.begin(), ids.end(), 0);
+		std::shuffle(ids.begin(), ids.end(), std::mt19937(1234));
+
+		harness.Run("SparseArray.Add", SparseArrayMaxID, [&]()
+			{
+				LeviathanCore::DataStructures::SparseArray<SparseArrayValue> sparseArray(SparseArrayMaxID, SparseArrayMaxID);
+				for (const size_t id : ids)
+				{
+					sparseArray.Add(id, SparseArrayValue{ { 1.0f, 2.0f, 3.0f }, static_cast<uint32_t>(id) });
+				}
+				Consume(&sparseArray);
+			});
+
+		LeviathanCore::DataStructures::SparseArray<SparseArrayValue> populated(SparseArrayMaxID, SparseArrayMaxID);
+		for (const size_t id : ids)
+		{
+			populated.Add(id, SparseArrayValue{ { 1.0f, 2.0f, 3.0f }, static_cast<uint32_t>(id) });
+		}
+
+		harness.Run("SparseArray.GetValue", SparseArrayMaxID, [&]()
+			{
+				uint64_t sum = 0;
+				for (const size_t id : ids)
+				{
+					sum += populated.GetValue(id).Value.Flags;
+				}
+				Consume(&sum);
+			});
+
+		harness.Run("SparseArray.IterateDense", SparseArrayMaxID, [&]()
+			{
+				const LeviathanCore::DataStructures::SparseArray<SparseArrayValue>::DenseValue* values = nullptr;
+				size_t count = 0;
+				populated.GetValues(values, count);
+
+				float sum = 0.0f;
+				for (size_t i = 0; i < count; ++i)
+				{
+					sum += values[i].Value.Position[0] + values[i].Value.Position[1] + values[i].Value.Position[2];
+				}
+				Consume(&sum);
+			});
+
+		harness.Run("SparseArray.AddRemove", SparseArrayMaxID, [&]()
+			{
+				LeviathanCore::DataStructures::SparseArray<SparseArrayValue> sparseArray(SparseArrayMaxID, SparseArrayMaxID);
+				for (const size_t id : ids)
+				{
+					sparseArray.Add(id, SparseArrayValue{});
+				}
+				for (size_t i = 0; i < SparseArrayMaxID; ++i)
+				{
+					sparseArray.Remove(i);
+				}
+				Consume(&sparseArray);
+			});
+	}
+
+	static void RunSerializeBenchmarks(Harness& harness)
+	{
+		std::vector<uint32_t> uints(SerializeUIntCount, 0);
+		std::mt19937 random(1234);
+		for (uint32_t& value : uints)
+		{
+			value = static_cast<uint32_t>(random());
+		}
+
+		const std::vector<uint8_t> bytes = LeviathanCore::Serialize::UInt32BufferToBytes(uints, LeviathanCore::Serialize::Endianness::LittleEndian);
+
+		harness.Run("Serialize.UInt32BufferToBytes.LittleEndian", SerializeUIntCount, [&]()
+			{
+				const std::vector<uint8_t> result = LeviathanCore::Serialize::UInt32BufferToBytes(uints, LeviathanCore::Serialize::Endianness::LittleEndian);
+				Consume(result.data());
+			});
+
+		harness.Run("Serialize.UInt32BufferToBytes.BigEndian", SerializeUIntCount, [&]()
+			{
+				const std::vector<uint8_t> result = LeviathanCore::Serialize::UInt32BufferToBytes(uints, LeviathanCore::Serialize::Endianness::BigEndian);
+				Consume(result.data());
+			});
+
+		harness.Run("Serialize.BytesToUInt32Buffer.LittleEndian", SerializeUIntCount, [&]()
+			{
+				const std::vector<uint32_t> result = LeviathanCore::Serialize::BytesToUInt32Buffer(bytes, LeviathanCore::Serialize::Endianness::LittleEndian);
+				Consume(result.data());
+			});
+
+		const std::filesystem::path file = std::filesystem::temp_directory_path() / "LeviathanBenchmarksSerialize.bin";
+		const std::string fileString = file.string();
+
+		harness.Run("Serialize.WriteBytesToFile.4MB", 1, [&]()
+			{
+				const bool written = LeviathanCore::Serialize::WriteBytesToFile(fileString, bytes);
+				Consume(&written);
+			});
+
+		harness.Run("Serialize.ReadFile.4MB", 1, [&]()
+			{
+				std::vector<uint8_t> buffer = {};
+				const bool read = LeviathanCore::Serialize::ReadFile(fileString, true, buffer);
+				Consume(&read);
+				Consume(buffer.data());
+			});
+
+		std::error_code errorCode = {};
+		std::filesystem::remove(file, errorCode);
+	}
+
+	static void RunCallbackBenchmarks(Harness& harness)
+	{
+		LeviathanCore::Callback<CallbackListenerType> callback = {};
+		for (const CallbackListenerType listener : CallbackListeners)
+		{
+			callback.Register(listener);
+		}
+
+		harness.Run("Callback.Call.8Listeners", CallbackCallCount, [&]()
+			{
+				for (size_t i = 0; i < CallbackCallCount; ++i)
+				{
+					callback.Call(static_cast<uint32_t>(i));
+				}
+				Consume(&gCallbackAccumulator);
+			});
+
+		harness.Run("Callback.RegisterDeregister.8Listeners", CallbackCallCount, [&]()
+			{
+				LeviathanCore::Callback<CallbackListenerType> transient = {};
+				for (size_t i = 0; i < CallbackCallCount; i += CallbackListenerCount)
+				{
+					for (const CallbackListenerType listener : CallbackListeners)
+					{
+						transient.Register(listener);
+					}
+					for (const CallbackListenerType listener : CallbackListeners)
+					{
+						transient.Deregister(listener);
+					}
+				}
+				Consume(&transient);
+			});
+	}
+
+	void RunCoreBenchmarks(Harness& harness)
+	{
+		RunSparseArrayBenchmarks(harness);
+		RunSerializeBenchmarks(harness);
+		RunCallbackBenchmarks(harness);
+	}
+}
@@ -0,0 +1,218 @@
+#include "BenchmarkSuites.h"
+#include "Benchmark.h"
+#include "EnvironmentCubemap.h"
+#include "AssetTypes.h"
+#include "JobSystem.h"
+
+namespace LeviathanBenchmarks
+{
+	static constexpr int32_t EnvironmentWidth = 4096;
+	static constexpr int32_t EnvironmentHeight = 2048;
+	static constexpr float EnvironmentPi = 3.14159265358979324f;
+	static constexpr const char* EnvironmentBilinearLabel = "4kTo1024.Bilinear.Float32";
+	static constexpr const char* EnvironmentBoxLabel = "4kTo256.Box.Float16";
+	static constexpr const char* EnvironmentLoadName = "EnvironmentCubemap.Load.512.Float16";
+
+	// Smooth sky gradient with a bright sun lobe.
+	static std::array<float, 3> EvaluateEnvironment(const float x, const float y, const float z)
+	{
+		static constexpr std::array<float, 3> sun = { 0.48f, 0.64f, 0.6f };
+		const float sunCosine = std::max((x * sun[0]) + (y * sun[1]) + (z * sun[2]), 0.0f);
+		const float sunLobe = 6.0f * std::pow(sunCosine, 16.0f);
+		return { 2.0f + x + (0.5f * y * z) + sunLobe, 2.0f + y + sunLobe, 2.0f + z + (0.5f * x * y) + (0.5f * sunLobe) };
+	}
+
+	// Rgba texels with rows from the bottom as loaded by TextureImporter::LoadHDRTexture.
+	static void MakeEnvironmentTexture(std::vector<float>& outTexels)
+	{
+		outTexels.resize(static_cast<size_t>(EnvironmentWidth) * EnvironmentHeight * LeviathanAssets::EnvironmentCubemap::ChannelCount);
+		for (int32_t row = 0; row < EnvironmentHeight; ++row)
+		{
+			const float latitude = (((static_cast<float>(row) + 0.5f) / static_cast<float>(EnvironmentHeight)) - 0.5f) * EnvironmentPi;
+			for (int32_t column = 0; column < EnvironmentWidth; ++column)
+			{
+				const float longitude = (((static_cast<float>(column) + 0.5f) / static_cast<float>(EnvironmentWidth)) - 0.5f) * 2.0f * EnvironmentPi;
+				const std::array<float, 3> radiance = EvaluateEnvironment(std::cos(latitude) * std::cos(longitude), std::sin(latitude),
+					std::cos(latitude) * std::sin(longitude));
+				float* const texel = outTexels.data() + (((static_cast<size_t>(row) * EnvironmentWidth) + column) * LeviathanAssets::EnvironmentCubemap::ChannelCount);
+				texel[0] = radiance[0];
+				texel[1] = radiance[1];
+				texel[2] = radiance[2];
+				texel[3] = 1.0f;
+			}
+		}
+	}
+
+	// 1 and powers of two up to the hardware thread count, and the hardware thread count.
+	static std::vector<size_t> GetEnvironmentThreadCounts()
+	{
+		const size_t hardwareThreadCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+		std::vector<size_t> threadCounts = {};
+		for (size_t threadCount = 1; threadCount < hardwareThreadCount; threadCount *= 2)
+		{
+			threadCounts.push_back(threadCount);
+		}
+		threadCounts.push_back(hardwareThreadCount);
+		return threadCounts;
+	}
+
+	static std::string GetConversionBenchmarkName(const std::string_view label, const size_t threadCount)
+	{
+		return "EnvironmentCubemap.Convert." + std::string(label) + "." + std::to_string(threadCount) + "Threads";
+	}
+
+	// Conversion on 1 thread, where the job system is not initialized, and on job systems of more threads.
+	static void RunConversionBenchmarks(Harness& harness, const LeviathanAssets::AssetTypes::HDRTexture& texture, const std::string_view label,
+		const LeviathanAssets::EnvironmentCubemap::Settings& settings)
+	{
+		const size_t texelCount = static_cast<size_t>(settings.FaceSize) * settings.FaceSize * LeviathanAssets::EnvironmentCubemap::FaceCount;
+		double singleThreadNanoseconds = 0.0;
+		for (const size_t threadCount : GetEnvironmentThreadCounts())
+		{
+			const std::string name = GetConversionBenchmarkName(label, threadCount);
+			if (!harness.IsEnabled(name))
+			{
+				continue;
+			}
+
+			const bool startedJobSystem = (threadCount > 1) && LeviathanCore::JobSystem::Initialize(threadCount - 1);
+			const size_t threads = LeviathanCore::JobSystem::GetThreadCount();
+			LeviathanAssets::EnvironmentCubemap::Header header = {};
+			std::vector<uint8_t> faceData = {};
+			const BenchmarkResult* const result = harness.Run(name, texelCount, [&]()
+				{
+					LeviathanAssets::EnvironmentCubemap::Convert(texture, settings, header, faceData);
+					Consume(faceData.data());
+				});
+			if (startedJobSystem)
+			{
+				LeviathanCore::JobSystem::Shutdown();
+			}
+			if (result == nullptr)
+			{
+				continue;
+			}
+
+			if (threads == 1)
+			{
+				singleThreadNanoseconds = result->MedianNanoseconds;
+			}
+
+			harness.AddMetric(name, "threads", static_cast<double>(threads));
+			harness.AddMetric(name, "samplesPerTexel", std::pow(static_cast<double>(LeviathanAssets::EnvironmentCubemap::GetSupersampleCount(
+				static_cast<uint32_t>(texture.Width), settings.FaceSize, settings.SampleFilter)), 2.0));
+			if (singleThreadNanoseconds > 0.0)
+			{
+				harness.AddMetric(name, "speedupVsSingleThread", singleThreadNanoseconds / result->MedianNanoseconds);
+			}
+		}
+	}
+
+	// Loading a converted cubemap file, the cost of later runs.
+	static void RunCubemapFileBenchmark(Harness& harness, const LeviathanAssets::AssetTypes::HDRTexture& texture)
+	{
+		const std::string name = EnvironmentLoadName;
+		if (!harness.IsEnabled(name))
+		{
+			return;
+		}
+
+		LeviathanAssets::EnvironmentCubemap::Settings settings = {};
+		settings.FaceSize = 512;
+		settings.FacePrecision = LeviathanAssets::EnvironmentCubemap::Precision::Float16;
+		settings.SampleFilter = LeviathanAssets::EnvironmentCubemap::Filter::Box;
+		LeviathanAssets::EnvironmentCubemap::Header header = {};
+		std::vector<uint8_t> faceData = {};
+		LeviathanAssets::EnvironmentCubemap::Convert(texture, settings, header, faceData);
+
+		const std::filesystem::path directory = std::filesystem::temp_directory_path();
+		const std::string file = (directory / "LeviathanBenchmarksEnvironment.lcube").string();
+		if (!LeviathanAssets::EnvironmentCubemap::Save(file, header, faceData))
+		{
+			return;
+		}
+
+		LeviathanAssets::EnvironmentCubemap::Header loadedHeader = {};
+		std::vector<uint8_t> loadedFaceData = {};
+		std::error_code errorCode = {};
+		if (harness.Run(name, 1, [&]()
+			{
+				LeviathanAssets::EnvironmentCubemap::Load(file, loadedHeader, loadedFaceData);
+				Consume(loadedFaceData.data());
+			}))
+		{
+			harness.AddMetric(name, "fileMegabytes", static_cast<double>(std::filesystem::file_size(file, errorCode)) / (1024.0 * 1024.0));
+		}
+
+		std::filesystem::remove(file, errorCode);
+	}
+
+	// Float to half conversion of a face worth of values.
+	static void RunHalfConversionBenchmark(Harness& harness)
+	{
+		static constexpr size_t ValueCount = 1024 * 1024;
+		const std::string name = "EnvironmentCubemap.FloatToHalf.1M";
+		if (!harness.IsEnabled(name))
+		{
+			return;
+		}
+
+		std::mt19937 random(49);
+		std::uniform_real_distribution<float> exponentDistribution(-16.0f, 16.0f);
+		std::vector<float> values(ValueCount);
+		for (float& value : values)
+		{
+			value = std::exp2(exponentDistribution(random));
+		}
+
+		std::vector<uint16_t> halves(ValueCount);
+		harness.Run(name, ValueCount, [&]()
+			{
+				for (size_t i = 0; i < ValueCount; ++i)
+				{
+					halves[i] = LeviathanAssets::EnvironmentCubemap::FloatToHalf(values[i]);
+				}
+				Consume(halves.data());
+			});
+	}
+
+	void RunEnvironmentCubemapBenchmarks(Harness& harness)
+	{
+		RunHalfConversionBenchmark(harness);
+
+		// The environment texture takes a while to make, so it is only made when a benchmark using it is enabled.
+		bool enabled = harness.IsEnabled(EnvironmentLoadName);
+		for (const size_t threadCount : GetEnvironmentThreadCounts())
+		{
+			enabled = enabled || harness.IsEnabled(GetConversionBenchmarkName(EnvironmentBilinearLabel, threadCount)) ||
+				harness.IsEnabled(GetConversionBenchmarkName(EnvironmentBoxLabel, threadCount));
+		}
+		if (!enabled)
+		{
+			return;
+		}
+
+		std::vector<float> texels = {};
+		MakeEnvironmentTexture(texels);
+		LeviathanAssets::AssetTypes::HDRTexture texture = {};
+		texture.Width = EnvironmentWidth;
+		texture.Height = EnvironmentHeight;
+		texture.NumComponentsPerPixel = static_cast<int>(LeviathanAssets::EnvironmentCubemap::ChannelCount);
+		texture.Data = texels.data();
+
+		// Faces a quarter of the texture's width take a single bilinear sample per texel. Smaller faces average a grid of samples per texel.
+		LeviathanAssets::EnvironmentCubemap::Settings bilinearSettings = {};
+		bilinearSettings.FaceSize = 1024;
+		bilinearSettings.FacePrecision = LeviathanAssets::EnvironmentCubemap::Precision::Float32;
+		bilinearSettings.SampleFilter = LeviathanAssets::EnvironmentCubemap::Filter::Bilinear;
+		RunConversionBenchmarks(harness, texture, EnvironmentBilinearLabel, bilinearSettings);
+
+		LeviathanAssets::EnvironmentCubemap::Settings boxSettings = {};
+		boxSettings.FaceSize = 256;
+		boxSettings.FacePrecision = LeviathanAssets::EnvironmentCubemap::Precision::Float16;
+		boxSettings.SampleFilter = LeviathanAssets::EnvironmentCubemap::Filter::Box;
+		RunConversionBenchmarks(harness, texture, EnvironmentBoxLabel, boxSettings);
+
+		RunCubemapFileBenchmark(harness, texture);
+	}
+}
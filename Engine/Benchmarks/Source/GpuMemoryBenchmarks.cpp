@@ -0,0 +1,157 @@
+#include "BenchmarkSuites.h"
+#include "Benchmark.h"
+#include "GpuMemory.h"
+
+namespace LeviathanBenchmarks
+{
+	static constexpr size_t GpuMemoryResourceCount = 8192;
+	static constexpr size_t GpuMemoryFrameCount = 240;
+	static constexpr size_t GpuMemoryChurnPerFrame = 64;
+	// Resources used by each frame out of every 4.
+	static constexpr uint32_t GpuMemoryUsedFraction = 4;
+	// Demoted textures are evicted once they are smaller than this.
+	static constexpr size_t GpuMemoryMinDemotedBytes = 64 * 1024;
+
+	// A resource of the simulated title.
+	struct GpuMemoryResourceRecord
+	{
+		LeviathanRenderer::GpuMemoryCategory Category = LeviathanRenderer::GpuMemoryCategory::VertexBuffer;
+		size_t SizeBytes = 0;
+		uint8_t Priority = LeviathanRenderer::GpuMemoryTracker::NotReclaimable;
+		uint64_t LastUsedFrame = 0;
+		LeviathanRenderer::GpuAllocationId Allocation = LeviathanRenderer::InvalidGpuAllocationId;
+	};
+
+	static GpuMemoryResourceRecord MakeGpuMemoryResource(std::mt19937& random)
+	{
+		GpuMemoryResourceRecord resource = {};
+		switch (random() % 5)
+		{
+		case 0:
+			resource.Category = LeviathanRenderer::GpuMemoryCategory::VertexBuffer;
+			resource.SizeBytes = (256 + (random() % 65536)) * 44;
+			break;
+
+		case 1:
+			resource.Category = LeviathanRenderer::GpuMemoryCategory::IndexBuffer;
+			resource.SizeBytes = (384 + (random() % 196608)) * sizeof(uint32_t);
+			break;
+
+		case 2:
+		case 3:
+		{
+			const uint32_t width = 64u << (random() % 6);
+			const uint32_t height = width >> (random() % 2);
+			const bool HDR = (random() % 8) == 0;
+			resource.Category = LeviathanRenderer::GpuMemoryCategory::Texture2D;
+			resource.SizeBytes = LeviathanRenderer::GetGpuTextureBytes(width, height, static_cast<uint32_t>(std::bit_width(std::min(width, height))), 1,
+				HDR ? LeviathanRenderer::GpuTextureFormat::RGBA32Float : LeviathanRenderer::GpuTextureFormat::RGBA8);
+			break;
+		}
+
+		default:
+			resource.Category = LeviathanRenderer::GpuMemoryCategory::TextureCube;
+			resource.SizeBytes = LeviathanRenderer::GetGpuTextureBytes(32u << (random() % 4), 32u << (random() % 4), 1, 6, LeviathanRenderer::GpuTextureFormat::RGBA8);
+			break;
+		}
+
+		// Three of four resources are reclaimable at one of four priorities.
+		const uint32_t priority = random() % 4;
+		resource.Priority = (random() % 4 != 0) ? static_cast<uint8_t>(priority) : LeviathanRenderer::GpuMemoryTracker::NotReclaimable;
+		return resource;
+	}
+
+	struct CountingGpuMemoryBackend
+	{
+		LeviathanRenderer::GpuMemoryTracker* Tracker = nullptr;
+		std::vector<GpuMemoryResourceRecord>* Resources = nullptr;
+		size_t ReclaimCount = 0;
+
+		bool Reclaim(const LeviathanRenderer::GpuAllocationId, const uint64_t resource)
+		{
+			GpuMemoryResourceRecord& record = (*Resources)[resource];
+			Tracker->Untrack(record.Allocation);
+			record.SizeBytes = 0;
+			++ReclaimCount;
+			return true;
+		}
+	};
+
+	static void TrackGpuMemoryResource(LeviathanRenderer::GpuMemoryTracker& tracker, std::vector<GpuMemoryResourceRecord>& resources, const size_t index)
+	{
+		GpuMemoryResourceRecord& resource = resources[index];
+		resource.Allocation = tracker.Track(resource.Category, resource.SizeBytes, index);
+		tracker.SetReclaimPriority(resource.Allocation, resource.Priority);
+		resource.LastUsedFrame = tracker.GetFrameIndex();
+	}
+
+	// Marks a quarter of the resources used by the frame and replaces the churned resources with new ones.
+	static void SimulateGpuMemoryFrame(LeviathanRenderer::GpuMemoryTracker& tracker, std::vector<GpuMemoryResourceRecord>& resources, std::mt19937& random)
+	{
+		for (size_t i = 0; i < GpuMemoryChurnPerFrame; ++i)
+		{
+			const size_t index = random() % resources.size();
+			tracker.Untrack(resources[index].Allocation);
+			resources[index] = MakeGpuMemoryResource(random);
+			TrackGpuMemoryResource(tracker, resources, index);
+		}
+
+		for (GpuMemoryResourceRecord& resource : resources)
+		{
+			if ((resource.Allocation != LeviathanRenderer::InvalidGpuAllocationId) && (random() % GpuMemoryUsedFraction == 0))
+			{
+				tracker.MarkUsed(resource.Allocation);
+				resource.LastUsedFrame = tracker.GetFrameIndex();
+			}
+		}
+	}
+
+	void RunGpuMemoryBenchmarks(Harness& harness)
+	{
+		const std::string name = "GpuMemory.TrackAndReclaim.8kResources";
+		if (!harness.IsEnabled(name))
+		{
+			return;
+		}
+
+		std::mt19937 sceneRandom(48);
+		std::vector<GpuMemoryResourceRecord> sceneResources(GpuMemoryResourceCount);
+		size_t sceneBytes = 0;
+		for (GpuMemoryResourceRecord& resource : sceneResources)
+		{
+			resource = MakeGpuMemoryResource(sceneRandom);
+			sceneBytes += resource.SizeBytes;
+		}
+
+		// Budgets holding about two thirds of the scene, so that every frame reclaims the memory of resources churned in.
+		const size_t totalBudget = sceneBytes * 2 / 3;
+		const size_t textureBudget = totalBudget / 2;
+
+		size_t reclaims = 0;
+		if (harness.Run(name, GpuMemoryFrameCount, [&]()
+			{
+				std::mt19937 random(480);
+				std::vector<GpuMemoryResourceRecord> resources = sceneResources;
+				LeviathanRenderer::GpuMemoryTracker tracker = {};
+				tracker.SetTotalBudget(totalBudget);
+				tracker.SetBudget(LeviathanRenderer::GpuMemoryCategory::Texture2D, textureBudget);
+				for (size_t i = 0; i < resources.size(); ++i)
+				{
+					TrackGpuMemoryResource(tracker, resources, i);
+				}
+
+				CountingGpuMemoryBackend backend = { .Tracker = &tracker, .Resources = &resources };
+				for (size_t frame = 0; frame < GpuMemoryFrameCount; ++frame)
+				{
+					SimulateGpuMemoryFrame(tracker, resources, random);
+					tracker.EndFrame(backend);
+				}
+				reclaims = backend.ReclaimCount;
+				Consume(&reclaims);
+			}))
+		{
+			harness.AddMetric(name, "sceneMegabytes", static_cast<double>(sceneBytes) / (1024.0 * 1024.0));
+			harness.AddMetric(name, "reclaimsPerFrame", static_cast<double>(reclaims) / static_cast<double>(GpuMemoryFrameCount));
+		}
+	}
+}
@@ -0,0 +1,168 @@
+#include "BenchmarkSuites.h"
+#include "Benchmark.h"
+#include "TestFixtures.h"
+#include "MathTypes.h"
+#include "JobSystem.h"
+#include "TransformHierarchy.h"
+
+namespace LeviathanBenchmarks
+{
+	using TransformHierarchy = LeviathanCore::Scene::TransformHierarchy;
+
+	static constexpr size_t HierarchyNodeCount = 1000000;
+	static constexpr size_t HierarchyRootCount = 1000;
+	// Every level has this many times the nodes of the level above until the node count is reached.
+	static constexpr size_t HierarchyBranchingFactor = 4;
+	static constexpr size_t DirtyNodeCount = HierarchyNodeCount / 10;
+
+	static LeviathanCore::MathTypes::Quaternion RandomRotation(std::mt19937& random)
+	{
+		std::uniform_real_distribution<float> angleDistribution(-3.14159265f, 3.14159265f);
+		return LeviathanCore::MathTypes::Quaternion(LeviathanCore::MathTypes::Euler(angleDistribution(random), angleDistribution(random), angleDistribution(random)));
+	}
+
+	// Creates HierarchyNodeCount nodes with random local transforms. Each node below the roots has a random parent in the level above. Returns node ids
+	// in creation order so that every parent precedes its children.
+	static std::vector<TransformHierarchy::NodeId> CreateHierarchy(TransformHierarchy& hierarchy, std::mt19937& random)
+	{
+		std::uniform_real_distribution<float> translationDistribution(-2.0f, 2.0f);
+		std::uniform_real_distribution<float> scaleDistribution(0.8f, 1.25f);
+
+		std::vector<TransformHierarchy::NodeId> nodes = {};
+		nodes.reserve(HierarchyNodeCount);
+
+		size_t levelFirst = 0;
+		size_t levelCount = 0;
+		size_t nextLevelCount = HierarchyRootCount;
+		while (nodes.size() < HierarchyNodeCount)
+		{
+			const size_t createCount = std::min(nextLevelCount, HierarchyNodeCount - nodes.size());
+			std::uniform_int_distribution<size_t> parentDistribution(0, (levelCount > 0) ? (levelCount - 1) : 0);
+			const size_t createFirst = nodes.size();
+			for (size_t i = 0; i < createCount; ++i)
+			{
+				const TransformHierarchy::NodeId parent = (levelCount > 0) ? nodes[levelFirst + parentDistribution(random)] : TransformHierarchy::InvalidNodeId;
+				const TransformHierarchy::NodeId node = hierarchy.CreateNode(parent);
+				hierarchy.SetLocalTransform(node,
+					LeviathanCore::MathTypes::Vector3(translationDistribution(random), translationDistribution(random), translationDistribution(random)),
+					RandomRotation(random),
+					LeviathanCore::MathTypes::Vector3(scaleDistribution(random), scaleDistribution(random), scaleDistribution(random)));
+				nodes.push_back(node);
+			}
+
+			levelFirst = createFirst;
+			levelCount = createCount;
+			nextLevelCount = createCount * HierarchyBranchingFactor;
+		}
+		return nodes;
+	}
+
+	static void RunUpdateBenchmarks(Harness& harness, const std::string_view threadingName, TransformHierarchy& hierarchy,
+		const std::vector<TransformHierarchy::NodeId>& nodes, std::mt19937& random)
+	{
+		// Pre-generate dirty node sets and rotations so the timed loop only sets and updates.
+		static constexpr size_t DirtySetCount = 4;
+		std::uniform_int_distribution<size_t> nodeDistribution(0, nodes.size() - 1);
+		std::vector<std::vector<TransformHierarchy::NodeId>> dirtySets(DirtySetCount);
+		std::vector<LeviathanCore::MathTypes::Quaternion> rotations(DirtyNodeCount);
+		for (std::vector<TransformHierarchy::NodeId>& dirtySet : dirtySets)
+		{
+			dirtySet.resize(DirtyNodeCount);
+			for (TransformHierarchy::NodeId& node : dirtySet)
+			{
+				node = nodes[nodeDistribution(random)];
+			}
+		}
+		for (LeviathanCore::MathTypes::Quaternion& rotation : rotations)
+		{
+			rotation = RandomRotation(random);
+		}
+
+		// Update is timed on its own as well since setting 100k local transforms is not part of the propagation cost.
+		const std::string dirtyName = "TransformHierarchy.Update.1MNodes.10PercentDirty." + std::string(threadingName);
+		std::vector<double> updateNanoseconds = {};
+		size_t dirtySetIndex = 0;
+		const BenchmarkResult* const dirtyResult = harness.Run(dirtyName, DirtyNodeCount, [&]()
+			{
+				const std::vector<TransformHierarchy::NodeId>& dirtySet = dirtySets[dirtySetIndex];
+				dirtySetIndex = (dirtySetIndex + 1) % DirtySetCount;
+				for (size_t i = 0; i < dirtySet.size(); ++i)
+				{
+					hierarchy.SetLocalRotation(dirtySet[i], rotations[i]);
+				}
+
+				const auto start = std::chrono::steady_clock::now();
+				hierarchy.Update();
+				const auto end = std::chrono::steady_clock::now();
+				updateNanoseconds.push_back(static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+				Consume(&hierarchy);
+			});
+		if (dirtyResult != nullptr)
+		{
+			size_t worldChangedCount = 0;
+			for (const TransformHierarchy::NodeId node : nodes)
+			{
+				worldChangedCount += hierarchy.HasWorldChanged(node) ? 1 : 0;
+			}
+
+			std::sort(updateNanoseconds.begin(), updateNanoseconds.end());
+			harness.AddMetric(dirtyName, "updateOnlyMilliseconds", updateNanoseconds[updateNanoseconds.size() / 2] * 1e-6);
+			harness.AddMetric(dirtyName, "worldChangedNodes", static_cast<double>(worldChangedCount));
+			harness.AddMetric(dirtyName, "threads", static_cast<double>(LeviathanCore::JobSystem::GetThreadCount()));
+		}
+
+		// Cost of an update with nothing to do, which only checks the dirty levels.
+		hierarchy.Update();
+		const std::string cleanName = "TransformHierarchy.Update.1MNodes.Clean." + std::string(threadingName);
+		const BenchmarkResult* const cleanResult = harness.Run(cleanName, 1, [&]()
+			{
+				hierarchy.Update();
+				Consume(&hierarchy);
+			});
+		if (cleanResult != nullptr)
+		{
+			harness.AddMetric(cleanName, "threads", static_cast<double>(LeviathanCore::JobSystem::GetThreadCount()));
+		}
+	}
+
+	void RunHierarchyBenchmarks(Harness& harness)
+	{
+		std::mt19937 random(4321);
+
+		harness.Run("TransformHierarchy.Build.1MNodes", HierarchyNodeCount, [&]()
+			{
+				std::mt19937 buildRandom(4321);
+				TransformHierarchy hierarchy = {};
+				CreateHierarchy(hierarchy, buildRandom);
+				hierarchy.Update();
+				Consume(&hierarchy);
+			});
+
+		TransformHierarchy hierarchy = {};
+		const std::vector<TransformHierarchy::NodeId> nodes = CreateHierarchy(hierarchy, random);
+		hierarchy.Update();
+
+		LeviathanTestFixtures::RunSingleThreadAndJobSystem(0, [&](const std::string_view threadingName)
+			{
+				RunUpdateBenchmarks(harness, threadingName, hierarchy, nodes, random);
+			});
+
+		// Moving root subtrees under other roots and back re-sorts storage by depth and recomputes every moved subtree.
+		const std::string reparentName = "TransformHierarchy.Reparent.100Subtrees";
+		bool attached = false;
+		const BenchmarkResult* const reparentResult = harness.Run(reparentName, 100, [&]()
+			{
+				for (size_t root = 0; root + 1 < HierarchyRootCount; root += (HierarchyRootCount / 100))
+				{
+					hierarchy.SetParent(nodes[root], attached ? TransformHierarchy::InvalidNodeId : nodes[root + 1]);
+				}
+				attached = !attached;
+				hierarchy.Update();
+				Consume(&hierarchy);
+			});
+		if (reparentResult != nullptr)
+		{
+			harness.AddMetric(reparentName, "levels", static_cast<double>(hierarchy.GetLevelCount()));
+		}
+	}
+}
@@ -0,0 +1,216 @@
+#include "BenchmarkSuites.h"
+#include "Benchmark.h"
+#include "ImageBasedLighting.h"
+#include "EnvironmentCubemap.h"
+#include "JobSystem.h"
+
+namespace LeviathanBenchmarks
+{
+	static constexpr uint32_t LightingSourceFaceSize = 256;
+	static constexpr const char* LightingLoadName = "ImageBasedLighting.Load.256";
+	static constexpr const char* LightingBrdfName = "ImageBasedLighting.IntegrateBrdf.128x128";
+
+	// Constant, linear and second band terms of the direction.
+	static std::array<float, 3> EvaluateLightingEnvironment(const float x, const float y, const float z)
+	{
+		return { 2.0f + (0.6f * x) + (0.4f * x * z) + (0.2f * ((3.0f * y * y) - 1.0f)), 2.0f + (0.5f * y) + (0.3f * ((x * x) - (z * z))),
+			1.5f + (0.4f * z) - (0.3f * y) + (0.3f * x * y) };
+	}
+
+	static void GetLightingTexelDirection(const uint32_t faceSize, const uint32_t face, const uint32_t x, const uint32_t y, float& outX, float& outY, float& outZ)
+	{
+		const float s = (2.0f * (static_cast<float>(x) + 0.5f) / static_cast<float>(faceSize)) - 1.0f;
+		const float t = (2.0f * (static_cast<float>(y) + 0.5f) / static_cast<float>(faceSize)) - 1.0f;
+		LeviathanAssets::EnvironmentCubemap::GetFaceDirection(face, s, t, outX, outY, outZ);
+		const float inverseLength = 1.0f / std::sqrt((outX * outX) + (outY * outY) + (outZ * outZ));
+		outX *= inverseLength;
+		outY *= inverseLength;
+		outZ *= inverseLength;
+	}
+
+	// Rgba faces of the environment at every texel's center direction.
+	static void MakeLightingEnvironmentFaces(const uint32_t faceSize, std::vector<float>& outFaces)
+	{
+		outFaces.resize(static_cast<size_t>(faceSize) * faceSize * LeviathanAssets::EnvironmentCubemap::FaceCount * LeviathanAssets::EnvironmentCubemap::ChannelCount);
+		for (uint32_t face = 0; face < LeviathanAssets::EnvironmentCubemap::FaceCount; ++face)
+		{
+			for (uint32_t y = 0; y < faceSize; ++y)
+			{
+				for (uint32_t x = 0; x < faceSize; ++x)
+				{
+					float directionX = 0.0f;
+					float directionY = 0.0f;
+					float directionZ = 0.0f;
+					GetLightingTexelDirection(faceSize, face, x, y, directionX, directionY, directionZ);
+					const std::array<float, 3> radiance = EvaluateLightingEnvironment(directionX, directionY, directionZ);
+					float* const texel = outFaces.data() + (((((static_cast<size_t>(face) * faceSize) + y) * faceSize) + x) * LeviathanAssets::EnvironmentCubemap::ChannelCount);
+					texel[0] = radiance[0];
+					texel[1] = radiance[1];
+					texel[2] = radiance[2];
+					texel[3] = 1.0f;
+				}
+			}
+		}
+	}
+
+	// 1 and powers of two up to the hardware thread count, and the hardware thread count.
+	static std::vector<size_t> GetLightingThreadCounts()
+	{
+		const size_t hardwareThreadCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+		std::vector<size_t> threadCounts = {};
+		for (size_t threadCount = 1; threadCount < hardwareThreadCount; threadCount *= 2)
+		{
+			threadCounts.push_back(threadCount);
+		}
+		threadCounts.push_back(hardwareThreadCount);
+		return threadCounts;
+	}
+
+	static std::string GetBakeBenchmarkName(const size_t threadCount)
+	{
+		return "ImageBasedLighting.Bake.256To128." + std::to_string(threadCount) + "Threads";
+	}
+
+	static LeviathanAssets::ImageBasedLighting::Settings GetBakeBenchmarkSettings()
+	{
+		LeviathanAssets::ImageBasedLighting::Settings settings = {};
+		settings.SpecularFaceSize = 128;
+		settings.SpecularMipCount = 6;
+		settings.SpecularSampleCount = 256;
+		settings.BrdfLutSize = 128;
+		settings.BrdfLutSampleCount = 512;
+		return settings;
+	}
+
+	// Bakes on 1 thread, where the job system is not initialized, and on job systems of more threads with the time of each stage.
+	static void RunBakeBenchmarks(Harness& harness, const std::vector<float>& sourceFaces)
+	{
+		const LeviathanAssets::ImageBasedLighting::Settings settings = GetBakeBenchmarkSettings();
+		const size_t texelCount = LeviathanAssets::ImageBasedLighting::GetSpecularMipOffset(settings.SpecularFaceSize, settings.SpecularMipCount) /
+			LeviathanAssets::EnvironmentCubemap::ChannelCount;
+		double singleThreadNanoseconds = 0.0;
+		for (const size_t threadCount : GetLightingThreadCounts())
+		{
+			const std::string name = GetBakeBenchmarkName(threadCount);
+			if (!harness.IsEnabled(name))
+			{
+				continue;
+			}
+
+			const bool startedJobSystem = (threadCount > 1) && LeviathanCore::JobSystem::Initialize(threadCount - 1);
+			const size_t threads = LeviathanCore::JobSystem::GetThreadCount();
+			LeviathanAssets::ImageBasedLighting::BakedLighting lighting = {};
+			LeviathanAssets::ImageBasedLighting::BakeStats stats = {};
+			const BenchmarkResult* const result = harness.Run(name, texelCount, [&]()
+				{
+					LeviathanAssets::ImageBasedLighting::Bake(sourceFaces.data(), LightingSourceFaceSize, settings, lighting, stats);
+					Consume(lighting.SpecularMips.data());
+				});
+			if (startedJobSystem)
+			{
+				LeviathanCore::JobSystem::Shutdown();
+			}
+			if (result == nullptr)
+			{
+				continue;
+			}
+
+			if (threads == 1)
+			{
+				singleThreadNanoseconds = result->MedianNanoseconds;
+			}
+
+			harness.AddMetric(name, "threads", static_cast<double>(threads));
+			harness.AddMetric(name, "sourceMipMilliseconds", stats.SourceMipMilliseconds);
+			harness.AddMetric(name, "irradianceMilliseconds", stats.IrradianceMilliseconds);
+			harness.AddMetric(name, "specularMilliseconds", stats.SpecularMilliseconds);
+			harness.AddMetric(name, "brdfLutMilliseconds", stats.BrdfLutMilliseconds);
+			if (singleThreadNanoseconds > 0.0)
+			{
+				harness.AddMetric(name, "speedupVsSingleThread", singleThreadNanoseconds / result->MedianNanoseconds);
+			}
+		}
+	}
+
+	// Integration of a lookup table's worth of texels on one thread.
+	static void RunBrdfBenchmark(Harness& harness)
+	{
+		static constexpr uint32_t LutSize = 128;
+		static constexpr uint32_t SampleCount = 512;
+		const std::string name = LightingBrdfName;
+		if (!harness.IsEnabled(name))
+		{
+			return;
+		}
+
+		std::vector<float> lut(static_cast<size_t>(LutSize) * LutSize * 2);
+		harness.Run(name, static_cast<size_t>(LutSize) * LutSize, [&]()
+			{
+				for (uint32_t y = 0; y < LutSize; ++y)
+				{
+					for (uint32_t x = 0; x < LutSize; ++x)
+					{
+						float* const texel = lut.data() + (((static_cast<size_t>(y) * LutSize) + x) * 2);
+						LeviathanAssets::ImageBasedLighting::IntegrateBrdf((static_cast<float>(x) + 0.5f) / LutSize, (static_cast<float>(y) + 0.5f) / LutSize,
+							SampleCount, texel[0], texel[1]);
+					}
+				}
+				Consume(lut.data());
+			});
+	}
+
+	// Loading a baked file, the cost of later runs.
+	static void RunLightingFileBenchmark(Harness& harness, const std::vector<float>& sourceFaces)
+	{
+		const std::string name = LightingLoadName;
+		if (!harness.IsEnabled(name))
+		{
+			return;
+		}
+
+		LeviathanAssets::ImageBasedLighting::Settings settings = {};
+		settings.SpecularSampleCount = 16;
+		settings.BrdfLutSampleCount = 16;
+		LeviathanAssets::ImageBasedLighting::BakedLighting lighting = {};
+		LeviathanAssets::ImageBasedLighting::BakeStats stats = {};
+		const std::string file = (std::filesystem::temp_directory_path() / "LeviathanBenchmarksLighting.lcube").string();
+		if ((!LeviathanAssets::ImageBasedLighting::Bake(sourceFaces.data(), LightingSourceFaceSize, settings, lighting, stats)) ||
+			(!LeviathanAssets::ImageBasedLighting::Save(file, lighting)))
+		{
+			return;
+		}
+
+		LeviathanAssets::ImageBasedLighting::BakedLighting loadedLighting = {};
+		std::error_code errorCode = {};
+		if (harness.Run(name, 1, [&]()
+			{
+				LeviathanAssets::ImageBasedLighting::Load(file, loadedLighting);
+				Consume(loadedLighting.SpecularMips.data());
+			}))
+		{
+			harness.AddMetric(name, "fileMegabytes", static_cast<double>(std::filesystem::file_size(file, errorCode)) / (1024.0 * 1024.0));
+		}
+
+		std::filesystem::remove(file, errorCode);
+	}
+
+	void RunImageBasedLightingBenchmarks(Harness& harness)
+	{
+		RunBrdfBenchmark(harness);
+
+		bool enabled = harness.IsEnabled(LightingLoadName);
+		for (const size_t threadCount : GetLightingThreadCounts())
+		{
+			enabled = enabled || harness.IsEnabled(GetBakeBenchmarkName(threadCount));
+		}
+		if (!enabled)
+		{
+			return;
+		}
+
+		std::vector<float> sourceFaces = {};
+		MakeLightingEnvironmentFaces(LightingSourceFaceSize, sourceFaces);
+		RunBakeBenchmarks(harness, sourceFaces);
+		RunLightingFileBenchmark(harness, sourceFaces);
+	}
+}
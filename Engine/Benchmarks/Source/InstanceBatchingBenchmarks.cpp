@@ -0,0 +1,241 @@
+#include "BenchmarkSuites.h"
+#include "Benchmark.h"
+#include "TestFixtures.h"
+#include "MathTypes.h"
+#include "JobSystem.h"
+#include "Camera.h"
+#include "VisibilityCulling.h"
+#include "RenderWorld.h"
+#include "InstanceBatching.h"
+#include "RenderCommands.h"
+#include "RenderStateFilter.h"
+
+namespace LeviathanBenchmarks
+{
+	namespace RenderCommands = LeviathanRenderer::RenderCommands;
+
+	static constexpr size_t CopyCount = 50000;
+	static constexpr size_t MixedRenderableCount = 100000;
+	static constexpr uint32_t MixedMeshCount = 16;
+	static constexpr uint32_t MixedMaterialCount = 64;
+
+	// Backend modelling submission cost. Constant buffer updates are copied to a staging buffer as a Map/memcpy would.
+	struct SubmissionBackend
+	{
+		uint64_t CallCount = 0;
+		uint64_t DrawCallCount = 0;
+		uint64_t UploadedBytes = 0;
+		uint64_t InstanceCount = 0;
+		std::array<uint8_t, 256> Staging = {};
+
+		void ClearRenderTarget(RenderCommands::RenderTarget, const float*) { ++CallCount; }
+		void ClearDepthStencil(float, uint8_t) { ++CallCount; }
+		void SetRenderTarget(RenderCommands::RenderTarget) { ++CallCount; }
+		void SetPipeline(RenderCommands::Pipeline, uint32_t) { ++CallCount; }
+		void SetSkyboxPipeline(LeviathanRenderer::RendererResourceId::IdType, LeviathanRenderer::RendererResourceId::IdType) { ++CallCount; }
+		void SetBlendState(RenderCommands::BlendState) { ++CallCount; }
+		void SetDepthStencilState(RenderCommands::DepthStencilState) { ++CallCount; }
+		void SetTexture(RenderCommands::TextureSlot, LeviathanRenderer::RendererResourceId::IdType) { ++CallCount; }
+		void SetSampler(RenderCommands::TextureSlot, LeviathanRenderer::RendererResourceId::IdType) { ++CallCount; }
+
+		void UpdateConstantBuffer(RenderCommands::ConstantBuffer, const void* data, const uint32_t byteWidth)
+		{
+			++CallCount;
+			memcpy(Staging.data(), data, std::min<size_t>(byteWidth, Staging.size()));
+			UploadedBytes += byteWidth;
+		}
+
+		void SetConstantBufferRange(RenderCommands::ConstantBuffer, uint32_t, uint32_t) { ++CallCount; }
+
+		void DrawIndexed(uint32_t, uint32_t, LeviathanRenderer::RendererResourceId::IdType, LeviathanRenderer::RendererResourceId::IdType)
+		{
+			++CallCount;
+			++DrawCallCount;
+			++InstanceCount;
+		}
+
+		void DrawIndexedInstanced(uint32_t, uint32_t, LeviathanRenderer::RendererResourceId::IdType, LeviathanRenderer::RendererResourceId::IdType,
+			const uint32_t instanceCount, uint32_t)
+		{
+			++CallCount;
+			++DrawCallCount;
+			InstanceCount += instanceCount;
+		}
+
+		void UnbindShaderResources() { ++CallCount; }
+	};
+
+	static LeviathanRenderer::RenderableDescription MakeRenderable(const uint32_t mesh, const uint32_t material, const LeviathanCore::MathTypes::Vector3& position)
+	{
+		LeviathanRenderer::RenderableDescription description = {};
+		description.Mesh.VertexBuffer = mesh;
+		description.Mesh.IndexBuffer = 1000 + mesh;
+		description.Mesh.IndexCount = 36 * mesh;
+		description.Mesh.VertexStrideBytes = 44;
+		description.Mesh.LocalBounds = LeviathanCore::BoundingVolumes::AABB{ LeviathanCore::MathTypes::Vector3(-0.5f, -0.5f, -0.5f),
+			LeviathanCore::MathTypes::Vector3(0.5f, 0.5f, 0.5f) };
+		description.Material.ColorTexture = 2000 + material;
+		description.Material.MetallicTexture = 3000 + material;
+		description.Material.RoughnessTexture = 4000 + material;
+		description.Material.NormalTexture = 5000 + (material % 4);
+		description.Material.Sampler = 1;
+		description.Transform = LeviathanCore::MathTypes::Matrix4x4::Translation(position);
+		return description;
+	}
+
+	// Records the per light draws of one lighting pass as Render did before instancing: material bindings, an object constant buffer upload and a draw
+	// for every draw list entry.
+	static void RecordPerDrawPass(RenderCommands::CommandBuffer& commands, const LeviathanRenderer::RenderWorld& world, const LeviathanRenderer::DrawList& drawList)
+	{
+		commands.Reset();
+		commands.BeginPacket(0);
+		commands.SetPipeline(RenderCommands::Pipeline::PointLight);
+		for (size_t drawIndex = 0; drawIndex < drawList.GetCount(); ++drawIndex)
+		{
+			const LeviathanRenderer::RenderMaterial& material = world.GetMaterial(drawList.Renderables[drawIndex]);
+			const LeviathanRenderer::RenderMesh& mesh = world.GetMesh(drawList.Renderables[drawIndex]);
+			commands.SetTexture(RenderCommands::TextureSlot::Color, material.ColorTexture);
+			commands.SetTexture(RenderCommands::TextureSlot::Metallic, material.MetallicTexture);
+			commands.SetTexture(RenderCommands::TextureSlot::Roughness, material.RoughnessTexture);
+			commands.SetTexture(RenderCommands::TextureSlot::Normal, material.NormalTexture);
+			commands.SetSampler(RenderCommands::TextureSlot::Color, material.Sampler);
+			commands.SetSampler(RenderCommands::TextureSlot::Metallic, material.Sampler);
+			commands.SetSampler(RenderCommands::TextureSlot::Roughness, material.Sampler);
+			commands.SetSampler(RenderCommands::TextureSlot::Normal, material.Sampler);
+			commands.UpdateConstantBuffer(RenderCommands::ConstantBuffer::Object, &drawList.ObjectData[drawIndex],
+				sizeof(LeviathanRenderer::ConstantBufferTypes::ObjectConstantBuffer));
+			commands.DrawIndexed(mesh.IndexCount, mesh.VertexStrideBytes, mesh.VertexBuffer, mesh.IndexBuffer);
+		}
+	}
+
+	// Records the same lighting pass with one instanced draw per batch.
+	static void RecordInstancedPass(RenderCommands::CommandBuffer& commands, const LeviathanRenderer::RenderWorld& world,
+		const LeviathanRenderer::InstanceBatchList& batches)
+	{
+		commands.Reset();
+		commands.BeginPacket(0);
+		commands.SetPipeline(RenderCommands::Pipeline::PointLight);
+		for (const LeviathanRenderer::InstanceBatch& batch : batches.Batches)
+		{
+			const LeviathanRenderer::RenderMaterial& material = world.GetMaterial(batch.Renderable);
+			const LeviathanRenderer::RenderMesh& mesh = world.GetMesh(batch.Renderable);
+			commands.SetTexture(RenderCommands::TextureSlot::Color, material.ColorTexture);
+			commands.SetTexture(RenderCommands::TextureSlot::Metallic, material.MetallicTexture);
+			commands.SetTexture(RenderCommands::TextureSlot::Roughness, material.RoughnessTexture);
+			commands.SetTexture(RenderCommands::TextureSlot::Normal, material.NormalTexture);
+			commands.SetSampler(RenderCommands::TextureSlot::Color, material.Sampler);
+			commands.SetSampler(RenderCommands::TextureSlot::Metallic, material.Sampler);
+			commands.SetSampler(RenderCommands::TextureSlot::Roughness, material.Sampler);
+			commands.SetSampler(RenderCommands::TextureSlot::Normal, material.Sampler);
+			commands.DrawIndexedInstanced(mesh.IndexCount, mesh.VertexStrideBytes, mesh.VertexBuffer, mesh.IndexBuffer, batch.InstanceCount, batch.FirstInstance);
+		}
+	}
+
+	static void RunBuildBenchmarks(Harness& harness, const std::string_view sceneName, const std::string_view threadingName,
+		const LeviathanRenderer::RenderWorld& world, const LeviathanRenderer::DrawList& drawList)
+	{
+		const std::string name = "InstanceBatching.Build." + std::string(sceneName) + "." + std::string(threadingName);
+		LeviathanRenderer::InstanceBatchList batches = {};
+		const BenchmarkResult* const result = harness.Run(name, drawList.GetCount(), [&]()
+			{
+				LeviathanRenderer::BuildInstanceBatches(world, drawList, batches);
+				Consume(batches.InstanceData.data());
+			});
+		if (result != nullptr)
+		{
+			harness.AddMetric(name, "draws", static_cast<double>(drawList.GetCount()));
+			harness.AddMetric(name, "batches", static_cast<double>(batches.GetBatchCount()));
+			harness.AddMetric(name, "threads", static_cast<double>(LeviathanCore::JobSystem::GetThreadCount()));
+		}
+	}
+
+	static void RunSubmitBenchmarks(Harness& harness, const std::string_view threadingName, const LeviathanRenderer::RenderWorld& world,
+		const LeviathanRenderer::DrawList& drawList)
+	{
+		RenderCommands::CommandBuffer commands = {};
+
+		// Per draw submission: record, then execute with redundant state filtered.
+		const std::string perDrawName = "InstanceBatching.Submit.50kCopies.PerDraw." + std::string(threadingName);
+		SubmissionBackend perDrawBackend = {};
+		const BenchmarkResult* const perDrawResult = harness.Run(perDrawName, drawList.GetCount(), [&]()
+			{
+				RecordPerDrawPass(commands, world, drawList);
+				perDrawBackend = {};
+				RenderCommands::StateFilteringBackend<SubmissionBackend> filteringBackend(perDrawBackend);
+				commands.Execute(filteringBackend);
+				Consume(&perDrawBackend);
+			});
+		if (perDrawResult != nullptr)
+		{
+			harness.AddMetric(perDrawName, "backendCalls", static_cast<double>(perDrawBackend.CallCount));
+			harness.AddMetric(perDrawName, "drawCalls", static_cast<double>(perDrawBackend.DrawCallCount));
+			harness.AddMetric(perDrawName, "uploadedBytes", static_cast<double>(perDrawBackend.UploadedBytes));
+			harness.AddMetric(perDrawName, "commandBytes", static_cast<double>(commands.GetSizeBytes()));
+		}
+
+		// Instanced submission: batch, record, upload the instance stream once, then execute.
+		const std::string instancedName = "InstanceBatching.Submit.50kCopies.Instanced." + std::string(threadingName);
+		LeviathanRenderer::InstanceBatchList batches = {};
+		std::vector<LeviathanRenderer::ConstantBufferTypes::ObjectConstantBuffer> instanceBuffer(drawList.GetCount());
+		SubmissionBackend instancedBackend = {};
+		const BenchmarkResult* const instancedResult = harness.Run(instancedName, drawList.GetCount(), [&]()
+			{
+				LeviathanRenderer::BuildInstanceBatches(world, drawList, batches);
+				RecordInstancedPass(commands, world, batches);
+				memcpy(static_cast<void*>(instanceBuffer.data()), batches.InstanceData.data(),
+					batches.GetInstanceCount() * sizeof(LeviathanRenderer::ConstantBufferTypes::ObjectConstantBuffer));
+				instancedBackend = {};
+				instancedBackend.UploadedBytes = batches.GetInstanceCount() * sizeof(LeviathanRenderer::ConstantBufferTypes::ObjectConstantBuffer);
+				RenderCommands::StateFilteringBackend<SubmissionBackend> filteringBackend(instancedBackend);
+				commands.Execute(filteringBackend);
+				Consume(&instancedBackend);
+				Consume(instanceBuffer.data());
+			});
+		if (instancedResult != nullptr)
+		{
+			harness.AddMetric(instancedName, "backendCalls", static_cast<double>(instancedBackend.CallCount));
+			harness.AddMetric(instancedName, "drawCalls", static_cast<double>(instancedBackend.DrawCallCount));
+			harness.AddMetric(instancedName, "uploadedBytes", static_cast<double>(instancedBackend.UploadedBytes));
+			harness.AddMetric(instancedName, "commandBytes", static_cast<double>(commands.GetSizeBytes()));
+		}
+	}
+
+	void RunInstanceBatchingBenchmarks(Harness& harness)
+	{
+		std::mt19937 random(97531);
+		LeviathanRenderer::Camera camera = {};
+		camera.UpdateViewMatrix();
+		camera.UpdateProjectionMatrix(1920, 1080);
+		camera.UpdateViewProjectionMatrix();
+		LeviathanRenderer::FrustumCullingStage cullingStage = {};
+
+		// 50k visible copies of one mesh with one material.
+		LeviathanRenderer::RenderWorld copiesWorld = {};
+		for (size_t i = 0; i < CopyCount; ++i)
+		{
+			copiesWorld.Create(MakeRenderable(1, 1, LeviathanTestFixtures::RandomVisiblePosition(random)));
+		}
+		LeviathanRenderer::DrawList copiesDrawList = {};
+		LeviathanRenderer::BuildDrawList(copiesWorld, camera, cullingStage, copiesDrawList);
+
+		// Visible renderables with 16 meshes and 64 materials.
+		std::uniform_int_distribution<uint32_t> meshDistribution(1, MixedMeshCount);
+		std::uniform_int_distribution<uint32_t> materialDistribution(1, MixedMaterialCount);
+		LeviathanRenderer::RenderWorld mixedWorld = {};
+		for (size_t i = 0; i < MixedRenderableCount; ++i)
+		{
+			const uint32_t mesh = meshDistribution(random);
+			const uint32_t material = materialDistribution(random);
+			mixedWorld.Create(MakeRenderable(mesh, material, LeviathanTestFixtures::RandomVisiblePosition(random)));
+		}
+		LeviathanRenderer::DrawList mixedDrawList = {};
+		LeviathanRenderer::BuildDrawList(mixedWorld, camera, cullingStage, mixedDrawList);
+
+		LeviathanTestFixtures::RunSingleThreadAndJobSystem(0, [&](const std::string_view threadingName)
+			{
+				RunBuildBenchmarks(harness, "50kCopies", threadingName, copiesWorld, copiesDrawList);
+				RunBuildBenchmarks(harness, "100kMixed", threadingName, mixedWorld, mixedDrawList);
+				RunSubmitBenchmarks(harness, threadingName, copiesWorld, copiesDrawList);
+			});
+	}
+}
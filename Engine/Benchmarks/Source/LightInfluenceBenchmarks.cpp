@@ -0,0 +1,123 @@
+#include "BenchmarkSuites.h"
+#include "Benchmark.h"
+#include "TestFixtures.h"
+#include "MathTypes.h"
+#include "BoundingVolumes.h"
+#include "JobSystem.h"
+#include "Camera.h"
+#include "VisibilityCulling.h"
+#include "RenderWorld.h"
+#include "InstanceBatching.h"
+#include "LightTypes.h"
+#include "LightInfluence.h"
+
+namespace LeviathanBenchmarks
+{
+	static constexpr size_t InfluenceRenderableCount = 20000;
+	static constexpr uint32_t InfluenceMeshCount = 16;
+	static constexpr uint32_t InfluenceMaterialCount = 64;
+	static constexpr size_t InfluencePointLightCount = 256;
+	static constexpr size_t InfluenceSpotLightCount = 64;
+
+	struct LightInfluenceScene
+	{
+		LeviathanRenderer::RenderWorld World = {};
+		LeviathanRenderer::DrawList DrawList = {};
+		LeviathanRenderer::InstanceBatchList Batches = {};
+		std::vector<LeviathanRenderer::LightTypes::PointLight> PointLights = {};
+		std::vector<LeviathanRenderer::LightTypes::SpotLight> SpotLights = {};
+	};
+
+	// Unit cubes of mixed meshes and materials and point and spot lights spread over the view frustum. Light radii of 10 to 60 units are limited
+	// further by the brightness cutoff of dim lights.
+	static void MakeLightInfluenceScene(LightInfluenceScene& scene)
+	{
+		std::mt19937 random(4321);
+		std::uniform_int_distribution<uint32_t> meshDistribution(1, InfluenceMeshCount);
+		std::uniform_int_distribution<uint32_t> materialDistribution(1, InfluenceMaterialCount);
+		for (size_t i = 0; i < InfluenceRenderableCount; ++i)
+		{
+			LeviathanRenderer::RenderableDescription description = {};
+			const uint32_t mesh = meshDistribution(random);
+			const uint32_t material = materialDistribution(random);
+			description.Mesh.VertexBuffer = mesh;
+			description.Mesh.IndexBuffer = 1000 + mesh;
+			description.Mesh.IndexCount = 36 * mesh;
+			description.Mesh.VertexStrideBytes = 44;
+			description.Mesh.LocalBounds = LeviathanCore::BoundingVolumes::AABB{ LeviathanCore::MathTypes::Vector3(-0.5f, -0.5f, -0.5f),
+				LeviathanCore::MathTypes::Vector3(0.5f, 0.5f, 0.5f) };
+			description.Material.ColorTexture = 2000 + material;
+			description.Material.MetallicTexture = 3000 + material;
+			description.Material.RoughnessTexture = 4000 + material;
+			description.Material.NormalTexture = 5000 + material;
+			description.Material.Sampler = 1;
+			description.Transform = LeviathanCore::MathTypes::Matrix4x4::Translation(LeviathanTestFixtures::RandomVisiblePosition(random));
+			scene.World.Create(description);
+		}
+
+		LeviathanRenderer::Camera camera = {};
+		camera.UpdateViewMatrix();
+		camera.UpdateProjectionMatrix(1920, 1080);
+		camera.UpdateViewProjectionMatrix();
+		LeviathanRenderer::FrustumCullingStage cullingStage = {};
+		LeviathanRenderer::BuildDrawList(scene.World, camera, cullingStage, scene.DrawList);
+		LeviathanRenderer::BuildInstanceBatches(scene.World, scene.DrawList, scene.Batches);
+
+		std::uniform_real_distribution<float> radiusDistribution(10.0f, 60.0f);
+		std::uniform_real_distribution<float> brightnessDistribution(1.0f, 50.0f);
+		std::uniform_real_distribution<float> unitDistribution(-1.0f, 1.0f);
+		std::uniform_real_distribution<float> coneAngleDistribution(LeviathanCore::MathLibrary::DegreesToRadians(10.0f), LeviathanCore::MathLibrary::DegreesToRadians(60.0f));
+
+		scene.PointLights.resize(InfluencePointLightCount);
+		for (LeviathanRenderer::LightTypes::PointLight& light : scene.PointLights)
+		{
+			light.Position = LeviathanTestFixtures::RandomVisiblePosition(random);
+			light.Brightness = brightnessDistribution(random);
+			light.Radius = radiusDistribution(random);
+		}
+
+		scene.SpotLights.resize(InfluenceSpotLightCount);
+		for (LeviathanRenderer::LightTypes::SpotLight& light : scene.SpotLights)
+		{
+			light.Position = LeviathanTestFixtures::RandomVisiblePosition(random);
+			light.Direction = LeviathanCore::MathTypes::Vector3(unitDistribution(random), unitDistribution(random), unitDistribution(random)).AsNormalizedSafe();
+			light.OuterConeAngleRadians = coneAngleDistribution(random);
+			light.Brightness = brightnessDistribution(random);
+			light.Radius = radiusDistribution(random);
+		}
+	}
+
+	static void RunInfluenceBuildBenchmarks(Harness& harness, const std::string_view threadingName, const LightInfluenceScene& scene)
+	{
+		const size_t lightCount = scene.PointLights.size() + scene.SpotLights.size();
+		const std::string name = "LightInfluence.Build." + std::to_string(scene.DrawList.GetCount()) + "x" + std::to_string(lightCount) + "." + std::string(threadingName);
+
+		LeviathanRenderer::LightInfluenceCulling culling = {};
+		if (harness.Run(name, scene.DrawList.GetCount() * lightCount, [&]()
+			{
+				culling.Build(scene.World, scene.DrawList, scene.Batches, scene.PointLights.data(), scene.PointLights.size(), scene.SpotLights.data(),
+					scene.SpotLights.size());
+				Consume(&culling.GetStats());
+			}))
+		{
+			const LeviathanRenderer::LightInfluenceStats& stats = culling.GetStats();
+			harness.AddMetric(name, "batches", static_cast<double>(scene.Batches.GetBatchCount()));
+			harness.AddMetric(name, "testedPairs", static_cast<double>(stats.TestedPairs));
+			harness.AddMetric(name, "culledPairs", static_cast<double>(stats.CulledPairs));
+			harness.AddMetric(name, "lightingDrawsBefore", static_cast<double>(stats.BatchPairs));
+			harness.AddMetric(name, "lightingDrawsAfter", static_cast<double>(stats.BatchPairs - stats.SkippedDraws));
+			harness.AddMetric(name, "threads", static_cast<double>(LeviathanCore::JobSystem::GetThreadCount()));
+		}
+	}
+
+	void RunLightInfluenceBenchmarks(Harness& harness)
+	{
+		LightInfluenceScene scene = {};
+		MakeLightInfluenceScene(scene);
+
+		LeviathanTestFixtures::RunSingleThreadAndJobSystem(0, [&](const std::string_view threadingName)
+			{
+				RunInfluenceBuildBenchmarks(harness, threadingName, scene);
+			});
+	}
+}
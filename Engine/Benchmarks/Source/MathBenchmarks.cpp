@@ -0,0 +1,243 @@
+#include "BenchmarkSuites.h"
+#include "Benchmark.h"
+#include "MathTypes.h"
+#include "MathLibrary.h"
+#include "FastMath.h"
+
+namespace LeviathanBenchmarks
+{
+	static constexpr size_t MatrixCount = 4096;
+	static constexpr size_t VectorCount = 65536;
+	static constexpr size_t TranscendentalCount = 65536;
+	// Fills the array with count values evenly spaced between min and max.
+	static std::vector<float> MakeSweep(const float min, const float max, const size_t count)
+	{
+		std::vector<float> values(count, 0.0f);
+		for (size_t i = 0; i < count; ++i)
+		{
+			values[i] = min + (max - min) * (static_cast<float>(i) / static_cast<float>(count));
+		}
+		return values;
+	}
+
+	static void RunMathTypesBenchmarks(Harness& harness)
+	{
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> distribution(-10.0f, 10.0f);
+
+		std::vector<LeviathanCore::MathTypes::Matrix4x4> matrices(MatrixCount);
+		std::vector<LeviathanCore::MathTypes::Vector4> vector4s(MatrixCount);
+		for (size_t i = 0; i < MatrixCount; ++i)
+		{
+			const LeviathanCore::MathTypes::Vector3 translation(distribution(random), distribution(random), distribution(random));
+			const LeviathanCore::MathTypes::Euler rotation(distribution(random), distribution(random), distribution(random));
+			matrices[i] = LeviathanCore::MathTypes::Matrix4x4::Translation(translation) * LeviathanCore::MathTypes::Matrix4x4::Rotation(rotation);
+			vector4s[i] = LeviathanCore::MathTypes::Vector4(translation, 1.0f);
+		}
+
+		std::vector<LeviathanCore::MathTypes::Vector3> vector3s(VectorCount);
+		for (LeviathanCore::MathTypes::Vector3& vector : vector3s)
+		{
+			vector = LeviathanCore::MathTypes::Vector3(distribution(random), distribution(random), distribution(random));
+		}
+
+		std::vector<LeviathanCore::MathTypes::Matrix4x4> matrixResults(MatrixCount);
+		std::vector<LeviathanCore::MathTypes::Vector4> vector4Results(MatrixCount);
+		std::vector<LeviathanCore::MathTypes::Vector3> vector3Results(VectorCount);
+
+		harness.Run("MathTypes.Matrix4x4.Multiply", MatrixCount, [&]()
+			{
+				for (size_t i = 0; i < MatrixCount; ++i)
+				{
+					matrixResults[i] = matrices[i] * matrices[(i + 1) % MatrixCount];
+				}
+				Consume(matrixResults.data());
+			});
+
+		harness.Run("MathTypes.Matrix4x4.MultiplyVector4", MatrixCount, [&]()
+			{
+				for (size_t i = 0; i < MatrixCount; ++i)
+				{
+					vector4Results[i] = matrices[i] * vector4s[i];
+				}
+				Consume(vector4Results.data());
+			});
+
+		harness.Run("MathTypes.Matrix4x4.Inverse", MatrixCount, [&]()
+			{
+				for (size_t i = 0; i < MatrixCount; ++i)
+				{
+					matrixResults[i] = LeviathanCore::MathTypes::Matrix4x4::Inverse(matrices[i]);
+				}
+				Consume(matrixResults.data());
+			});
+
+		harness.Run("MathTypes.Matrix4x4.RotationEuler", MatrixCount, [&]()
+			{
+				for (size_t i = 0; i < MatrixCount; ++i)
+				{
+					const LeviathanCore::MathTypes::Vector4& angles = vector4s[i];
+					matrixResults[i] = LeviathanCore::MathTypes::Matrix4x4::Rotation(LeviathanCore::MathTypes::Euler(angles.X(), angles.Y(), angles.Z()));
+				}
+				Consume(matrixResults.data());
+			});
+
+		harness.Run("MathTypes.Vector3.CrossProduct", VectorCount, [&]()
+			{
+				for (size_t i = 0; i < VectorCount; ++i)
+				{
+					vector3Results[i] = LeviathanCore::MathTypes::Vector3::CrossProduct(vector3s[i], vector3s[(i + 1) % VectorCount]);
+				}
+				Consume(vector3Results.data());
+			});
+
+		harness.Run("MathTypes.Vector3.AsNormalizedSafe", VectorCount, [&]()
+			{
+				for (size_t i = 0; i < VectorCount; ++i)
+				{
+					vector3Results[i] = vector3s[i].AsNormalizedSafe();
+				}
+				Consume(vector3Results.data());
+			});
+
+		harness.Run("MathTypes.Quaternion.RotateVector3", VectorCount, [&]()
+			{
+				LeviathanCore::MathTypes::Quaternion quaternion(LeviathanCore::MathTypes::Euler(0.3f, 1.2f, -0.7f));
+				for (size_t i = 0; i < VectorCount; ++i)
+				{
+					vector3Results[i] = quaternion * vector3s[i];
+				}
+				Consume(vector3Results.data());
+			});
+	}
+
+	// Runs the libm, scalar FastMath and array FastMath variants of a unary function.
+	template <typename LibmFunction, typename ScalarFunction, typename ArrayFunction>
+	static void RunUnaryTranscendentalBenchmarks(Harness& harness, const std::string& name, const std::vector<float>& benchmarkInputs, LibmFunction&& libm,
+		ScalarFunction&& scalar, ArrayFunction&& array)
+	{
+		std::vector<float> outputs(benchmarkInputs.size(), 0.0f);
+		const size_t count = benchmarkInputs.size();
+
+		harness.Run("MathLibrary." + name, count, [&]()
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					outputs[i] = libm(benchmarkInputs[i]);
+				}
+				Consume(outputs.data());
+			});
+
+		harness.Run("FastMath." + name + ".Scalar", count, [&]()
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					outputs[i] = scalar(benchmarkInputs[i]);
+				}
+				Consume(outputs.data());
+			});
+
+		harness.Run("FastMath." + name + ".Array", count, [&]()
+			{
+				array(benchmarkInputs.data(), outputs.data(), count);
+				Consume(outputs.data());
+			});
+	}
+
+	static void RunTranscendentalBenchmarks(Harness& harness)
+	{
+		using namespace LeviathanCore;
+
+		const std::vector<float> angles = MakeSweep(-MathLibrary::Pi, MathLibrary::Pi, TranscendentalCount);
+
+		RunUnaryTranscendentalBenchmarks(harness, "Sin", angles,
+			[](const float x) { return MathLibrary::Sin(x); },
+			[](const float x) { return FastMath::Sin(x); },
+			[](const float* x, float* out, const size_t count) { FastMath::Sin(x, out, count); });
+
+		RunUnaryTranscendentalBenchmarks(harness, "Cos", angles,
+			[](const float x) { return MathLibrary::Cos(x); },
+			[](const float x) { return FastMath::Cos(x); },
+			[](const float* x, float* out, const size_t count) { FastMath::Cos(x, out, count); });
+
+		RunUnaryTranscendentalBenchmarks(harness, "Exp", MakeSweep(-20.0f, 20.0f, TranscendentalCount),
+			[](const float x) { return std::exp(x); },
+			[](const float x) { return FastMath::Exp(x); },
+			[](const float* x, float* out, const size_t count) { FastMath::Exp(x, out, count); });
+
+		const std::vector<float> positiveInputs = MakeSweep(0.001f, 1000.0f, TranscendentalCount);
+
+		RunUnaryTranscendentalBenchmarks(harness, "Log", positiveInputs,
+			[](const float x) { return std::log(x); },
+			[](const float x) { return FastMath::Log(x); },
+			[](const float* x, float* out, const size_t count) { FastMath::Log(x, out, count); });
+
+		RunUnaryTranscendentalBenchmarks(harness, "RSqrt", positiveInputs,
+			[](const float x) { return 1.0f / std::sqrt(x); },
+			[](const float x) { return FastMath::RSqrt(x); },
+			[](const float* x, float* out, const size_t count) { FastMath::RSqrt(x, out, count); });
+
+		// SinCos shares a range reduction so it is timed against separate libm calls.
+		std::vector<float> sinOutputs(TranscendentalCount, 0.0f);
+		std::vector<float> cosOutputs(TranscendentalCount, 0.0f);
+		harness.Run("MathLibrary.SinCos", TranscendentalCount, [&]()
+			{
+				for (size_t i = 0; i < TranscendentalCount; ++i)
+				{
+					sinOutputs[i] = MathLibrary::Sin(angles[i]);
+					cosOutputs[i] = MathLibrary::Cos(angles[i]);
+				}
+				Consume(sinOutputs.data());
+				Consume(cosOutputs.data());
+			});
+
+		harness.Run("FastMath.SinCos.Array", TranscendentalCount, [&]()
+			{
+				FastMath::SinCos(angles.data(), sinOutputs.data(), cosOutputs.data(), TranscendentalCount);
+				Consume(sinOutputs.data());
+				Consume(cosOutputs.data());
+			});
+
+		// ATan2 inputs are points on circles of varying radius so that every octant and quadrant is covered.
+		std::vector<float> atanY(TranscendentalCount, 0.0f);
+		std::vector<float> atanX(TranscendentalCount, 0.0f);
+		for (size_t i = 0; i < TranscendentalCount; ++i)
+		{
+			const double angle = MathLibrary::TwoPi * static_cast<double>(i) / static_cast<double>(TranscendentalCount);
+			const double radius = 0.01 + static_cast<double>(i % 97) * 0.37;
+			atanY[i] = static_cast<float>(radius * std::sin(angle));
+			atanX[i] = static_cast<float>(radius * std::cos(angle));
+		}
+
+		std::vector<float> atanOutputs(TranscendentalCount, 0.0f);
+		harness.Run("MathLibrary.ATan2", TranscendentalCount, [&]()
+			{
+				for (size_t i = 0; i < TranscendentalCount; ++i)
+				{
+					atanOutputs[i] = MathLibrary::ATan2(atanY[i], atanX[i]);
+				}
+				Consume(atanOutputs.data());
+			});
+
+		harness.Run("FastMath.ATan2.Scalar", TranscendentalCount, [&]()
+			{
+				for (size_t i = 0; i < TranscendentalCount; ++i)
+				{
+					atanOutputs[i] = FastMath::ATan2(atanY[i], atanX[i]);
+				}
+				Consume(atanOutputs.data());
+			});
+
+		harness.Run("FastMath.ATan2.Array", TranscendentalCount, [&]()
+			{
+				FastMath::ATan2(atanY.data(), atanX.data(), atanOutputs.data(), TranscendentalCount);
+				Consume(atanOutputs.data());
+			});
+	}
+
+	void RunMathBenchmarks(Harness& harness)
+	{
+		RunMathTypesBenchmarks(harness);
+		RunTranscendentalBenchmarks(harness);
+	}
+}
@@ -0,0 +1,231 @@
+#include "BenchmarkSuites.h"
+#include "Benchmark.h"
+#include "MathTypes.h"
+#include "BoundingVolumes.h"
+#include "AssetTypes.h"
+#include "MeshSimplification.h"
+#include "Camera.h"
+#include "LevelOfDetail.h"
+
+namespace LeviathanBenchmarks
+{
+	// 2 * 512 * (256 - 1) = 261120 triangles.
+	static constexpr size_t SimplificationSectors = 512;
+	static constexpr size_t SimplificationStacks = 256;
+	static constexpr float SimplificationRadius = 10.0f;
+	static constexpr size_t LODObjectCount = 20000;
+	static constexpr float LODObjectScale = 0.05f;
+	static constexpr float LODViewportHeight = 1080.0f;
+	static constexpr float LODMaxPixelError = 1.0f;
+
+	// Radius of the bumpy sphere. The bumps vanish at the poles so that the pole vertices meet.
+	static float SimplificationSurfaceRadius(const float theta, const float phi)
+	{
+		return SimplificationRadius + (0.5f * std::sin(8.0f * theta) * std::cos(6.0f * phi)) + (0.2f * std::sin(14.0f * theta) * std::sin(11.0f * phi));
+	}
+
+	// Closed bumpy uv sphere with smooth normals, texture coordinates and tangents. The first and last sector columns share positions but not texture
+	// coordinates, forming a seam, and every pole is a ring of vertices at one position.
+	static LeviathanAssets::AssetTypes::Mesh CreateSimplificationSphere()
+	{
+		constexpr size_t columns = SimplificationSectors + 1;
+		LeviathanAssets::AssetTypes::Mesh mesh = {};
+		for (size_t stack = 0; stack <= SimplificationStacks; ++stack)
+		{
+			const float theta = 3.14159265f * static_cast<float>(stack) / static_cast<float>(SimplificationStacks);
+			for (size_t sector = 0; sector <= SimplificationSectors; ++sector)
+			{
+				// The seam column repeats the angle of the first column so that its positions are bitwise equal.
+				const float phi = 6.28318531f * static_cast<float>(sector % SimplificationSectors) / static_cast<float>(SimplificationSectors);
+				const float radius = SimplificationSurfaceRadius(theta, phi);
+				if ((stack == 0) || (stack == SimplificationStacks))
+				{
+					mesh.Positions.emplace_back(0.0f, (stack == 0) ? SimplificationRadius : -SimplificationRadius, 0.0f);
+				}
+				else
+				{
+					mesh.Positions.emplace_back(radius * std::sin(theta) * std::cos(phi), radius * std::cos(theta), radius * std::sin(theta) * std::sin(phi));
+				}
+				mesh.TextureCoordinates.emplace_back(static_cast<float>(sector) / static_cast<float>(SimplificationSectors),
+					static_cast<float>(stack) / static_cast<float>(SimplificationStacks));
+				mesh.Tangents.emplace_back(-std::sin(phi), 0.0f, std::cos(phi));
+			}
+		}
+
+		for (size_t stack = 0; stack < SimplificationStacks; ++stack)
+		{
+			for (size_t sector = 0; sector < SimplificationSectors; ++sector)
+			{
+				const uint32_t a = static_cast<uint32_t>((stack * columns) + sector);
+				const uint32_t b = a + static_cast<uint32_t>(columns);
+				// The first and last stacks have one triangle per sector.
+				if (stack != 0)
+				{
+					mesh.Indices.insert(mesh.Indices.end(), { a, b, a + 1 });
+				}
+				if (stack != SimplificationStacks - 1)
+				{
+					mesh.Indices.insert(mesh.Indices.end(), { a + 1, b, b + 1 });
+				}
+			}
+		}
+
+		// Smooth normals accumulated per position so that both sides of the seam and every vertex of a pole agree.
+		const auto positionGroup = [](const size_t vertex) -> size_t
+			{
+				const size_t stack = vertex / columns;
+				if (stack == 0)
+				{
+					return 0;
+				}
+				if (stack == SimplificationStacks)
+				{
+					return 1;
+				}
+				return 2 + ((stack - 1) * SimplificationSectors) + ((vertex % columns) % SimplificationSectors);
+			};
+		std::vector<LeviathanCore::MathTypes::Vector3> groupNormals(2 + ((SimplificationStacks - 1) * SimplificationSectors), LeviathanCore::MathTypes::Vector3(0.0f, 0.0f, 0.0f));
+		for (size_t i = 0; i < mesh.Indices.size(); i += 3)
+		{
+			const LeviathanCore::MathTypes::Vector3& p0 = mesh.Positions[mesh.Indices[i]];
+			const LeviathanCore::MathTypes::Vector3 faceNormal = LeviathanCore::MathTypes::Vector3::CrossProduct(mesh.Positions[mesh.Indices[i + 1]] - p0,
+				mesh.Positions[mesh.Indices[i + 2]] - p0);
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				LeviathanCore::MathTypes::Vector3& normal = groupNormals[positionGroup(mesh.Indices[i + corner])];
+				normal = normal + faceNormal;
+			}
+		}
+		for (size_t vertex = 0; vertex < mesh.Positions.size(); ++vertex)
+		{
+			mesh.Normals.push_back(groupNormals[positionGroup(vertex)].AsNormalizedSafe());
+		}
+
+		mesh.CalculateBounds();
+		return mesh;
+	}
+
+	static void RunSimplifyBenchmark(Harness& harness, const LeviathanAssets::AssetTypes::Mesh& mesh)
+	{
+		const size_t sourceTriangles = mesh.Indices.size() / 3;
+		const size_t targetTriangles = sourceTriangles / 4;
+		const std::string name = "MeshSimplification.Simplify." + std::to_string(sourceTriangles) + ".To" + std::to_string(targetTriangles);
+
+		const LeviathanAssets::MeshSimplification::Settings settings = {};
+		LeviathanAssets::AssetTypes::Mesh simplified = {};
+		float error = 0.0f;
+		const BenchmarkResult* const result = harness.Run(name, sourceTriangles, [&]()
+			{
+				LeviathanAssets::MeshSimplification::Simplify(mesh, targetTriangles, std::numeric_limits<float>::max(), settings, simplified, error);
+				Consume(simplified.Indices.data());
+			});
+		if (result != nullptr)
+		{
+			const size_t resultTriangles = simplified.Indices.size() / 3;
+			harness.AddMetric(name, "resultTriangles", static_cast<double>(resultTriangles));
+			harness.AddMetric(name, "trianglesSaved", static_cast<double>(sourceTriangles - resultTriangles));
+			harness.AddMetric(name, "error", static_cast<double>(error));
+			if (result->MedianNanoseconds > 0.0)
+			{
+				harness.AddMetric(name, "MtrianglesPerSecond", (static_cast<double>(sourceTriangles) * 1e3) / result->MedianNanoseconds);
+			}
+		}
+	}
+
+	static void RunLODChainBenchmark(Harness& harness, const LeviathanAssets::AssetTypes::Mesh& mesh, LeviathanAssets::MeshSimplification::LODChain& outChain)
+	{
+		const size_t sourceTriangles = mesh.Indices.size() / 3;
+		const std::string name = "MeshSimplification.BuildLODChain." + std::to_string(sourceTriangles);
+
+		const LeviathanAssets::MeshSimplification::LODChainSettings settings = {};
+		const BenchmarkResult* const result = harness.Run(name, sourceTriangles, [&]()
+			{
+				LeviathanAssets::MeshSimplification::BuildLODChain(mesh, settings, outChain);
+				Consume(outChain.Levels.data());
+			});
+		if (result != nullptr)
+		{
+			harness.AddMetric(name, "levels", static_cast<double>(outChain.Levels.size()));
+			for (size_t level = 1; level < outChain.Levels.size(); ++level)
+			{
+				const std::string levelName = "level" + std::to_string(level);
+				harness.AddMetric(name, levelName + "Triangles", static_cast<double>(outChain.Levels[level].Indices.size() / 3));
+				harness.AddMetric(name, levelName + "Error", static_cast<double>(outChain.Errors[level]));
+			}
+			if (result->MedianNanoseconds > 0.0)
+			{
+				harness.AddMetric(name, "MtrianglesPerSecond", (static_cast<double>(sourceTriangles) * 1e3) / result->MedianNanoseconds);
+			}
+		}
+	}
+
+	// Copies of the mesh scaled to a world radius of 0.5 spread over the view of a camera at the origin looking down +z.
+	static void RunLODSelectionBenchmark(Harness& harness, const LeviathanAssets::AssetTypes::Mesh& mesh, const LeviathanAssets::MeshSimplification::LODChain& chain)
+	{
+		if (chain.Levels.empty())
+		{
+			return;
+		}
+
+		std::mt19937 random(2468);
+		std::uniform_real_distribution<float> depthDistribution(2.0f, 400.0f);
+		std::uniform_real_distribution<float> offsetDistribution(-0.3f, 0.3f);
+		std::vector<LeviathanCore::BoundingVolumes::Sphere> bounds(LODObjectCount);
+		for (LeviathanCore::BoundingVolumes::Sphere& sphere : bounds)
+		{
+			const float z = depthDistribution(random);
+			sphere.Center = LeviathanCore::MathTypes::Vector3(offsetDistribution(random) * z, offsetDistribution(random) * z, z);
+			sphere.Radius = mesh.BoundingSphere.Radius * LODObjectScale;
+		}
+
+		LeviathanRenderer::Camera camera = {};
+		camera.UpdateViewMatrix();
+		camera.UpdateProjectionMatrix(1920, 1080);
+		camera.UpdateViewProjectionMatrix();
+
+		const uint32_t levelCount = static_cast<uint32_t>(chain.Levels.size());
+		std::vector<uint32_t> levels(LODObjectCount, 0);
+		const std::string name = "MeshSimplification.SelectLevelOfDetail." + std::to_string(LODObjectCount);
+		if (harness.Run(name, LODObjectCount, [&]()
+			{
+				for (size_t i = 0; i < LODObjectCount; ++i)
+				{
+					levels[i] = LeviathanRenderer::SelectLevelOfDetail(camera, bounds[i], LODObjectScale, chain.Errors.data(), levelCount, LODViewportHeight,
+						LODMaxPixelError);
+				}
+				Consume(levels.data());
+			}))
+		{
+			const double fullTriangles = static_cast<double>(LODObjectCount) * static_cast<double>(mesh.Indices.size() / 3);
+			double selectedTriangles = 0.0;
+			std::vector<double> levelObjects(levelCount, 0.0);
+			for (size_t i = 0; i < LODObjectCount; ++i)
+			{
+				selectedTriangles += static_cast<double>(chain.Levels[levels[i]].Indices.size() / 3);
+				levelObjects[levels[i]] += 1.0;
+			}
+
+			harness.AddMetric(name, "trianglesFullDetail", fullTriangles);
+			harness.AddMetric(name, "trianglesSelected", selectedTriangles);
+			harness.AddMetric(name, "trianglesSaved", fullTriangles - selectedTriangles);
+			for (uint32_t level = 0; level < levelCount; ++level)
+			{
+				harness.AddMetric(name, "level" + std::to_string(level) + "Objects", levelObjects[level]);
+			}
+		}
+	}
+
+	void RunMeshSimplificationBenchmarks(Harness& harness)
+	{
+		const LeviathanAssets::AssetTypes::Mesh mesh = CreateSimplificationSphere();
+		RunSimplifyBenchmark(harness, mesh);
+
+		LeviathanAssets::MeshSimplification::LODChain chain = {};
+		RunLODChainBenchmark(harness, mesh, chain);
+		if (chain.Levels.empty() && harness.IsEnabled("MeshSimplification.SelectLevelOfDetail." + std::to_string(LODObjectCount)))
+		{
+			LeviathanAssets::MeshSimplification::BuildLODChain(mesh, LeviathanAssets::MeshSimplification::LODChainSettings{}, chain);
+		}
+		RunLODSelectionBenchmark(harness, mesh, chain);
+	}
+}
@@ -0,0 +1,165 @@
+#include "BenchmarkSuites.h"
+#include "Benchmark.h"
+#include "TestFixtures.h"
+#include "MathTypes.h"
+#include "BoundingVolumes.h"
+#include "JobSystem.h"
+#include "AssetTypes.h"
+#include "Meshlets.h"
+#include "Camera.h"
+#include "ClusterCulling.h"
+
+namespace LeviathanBenchmarks
+{
+	// 2 * 2048 * 1024 = 4194304 triangles.
+	static constexpr size_t TorusMajorSegments = 2048;
+	static constexpr size_t TorusMinorSegments = 1024;
+	static constexpr float TorusMajorRadius = 10.0f;
+	static constexpr float TorusMinorRadius = 3.0f;
+
+	// Closed bumpy torus around the y axis with triangles facing outwards.
+	static LeviathanAssets::AssetTypes::Mesh CreateMeshletTorus()
+	{
+		LeviathanAssets::AssetTypes::Mesh mesh = {};
+		mesh.Positions.reserve(TorusMajorSegments * TorusMinorSegments);
+		for (size_t major = 0; major < TorusMajorSegments; ++major)
+		{
+			const float u = 6.28318531f * static_cast<float>(major) / static_cast<float>(TorusMajorSegments);
+			for (size_t minor = 0; minor < TorusMinorSegments; ++minor)
+			{
+				const float v = 6.28318531f * static_cast<float>(minor) / static_cast<float>(TorusMinorSegments);
+				const float radius = TorusMinorRadius + (0.3f * std::sin(13.0f * u) * std::cos(7.0f * v)) + (0.1f * std::sin(41.0f * u + 3.0f * v));
+				const float ring = TorusMajorRadius + (radius * std::cos(v));
+				mesh.Positions.emplace_back(ring * std::cos(u), radius * std::sin(v), ring * std::sin(u));
+			}
+		}
+
+		const auto vertex = [](const size_t major, const size_t minor)
+			{
+				return static_cast<uint32_t>(((major % TorusMajorSegments) * TorusMinorSegments) + (minor % TorusMinorSegments));
+			};
+		mesh.Indices.reserve(TorusMajorSegments * TorusMinorSegments * 6);
+		for (size_t major = 0; major < TorusMajorSegments; ++major)
+		{
+			for (size_t minor = 0; minor < TorusMinorSegments; ++minor)
+			{
+				const uint32_t a = vertex(major, minor);
+				const uint32_t b = vertex(major, minor + 1);
+				const uint32_t c = vertex(major + 1, minor);
+				const uint32_t d = vertex(major + 1, minor + 1);
+				mesh.Indices.insert(mesh.Indices.end(), { a, b, c, b, d, c });
+			}
+		}
+
+		mesh.CalculateBounds();
+		return mesh;
+	}
+
+	static void RunBuildMeshletsBenchmark(Harness& harness, const std::string& name, const LeviathanAssets::AssetTypes::Mesh& mesh,
+		LeviathanAssets::Meshlets::MeshletMesh& outMeshlets)
+	{
+		const size_t triangleCount = mesh.Indices.size() / 3;
+		const LeviathanAssets::Meshlets::Settings settings = {};
+		const BenchmarkResult* const result = harness.Run(name, triangleCount, [&]()
+			{
+				LeviathanAssets::Meshlets::BuildMeshlets(mesh, settings, outMeshlets);
+				Consume(outMeshlets.Meshlets.data());
+			});
+		if (result != nullptr)
+		{
+			const double meshletCount = static_cast<double>(outMeshlets.Meshlets.size());
+			double radiusSum = 0.0;
+			double coneCount = 0.0;
+			for (const LeviathanAssets::Meshlets::Meshlet& meshlet : outMeshlets.Meshlets)
+			{
+				radiusSum += static_cast<double>(meshlet.BoundingSphere.Radius);
+				coneCount += (meshlet.ConeCutoff < 1.0f) ? 1.0 : 0.0;
+			}
+
+			harness.AddMetric(name, "meshlets", meshletCount);
+			harness.AddMetric(name, "averageVertices", static_cast<double>(outMeshlets.Vertices.size()) / meshletCount);
+			harness.AddMetric(name, "averageTriangles", static_cast<double>(triangleCount) / meshletCount);
+			// Meshlet vertices per source vertex. Every vertex shared by two meshlets is transformed twice by meshlet consumers.
+			harness.AddMetric(name, "vertexDuplication", static_cast<double>(outMeshlets.Vertices.size()) / static_cast<double>(mesh.Positions.size()));
+			harness.AddMetric(name, "averageRadius", radiusSum / meshletCount);
+			harness.AddMetric(name, "meshletsWithCone", coneCount);
+			if (result->MedianNanoseconds > 0.0)
+			{
+				harness.AddMetric(name, "MtrianglesPerSecond", (static_cast<double>(triangleCount) * 1e3) / result->MedianNanoseconds);
+			}
+		}
+	}
+
+	static void RunClusterCullingBenchmark(Harness& harness, const std::string& name, const LeviathanAssets::AssetTypes::Mesh& mesh,
+		const LeviathanAssets::Meshlets::MeshletMesh& meshlets)
+	{
+		std::vector<LeviathanRenderer::ClusterDescription> clusters(meshlets.Meshlets.size());
+		for (size_t i = 0; i < clusters.size(); ++i)
+		{
+			const LeviathanAssets::Meshlets::Meshlet& meshlet = meshlets.Meshlets[i];
+			clusters[i] = LeviathanRenderer::ClusterDescription{ meshlet.BoundingSphere, meshlet.ConeApex, meshlet.ConeAxis, meshlet.ConeCutoff,
+				meshlet.TriangleOffset * 3, meshlet.TriangleCount * 3 };
+		}
+		LeviathanRenderer::ClusterCullingStage stage = {};
+		stage.SetClusters(clusters.data(), clusters.size());
+
+		// The torus is tilted, scaled and moved in front of a camera looking down +z so that part of it is outside the view and half of it faces away.
+		const LeviathanCore::MathTypes::Matrix4x4 transform = LeviathanCore::MathTypes::Matrix4x4::Translation(LeviathanCore::MathTypes::Vector3(4.0f, -2.0f, 24.0f)) *
+			LeviathanCore::MathTypes::Matrix4x4::Rotation(LeviathanCore::MathTypes::Vector3(1.0f, 0.0f, 0.0f), -0.9f) *
+			LeviathanCore::MathTypes::Matrix4x4::Scaling(LeviathanCore::MathTypes::Vector3(1.5f, 1.5f, 1.5f));
+		LeviathanRenderer::Camera camera = {};
+		camera.UpdateViewMatrix();
+		camera.UpdateProjectionMatrix(1920, 1080);
+		camera.UpdateViewProjectionMatrix();
+
+		const size_t clusterCount = clusters.size();
+		const BenchmarkResult* const result = harness.Run(name, clusterCount, [&]()
+			{
+				stage.Cull(camera, transform, meshlets.Indices.data());
+				Consume(stage.GetVisibleIndices());
+			});
+		if (result != nullptr)
+		{
+			const LeviathanRenderer::ClusterCullingStats& stats = stage.GetStats();
+			const double triangleCount = static_cast<double>(mesh.Indices.size() / 3);
+			const double visibleTriangles = static_cast<double>(stage.GetVisibleIndexCount() / 3);
+
+			harness.AddMetric(name, "visibleClusters", static_cast<double>(stage.GetVisibleClusterCount()));
+			harness.AddMetric(name, "frustumCulledClusters", static_cast<double>(stats.FrustumCulledClusters));
+			harness.AddMetric(name, "backFacingClusters", static_cast<double>(stats.BackFacingClusters));
+			harness.AddMetric(name, "visibleTriangles", visibleTriangles);
+			harness.AddMetric(name, "trianglesCulled", triangleCount - visibleTriangles);
+			harness.AddMetric(name, "threads", static_cast<double>(LeviathanCore::JobSystem::GetThreadCount()));
+			if (result->MedianNanoseconds > 0.0)
+			{
+				harness.AddMetric(name, "MtrianglesPerSecond", (triangleCount * 1e3) / result->MedianNanoseconds);
+			}
+		}
+	}
+
+	void RunMeshletBenchmarks(Harness& harness)
+	{
+		const size_t triangleCount = 2 * TorusMajorSegments * TorusMinorSegments;
+		const std::string buildName = "Meshlets.Build." + std::to_string(triangleCount);
+		const std::string cullName = "Meshlets.ClusterCull." + std::to_string(triangleCount);
+		const std::string singleThreadCullName = cullName + ".SingleThread";
+		const std::string jobSystemCullName = cullName + ".JobSystem";
+		if (!harness.IsEnabled(buildName) && !harness.IsEnabled(singleThreadCullName) && !harness.IsEnabled(jobSystemCullName))
+		{
+			return;
+		}
+
+		const LeviathanAssets::AssetTypes::Mesh mesh = CreateMeshletTorus();
+		LeviathanAssets::Meshlets::MeshletMesh meshlets = {};
+		RunBuildMeshletsBenchmark(harness, buildName, mesh, meshlets);
+		if (meshlets.Meshlets.empty())
+		{
+			LeviathanAssets::Meshlets::BuildMeshlets(mesh, LeviathanAssets::Meshlets::Settings{}, meshlets);
+		}
+
+		LeviathanTestFixtures::RunSingleThreadAndJobSystem(0, [&](const std::string_view threadingName)
+			{
+				RunClusterCullingBenchmark(harness, cullName + "." + std::string(threadingName), mesh, meshlets);
+			});
+	}
+}
@@ -0,0 +1,168 @@
+#include "BenchmarkSuites.h"
+#include "Benchmark.h"
+#include "TestFixtures.h"
+#include "MathTypes.h"
+#include "BoundingVolumes.h"
+#include "JobSystem.h"
+#include "Camera.h"
+#include "VisibilityCulling.h"
+#include "RenderWorld.h"
+#include "OcclusionCulling.h"
+
+namespace LeviathanBenchmarks
+{
+	static constexpr size_t OccludeeCount = 20000;
+	static constexpr size_t OccluderRowCount = 8;
+
+	struct OcclusionScene
+	{
+		LeviathanRenderer::Camera Camera = {};
+		LeviathanRenderer::RenderWorld World = {};
+		LeviathanRenderer::FrustumCullingStage FrustumCulling = {};
+		LeviathanRenderer::OcclusionCullingStage OcclusionCulling = {};
+		// Boxes of the occluders, which objects are kept out of.
+		std::vector<LeviathanCore::BoundingVolumes::AABB> OccluderBoxes = {};
+	};
+
+	static LeviathanRenderer::OccluderDescription MakeBoxOccluder(const LeviathanCore::BoundingVolumes::AABB& box)
+	{
+		LeviathanRenderer::OccluderDescription description = {};
+		for (uint32_t corner = 0; corner < 8; ++corner)
+		{
+			description.Positions.emplace_back((corner & 1) ? box.Max.X() : box.Min.X(), (corner & 2) ? box.Max.Y() : box.Min.Y(),
+				(corner & 4) ? box.Max.Z() : box.Min.Z());
+		}
+		description.Indices = {
+			0, 2, 3, 0, 3, 1,
+			4, 5, 7, 4, 7, 6,
+			0, 1, 5, 0, 5, 4,
+			2, 6, 7, 2, 7, 3,
+			0, 4, 6, 0, 6, 2,
+			1, 3, 7, 1, 7, 5 };
+		description.Transform = LeviathanCore::MathTypes::Matrix4x4::Identity();
+		return description;
+	}
+
+	// Indoor scene seen from a camera at the origin looking down +z. Rows of wall panels with doorway gaps and varying heights stand between 60 and 725
+	// units deep, and a corridor wall on the left runs from behind the camera to beyond the farthest row, crossing the near plane. Unit cubes are
+	// scattered over the view between the walls.
+	static void MakeOcclusionScene(OcclusionScene& scene)
+	{
+		scene.Camera.UpdateViewMatrix();
+		scene.Camera.UpdateProjectionMatrix(1920, 1080);
+		scene.Camera.UpdateViewProjectionMatrix();
+
+		std::mt19937 random(2468);
+		std::uniform_real_distribution<float> unitDistribution(0.0f, 1.0f);
+		for (size_t row = 0; row < OccluderRowCount; ++row)
+		{
+			const float z = 60.0f + 95.0f * static_cast<float>(row);
+			for (float x = -0.8f * z; x < 0.8f * z;)
+			{
+				const float width = z * (0.12f + 0.18f * unitDistribution(random));
+				const float top = z * (0.45f * unitDistribution(random));
+				scene.OccluderBoxes.push_back(LeviathanCore::BoundingVolumes::AABB{ LeviathanCore::MathTypes::Vector3(x, -0.5f * z, z),
+					LeviathanCore::MathTypes::Vector3(x + width, top, z + 2.0f) });
+				x += width + z * (0.02f + 0.03f * unitDistribution(random));
+			}
+		}
+		scene.OccluderBoxes.push_back(LeviathanCore::BoundingVolumes::AABB{ LeviathanCore::MathTypes::Vector3(-40.0f, -400.0f, -20.0f),
+			LeviathanCore::MathTypes::Vector3(-38.0f, 400.0f, 900.0f) });
+
+		for (const LeviathanCore::BoundingVolumes::AABB& box : scene.OccluderBoxes)
+		{
+			scene.OcclusionCulling.CreateOccluder(MakeBoxOccluder(box));
+		}
+
+		std::uniform_real_distribution<float> depthDistribution(20.0f, 800.0f);
+		std::uniform_real_distribution<float> offsetDistribution(-1.0f, 1.0f);
+		const LeviathanCore::BoundingVolumes::AABB localBounds{ LeviathanCore::MathTypes::Vector3(-0.5f, -0.5f, -0.5f), LeviathanCore::MathTypes::Vector3(0.5f, 0.5f, 0.5f) };
+		while (scene.World.GetCount() < OccludeeCount)
+		{
+			const float z = depthDistribution(random);
+			LeviathanRenderer::RenderableDescription description = {};
+			description.Mesh.LocalBounds = localBounds;
+			description.Transform = LeviathanCore::MathTypes::Matrix4x4::Translation(LeviathanCore::MathTypes::Vector3(0.6f * z * offsetDistribution(random),
+				0.35f * z * offsetDistribution(random), z));
+
+			// Cubes are kept out of the walls.
+			const LeviathanCore::BoundingVolumes::AABB bounds = localBounds.Transformed(description.Transform);
+			if (std::none_of(scene.OccluderBoxes.begin(), scene.OccluderBoxes.end(), [&bounds](const LeviathanCore::BoundingVolumes::AABB& box) { return box.Intersects(bounds); }))
+			{
+				scene.World.Create(description);
+			}
+		}
+
+		scene.FrustumCulling.Cull(scene.Camera.GetFrustum(), scene.World.GetWorldBounds());
+	}
+
+	static void RunOcclusionStageBenchmarks(Harness& harness, const std::string_view threadingName, OcclusionScene& scene)
+	{
+		const LeviathanRenderer::OcclusionCullingStage& occlusion = scene.OcclusionCulling;
+		const std::string resolution = std::to_string(occlusion.GetWidth()) + "x" + std::to_string(occlusion.GetHeight());
+
+		const std::string renderName = "OcclusionCulling.RenderOccluders." + resolution + "." + std::string(threadingName);
+		if (harness.Run(renderName, occlusion.GetOccluderCount(), [&]()
+			{
+				scene.OcclusionCulling.RenderOccluders(scene.Camera);
+				Consume(occlusion.GetDepthBuffer());
+			}))
+		{
+			const size_t pixelCount = static_cast<size_t>(occlusion.GetWidth()) * occlusion.GetHeight();
+			const size_t coveredPixels = pixelCount - static_cast<size_t>(std::count(occlusion.GetDepthBuffer(), occlusion.GetDepthBuffer() + pixelCount, 0.0f));
+			harness.AddMetric(renderName, "occluders", static_cast<double>(occlusion.GetOccluderCount()));
+			harness.AddMetric(renderName, "occluderTriangles", static_cast<double>(occlusion.GetStats().OccluderTriangles));
+			harness.AddMetric(renderName, "rasterizedTriangles", static_cast<double>(occlusion.GetStats().RasterizedTriangles));
+			harness.AddMetric(renderName, "coveredPixelFraction", static_cast<double>(coveredPixels) / static_cast<double>(pixelCount));
+			harness.AddMetric(renderName, "threads", static_cast<double>(LeviathanCore::JobSystem::GetThreadCount()));
+		}
+
+		// Depth of the scene view for the object tests.
+		scene.OcclusionCulling.RenderOccluders(scene.Camera);
+		const size_t testedCount = scene.FrustumCulling.GetVisibleCount();
+		const std::string cullName = "OcclusionCulling.Cull." + std::to_string(testedCount) + "." + std::string(threadingName);
+		if (harness.Run(cullName, testedCount, [&]()
+			{
+				scene.OcclusionCulling.Cull(scene.World.GetWorldBounds(), scene.FrustumCulling.GetVisibleIndices(), testedCount);
+				Consume(occlusion.GetVisibleIndices());
+			}))
+		{
+			harness.AddMetric(cullName, "testedObjects", static_cast<double>(occlusion.GetStats().TestedObjects));
+			harness.AddMetric(cullName, "occludedObjects", static_cast<double>(occlusion.GetStats().OccludedObjects));
+			harness.AddMetric(cullName, "threads", static_cast<double>(LeviathanCore::JobSystem::GetThreadCount()));
+		}
+
+		// Draw list building with frustum culling only and with occlusion culling.
+		LeviathanRenderer::DrawList drawList = {};
+		const std::string frustumName = "OcclusionCulling.BuildDrawList.FrustumOnly." + std::string(threadingName);
+		if (harness.Run(frustumName, scene.World.GetCount(), [&]()
+			{
+				LeviathanRenderer::BuildDrawList(scene.World, scene.Camera, scene.FrustumCulling, drawList);
+				Consume(drawList.Renderables.data());
+			}))
+		{
+			harness.AddMetric(frustumName, "draws", static_cast<double>(drawList.GetCount()));
+		}
+
+		const std::string occlusionName = "OcclusionCulling.BuildDrawList.WithOcclusion." + std::string(threadingName);
+		if (harness.Run(occlusionName, scene.World.GetCount(), [&]()
+			{
+				LeviathanRenderer::BuildDrawList(scene.World, scene.Camera, scene.FrustumCulling, scene.OcclusionCulling, drawList);
+				Consume(drawList.Renderables.data());
+			}))
+		{
+			harness.AddMetric(occlusionName, "draws", static_cast<double>(drawList.GetCount()));
+		}
+	}
+
+	void RunOcclusionCullingBenchmarks(Harness& harness)
+	{
+		OcclusionScene scene = {};
+		MakeOcclusionScene(scene);
+
+		LeviathanTestFixtures::RunSingleThreadAndJobSystem(0, [&](const std::string_view threadingName)
+			{
+				RunOcclusionStageBenchmarks(harness, threadingName, scene);
+			});
+	}
+}
@@ -0,0 +1,209 @@
+#include "BenchmarkSuites.h"
+#include "Benchmark.h"
+#include "TestFixtures.h"
+#include "MathTypes.h"
+#include "BoundingVolumes.h"
+#include "JobSystem.h"
+#include "AssetTypes.h"
+#include "TriangleBVH.h"
+
+namespace LeviathanBenchmarks
+{
+	// 2 * 1000 * (500 - 1) = 998000 triangles.
+	static constexpr size_t MeshSectors = 1000;
+	static constexpr size_t MeshStacks = 500;
+	static constexpr size_t ImageWidth = 512;
+	static constexpr size_t ImageHeight = 256;
+	static constexpr float RayLength = 1000.0f;
+
+	// Sphere with a bumpy surface so that the hierarchy is not trivially regular.
+	static LeviathanAssets::AssetTypes::Mesh CreateBumpySphere()
+	{
+		LeviathanAssets::AssetTypes::Mesh mesh = {};
+		mesh.Positions.reserve((MeshSectors + 1) * (MeshStacks + 1));
+		for (size_t stack = 0; stack <= MeshStacks; ++stack)
+		{
+			const float theta = 3.14159265f * static_cast<float>(stack) / static_cast<float>(MeshStacks);
+			for (size_t sector = 0; sector <= MeshSectors; ++sector)
+			{
+				const float phi = 6.28318531f * static_cast<float>(sector) / static_cast<float>(MeshSectors);
+				const float radius = 10.0f + (0.5f * std::sin(8.0f * theta) * std::cos(6.0f * phi)) + (0.2f * std::sin((23.0f * theta) + (11.0f * phi)));
+				mesh.Positions.emplace_back(radius * std::sin(theta) * std::cos(phi), radius * std::cos(theta), radius * std::sin(theta) * std::sin(phi));
+			}
+		}
+
+		for (size_t stack = 0; stack < MeshStacks; ++stack)
+		{
+			for (size_t sector = 0; sector < MeshSectors; ++sector)
+			{
+				const uint32_t a = static_cast<uint32_t>((stack * (MeshSectors + 1)) + sector);
+				const uint32_t b = a + static_cast<uint32_t>(MeshSectors + 1);
+				// The first and last stacks have one triangle per sector.
+				if (stack != 0)
+				{
+					mesh.Indices.insert(mesh.Indices.end(), { a, b, a + 1 });
+				}
+				if (stack != MeshStacks - 1)
+				{
+					mesh.Indices.insert(mesh.Indices.end(), { a + 1, b, b + 1 });
+				}
+			}
+		}
+
+		mesh.CalculateBounds();
+		return mesh;
+	}
+
+	// Pinhole camera rays ordered in 2x2 pixel quads so that each packet of 4 rays is coherent.
+	static std::vector<LeviathanCore::BoundingVolumes::Ray> CreatePrimaryRays()
+	{
+		std::vector<LeviathanCore::BoundingVolumes::Ray> rays = {};
+		rays.reserve(ImageWidth * ImageHeight);
+		const LeviathanCore::MathTypes::Vector3 origin(0.0f, 3.0f, -30.0f);
+		const float aspectRatio = static_cast<float>(ImageWidth) / static_cast<float>(ImageHeight);
+		for (size_t y = 0; y < ImageHeight; y += 2)
+		{
+			for (size_t x = 0; x < ImageWidth; x += 2)
+			{
+				for (size_t quad = 0; quad < 4; ++quad)
+				{
+					const float u = ((static_cast<float>(x + (quad & 1)) + 0.5f) / static_cast<float>(ImageWidth)) * 2.0f - 1.0f;
+					const float v = ((static_cast<float>(y + (quad >> 1)) + 0.5f) / static_cast<float>(ImageHeight)) * 2.0f - 1.0f;
+					const LeviathanCore::MathTypes::Vector3 direction(u * aspectRatio * 0.5f, (v * 0.5f) - 0.1f, 1.0f);
+					rays.push_back(LeviathanCore::BoundingVolumes::Ray{ origin, direction.AsNormalizedSafe() });
+				}
+			}
+		}
+		return rays;
+	}
+
+	// Random origins around the mesh with random directions.
+	static std::vector<LeviathanCore::BoundingVolumes::Ray> CreateIncoherentRays(const size_t count)
+	{
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> originDistribution(-15.0f, 15.0f);
+		std::uniform_real_distribution<float> directionDistribution(-1.0f, 1.0f);
+
+		std::vector<LeviathanCore::BoundingVolumes::Ray> rays(count);
+		for (LeviathanCore::BoundingVolumes::Ray& ray : rays)
+		{
+			ray.Origin = LeviathanCore::MathTypes::Vector3(originDistribution(random), originDistribution(random), originDistribution(random));
+			ray.Direction = LeviathanCore::MathTypes::Vector3(directionDistribution(random), directionDistribution(random), directionDistribution(random)).AsNormalizedSafe();
+		}
+		return rays;
+	}
+
+	static void AddRaysPerSecondMetric(Harness& harness, const BenchmarkResult* const result, const size_t rayCount)
+	{
+		if ((result != nullptr) && (result->MedianNanoseconds > 0.0))
+		{
+			harness.AddMetric(result->Name, "MraysPerSecond", (static_cast<double>(rayCount) * 1e3) / result->MedianNanoseconds);
+		}
+	}
+
+	static void RunRayQueryBenchmarks(Harness& harness, const std::string_view raysName, const LeviathanAssets::TriangleBVH& bvh,
+		const std::vector<LeviathanCore::BoundingVolumes::Ray>& rays)
+	{
+		std::vector<LeviathanAssets::TriangleBVH::Hit> singleHits(rays.size());
+		const std::string intersectName = "TriangleBVH.Intersect." + std::string(raysName);
+		const BenchmarkResult* result = harness.Run(intersectName, rays.size(), [&]()
+			{
+				for (size_t i = 0; i < rays.size(); ++i)
+				{
+					bvh.Intersect(rays[i], RayLength, singleHits[i]);
+				}
+				Consume(singleHits.data());
+			});
+		if (result != nullptr)
+		{
+			AddRaysPerSecondMetric(harness, result, rays.size());
+
+			double hitCount = 0.0;
+			for (const LeviathanAssets::TriangleBVH::Hit& hit : singleHits)
+			{
+				hitCount += (hit.TriangleIndex != LeviathanAssets::TriangleBVH::InvalidTriangleIndex) ? 1.0 : 0.0;
+			}
+			harness.AddMetric(intersectName, "hits", hitCount);
+		}
+
+		std::vector<LeviathanAssets::TriangleBVH::Hit> packetHits(rays.size());
+		const std::string packetName = "TriangleBVH.IntersectPacket." + std::string(raysName);
+		result = harness.Run(packetName, rays.size(), [&]()
+			{
+				bvh.IntersectPacket(rays.data(), rays.size(), RayLength, packetHits.data());
+				Consume(packetHits.data());
+			});
+		if (result != nullptr)
+		{
+			AddRaysPerSecondMetric(harness, result, rays.size());
+		}
+
+		std::vector<uint8_t> anyHits(rays.size(), 0);
+		const std::string anyName = "TriangleBVH.IntersectAny." + std::string(raysName);
+		result = harness.Run(anyName, rays.size(), [&]()
+			{
+				for (size_t i = 0; i < rays.size(); ++i)
+				{
+					anyHits[i] = bvh.IntersectAny(rays[i], RayLength) ? 1 : 0;
+				}
+				Consume(anyHits.data());
+			});
+		if (result != nullptr)
+		{
+			AddRaysPerSecondMetric(harness, result, rays.size());
+		}
+
+		std::vector<uint8_t> anyPacketHits(rays.size(), 0);
+		const std::string anyPacketName = "TriangleBVH.IntersectAnyPacket." + std::string(raysName);
+		result = harness.Run(anyPacketName, rays.size(), [&]()
+			{
+				bvh.IntersectAnyPacket(rays.data(), rays.size(), RayLength, anyPacketHits.data());
+				Consume(anyPacketHits.data());
+			});
+		if (result != nullptr)
+		{
+			AddRaysPerSecondMetric(harness, result, rays.size());
+		}
+	}
+
+	static void RunBuildBenchmark(Harness& harness, const std::string_view threadingName, const LeviathanAssets::AssetTypes::Mesh& mesh, LeviathanAssets::TriangleBVH& bvh)
+	{
+		const size_t triangleCount = mesh.Indices.size() / 3;
+		const std::string name = "TriangleBVH.Build.1MTriangles." + std::string(threadingName);
+		const BenchmarkResult* const result = harness.Run(name, triangleCount, [&]()
+			{
+				bvh.Build(mesh);
+				Consume(&bvh);
+			});
+		if (result != nullptr)
+		{
+			harness.AddMetric(name, "milliseconds", result->MedianNanoseconds * 1e-6);
+			harness.AddMetric(name, "triangles", static_cast<double>(bvh.GetTriangleCount()));
+			harness.AddMetric(name, "nodes", static_cast<double>(bvh.GetNodeCount()));
+			harness.AddMetric(name, "depth", static_cast<double>(bvh.GetDepth()));
+			harness.AddMetric(name, "threads", static_cast<double>(LeviathanCore::JobSystem::GetThreadCount()));
+		}
+	}
+
+	void RunRayTracingBenchmarks(Harness& harness)
+	{
+		const LeviathanAssets::AssetTypes::Mesh mesh = CreateBumpySphere();
+		LeviathanAssets::TriangleBVH bvh = {};
+
+		LeviathanTestFixtures::RunSingleThreadAndJobSystem(0, [&](const std::string_view threadingName)
+			{
+				RunBuildBenchmark(harness, threadingName, mesh, bvh);
+			});
+
+		if (bvh.IsEmpty())
+		{
+			bvh.Build(mesh);
+		}
+
+		const std::vector<LeviathanCore::BoundingVolumes::Ray> primaryRays = CreatePrimaryRays();
+		RunRayQueryBenchmarks(harness, "Primary", bvh, primaryRays);
+
+		const std::vector<LeviathanCore::BoundingVolumes::Ray> incoherentRays = CreateIncoherentRays(primaryRays.size());
+		RunRayQueryBenchmarks(harness, "Incoherent", bvh, incoherentRays);
+	}
+}
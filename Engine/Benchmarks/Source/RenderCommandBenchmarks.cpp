@@ -0,0 +1,376 @@
+#include "BenchmarkSuites.h"
+#include "Benchmark.h"
+#include "TestFixtures.h"
+#include "JobSystem.h"
+#include "RenderCommands.h"
+#include "RenderStateFilter.h"
+#include "RendererConstants.h"
+
+namespace LeviathanBenchmarks
+{
+	namespace RenderCommands = LeviathanRenderer::RenderCommands;
+
+	static constexpr size_t DrawCount = 100000;
+	static constexpr size_t RecordChunkSize = 1024;
+	static constexpr size_t MaterialCount = 64;
+
+	struct Draw
+	{
+		uint64_t SortKey = 0;
+		LeviathanRenderer::RendererResourceId::IdType ColorTexture = LeviathanRenderer::RendererResourceId::InvalidId;
+		LeviathanRenderer::RendererResourceId::IdType NormalTexture = LeviathanRenderer::RendererResourceId::InvalidId;
+		LeviathanRenderer::RendererResourceId::IdType VertexBuffer = LeviathanRenderer::RendererResourceId::InvalidId;
+		LeviathanRenderer::RendererResourceId::IdType IndexBuffer = LeviathanRenderer::RendererResourceId::InvalidId;
+		uint32_t IndexCount = 0;
+		// Same size as the object constant buffer.
+		std::array<float, 48> ObjectData = {};
+	};
+
+	// Backend that only accumulates its arguments so that execution cost is the decoding cost.
+	struct CountingBackend
+	{
+		uint64_t CallCount = 0;
+		uint64_t Checksum = 0;
+
+		void ClearRenderTarget(RenderCommands::RenderTarget, const float*) { ++CallCount; }
+		void ClearDepthStencil(float, uint8_t) { ++CallCount; }
+		void SetRenderTarget(RenderCommands::RenderTarget) { ++CallCount; }
+		void SetPipeline(RenderCommands::Pipeline, uint32_t) { ++CallCount; }
+		void SetSkyboxPipeline(LeviathanRenderer::RendererResourceId::IdType, LeviathanRenderer::RendererResourceId::IdType) { ++CallCount; }
+		void SetBlendState(RenderCommands::BlendState) { ++CallCount; }
+		void SetDepthStencilState(RenderCommands::DepthStencilState) { ++CallCount; }
+		void SetTexture(RenderCommands::TextureSlot, const LeviathanRenderer::RendererResourceId::IdType textureId) { ++CallCount; Checksum += textureId; }
+		void SetSampler(RenderCommands::TextureSlot, const LeviathanRenderer::RendererResourceId::IdType samplerId) { ++CallCount; Checksum += samplerId; }
+		void UpdateConstantBuffer(RenderCommands::ConstantBuffer, const void* data, uint32_t) { ++CallCount; Checksum += *static_cast<const uint32_t*>(data); }
+		void SetConstantBufferRange(RenderCommands::ConstantBuffer, const uint32_t offset, uint32_t) { ++CallCount; Checksum += offset; }
+		void DrawIndexed(const uint32_t indexCount, uint32_t, LeviathanRenderer::RendererResourceId::IdType, LeviathanRenderer::RendererResourceId::IdType) { ++CallCount; Checksum += indexCount; }
+		void DrawIndexedInstanced(const uint32_t indexCount, uint32_t, LeviathanRenderer::RendererResourceId::IdType, LeviathanRenderer::RendererResourceId::IdType,
+			const uint32_t instanceCount, uint32_t) { ++CallCount; Checksum += indexCount * instanceCount; }
+		void UnbindShaderResources() { ++CallCount; }
+	};
+
+	// Draws with unique sort keys grouped by material. The depth field holds the draw index so that sorted order does not depend on how draws are split
+	// across threads.
+	static std::vector<Draw> CreateDraws()
+	{
+		std::mt19937 random(2468);
+		std::uniform_int_distribution<uint32_t> materialDistribution(1, MaterialCount);
+		std::uniform_int_distribution<uint32_t> indexCountDistribution(36, 30000);
+		std::uniform_real_distribution<float> dataDistribution(-1.0f, 1.0f);
+
+		std::vector<Draw> draws(DrawCount);
+		for (size_t i = 0; i < draws.size(); ++i)
+		{
+			Draw& draw = draws[i];
+			const uint32_t material = materialDistribution(random);
+			draw.SortKey = RenderCommands::MakeSortKey(1, static_cast<uint8_t>(RenderCommands::Pipeline::AmbientLight), material, static_cast<uint32_t>(draws.size() - i));
+			draw.ColorTexture = material * 2;
+			draw.NormalTexture = material * 2 + 1;
+			draw.VertexBuffer = 1000 + (i % 97);
+			draw.IndexBuffer = 2000 + (i % 97);
+			draw.IndexCount = indexCountDistribution(random);
+			for (float& value : draw.ObjectData)
+			{
+				value = dataDistribution(random);
+			}
+		}
+		return draws;
+	}
+
+	static void RecordDraw(RenderCommands::CommandBuffer& commands, const Draw& draw)
+	{
+		commands.BeginPacket(draw.SortKey);
+		commands.SetTexture(RenderCommands::TextureSlot::Color, draw.ColorTexture);
+		commands.SetTexture(RenderCommands::TextureSlot::Normal, draw.NormalTexture);
+		commands.SetSampler(RenderCommands::TextureSlot::Color, 1);
+		commands.UpdateConstantBuffer(RenderCommands::ConstantBuffer::Object, draw.ObjectData.data(), static_cast<uint32_t>(sizeof(draw.ObjectData)));
+		commands.DrawIndexed(draw.IndexCount, 44, draw.VertexBuffer, draw.IndexBuffer);
+	}
+
+	// Records the draws into the buffers of the job system threads.
+	static void RecordDraws(RenderCommands::CommandQueue& queue, const std::vector<Draw>& draws)
+	{
+		queue.Reset(LeviathanCore::JobSystem::GetThreadCount());
+		LeviathanCore::JobSystem::ParallelFor(draws.size(), RecordChunkSize, [&queue, &draws](const size_t first, const size_t count, const size_t threadIndex)
+			{
+				RenderCommands::CommandBuffer& commands = queue.GetBuffer(threadIndex);
+				for (size_t i = first; i < first + count; ++i)
+				{
+					RecordDraw(commands, draws[i]);
+				}
+			});
+	}
+
+	static void RunCommandQueueBenchmarks(Harness& harness, const std::string_view threadingName, const std::vector<Draw>& draws)
+	{
+		RenderCommands::CommandQueue queue = {};
+
+		const std::string recordName = "RenderCommands.Record.100kDraws." + std::string(threadingName);
+		const BenchmarkResult* const recordResult = harness.Run(recordName, draws.size(), [&]()
+			{
+				RecordDraws(queue, draws);
+				Consume(&queue);
+			});
+		if (recordResult != nullptr)
+		{
+			size_t sizeBytes = 0;
+			for (size_t i = 0; i < queue.GetBufferCount(); ++i)
+			{
+				sizeBytes += queue.GetBuffer(i).GetSizeBytes();
+			}
+			harness.AddMetric(recordName, "bytesPerDraw", static_cast<double>(sizeBytes) / static_cast<double>(draws.size()));
+			harness.AddMetric(recordName, "threads", static_cast<double>(LeviathanCore::JobSystem::GetThreadCount()));
+		}
+
+		RecordDraws(queue, draws);
+
+		const std::string sortName = "RenderCommands.Sort.100kDraws." + std::string(threadingName);
+		const BenchmarkResult* const sortResult = harness.Run(sortName, draws.size(), [&]()
+			{
+				queue.Sort();
+				Consume(&queue);
+			});
+		if (sortResult != nullptr)
+		{
+			harness.AddMetric(sortName, "packets", static_cast<double>(queue.GetSortedPackets().size()));
+		}
+
+		queue.Sort();
+
+		const std::string executeName = "RenderCommands.Execute.100kDraws." + std::string(threadingName);
+		CountingBackend countingBackend = {};
+		const BenchmarkResult* const executeResult = harness.Run(executeName, draws.size(), [&]()
+			{
+				countingBackend = {};
+				queue.Execute(countingBackend);
+				Consume(&countingBackend);
+			});
+		if (executeResult != nullptr)
+		{
+			harness.AddMetric(executeName, "callsPerDraw", static_cast<double>(countingBackend.CallCount) / static_cast<double>(draws.size()));
+
+		}
+	}
+
+	// Lighting frames recorded the same way as LeviathanRenderer::Render with every object drawn once per light.
+	static constexpr size_t FrameObjectCount = 64;
+	static constexpr size_t FrameMaterialCount = 8;
+	static constexpr size_t FrameDirectionalLightCount = 2;
+	static constexpr size_t FramePointLightCount = 16;
+	static constexpr size_t FrameSpotLightCount = 16;
+	static constexpr size_t RandomStreamCommandCount = 100000;
+
+	static void RecordLightingFrame(RenderCommands::CommandBuffer& commands, const std::vector<Draw>& objects)
+	{
+		static constexpr float clearColor[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		static constexpr LeviathanRenderer::RendererResourceId::IdType skyboxTexture = 900;
+		static constexpr LeviathanRenderer::RendererResourceId::IdType skyboxSampler = 901;
+		static constexpr LeviathanRenderer::RendererResourceId::IdType materialSampler = 902;
+
+		// Lighting pipelines are set per draw after the material's textures with the material's permutation as by the renderer.
+		const auto recordObjectLightingDraw = [&commands](const RenderCommands::Pipeline pipeline, const Draw& object)
+			{
+				const bool normalMapping = (object.NormalTexture != LeviathanRenderer::RendererResourceId::InvalidId);
+				commands.SetTexture(RenderCommands::TextureSlot::Color, object.ColorTexture);
+				commands.SetTexture(RenderCommands::TextureSlot::Metallic, object.ColorTexture + 1000);
+				commands.SetTexture(RenderCommands::TextureSlot::Roughness, object.ColorTexture + 2000);
+				commands.SetSampler(RenderCommands::TextureSlot::Color, materialSampler);
+				commands.SetSampler(RenderCommands::TextureSlot::Roughness, materialSampler);
+				commands.SetSampler(RenderCommands::TextureSlot::Metallic, materialSampler);
+				if (normalMapping)
+				{
+					commands.SetTexture(RenderCommands::TextureSlot::Normal, object.NormalTexture);
+					commands.SetSampler(RenderCommands::TextureSlot::Normal, materialSampler);
+				}
+				commands.SetPipeline(pipeline, normalMapping ? LeviathanRenderer::RendererConstants::NormalMappedLightingPermutation : 0);
+				commands.UpdateConstantBuffer(RenderCommands::ConstantBuffer::Object, object.ObjectData.data(), static_cast<uint32_t>(sizeof(object.ObjectData)));
+				commands.DrawIndexed(object.IndexCount, 44, object.VertexBuffer, object.IndexBuffer);
+			};
+
+		const auto recordLightPass = [&](const uint8_t pass, const RenderCommands::Pipeline pipeline, const RenderCommands::ConstantBuffer lightBuffer,
+			const size_t lightCount)
+			{
+				commands.BeginPacket(RenderCommands::MakeSortKey(pass, 0, 0, 0));
+				commands.SetDepthStencilState(RenderCommands::DepthStencilState::NoWriteDepthDepthFuncEqual);
+				commands.SetBlendState(RenderCommands::BlendState::Additive);
+				for (size_t light = 0; light < lightCount; ++light)
+				{
+					std::array<float, 16> lightData = {};
+					lightData[0] = static_cast<float>(light);
+					lightData[1] = static_cast<float>(pass);
+					commands.UpdateConstantBuffer(lightBuffer, lightData.data(), static_cast<uint32_t>(sizeof(lightData)));
+					for (const Draw& object : objects)
+					{
+						recordObjectLightingDraw(pipeline, object);
+					}
+				}
+			};
+
+		commands.Reset();
+		commands.BeginPacket(RenderCommands::MakeSortKey(0, 0, 0, 0));
+		commands.ClearRenderTarget(RenderCommands::RenderTarget::Screen, clearColor);
+		commands.ClearRenderTarget(RenderCommands::RenderTarget::Scene, clearColor);
+		commands.ClearDepthStencil(1.0f, 0);
+		commands.SetRenderTarget(RenderCommands::RenderTarget::Scene);
+
+		commands.BeginPacket(RenderCommands::MakeSortKey(1, 0, 0, 0));
+		commands.SetBlendState(RenderCommands::BlendState::Disabled);
+		commands.SetDepthStencilState(RenderCommands::DepthStencilState::WriteDepthDepthFuncLess);
+		commands.SetPipeline(RenderCommands::Pipeline::AmbientLight);
+		for (const Draw& object : objects)
+		{
+			commands.SetTexture(RenderCommands::TextureSlot::Environment, skyboxTexture);
+			commands.SetSampler(RenderCommands::TextureSlot::Environment, skyboxSampler);
+			commands.SetTexture(RenderCommands::TextureSlot::Color, object.ColorTexture);
+			commands.SetSampler(RenderCommands::TextureSlot::Color, materialSampler);
+			commands.UpdateConstantBuffer(RenderCommands::ConstantBuffer::Object, object.ObjectData.data(), static_cast<uint32_t>(sizeof(object.ObjectData)));
+			commands.DrawIndexed(object.IndexCount, 44, object.VertexBuffer, object.IndexBuffer);
+		}
+
+		recordLightPass(2, RenderCommands::Pipeline::DirectionalLight, RenderCommands::ConstantBuffer::DirectionalLight, FrameDirectionalLightCount);
+		recordLightPass(3, RenderCommands::Pipeline::PointLight, RenderCommands::ConstantBuffer::PointLight, FramePointLightCount);
+		recordLightPass(4, RenderCommands::Pipeline::SpotLight, RenderCommands::ConstantBuffer::SpotLight, FrameSpotLightCount);
+
+		commands.BeginPacket(RenderCommands::MakeSortKey(5, 0, 0, 0));
+		commands.SetBlendState(RenderCommands::BlendState::Disabled);
+		commands.SetDepthStencilState(RenderCommands::DepthStencilState::WriteDepthDepthFuncLessEqual);
+		commands.SetSkyboxPipeline(skyboxTexture, skyboxSampler);
+		std::array<float, 16> skyboxData = {};
+		commands.UpdateConstantBuffer(RenderCommands::ConstantBuffer::Skybox, skyboxData.data(), static_cast<uint32_t>(sizeof(skyboxData)));
+		commands.DrawIndexed(36, 12, 800, 801);
+
+		commands.BeginPacket(RenderCommands::MakeSortKey(6, 0, 0, 0));
+		commands.SetBlendState(RenderCommands::BlendState::Disabled);
+		commands.SetDepthStencilState(RenderCommands::DepthStencilState::Disabled);
+		commands.SetRenderTarget(RenderCommands::RenderTarget::Screen);
+		commands.SetPipeline(RenderCommands::Pipeline::PostProcess);
+		commands.DrawIndexed(6, 16, 802, 803);
+		commands.UnbindShaderResources();
+	}
+
+	// Random command stream over few distinct values so that most state changes are redundant.
+	static void RecordRandomStream(RenderCommands::CommandBuffer& commands, std::mt19937& random)
+	{
+		std::uniform_int_distribution<uint32_t> commandDistribution(0, static_cast<uint32_t>(RenderCommands::CommandTypeCount) - 1);
+		std::uniform_int_distribution<uint32_t> valueDistribution(0, 2);
+		std::array<float, 4> data = {};
+
+		commands.Reset();
+		for (size_t i = 0; i < RandomStreamCommandCount; ++i)
+		{
+			const uint32_t value = valueDistribution(random);
+			switch (static_cast<RenderCommands::CommandType>(commandDistribution(random)))
+			{
+			case RenderCommands::CommandType::ClearRenderTarget: commands.ClearRenderTarget(RenderCommands::RenderTarget::Scene, data.data()); break;
+			case RenderCommands::CommandType::ClearDepthStencil: commands.ClearDepthStencil(1.0f, 0); break;
+			case RenderCommands::CommandType::SetRenderTarget: commands.SetRenderTarget(static_cast<RenderCommands::RenderTarget>(value % 2)); break;
+			case RenderCommands::CommandType::SetPipeline: commands.SetPipeline(static_cast<RenderCommands::Pipeline>(value), value % 2); break;
+			case RenderCommands::CommandType::SetSkyboxPipeline: commands.SetSkyboxPipeline(10 + value, 20 + (value % 2)); break;
+			case RenderCommands::CommandType::SetBlendState: commands.SetBlendState(static_cast<RenderCommands::BlendState>(value % 2)); break;
+			case RenderCommands::CommandType::SetDepthStencilState: commands.SetDepthStencilState(static_cast<RenderCommands::DepthStencilState>(value)); break;
+			case RenderCommands::CommandType::SetTexture: commands.SetTexture(static_cast<RenderCommands::TextureSlot>(value), 30 + (value + i) % 3); break;
+			case RenderCommands::CommandType::SetSampler: commands.SetSampler(static_cast<RenderCommands::TextureSlot>(value), 40 + (i % 2)); break;
+			case RenderCommands::CommandType::UpdateConstantBuffer:
+				data[0] = static_cast<float>(value);
+				commands.UpdateConstantBuffer(static_cast<RenderCommands::ConstantBuffer>(i % RenderCommands::ConstantBufferCount), data.data(),
+					static_cast<uint32_t>(sizeof(data)));
+				break;
+			case RenderCommands::CommandType::SetConstantBufferRange:
+				commands.SetConstantBufferRange(static_cast<RenderCommands::ConstantBuffer>(i % RenderCommands::ConstantBufferCount), 256 * value, 64);
+				break;
+			case RenderCommands::CommandType::DrawIndexed: commands.DrawIndexed(36, 12, 50 + value, 60 + value); break;
+			case RenderCommands::CommandType::DrawIndexedInstanced: commands.DrawIndexedInstanced(36, 12, 50 + value, 60 + value, 1 + value, static_cast<uint32_t>(i)); break;
+			case RenderCommands::CommandType::UnbindShaderResources: commands.UnbindShaderResources(); break;
+			}
+		}
+	}
+
+	static void RunLightingFrameBenchmarks(Harness& harness, const std::string_view objectsName, const std::vector<Draw>& draws, const size_t objectCount)
+	{
+		// Objects of the lighting frame drawn in material order as they would be after sorting.
+		std::vector<Draw> objects(draws.begin(), draws.begin() + objectCount);
+		for (size_t i = 0; i < objects.size(); ++i)
+		{
+			objects[i].ColorTexture = 2 * (1 + (i * FrameMaterialCount) / objects.size());
+			// Every fourth material has no normal texture and draws with the lighting permutation without normal mapping.
+			objects[i].NormalTexture = ((objects[i].ColorTexture % 8) == 0) ? LeviathanRenderer::RendererResourceId::InvalidId : objects[i].ColorTexture + 1;
+		}
+		RenderCommands::CommandBuffer frame = {};
+		RecordLightingFrame(frame, objects);
+		const size_t frameDrawCount = objectCount * (1 + FrameDirectionalLightCount + FramePointLightCount + FrameSpotLightCount) + 2;
+
+		const std::string unfilteredName = "RenderCommands.Execute.LightingFrame." + std::string(objectsName) + ".Unfiltered";
+		CountingBackend unfilteredBackend = {};
+		harness.Run(unfilteredName, frameDrawCount, [&]()
+			{
+				unfilteredBackend = {};
+				frame.Execute(unfilteredBackend);
+				Consume(&unfilteredBackend);
+			});
+
+		const std::string filteredName = "RenderCommands.Execute.LightingFrame." + std::string(objectsName) + ".StateFiltered";
+		RenderCommands::StateFilterStats filteredStats = {};
+		const BenchmarkResult* const filteredResult = harness.Run(filteredName, frameDrawCount, [&]()
+			{
+				CountingBackend countingBackend = {};
+				RenderCommands::StateFilteringBackend<CountingBackend> filteringBackend(countingBackend);
+				frame.Execute(filteringBackend);
+				filteredStats = filteringBackend.GetStats();
+				Consume(&countingBackend);
+			});
+		if (filteredResult != nullptr)
+		{
+			unfilteredBackend = {};
+			frame.Execute(unfilteredBackend);
+			harness.AddMetric(filteredName, "unfilteredCalls", static_cast<double>(unfilteredBackend.CallCount));
+			harness.AddMetric(filteredName, "issuedCalls", static_cast<double>(filteredStats.GetIssuedCallCount()));
+			harness.AddMetric(filteredName, "elidedCalls", static_cast<double>(filteredStats.GetElidedCallCount()));
+			harness.AddMetric(filteredName, "elidedTextureSets", static_cast<double>(filteredStats.ElidedCalls[static_cast<size_t>(RenderCommands::CommandType::SetTexture)]));
+			harness.AddMetric(filteredName, "elidedSamplerSets", static_cast<double>(filteredStats.ElidedCalls[static_cast<size_t>(RenderCommands::CommandType::SetSampler)]));
+			harness.AddMetric(filteredName, "elidedConstantBufferUpdates",
+				static_cast<double>(filteredStats.ElidedCalls[static_cast<size_t>(RenderCommands::CommandType::UpdateConstantBuffer)]));
+
+		}
+	}
+
+	static void RunStateFilterBenchmarks(Harness& harness, const std::vector<Draw>& draws)
+	{
+		// A single object matches the scene LeviathanRenderer::Render currently draws.
+		RunLightingFrameBenchmarks(harness, "1Object", draws, 1);
+		RunLightingFrameBenchmarks(harness, "64Objects", draws, FrameObjectCount);
+
+		// Random stream with frequent redundant and interleaved state changes.
+		std::mt19937 random(97531);
+		RenderCommands::CommandBuffer randomStream = {};
+		RecordRandomStream(randomStream, random);
+
+		const std::string randomName = "RenderCommands.Execute.RandomStream.StateFiltered";
+		RenderCommands::StateFilterStats randomStats = {};
+		const BenchmarkResult* const randomResult = harness.Run(randomName, RandomStreamCommandCount, [&]()
+			{
+				CountingBackend countingBackend = {};
+				RenderCommands::StateFilteringBackend<CountingBackend> filteringBackend(countingBackend);
+				randomStream.Execute(filteringBackend);
+				randomStats = filteringBackend.GetStats();
+				Consume(&countingBackend);
+			});
+		if (randomResult != nullptr)
+		{
+			harness.AddMetric(randomName, "draws", static_cast<double>(randomStats.IssuedCalls[static_cast<size_t>(RenderCommands::CommandType::DrawIndexed)] +
+				randomStats.IssuedCalls[static_cast<size_t>(RenderCommands::CommandType::DrawIndexedInstanced)]));
+			harness.AddMetric(randomName, "elidedCalls", static_cast<double>(randomStats.GetElidedCallCount()));
+		}
+	}
+
+	void RunRenderCommandBenchmarks(Harness& harness)
+	{
+		const std::vector<Draw> draws = CreateDraws();
+
+		LeviathanTestFixtures::RunSingleThreadAndJobSystem(0, [&](const std::string_view threadingName)
+			{
+				RunCommandQueueBenchmarks(harness, threadingName, draws);
+			});
+
+		RunStateFilterBenchmarks(harness, draws);
+	}
+}
@@ -0,0 +1,270 @@
+#include "BenchmarkSuites.h"
+#include "Benchmark.h"
+#include "RenderGraph.h"
+
+namespace LeviathanBenchmarks
+{
+	static constexpr uint32_t FrameWidth = 1920;
+	static constexpr uint32_t FrameHeight = 1080;
+	static constexpr size_t ShadowCascadeCount = 4;
+	static constexpr size_t HierarchicalDepthLevelCount = 8;
+	static constexpr size_t TransparentPassCount = 37;
+	static constexpr size_t BloomLevelCount = 6;
+	static constexpr size_t ExposureLevelCount = 6;
+	static constexpr size_t DebugViewCount = 12;
+
+	// Declares a deferred frame of 100 passes: shadow cascades, depth prepass, g-buffer, hierarchical depth, ambient occlusion, lighting,
+	// transparent passes blending into the lit scene, volumetric fog, reflections, bloom, temporal anti-aliasing, motion blur, depth of field,
+	// exposure, tone mapping, anti-aliasing and ui into the imported back buffer. Debug views write textures nothing reads and are culled.
+	static void DeclareDeferredFrame(LeviathanRenderer::RenderGraph& graph)
+	{
+		using LeviathanRenderer::RenderGraphFormat;
+		using LeviathanRenderer::RenderGraphTextureDescription;
+		using ResourceHandle = LeviathanRenderer::RenderGraph::ResourceHandle;
+
+		const auto texture = [&graph](const uint32_t width, const uint32_t height, const RenderGraphFormat format)
+			{
+				return graph.CreateTexture(RenderGraphTextureDescription{ std::max(width, 1u), std::max(height, 1u), format });
+			};
+
+		graph.Reset();
+		const ResourceHandle backBuffer = graph.ImportTexture(RenderGraphTextureDescription{ FrameWidth, FrameHeight, RenderGraphFormat::R8G8B8A8Unorm });
+		const ResourceHandle history = graph.ImportTexture(RenderGraphTextureDescription{ FrameWidth, FrameHeight, RenderGraphFormat::R16G16B16A16Float });
+		graph.MarkOutput(backBuffer);
+		graph.MarkOutput(history);
+
+		std::array<ResourceHandle, ShadowCascadeCount> shadowMaps = {};
+		for (size_t cascade = 0; cascade < ShadowCascadeCount; ++cascade)
+		{
+			shadowMaps[cascade] = texture(2048, 2048, RenderGraphFormat::D24UnormS8Uint);
+			graph.AddPass();
+			graph.Write(shadowMaps[cascade]);
+		}
+
+		const ResourceHandle depth = texture(FrameWidth, FrameHeight, RenderGraphFormat::D24UnormS8Uint);
+		graph.AddPass();
+		graph.Write(depth);
+
+		const ResourceHandle albedo = texture(FrameWidth, FrameHeight, RenderGraphFormat::R8G8B8A8Unorm);
+		const ResourceHandle normals = texture(FrameWidth, FrameHeight, RenderGraphFormat::R16G16B16A16Float);
+		const ResourceHandle material = texture(FrameWidth, FrameHeight, RenderGraphFormat::R8G8B8A8Unorm);
+		const ResourceHandle velocity = texture(FrameWidth, FrameHeight, RenderGraphFormat::R16G16B16A16Float);
+		graph.AddPass();
+		graph.Read(depth);
+		graph.Write(depth);
+		graph.Write(albedo);
+		graph.Write(normals);
+		graph.Write(material);
+		graph.Write(velocity);
+
+		std::array<ResourceHandle, HierarchicalDepthLevelCount> depthLevels = {};
+		for (size_t level = 0; level < HierarchicalDepthLevelCount; ++level)
+		{
+			depthLevels[level] = texture((FrameWidth / 2) >> level, (FrameHeight / 2) >> level, RenderGraphFormat::R32Float);
+			graph.AddPass();
+			graph.Read((level == 0) ? depth : depthLevels[level - 1]);
+			graph.Write(depthLevels[level]);
+		}
+
+		const ResourceHandle occlusion = texture(FrameWidth, FrameHeight, RenderGraphFormat::R8Unorm);
+		const ResourceHandle occlusionBlurX = texture(FrameWidth, FrameHeight, RenderGraphFormat::R8Unorm);
+		const ResourceHandle occlusionBlurred = texture(FrameWidth, FrameHeight, RenderGraphFormat::R8Unorm);
+		graph.AddPass();
+		graph.Read(depthLevels[0]);
+		graph.Read(normals);
+		graph.Write(occlusion);
+		graph.AddPass();
+		graph.Read(occlusion);
+		graph.Write(occlusionBlurX);
+		graph.AddPass();
+		graph.Read(occlusionBlurX);
+		graph.Write(occlusionBlurred);
+
+		const ResourceHandle scene = texture(FrameWidth, FrameHeight, RenderGraphFormat::R16G16B16A16Float);
+		graph.AddPass();
+		graph.Read(depth);
+		graph.Read(albedo);
+		graph.Read(normals);
+		graph.Read(material);
+		graph.Read(occlusionBlurred);
+		for (const ResourceHandle shadowMap : shadowMaps)
+		{
+			graph.Read(shadowMap);
+		}
+		graph.Write(scene);
+
+		for (size_t pass = 0; pass < TransparentPassCount; ++pass)
+		{
+			graph.AddPass();
+			graph.Read(depth);
+			graph.Read(scene);
+			graph.Write(scene);
+		}
+
+		const ResourceHandle froxels = texture(160, 90 * 64, RenderGraphFormat::R16G16B16A16Float);
+		const ResourceHandle integratedFroxels = texture(160, 90 * 64, RenderGraphFormat::R16G16B16A16Float);
+		graph.AddPass();
+		graph.Read(shadowMaps[0]);
+		graph.Write(froxels);
+		graph.AddPass();
+		graph.Read(froxels);
+		graph.Write(integratedFroxels);
+		graph.AddPass();
+		graph.Read(integratedFroxels);
+		graph.Read(depth);
+		graph.Read(scene);
+		graph.Write(scene);
+
+		const ResourceHandle reflections = texture(FrameWidth / 2, FrameHeight / 2, RenderGraphFormat::R16G16B16A16Float);
+		graph.AddPass();
+		graph.Read(depthLevels[HierarchicalDepthLevelCount - 1]);
+		graph.Read(normals);
+		graph.Read(scene);
+		graph.Write(reflections);
+		graph.AddPass();
+		graph.Read(reflections);
+		graph.Read(material);
+		graph.Read(scene);
+		graph.Write(scene);
+
+		std::array<ResourceHandle, BloomLevelCount> bloomDown = {};
+		std::array<ResourceHandle, BloomLevelCount> bloomUp = {};
+		for (size_t level = 0; level < BloomLevelCount; ++level)
+		{
+			bloomDown[level] = texture((FrameWidth / 2) >> level, (FrameHeight / 2) >> level, RenderGraphFormat::R16G16B16A16Float);
+			graph.AddPass();
+			graph.Read((level == 0) ? scene : bloomDown[level - 1]);
+			graph.Write(bloomDown[level]);
+		}
+		for (size_t level = BloomLevelCount; level-- > 0;)
+		{
+			bloomUp[level] = texture((FrameWidth / 2) >> level, (FrameHeight / 2) >> level, RenderGraphFormat::R16G16B16A16Float);
+			graph.AddPass();
+			graph.Read(bloomDown[level]);
+			if (level + 1 < BloomLevelCount)
+			{
+				graph.Read(bloomUp[level + 1]);
+			}
+			graph.Write(bloomUp[level]);
+		}
+
+		const ResourceHandle antiAliased = texture(FrameWidth, FrameHeight, RenderGraphFormat::R16G16B16A16Float);
+		graph.AddPass();
+		graph.Read(scene);
+		graph.Read(velocity);
+		graph.Read(history);
+		graph.Write(antiAliased);
+		graph.Write(history);
+
+		const ResourceHandle motionTiles = texture(FrameWidth / 16, FrameHeight / 16, RenderGraphFormat::R16G16B16A16Float);
+		const ResourceHandle motionBlurred = texture(FrameWidth, FrameHeight, RenderGraphFormat::R16G16B16A16Float);
+		graph.AddPass();
+		graph.Read(velocity);
+		graph.Write(motionTiles);
+		graph.AddPass();
+		graph.Read(antiAliased);
+		graph.Read(motionTiles);
+		graph.Write(motionBlurred);
+
+		const ResourceHandle circleOfConfusion = texture(FrameWidth, FrameHeight, RenderGraphFormat::R8Unorm);
+		const ResourceHandle nearField = texture(FrameWidth / 2, FrameHeight / 2, RenderGraphFormat::R16G16B16A16Float);
+		const ResourceHandle farField = texture(FrameWidth / 2, FrameHeight / 2, RenderGraphFormat::R16G16B16A16Float);
+		const ResourceHandle focused = texture(FrameWidth, FrameHeight, RenderGraphFormat::R16G16B16A16Float);
+		graph.AddPass();
+		graph.Read(depth);
+		graph.Write(circleOfConfusion);
+		graph.AddPass();
+		graph.Read(motionBlurred);
+		graph.Read(circleOfConfusion);
+		graph.Write(nearField);
+		graph.AddPass();
+		graph.Read(motionBlurred);
+		graph.Read(circleOfConfusion);
+		graph.Write(farField);
+		graph.AddPass();
+		graph.Read(motionBlurred);
+		graph.Read(nearField);
+		graph.Read(farField);
+		graph.Write(focused);
+
+		ResourceHandle luminance = focused;
+		for (size_t level = 0; level < ExposureLevelCount; ++level)
+		{
+			const ResourceHandle nextLuminance = texture(64 >> level, 64 >> level, RenderGraphFormat::R32Float);
+			graph.AddPass();
+			graph.Read(luminance);
+			graph.Write(nextLuminance);
+			luminance = nextLuminance;
+		}
+
+		const ResourceHandle toneMapped = texture(FrameWidth, FrameHeight, RenderGraphFormat::R8G8B8A8Unorm);
+		graph.AddPass();
+		graph.Read(focused);
+		graph.Read(bloomUp[0]);
+		graph.Read(luminance);
+		graph.Write(toneMapped);
+
+		const ResourceHandle edgeAntiAliased = texture(FrameWidth, FrameHeight, RenderGraphFormat::R8G8B8A8Unorm);
+		graph.AddPass();
+		graph.Read(toneMapped);
+		graph.Write(edgeAntiAliased);
+
+		graph.AddPass();
+		graph.Read(edgeAntiAliased);
+		graph.Write(backBuffer);
+
+		// Debug views of intermediate results nothing presents.
+		const std::array<ResourceHandle, 6> debugSources = { albedo, normals, material, velocity, occlusionBlurred, reflections };
+		for (size_t view = 0; view < DebugViewCount; ++view)
+		{
+			const ResourceHandle debugView = texture(FrameWidth, FrameHeight, RenderGraphFormat::R8G8B8A8Unorm);
+			graph.AddPass();
+			graph.Read(debugSources[view % debugSources.size()]);
+			graph.Write(debugView);
+		}
+	}
+
+	void RunRenderGraphBenchmarks(Harness& harness)
+	{
+		const std::string compileName = "RenderGraph.Compile.DeferredFrame";
+		const std::string declareName = "RenderGraph.DeclareAndCompile.DeferredFrame";
+		if (!harness.IsEnabled(compileName) && !harness.IsEnabled(declareName))
+		{
+			return;
+		}
+
+		LeviathanRenderer::RenderGraph graph = {};
+		DeclareDeferredFrame(graph);
+		const size_t passCount = graph.GetPassCount();
+
+		// Compiling the same declarations every repetition measures the compile step alone.
+		const BenchmarkResult* const compileResult = harness.Run(compileName, passCount, [&]()
+			{
+				graph.Compile();
+				Consume(graph.GetCompiledPasses());
+			});
+		if (compileResult != nullptr)
+		{
+			const LeviathanRenderer::RenderGraphStats& stats = graph.GetStats();
+			harness.AddMetric(compileName, "passes", static_cast<double>(stats.PassCount));
+			harness.AddMetric(compileName, "compileMicroseconds", compileResult->MedianNanoseconds / 1e3);
+			harness.AddMetric(compileName, "culledPasses", static_cast<double>(stats.CulledPassCount));
+			harness.AddMetric(compileName, "allocatedResources", static_cast<double>(stats.AllocatedResourceCount));
+			harness.AddMetric(compileName, "transientMiB", static_cast<double>(stats.TransientBytes) / (1024.0 * 1024.0));
+			harness.AddMetric(compileName, "heapMiB", static_cast<double>(stats.HeapBytes) / (1024.0 * 1024.0));
+		}
+
+		// Declaring the frame every repetition reuses the graph's memory, as rebuilding the graph every frame does.
+		const BenchmarkResult* const declareResult = harness.Run(declareName, passCount, [&]()
+			{
+				DeclareDeferredFrame(graph);
+				graph.Compile();
+				Consume(graph.GetCompiledPasses());
+			});
+		if (declareResult != nullptr)
+		{
+			harness.AddMetric(declareName, "passes", static_cast<double>(passCount));
+			harness.AddMetric(declareName, "microseconds", declareResult->MedianNanoseconds / 1e3);
+		}
+	}
+}
@@ -0,0 +1,151 @@
+#include "BenchmarkSuites.h"
+#include "Benchmark.h"
+#include "TestFixtures.h"
+#include "MathTypes.h"
+#include "JobSystem.h"
+#include "Camera.h"
+#include "VisibilityCulling.h"
+#include "RenderWorld.h"
+
+namespace LeviathanBenchmarks
+{
+	static constexpr size_t WorldRenderableCount = 100000;
+	static constexpr size_t WorldChangedCount = WorldRenderableCount / 100;
+	static constexpr size_t WorldDestroyedCount = WorldRenderableCount / 10;
+	static constexpr size_t WorldMeshCount = 16;
+	static constexpr size_t WorldMaterialCount = 64;
+	static constexpr float WorldHalfSize = 400.0f;
+
+	static LeviathanCore::MathTypes::Matrix4x4 RandomTransform(std::mt19937& random)
+	{
+		std::uniform_real_distribution<float> positionDistribution(-WorldHalfSize, WorldHalfSize);
+		std::uniform_real_distribution<float> angleDistribution(-3.14159265f, 3.14159265f);
+		return LeviathanCore::MathTypes::Matrix4x4::Translation(
+			LeviathanCore::MathTypes::Vector3(positionDistribution(random), positionDistribution(random), positionDistribution(random))) *
+			LeviathanCore::MathTypes::Matrix4x4::Rotation(LeviathanCore::MathTypes::Quaternion(LeviathanCore::MathTypes::Euler(0.0f, angleDistribution(random), 0.0f)));
+	}
+
+	static LeviathanRenderer::RenderableDescription RandomRenderable(std::mt19937& random)
+	{
+		std::uniform_int_distribution<uint32_t> meshDistribution(1, WorldMeshCount);
+		std::uniform_int_distribution<uint32_t> materialDistribution(1, WorldMaterialCount);
+		std::uniform_real_distribution<float> sizeDistribution(0.25f, 4.0f);
+
+		const uint32_t mesh = meshDistribution(random);
+		const uint32_t material = materialDistribution(random);
+		const float size = sizeDistribution(random);
+
+		LeviathanRenderer::RenderableDescription description = {};
+		description.Mesh.VertexBuffer = mesh;
+		description.Mesh.IndexBuffer = 1000 + mesh;
+		description.Mesh.IndexCount = 36 * mesh;
+		description.Mesh.VertexStrideBytes = 44;
+		description.Mesh.LocalBounds = LeviathanCore::BoundingVolumes::AABB{ LeviathanCore::MathTypes::Vector3(-size, -size, -size),
+			LeviathanCore::MathTypes::Vector3(size, size, size) };
+		description.Material.ColorTexture = 2000 + material;
+		description.Material.MetallicTexture = 3000 + material;
+		description.Material.RoughnessTexture = 4000 + material;
+		description.Material.NormalTexture = 5000 + material;
+		description.Material.Sampler = 1;
+		description.Transform = RandomTransform(random);
+		return description;
+	}
+
+	// Camera at the origin looking down +z.
+	static LeviathanRenderer::Camera MakeCamera()
+	{
+		LeviathanRenderer::Camera camera = {};
+		camera.UpdateViewMatrix();
+		camera.UpdateProjectionMatrix(1920, 1080);
+		camera.UpdateViewProjectionMatrix();
+		return camera;
+	}
+
+	static void RunDrawListBenchmarks(Harness& harness, const std::string_view threadingName, const LeviathanRenderer::RenderWorld& world,
+		const LeviathanRenderer::Camera& camera)
+	{
+		const std::string name = "RenderWorld.BuildDrawList.100kRenderables." + std::string(threadingName);
+		LeviathanRenderer::FrustumCullingStage cullingStage = {};
+		LeviathanRenderer::DrawList drawList = {};
+		const BenchmarkResult* const result = harness.Run(name, world.GetCount(), [&]()
+			{
+				LeviathanRenderer::BuildDrawList(world, camera, cullingStage, drawList);
+				Consume(drawList.ObjectData.data());
+			});
+		if (result != nullptr)
+		{
+			harness.AddMetric(name, "draws", static_cast<double>(drawList.GetCount()));
+			harness.AddMetric(name, "threads", static_cast<double>(LeviathanCore::JobSystem::GetThreadCount()));
+		}
+	}
+
+	void RunRenderWorldBenchmarks(Harness& harness)
+	{
+		std::mt19937 random(8642);
+		std::vector<LeviathanRenderer::RenderableDescription> descriptions(WorldRenderableCount);
+		for (LeviathanRenderer::RenderableDescription& description : descriptions)
+		{
+			description = RandomRenderable(random);
+		}
+
+		harness.Run("RenderWorld.Create.100kRenderables", WorldRenderableCount, [&]()
+			{
+				LeviathanRenderer::RenderWorld world = {};
+				for (const LeviathanRenderer::RenderableDescription& description : descriptions)
+				{
+					world.Create(description);
+				}
+				Consume(&world);
+			});
+
+		LeviathanRenderer::RenderWorld world = {};
+		std::vector<LeviathanRenderer::RenderableId> renderables(WorldRenderableCount);
+		for (size_t i = 0; i < descriptions.size(); ++i)
+		{
+			renderables[i] = world.Create(descriptions[i]);
+		}
+
+		// Per frame cost of moving 1% of the renderables.
+		std::vector<LeviathanCore::MathTypes::Matrix4x4> transforms(WorldChangedCount);
+		std::vector<size_t> changed(WorldChangedCount);
+		std::uniform_int_distribution<size_t> renderableDistribution(0, WorldRenderableCount - 1);
+		for (size_t i = 0; i < WorldChangedCount; ++i)
+		{
+			changed[i] = renderableDistribution(random);
+			transforms[i] = RandomTransform(random);
+		}
+
+		harness.Run("RenderWorld.SetTransform.1PercentOf100k", WorldChangedCount, [&]()
+			{
+				for (size_t i = 0; i < WorldChangedCount; ++i)
+				{
+					world.SetTransform(renderables[changed[i]], transforms[i]);
+				}
+				Consume(&world);
+			});
+
+		// Destroying renderables moves others in storage.
+		const std::string destroyName = "RenderWorld.DestroyCreate.10PercentOf100k";
+		const BenchmarkResult* const destroyResult = harness.Run(destroyName, WorldDestroyedCount, [&]()
+			{
+				for (size_t i = 0; i < WorldDestroyedCount; ++i)
+				{
+					const size_t slot = (i * 7919) % WorldRenderableCount;
+					world.Destroy(renderables[slot]);
+					renderables[slot] = world.Create(descriptions[slot]);
+				}
+				Consume(&world);
+			});
+		if (destroyResult != nullptr)
+		{
+			harness.AddMetric(destroyName, "renderables", static_cast<double>(world.GetCount()));
+		}
+
+		const LeviathanRenderer::Camera camera = MakeCamera();
+
+		LeviathanTestFixtures::RunSingleThreadAndJobSystem(0, [&](const std::string_view threadingName)
+			{
+				RunDrawListBenchmarks(harness, threadingName, world, camera);
+			});
+	}
+}
@@ -0,0 +1,204 @@
+#include "BenchmarkSuites.h"
+#include "Benchmark.h"
+#include "ShaderCache.h"
+#include "JobSystem.h"
+
+namespace LeviathanBenchmarks
+{
+	static constexpr size_t MaterialCount = 128;
+	// Every fourth material is unlit and does not include the lighting header.
+	static constexpr size_t UnlitMaterialInterval = 4;
+
+	static constexpr std::string_view MathFile = "Shaders/Common/Math.hlsl";
+	static constexpr std::string_view LightingFile = "Shaders/Common/Lighting.hlsl";
+	static constexpr std::string_view SkinningFile = "Shaders/Common/Animation/Skinning.hlsl";
+
+	// Shader sources held in memory in place of files on disk.
+	struct VirtualShaderFiles
+	{
+		std::unordered_map<std::string, std::string> Files = {};
+	};
+
+	static bool ReadVirtualShaderFile(const std::string_view file, std::string& outSource, void* const userData)
+	{
+		const VirtualShaderFiles& files = *static_cast<const VirtualShaderFiles*>(userData);
+		const auto found = files.Files.find(std::string(file));
+		if (found == files.Files.end())
+		{
+			return false;
+		}
+		outSource = found->second;
+		return true;
+	}
+
+	// Stands in for the shader compiler. Bytecode is the target, entry point, macros and source so that stale bytecode is detected by comparing it to
+	// the bytecode of the current inputs.
+	static void MakeFakeBytecode(const LeviathanRenderer::ShaderCompileDescription& description, const std::string_view source, std::vector<uint8_t>& outBytecode)
+	{
+		std::string bytecode(description.Target);
+		bytecode.append(description.EntryPoint);
+		for (size_t i = 0; i < description.MacroCount; ++i)
+		{
+			bytecode.append(description.Macros[i].Name).append("=").append(description.Macros[i].Definition).append(";");
+		}
+		bytecode.append(source);
+		outBytecode.assign(bytecode.begin(), bytecode.end());
+	}
+
+	static bool FakeCompile(const LeviathanRenderer::ShaderCompileDescription& description, const std::string_view source, std::vector<uint8_t>& outBytecode,
+		void* const userData)
+	{
+		std::atomic<size_t>& compileCount = *static_cast<std::atomic<size_t>*>(userData);
+		++compileCount;
+		MakeFakeBytecode(description, source, outBytecode);
+		return true;
+	}
+
+	static std::string MakeMaterialFile(const size_t material, const bool pixelShader)
+	{
+		return "Shaders/Materials/Material" + std::to_string(material) + (pixelShader ? "PixelShader.hlsl" : "VertexShader.hlsl");
+	}
+
+	static bool IsLitMaterial(const size_t material)
+	{
+		return (material % UnlitMaterialInterval) != (UnlitMaterialInterval - 1);
+	}
+
+	// Shared headers included through relative paths and a vertex and pixel shader per material. Odd materials are skinned. Includes inside comments
+	// name files that do not exist so that treating them as dependencies fails to read them.
+	static void MakeShaderFiles(VirtualShaderFiles& files)
+	{
+		files.Files.clear();
+		files.Files[std::string(MathFile)] = "#ifndef MATH_HLSL\n#define MATH_HLSL\nstatic const float Pi = 3.14159265f;\nfloat Square(float x) { return x * x; }\n#endif\n";
+		files.Files[std::string(LightingFile)] =
+			"#ifndef LIGHTING_HLSL\n#define LIGHTING_HLSL\n#include \"Math.hlsl\"\n"
+			"// #include \"CommentedLine.hlsl\"\n"
+			"float3 Lambert(float3 albedo) { return albedo / Pi; }\n#endif\n";
+		files.Files[std::string(SkinningFile)] =
+			"  #  include \"../Math.hlsl\"\n"
+			"/* Skinning matrices.\n#include \"CommentedBlock.hlsl\"\n*/\n"
+			"float4x4 Skin(float4x4 bones[4], float4 weights) { return bones[0] * weights.x; }\n";
+
+		for (size_t material = 0; material < MaterialCount; ++material)
+		{
+			std::string vertexShader = "#include \"../Common/Math.hlsl\"\n";
+			if ((material % 2) == 1)
+			{
+				vertexShader += "#include <../Common/Animation/Skinning.hlsl>\n";
+			}
+			vertexShader += "float4 main(float3 position : POSITION) : SV_POSITION { return float4(position * " + std::to_string(material) + ".0f, 1.0f); }\n";
+			files.Files[MakeMaterialFile(material, false)] = std::move(vertexShader);
+
+			// A comment marker inside a string literal does not hide the include after it.
+			std::string pixelShader = "static const char* Name = \"/* not a comment\";\n";
+			pixelShader += IsLitMaterial(material) ? "#include \"..\\Common\\.\\Lighting.hlsl\"\n" : "#include \"../Common/Math.hlsl\"\n";
+			pixelShader += "float4 main() : SV_TARGET { return float4(" + std::to_string(material) + ".0f, 0.0f, 0.0f, 1.0f); }\n";
+			files.Files[MakeMaterialFile(material, true)] = std::move(pixelShader);
+		}
+	}
+
+	struct ShaderCacheScene
+	{
+		std::vector<std::string> Files = {};
+		std::array<LeviathanRenderer::ShaderMacro, 2> Macros = {};
+		std::vector<LeviathanRenderer::ShaderCompileDescription> Descriptions = {};
+	};
+
+	// A vertex and pixel shader per material. Pixel shaders of lit materials use the macros.
+	static void MakeShaderCacheScene(ShaderCacheScene& scene)
+	{
+		scene.Files.clear();
+		for (size_t material = 0; material < MaterialCount; ++material)
+		{
+			scene.Files.push_back(MakeMaterialFile(material, false));
+			scene.Files.push_back(MakeMaterialFile(material, true));
+		}
+		scene.Macros[0] = LeviathanRenderer::ShaderMacro{ .Name = "TEXTURE2D_SRV_TABLE_LENGTH", .Definition = "16" };
+		scene.Macros[1] = LeviathanRenderer::ShaderMacro{ .Name = "SHADOW_CASCADE_COUNT", .Definition = "4" };
+
+		scene.Descriptions.clear();
+		for (size_t material = 0; material < MaterialCount; ++material)
+		{
+			const bool lit = IsLitMaterial(material);
+			scene.Descriptions.push_back(LeviathanRenderer::ShaderCompileDescription{ .SourceFile = scene.Files[material * 2], .EntryPoint = "main",
+				.Target = "vs_5_0", .Macros = nullptr, .MacroCount = 0 });
+			scene.Descriptions.push_back(LeviathanRenderer::ShaderCompileDescription{ .SourceFile = scene.Files[(material * 2) + 1], .EntryPoint = "main",
+				.Target = "ps_5_0", .Macros = lit ? scene.Macros.data() : nullptr, .MacroCount = lit ? scene.Macros.size() : 0 });
+		}
+	}
+
+	void RunShaderCacheBenchmarks(Harness& harness)
+	{
+		const std::string lookupName = "ShaderCache.GetOrCompile.Warm";
+		const std::string keyName = "ShaderCache.HashSourceTrees.Cold";
+		if (!harness.IsEnabled(lookupName) && !harness.IsEnabled(keyName))
+		{
+			return;
+		}
+
+		const bool startedJobSystem = LeviathanCore::JobSystem::Initialize();
+
+		VirtualShaderFiles files = {};
+		MakeShaderFiles(files);
+		ShaderCacheScene scene = {};
+		MakeShaderCacheScene(scene);
+		const size_t shaderCount = scene.Descriptions.size();
+
+		std::atomic<size_t> compileCount = 0;
+		LeviathanRenderer::ShaderSourceGraph sources(ReadVirtualShaderFile, &files);
+		LeviathanRenderer::ShaderCache cache = {};
+		std::vector<const std::vector<uint8_t>*> bytecode = {};
+
+		// Cold start compiles every shader once.
+		cache.GetOrCompile(sources, scene.Descriptions.data(), shaderCount, FakeCompile, &compileCount, bytecode);
+		const size_t coldCompiles = compileCount;
+
+		// Every lookup hits once sources are read. Measures hashing every source tree and the cache lookups.
+		const BenchmarkResult* const lookupResult = harness.Run(lookupName, shaderCount, [&]()
+			{
+				cache.GetOrCompile(sources, scene.Descriptions.data(), shaderCount, FakeCompile, &compileCount, bytecode);
+				Consume(bytecode.data());
+			});
+
+		// Reading and parsing every source file before hashing, as on startup.
+		const BenchmarkResult* const keyResult = harness.Run(keyName, shaderCount, [&]()
+			{
+				sources.Clear();
+				uint64_t combined = 0;
+				for (const LeviathanRenderer::ShaderCompileDescription& description : scene.Descriptions)
+				{
+					uint64_t hash = 0;
+					sources.HashSourceTree(description.SourceFile, hash);
+					combined ^= LeviathanRenderer::ShaderCache::ComputeKey(hash, description);
+				}
+				Consume(&combined);
+			});
+
+		if ((lookupResult == nullptr) && (keyResult == nullptr))
+		{
+			if (startedJobSystem)
+			{
+				LeviathanCore::JobSystem::Shutdown();
+			}
+			return;
+		}
+		const std::string& name = (lookupResult != nullptr) ? lookupName : keyName;
+		if (lookupResult != nullptr)
+		{
+			harness.AddMetric(lookupName, "lookupMicroseconds", lookupResult->MedianNanoseconds / 1e3);
+		}
+		if (keyResult != nullptr)
+		{
+			harness.AddMetric(keyName, "hashMicroseconds", keyResult->MedianNanoseconds / 1e3);
+		}
+		harness.AddMetric(name, "shaders", static_cast<double>(shaderCount));
+		harness.AddMetric(name, "sourceFiles", static_cast<double>(sources.GetFileCount()));
+		harness.AddMetric(name, "coldCompiles", static_cast<double>(coldCompiles));
+		harness.AddMetric(name, "warmCompiles", static_cast<double>(compileCount - coldCompiles));
+
+		if (startedJobSystem)
+		{
+			LeviathanCore::JobSystem::Shutdown();
+		}
+	}
+}
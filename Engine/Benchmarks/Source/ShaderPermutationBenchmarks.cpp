@@ -0,0 +1,136 @@
+#include "BenchmarkSuites.h"
+#include "Benchmark.h"
+#include "ShaderPermutations.h"
+#include "JobSystem.h"
+
+namespace LeviathanBenchmarks
+{
+	static constexpr std::string_view LitPixelShaderFile = "Shaders/LitPixelShader.hlsl";
+	static constexpr size_t FrameDrawCount = 4096;
+	static constexpr size_t FrameMaterialCount = 24;
+
+	static constexpr std::array<LeviathanRenderer::ShaderFeature, 3> LitFeatures =
+	{
+		LeviathanRenderer::ShaderFeature{ .Name = "NORMAL_MAPPING", .BitCount = 1 },
+		LeviathanRenderer::ShaderFeature{ .Name = "LIGHT_COUNT", .BitCount = 3 },
+		LeviathanRenderer::ShaderFeature{ .Name = "SHADOWS", .BitCount = 1 }
+	};
+	static constexpr size_t NormalMappingFeature = 0;
+	static constexpr size_t LightCountFeature = 1;
+	static constexpr size_t ShadowsFeature = 2;
+	static constexpr size_t LitKeyBitCount = LeviathanRenderer::GetShaderFeatureBitOffset(LitFeatures.data(), LitFeatures.size());
+
+	static constexpr LeviathanRenderer::ShaderPermutationKey MakeLitKey(const uint32_t normalMapping, const uint32_t lightCount, const uint32_t shadows)
+	{
+		LeviathanRenderer::ShaderPermutationKey key = 0;
+		key = LeviathanRenderer::SetShaderFeature(LitFeatures.data(), NormalMappingFeature, key, normalMapping);
+		key = LeviathanRenderer::SetShaderFeature(LitFeatures.data(), LightCountFeature, key, lightCount);
+		return LeviathanRenderer::SetShaderFeature(LitFeatures.data(), ShadowsFeature, key, shadows);
+	}
+
+	struct VirtualShaderFile
+	{
+		std::string Source = {};
+	};
+
+	static bool ReadLitPixelShaderFile(const std::string_view file, std::string& outSource, void* const userData)
+	{
+		if (file != LitPixelShaderFile)
+		{
+			return false;
+		}
+		outSource = static_cast<const VirtualShaderFile*>(userData)->Source;
+		return true;
+	}
+
+	// Stands in for the shader compiler. Bytecode is the macros followed by the source.
+	static void MakePermutationBytecode(const LeviathanRenderer::ShaderMacro* const macros, const size_t macroCount, const std::string_view source,
+		std::vector<uint8_t>& outBytecode)
+	{
+		std::string bytecode = {};
+		for (size_t i = 0; i < macroCount; ++i)
+		{
+			bytecode.append(macros[i].Name).append("=").append(macros[i].Definition).append(";");
+		}
+		bytecode.append(source);
+		outBytecode.assign(bytecode.begin(), bytecode.end());
+	}
+
+	static bool FakePermutationCompile(const LeviathanRenderer::ShaderCompileDescription& description, const std::string_view source,
+		std::vector<uint8_t>& outBytecode, void* const userData)
+	{
+		++*static_cast<std::atomic<size_t>*>(userData);
+		MakePermutationBytecode(description.Macros, description.MacroCount, source, outBytecode);
+		return true;
+	}
+
+	// Permutation of every draw of a frame. Materials are spread over a few normal mapping, light count and shadow combinations and draws are in
+	// material order as they would be after sorting.
+	static void MakeFrameKeys(std::vector<LeviathanRenderer::ShaderPermutationKey>& outKeys)
+	{
+		outKeys.resize(FrameDrawCount);
+		for (size_t draw = 0; draw < FrameDrawCount; ++draw)
+		{
+			const uint32_t material = static_cast<uint32_t>((draw * FrameMaterialCount) / FrameDrawCount);
+			outKeys[draw] = MakeLitKey(material % 2, (material / 2) % 4, (material / 8) % 2);
+		}
+	}
+
+	void RunShaderPermutationBenchmarks(Harness& harness)
+	{
+		const std::string name = "ShaderPermutations.GetPermutation.Warm";
+		if (!harness.IsEnabled(name))
+		{
+			return;
+		}
+
+		const bool startedJobSystem = LeviathanCore::JobSystem::Initialize();
+
+		VirtualShaderFile file = { .Source = "#if NORMAL_MAPPING\nfloat3 SampleNormal();\n#endif\nfloat4 main() : SV_TARGET { return LIGHT_COUNT; }\n" };
+		static constexpr std::array<LeviathanRenderer::ShaderMacro, 1> baseMacros =
+		{
+			LeviathanRenderer::ShaderMacro{ .Name = "TEXTURE2D_SRV_TABLE_LENGTH", .Definition = "16" }
+		};
+		const LeviathanRenderer::ShaderCompileDescription base = { .SourceFile = LitPixelShaderFile, .EntryPoint = "main", .Target = "ps_5_0",
+			.Macros = baseMacros.data(), .MacroCount = baseMacros.size() };
+
+		std::vector<LeviathanRenderer::ShaderPermutationKey> frameKeys = {};
+		MakeFrameKeys(frameKeys);
+		std::vector<LeviathanRenderer::ShaderPermutationKey> distinctKeys = frameKeys;
+		std::sort(distinctKeys.begin(), distinctKeys.end());
+		distinctKeys.erase(std::unique(distinctKeys.begin(), distinctKeys.end()), distinctKeys.end());
+
+		std::atomic<size_t> compileCount = 0;
+		LeviathanRenderer::ShaderSourceGraph sources(ReadLitPixelShaderFile, &file);
+		LeviathanRenderer::ShaderCache cache = {};
+		LeviathanRenderer::ShaderPermutationSet permutations("LitPixelShader", base, LitFeatures.data(), LitFeatures.size());
+
+		// First run without a usage list. Every permutation is loaded on first use.
+		for (const LeviathanRenderer::ShaderPermutationKey key : frameKeys)
+		{
+			permutations.GetPermutation(key, cache, sources, FakePermutationCompile, &compileCount);
+		}
+
+		// Every lookup hits a resident permutation.
+		const BenchmarkResult* const result = harness.Run(name, FrameDrawCount, [&]()
+			{
+				uintptr_t checksum = 0;
+				for (const LeviathanRenderer::ShaderPermutationKey key : frameKeys)
+				{
+					checksum += reinterpret_cast<uintptr_t>(permutations.GetPermutation(key, cache, sources, FakePermutationCompile, &compileCount));
+				}
+				Consume(&checksum);
+			});
+		if (result != nullptr)
+		{
+			harness.AddMetric(name, "lookupNanosecondsPerDraw", result->MedianNanoseconds / static_cast<double>(FrameDrawCount));
+			harness.AddMetric(name, "distinctPermutations", static_cast<double>(distinctKeys.size()));
+			harness.AddMetric(name, "possiblePermutations", static_cast<double>(1u << LitKeyBitCount));
+		}
+
+		if (startedJobSystem)
+		{
+			LeviathanCore::JobSystem::Shutdown();
+		}
+	}
+}
@@ -0,0 +1,240 @@
+#include "BenchmarkSuites.h"
+#include "Benchmark.h"
+#include "TestFixtures.h"
+#include "MathTypes.h"
+#include "BoundingVolumes.h"
+#include "DynamicAABBTree.h"
+
+namespace LeviathanBenchmarks
+{
+	static constexpr size_t MovingObjectCount = 100000;
+	static constexpr size_t QueryCount = 256;
+	static constexpr float WorldHalfSize = 1000.0f;
+	static constexpr float MaxSpeed = 0.5f;
+
+	struct MovingObject
+	{
+		LeviathanCore::MathTypes::Vector3 Center = {};
+		LeviathanCore::MathTypes::Vector3 HalfExtents = {};
+		LeviathanCore::MathTypes::Vector3 Velocity = {};
+		LeviathanCore::DataStructures::DynamicAABBTree::ProxyId Proxy = LeviathanCore::DataStructures::DynamicAABBTree::InvalidProxyId;
+
+		inline LeviathanCore::BoundingVolumes::AABB Bounds() const { return LeviathanCore::BoundingVolumes::AABB{ Center - HalfExtents, Center + HalfExtents }; }
+	};
+
+	// Moves every object by its velocity, reflecting off the world bounds, and updates its proxy. Returns the number of reinserted proxies.
+	static size_t StepObjects(std::vector<MovingObject>& objects, LeviathanCore::DataStructures::DynamicAABBTree& tree)
+	{
+		size_t reinsertedCount = 0;
+		for (MovingObject& object : objects)
+		{
+			float* const center = object.Center.Data();
+			float* const velocity = object.Velocity.Data();
+			for (size_t axis = 0; axis < 3; ++axis)
+			{
+				center[axis] += velocity[axis];
+				if (std::fabs(center[axis]) > WorldHalfSize)
+				{
+					velocity[axis] = -velocity[axis];
+				}
+			}
+			reinsertedCount += tree.MoveProxy(object.Proxy, object.Bounds(), object.Velocity) ? 1 : 0;
+		}
+		return reinsertedCount;
+	}
+
+	// Returns the enlarged boxes of the tree proxies indexed by proxy id for brute force comparisons.
+	static LeviathanCore::BoundingVolumes::AABBArray GatherFatBoxes(const std::vector<MovingObject>& objects, const LeviathanCore::DataStructures::DynamicAABBTree& tree,
+		std::vector<LeviathanCore::DataStructures::DynamicAABBTree::ProxyId>& outProxies)
+	{
+		LeviathanCore::BoundingVolumes::AABBArray boxes = {};
+		outProxies.clear();
+		for (const MovingObject& object : objects)
+		{
+			boxes.Add(tree.GetFatAABB(object.Proxy));
+			outProxies.push_back(object.Proxy);
+		}
+		return boxes;
+	}
+
+	void RunSpatialBenchmarks(Harness& harness)
+	{
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> positionDistribution(-WorldHalfSize, WorldHalfSize);
+		std::uniform_real_distribution<float> sizeDistribution(0.5f, 3.0f);
+		std::uniform_real_distribution<float> velocityDistribution(-MaxSpeed, MaxSpeed);
+
+		std::vector<MovingObject> objects(MovingObjectCount);
+		for (MovingObject& object : objects)
+		{
+			object.Center = LeviathanCore::MathTypes::Vector3(positionDistribution(random), positionDistribution(random), positionDistribution(random));
+			object.HalfExtents = LeviathanCore::MathTypes::Vector3(sizeDistribution(random), sizeDistribution(random), sizeDistribution(random));
+			object.Velocity = LeviathanCore::MathTypes::Vector3(velocityDistribution(random), velocityDistribution(random), velocityDistribution(random));
+		}
+
+		harness.Run("Spatial.DynamicAABBTree.CreateProxy.100k", MovingObjectCount, [&]()
+			{
+				LeviathanCore::DataStructures::DynamicAABBTree tree(0.5f);
+				for (size_t i = 0; i < objects.size(); ++i)
+				{
+					tree.CreateProxy(objects[i].Bounds(), i);
+				}
+				Consume(&tree);
+			});
+
+		LeviathanCore::DataStructures::DynamicAABBTree tree(0.5f);
+		for (size_t i = 0; i < objects.size(); ++i)
+		{
+			objects[i].Proxy = tree.CreateProxy(objects[i].Bounds(), i);
+		}
+
+		size_t reinsertedCount = 0;
+		size_t stepCount = 0;
+		if (harness.Run("Spatial.DynamicAABBTree.MoveProxy.100kMovingPerFrame", MovingObjectCount, [&]()
+			{
+				reinsertedCount += StepObjects(objects, tree);
+				++stepCount;
+			}))
+		{
+			harness.AddMetric("Spatial.DynamicAABBTree.MoveProxy.100kMovingPerFrame", "reinsertedPerFrame", static_cast<double>(reinsertedCount) / static_cast<double>(stepCount));
+			harness.AddMetric("Spatial.DynamicAABBTree.MoveProxy.100kMovingPerFrame", "height", static_cast<double>(tree.GetHeight()));
+			harness.AddMetric("Spatial.DynamicAABBTree.MoveProxy.100kMovingPerFrame", "areaRatio", static_cast<double>(tree.GetAreaRatio()));
+		}
+
+		// Brute force queries test the same enlarged boxes as the tree so that both do the same work.
+		std::vector<LeviathanCore::DataStructures::DynamicAABBTree::ProxyId> proxies = {};
+		const LeviathanCore::BoundingVolumes::AABBArray fatBoxes = GatherFatBoxes(objects, tree, proxies);
+		const LeviathanCore::BoundingVolumes::AABBSoA fatBoxView = fatBoxes.View();
+		std::vector<uint8_t> bruteForceResults(MovingObjectCount, 0);
+
+		std::vector<LeviathanCore::BoundingVolumes::AABB> queryBoxes(QueryCount);
+		std::vector<LeviathanCore::BoundingVolumes::Ray> queryRays(QueryCount);
+		std::vector<LeviathanCore::MathTypes::Vector3> queryPoints(QueryCount);
+		for (size_t i = 0; i < QueryCount; ++i)
+		{
+			const LeviathanCore::MathTypes::Vector3 center(positionDistribution(random), positionDistribution(random), positionDistribution(random));
+			queryBoxes[i] = LeviathanCore::BoundingVolumes::AABB{ center - LeviathanCore::MathTypes::Vector3(20.0f, 20.0f, 20.0f), center + LeviathanCore::MathTypes::Vector3(20.0f, 20.0f, 20.0f) };
+			const LeviathanCore::MathTypes::Vector3 direction(velocityDistribution(random), velocityDistribution(random), velocityDistribution(random));
+			queryRays[i] = LeviathanCore::BoundingVolumes::Ray{ center, direction.AsNormalizedSafe() };
+			queryPoints[i] = center;
+		}
+
+		// Overlap.
+		std::vector<size_t> treeOverlapCounts(QueryCount, 0);
+		harness.Run("Spatial.DynamicAABBTree.QueryOverlap", QueryCount, [&]()
+			{
+				for (size_t q = 0; q < QueryCount; ++q)
+				{
+					size_t count = 0;
+					tree.QueryOverlap(queryBoxes[q], [&count](LeviathanCore::DataStructures::DynamicAABBTree::ProxyId) { ++count; return true; });
+					treeOverlapCounts[q] = count;
+				}
+				Consume(treeOverlapCounts.data());
+			});
+
+		std::vector<size_t> bruteOverlapCounts(QueryCount, 0);
+		harness.Run("Spatial.BruteForce.QueryOverlap", QueryCount, [&]()
+			{
+				for (size_t q = 0; q < QueryCount; ++q)
+				{
+					LeviathanCore::BoundingVolumes::TestAABBAABBs(queryBoxes[q], fatBoxView, 0, MovingObjectCount, bruteForceResults.data());
+					bruteOverlapCounts[q] = static_cast<size_t>(std::count(bruteForceResults.begin(), bruteForceResults.end(), static_cast<uint8_t>(1)));
+				}
+				Consume(bruteOverlapCounts.data());
+			});
+
+		// Frustum.
+		const LeviathanCore::BoundingVolumes::Frustum frustum = LeviathanTestFixtures::MakeFrustum(600.0f);
+
+		size_t treeFrustumCount = 0;
+		harness.Run("Spatial.DynamicAABBTree.QueryFrustum", 1, [&]()
+			{
+				treeFrustumCount = 0;
+				tree.QueryFrustum(frustum, [&treeFrustumCount](LeviathanCore::DataStructures::DynamicAABBTree::ProxyId) { ++treeFrustumCount; return true; });
+				Consume(&treeFrustumCount);
+			});
+
+		size_t bruteFrustumCount = 0;
+		if (harness.Run("Spatial.BruteForce.QueryFrustum", 1, [&]()
+			{
+				LeviathanCore::BoundingVolumes::TestFrustumAABBs(frustum, fatBoxView, 0, MovingObjectCount, bruteForceResults.data());
+				bruteFrustumCount = static_cast<size_t>(std::count(bruteForceResults.begin(), bruteForceResults.end(), static_cast<uint8_t>(1)));
+				Consume(&bruteFrustumCount);
+			}))
+		{
+			harness.AddMetric("Spatial.BruteForce.QueryFrustum", "visible", static_cast<double>(bruteFrustumCount));
+		}
+
+		// Closest hit ray casts.
+		static constexpr float rayLength = 2.0f * WorldHalfSize;
+		std::vector<float> treeHitDistances(QueryCount, 0.0f);
+		harness.Run("Spatial.DynamicAABBTree.RayCastClosest", QueryCount, [&]()
+			{
+				for (size_t q = 0; q < QueryCount; ++q)
+				{
+					float closest = rayLength;
+					tree.RayCast(queryRays[q], rayLength, [&](const LeviathanCore::DataStructures::DynamicAABBTree::ProxyId proxyId, const float maxDistance)
+						{
+							float distance = 0.0f;
+							if (queryRays[q].Intersects(tree.GetFatAABB(proxyId), maxDistance, distance))
+							{
+								closest = std::min(closest, distance);
+								return distance;
+							}
+							return maxDistance;
+						});
+					treeHitDistances[q] = closest;
+				}
+				Consume(treeHitDistances.data());
+			});
+
+		std::vector<float> bruteHitDistances(QueryCount, 0.0f);
+		std::vector<float> bruteDistances(MovingObjectCount, 0.0f);
+		harness.Run("Spatial.BruteForce.RayCastClosest", QueryCount, [&]()
+			{
+				for (size_t q = 0; q < QueryCount; ++q)
+				{
+					LeviathanCore::BoundingVolumes::TestRayAABBs(queryRays[q], rayLength, fatBoxView, 0, MovingObjectCount, bruteForceResults.data(), bruteDistances.data());
+					float closest = rayLength;
+					for (size_t i = 0; i < MovingObjectCount; ++i)
+					{
+						closest = bruteForceResults[i] ? std::min(closest, bruteDistances[i]) : closest;
+					}
+					bruteHitDistances[q] = closest;
+				}
+				Consume(bruteHitDistances.data());
+			});
+
+		// Nearest neighbor against the enlarged boxes.
+		std::vector<float> treeNearestDistances(QueryCount, 0.0f);
+		harness.Run("Spatial.DynamicAABBTree.FindNearest", QueryCount, [&]()
+			{
+				for (size_t q = 0; q < QueryCount; ++q)
+				{
+					LeviathanCore::DataStructures::DynamicAABBTree::ProxyId nearest = LeviathanCore::DataStructures::DynamicAABBTree::InvalidProxyId;
+					float distance = std::numeric_limits<float>::max();
+					tree.FindNearest(queryPoints[q], std::numeric_limits<float>::max(), [&](const LeviathanCore::DataStructures::DynamicAABBTree::ProxyId proxyId)
+						{
+							return tree.GetFatAABB(proxyId).SquaredDistance(queryPoints[q]);
+						}, nearest, distance);
+					treeNearestDistances[q] = distance;
+				}
+				Consume(treeNearestDistances.data());
+			});
+
+		std::vector<float> bruteNearestDistances(QueryCount, 0.0f);
+		harness.Run("Spatial.BruteForce.FindNearest", QueryCount, [&]()
+			{
+				for (size_t q = 0; q < QueryCount; ++q)
+				{
+					float bestSquaredDistance = std::numeric_limits<float>::max();
+					for (size_t i = 0; i < MovingObjectCount; ++i)
+					{
+						bestSquaredDistance = std::min(bestSquaredDistance, fatBoxes.Get(i).SquaredDistance(queryPoints[q]));
+					}
+					bruteNearestDistances[q] = std::sqrt(bestSquaredDistance);
+				}
+				Consume(bruteNearestDistances.data());
+			});
+	}
+}
@@ -0,0 +1,209 @@
+#include "BenchmarkSuites.h"
+#include "Benchmark.h"
+#include "TextureStreaming.h"
+#include "Camera.h"
+#include "StreamableTexture.h"
+#include "AssetTypes.h"
+
+namespace LeviathanBenchmarks
+{
+	static constexpr size_t StreamingTextureCount = 1024;
+	static constexpr size_t StreamingObjectCount = 4096;
+	static constexpr size_t StreamingFrameCount = 600;
+	static constexpr size_t StreamingPoolBytes = 128 * 1024 * 1024;
+	static constexpr size_t StreamingBytesPerFrame = 4 * 1024 * 1024;
+	static constexpr uint32_t StreamingBytesPerPixel = 4;
+	static constexpr float StreamingViewportHeight = 1080.0f;
+	static constexpr float StreamingFovYDegrees = 60.0f;
+	// Texture repeats per world unit of the objects' surfaces.
+	static constexpr float StreamingTextureCoordinateDensity = 0.25f;
+	static constexpr float StreamingCorridorLength = 2000.0f;
+
+	struct StreamingTextureRecord
+	{
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+		uint32_t MipCount = 0;
+	};
+
+	struct StreamingScene
+	{
+		std::vector<StreamingTextureRecord> Textures = {};
+		std::vector<LeviathanCore::BoundingVolumes::Sphere> Bounds = {};
+		std::vector<uint32_t> ObjectTextures = {};
+	};
+
+	static uint32_t GetStreamingMipCount(const uint32_t width, const uint32_t height)
+	{
+		return static_cast<uint32_t>(std::bit_width(std::max(width, height)));
+	}
+
+	// Textures of 256 to 2048 texels on objects spread along a corridor the camera flies through.
+	static void MakeStreamingScene(StreamingScene& scene)
+	{
+		std::mt19937 random(47);
+		scene.Textures.resize(StreamingTextureCount);
+		for (StreamingTextureRecord& texture : scene.Textures)
+		{
+			texture.Width = 256u << (random() % 4);
+			texture.Height = texture.Width >> (random() % 2);
+			texture.MipCount = GetStreamingMipCount(texture.Width, texture.Height);
+		}
+
+		std::uniform_real_distribution<float> offsetDistribution(-60.0f, 60.0f);
+		std::uniform_real_distribution<float> depthDistribution(0.0f, StreamingCorridorLength);
+		std::uniform_real_distribution<float> radiusDistribution(1.0f, 4.0f);
+		scene.Bounds.resize(StreamingObjectCount);
+		scene.ObjectTextures.resize(StreamingObjectCount);
+		for (size_t i = 0; i < StreamingObjectCount; ++i)
+		{
+			scene.Bounds[i].Center = LeviathanCore::MathTypes::Vector3(offsetDistribution(random), offsetDistribution(random) * 0.25f, depthDistribution(random));
+			scene.Bounds[i].Radius = radiusDistribution(random);
+			scene.ObjectTextures[i] = static_cast<uint32_t>(random() % StreamingTextureCount);
+		}
+	}
+
+	static LeviathanRenderer::Camera MakeStreamingCamera(const float z)
+	{
+		LeviathanRenderer::Camera camera = {};
+		camera.SetFovY(StreamingFovYDegrees);
+		camera.SetPosition(LeviathanCore::MathTypes::Vector3(0.0f, 0.0f, z));
+		camera.UpdateViewMatrix();
+		camera.UpdateProjectionMatrix(1920, static_cast<int>(StreamingViewportHeight));
+		camera.UpdateViewProjectionMatrix();
+		return camera;
+	}
+
+	static void RegisterStreamingTextures(LeviathanRenderer::TextureStreamer& streamer, const StreamingScene& scene, std::vector<LeviathanRenderer::StreamedTextureId>& outIds)
+	{
+		outIds.resize(scene.Textures.size());
+		for (size_t i = 0; i < scene.Textures.size(); ++i)
+		{
+			const StreamingTextureRecord& texture = scene.Textures[i];
+			outIds[i] = streamer.Register(texture.Width, texture.Height, texture.MipCount, StreamingBytesPerPixel);
+		}
+	}
+
+	// Adds the demand of every object in the camera's frustum. Returns the number of visible objects.
+	static size_t AddStreamingDemand(LeviathanRenderer::TextureStreamer& streamer, const StreamingScene& scene, const std::vector<LeviathanRenderer::StreamedTextureId>& ids,
+		const LeviathanRenderer::Camera& camera)
+	{
+		const LeviathanCore::BoundingVolumes::Frustum frustum = camera.GetFrustum();
+		size_t visible = 0;
+		for (size_t i = 0; i < scene.Bounds.size(); ++i)
+		{
+			if (!frustum.Intersects(scene.Bounds[i]))
+			{
+				continue;
+			}
+
+			const uint32_t textureIndex = scene.ObjectTextures[i];
+			const StreamingTextureRecord& texture = scene.Textures[textureIndex];
+			const float texelsPerWorldUnit = static_cast<float>(std::max(texture.Width, texture.Height)) * StreamingTextureCoordinateDensity;
+			streamer.AddDemand(ids[textureIndex], LeviathanRenderer::GetTextureMipDemand(camera, scene.Bounds[i], texelsPerWorldUnit, StreamingViewportHeight));
+			++visible;
+		}
+		return visible;
+	}
+
+	struct CountingStreamingBackend
+	{
+		size_t StreamInCount = 0;
+		size_t StreamOutCount = 0;
+
+		LeviathanRenderer::StreamInResult StreamIn(LeviathanRenderer::StreamedTextureId, uint32_t, uint32_t)
+		{
+			++StreamInCount;
+			return LeviathanRenderer::StreamInResult::Loaded;
+		}
+
+		void StreamOut(LeviathanRenderer::StreamedTextureId, uint32_t)
+		{
+			++StreamOutCount;
+		}
+	};
+
+	static void RunTextureStreamingFlythroughBenchmarks(Harness& harness)
+	{
+		const std::string name = "TextureStreaming.Update.1kTextures.Flythrough";
+		if (!harness.IsEnabled(name))
+		{
+			return;
+		}
+
+		StreamingScene scene = {};
+		MakeStreamingScene(scene);
+
+		LeviathanRenderer::TextureStreamingSettings settings = {};
+		settings.PoolBytes = StreamingPoolBytes;
+		settings.MaxStreamInBytesPerUpdate = StreamingBytesPerFrame;
+		settings.TailSize = 64;
+		settings.HysteresisUpdates = 30;
+
+		// The camera flies down the corridor demanding the textures of the objects in view every frame.
+		size_t visibleObjects = 0;
+		CountingStreamingBackend backend = {};
+		if (harness.Run(name, StreamingFrameCount, [&]()
+			{
+				LeviathanRenderer::TextureStreamer streamer(settings);
+				std::vector<LeviathanRenderer::StreamedTextureId> ids = {};
+				RegisterStreamingTextures(streamer, scene, ids);
+				backend = {};
+				visibleObjects = 0;
+				for (size_t frame = 0; frame < StreamingFrameCount; ++frame)
+				{
+					const float z = StreamingCorridorLength * static_cast<float>(frame) / static_cast<float>(StreamingFrameCount);
+					visibleObjects += AddStreamingDemand(streamer, scene, ids, MakeStreamingCamera(z));
+					streamer.Update(backend);
+				}
+				Consume(&backend);
+			}))
+		{
+			harness.AddMetric(name, "visibleObjectsPerFrame", static_cast<double>(visibleObjects) / static_cast<double>(StreamingFrameCount));
+			harness.AddMetric(name, "streamIns", static_cast<double>(backend.StreamInCount));
+			harness.AddMetric(name, "streamOuts", static_cast<double>(backend.StreamOutCount));
+		}
+	}
+
+	static void RunStreamableTextureBenchmarks(Harness& harness)
+	{
+		static constexpr uint32_t Width = 1024;
+		static constexpr uint32_t Height = 384;
+
+		const std::string name = "TextureStreaming.StreamableTexture.BuildMipChain.1024x384";
+		if (!harness.IsEnabled(name))
+		{
+			return;
+		}
+
+		std::mt19937 random(470);
+		std::vector<uint8_t> pixels(static_cast<size_t>(Width) * Height * LeviathanAssets::StreamableTexture::BytesPerPixel);
+		for (uint8_t& value : pixels)
+		{
+			value = static_cast<uint8_t>(random());
+		}
+		LeviathanAssets::AssetTypes::Texture texture = {};
+		texture.Width = static_cast<int>(Width);
+		texture.Height = static_cast<int>(Height);
+		texture.Num8BitComponentsPerPixel = static_cast<int>(LeviathanAssets::StreamableTexture::BytesPerPixel);
+		texture.Data = pixels.data();
+
+		LeviathanAssets::StreamableTexture::Header header = {};
+		std::vector<uint8_t> mipData = {};
+		if (harness.Run(name, 1, [&]()
+			{
+				LeviathanAssets::StreamableTexture::BuildMipChain(texture, false, header, mipData);
+				Consume(mipData.data());
+			}))
+		{
+			harness.AddMetric(name, "mips", static_cast<double>(header.MipCount));
+			harness.AddMetric(name, "megabytes", static_cast<double>(mipData.size()) / (1024.0 * 1024.0));
+		}
+	}
+
+	void RunTextureStreamingBenchmarks(Harness& harness)
+	{
+		RunTextureStreamingFlythroughBenchmarks(harness);
+		RunStreamableTextureBenchmarks(harness);
+	}
+}
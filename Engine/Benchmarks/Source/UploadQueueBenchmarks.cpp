@@ -0,0 +1,230 @@
+#include "BenchmarkSuites.h"
+#include "Benchmark.h"
+#include "UploadQueue.h"
+#include "JobSystem.h"
+
+namespace LeviathanBenchmarks
+{
+	static constexpr size_t UploadRequestCount = 2048;
+	static constexpr size_t UploadBudgetBytes = 1024 * 1024;
+	static constexpr size_t UploadSourceBytes = 8 * 1024 * 1024;
+	static constexpr uint8_t UploadPriorityCount = 4;
+
+	// A resource creation request reading its data from the shared source bytes.
+	struct UploadRequestRecord
+	{
+		LeviathanRenderer::UploadResourceType Type = LeviathanRenderer::UploadResourceType::VertexBuffer;
+		uint8_t Priority = 0;
+		// Vertex or index count or texture or cube face width.
+		uint32_t Count = 0;
+		uint32_t Height = 0;
+		uint32_t StrideBytes = 0;
+		// Offset of the data or of each cube face in the source bytes.
+		std::array<size_t, LeviathanRenderer::UploadQueue::TextureCubeFaceCount> Offsets = {};
+		size_t SizeBytes = 0;
+	};
+
+	struct UploadScene
+	{
+		std::vector<uint8_t> Source = {};
+		std::vector<UploadRequestRecord> Requests = {};
+		size_t TotalBytes = 0;
+	};
+
+	static void MakeUploadScene(UploadScene& scene)
+	{
+		std::mt19937 random(46);
+		scene.Source.resize(UploadSourceBytes);
+		for (uint8_t& byte : scene.Source)
+		{
+			byte = static_cast<uint8_t>(random());
+		}
+
+		scene.Requests.resize(UploadRequestCount);
+		scene.TotalBytes = 0;
+		for (UploadRequestRecord& request : scene.Requests)
+		{
+			request.Type = static_cast<LeviathanRenderer::UploadResourceType>(random() % 4);
+			request.Priority = static_cast<uint8_t>(random() % UploadPriorityCount);
+			size_t faceCount = 1;
+			switch (request.Type)
+			{
+			case LeviathanRenderer::UploadResourceType::VertexBuffer:
+				request.StrideBytes = 44;
+				request.Count = 64 + static_cast<uint32_t>(random() % 2048);
+				request.SizeBytes = static_cast<size_t>(request.Count) * request.StrideBytes;
+				break;
+
+			case LeviathanRenderer::UploadResourceType::IndexBuffer:
+				request.StrideBytes = sizeof(uint32_t);
+				request.Count = 96 + static_cast<uint32_t>(random() % 8192);
+				request.SizeBytes = static_cast<size_t>(request.Count) * request.StrideBytes;
+				break;
+
+			case LeviathanRenderer::UploadResourceType::Texture2D:
+				// Mostly small textures and a few larger than the budget.
+				request.Count = 16u << (random() % 7);
+				request.Height = 16u << (random() % 7);
+				request.StrideBytes = request.Count * 4;
+				request.SizeBytes = static_cast<size_t>(request.StrideBytes) * request.Height;
+				break;
+
+			case LeviathanRenderer::UploadResourceType::TextureCube:
+				request.Count = 16u << (random() % 4);
+				request.StrideBytes = request.Count * LeviathanRenderer::UploadQueue::TextureCubeBytesPerPixel;
+				faceCount = LeviathanRenderer::UploadQueue::TextureCubeFaceCount;
+				request.SizeBytes = static_cast<size_t>(request.StrideBytes) * request.Count;
+				break;
+
+			default:
+				break;
+			}
+
+			// Cube faces are read from unrelated offsets and staged back to back.
+			for (size_t face = 0; face < faceCount; ++face)
+			{
+				request.Offsets[face] = random() % (UploadSourceBytes - request.SizeBytes);
+			}
+			request.SizeBytes *= faceCount;
+			scene.TotalBytes += request.SizeBytes;
+		}
+	}
+
+	static LeviathanRenderer::UploadTicket EnqueueUploadRequest(LeviathanRenderer::UploadQueue& queue, const UploadScene& scene, const UploadRequestRecord& request)
+	{
+		const LeviathanRenderer::UploadDescription description = { .Priority = request.Priority };
+		const uint8_t* const data = scene.Source.data() + request.Offsets[0];
+		switch (request.Type)
+		{
+		case LeviathanRenderer::UploadResourceType::VertexBuffer:
+			return queue.EnqueueVertexBuffer(data, request.Count, request.StrideBytes, description);
+
+		case LeviathanRenderer::UploadResourceType::IndexBuffer:
+			return queue.EnqueueIndexBuffer(reinterpret_cast<const uint32_t*>(data), request.Count, description);
+
+		case LeviathanRenderer::UploadResourceType::Texture2D:
+			return queue.EnqueueTexture2D(request.Count, request.Height, data, request.StrideBytes, false, false, false, description);
+
+		case LeviathanRenderer::UploadResourceType::TextureCube:
+		{
+			std::array<const void*, LeviathanRenderer::UploadQueue::TextureCubeFaceCount> faces = {};
+			for (size_t face = 0; face < faces.size(); ++face)
+			{
+				faces[face] = scene.Source.data() + request.Offsets[face];
+			}
+			return queue.EnqueueTextureCube(request.Count, faces.data(), false, false, false, description);
+		}
+
+		default:
+			break;
+		}
+		return LeviathanRenderer::UploadQueue::InvalidTicket;
+	}
+
+	// Backend only counting the created bytes so that processing cost is the scheduling cost.
+	struct CountingUploadBackend
+	{
+		size_t CreatedBytes = 0;
+
+		bool CreateVertexBuffer(const void*, const uint32_t vertexCount, const size_t strideBytes, LeviathanRenderer::RendererResourceId::IdType& outId)
+		{
+			CreatedBytes += vertexCount * strideBytes;
+			outId = 0;
+			return true;
+		}
+
+		bool CreateIndexBuffer(const uint32_t*, const uint32_t indexCount, LeviathanRenderer::RendererResourceId::IdType& outId)
+		{
+			CreatedBytes += indexCount * sizeof(uint32_t);
+			outId = 0;
+			return true;
+		}
+
+		bool CreateTexture2D(uint32_t, const uint32_t height, const void*, const uint32_t rowSizeBytes, bool, bool, bool, LeviathanRenderer::RendererResourceId::IdType& outId)
+		{
+			CreatedBytes += static_cast<size_t>(rowSizeBytes) * height;
+			outId = 0;
+			return true;
+		}
+
+		bool CreateTextureCube(const uint32_t faceWidth, const void* const*, bool, bool, bool, LeviathanRenderer::RendererResourceId::IdType& outId)
+		{
+			CreatedBytes += static_cast<size_t>(faceWidth) * faceWidth * LeviathanRenderer::UploadQueue::TextureCubeBytesPerPixel *
+				LeviathanRenderer::UploadQueue::TextureCubeFaceCount;
+			outId = 0;
+			return true;
+		}
+
+		bool SetTexture2DMips(LeviathanRenderer::RendererResourceId::IdType, const uint32_t width, const uint32_t height, uint32_t, const void* const*,
+			const uint32_t loadedMipCount)
+		{
+			for (uint32_t mip = 0; mip < loadedMipCount; ++mip)
+			{
+				CreatedBytes += static_cast<size_t>(std::max(width >> mip, 1u)) * std::max(height >> mip, 1u) *
+					LeviathanRenderer::UploadQueue::Texture2DMipsBytesPerPixel;
+			}
+			return true;
+		}
+	};
+
+	void RunUploadQueueBenchmarks(Harness& harness)
+	{
+		const std::string name = "UploadQueue.EnqueueAndProcess.2kMixed.JobSystem";
+		if (!harness.IsEnabled(name))
+		{
+			return;
+		}
+
+		const bool startedJobSystem = LeviathanCore::JobSystem::Initialize();
+
+		UploadScene scene = {};
+		MakeUploadScene(scene);
+
+		// Requests staged from every thread and created frame by frame within the budget.
+		size_t frames = 0;
+		// Frames creating several uploads and the bytes they create, excluding the last frame.
+		size_t budgetedFrames = 0;
+		size_t budgetedBytes = 0;
+		const BenchmarkResult* const result = harness.Run(name, UploadRequestCount, [&]()
+			{
+				LeviathanRenderer::UploadQueue queue(UploadBudgetBytes);
+				LeviathanCore::JobSystem::ParallelFor(UploadRequestCount, 64, [&](const size_t first, const size_t count, size_t)
+					{
+						for (size_t i = first; i < first + count; ++i)
+						{
+							EnqueueUploadRequest(queue, scene, scene.Requests[i]);
+						}
+					});
+
+				CountingUploadBackend backend = {};
+				frames = 0;
+				budgetedFrames = 0;
+				budgetedBytes = 0;
+				do
+				{
+					queue.Process(backend);
+					++frames;
+					const LeviathanRenderer::UploadQueueStats& stats = queue.GetStats();
+					if ((stats.LastFrameUploads > 1) && (stats.PendingBytes > 0))
+					{
+						++budgetedFrames;
+						budgetedBytes += stats.LastFrameBytes;
+					}
+				} while (queue.GetStats().PendingBytes > 0);
+				Consume(&backend.CreatedBytes);
+			});
+		if (result != nullptr)
+		{
+			harness.AddMetric(name, "threads", static_cast<double>(LeviathanCore::JobSystem::GetThreadCount()));
+			harness.AddMetric(name, "totalMegabytes", static_cast<double>(scene.TotalBytes) / (1024.0 * 1024.0));
+			harness.AddMetric(name, "frames", static_cast<double>(frames));
+			harness.AddMetric(name, "budgetUtilization", (budgetedFrames > 0) ?
+				static_cast<double>(budgetedBytes) / static_cast<double>(budgetedFrames * UploadBudgetBytes) : 0.0);
+		}
+
+		if (startedJobSystem)
+		{
+			LeviathanCore::JobSystem::Shutdown();
+		}
+	}
+}
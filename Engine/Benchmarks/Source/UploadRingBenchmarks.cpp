@@ -0,0 +1,139 @@
+#include "BenchmarkSuites.h"
+#include "Benchmark.h"
+#include "UploadRing.h"
+#include "RendererConstants.h"
+
+namespace LeviathanBenchmarks
+{
+	static constexpr size_t SimulatedFrameCount = 4096;
+
+	struct UploadScenario
+	{
+		size_t CapacityBytes = 0;
+		uint32_t MinAllocationsPerFrame = 0;
+		uint32_t MaxAllocationsPerFrame = 0;
+		uint32_t MinSizeBytes = 0;
+		uint32_t MaxSizeBytes = 0;
+		// The simulated gpu completes frames up to this many frames behind the cpu, chosen at random every frame.
+		uint32_t MaxGpuLatencyFrames = 0;
+		uint32_t Seed = 0;
+	};
+
+	struct UploadStats
+	{
+		uint64_t Allocations = 0;
+		uint64_t FailedAllocations = 0;
+		uint64_t Waits = 0;
+		size_t PeakUsedBytes = 0;
+	};
+
+	// Records SimulatedFrameCount frames of constant data the way LeviathanRenderer::Render does: allocate, write, end the frame with an increasing
+	// fence value and retire frames the gpu completed. Waits for the oldest frame in flight when the ring is full.
+	static UploadStats SimulateFrames(const UploadScenario& scenario, LeviathanRenderer::UploadRing& ring, std::vector<uint8_t>& memory)
+	{
+		std::mt19937 random(scenario.Seed);
+		std::uniform_int_distribution<uint32_t> countDistribution(scenario.MinAllocationsPerFrame, scenario.MaxAllocationsPerFrame);
+		std::uniform_int_distribution<uint32_t> sizeDistribution(scenario.MinSizeBytes, scenario.MaxSizeBytes);
+		std::uniform_int_distribution<uint32_t> latencyDistribution(0, scenario.MaxGpuLatencyFrames);
+
+		ring.Initialize(scenario.CapacityBytes, LeviathanRenderer::RendererConstants::ConstantUploadAlignmentBytes, LeviathanRenderer::RendererConstants::MaxFramesInFlight);
+
+		UploadStats stats = {};
+		uint64_t signalledFence = 0;
+
+		for (size_t frame = 0; frame < SimulatedFrameCount; ++frame)
+		{
+			const uint32_t latency = latencyDistribution(random);
+			if (signalledFence > latency)
+			{
+				ring.Retire(signalledFence - latency);
+			}
+
+			if (!ring.BeginFrame())
+			{
+				++stats.Waits;
+				ring.Retire(ring.GetOldestFrameFence());
+				ring.BeginFrame();
+			}
+
+			const uint64_t fence = signalledFence + 1;
+			const uint32_t allocationCount = countDistribution(random);
+			for (uint32_t allocationIndex = 0; allocationIndex < allocationCount; ++allocationIndex)
+			{
+				const size_t sizeBytes = sizeDistribution(random);
+				size_t offset = ring.Allocate(sizeBytes);
+				while ((offset == LeviathanRenderer::UploadRing::InvalidOffset) && (ring.GetFrameInFlightCount() > 0))
+				{
+					++stats.Waits;
+					ring.Retire(ring.GetOldestFrameFence());
+					offset = ring.Allocate(sizeBytes);
+				}
+
+				++stats.Allocations;
+				if (offset == LeviathanRenderer::UploadRing::InvalidOffset)
+				{
+					++stats.FailedAllocations;
+					continue;
+				}
+
+				memset(memory.data() + offset, static_cast<uint8_t>(fence * 31 + allocationIndex), sizeBytes);
+			}
+
+			stats.PeakUsedBytes = std::max(stats.PeakUsedBytes, ring.GetUsedBytes());
+			ring.EndFrame(fence);
+			signalledFence = fence;
+		}
+
+		ring.Retire(signalledFence);
+		return stats;
+	}
+
+	static void RunUploadScenario(Harness& harness, const std::string_view scenarioName, const UploadScenario& scenario)
+	{
+		LeviathanRenderer::UploadRing ring = {};
+		std::vector<uint8_t> memory(scenario.CapacityBytes, 0);
+
+		// Count allocations up front so that throughput is reported per allocation.
+		const UploadStats expected = SimulateFrames(scenario, ring, memory);
+
+		const std::string name = "UploadRing.Frames." + std::string(scenarioName);
+		UploadStats stats = {};
+		const BenchmarkResult* const result = harness.Run(name, expected.Allocations, [&]()
+			{
+				stats = SimulateFrames(scenario, ring, memory);
+				Consume(memory.data());
+			});
+		if (result != nullptr)
+		{
+			harness.AddMetric(name, "frames", static_cast<double>(SimulatedFrameCount));
+			harness.AddMetric(name, "wraps", static_cast<double>(ring.GetWrapCount()));
+			harness.AddMetric(name, "waits", static_cast<double>(stats.Waits));
+			harness.AddMetric(name, "peakUsedBytes", static_cast<double>(stats.PeakUsedBytes));
+		}
+	}
+
+	void RunUploadRingBenchmarks(Harness& harness)
+	{
+		// Light and skybox constants of a frame with 2 directional, 16 point and 16 spot lights in the renderer's upload buffer.
+		UploadScenario lightConstants = {};
+		lightConstants.CapacityBytes = LeviathanRenderer::RendererConstants::ConstantUploadBufferSizeBytes;
+		lightConstants.MinAllocationsPerFrame = 35;
+		lightConstants.MaxAllocationsPerFrame = 35;
+		lightConstants.MinSizeBytes = 32;
+		lightConstants.MaxSizeBytes = 128;
+		lightConstants.MaxGpuLatencyFrames = 2;
+		lightConstants.Seed = 1357;
+		RunUploadScenario(harness, "LightConstants", lightConstants);
+
+		// Random sizes in a small buffer with a gpu that can fall further behind than the frames in flight, forcing frequent wraps and waits.
+		UploadScenario randomSizes = {};
+		randomSizes.CapacityBytes = 64 * 1024;
+		randomSizes.MinAllocationsPerFrame = 1;
+		randomSizes.MaxAllocationsPerFrame = 16;
+		randomSizes.MinSizeBytes = 1;
+		randomSizes.MaxSizeBytes = 2048;
+		randomSizes.MaxGpuLatencyFrames = 4;
+		randomSizes.Seed = 2468;
+		RunUploadScenario(harness, "RandomSizes", randomSizes);
+	}
+}
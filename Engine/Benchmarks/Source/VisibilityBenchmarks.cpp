@@ -0,0 +1,60 @@
+#include "BenchmarkSuites.h"
+#include "Benchmark.h"
+#include "TestFixtures.h"
+#include "MathTypes.h"
+#include "BoundingVolumes.h"
+#include "JobSystem.h"
+#include "VisibilityCulling.h"
+
+namespace LeviathanBenchmarks
+{
+	static constexpr std::array<size_t, 3> RenderableCounts = { 100000, 250000, 1000000 };
+	static constexpr float SceneHalfSize = 1000.0f;
+	static constexpr float FarPlane = 800.0f;
+
+	static void RunFrustumCullingBenchmarks(Harness& harness, const std::string_view threadingName, const LeviathanCore::BoundingVolumes::Frustum& frustum,
+		const std::vector<LeviathanCore::BoundingVolumes::AABBArray>& boundsSets)
+	{
+		for (const LeviathanCore::BoundingVolumes::AABBArray& bounds : boundsSets)
+		{
+			const std::string name = "Visibility.FrustumCull.AABB." + std::to_string(bounds.Size()) + "." + std::string(threadingName);
+			const LeviathanCore::BoundingVolumes::AABBSoA view = bounds.View();
+
+			LeviathanRenderer::FrustumCullingStage stage = {};
+			if (harness.Run(name, bounds.Size(), [&]()
+				{
+					stage.Cull(frustum, view);
+					Consume(stage.GetVisibleIndices());
+				}))
+			{
+				harness.AddMetric(name, "visible", static_cast<double>(stage.GetVisibleCount()));
+				harness.AddMetric(name, "threads", static_cast<double>(LeviathanCore::JobSystem::GetThreadCount()));
+			}
+		}
+	}
+
+	void RunVisibilityBenchmarks(Harness& harness)
+	{
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> positionDistribution(-SceneHalfSize, SceneHalfSize);
+		std::uniform_real_distribution<float> sizeDistribution(0.25f, 4.0f);
+
+		std::vector<LeviathanCore::BoundingVolumes::AABBArray> boundsSets(RenderableCounts.size());
+		for (size_t set = 0; set < RenderableCounts.size(); ++set)
+		{
+			for (size_t i = 0; i < RenderableCounts[set]; ++i)
+			{
+				const LeviathanCore::MathTypes::Vector3 center(positionDistribution(random), positionDistribution(random), positionDistribution(random));
+				const LeviathanCore::MathTypes::Vector3 halfExtents(sizeDistribution(random), sizeDistribution(random), sizeDistribution(random));
+				boundsSets[set].Add(LeviathanCore::BoundingVolumes::AABB{ center - halfExtents, center + halfExtents });
+			}
+		}
+
+		const LeviathanCore::BoundingVolumes::Frustum frustum = LeviathanTestFixtures::MakeFrustum(FarPlane);
+
+		LeviathanTestFixtures::RunSingleThreadAndJobSystem(0, [&](const std::string_view threadingName)
+			{
+				RunFrustumCullingBenchmarks(harness, threadingName, frustum, boundsSets);
+			});
+	}
+}
@@ -1,5 +1,38 @@
 #include "AssetTypes.h"
 
+void LeviathanAssets::AssetTypes::Mesh::CalculateBounds()
+{
+	Bounds = LeviathanCore::BoundingVolumes::AABB::FromPoints(Positions.data(), Positions.size());
+	BoundingSphere = LeviathanCore::BoundingVolumes::Sphere::FromPoints(Positions.data(), Positions.size());
+}
+
+float LeviathanAssets::AssetTypes::Mesh::CalculateTextureCoordinateDensity() const
+{
+	if ((TextureCoordinates.size() != Positions.size()) || (Indices.size() < 3))
+	{
+		return 0.0f;
+	}
+
+	double area = 0.0;
+	double textureCoordinateArea = 0.0;
+	for (size_t i = 0; i + 2 < Indices.size(); i += 3)
+	{
+		const uint32_t a = Indices[i];
+		const uint32_t b = Indices[i + 1];
+		const uint32_t c = Indices[i + 2];
+		if ((a >= Positions.size()) || (b >= Positions.size()) || (c >= Positions.size()))
+		{
+			return 0.0f;
+		}
+
+		area += LeviathanCore::MathTypes::Vector3::CrossProduct(Positions[b] - Positions[a], Positions[c] - Positions[a]).Length();
+		const LeviathanCore::MathTypes::Vector2 uvB = TextureCoordinates[b] - TextureCoordinates[a];
+		const LeviathanCore::MathTypes::Vector2 uvC = TextureCoordinates[c] - TextureCoordinates[a];
+		textureCoordinateArea += std::abs((uvB.X() * uvC.Y()) - (uvB.Y() * uvC.X()));
+	}
+	return (area > 0.0) ? static_cast<float>(std::sqrt(textureCoordinateArea / area)) : 0.0f;
+}
+
 void LeviathanAssets::AssetTypes::Texture::FlipGreenChannel()
 {
 	const size_t pixelCount = static_cast<size_t>(Width * Height);
@@ -0,0 +1,401 @@
+#include "EnvironmentCubemap.h"
+#include "AssetTypes.h"
+#include "FastMath.h"
+#include "JobSystem.h"
+#include "Logging.h"
+#include "Serialize.h"
+
+namespace LeviathanAssets
+{
+	namespace EnvironmentCubemap
+	{
+		struct FileHeader
+		{
+			LeviathanCore::Serialize::FileTag Tag = {};
+			uint32_t FaceSize = 0;
+			uint32_t MipCount = 0;
+			uint32_t FacePrecision = 0;
+			uint32_t SampleFilter = 0;
+			uint64_t ExtraSizeBytes = 0;
+			uint64_t SourceSizeBytes = 0;
+			int64_t SourceWriteTime = 0;
+		};
+
+		struct EquirectangularSource
+		{
+			const float* Texels = nullptr;
+			int32_t Width = 0;
+			int32_t Height = 0;
+		};
+
+		static constexpr float InverseTwoPi = 0.159154943091895336f;
+		static constexpr float InversePi = 0.318309886183790672f;
+
+		// Bilinear samples per parallel for range.
+		static constexpr size_t SamplesPerJob = 32768;
+
+		// Adds weight times the bilinear sample of the equirectangular texture at (u, v) to the rgba sum.
+		static inline void AccumulateSample(const EquirectangularSource& source, const float u, const float v, const float weight, float* const sum)
+		{
+			const float x = (u * static_cast<float>(source.Width)) - 0.5f;
+			const float y = (v * static_cast<float>(source.Height)) - 0.5f;
+			const float floorX = std::floor(x);
+			const float floorY = std::floor(y);
+			const float fractionX = x - floorX;
+			const float fractionY = y - floorY;
+
+			int32_t x0 = static_cast<int32_t>(floorX);
+			x0 = (x0 < 0) ? (x0 + source.Width) : ((x0 >= source.Width) ? (x0 - source.Width) : x0);
+			const int32_t x1 = (x0 + 1 == source.Width) ? 0 : (x0 + 1);
+			const int32_t y0 = std::clamp(static_cast<int32_t>(floorY), 0, source.Height - 1);
+			const int32_t y1 = std::clamp(static_cast<int32_t>(floorY) + 1, 0, source.Height - 1);
+
+			const float* const row0 = source.Texels + (static_cast<size_t>(y0) * source.Width * ChannelCount);
+			const float* const row1 = source.Texels + (static_cast<size_t>(y1) * source.Width * ChannelCount);
+			AccumulateBilinearSample(row0, row1, static_cast<size_t>(x0), static_cast<size_t>(x1), fractionX, fractionY, weight, sum);
+		}
+
+		uint32_t GetBytesPerTexel(const Precision precision)
+		{
+			return ChannelCount * ((precision == Precision::Float16) ? 2 : 4);
+		}
+
+		uint32_t GetMaxMipCount(uint32_t faceSize)
+		{
+			uint32_t mipCount = 1;
+			while (faceSize > 1)
+			{
+				faceSize >>= 1;
+				++mipCount;
+			}
+			return mipCount;
+		}
+
+		uint32_t GetMipFaceSize(const uint32_t faceSize, const uint32_t mip)
+		{
+			return std::max(faceSize >> mip, 1u);
+		}
+
+		size_t GetFaceSizeBytes(const Header& header)
+		{
+			return static_cast<size_t>(header.FaceSize) * header.FaceSize * GetBytesPerTexel(header.FacePrecision);
+		}
+
+		size_t GetFaceDataSizeBytes(const Header& header)
+		{
+			size_t sizeBytes = 0;
+			for (uint32_t mip = 0; mip < header.MipCount; ++mip)
+			{
+				const size_t mipFaceSize = GetMipFaceSize(header.FaceSize, mip);
+				sizeBytes += mipFaceSize * mipFaceSize * GetBytesPerTexel(header.FacePrecision) * FaceCount;
+			}
+			return sizeBytes;
+		}
+
+		uint32_t GetSupersampleCount(const uint32_t sourceWidth, const uint32_t faceSize, const Filter filter)
+		{
+			if ((filter == Filter::Bilinear) || (faceSize == 0))
+			{
+				return 1;
+			}
+
+			// A face spans a quarter of the equirectangular texture's width at the horizon.
+			const uint64_t faceSpan = 4 * static_cast<uint64_t>(faceSize);
+			return static_cast<uint32_t>(std::clamp<uint64_t>((sourceWidth + faceSpan - 1) / faceSpan, 1, MaxSupersampleCount));
+		}
+
+		void GetFaceDirection(const uint32_t face, const float s, const float t, float& outX, float& outY, float& outZ)
+		{
+			switch (face)
+			{
+			case 0: outX = 1.0f; outY = -t; outZ = -s; break;
+			case 1: outX = -1.0f; outY = -t; outZ = s; break;
+			case 2: outX = s; outY = 1.0f; outZ = t; break;
+			case 3: outX = s; outY = -1.0f; outZ = -t; break;
+			case 4: outX = s; outY = -t; outZ = 1.0f; break;
+			default: outX = -s; outY = -t; outZ = -1.0f; break;
+			}
+		}
+
+		void GetFaceCoordinates(const float x, const float y, const float z, uint32_t& outFace, float& outS, float& outT)
+		{
+			const float absX = std::fabs(x);
+			const float absY = std::fabs(y);
+			const float absZ = std::fabs(z);
+			if ((absX >= absY) && (absX >= absZ))
+			{
+				outFace = (x > 0.0f) ? 0 : 1;
+				outS = ((x > 0.0f) ? -z : z) / absX;
+				outT = -y / absX;
+			}
+			else if (absY >= absZ)
+			{
+				outFace = (y > 0.0f) ? 2 : 3;
+				outS = x / absY;
+				outT = ((y > 0.0f) ? z : -z) / absY;
+			}
+			else
+			{
+				outFace = (z > 0.0f) ? 4 : 5;
+				outS = ((z > 0.0f) ? x : -x) / absZ;
+				outT = -y / absZ;
+			}
+		}
+
+		// Solid angle of the face region from the face center to (s, t).
+		static inline float GetAreaElement(const float s, const float t)
+		{
+			return std::atan2(s * t, std::sqrt((s * s) + (t * t) + 1.0f));
+		}
+
+		float GetTexelSolidAngle(const uint32_t faceSize, const uint32_t x, const uint32_t y)
+		{
+			const float texelSize = 2.0f / static_cast<float>(faceSize);
+			const float s0 = (static_cast<float>(x) * texelSize) - 1.0f;
+			const float t0 = (static_cast<float>(y) * texelSize) - 1.0f;
+			const float s1 = s0 + texelSize;
+			const float t1 = t0 + texelSize;
+			return GetAreaElement(s0, t0) - GetAreaElement(s0, t1) - GetAreaElement(s1, t0) + GetAreaElement(s1, t1);
+		}
+
+		uint16_t FloatToHalf(const float value)
+		{
+			const uint32_t bits = std::bit_cast<uint32_t>(value);
+			const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000u);
+			const uint32_t magnitude = bits & 0x7fffffffu;
+			if (magnitude > 0x7f800000u)
+			{
+				return sign | 0x7e00u;
+			}
+			if (magnitude >= 0x477fe000u)
+			{
+				// 65504, the largest half.
+				return sign | 0x7bffu;
+			}
+			if (magnitude < 0x38800000u)
+			{
+				// Denormal halves count 2^-24 steps. Rounds half to even.
+				if (magnitude < 0x33000000u)
+				{
+					return sign;
+				}
+				const uint32_t mantissa = (magnitude & 0x007fffffu) | 0x00800000u;
+				const uint32_t shift = 126 - (magnitude >> 23);
+				const uint32_t half = mantissa >> shift;
+				const uint32_t remainder = mantissa & ((1u << shift) - 1);
+				const uint32_t halfway = 1u << (shift - 1);
+				const uint32_t roundUp = ((remainder > halfway) || ((remainder == halfway) && ((half & 1) != 0))) ? 1 : 0;
+				return sign | static_cast<uint16_t>(half + roundUp);
+			}
+
+			// Rebias the exponent from 127 to 15 and round the mantissa half to even.
+			const uint32_t rounded = magnitude + 0x0fffu + ((magnitude >> 13) & 1u);
+			return sign | static_cast<uint16_t>((rounded - 0x38000000u) >> 13);
+		}
+
+		float HalfToFloat(const uint16_t value)
+		{
+			const uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+			const uint32_t exponent = (value >> 10) & 0x1fu;
+			const uint32_t mantissa = value & 0x03ffu;
+			if (exponent == 0)
+			{
+				const float denormal = static_cast<float>(mantissa) * 5.9604644775390625e-8f;
+				return (sign != 0) ? -denormal : denormal;
+			}
+			if (exponent == 0x1f)
+			{
+				return std::bit_cast<float>(sign | 0x7f800000u | (mantissa << 13));
+			}
+			return std::bit_cast<float>(sign | ((exponent + 112) << 23) | (mantissa << 13));
+		}
+
+		bool Convert(const AssetTypes::HDRTexture& equirectangular, const Settings& settings, Header& outHeader, std::vector<uint8_t>& outFaceData)
+		{
+			outHeader = {};
+			outFaceData.clear();
+			if ((equirectangular.Data == nullptr) || (equirectangular.Width <= 0) || (equirectangular.Height <= 0) || (settings.FaceSize == 0) ||
+				(settings.FaceSize > MaxFaceSize))
+			{
+				return false;
+			}
+
+			outHeader.FaceSize = settings.FaceSize;
+			outHeader.FacePrecision = settings.FacePrecision;
+			outHeader.SampleFilter = settings.SampleFilter;
+			const size_t faceSizeBytes = GetFaceSizeBytes(outHeader);
+			outFaceData.resize(faceSizeBytes * FaceCount);
+
+			const EquirectangularSource source = { .Texels = equirectangular.Data, .Width = equirectangular.Width, .Height = equirectangular.Height };
+			const uint32_t faceSize = settings.FaceSize;
+			const uint32_t supersampleCount = GetSupersampleCount(static_cast<uint32_t>(equirectangular.Width), faceSize, settings.SampleFilter);
+			const size_t rowSampleCount = static_cast<size_t>(faceSize) * supersampleCount;
+			const float sampleWeight = 1.0f / static_cast<float>(supersampleCount * supersampleCount);
+			const uint32_t bytesPerTexel = GetBytesPerTexel(settings.FacePrecision);
+
+			// Per thread direction, angle and rgba sum scratch for a row of samples.
+			std::vector<std::vector<float>> threadScratch(LeviathanCore::JobSystem::GetThreadCount());
+			const size_t rowCount = static_cast<size_t>(FaceCount) * faceSize;
+			const size_t rowsPerJob = std::max<size_t>(SamplesPerJob / (rowSampleCount * supersampleCount), 1);
+			LeviathanCore::JobSystem::ParallelFor(rowCount, rowsPerJob, [&](const size_t firstRow, const size_t count, const size_t threadIndex)
+				{
+					std::vector<float>& scratch = threadScratch[threadIndex];
+					scratch.resize((rowSampleCount * 5) + (static_cast<size_t>(faceSize) * ChannelCount));
+					float* const x = scratch.data();
+					float* const y = x + rowSampleCount;
+					float* const z = y + rowSampleCount;
+					float* const horizontal = z + rowSampleCount;
+					float* const longitude = horizontal + rowSampleCount;
+					float* const latitude = x;
+					float* const sums = longitude + rowSampleCount;
+
+					for (size_t row = firstRow; row < firstRow + count; ++row)
+					{
+						const uint32_t face = static_cast<uint32_t>(row / faceSize);
+						const uint32_t faceRow = static_cast<uint32_t>(row % faceSize);
+						std::fill(sums, sums + (static_cast<size_t>(faceSize) * ChannelCount), 0.0f);
+
+						for (uint32_t subrow = 0; subrow < supersampleCount; ++subrow)
+						{
+							const float t = (2.0f * (static_cast<float>(faceRow) + ((static_cast<float>(subrow) + 0.5f) / static_cast<float>(supersampleCount))) /
+								static_cast<float>(faceSize)) - 1.0f;
+							for (size_t sample = 0; sample < rowSampleCount; ++sample)
+							{
+								const float s = (2.0f * (static_cast<float>(sample) + 0.5f) / static_cast<float>(rowSampleCount)) - 1.0f;
+								GetFaceDirection(face, s, t, x[sample], y[sample], z[sample]);
+								horizontal[sample] = std::sqrt((x[sample] * x[sample]) + (z[sample] * z[sample]));
+							}
+
+							// Latitude overwrites x once longitude is known.
+							LeviathanCore::FastMath::ATan2(z, x, longitude, rowSampleCount);
+							LeviathanCore::FastMath::ATan2(y, horizontal, latitude, rowSampleCount);
+
+							for (size_t sample = 0; sample < rowSampleCount; ++sample)
+							{
+								AccumulateSample(source, (longitude[sample] * InverseTwoPi) + 0.5f, (latitude[sample] * InversePi) + 0.5f, sampleWeight,
+									sums + ((sample / supersampleCount) * ChannelCount));
+							}
+						}
+
+						uint8_t* const target = outFaceData.data() + (face * faceSizeBytes) + (static_cast<size_t>(faceRow) * faceSize * bytesPerTexel);
+						for (uint32_t texel = 0; texel < faceSize; ++texel)
+						{
+							const std::array<float, ChannelCount> color = { sums[texel * ChannelCount], sums[(texel * ChannelCount) + 1],
+								sums[(texel * ChannelCount) + 2], 1.0f };
+							if (settings.FacePrecision == Precision::Float16)
+							{
+								const std::array<uint16_t, ChannelCount> halves = { FloatToHalf(color[0]), FloatToHalf(color[1]), FloatToHalf(color[2]),
+									FloatToHalf(color[3]) };
+								memcpy(target + (texel * bytesPerTexel), halves.data(), bytesPerTexel);
+							}
+							else
+							{
+								memcpy(target + (texel * bytesPerTexel), color.data(), bytesPerTexel);
+							}
+						}
+					}
+				});
+			return true;
+		}
+
+		bool Save(const std::string_view file, const Header& header, const std::vector<uint8_t>& faceData)
+		{
+			return Save(file, header, faceData, {});
+		}
+
+		bool Save(const std::string_view file, const Header& header, const std::vector<uint8_t>& faceData, const std::vector<uint8_t>& extraData)
+		{
+			if ((header.FaceSize == 0) || (header.FaceSize > MaxFaceSize) || (header.MipCount == 0) || (header.MipCount > GetMaxMipCount(header.FaceSize)) ||
+				(faceData.size() != GetFaceDataSizeBytes(header)))
+			{
+				LEVIATHAN_LOG("Failed to save environment cubemap %s. The face data does not match the header.", file.data());
+				return false;
+			}
+
+			FileHeader fileHeader = {};
+			fileHeader.Tag = FileTag;
+			fileHeader.FaceSize = header.FaceSize;
+			fileHeader.MipCount = header.MipCount;
+			fileHeader.FacePrecision = static_cast<uint32_t>(header.FacePrecision);
+			fileHeader.SampleFilter = static_cast<uint32_t>(header.SampleFilter);
+			fileHeader.ExtraSizeBytes = extraData.size();
+			fileHeader.SourceSizeBytes = header.Source.SizeBytes;
+			fileHeader.SourceWriteTime = header.Source.WriteTime;
+
+			std::vector<uint8_t> bytes(sizeof(FileHeader) + faceData.size() + extraData.size(), 0);
+			memcpy(bytes.data(), &fileHeader, sizeof(FileHeader));
+			memcpy(bytes.data() + sizeof(FileHeader), faceData.data(), faceData.size());
+			if (!extraData.empty())
+			{
+				memcpy(bytes.data() + sizeof(FileHeader) + faceData.size(), extraData.data(), extraData.size());
+			}
+			return LeviathanCore::Serialize::WriteBytesToFile(file, bytes);
+		}
+
+		bool Load(const std::string_view file, Header& outHeader, std::vector<uint8_t>& outFaceData)
+		{
+			std::vector<uint8_t> extraData = {};
+			return Load(file, outHeader, outFaceData, extraData);
+		}
+
+		bool Load(const std::string_view file, Header& outHeader, std::vector<uint8_t>& outFaceData, std::vector<uint8_t>& outExtraData)
+		{
+			outHeader = {};
+			outFaceData.clear();
+			outExtraData.clear();
+			std::vector<uint8_t> bytes = {};
+			if (!LeviathanCore::Serialize::FileExists(file) || !LeviathanCore::Serialize::ReadFile(file, true, bytes))
+			{
+				return false;
+			}
+
+			FileHeader fileHeader = {};
+			if (!LeviathanCore::Serialize::ReadFileHeader(bytes, FileTag, fileHeader) || (fileHeader.FaceSize == 0) || (fileHeader.FaceSize > MaxFaceSize) ||
+				(fileHeader.MipCount == 0) || (fileHeader.MipCount > GetMaxMipCount(fileHeader.FaceSize)) ||
+				(fileHeader.FacePrecision > static_cast<uint32_t>(Precision::Float16)) || (fileHeader.SampleFilter > static_cast<uint32_t>(Filter::Box)))
+			{
+				LEVIATHAN_LOG("Failed to load environment cubemap %s. The file is from another version or corrupt.", file.data());
+				return false;
+			}
+
+			const Header header = { .FaceSize = fileHeader.FaceSize, .MipCount = fileHeader.MipCount, .FacePrecision = static_cast<Precision>(fileHeader.FacePrecision),
+				.SampleFilter = static_cast<Filter>(fileHeader.SampleFilter),
+				.Source = { .SizeBytes = fileHeader.SourceSizeBytes, .WriteTime = fileHeader.SourceWriteTime } };
+			const size_t faceDataBytes = GetFaceDataSizeBytes(header);
+			if ((fileHeader.ExtraSizeBytes > bytes.size()) || (bytes.size() - sizeof(FileHeader) != faceDataBytes + fileHeader.ExtraSizeBytes))
+			{
+				LEVIATHAN_LOG("Failed to load environment cubemap %s. The face data is truncated.", file.data());
+				return false;
+			}
+
+			outHeader = header;
+			outFaceData.assign(bytes.begin() + sizeof(FileHeader), bytes.begin() + static_cast<ptrdiff_t>(sizeof(FileHeader) + faceDataBytes));
+			outExtraData.assign(bytes.begin() + static_cast<ptrdiff_t>(sizeof(FileHeader) + faceDataBytes), bytes.end());
+			return true;
+		}
+
+		void ToFloat32(const Header& header, const std::vector<uint8_t>& faceData, std::vector<float>& outFaceData)
+		{
+			const size_t valueCount = (GetFaceDataSizeBytes(header) / GetBytesPerTexel(header.FacePrecision)) * ChannelCount;
+			outFaceData.resize(valueCount);
+			if (faceData.size() != GetFaceDataSizeBytes(header))
+			{
+				outFaceData.clear();
+				return;
+			}
+
+			if (header.FacePrecision == Precision::Float32)
+			{
+				memcpy(outFaceData.data(), faceData.data(), faceData.size());
+				return;
+			}
+
+			for (size_t i = 0; i < valueCount; ++i)
+			{
+				uint16_t half = 0;
+				memcpy(&half, faceData.data() + (i * sizeof(uint16_t)), sizeof(uint16_t));
+				outFaceData[i] = HalfToFloat(half);
+			}
+		}
+	}
+}
@@ -0,0 +1,568 @@
+#include "ImageBasedLighting.h"
+#include "EnvironmentCubemap.h"
+#include "JobSystem.h"
+#include "Logging.h"
+#include "Serialize.h"
+
+namespace LeviathanAssets
+{
+	namespace ImageBasedLighting
+	{
+		// Stored after the specular faces, followed by the irradiance coefficients and the BRDF lookup table.
+		struct FileHeader
+		{
+			LeviathanCore::Serialize::FileTag Tag = {};
+			uint32_t BrdfLutSize = 0;
+			uint32_t SpecularFaceSize = 0;
+			uint32_t SpecularMipCount = 0;
+			uint32_t SpecularSampleCount = 0;
+			uint32_t BrdfLutSampleCount = 0;
+			uint32_t Reserved = 0;
+		};
+
+		struct CubeMip
+		{
+			const float* Texels = nullptr;
+			uint32_t FaceSize = 0;
+		};
+
+		// Light direction in the tangent space of the reflection direction with its weight and source mip.
+		struct SpecularSample
+		{
+			float X = 0.0f;
+			float Y = 0.0f;
+			float Z = 0.0f;
+			float Weight = 0.0f;
+			float Lod = 0.0f;
+		};
+
+		static constexpr float Pi = 3.14159265358979323846f;
+		static constexpr uint32_t FaceCount = EnvironmentCubemap::FaceCount;
+		static constexpr uint32_t ChannelCount = EnvironmentCubemap::ChannelCount;
+
+		// Irradiance of each band relative to the radiance projected to it, the clamped cosine lobe's coefficients divided by Pi.
+		static constexpr std::array<float, 3> SHBandConvolution = { 1.0f, 2.0f / 3.0f, 0.25f };
+
+		// Bilinear samples per parallel for range.
+		static constexpr size_t SamplesPerJob = 16384;
+
+		static double GetMillisecondsSince(const std::chrono::steady_clock::time_point start)
+		{
+			return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		}
+
+		// Van der Corput radical inverse in base 2, the second coordinate of the Hammersley point set.
+		static inline float RadicalInverse(uint32_t bits)
+		{
+			bits = (bits << 16) | (bits >> 16);
+			bits = ((bits & 0x55555555u) << 1) | ((bits & 0xaaaaaaaau) >> 1);
+			bits = ((bits & 0x33333333u) << 2) | ((bits & 0xccccccccu) >> 2);
+			bits = ((bits & 0x0f0f0f0fu) << 4) | ((bits & 0xf0f0f0f0u) >> 4);
+			bits = ((bits & 0x00ff00ffu) << 8) | ((bits & 0xff00ff00u) >> 8);
+			return static_cast<float>(bits) * 2.3283064365386963e-10f;
+		}
+
+		// Half vector around +Z distributed proportionally to the GGX normal distribution times N dot H.
+		static inline void ImportanceSampleGGX(const uint32_t sample, const uint32_t sampleCount, const float alpha, float& outX, float& outY, float& outZ)
+		{
+			const float u = static_cast<float>(sample) / static_cast<float>(sampleCount);
+			const float v = RadicalInverse(sample);
+			const float phi = 2.0f * Pi * u;
+			const float cosTheta = std::sqrt((1.0f - v) / (1.0f + (((alpha * alpha) - 1.0f) * v)));
+			const float sinTheta = std::sqrt(std::max(1.0f - (cosTheta * cosTheta), 0.0f));
+			outX = sinTheta * std::cos(phi);
+			outY = sinTheta * std::sin(phi);
+			outZ = cosTheta;
+		}
+
+		// Adds weight times the bilinear sample of a face at (s, t) to the rgba sum. Samples clamp to the face's edge texels.
+		static inline void AccumulateFaceSample(const CubeMip& mip, const uint32_t face, const float s, const float t, const float weight, float* const sum)
+		{
+			const int32_t faceSize = static_cast<int32_t>(mip.FaceSize);
+			const float x = (((s * 0.5f) + 0.5f) * static_cast<float>(faceSize)) - 0.5f;
+			const float y = (((t * 0.5f) + 0.5f) * static_cast<float>(faceSize)) - 0.5f;
+			const float floorX = std::floor(x);
+			const float floorY = std::floor(y);
+			const float fractionX = x - floorX;
+			const float fractionY = y - floorY;
+			const int32_t x0 = std::clamp(static_cast<int32_t>(floorX), 0, faceSize - 1);
+			const int32_t x1 = std::clamp(static_cast<int32_t>(floorX) + 1, 0, faceSize - 1);
+			const int32_t y0 = std::clamp(static_cast<int32_t>(floorY), 0, faceSize - 1);
+			const int32_t y1 = std::clamp(static_cast<int32_t>(floorY) + 1, 0, faceSize - 1);
+
+			const float* const faceTexels = mip.Texels + (static_cast<size_t>(face) * faceSize * faceSize * ChannelCount);
+			const float* const row0 = faceTexels + (static_cast<size_t>(y0) * faceSize * ChannelCount);
+			const float* const row1 = faceTexels + (static_cast<size_t>(y1) * faceSize * ChannelCount);
+			EnvironmentCubemap::AccumulateBilinearSample(row0, row1, static_cast<size_t>(x0), static_cast<size_t>(x1), fractionX, fractionY, weight, sum);
+		}
+
+		// Adds weight times the trilinear sample of the source mips in the direction (x, y, z) to the rgba sum.
+		static inline void AccumulateCubeSample(const std::vector<CubeMip>& mips, const float x, const float y, const float z, const float lod, const float weight,
+			float* const sum)
+		{
+			uint32_t face = 0;
+			float s = 0.0f;
+			float t = 0.0f;
+			EnvironmentCubemap::GetFaceCoordinates(x, y, z, face, s, t);
+
+			const float clampedLod = std::clamp(lod, 0.0f, static_cast<float>(mips.size() - 1));
+			const uint32_t mip = static_cast<uint32_t>(clampedLod);
+			const float fraction = clampedLod - static_cast<float>(mip);
+			if ((fraction <= 0.0f) || (mip + 1 >= mips.size()))
+			{
+				AccumulateFaceSample(mips[mip], face, s, t, weight, sum);
+				return;
+			}
+			AccumulateFaceSample(mips[mip], face, s, t, weight * (1.0f - fraction), sum);
+			AccumulateFaceSample(mips[mip + 1], face, s, t, weight * fraction, sum);
+		}
+
+		// Normalized direction through the center of texel (x, y) of a face.
+		static inline void GetTexelDirection(const uint32_t faceSize, const uint32_t face, const uint32_t x, const uint32_t y, float& outX, float& outY, float& outZ)
+		{
+			const float s = ((2.0f * (static_cast<float>(x) + 0.5f)) / static_cast<float>(faceSize)) - 1.0f;
+			const float t = ((2.0f * (static_cast<float>(y) + 0.5f)) / static_cast<float>(faceSize)) - 1.0f;
+			EnvironmentCubemap::GetFaceDirection(face, s, t, outX, outY, outZ);
+			const float inverseLength = 1.0f / std::sqrt((outX * outX) + (outY * outY) + (outZ * outZ));
+			outX *= inverseLength;
+			outY *= inverseLength;
+			outZ *= inverseLength;
+		}
+
+		// Halves the source mip chain with a 2x2 box filter while the face size is even.
+		static void BuildSourceMips(const float* const faces, const uint32_t faceSize, std::vector<float>& outStorage, std::vector<CubeMip>& outMips)
+		{
+			size_t storageSize = 0;
+			for (uint32_t size = faceSize; (size > 1) && ((size % 2) == 0); size /= 2)
+			{
+				storageSize += static_cast<size_t>(size / 2) * (size / 2) * FaceCount * ChannelCount;
+			}
+			outStorage.resize(storageSize);
+			outMips.clear();
+			outMips.push_back({ .Texels = faces, .FaceSize = faceSize });
+
+			float* target = outStorage.data();
+			while ((outMips.back().FaceSize > 1) && ((outMips.back().FaceSize % 2) == 0))
+			{
+				const CubeMip source = outMips.back();
+				const CubeMip mip = { .Texels = target, .FaceSize = source.FaceSize / 2 };
+				const size_t rowCount = static_cast<size_t>(FaceCount) * mip.FaceSize;
+				const size_t rowsPerJob = std::max<size_t>(SamplesPerJob / (static_cast<size_t>(mip.FaceSize) * 4), 1);
+				LeviathanCore::JobSystem::ParallelFor(rowCount, rowsPerJob, [&](const size_t firstRow, const size_t count, const size_t)
+					{
+						for (size_t row = firstRow; row < firstRow + count; ++row)
+						{
+							const size_t face = row / mip.FaceSize;
+							const size_t faceRow = row % mip.FaceSize;
+							const float* const sourceFace = source.Texels + (face * source.FaceSize * source.FaceSize * ChannelCount);
+							const float* const sourceRow0 = sourceFace + (faceRow * 2 * source.FaceSize * ChannelCount);
+							const float* const sourceRow1 = sourceRow0 + (static_cast<size_t>(source.FaceSize) * ChannelCount);
+							float* const targetRow = target + (row * mip.FaceSize * ChannelCount);
+							for (size_t x = 0; x < mip.FaceSize; ++x)
+							{
+								for (uint32_t channel = 0; channel < ChannelCount; ++channel)
+								{
+									const size_t left = (x * 2 * ChannelCount) + channel;
+									targetRow[(x * ChannelCount) + channel] = 0.25f * (sourceRow0[left] + sourceRow0[left + ChannelCount] + sourceRow1[left] +
+										sourceRow1[left + ChannelCount]);
+								}
+							}
+						}
+					});
+				outMips.push_back(mip);
+				target += static_cast<size_t>(mip.FaceSize) * mip.FaceSize * FaceCount * ChannelCount;
+			}
+		}
+
+		// Projects the radiance of the first mip no larger than MaxIrradianceSourceFaceSize, weighting texels by their solid angle. Rows are summed in
+		// parallel and reduced in order so results do not depend on the thread count.
+		static void ProjectIrradiance(const std::vector<CubeMip>& mips, std::array<float, SHCoefficientCount * 3>& outSH)
+		{
+			const CubeMip* source = &mips.back();
+			for (const CubeMip& mip : mips)
+			{
+				if (mip.FaceSize <= MaxIrradianceSourceFaceSize)
+				{
+					source = &mip;
+					break;
+				}
+			}
+
+			const uint32_t faceSize = source->FaceSize;
+			const size_t rowCount = static_cast<size_t>(FaceCount) * faceSize;
+			std::vector<double> rowSums(rowCount * SHCoefficientCount * 3, 0.0);
+			const size_t rowsPerJob = std::max<size_t>(SamplesPerJob / (static_cast<size_t>(faceSize) * 8), 1);
+			LeviathanCore::JobSystem::ParallelFor(rowCount, rowsPerJob, [&](const size_t firstRow, const size_t count, const size_t)
+				{
+					std::array<float, SHCoefficientCount> basis = {};
+					for (size_t row = firstRow; row < firstRow + count; ++row)
+					{
+						const uint32_t face = static_cast<uint32_t>(row / faceSize);
+						const uint32_t faceRow = static_cast<uint32_t>(row % faceSize);
+						const float* const texels = source->Texels + (row * faceSize * ChannelCount);
+						double* const sums = rowSums.data() + (row * SHCoefficientCount * 3);
+						for (uint32_t x = 0; x < faceSize; ++x)
+						{
+							float directionX = 0.0f;
+							float directionY = 0.0f;
+							float directionZ = 0.0f;
+							GetTexelDirection(faceSize, face, x, faceRow, directionX, directionY, directionZ);
+							EvaluateSHBasis(directionX, directionY, directionZ, basis);
+							const float solidAngle = EnvironmentCubemap::GetTexelSolidAngle(faceSize, x, faceRow);
+							for (uint32_t coefficient = 0; coefficient < SHCoefficientCount; ++coefficient)
+							{
+								const float weight = basis[coefficient] * solidAngle;
+								for (uint32_t channel = 0; channel < 3; ++channel)
+								{
+									sums[(coefficient * 3) + channel] += static_cast<double>(texels[(x * ChannelCount) + channel] * weight);
+								}
+							}
+						}
+					}
+				});
+
+			std::array<double, SHCoefficientCount * 3> totals = {};
+			for (size_t row = 0; row < rowCount; ++row)
+			{
+				for (size_t i = 0; i < totals.size(); ++i)
+				{
+					totals[i] += rowSums[(row * SHCoefficientCount * 3) + i];
+				}
+			}
+			for (uint32_t coefficient = 0; coefficient < SHCoefficientCount; ++coefficient)
+			{
+				const uint32_t band = (coefficient == 0) ? 0 : ((coefficient < 4) ? 1 : 2);
+				for (uint32_t channel = 0; channel < 3; ++channel)
+				{
+					outSH[(coefficient * 3) + channel] = static_cast<float>(totals[(coefficient * 3) + channel]) * SHBandConvolution[band];
+				}
+			}
+		}
+
+		// GGX samples of a mip with filtered importance sampling, reading each sample from the source mip whose texels cover the sample's share of the
+		// lobe's solid angle. Mip 0 is a single mirror sample.
+		static void BuildSpecularSamples(const uint32_t mip, const uint32_t mipCount, const uint32_t sampleCount, const uint32_t sourceFaceSize,
+			const uint32_t mipFaceSize, std::vector<SpecularSample>& outSamples)
+		{
+			outSamples.clear();
+
+			// Texels of the target mip cover this many source mips.
+			const float minLod = std::max(std::log2(static_cast<float>(sourceFaceSize) / static_cast<float>(mipFaceSize)), 0.0f);
+			const float roughness = GetSpecularMipRoughness(mip, mipCount);
+			if (roughness <= 0.0f)
+			{
+				outSamples.push_back({ .X = 0.0f, .Y = 0.0f, .Z = 1.0f, .Weight = 1.0f, .Lod = minLod });
+				return;
+			}
+
+			const float alpha = roughness * roughness;
+			const float alphaSquared = alpha * alpha;
+			const float texelSolidAngle = (4.0f * Pi) / (static_cast<float>(FaceCount) * static_cast<float>(sourceFaceSize) * static_cast<float>(sourceFaceSize));
+			for (uint32_t sample = 0; sample < sampleCount; ++sample)
+			{
+				float hX = 0.0f;
+				float hY = 0.0f;
+				float hZ = 0.0f;
+				ImportanceSampleGGX(sample, sampleCount, alpha, hX, hY, hZ);
+
+				// Reflect the view direction, equal to the normal, about the half vector.
+				const float lZ = (2.0f * hZ * hZ) - 1.0f;
+				if (lZ <= 0.0f)
+				{
+					continue;
+				}
+
+				// With N = V the pdf of the light direction is D(h) * (N dot H) / (4 * (V dot H)) = D(h) / 4.
+				const float denominator = (hZ * hZ * (alphaSquared - 1.0f)) + 1.0f;
+				const float distribution = alphaSquared / (Pi * denominator * denominator);
+				const float sampleSolidAngle = 1.0f / (static_cast<float>(sampleCount) * distribution * 0.25f);
+				const float lod = std::max((0.5f * std::log2(sampleSolidAngle / texelSolidAngle)) + 1.0f, minLod);
+				outSamples.push_back({ .X = 2.0f * hZ * hX, .Y = 2.0f * hZ * hY, .Z = lZ, .Weight = lZ, .Lod = lod });
+			}
+		}
+
+		static void PrefilterSpecularMip(const std::vector<CubeMip>& sourceMips, const std::vector<SpecularSample>& samples, const uint32_t faceSize,
+			float* const target)
+		{
+			float totalWeight = 0.0f;
+			for (const SpecularSample& sample : samples)
+			{
+				totalWeight += sample.Weight;
+			}
+			const float inverseTotalWeight = 1.0f / totalWeight;
+
+			const size_t rowCount = static_cast<size_t>(FaceCount) * faceSize;
+			const size_t rowsPerJob = std::max<size_t>(SamplesPerJob / (static_cast<size_t>(faceSize) * samples.size()), 1);
+			LeviathanCore::JobSystem::ParallelFor(rowCount, rowsPerJob, [&](const size_t firstRow, const size_t count, const size_t)
+				{
+					for (size_t row = firstRow; row < firstRow + count; ++row)
+					{
+						const uint32_t face = static_cast<uint32_t>(row / faceSize);
+						const uint32_t faceRow = static_cast<uint32_t>(row % faceSize);
+						for (uint32_t x = 0; x < faceSize; ++x)
+						{
+							float nX = 0.0f;
+							float nY = 0.0f;
+							float nZ = 0.0f;
+							GetTexelDirection(faceSize, face, x, faceRow, nX, nY, nZ);
+
+							// Tangent frame around the normal.
+							const bool useZUp = std::fabs(nZ) < 0.999f;
+							const float upX = useZUp ? 0.0f : 1.0f;
+							const float upZ = useZUp ? 1.0f : 0.0f;
+							float tX = -upZ * nY;
+							float tY = (upZ * nX) - (upX * nZ);
+							float tZ = upX * nY;
+							const float inverseTangentLength = 1.0f / std::sqrt((tX * tX) + (tY * tY) + (tZ * tZ));
+							tX *= inverseTangentLength;
+							tY *= inverseTangentLength;
+							tZ *= inverseTangentLength;
+							const float bX = (nY * tZ) - (nZ * tY);
+							const float bY = (nZ * tX) - (nX * tZ);
+							const float bZ = (nX * tY) - (nY * tX);
+
+							std::array<float, ChannelCount> sum = {};
+							for (const SpecularSample& sample : samples)
+							{
+								AccumulateCubeSample(sourceMips, (tX * sample.X) + (bX * sample.Y) + (nX * sample.Z), (tY * sample.X) + (bY * sample.Y) + (nY * sample.Z),
+									(tZ * sample.X) + (bZ * sample.Y) + (nZ * sample.Z), sample.Lod, sample.Weight, sum.data());
+							}
+
+							float* const texel = target + (((row * faceSize) + x) * ChannelCount);
+							texel[0] = sum[0] * inverseTotalWeight;
+							texel[1] = sum[1] * inverseTotalWeight;
+							texel[2] = sum[2] * inverseTotalWeight;
+							texel[3] = 1.0f;
+						}
+					}
+				});
+		}
+
+		uint32_t GetSpecularMipFaceSize(const uint32_t specularFaceSize, const uint32_t mip)
+		{
+			return EnvironmentCubemap::GetMipFaceSize(specularFaceSize, mip);
+		}
+
+		size_t GetSpecularMipOffset(const uint32_t specularFaceSize, const uint32_t mip)
+		{
+			size_t offset = 0;
+			for (uint32_t i = 0; i < mip; ++i)
+			{
+				const size_t faceSize = GetSpecularMipFaceSize(specularFaceSize, i);
+				offset += faceSize * faceSize * FaceCount * ChannelCount;
+			}
+			return offset;
+		}
+
+		float GetSpecularMipRoughness(const uint32_t mip, const uint32_t mipCount)
+		{
+			return (mipCount > 1) ? (static_cast<float>(mip) / static_cast<float>(mipCount - 1)) : 0.0f;
+		}
+
+		void EvaluateSHBasis(const float x, const float y, const float z, std::array<float, SHCoefficientCount>& outBasis)
+		{
+			outBasis[0] = 0.282095f;
+			outBasis[1] = 0.488603f * y;
+			outBasis[2] = 0.488603f * z;
+			outBasis[3] = 0.488603f * x;
+			outBasis[4] = 1.092548f * x * y;
+			outBasis[5] = 1.092548f * y * z;
+			outBasis[6] = 0.315392f * ((3.0f * z * z) - 1.0f);
+			outBasis[7] = 1.092548f * x * z;
+			outBasis[8] = 0.546274f * ((x * x) - (y * y));
+		}
+
+		void EvaluateIrradiance(const BakedLighting& lighting, const float x, const float y, const float z, std::array<float, 3>& outColor)
+		{
+			std::array<float, SHCoefficientCount> basis = {};
+			EvaluateSHBasis(x, y, z, basis);
+			outColor = {};
+			for (uint32_t coefficient = 0; coefficient < SHCoefficientCount; ++coefficient)
+			{
+				for (uint32_t channel = 0; channel < 3; ++channel)
+				{
+					outColor[channel] += lighting.IrradianceSH[(coefficient * 3) + channel] * basis[coefficient];
+				}
+			}
+			for (float& channel : outColor)
+			{
+				channel = std::max(channel, 0.0f);
+			}
+		}
+
+		void IntegrateBrdf(const float nDotV, const float roughness, const uint32_t sampleCount, float& outScale, float& outBias)
+		{
+			const float clampedNDotV = std::clamp(nDotV, 1e-4f, 1.0f);
+			const float vX = std::sqrt(1.0f - (clampedNDotV * clampedNDotV));
+			const float vZ = clampedNDotV;
+			const float alpha = roughness * roughness;
+			// Schlick-GGX geometry term with k remapped for image based lighting.
+			const float k = alpha * 0.5f;
+			const float geometryV = clampedNDotV / ((clampedNDotV * (1.0f - k)) + k);
+
+			float scale = 0.0f;
+			float bias = 0.0f;
+			for (uint32_t sample = 0; sample < sampleCount; ++sample)
+			{
+				float hX = 0.0f;
+				float hY = 0.0f;
+				float hZ = 0.0f;
+				ImportanceSampleGGX(sample, sampleCount, alpha, hX, hY, hZ);
+				const float vDotH = std::max((vX * hX) + (vZ * hZ), 0.0f);
+				const float nDotL = (2.0f * vDotH * hZ) - vZ;
+				if ((nDotL <= 0.0f) || (hZ <= 0.0f))
+				{
+					continue;
+				}
+
+				// The BRDF times N dot L over the pdf of the light direction.
+				const float geometry = geometryV * (nDotL / ((nDotL * (1.0f - k)) + k));
+				const float visibility = (geometry * vDotH) / (hZ * clampedNDotV);
+				const float oneMinusVDotH = 1.0f - vDotH;
+				const float fresnel = (oneMinusVDotH * oneMinusVDotH) * (oneMinusVDotH * oneMinusVDotH) * oneMinusVDotH;
+				scale += (1.0f - fresnel) * visibility;
+				bias += fresnel * visibility;
+			}
+			outScale = scale / static_cast<float>(sampleCount);
+			outBias = bias / static_cast<float>(sampleCount);
+		}
+
+		bool Bake(const float* const faces, const uint32_t faceSize, const Settings& settings, BakedLighting& outLighting, BakeStats& outStats)
+		{
+			outLighting = {};
+			outStats = {};
+			if ((faces == nullptr) || (faceSize == 0) || (faceSize > EnvironmentCubemap::MaxFaceSize) || (settings.SpecularFaceSize == 0) ||
+				(settings.SpecularFaceSize > EnvironmentCubemap::MaxFaceSize) || (settings.SpecularMipCount == 0) || (settings.SpecularSampleCount == 0) ||
+				(settings.BrdfLutSize == 0) || (settings.BrdfLutSize > MaxBrdfLutSize) || (settings.BrdfLutSampleCount == 0))
+			{
+				return false;
+			}
+
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			std::vector<float> sourceMipStorage = {};
+			std::vector<CubeMip> sourceMips = {};
+			BuildSourceMips(faces, faceSize, sourceMipStorage, sourceMips);
+			outStats.SourceMipCount = static_cast<uint32_t>(sourceMips.size());
+			outStats.SourceMipMilliseconds = GetMillisecondsSince(start);
+
+			start = std::chrono::steady_clock::now();
+			ProjectIrradiance(sourceMips, outLighting.IrradianceSH);
+			outStats.IrradianceMilliseconds = GetMillisecondsSince(start);
+
+			start = std::chrono::steady_clock::now();
+			outLighting.SpecularFaceSize = settings.SpecularFaceSize;
+			outLighting.BakeSettings = settings;
+			outLighting.SpecularMipCount = std::min({ settings.SpecularMipCount, EnvironmentCubemap::GetMaxMipCount(settings.SpecularFaceSize), MaxSpecularMipCount });
+			outLighting.SpecularMips.resize(GetSpecularMipOffset(outLighting.SpecularFaceSize, outLighting.SpecularMipCount));
+			std::vector<SpecularSample> samples = {};
+			for (uint32_t mip = 0; mip < outLighting.SpecularMipCount; ++mip)
+			{
+				const uint32_t mipFaceSize = GetSpecularMipFaceSize(outLighting.SpecularFaceSize, mip);
+				BuildSpecularSamples(mip, outLighting.SpecularMipCount, settings.SpecularSampleCount, faceSize, mipFaceSize, samples);
+				PrefilterSpecularMip(sourceMips, samples, mipFaceSize, outLighting.SpecularMips.data() + GetSpecularMipOffset(outLighting.SpecularFaceSize, mip));
+			}
+			outStats.SpecularMilliseconds = GetMillisecondsSince(start);
+
+			start = std::chrono::steady_clock::now();
+			const uint32_t lutSize = settings.BrdfLutSize;
+			outLighting.BrdfLutSize = lutSize;
+			outLighting.BrdfLut.resize(static_cast<size_t>(lutSize) * lutSize * 2);
+			const size_t lutRowsPerJob = std::max<size_t>(SamplesPerJob / (static_cast<size_t>(lutSize) * settings.BrdfLutSampleCount), 1);
+			LeviathanCore::JobSystem::ParallelFor(lutSize, lutRowsPerJob, [&](const size_t firstRow, const size_t count, const size_t)
+				{
+					for (size_t row = firstRow; row < firstRow + count; ++row)
+					{
+						const float roughness = (static_cast<float>(row) + 0.5f) / static_cast<float>(lutSize);
+						for (uint32_t x = 0; x < lutSize; ++x)
+						{
+							const float nDotV = (static_cast<float>(x) + 0.5f) / static_cast<float>(lutSize);
+							float* const texel = outLighting.BrdfLut.data() + (((row * lutSize) + x) * 2);
+							IntegrateBrdf(nDotV, roughness, settings.BrdfLutSampleCount, texel[0], texel[1]);
+						}
+					}
+				});
+			outStats.BrdfLutMilliseconds = GetMillisecondsSince(start);
+			return true;
+		}
+
+		static bool IsValidSize(const uint32_t specularFaceSize, const uint32_t specularMipCount, const uint32_t brdfLutSize)
+		{
+			return (specularFaceSize != 0) && (specularFaceSize <= EnvironmentCubemap::MaxFaceSize) && (specularMipCount != 0) &&
+				(specularMipCount <= std::min(EnvironmentCubemap::GetMaxMipCount(specularFaceSize), MaxSpecularMipCount)) && (brdfLutSize != 0) &&
+				(brdfLutSize <= MaxBrdfLutSize);
+		}
+
+		bool Save(const std::string_view file, const BakedLighting& lighting)
+		{
+			if (!IsValidSize(lighting.SpecularFaceSize, lighting.SpecularMipCount, lighting.BrdfLutSize) ||
+				(lighting.SpecularMips.size() != GetSpecularMipOffset(lighting.SpecularFaceSize, lighting.SpecularMipCount)) ||
+				(lighting.BrdfLut.size() != static_cast<size_t>(lighting.BrdfLutSize) * lighting.BrdfLutSize * 2))
+			{
+				LEVIATHAN_LOG("Failed to save image based lighting %s. The baked data does not match its sizes.", file.data());
+				return false;
+			}
+
+			const EnvironmentCubemap::Header header = { .FaceSize = lighting.SpecularFaceSize, .MipCount = lighting.SpecularMipCount,
+				.FacePrecision = EnvironmentCubemap::Precision::Float32 };
+			std::vector<uint8_t> faceData(lighting.SpecularMips.size() * sizeof(float), 0);
+			memcpy(faceData.data(), lighting.SpecularMips.data(), faceData.size());
+
+			FileHeader fileHeader = {};
+			fileHeader.Tag = FileTag;
+			fileHeader.BrdfLutSize = lighting.BrdfLutSize;
+			fileHeader.SpecularFaceSize = lighting.BakeSettings.SpecularFaceSize;
+			fileHeader.SpecularMipCount = lighting.BakeSettings.SpecularMipCount;
+			fileHeader.SpecularSampleCount = lighting.BakeSettings.SpecularSampleCount;
+			fileHeader.BrdfLutSampleCount = lighting.BakeSettings.BrdfLutSampleCount;
+
+			const size_t shBytes = lighting.IrradianceSH.size() * sizeof(float);
+			const size_t lutBytes = lighting.BrdfLut.size() * sizeof(float);
+			std::vector<uint8_t> extraData(sizeof(FileHeader) + shBytes + lutBytes, 0);
+			uint8_t* target = extraData.data();
+			memcpy(target, &fileHeader, sizeof(FileHeader));
+			target += sizeof(FileHeader);
+			memcpy(target, lighting.IrradianceSH.data(), shBytes);
+			target += shBytes;
+			memcpy(target, lighting.BrdfLut.data(), lutBytes);
+			return EnvironmentCubemap::Save(file, header, faceData, extraData);
+		}
+
+		bool Load(const std::string_view file, BakedLighting& outLighting)
+		{
+			outLighting = {};
+			EnvironmentCubemap::Header header = {};
+			std::vector<uint8_t> faceData = {};
+			std::vector<uint8_t> extraData = {};
+			if (!EnvironmentCubemap::Load(file, header, faceData, extraData))
+			{
+				return false;
+			}
+
+			FileHeader fileHeader = {};
+			const size_t shBytes = outLighting.IrradianceSH.size() * sizeof(float);
+			const bool tagged = LeviathanCore::Serialize::ReadFileHeader(extraData, FileTag, fileHeader);
+			const size_t lutFloats = static_cast<size_t>(fileHeader.BrdfLutSize) * fileHeader.BrdfLutSize * 2;
+			if (!tagged || (header.FacePrecision != EnvironmentCubemap::Precision::Float32) || !IsValidSize(header.FaceSize, header.MipCount, fileHeader.BrdfLutSize) ||
+				(extraData.size() != sizeof(FileHeader) + shBytes + (lutFloats * sizeof(float))))
+			{
+				LEVIATHAN_LOG("Failed to load image based lighting %s. The file is from another version or corrupt.", file.data());
+				return false;
+			}
+
+			outLighting.BakeSettings = { .SpecularFaceSize = fileHeader.SpecularFaceSize, .SpecularMipCount = fileHeader.SpecularMipCount,
+				.SpecularSampleCount = fileHeader.SpecularSampleCount, .BrdfLutSize = fileHeader.BrdfLutSize, .BrdfLutSampleCount = fileHeader.BrdfLutSampleCount };
+			outLighting.SpecularFaceSize = header.FaceSize;
+			outLighting.SpecularMipCount = header.MipCount;
+			outLighting.SpecularMips.resize(faceData.size() / sizeof(float));
+			memcpy(outLighting.SpecularMips.data(), faceData.data(), faceData.size());
+
+			const uint8_t* source = extraData.data() + sizeof(FileHeader);
+			memcpy(outLighting.IrradianceSH.data(), source, shBytes);
+			source += shBytes;
+			outLighting.BrdfLutSize = fileHeader.BrdfLutSize;
+			outLighting.BrdfLut.resize(lutFloats);
+			memcpy(outLighting.BrdfLut.data(), source, lutFloats * sizeof(float));
+			return true;
+		}
+	}
+}
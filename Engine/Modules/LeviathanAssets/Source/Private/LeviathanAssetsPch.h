@@ -2,6 +2,14 @@
 
 // Standard library.
 #include <string>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <bit>
+#include <cstdint>
+#include <chrono>
 
 // Assimp.
 #include "Assimp/Importer.hpp"
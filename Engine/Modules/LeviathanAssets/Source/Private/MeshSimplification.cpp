@@ -0,0 +1,931 @@
+#include "MeshSimplification.h"
+#include "AssetTypes.h"
+#include "LeviathanAssert.h"
+#include "Logging.h"
+
+namespace LeviathanAssets
+{
+	namespace MeshSimplification
+	{
+		// Normal, texture coordinate and tangent components.
+		static constexpr size_t AttributeCount = 8;
+		static constexpr uint32_t InvalidVertex = std::numeric_limits<uint32_t>::max();
+		// Weights of the planes through border and seam edges perpendicular to their triangle relative to the triangle planes. Border edges are held
+		// firmly while seam edges are also held in place by the attribute error.
+		static constexpr float BorderEdgeWeight = 10.0f;
+		static constexpr float SeamEdgeWeight = 1.0f;
+		// Collapses share vertices so most of the cheapest collapses of a pass are locked by an earlier collapse. A pass accepts collapses up to this
+		// factor times the error of the collapse that would meet the pass's goal if every collapse succeeded.
+		static constexpr float PassErrorFactor = 1.5f;
+		// Collapses are ordered by the 8 exponent bits and the 3 highest mantissa bits of their error.
+		static constexpr uint32_t SortBucketBits = 11;
+		static constexpr size_t SortBucketCount = size_t(1) << SortBucketBits;
+
+		using Point = std::array<float, 3>;
+		using Attributes = std::array<float, AttributeCount>;
+
+		static inline Point Subtract(const Point& a, const Point& b) { return { a[0] - b[0], a[1] - b[1], a[2] - b[2] }; }
+		static inline float Dot(const Point& a, const Point& b) { return (a[0] * b[0]) + (a[1] * b[1]) + (a[2] * b[2]); }
+		static inline Point Cross(const Point& a, const Point& b)
+		{
+			return { (a[1] * b[2]) - (a[2] * b[1]), (a[2] * b[0]) - (a[0] * b[2]), (a[0] * b[1]) - (a[1] * b[0]) };
+		}
+
+		enum class VertexKind : uint8_t
+		{
+			// Every edge has an opposite edge.
+			Manifold,
+			// On a single open border.
+			Border,
+			// Split into two vertices along a single attribute seam.
+			Seam,
+			// Any other topology. Never moves.
+			Locked
+		};
+		static constexpr size_t VertexKindCount = 4;
+
+		// Whether a vertex of the row's kind may collapse into a vertex of the column's kind. Border and seam vertices only collapse along their border or
+		// seam, which is checked separately.
+		static constexpr std::array<std::array<bool, VertexKindCount>, VertexKindCount> CanCollapse = { {
+			{ true, true, true, true },
+			{ false, true, false, true },
+			{ false, false, true, true },
+			{ false, false, false, false } } };
+
+		// Whether the edge between vertices of the row's and the column's kind is expected to appear in both directions.
+		static constexpr std::array<std::array<bool, VertexKindCount>, VertexKindCount> HasOpposite = { {
+			{ true, true, true, true },
+			{ true, false, true, false },
+			{ true, true, true, true },
+			{ true, false, true, false } } };
+
+		// Area weighted sum of squared distances to planes: x^T A x + 2 b.x + c.
+		struct PositionQuadric
+		{
+			std::array<float, 6> A = {};
+			Point B = {};
+			float C = 0.0f;
+			float Weight = 0.0f;
+
+			void AddPlane(const Point& normal, const float distance, const float weight)
+			{
+				A[0] += weight * normal[0] * normal[0];
+				A[1] += weight * normal[1] * normal[1];
+				A[2] += weight * normal[2] * normal[2];
+				A[3] += weight * normal[0] * normal[1];
+				A[4] += weight * normal[0] * normal[2];
+				A[5] += weight * normal[1] * normal[2];
+				for (size_t axis = 0; axis < 3; ++axis)
+				{
+					B[axis] += weight * distance * normal[axis];
+				}
+				C += weight * distance * distance;
+				Weight += weight;
+			}
+
+			void Add(const PositionQuadric& other)
+			{
+				for (size_t i = 0; i < 6; ++i)
+				{
+					A[i] += other.A[i];
+				}
+				for (size_t axis = 0; axis < 3; ++axis)
+				{
+					B[axis] += other.B[axis];
+				}
+				C += other.C;
+				Weight += other.Weight;
+			}
+
+			float Evaluate(const Point& p) const
+			{
+				const float ax = (A[0] * p[0]) + (A[3] * p[1]) + (A[4] * p[2]);
+				const float ay = (A[3] * p[0]) + (A[1] * p[1]) + (A[5] * p[2]);
+				const float az = (A[4] * p[0]) + (A[5] * p[1]) + (A[2] * p[2]);
+				return (p[0] * ax) + (p[1] * ay) + (p[2] * az) + (2.0f * Dot(B, p)) + C;
+			}
+		};
+
+		// Area weighted sum of squared deviations of the attributes from their linear interpolation across triangles, where every attribute component j
+		// of a triangle is G_j.x + D_j at position x on the triangle's plane. For a point with position p and attributes s the sum expands to
+		// p^T A p + 2 b.p - 2 sum(s_j * G_j.p) - 2 sum(s_j * E_j) + c + area * sum(s_j^2) with G_j and E_j holding the weighted gradients and offsets.
+		struct AttributeQuadric
+		{
+			std::array<float, 6> A = {};
+			Point B = {};
+			std::array<Point, AttributeCount> G = {};
+			Attributes E = {};
+			float C = 0.0f;
+			float Area = 0.0f;
+
+			void Add(const AttributeQuadric& other)
+			{
+				for (size_t i = 0; i < 6; ++i)
+				{
+					A[i] += other.A[i];
+				}
+				for (size_t axis = 0; axis < 3; ++axis)
+				{
+					B[axis] += other.B[axis];
+				}
+				for (size_t j = 0; j < AttributeCount; ++j)
+				{
+					for (size_t axis = 0; axis < 3; ++axis)
+					{
+						G[j][axis] += other.G[j][axis];
+					}
+					E[j] += other.E[j];
+				}
+				C += other.C;
+				Area += other.Area;
+			}
+
+			float Evaluate(const Point& p, const Attributes& s) const
+			{
+				const float ax = (A[0] * p[0]) + (A[3] * p[1]) + (A[4] * p[2]);
+				const float ay = (A[3] * p[0]) + (A[1] * p[1]) + (A[5] * p[2]);
+				const float az = (A[4] * p[0]) + (A[5] * p[1]) + (A[2] * p[2]);
+				float result = (p[0] * ax) + (p[1] * ay) + (p[2] * az) + (2.0f * Dot(B, p)) + C;
+				for (size_t j = 0; j < AttributeCount; ++j)
+				{
+					result += (s[j] * Area * s[j]) - (2.0f * s[j] * (Dot(G[j], p) + E[j]));
+				}
+				return result;
+			}
+		};
+
+		// Edges leaving every vertex as the next and previous vertex of each triangle using the vertex, in compressed rows.
+		struct EdgeAdjacency
+		{
+			struct Edge
+			{
+				uint32_t Next = 0;
+				uint32_t Previous = 0;
+			};
+
+			std::vector<uint32_t> Offsets = {};
+			std::vector<Edge> Edges = {};
+		};
+
+		struct Collapse
+		{
+			// Vertex removed and the vertex it is merged into.
+			uint32_t From = 0;
+			uint32_t To = 0;
+			float Error = 0.0f;
+			bool Bidirectional = false;
+		};
+
+		struct Simplifier
+		{
+			size_t VertexCount = 0;
+			// Positions translated and scaled to fit the unit cube and attributes multiplied by their weight.
+			std::vector<Point> Positions = {};
+			std::vector<Attributes> VertexAttributes = {};
+			float Extent = 1.0f;
+
+			// First vertex with the same position as every vertex and the next vertex in the ring of vertices with the same position.
+			std::vector<uint32_t> Remap = {};
+			std::vector<uint32_t> Wedge = {};
+			std::vector<VertexKind> Kinds = {};
+			// Target of the single open edge leaving and source of the single open edge entering every border or seam vertex.
+			std::vector<uint32_t> OpenNext = {};
+			std::vector<uint32_t> OpenPrevious = {};
+
+			// Position quadrics are shared by the vertices of a position and indexed by Remap. Attribute quadrics are per vertex.
+			std::vector<PositionQuadric> PositionQuadrics = {};
+			std::vector<AttributeQuadric> AttributeQuadrics = {};
+
+			std::vector<uint32_t> Indices = {};
+			// Largest error of a performed collapse relative to the unit cube.
+			float Error = 0.0f;
+
+			EdgeAdjacency Adjacency = {};
+			std::vector<Collapse> Collapses = {};
+			std::vector<uint32_t> CollapseOrder = {};
+			std::vector<uint32_t> CollapseRemap = {};
+			std::vector<uint8_t> CollapseLocked = {};
+		};
+
+		// remap may be null to build the adjacency of the vertices instead of their positions.
+		static void BuildEdgeAdjacency(EdgeAdjacency& adjacency, const std::vector<uint32_t>& indices, const size_t vertexCount, const uint32_t* const remap)
+		{
+			const auto vertex = [&indices, remap](const size_t i) { return (remap != nullptr) ? remap[indices[i]] : indices[i]; };
+
+			adjacency.Offsets.assign(vertexCount + 1, 0);
+			for (size_t i = 0; i < indices.size(); ++i)
+			{
+				++adjacency.Offsets[vertex(i) + 1];
+			}
+			for (size_t i = 0; i < vertexCount; ++i)
+			{
+				adjacency.Offsets[i + 1] += adjacency.Offsets[i];
+			}
+
+			adjacency.Edges.resize(indices.size());
+			std::vector<uint32_t> cursors(adjacency.Offsets.begin(), adjacency.Offsets.end() - 1);
+			for (size_t i = 0; i < indices.size(); i += 3)
+			{
+				const std::array<uint32_t, 3> triangle = { vertex(i), vertex(i + 1), vertex(i + 2) };
+				for (size_t corner = 0; corner < 3; ++corner)
+				{
+					adjacency.Edges[cursors[triangle[corner]]++] = EdgeAdjacency::Edge{ triangle[(corner + 1) % 3], triangle[(corner + 2) % 3] };
+				}
+			}
+		}
+
+		static bool HasEdge(const EdgeAdjacency& adjacency, const uint32_t from, const uint32_t to)
+		{
+			for (uint32_t i = adjacency.Offsets[from]; i < adjacency.Offsets[from + 1]; ++i)
+			{
+				if (adjacency.Edges[i].Next == to)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// Links vertices with bitwise identical positions.
+		static void BuildPositionRemap(Simplifier& simplifier, const std::vector<LeviathanCore::MathTypes::Vector3>& positions)
+		{
+			const auto key = [&positions](const uint32_t vertex)
+				{
+					const LeviathanCore::MathTypes::Vector3& position = positions[vertex];
+					return std::array<uint32_t, 4>{ std::bit_cast<uint32_t>(position.X()), std::bit_cast<uint32_t>(position.Y()),
+						std::bit_cast<uint32_t>(position.Z()), vertex };
+				};
+
+			std::vector<uint32_t> order(simplifier.VertexCount);
+			std::iota(order.begin(), order.end(), 0);
+			std::sort(order.begin(), order.end(), [&key](const uint32_t a, const uint32_t b) { return key(a) < key(b); });
+
+			simplifier.Remap.resize(simplifier.VertexCount);
+			simplifier.Wedge.resize(simplifier.VertexCount);
+			for (size_t first = 0; first < order.size();)
+			{
+				const std::array<uint32_t, 4> firstKey = key(order[first]);
+				size_t last = first + 1;
+				while ((last < order.size()) && (std::equal(firstKey.begin(), firstKey.begin() + 3, key(order[last]).begin())))
+				{
+					++last;
+				}
+
+				// Ties are ordered by vertex so the first vertex of the group is the smallest.
+				for (size_t i = first; i < last; ++i)
+				{
+					simplifier.Remap[order[i]] = order[first];
+					simplifier.Wedge[order[i]] = order[(i + 1 < last) ? i + 1 : first];
+				}
+				first = last;
+			}
+		}
+
+		static void ClassifyVertices(Simplifier& simplifier, const bool lockBorders)
+		{
+			BuildEdgeAdjacency(simplifier.Adjacency, simplifier.Indices, simplifier.VertexCount, nullptr);
+
+			// Open edges are edges without an opposite edge between the same two vertices. Vertices with more than one open edge in a direction
+			// reference themselves. Edges along a seam are open as their opposite edge uses the other vertices of the seam's positions.
+			simplifier.OpenNext.assign(simplifier.VertexCount, InvalidVertex);
+			simplifier.OpenPrevious.assign(simplifier.VertexCount, InvalidVertex);
+			for (uint32_t vertex = 0; vertex < simplifier.VertexCount; ++vertex)
+			{
+				for (uint32_t i = simplifier.Adjacency.Offsets[vertex]; i < simplifier.Adjacency.Offsets[vertex + 1]; ++i)
+				{
+					const uint32_t target = simplifier.Adjacency.Edges[i].Next;
+					if (!HasEdge(simplifier.Adjacency, target, vertex))
+					{
+						simplifier.OpenNext[vertex] = (simplifier.OpenNext[vertex] == InvalidVertex) ? target : vertex;
+						simplifier.OpenPrevious[target] = (simplifier.OpenPrevious[target] == InvalidVertex) ? vertex : target;
+					}
+				}
+			}
+
+			const auto isSingleOpenEdge = [](const uint32_t open, const uint32_t vertex) { return (open != InvalidVertex) && (open != vertex); };
+
+			simplifier.Kinds.resize(simplifier.VertexCount);
+			for (uint32_t vertex = 0; vertex < simplifier.VertexCount; ++vertex)
+			{
+				if (simplifier.Remap[vertex] != vertex)
+				{
+					// The first vertex of the position is classified first.
+					simplifier.Kinds[vertex] = simplifier.Kinds[simplifier.Remap[vertex]];
+					continue;
+				}
+
+				const uint32_t other = simplifier.Wedge[vertex];
+				VertexKind kind = VertexKind::Locked;
+				if (other == vertex)
+				{
+					const uint32_t next = simplifier.OpenNext[vertex];
+					const uint32_t previous = simplifier.OpenPrevious[vertex];
+					if ((next == InvalidVertex) && (previous == InvalidVertex))
+					{
+						kind = VertexKind::Manifold;
+					}
+					else if (isSingleOpenEdge(next, vertex) && isSingleOpenEdge(previous, vertex))
+					{
+						kind = lockBorders ? VertexKind::Locked : VertexKind::Border;
+					}
+				}
+				else if (simplifier.Wedge[other] == vertex)
+				{
+					// A seam has one open edge in each direction on both sides and the edges of the two sides connect the same positions.
+					const uint32_t next = simplifier.OpenNext[vertex];
+					const uint32_t previous = simplifier.OpenPrevious[vertex];
+					const uint32_t otherNext = simplifier.OpenNext[other];
+					const uint32_t otherPrevious = simplifier.OpenPrevious[other];
+					if (isSingleOpenEdge(next, vertex) && isSingleOpenEdge(previous, vertex) && isSingleOpenEdge(otherNext, other) &&
+						isSingleOpenEdge(otherPrevious, other) && (simplifier.Remap[next] == simplifier.Remap[otherPrevious]) &&
+						(simplifier.Remap[previous] == simplifier.Remap[otherNext]))
+					{
+						kind = VertexKind::Seam;
+					}
+				}
+				simplifier.Kinds[vertex] = kind;
+			}
+		}
+
+		static void FillQuadrics(Simplifier& simplifier)
+		{
+			simplifier.PositionQuadrics.assign(simplifier.VertexCount, PositionQuadric{});
+			simplifier.AttributeQuadrics.assign(simplifier.VertexCount, AttributeQuadric{});
+
+			for (size_t i = 0; i < simplifier.Indices.size(); i += 3)
+			{
+				const std::array<uint32_t, 3> triangle = { simplifier.Indices[i], simplifier.Indices[i + 1], simplifier.Indices[i + 2] };
+				const Point& p0 = simplifier.Positions[triangle[0]];
+				const Point edge1 = Subtract(simplifier.Positions[triangle[1]], p0);
+				const Point edge2 = Subtract(simplifier.Positions[triangle[2]], p0);
+				Point normal = Cross(edge1, edge2);
+				const float area = std::sqrt(Dot(normal, normal));
+				if (area == 0.0f)
+				{
+					continue;
+				}
+				for (size_t axis = 0; axis < 3; ++axis)
+				{
+					normal[axis] /= area;
+				}
+
+				PositionQuadric plane = {};
+				plane.AddPlane(normal, -Dot(normal, p0), area);
+
+				// Gradient of every attribute component in the triangle's plane from the barycentric solution of the edge differences.
+				const float e11 = Dot(edge1, edge1);
+				const float e12 = Dot(edge1, edge2);
+				const float e22 = Dot(edge2, edge2);
+				const float determinant = (e11 * e22) - (e12 * e12);
+				AttributeQuadric attributes = {};
+				if (determinant > 0.0f)
+				{
+					const Attributes& s0 = simplifier.VertexAttributes[triangle[0]];
+					const Attributes& s1 = simplifier.VertexAttributes[triangle[1]];
+					const Attributes& s2 = simplifier.VertexAttributes[triangle[2]];
+					for (size_t j = 0; j < AttributeCount; ++j)
+					{
+						const float delta1 = s1[j] - s0[j];
+						const float delta2 = s2[j] - s0[j];
+						const float u = ((e22 * delta1) - (e12 * delta2)) / determinant;
+						const float v = ((e11 * delta2) - (e12 * delta1)) / determinant;
+						const Point gradient = { (u * edge1[0]) + (v * edge2[0]), (u * edge1[1]) + (v * edge2[1]), (u * edge1[2]) + (v * edge2[2]) };
+						const float offset = s0[j] - Dot(gradient, p0);
+
+						attributes.A[0] += area * gradient[0] * gradient[0];
+						attributes.A[1] += area * gradient[1] * gradient[1];
+						attributes.A[2] += area * gradient[2] * gradient[2];
+						attributes.A[3] += area * gradient[0] * gradient[1];
+						attributes.A[4] += area * gradient[0] * gradient[2];
+						attributes.A[5] += area * gradient[1] * gradient[2];
+						for (size_t axis = 0; axis < 3; ++axis)
+						{
+							attributes.B[axis] += area * offset * gradient[axis];
+							attributes.G[j][axis] = area * gradient[axis];
+						}
+						attributes.E[j] = area * offset;
+						attributes.C += area * offset * offset;
+					}
+					attributes.Area = area;
+				}
+
+				for (const uint32_t vertex : triangle)
+				{
+					simplifier.PositionQuadrics[simplifier.Remap[vertex]].Add(plane);
+					simplifier.AttributeQuadrics[vertex].Add(attributes);
+				}
+			}
+
+			// Planes through border and seam edges perpendicular to their triangle keep the edges from moving inwards.
+			for (size_t i = 0; i < simplifier.Indices.size(); i += 3)
+			{
+				for (size_t corner = 0; corner < 3; ++corner)
+				{
+					const uint32_t v0 = simplifier.Indices[i + corner];
+					const uint32_t v1 = simplifier.Indices[i + ((corner + 1) % 3)];
+					const uint32_t v2 = simplifier.Indices[i + ((corner + 2) % 3)];
+					const VertexKind k0 = simplifier.Kinds[v0];
+					const VertexKind k1 = simplifier.Kinds[v1];
+					const bool open0 = (k0 == VertexKind::Border) || (k0 == VertexKind::Seam);
+					const bool open1 = (k1 == VertexKind::Border) || (k1 == VertexKind::Seam);
+
+					// Edges between a border or seam vertex and a locked vertex are included so that the corners of borders are held too.
+					if ((!open0 && !open1) || (open0 && (simplifier.OpenNext[v0] != v1)) || (open1 && (simplifier.OpenPrevious[v1] != v0)))
+					{
+						continue;
+					}
+					// Seam edges appear on both sides of the seam.
+					if (HasOpposite[static_cast<size_t>(k0)][static_cast<size_t>(k1)] && (simplifier.Remap[v1] > simplifier.Remap[v0]))
+					{
+						continue;
+					}
+
+					const Point& p0 = simplifier.Positions[v0];
+					Point edge = Subtract(simplifier.Positions[v1], p0);
+					const float length = std::sqrt(Dot(edge, edge));
+					if (length == 0.0f)
+					{
+						continue;
+					}
+					for (size_t axis = 0; axis < 3; ++axis)
+					{
+						edge[axis] /= length;
+					}
+
+					// Normal of the plane from the edge towards the opposite vertex, perpendicular to the edge.
+					const Point toOpposite = Subtract(simplifier.Positions[v2], p0);
+					const float along = Dot(toOpposite, edge);
+					Point normal = { toOpposite[0] - (edge[0] * along), toOpposite[1] - (edge[1] * along), toOpposite[2] - (edge[2] * along) };
+					const float normalLength = std::sqrt(Dot(normal, normal));
+					if (normalLength == 0.0f)
+					{
+						continue;
+					}
+					for (size_t axis = 0; axis < 3; ++axis)
+					{
+						normal[axis] /= normalLength;
+					}
+
+					// Weighted by the squared edge length to match the area weight of triangle planes.
+					const float weight = ((k0 == VertexKind::Border) || (k1 == VertexKind::Border)) ? BorderEdgeWeight : SeamEdgeWeight;
+					PositionQuadric plane = {};
+					plane.AddPlane(normal, -Dot(normal, p0), length * length * weight);
+					simplifier.PositionQuadrics[simplifier.Remap[v0]].Add(plane);
+					simplifier.PositionQuadrics[simplifier.Remap[v1]].Add(plane);
+				}
+			}
+		}
+
+		static bool InitializeSimplifier(Simplifier& simplifier, const AssetTypes::Mesh& mesh, const Settings& settings)
+		{
+			if ((mesh.Indices.size() < 3) || ((mesh.Indices.size() % 3) != 0))
+			{
+				LEVIATHAN_LOG("Failed to simplify mesh. Index count %zu is not a non zero multiple of 3.", mesh.Indices.size());
+				return false;
+			}
+			for (const uint32_t index : mesh.Indices)
+			{
+				if (index >= mesh.Positions.size())
+				{
+					LEVIATHAN_LOG("Failed to simplify mesh. Index %u is out of range.", index);
+					return false;
+				}
+			}
+
+			simplifier.VertexCount = mesh.Positions.size();
+
+			// Work in the unit cube so that errors and attribute weights do not depend on the mesh's size.
+			const LeviathanCore::BoundingVolumes::AABB bounds = LeviathanCore::BoundingVolumes::AABB::FromPoints(mesh.Positions.data(), mesh.Positions.size());
+			simplifier.Extent = std::max({ bounds.Max.X() - bounds.Min.X(), bounds.Max.Y() - bounds.Min.Y(), bounds.Max.Z() - bounds.Min.Z() });
+			if (simplifier.Extent <= 0.0f)
+			{
+				simplifier.Extent = 1.0f;
+			}
+			const float scale = 1.0f / simplifier.Extent;
+			simplifier.Positions.resize(simplifier.VertexCount);
+			for (size_t i = 0; i < simplifier.VertexCount; ++i)
+			{
+				const LeviathanCore::MathTypes::Vector3& position = mesh.Positions[i];
+				simplifier.Positions[i] = { (position.X() - bounds.Min.X()) * scale, (position.Y() - bounds.Min.Y()) * scale, (position.Z() - bounds.Min.Z()) * scale };
+			}
+
+			const bool hasNormals = (mesh.Normals.size() == simplifier.VertexCount);
+			const bool hasTextureCoordinates = (mesh.TextureCoordinates.size() == simplifier.VertexCount);
+			const bool hasTangents = (mesh.Tangents.size() == simplifier.VertexCount);
+			simplifier.VertexAttributes.assign(simplifier.VertexCount, Attributes{});
+			for (size_t i = 0; i < simplifier.VertexCount; ++i)
+			{
+				Attributes& attributes = simplifier.VertexAttributes[i];
+				if (hasNormals)
+				{
+					attributes[0] = mesh.Normals[i].X() * settings.NormalWeight;
+					attributes[1] = mesh.Normals[i].Y() * settings.NormalWeight;
+					attributes[2] = mesh.Normals[i].Z() * settings.NormalWeight;
+				}
+				if (hasTextureCoordinates)
+				{
+					attributes[3] = mesh.TextureCoordinates[i].X() * settings.TextureCoordinateWeight;
+					attributes[4] = mesh.TextureCoordinates[i].Y() * settings.TextureCoordinateWeight;
+				}
+				if (hasTangents)
+				{
+					attributes[5] = mesh.Tangents[i].X() * settings.TangentWeight;
+					attributes[6] = mesh.Tangents[i].Y() * settings.TangentWeight;
+					attributes[7] = mesh.Tangents[i].Z() * settings.TangentWeight;
+				}
+			}
+
+			// Triangles referencing a vertex twice cover nothing and are dropped.
+			simplifier.Indices.clear();
+			simplifier.Indices.reserve(mesh.Indices.size());
+			for (size_t i = 0; i < mesh.Indices.size(); i += 3)
+			{
+				const uint32_t v0 = mesh.Indices[i];
+				const uint32_t v1 = mesh.Indices[i + 1];
+				const uint32_t v2 = mesh.Indices[i + 2];
+				if ((v0 != v1) && (v0 != v2) && (v1 != v2))
+				{
+					simplifier.Indices.insert(simplifier.Indices.end(), { v0, v1, v2 });
+				}
+			}
+			simplifier.Error = 0.0f;
+
+			BuildPositionRemap(simplifier, mesh.Positions);
+			ClassifyVertices(simplifier, settings.LockBorders);
+			FillQuadrics(simplifier);
+			return true;
+		}
+
+		// Vertex on the other side of the seam that the other side of seam vertex from collapses into when from collapses into to.
+		static uint32_t GetSeamTarget(const Simplifier& simplifier, const uint32_t from, const uint32_t to)
+		{
+			const uint32_t otherFrom = simplifier.Wedge[from];
+			return (simplifier.OpenNext[from] == to) ? simplifier.OpenPrevious[otherFrom] : simplifier.OpenNext[otherFrom];
+		}
+
+		static float CalculateCollapseError(const Simplifier& simplifier, const uint32_t from, const uint32_t to)
+		{
+			const PositionQuadric& positionQuadric = simplifier.PositionQuadrics[simplifier.Remap[from]];
+			const Point& position = simplifier.Positions[to];
+			float error = positionQuadric.Evaluate(position) + simplifier.AttributeQuadrics[from].Evaluate(position, simplifier.VertexAttributes[to]);
+			if (simplifier.Kinds[from] == VertexKind::Seam)
+			{
+				const uint32_t otherFrom = simplifier.Wedge[from];
+				const uint32_t otherTo = GetSeamTarget(simplifier, from, to);
+				error += simplifier.AttributeQuadrics[otherFrom].Evaluate(position, simplifier.VertexAttributes[otherTo]);
+			}
+
+			// Mean over the area merged into the vertex.
+			return (positionQuadric.Weight > 0.0f) ? (std::fabs(error) / positionQuadric.Weight) : 0.0f;
+		}
+
+		static void PickCollapses(Simplifier& simplifier)
+		{
+			simplifier.Collapses.clear();
+			for (size_t i = 0; i < simplifier.Indices.size(); i += 3)
+			{
+				for (size_t corner = 0; corner < 3; ++corner)
+				{
+					const uint32_t v0 = simplifier.Indices[i + corner];
+					const uint32_t v1 = simplifier.Indices[i + ((corner + 1) % 3)];
+					const size_t k0 = static_cast<size_t>(simplifier.Kinds[v0]);
+					const size_t k1 = static_cast<size_t>(simplifier.Kinds[v1]);
+					if (!CanCollapse[k0][k1] && !CanCollapse[k1][k0])
+					{
+						continue;
+					}
+					// Edges appearing in both directions are picked once.
+					if (HasOpposite[k0][k1] && (simplifier.Remap[v1] > simplifier.Remap[v0]))
+					{
+						continue;
+					}
+					// Border and seam vertices only collapse along their border or seam, e.g. not across a narrow strip or into a corner of another
+					// border.
+					const bool open0 = (simplifier.Kinds[v0] == VertexKind::Border) || (simplifier.Kinds[v0] == VertexKind::Seam);
+					const bool open1 = (simplifier.Kinds[v1] == VertexKind::Border) || (simplifier.Kinds[v1] == VertexKind::Seam);
+					if ((open0 && (simplifier.Kinds[v1] != VertexKind::Manifold) && (simplifier.OpenNext[v0] != v1)) ||
+						(open1 && (simplifier.Kinds[v0] != VertexKind::Manifold) && (simplifier.OpenPrevious[v1] != v0)))
+					{
+						continue;
+					}
+
+					if (CanCollapse[k0][k1] && CanCollapse[k1][k0])
+					{
+						simplifier.Collapses.push_back(Collapse{ v0, v1, 0.0f, true });
+					}
+					else
+					{
+						const bool forward = CanCollapse[k0][k1];
+						simplifier.Collapses.push_back(Collapse{ forward ? v0 : v1, forward ? v1 : v0, 0.0f, false });
+					}
+				}
+			}
+		}
+
+		// Errors are not negative so the bits below the sign bit order them.
+		static inline uint32_t GetSortBucket(const float error)
+		{
+			return (std::bit_cast<uint32_t>(error) << 1) >> (32 - SortBucketBits);
+		}
+
+		static void RankCollapses(Simplifier& simplifier)
+		{
+			for (Collapse& collapse : simplifier.Collapses)
+			{
+				collapse.Error = CalculateCollapseError(simplifier, collapse.From, collapse.To);
+				if (collapse.Bidirectional)
+				{
+					const float reverseError = CalculateCollapseError(simplifier, collapse.To, collapse.From);
+					if (reverseError < collapse.Error)
+					{
+						std::swap(collapse.From, collapse.To);
+						collapse.Error = reverseError;
+					}
+				}
+			}
+
+			// Counting sort by the exponent and the highest mantissa bits of the error. Collapses within an eighth of an octave of each other stay in
+			// pick order, which is close enough for greedy collapsing and much cheaper than a comparison sort.
+			std::array<uint32_t, SortBucketCount> bucketOffsets = {};
+			for (const Collapse& collapse : simplifier.Collapses)
+			{
+				++bucketOffsets[GetSortBucket(collapse.Error)];
+			}
+			uint32_t offset = 0;
+			for (uint32_t& bucketOffset : bucketOffsets)
+			{
+				const uint32_t count = bucketOffset;
+				bucketOffset = offset;
+				offset += count;
+			}
+			simplifier.CollapseOrder.resize(simplifier.Collapses.size());
+			for (size_t i = 0; i < simplifier.Collapses.size(); ++i)
+			{
+				simplifier.CollapseOrder[bucketOffsets[GetSortBucket(simplifier.Collapses[i].Error)]++] = static_cast<uint32_t>(i);
+			}
+		}
+
+		// Returns whether moving position from to position to flips a triangle around from that is not removed by the collapse.
+		static bool HasTriangleFlips(const Simplifier& simplifier, const uint32_t from, const uint32_t to)
+		{
+			const Point& p0 = simplifier.Positions[from];
+			const Point& p1 = simplifier.Positions[to];
+			for (uint32_t i = simplifier.Adjacency.Offsets[from]; i < simplifier.Adjacency.Offsets[from + 1]; ++i)
+			{
+				const uint32_t a = simplifier.Remap[simplifier.CollapseRemap[simplifier.Adjacency.Edges[i].Next]];
+				const uint32_t b = simplifier.Remap[simplifier.CollapseRemap[simplifier.Adjacency.Edges[i].Previous]];
+				if ((a == to) || (b == to) || (a == b))
+				{
+					continue;
+				}
+
+				const Point& pa = simplifier.Positions[a];
+				const Point edge = Subtract(simplifier.Positions[b], pa);
+				const Point before = Cross(edge, Subtract(p0, pa));
+				const Point after = Cross(edge, Subtract(p1, pa));
+				if (Dot(before, after) <= 0.0f)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		static size_t PerformCollapses(Simplifier& simplifier, const size_t triangleGoal, const float maxError)
+		{
+			std::iota(simplifier.CollapseRemap.begin(), simplifier.CollapseRemap.end(), 0);
+			std::fill(simplifier.CollapseLocked.begin(), simplifier.CollapseLocked.end(), static_cast<uint8_t>(0));
+
+			// Most collapses remove two triangles.
+			size_t edgeGoal = triangleGoal / 2;
+			size_t triangleCollapses = 0;
+			size_t edgeCollapses = 0;
+			for (const uint32_t index : simplifier.CollapseOrder)
+			{
+				const Collapse& collapse = simplifier.Collapses[index];
+				if ((collapse.Error > maxError) || (triangleCollapses >= triangleGoal))
+				{
+					break;
+				}
+
+				// Collapses rank by errors from the start of the pass. Later collapses are left to the next pass once a pass has made progress.
+				const float errorGoal = (edgeGoal < simplifier.Collapses.size()) ?
+					PassErrorFactor * simplifier.Collapses[simplifier.CollapseOrder[edgeGoal]].Error : std::numeric_limits<float>::max();
+				if ((collapse.Error > errorGoal) && (triangleCollapses > triangleGoal / 6))
+				{
+					break;
+				}
+
+				// Vertices move at most once per pass and nothing moves onto a moved vertex so that the ranked errors stay valid.
+				const uint32_t from = collapse.From;
+				const uint32_t to = collapse.To;
+				const uint32_t fromPosition = simplifier.Remap[from];
+				const uint32_t toPosition = simplifier.Remap[to];
+				if ((simplifier.CollapseLocked[fromPosition] != 0) || (simplifier.CollapseLocked[toPosition] != 0))
+				{
+					continue;
+				}
+				if (HasTriangleFlips(simplifier, fromPosition, toPosition))
+				{
+					// Rejected collapses do not count towards the pass's error goal.
+					++edgeGoal;
+					continue;
+				}
+
+				simplifier.PositionQuadrics[toPosition].Add(simplifier.PositionQuadrics[fromPosition]);
+				simplifier.AttributeQuadrics[to].Add(simplifier.AttributeQuadrics[from]);
+				simplifier.CollapseRemap[from] = to;
+				if (simplifier.Kinds[from] == VertexKind::Seam)
+				{
+					const uint32_t otherFrom = simplifier.Wedge[from];
+					const uint32_t otherTo = GetSeamTarget(simplifier, from, to);
+					LEVIATHAN_ASSERT((otherTo != InvalidVertex) && (simplifier.Remap[otherTo] == toPosition));
+					simplifier.AttributeQuadrics[otherTo].Add(simplifier.AttributeQuadrics[otherFrom]);
+					simplifier.CollapseRemap[otherFrom] = otherTo;
+				}
+
+				simplifier.CollapseLocked[fromPosition] = 1;
+				simplifier.CollapseLocked[toPosition] = 1;
+				// Border edges have a single triangle.
+				triangleCollapses += (simplifier.Kinds[from] == VertexKind::Border) ? 1 : 2;
+				++edgeCollapses;
+				simplifier.Error = std::max(simplifier.Error, collapse.Error);
+			}
+			return edgeCollapses;
+		}
+
+		static void RemapOpenEdges(std::vector<uint32_t>& openEdges, const std::vector<uint32_t>& collapseRemap)
+		{
+			for (size_t vertex = 0; vertex < openEdges.size(); ++vertex)
+			{
+				const uint32_t target = openEdges[vertex];
+				if (target != InvalidVertex)
+				{
+					// A vertex whose open edge collapsed into itself continues along the removed vertex's open edge.
+					const uint32_t remapped = collapseRemap[target];
+					openEdges[vertex] = (remapped == vertex) ? openEdges[target] : remapped;
+				}
+			}
+		}
+
+		static void RemapIndices(Simplifier& simplifier)
+		{
+			size_t count = 0;
+			for (size_t i = 0; i < simplifier.Indices.size(); i += 3)
+			{
+				const uint32_t v0 = simplifier.CollapseRemap[simplifier.Indices[i]];
+				const uint32_t v1 = simplifier.CollapseRemap[simplifier.Indices[i + 1]];
+				const uint32_t v2 = simplifier.CollapseRemap[simplifier.Indices[i + 2]];
+				if ((v0 != v1) && (v0 != v2) && (v1 != v2))
+				{
+					simplifier.Indices[count] = v0;
+					simplifier.Indices[count + 1] = v1;
+					simplifier.Indices[count + 2] = v2;
+					count += 3;
+				}
+			}
+			simplifier.Indices.resize(count);
+		}
+
+		// Collapses edges in passes of independent collapses until at most targetIndexCount indices remain, no edge can collapse or the next collapse
+		// exceeds maxError relative to the unit cube.
+		static void SimplifyTo(Simplifier& simplifier, const size_t targetIndexCount, const float maxError)
+		{
+			simplifier.CollapseRemap.resize(simplifier.VertexCount);
+			simplifier.CollapseLocked.resize(simplifier.VertexCount);
+			while (simplifier.Indices.size() > targetIndexCount)
+			{
+				BuildEdgeAdjacency(simplifier.Adjacency, simplifier.Indices, simplifier.VertexCount, simplifier.Remap.data());
+				PickCollapses(simplifier);
+				if (simplifier.Collapses.empty())
+				{
+					break;
+				}
+
+				RankCollapses(simplifier);
+				const size_t triangleGoal = (simplifier.Indices.size() - targetIndexCount) / 3;
+				if (PerformCollapses(simplifier, triangleGoal, maxError) == 0)
+				{
+					break;
+				}
+
+				RemapOpenEdges(simplifier.OpenNext, simplifier.CollapseRemap);
+				RemapOpenEdges(simplifier.OpenPrevious, simplifier.CollapseRemap);
+				RemapIndices(simplifier);
+			}
+		}
+
+		// Object space error from the squared error relative to the unit cube and back.
+		static float ToObjectError(const Simplifier& simplifier, const float error) { return std::sqrt(error) * simplifier.Extent; }
+		static float FromObjectError(const Simplifier& simplifier, const float error)
+		{
+			const float relative = error / simplifier.Extent;
+			return relative * relative;
+		}
+
+		// Copies the vertices used by the simplified indices in source order.
+		static void ExtractMesh(const AssetTypes::Mesh& source, const std::vector<uint32_t>& indices, AssetTypes::Mesh& outMesh)
+		{
+			std::vector<uint32_t> vertexRemap(source.Positions.size(), InvalidVertex);
+			for (const uint32_t index : indices)
+			{
+				vertexRemap[index] = 0;
+			}
+
+			const bool hasNormals = (source.Normals.size() == source.Positions.size());
+			const bool hasTextureCoordinates = (source.TextureCoordinates.size() == source.Positions.size());
+			const bool hasTangents = (source.Tangents.size() == source.Positions.size());
+			outMesh = {};
+			for (size_t vertex = 0; vertex < source.Positions.size(); ++vertex)
+			{
+				if (vertexRemap[vertex] == InvalidVertex)
+				{
+					continue;
+				}
+
+				vertexRemap[vertex] = static_cast<uint32_t>(outMesh.Positions.size());
+				outMesh.Positions.push_back(source.Positions[vertex]);
+				if (hasNormals)
+				{
+					outMesh.Normals.push_back(source.Normals[vertex]);
+				}
+				if (hasTextureCoordinates)
+				{
+					outMesh.TextureCoordinates.push_back(source.TextureCoordinates[vertex]);
+				}
+				if (hasTangents)
+				{
+					outMesh.Tangents.push_back(source.Tangents[vertex]);
+				}
+			}
+
+			outMesh.Indices.resize(indices.size());
+			for (size_t i = 0; i < indices.size(); ++i)
+			{
+				outMesh.Indices[i] = vertexRemap[indices[i]];
+			}
+			outMesh.CalculateBounds();
+		}
+
+		bool Simplify(const AssetTypes::Mesh& mesh, const size_t targetTriangleCount, const float maxError, const Settings& settings, AssetTypes::Mesh& outMesh,
+			float& outError)
+		{
+			Simplifier simplifier = {};
+			if (!InitializeSimplifier(simplifier, mesh, settings))
+			{
+				return false;
+			}
+
+			SimplifyTo(simplifier, targetTriangleCount * 3, FromObjectError(simplifier, maxError));
+			ExtractMesh(mesh, simplifier.Indices, outMesh);
+			outError = ToObjectError(simplifier, simplifier.Error);
+			return true;
+		}
+
+		bool BuildLODChain(const AssetTypes::Mesh& mesh, const LODChainSettings& settings, LODChain& outChain)
+		{
+			outChain.Levels.clear();
+			outChain.Errors.clear();
+
+			// Every level must have fewer triangles than the previous level.
+			if ((!(settings.TriangleRatio > 0.0f)) || (settings.TriangleRatio >= 1.0f))
+			{
+				LEVIATHAN_LOG("Failed to build level of detail chain. Triangle ratio %f is not between 0 and 1.", settings.TriangleRatio);
+				return false;
+			}
+
+			Simplifier simplifier = {};
+			if (!InitializeSimplifier(simplifier, mesh, settings.Simplification))
+			{
+				return false;
+			}
+
+			outChain.Levels.push_back(mesh);
+			outChain.Errors.push_back(0.0f);
+
+			const float maxError = FromObjectError(simplifier, settings.MaxError);
+			while (outChain.Levels.size() < settings.MaxLevelCount)
+			{
+				const size_t previousCount = simplifier.Indices.size() / 3;
+				const size_t targetCount = static_cast<size_t>(static_cast<float>(previousCount) * settings.TriangleRatio);
+				if (targetCount < settings.MinTriangleCount)
+				{
+					break;
+				}
+
+				SimplifyTo(simplifier, targetCount * 3, maxError);
+
+				// Levels removing less than half of the requested triangles are not worth their memory.
+				const size_t count = simplifier.Indices.size() / 3;
+				if ((previousCount - count) * 2 < previousCount - targetCount)
+				{
+					break;
+				}
+
+				ExtractMesh(mesh, simplifier.Indices, outChain.Levels.emplace_back());
+				outChain.Errors.push_back(ToObjectError(simplifier, simplifier.Error));
+			}
+			return true;
+		}
+	}
+}
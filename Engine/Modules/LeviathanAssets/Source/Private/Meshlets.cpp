@@ -0,0 +1,546 @@
+#include "Meshlets.h"
+#include "AssetTypes.h"
+#include "Logging.h"
+
+namespace LeviathanAssets
+{
+	namespace Meshlets
+	{
+		static constexpr uint8_t UnusedLocalIndex = 0xff;
+		static constexpr uint32_t InvalidTriangle = std::numeric_limits<uint32_t>::max();
+		// Triangle centers are quantized to this many bits per axis for their Morton codes, sorted in passes of RadixBits.
+		static constexpr uint32_t MortonAxisBits = 10;
+		static constexpr uint32_t RadixBits = 10;
+		static constexpr size_t RadixBucketCount = size_t(1) << RadixBits;
+		// Unused triangles near a point are searched among this many triangles before and after a nearby triangle in Morton order.
+		static constexpr size_t NearbySearchRadius = 256;
+
+		using Point = std::array<float, 3>;
+
+		static inline Point Add(const Point& a, const Point& b) { return { a[0] + b[0], a[1] + b[1], a[2] + b[2] }; }
+		static inline Point Subtract(const Point& a, const Point& b) { return { a[0] - b[0], a[1] - b[1], a[2] - b[2] }; }
+		static inline Point Scale(const Point& a, const float s) { return { a[0] * s, a[1] * s, a[2] * s }; }
+		static inline float Dot(const Point& a, const Point& b) { return (a[0] * b[0]) + (a[1] * b[1]) + (a[2] * b[2]); }
+		static inline Point Cross(const Point& a, const Point& b)
+		{
+			return { (a[1] * b[2]) - (a[2] * b[1]), (a[2] * b[0]) - (a[0] * b[2]), (a[0] * b[1]) - (a[1] * b[0]) };
+		}
+
+		// Returns the unit length vector in the direction of a, or the zero vector if a has no length.
+		static inline Point Normalize(const Point& a)
+		{
+			const float length = std::sqrt(Dot(a, a));
+			return (length > 0.0f) ? Scale(a, 1.0f / length) : Point{};
+		}
+
+		// Spreads the low 10 bits of value to every third bit.
+		static inline uint32_t SpreadBits(uint32_t value)
+		{
+			value &= 0x3ff;
+			value = (value | (value << 16)) & 0x030000ff;
+			value = (value | (value << 8)) & 0x0300f00f;
+			value = (value | (value << 4)) & 0x030c30c3;
+			value = (value | (value << 2)) & 0x09249249;
+			return value;
+		}
+
+		struct Builder
+		{
+			const uint32_t* Indices = nullptr;
+			size_t TriangleCount = 0;
+			size_t MaxVertexCount = 0;
+			size_t MaxTriangleCount = 0;
+			float ConeWeight = 0.0f;
+			// Radius of a disc with the area of a full meshlet of average triangles. Scales the distance score.
+			float ExpectedRadius = 1.0f;
+
+			std::vector<Point> Positions = {};
+			std::vector<Point> TriangleCenters = {};
+			// Unit length, or zero for triangles without area.
+			std::vector<Point> TriangleNormals = {};
+
+			// Unused triangles of every vertex in Triangles[Offsets[v], Offsets[v] + Counts[v]), one entry per corner referencing the vertex. Triangles
+			// are removed as they are added to meshlets so that only unused neighbors are visited.
+			std::vector<uint32_t> AdjacencyOffsets = {};
+			std::vector<uint32_t> AdjacencyCounts = {};
+			std::vector<uint32_t> AdjacencyTriangles = {};
+
+			// Triangles in Morton order of their centers and the position of every triangle in that order, for finding unused triangles near a
+			// meshlet that has no unused neighbor.
+			std::vector<uint32_t> MortonOrder = {};
+			std::vector<uint32_t> MortonRanks = {};
+			size_t MortonCursor = 0;
+			std::vector<uint8_t> Used = {};
+			uint32_t LastTriangle = InvalidTriangle;
+
+			// Index of every source vertex in the current meshlet, UnusedLocalIndex if not in the meshlet.
+			std::vector<uint8_t> LocalIndices = {};
+			std::vector<uint32_t> MeshletVertices = {};
+			std::vector<uint32_t> MeshletTriangles = {};
+			std::vector<uint32_t> PreviousMeshletVertices = {};
+			// Unused triangles sharing a vertex with the current meshlet, each listed once. Triangles used since they were listed are removed while
+			// picking.
+			std::vector<uint32_t> Candidates = {};
+			std::vector<uint8_t> CandidateMarks = {};
+			Point CenterSum = {};
+			Point NormalSum = {};
+			std::vector<LeviathanCore::MathTypes::Vector3> BoundsScratch = {};
+		};
+
+		static bool InitializeBuilder(Builder& builder, const AssetTypes::Mesh& mesh, const Settings& settings)
+		{
+			if ((mesh.Indices.size() < 3) || ((mesh.Indices.size() % 3) != 0))
+			{
+				LEVIATHAN_LOG("Failed to build meshlets. Index count %zu is not a non zero multiple of 3.", mesh.Indices.size());
+				return false;
+			}
+			if ((settings.MaxVertexCount < 3) || (settings.MaxVertexCount > MaxVertexCountLimit) || (settings.MaxTriangleCount == 0))
+			{
+				LEVIATHAN_LOG("Failed to build meshlets. Meshlet limits of %zu vertices and %zu triangles are out of range.", settings.MaxVertexCount,
+					settings.MaxTriangleCount);
+				return false;
+			}
+			for (const uint32_t index : mesh.Indices)
+			{
+				if (index >= mesh.Positions.size())
+				{
+					LEVIATHAN_LOG("Failed to build meshlets. Index %u is out of range.", index);
+					return false;
+				}
+			}
+
+			const size_t vertexCount = mesh.Positions.size();
+			builder.Indices = mesh.Indices.data();
+			builder.TriangleCount = mesh.Indices.size() / 3;
+			builder.MaxVertexCount = settings.MaxVertexCount;
+			builder.MaxTriangleCount = settings.MaxTriangleCount;
+			builder.ConeWeight = std::clamp(settings.ConeWeight, 0.0f, 1.0f);
+
+			builder.Positions.resize(vertexCount);
+			for (size_t i = 0; i < vertexCount; ++i)
+			{
+				builder.Positions[i] = { mesh.Positions[i].X(), mesh.Positions[i].Y(), mesh.Positions[i].Z() };
+			}
+
+			builder.TriangleCenters.resize(builder.TriangleCount);
+			builder.TriangleNormals.resize(builder.TriangleCount);
+			double area = 0.0;
+			for (size_t triangle = 0; triangle < builder.TriangleCount; ++triangle)
+			{
+				const Point& p0 = builder.Positions[builder.Indices[(triangle * 3) + 0]];
+				const Point& p1 = builder.Positions[builder.Indices[(triangle * 3) + 1]];
+				const Point& p2 = builder.Positions[builder.Indices[(triangle * 3) + 2]];
+				const Point normal = Cross(Subtract(p1, p0), Subtract(p2, p0));
+				builder.TriangleCenters[triangle] = Scale(Add(Add(p0, p1), p2), 1.0f / 3.0f);
+				builder.TriangleNormals[triangle] = Normalize(normal);
+				area += 0.5 * std::sqrt(static_cast<double>(Dot(normal, normal)));
+			}
+			const double meshletArea = area / static_cast<double>(builder.TriangleCount) * static_cast<double>(builder.MaxTriangleCount);
+			builder.ExpectedRadius = static_cast<float>(std::sqrt(meshletArea / 3.14159265358979));
+			if (!(builder.ExpectedRadius > 0.0f))
+			{
+				builder.ExpectedRadius = 1.0f;
+			}
+
+			// Vertex to triangle adjacency.
+			builder.AdjacencyCounts.assign(vertexCount, 0);
+			for (const uint32_t index : mesh.Indices)
+			{
+				++builder.AdjacencyCounts[index];
+			}
+			builder.AdjacencyOffsets.resize(vertexCount);
+			uint32_t offset = 0;
+			for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+			{
+				builder.AdjacencyOffsets[vertex] = offset;
+				offset += builder.AdjacencyCounts[vertex];
+			}
+			builder.AdjacencyTriangles.resize(mesh.Indices.size());
+			std::fill(builder.AdjacencyCounts.begin(), builder.AdjacencyCounts.end(), 0);
+			for (size_t i = 0; i < mesh.Indices.size(); ++i)
+			{
+				const uint32_t vertex = mesh.Indices[i];
+				builder.AdjacencyTriangles[builder.AdjacencyOffsets[vertex] + builder.AdjacencyCounts[vertex]++] = static_cast<uint32_t>(i / 3);
+			}
+
+			// Morton order of the triangle centers with a least significant digit radix sort of the codes in the high half of the keys.
+			Point centerMin = builder.TriangleCenters[0];
+			Point centerMax = builder.TriangleCenters[0];
+			for (const Point& center : builder.TriangleCenters)
+			{
+				for (size_t axis = 0; axis < 3; ++axis)
+				{
+					centerMin[axis] = std::min(centerMin[axis], center[axis]);
+					centerMax[axis] = std::max(centerMax[axis], center[axis]);
+				}
+			}
+			const float extent = std::max({ centerMax[0] - centerMin[0], centerMax[1] - centerMin[1], centerMax[2] - centerMin[2] });
+			const float quantizationScale = (extent > 0.0f) ? static_cast<float>((1u << MortonAxisBits) - 1) / extent : 0.0f;
+			std::vector<uint64_t> keys(builder.TriangleCount);
+			for (size_t triangle = 0; triangle < builder.TriangleCount; ++triangle)
+			{
+				const Point& center = builder.TriangleCenters[triangle];
+				uint32_t code = 0;
+				for (size_t axis = 0; axis < 3; ++axis)
+				{
+					code |= SpreadBits(static_cast<uint32_t>((center[axis] - centerMin[axis]) * quantizationScale)) << axis;
+				}
+				keys[triangle] = (static_cast<uint64_t>(code) << 32) | triangle;
+			}
+			std::vector<uint64_t> sortedKeys(builder.TriangleCount);
+			for (uint32_t shift = 32; shift < 32 + (3 * MortonAxisBits); shift += RadixBits)
+			{
+				std::array<size_t, RadixBucketCount> bucketOffsets = {};
+				for (const uint64_t key : keys)
+				{
+					++bucketOffsets[(key >> shift) & (RadixBucketCount - 1)];
+				}
+				size_t bucketOffset = 0;
+				for (size_t& bucket : bucketOffsets)
+				{
+					const size_t count = bucket;
+					bucket = bucketOffset;
+					bucketOffset += count;
+				}
+				for (const uint64_t key : keys)
+				{
+					sortedKeys[bucketOffsets[(key >> shift) & (RadixBucketCount - 1)]++] = key;
+				}
+				keys.swap(sortedKeys);
+			}
+			builder.MortonOrder.resize(builder.TriangleCount);
+			builder.MortonRanks.resize(builder.TriangleCount);
+			for (size_t i = 0; i < builder.TriangleCount; ++i)
+			{
+				builder.MortonOrder[i] = static_cast<uint32_t>(keys[i]);
+				builder.MortonRanks[builder.MortonOrder[i]] = static_cast<uint32_t>(i);
+			}
+
+			builder.Used.assign(builder.TriangleCount, 0);
+			builder.CandidateMarks.assign(builder.TriangleCount, 0);
+			builder.LocalIndices.assign(vertexCount, UnusedLocalIndex);
+			builder.MeshletVertices.reserve(builder.MaxVertexCount);
+			builder.MeshletTriangles.reserve(builder.MaxTriangleCount);
+			builder.BoundsScratch.reserve(builder.MaxVertexCount);
+			return true;
+		}
+
+		// Lower scores are better. Prefers triangles near the meshlet's center facing along the meshlet's average normal.
+		static inline float GetTriangleScore(const Builder& builder, const uint32_t triangle, const Point& meshletCenter, const Point& meshletAxis)
+		{
+			const Point offset = Subtract(builder.TriangleCenters[triangle], meshletCenter);
+			const float distance = std::sqrt(Dot(offset, offset));
+			const float spread = Dot(builder.TriangleNormals[triangle], meshletAxis);
+			const float cone = std::max(1.0f - (spread * builder.ConeWeight), 1e-3f);
+			return (1.0f + ((distance / builder.ExpectedRadius) * (1.0f - builder.ConeWeight))) * cone;
+		}
+
+		static inline uint32_t GetNewVertexCount(const Builder& builder, const uint32_t triangle)
+		{
+			const uint32_t* const corners = builder.Indices + (static_cast<size_t>(triangle) * 3);
+			return static_cast<uint32_t>(builder.LocalIndices[corners[0]] == UnusedLocalIndex) + static_cast<uint32_t>(builder.LocalIndices[corners[1]] == UnusedLocalIndex) +
+				static_cast<uint32_t>(builder.LocalIndices[corners[2]] == UnusedLocalIndex);
+		}
+
+		// Returns the best unused triangle sharing a vertex with the current meshlet, or InvalidTriangle if there is none.
+		static uint32_t PickNeighborTriangle(Builder& builder)
+		{
+			const float inverseCount = 1.0f / static_cast<float>(builder.MeshletTriangles.size());
+			const Point meshletCenter = Scale(builder.CenterSum, inverseCount);
+			const Point meshletAxis = Normalize(builder.NormalSum);
+
+			uint32_t bestTriangle = InvalidTriangle;
+			uint32_t bestPriority = std::numeric_limits<uint32_t>::max();
+			float bestScore = std::numeric_limits<float>::max();
+			size_t candidateCount = 0;
+			for (const uint32_t triangle : builder.Candidates)
+			{
+				if (builder.Used[triangle] != 0)
+				{
+					builder.CandidateMarks[triangle] = 0;
+					continue;
+				}
+				builder.Candidates[candidateCount++] = triangle;
+
+				// Triangles adding no vertices come first, then triangles that are the last unused triangle of one of their vertices as they would
+				// otherwise cost that vertex again in a later meshlet.
+				const uint32_t* const corners = builder.Indices + (static_cast<size_t>(triangle) * 3);
+				const uint32_t newVertexCount = GetNewVertexCount(builder, triangle);
+				const bool dangling = (builder.AdjacencyCounts[corners[0]] == 1) || (builder.AdjacencyCounts[corners[1]] == 1) ||
+					(builder.AdjacencyCounts[corners[2]] == 1);
+				const uint32_t priority = (newVertexCount == 0) ? 0 : (dangling ? 1 : newVertexCount + 1);
+				if (priority > bestPriority)
+				{
+					continue;
+				}
+
+				const float score = GetTriangleScore(builder, triangle, meshletCenter, meshletAxis);
+				if ((priority < bestPriority) || (score < bestScore))
+				{
+					bestTriangle = triangle;
+					bestPriority = priority;
+					bestScore = score;
+				}
+			}
+			builder.Candidates.resize(candidateCount);
+			return bestTriangle;
+		}
+
+		// Returns the first unused triangle in Morton order, or InvalidTriangle if every triangle is used.
+		static uint32_t PickNextTriangleInSpace(Builder& builder)
+		{
+			while ((builder.MortonCursor < builder.TriangleCount) && (builder.Used[builder.MortonOrder[builder.MortonCursor]] != 0))
+			{
+				++builder.MortonCursor;
+			}
+			return (builder.MortonCursor < builder.TriangleCount) ? builder.MortonOrder[builder.MortonCursor] : InvalidTriangle;
+		}
+
+		// Returns the unused triangle whose center is nearest to the point among the triangles around nearTriangle in Morton order, or InvalidTriangle if
+		// there is none within maxDistance.
+		static uint32_t PickNearbyTriangle(const Builder& builder, const uint32_t nearTriangle, const Point& point, const float maxDistance)
+		{
+			const size_t rank = builder.MortonRanks[nearTriangle];
+			const size_t first = (rank > NearbySearchRadius) ? rank - NearbySearchRadius : 0;
+			const size_t end = std::min(rank + NearbySearchRadius + 1, builder.TriangleCount);
+			uint32_t bestTriangle = InvalidTriangle;
+			float bestSquaredDistance = maxDistance * maxDistance;
+			for (size_t i = first; i < end; ++i)
+			{
+				const uint32_t triangle = builder.MortonOrder[i];
+				if (builder.Used[triangle] != 0)
+				{
+					continue;
+				}
+				const Point offset = Subtract(builder.TriangleCenters[triangle], point);
+				const float squaredDistance = Dot(offset, offset);
+				if (squaredDistance <= bestSquaredDistance)
+				{
+					bestTriangle = triangle;
+					bestSquaredDistance = squaredDistance;
+				}
+			}
+			return bestTriangle;
+		}
+
+		// Returns the first triangle of a new meshlet. Starts next to the previous meshlet with the triangle whose vertices have the fewest unused
+		// triangles, so that corners between used triangles are filled before they become isolated. A previous meshlet enclosed by used triangles is
+		// continued from the nearest unused triangle.
+		static uint32_t PickSeedTriangle(Builder& builder)
+		{
+			uint32_t bestTriangle = InvalidTriangle;
+			uint32_t bestUnusedCount = std::numeric_limits<uint32_t>::max();
+			for (const uint32_t vertex : builder.PreviousMeshletVertices)
+			{
+				const uint32_t* const triangles = builder.AdjacencyTriangles.data() + builder.AdjacencyOffsets[vertex];
+				for (uint32_t i = 0; i < builder.AdjacencyCounts[vertex]; ++i)
+				{
+					const uint32_t* const corners = builder.Indices + (static_cast<size_t>(triangles[i]) * 3);
+					const uint32_t unusedCount = builder.AdjacencyCounts[corners[0]] + builder.AdjacencyCounts[corners[1]] + builder.AdjacencyCounts[corners[2]];
+					if (unusedCount < bestUnusedCount)
+					{
+						bestTriangle = triangles[i];
+						bestUnusedCount = unusedCount;
+					}
+				}
+			}
+			if ((bestTriangle == InvalidTriangle) && (builder.LastTriangle != InvalidTriangle))
+			{
+				bestTriangle = PickNearbyTriangle(builder, builder.LastTriangle, builder.TriangleCenters[builder.LastTriangle], std::numeric_limits<float>::max());
+			}
+			return (bestTriangle != InvalidTriangle) ? bestTriangle : PickNextTriangleInSpace(builder);
+		}
+
+		static void AddTriangle(Builder& builder, const uint32_t triangle)
+		{
+			const uint32_t* const corners = builder.Indices + (static_cast<size_t>(triangle) * 3);
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				const uint32_t vertex = corners[corner];
+				uint32_t* const triangles = builder.AdjacencyTriangles.data() + builder.AdjacencyOffsets[vertex];
+				uint32_t& count = builder.AdjacencyCounts[vertex];
+				if (builder.LocalIndices[vertex] == UnusedLocalIndex)
+				{
+					builder.LocalIndices[vertex] = static_cast<uint8_t>(builder.MeshletVertices.size());
+					builder.MeshletVertices.push_back(vertex);
+					for (uint32_t i = 0; i < count; ++i)
+					{
+						if (builder.CandidateMarks[triangles[i]] == 0)
+						{
+							builder.CandidateMarks[triangles[i]] = 1;
+							builder.Candidates.push_back(triangles[i]);
+						}
+					}
+				}
+
+				// Remove one adjacency entry per corner so that degenerate triangles referencing a vertex twice are removed twice.
+				for (uint32_t i = 0; i < count; ++i)
+				{
+					if (triangles[i] == triangle)
+					{
+						triangles[i] = triangles[--count];
+						break;
+					}
+				}
+			}
+
+			builder.Used[triangle] = 1;
+			builder.LastTriangle = triangle;
+			builder.MeshletTriangles.push_back(triangle);
+			builder.CenterSum = Add(builder.CenterSum, builder.TriangleCenters[triangle]);
+			builder.NormalSum = Add(builder.NormalSum, builder.TriangleNormals[triangle]);
+		}
+
+		// Sets the meshlet's normal cone from the triangles of the current meshlet. The apex is placed behind every triangle's plane so that every
+		// point in the cone opposite to the axis from the apex is behind every triangle.
+		static void CalculateNormalCone(const Builder& builder, const Point& center, Meshlet& meshlet)
+		{
+			meshlet.ConeApex = LeviathanCore::MathTypes::Vector3(center[0], center[1], center[2]);
+			meshlet.ConeCutoff = 1.0f;
+
+			const Point axis = Normalize(builder.NormalSum);
+			if (Dot(axis, axis) == 0.0f)
+			{
+				return;
+			}
+			meshlet.ConeAxis = LeviathanCore::MathTypes::Vector3(axis[0], axis[1], axis[2]);
+
+			float minAxisDot = 1.0f;
+			for (const uint32_t triangle : builder.MeshletTriangles)
+			{
+				const Point& normal = builder.TriangleNormals[triangle];
+				if (Dot(normal, normal) > 0.0f)
+				{
+					minAxisDot = std::min(minAxisDot, Dot(normal, axis));
+				}
+			}
+			// Triangles facing more than 90 degrees apart can not be back facing together from a single point.
+			if (minAxisDot <= 0.0f)
+			{
+				return;
+			}
+
+			float apexDistance = -std::numeric_limits<float>::max();
+			for (const uint32_t triangle : builder.MeshletTriangles)
+			{
+				const Point& normal = builder.TriangleNormals[triangle];
+				if (Dot(normal, normal) > 0.0f)
+				{
+					const Point& p0 = builder.Positions[builder.Indices[static_cast<size_t>(triangle) * 3]];
+					apexDistance = std::max(apexDistance, Dot(Subtract(center, p0), normal) / Dot(axis, normal));
+				}
+			}
+
+			const Point apex = Subtract(center, Scale(axis, apexDistance));
+			meshlet.ConeApex = LeviathanCore::MathTypes::Vector3(apex[0], apex[1], apex[2]);
+			meshlet.ConeCutoff = std::sqrt(1.0f - (minAxisDot * minAxisDot));
+		}
+
+		static void FinishMeshlet(Builder& builder, MeshletMesh& outMeshlets)
+		{
+			if (builder.MeshletTriangles.empty())
+			{
+				return;
+			}
+
+			Meshlet& meshlet = outMeshlets.Meshlets.emplace_back();
+			meshlet.VertexOffset = static_cast<uint32_t>(outMeshlets.Vertices.size());
+			meshlet.VertexCount = static_cast<uint32_t>(builder.MeshletVertices.size());
+			meshlet.TriangleOffset = static_cast<uint32_t>(outMeshlets.Indices.size() / 3);
+			meshlet.TriangleCount = static_cast<uint32_t>(builder.MeshletTriangles.size());
+
+			outMeshlets.Vertices.insert(outMeshlets.Vertices.end(), builder.MeshletVertices.begin(), builder.MeshletVertices.end());
+			for (const uint32_t triangle : builder.MeshletTriangles)
+			{
+				const uint32_t* const corners = builder.Indices + (static_cast<size_t>(triangle) * 3);
+				for (size_t corner = 0; corner < 3; ++corner)
+				{
+					outMeshlets.Triangles.push_back(builder.LocalIndices[corners[corner]]);
+					outMeshlets.Indices.push_back(corners[corner]);
+				}
+			}
+
+			builder.BoundsScratch.clear();
+			for (const uint32_t vertex : builder.MeshletVertices)
+			{
+				const Point& position = builder.Positions[vertex];
+				builder.BoundsScratch.emplace_back(position[0], position[1], position[2]);
+			}
+			meshlet.BoundingSphere = LeviathanCore::BoundingVolumes::Sphere::FromPoints(builder.BoundsScratch.data(), builder.BoundsScratch.size());
+			const LeviathanCore::MathTypes::Vector3& center = meshlet.BoundingSphere.Center;
+			CalculateNormalCone(builder, Point{ center.X(), center.Y(), center.Z() }, meshlet);
+
+			for (const uint32_t vertex : builder.MeshletVertices)
+			{
+				builder.LocalIndices[vertex] = UnusedLocalIndex;
+			}
+			for (const uint32_t triangle : builder.Candidates)
+			{
+				builder.CandidateMarks[triangle] = 0;
+			}
+			builder.Candidates.clear();
+			builder.PreviousMeshletVertices.swap(builder.MeshletVertices);
+			builder.MeshletVertices.clear();
+			builder.MeshletTriangles.clear();
+			builder.CenterSum = {};
+			builder.NormalSum = {};
+		}
+
+		bool BuildMeshlets(const AssetTypes::Mesh& mesh, const Settings& settings, MeshletMesh& outMeshlets)
+		{
+			outMeshlets.Meshlets.clear();
+			outMeshlets.Vertices.clear();
+			outMeshlets.Triangles.clear();
+			outMeshlets.Indices.clear();
+
+			Builder builder = {};
+			if (!InitializeBuilder(builder, mesh, settings))
+			{
+				return false;
+			}
+			outMeshlets.Triangles.reserve(mesh.Indices.size());
+			outMeshlets.Indices.reserve(mesh.Indices.size());
+
+			for (;;)
+			{
+				uint32_t triangle = InvalidTriangle;
+				if (builder.MeshletTriangles.empty())
+				{
+					triangle = PickSeedTriangle(builder);
+					if (triangle == InvalidTriangle)
+					{
+						break;
+					}
+				}
+				else
+				{
+					triangle = PickNeighborTriangle(builder);
+					// Meshlets enclosed by used triangles and disconnected parts, e.g. faces without shared vertices, continue with a nearby unused
+					// triangle. Meshlets with nothing near their center are finished early rather than grow bounds spanning distant triangles.
+					if (triangle == InvalidTriangle)
+					{
+						const Point center = Scale(builder.CenterSum, 1.0f / static_cast<float>(builder.MeshletTriangles.size()));
+						triangle = PickNearbyTriangle(builder, builder.LastTriangle, center, builder.ExpectedRadius);
+					}
+					if (triangle == InvalidTriangle)
+					{
+						FinishMeshlet(builder, outMeshlets);
+						continue;
+					}
+				}
+
+				if (builder.MeshletVertices.size() + GetNewVertexCount(builder, triangle) > builder.MaxVertexCount)
+				{
+					FinishMeshlet(builder, outMeshlets);
+				}
+				AddTriangle(builder, triangle);
+				if (builder.MeshletTriangles.size() == builder.MaxTriangleCount)
+				{
+					FinishMeshlet(builder, outMeshlets);
+				}
+			}
+			FinishMeshlet(builder, outMeshlets);
+			return true;
+		}
+	}
+}
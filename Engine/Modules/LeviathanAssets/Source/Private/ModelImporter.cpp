@@ -89,6 +89,7 @@ static LeviathanAssets::AssetTypes::Mesh ProcessMesh(aiMesh* mesh, [[maybe_unuse
 	// TODO: Process materials.
 	// TODO: Process bones.
 
+	result.CalculateBounds();
 	return result;
 }
 
@@ -179,6 +180,7 @@ LeviathanAssets::AssetTypes::Mesh LeviathanAssets::ModelImporter::CombineMeshes(
 		}
 	}
 
+	result.CalculateBounds();
 	return result;
 }
 
@@ -218,6 +220,7 @@ LeviathanAssets::AssetTypes::Mesh LeviathanAssets::ModelImporter::CreatePlanePri
 
 	// Calculate tangents
 	result.Tangents = BuildTangentsList(result.Positions.size(), result.Positions.data(), result.TextureCoordinates.data(), result.Indices.size(), result.Indices.data());
+	result.CalculateBounds();
 	return result;
 }
 
@@ -317,6 +320,7 @@ LeviathanAssets::AssetTypes::Mesh LeviathanAssets::ModelImporter::CreateCubePrim
 
 	// Calculate tangents
 	result.Tangents = BuildTangentsList(result.Positions.size(), result.Positions.data(), result.TextureCoordinates.data(), result.Indices.size(), result.Indices.data());
+	result.CalculateBounds();
 	return result;
 }
 
@@ -387,6 +391,7 @@ LeviathanAssets::AssetTypes::Mesh LeviathanAssets::ModelImporter::CreateSpherePr
 	result.Tangents = BuildTangentsList(result.Positions.size(), result.Positions.data(), result.TextureCoordinates.data(), result.Indices.size(), result.Indices.data());
 
 	// Return result.
+	result.CalculateBounds();
 	return result;
 }
 
@@ -525,6 +530,7 @@ LeviathanAssets::AssetTypes::Mesh LeviathanAssets::ModelImporter::CreateCylinder
 	// Calculate tangents
 	result.Tangents = BuildTangentsList(result.Positions.size(), result.Positions.data(), result.TextureCoordinates.data(), result.Indices.size(), result.Indices.data());
 
+	result.CalculateBounds();
 	return result;
 }
 
@@ -664,5 +670,6 @@ LeviathanAssets::AssetTypes::Mesh LeviathanAssets::ModelImporter::CreateConePrim
 	// Calculate tangents
 	result.Tangents = BuildTangentsList(result.Positions.size(), result.Positions.data(), result.TextureCoordinates.data(), result.Indices.size(), result.Indices.data());
 
+	result.CalculateBounds();
 	return result;
 }
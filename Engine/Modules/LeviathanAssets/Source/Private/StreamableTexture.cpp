@@ -0,0 +1,206 @@
+#include "StreamableTexture.h"
+#include "AssetTypes.h"
+#include "Logging.h"
+#include "Serialize.h"
+
+namespace LeviathanAssets
+{
+	namespace StreamableTexture
+	{
+		struct FileHeader
+		{
+			LeviathanCore::Serialize::FileTag Tag = {};
+			uint32_t Width = 0;
+			uint32_t Height = 0;
+			uint32_t MipCount = 0;
+			uint32_t sRGB = 0;
+			uint64_t SourceSizeBytes = 0;
+			int64_t SourceWriteTime = 0;
+		};
+
+		struct FileMipEntry
+		{
+			uint32_t Width = 0;
+			uint32_t Height = 0;
+			uint64_t Offset = 0;
+			uint64_t SizeBytes = 0;
+		};
+
+		// Fills the mip table of a full chain with the mips back to back from the finest. Returns the bytes of the chain.
+		static uint64_t MakeMipTable(const uint32_t width, const uint32_t height, Header& outHeader)
+		{
+			outHeader.Width = width;
+			outHeader.Height = height;
+			outHeader.MipCount = GetMipCount(width, height);
+			outHeader.DataOffset = sizeof(FileHeader) + (static_cast<uint64_t>(outHeader.MipCount) * sizeof(FileMipEntry));
+			outHeader.Mips = {};
+
+			uint64_t offset = 0;
+			for (uint32_t mip = 0; mip < outHeader.MipCount; ++mip)
+			{
+				MipLevel& level = outHeader.Mips[mip];
+				level.Width = std::max(width >> mip, 1u);
+				level.Height = std::max(height >> mip, 1u);
+				level.Offset = offset;
+				level.SizeBytes = static_cast<uint64_t>(level.Width) * level.Height * BytesPerPixel;
+				offset += level.SizeBytes;
+			}
+			return offset;
+		}
+
+		uint32_t GetMipCount(const uint32_t width, const uint32_t height)
+		{
+			return static_cast<uint32_t>(std::bit_width(std::max(std::max(width, height), 1u)));
+		}
+
+		bool BuildMipChain(const AssetTypes::Texture& texture, const bool sRGB, Header& outHeader, std::vector<uint8_t>& outMipData)
+		{
+			outHeader = {};
+			outMipData.clear();
+			if ((texture.Data == nullptr) || (texture.Width <= 0) || (texture.Height <= 0) ||
+				(GetMipCount(static_cast<uint32_t>(texture.Width), static_cast<uint32_t>(texture.Height)) > MaxMipCount))
+			{
+				return false;
+			}
+
+			const uint64_t chainBytes = MakeMipTable(static_cast<uint32_t>(texture.Width), static_cast<uint32_t>(texture.Height), outHeader);
+			outHeader.sRGB = sRGB;
+			outMipData.resize(static_cast<size_t>(chainBytes));
+			memcpy(outMipData.data(), texture.Data, static_cast<size_t>(outHeader.Mips[0].SizeBytes));
+
+			// Color channels are averaged in linear space. Alpha is always linear.
+			std::array<float, 256> toLinear = {};
+			for (size_t value = 0; value < toLinear.size(); ++value)
+			{
+				const float unit = static_cast<float>(value) / 255.0f;
+				toLinear[value] = (!sRGB) ? unit : ((unit <= 0.04045f) ? (unit / 12.92f) : std::pow((unit + 0.055f) / 1.055f, 2.4f));
+			}
+			const auto fromLinear = [sRGB](const float linear)
+				{
+					const float unit = (!sRGB) ? linear : ((linear <= 0.0031308f) ? (linear * 12.92f) : ((1.055f * std::pow(linear, 1.0f / 2.4f)) - 0.055f));
+					return static_cast<uint8_t>(std::clamp((unit * 255.0f) + 0.5f, 0.0f, 255.0f));
+				};
+
+			for (uint32_t mip = 1; mip < outHeader.MipCount; ++mip)
+			{
+				const MipLevel& source = outHeader.Mips[mip - 1];
+				const MipLevel& target = outHeader.Mips[mip];
+				const uint8_t* const sourceData = outMipData.data() + source.Offset;
+				uint8_t* const targetData = outMipData.data() + target.Offset;
+				for (uint32_t y = 0; y < target.Height; ++y)
+				{
+					const std::array<uint32_t, 2> rows = { std::min(2 * y, source.Height - 1), std::min((2 * y) + 1, source.Height - 1) };
+					for (uint32_t x = 0; x < target.Width; ++x)
+					{
+						const std::array<uint32_t, 2> columns = { std::min(2 * x, source.Width - 1), std::min((2 * x) + 1, source.Width - 1) };
+						std::array<float, BytesPerPixel> sum = {};
+						for (const uint32_t row : rows)
+						{
+							for (const uint32_t column : columns)
+							{
+								const uint8_t* const pixel = sourceData + ((static_cast<size_t>(row) * source.Width) + column) * BytesPerPixel;
+								for (uint32_t channel = 0; channel < 3; ++channel)
+								{
+									sum[channel] += toLinear[pixel[channel]];
+								}
+								sum[3] += static_cast<float>(pixel[3]) / 255.0f;
+							}
+						}
+
+						uint8_t* const pixel = targetData + ((static_cast<size_t>(y) * target.Width) + x) * BytesPerPixel;
+						for (uint32_t channel = 0; channel < 3; ++channel)
+						{
+							pixel[channel] = fromLinear(sum[channel] * 0.25f);
+						}
+						pixel[3] = static_cast<uint8_t>(std::clamp((sum[3] * 0.25f * 255.0f) + 0.5f, 0.0f, 255.0f));
+					}
+				}
+			}
+			return true;
+		}
+
+		bool Save(const std::string_view file, const Header& header, const std::vector<uint8_t>& mipData)
+		{
+			if ((header.MipCount == 0) || (header.MipCount > MaxMipCount) ||
+				(mipData.size() != header.Mips[header.MipCount - 1].Offset + header.Mips[header.MipCount - 1].SizeBytes))
+			{
+				LEVIATHAN_LOG("Failed to save streamable texture %s. The mip data does not match the mip table.", file.data());
+				return false;
+			}
+
+			std::vector<uint8_t> bytes(static_cast<size_t>(header.DataOffset) + mipData.size(), 0);
+			FileHeader fileHeader = {};
+			fileHeader.Tag = FileTag;
+			fileHeader.Width = header.Width;
+			fileHeader.Height = header.Height;
+			fileHeader.MipCount = header.MipCount;
+			fileHeader.sRGB = header.sRGB ? 1 : 0;
+			fileHeader.SourceSizeBytes = header.Source.SizeBytes;
+			fileHeader.SourceWriteTime = header.Source.WriteTime;
+			memcpy(bytes.data(), &fileHeader, sizeof(FileHeader));
+			for (uint32_t mip = 0; mip < header.MipCount; ++mip)
+			{
+				const MipLevel& level = header.Mips[mip];
+				const FileMipEntry entry = { .Width = level.Width, .Height = level.Height, .Offset = level.Offset, .SizeBytes = level.SizeBytes };
+				memcpy(bytes.data() + sizeof(FileHeader) + (mip * sizeof(FileMipEntry)), &entry, sizeof(FileMipEntry));
+			}
+			memcpy(bytes.data() + header.DataOffset, mipData.data(), mipData.size());
+			return LeviathanCore::Serialize::WriteBytesToFile(file, bytes);
+		}
+
+		bool LoadHeader(const std::string_view file, Header& outHeader)
+		{
+			outHeader = {};
+			std::vector<uint8_t> bytes = {};
+			if (!LeviathanCore::Serialize::FileExists(file) || !LeviathanCore::Serialize::ReadFileRange(file, 0, sizeof(FileHeader), bytes))
+			{
+				return false;
+			}
+
+			FileHeader fileHeader = {};
+			if (!LeviathanCore::Serialize::ReadFileHeader(bytes, FileTag, fileHeader) || (fileHeader.Width == 0) || (fileHeader.Height == 0) ||
+				(fileHeader.MipCount != GetMipCount(fileHeader.Width, fileHeader.Height)) || (fileHeader.MipCount > MaxMipCount))
+			{
+				LEVIATHAN_LOG("Failed to load streamable texture %s. The file is from another version or corrupt.", file.data());
+				return false;
+			}
+
+			if (!LeviathanCore::Serialize::ReadFileRange(file, sizeof(FileHeader), fileHeader.MipCount * sizeof(FileMipEntry), bytes))
+			{
+				LEVIATHAN_LOG("Failed to load streamable texture %s. The mip table is truncated.", file.data());
+				return false;
+			}
+
+			// The stored table must match the table of the texture's full chain.
+			MakeMipTable(fileHeader.Width, fileHeader.Height, outHeader);
+			outHeader.sRGB = (fileHeader.sRGB != 0);
+			outHeader.Source = { .SizeBytes = fileHeader.SourceSizeBytes, .WriteTime = fileHeader.SourceWriteTime };
+			for (uint32_t mip = 0; mip < fileHeader.MipCount; ++mip)
+			{
+				FileMipEntry entry = {};
+				memcpy(&entry, bytes.data() + (mip * sizeof(FileMipEntry)), sizeof(FileMipEntry));
+				const MipLevel& level = outHeader.Mips[mip];
+				if ((entry.Width != level.Width) || (entry.Height != level.Height) || (entry.Offset != level.Offset) || (entry.SizeBytes != level.SizeBytes))
+				{
+					LEVIATHAN_LOG("Failed to load streamable texture %s. Mip %u is corrupt.", file.data(), mip);
+					outHeader = {};
+					return false;
+				}
+			}
+			return true;
+		}
+
+		bool ReadMips(const std::string_view file, const Header& header, const uint32_t firstMip, const uint32_t mipCount, std::vector<uint8_t>& outMipData)
+		{
+			if ((mipCount == 0) || (firstMip >= header.MipCount) || (mipCount > header.MipCount - firstMip))
+			{
+				return false;
+			}
+
+			const MipLevel& last = header.Mips[firstMip + mipCount - 1];
+			const uint64_t offset = header.Mips[firstMip].Offset;
+			const uint64_t sizeBytes = last.Offset + last.SizeBytes - offset;
+			return LeviathanCore::Serialize::ReadFileRange(file, header.DataOffset + offset, static_cast<size_t>(sizeBytes), outMipData);
+		}
+	}
+}
@@ -0,0 +1,1053 @@
+#include "TriangleBVH.h"
+#include "AssetTypes.h"
+#include "JobSystem.h"
+#include "LeviathanAssert.h"
+#include "Logging.h"
+#include "Simd.h"
+
+namespace LeviathanAssets
+{
+	// Ranges with at most this many triangles may become leaves when that is cheaper than splitting them.
+	static constexpr uint32_t MaxLeafTriangles = 8;
+	static constexpr size_t MinBinCount = 8;
+	static constexpr size_t MaxBinCount = 32;
+	static constexpr float TraversalCost = 1.0f;
+	static constexpr float IntersectionCost = 1.0f;
+	// Ranges deeper than this are split at the object median, which bounds the tree depth for the fixed size traversal stacks.
+	static constexpr size_t MaxSurfaceAreaHeuristicDepth = 48;
+	static constexpr size_t TraversalStackSize = 256;
+	// The upper levels of the tree are split with parallel binning until every range is small enough to be built as an independent subtree job.
+	static constexpr size_t SubtreesPerThread = 8;
+	static constexpr size_t MinSubtreeSize = 4096;
+	static constexpr size_t ParallelChunkSize = 16384;
+	// Direction components closer to zero are clamped so that inverse directions stay finite.
+	static constexpr float MinDirectionComponent = 1e-20f;
+
+	struct BuildBox
+	{
+		std::array<float, 3> Min = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+		std::array<float, 3> Max = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+
+		inline void Grow(const std::array<float, 3>& point)
+		{
+			for (size_t axis = 0; axis < 3; ++axis)
+			{
+				Min[axis] = std::min(Min[axis], point[axis]);
+				Max[axis] = std::max(Max[axis], point[axis]);
+			}
+		}
+
+		inline void Grow(const BuildBox& other)
+		{
+			for (size_t axis = 0; axis < 3; ++axis)
+			{
+				Min[axis] = std::min(Min[axis], other.Min[axis]);
+				Max[axis] = std::max(Max[axis], other.Max[axis]);
+			}
+		}
+
+		inline float SurfaceArea() const
+		{
+			if (Min[0] > Max[0])
+			{
+				return 0.0f;
+			}
+
+			const float x = Max[0] - Min[0];
+			const float y = Max[1] - Min[1];
+			const float z = Max[2] - Min[2];
+			return 2.0f * ((x * y) + (y * z) + (z * x));
+		}
+	};
+
+	struct BuildReference
+	{
+		BuildBox Box = {};
+		uint32_t Triangle = 0;
+
+		// Twice the box center, which bins and orders references the same as the center.
+		inline float Centroid(const size_t axis) const { return Box.Min[axis] + Box.Max[axis]; }
+		inline std::array<float, 3> Centroid() const { return { Centroid(0), Centroid(1), Centroid(2) }; }
+	};
+
+	// Binary node. Leaves have a non zero reference count.
+	struct BuildNode
+	{
+		BuildBox Box = {};
+		uint32_t Child1 = 0;
+		uint32_t Child2 = 0;
+		uint32_t FirstReference = 0;
+		uint32_t ReferenceCount = 0;
+
+		inline bool IsLeaf() const { return ReferenceCount > 0; }
+	};
+
+	// References [First, First + Count) that become the node with index Node.
+	struct BuildRange
+	{
+		uint32_t Node = 0;
+		uint32_t First = 0;
+		uint32_t Count = 0;
+		size_t Depth = 0;
+		BuildBox Box = {};
+		BuildBox CentroidBox = {};
+	};
+
+	struct Bin
+	{
+		BuildBox Box = {};
+		uint32_t Count = 0;
+	};
+
+	using BinGrid = std::array<std::array<Bin, MaxBinCount>, 3>;
+
+	struct BinMapping
+	{
+		std::array<float, 3> Offset = {};
+		std::array<float, 3> Scale = {};
+		size_t Count = MaxBinCount;
+
+		inline size_t Index(const BuildReference& reference, const size_t axis) const
+		{
+			const int32_t index = static_cast<int32_t>((reference.Centroid(axis) - Offset[axis]) * Scale[axis]);
+			return static_cast<size_t>(std::clamp(index, 0, static_cast<int32_t>(Count - 1)));
+		}
+	};
+
+	struct Split
+	{
+		// 3 if no split was found.
+		size_t Axis = 3;
+		// References in bins [0, LastBin] go to the first child.
+		size_t LastBin = 0;
+		float Cost = std::numeric_limits<float>::max();
+		std::array<BuildBox, 2> Boxes = {};
+		std::array<uint32_t, 2> Counts = {};
+	};
+
+	// Small ranges use fewer bins as the per split cost of clearing and sweeping the bins dominates.
+	static BinMapping MakeBinMapping(const BuildBox& centroidBox, const uint32_t referenceCount)
+	{
+		BinMapping mapping = {};
+		mapping.Count = std::clamp(static_cast<size_t>(referenceCount) / 4, MinBinCount, MaxBinCount);
+		for (size_t axis = 0; axis < 3; ++axis)
+		{
+			const float extent = centroidBox.Max[axis] - centroidBox.Min[axis];
+			mapping.Offset[axis] = centroidBox.Min[axis];
+			mapping.Scale[axis] = (extent > 0.0f) ? ((static_cast<float>(mapping.Count) * (1.0f - 1e-5f)) / extent) : 0.0f;
+		}
+		return mapping;
+	}
+
+	static void ClearBins(const BinMapping& mapping, BinGrid& bins)
+	{
+		for (size_t axis = 0; axis < 3; ++axis)
+		{
+			std::fill(bins[axis].begin(), bins[axis].begin() + mapping.Count, Bin{});
+		}
+	}
+
+	static void BinReferences(const BuildReference* const references, const size_t count, const BinMapping& mapping, BinGrid& bins)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			const BuildReference& reference = references[i];
+			for (size_t axis = 0; axis < 3; ++axis)
+			{
+				Bin& bin = bins[axis][mapping.Index(reference, axis)];
+				bin.Box.Grow(reference.Box);
+				++bin.Count;
+			}
+		}
+	}
+
+	static Split FindBestSplit(const BinGrid& bins, const BinMapping& mapping, const BuildBox& centroidBox, const float parentArea)
+	{
+		Split best = {};
+		const float inverseParentArea = 1.0f / std::max(parentArea, std::numeric_limits<float>::min());
+		const size_t binCount = mapping.Count;
+
+		for (size_t axis = 0; axis < 3; ++axis)
+		{
+			if (centroidBox.Max[axis] <= centroidBox.Min[axis])
+			{
+				continue;
+			}
+
+			// Sweep from the right to find the area and count of every right side.
+			std::array<float, MaxBinCount> rightAreas = {};
+			std::array<uint32_t, MaxBinCount> rightCounts = {};
+			BuildBox right = {};
+			uint32_t rightCount = 0;
+			for (size_t i = binCount - 1; i > 0; --i)
+			{
+				right.Grow(bins[axis][i].Box);
+				rightCount += bins[axis][i].Count;
+				rightAreas[i - 1] = right.SurfaceArea();
+				rightCounts[i - 1] = rightCount;
+			}
+
+			BuildBox left = {};
+			uint32_t leftCount = 0;
+			for (size_t i = 0; i < binCount - 1; ++i)
+			{
+				left.Grow(bins[axis][i].Box);
+				leftCount += bins[axis][i].Count;
+				if ((leftCount == 0) || (rightCounts[i] == 0))
+				{
+					continue;
+				}
+
+				const float cost = TraversalCost + (IntersectionCost * ((left.SurfaceArea() * static_cast<float>(leftCount)) +
+					(rightAreas[i] * static_cast<float>(rightCounts[i]))) * inverseParentArea);
+				if (cost < best.Cost)
+				{
+					best.Axis = axis;
+					best.LastBin = i;
+					best.Cost = cost;
+				}
+			}
+		}
+
+		if (best.Axis < 3)
+		{
+			for (size_t i = 0; i < binCount; ++i)
+			{
+				const Bin& bin = bins[best.Axis][i];
+				const size_t side = (i <= best.LastBin) ? 0 : 1;
+				best.Boxes[side].Grow(bin.Box);
+				best.Counts[side] += bin.Count;
+			}
+		}
+
+		return best;
+	}
+
+	static BuildBox CalculateCentroidBox(const BuildReference* const references, const size_t count)
+	{
+		BuildBox box = {};
+		for (size_t i = 0; i < count; ++i)
+		{
+			box.Grow(references[i].Centroid());
+		}
+		return box;
+	}
+
+	// Splits the range in two and returns true or returns false if the range should become a leaf. bins is scratch memory. Binning runs on the job
+	// system when threadBins is not null, which must have an entry for every job system thread.
+	static bool SplitRange(std::vector<BuildReference>& references, const BuildRange& range, BinGrid& bins, std::vector<BinGrid>* const threadBins,
+		BuildRange& outFirst, BuildRange& outSecond)
+	{
+		if (range.Count <= 1)
+		{
+			return false;
+		}
+
+		BuildReference* const first = references.data() + range.First;
+		BuildReference* const last = first + range.Count;
+
+		outFirst.Depth = range.Depth + 1;
+		outSecond.Depth = range.Depth + 1;
+
+		if (range.Depth < MaxSurfaceAreaHeuristicDepth)
+		{
+			const BinMapping mapping = MakeBinMapping(range.CentroidBox, range.Count);
+			ClearBins(mapping, bins);
+			if (threadBins != nullptr)
+			{
+				for (BinGrid& grid : *threadBins)
+				{
+					ClearBins(mapping, grid);
+				}
+
+				LeviathanCore::JobSystem::ParallelFor(range.Count, ParallelChunkSize, [first, &mapping, threadBins](const size_t rangeFirst, const size_t rangeCount,
+					const size_t threadIndex)
+					{
+						BinReferences(first + rangeFirst, rangeCount, mapping, (*threadBins)[threadIndex]);
+					});
+
+				for (const BinGrid& grid : *threadBins)
+				{
+					for (size_t axis = 0; axis < 3; ++axis)
+					{
+						for (size_t i = 0; i < mapping.Count; ++i)
+						{
+							bins[axis][i].Box.Grow(grid[axis][i].Box);
+							bins[axis][i].Count += grid[axis][i].Count;
+						}
+					}
+				}
+			}
+			else
+			{
+				BinReferences(first, range.Count, mapping, bins);
+			}
+
+			const Split split = FindBestSplit(bins, mapping, range.CentroidBox, range.Box.SurfaceArea());
+			const float leafCost = IntersectionCost * static_cast<float>(range.Count);
+			if ((range.Count <= MaxLeafTriangles) && ((split.Axis >= 3) || (leafCost <= split.Cost)))
+			{
+				return false;
+			}
+
+			if (split.Axis < 3)
+			{
+				BuildReference* const middle = std::partition(first, last, [&mapping, &split](const BuildReference& reference)
+					{
+						return mapping.Index(reference, split.Axis) <= split.LastBin;
+					});
+				LEVIATHAN_ASSERT(static_cast<uint32_t>(middle - first) == split.Counts[0]);
+
+				outFirst.First = range.First;
+				outFirst.Count = split.Counts[0];
+				outFirst.Box = split.Boxes[0];
+				outFirst.CentroidBox = CalculateCentroidBox(first, split.Counts[0]);
+				outSecond.First = range.First + split.Counts[0];
+				outSecond.Count = split.Counts[1];
+				outSecond.Box = split.Boxes[1];
+				outSecond.CentroidBox = CalculateCentroidBox(middle, split.Counts[1]);
+				return true;
+			}
+		}
+
+		if (range.Count <= MaxLeafTriangles)
+		{
+			return false;
+		}
+
+		// Split at the object median along the widest centroid axis. Also separates references with coincident centroids, which binning cannot.
+		size_t axis = 0;
+		for (size_t i = 1; i < 3; ++i)
+		{
+			if ((range.CentroidBox.Max[i] - range.CentroidBox.Min[i]) > (range.CentroidBox.Max[axis] - range.CentroidBox.Min[axis]))
+			{
+				axis = i;
+			}
+		}
+
+		const uint32_t half = range.Count / 2;
+		std::nth_element(first, first + half, last, [axis](const BuildReference& a, const BuildReference& b) { return a.Centroid(axis) < b.Centroid(axis); });
+
+		outFirst.First = range.First;
+		outFirst.Count = half;
+		outSecond.First = range.First + half;
+		outSecond.Count = range.Count - half;
+		for (BuildRange* const child : { &outFirst, &outSecond })
+		{
+			child->Box = {};
+			for (const BuildReference* reference = references.data() + child->First; reference != references.data() + child->First + child->Count; ++reference)
+			{
+				child->Box.Grow(reference->Box);
+			}
+			child->CentroidBox = CalculateCentroidBox(references.data() + child->First, child->Count);
+		}
+		return true;
+	}
+
+	// Builds the subtree of the range into outNodes with the range's node at index 0.
+	static void BuildSubtree(std::vector<BuildReference>& references, BuildRange root, std::vector<BuildNode>& outNodes)
+	{
+		outNodes.clear();
+		outNodes.reserve((2 * static_cast<size_t>(root.Count) / MaxLeafTriangles) + 1);
+		outNodes.emplace_back();
+		outNodes[0].Box = root.Box;
+
+		root.Node = 0;
+		BinGrid bins = {};
+		std::vector<BuildRange> stack = { root };
+		while (!stack.empty())
+		{
+			const BuildRange range = stack.back();
+			stack.pop_back();
+
+			BuildRange first = {};
+			BuildRange second = {};
+			if (!SplitRange(references, range, bins, nullptr, first, second))
+			{
+				outNodes[range.Node].FirstReference = range.First;
+				outNodes[range.Node].ReferenceCount = range.Count;
+				continue;
+			}
+
+			first.Node = static_cast<uint32_t>(outNodes.size());
+			second.Node = first.Node + 1;
+			outNodes.resize(outNodes.size() + 2);
+			outNodes[first.Node].Box = first.Box;
+			outNodes[second.Node].Box = second.Box;
+			outNodes[range.Node].Child1 = first.Node;
+			outNodes[range.Node].Child2 = second.Node;
+
+			stack.push_back(second);
+			stack.push_back(first);
+		}
+	}
+
+	static void BuildBinaryTree(std::vector<BuildReference>& references, std::vector<BuildNode>& outNodes)
+	{
+		BuildRange root = {};
+		root.Count = static_cast<uint32_t>(references.size());
+		for (const BuildReference& reference : references)
+		{
+			root.Box.Grow(reference.Box);
+			root.CentroidBox.Grow(reference.Centroid());
+		}
+
+		outNodes.clear();
+		outNodes.emplace_back();
+		outNodes[0].Box = root.Box;
+
+		// Split the upper levels with parallel binning until the ranges can be built as independent subtrees.
+		const size_t threadCount = LeviathanCore::JobSystem::GetThreadCount();
+		const size_t subtreeSize = (threadCount > 1) ? std::max(references.size() / (threadCount * SubtreesPerThread), MinSubtreeSize) : references.size();
+
+		BinGrid bins = {};
+		std::vector<BinGrid> threadBins(threadCount);
+		std::vector<BuildRange> subtreeRanges = {};
+		std::vector<BuildRange> stack = { root };
+		while (!stack.empty())
+		{
+			const BuildRange range = stack.back();
+			stack.pop_back();
+
+			if (range.Count <= subtreeSize)
+			{
+				subtreeRanges.push_back(range);
+				continue;
+			}
+
+			BuildRange first = {};
+			BuildRange second = {};
+			if (!SplitRange(references, range, bins, &threadBins, first, second))
+			{
+				outNodes[range.Node].FirstReference = range.First;
+				outNodes[range.Node].ReferenceCount = range.Count;
+				continue;
+			}
+
+			first.Node = static_cast<uint32_t>(outNodes.size());
+			second.Node = first.Node + 1;
+			outNodes.resize(outNodes.size() + 2);
+			outNodes[first.Node].Box = first.Box;
+			outNodes[second.Node].Box = second.Box;
+			outNodes[range.Node].Child1 = first.Node;
+			outNodes[range.Node].Child2 = second.Node;
+
+			stack.push_back(second);
+			stack.push_back(first);
+		}
+
+		// Largest subtrees first so that small ones fill in at the end.
+		std::sort(subtreeRanges.begin(), subtreeRanges.end(), [](const BuildRange& a, const BuildRange& b) { return a.Count > b.Count; });
+
+		std::vector<std::vector<BuildNode>> subtreeNodes(subtreeRanges.size());
+		LeviathanCore::JobSystem::ParallelFor(subtreeRanges.size(), 1, [&references, &subtreeRanges, &subtreeNodes](const size_t first, const size_t count, const size_t)
+			{
+				for (size_t i = first; i < first + count; ++i)
+				{
+					BuildSubtree(references, subtreeRanges[i], subtreeNodes[i]);
+				}
+			});
+
+		// Link the subtrees into the upper levels. The subtree root replaces the range's node and the other nodes are appended.
+		for (size_t i = 0; i < subtreeRanges.size(); ++i)
+		{
+			const std::vector<BuildNode>& nodes = subtreeNodes[i];
+			const uint32_t offset = static_cast<uint32_t>(outNodes.size()) - 1;
+			const auto relocate = [offset](BuildNode node)
+				{
+					if (!node.IsLeaf())
+					{
+						node.Child1 += offset;
+						node.Child2 += offset;
+					}
+					return node;
+				};
+
+			outNodes[subtreeRanges[i].Node] = relocate(nodes[0]);
+			for (size_t j = 1; j < nodes.size(); ++j)
+			{
+				outNodes.push_back(relocate(nodes[j]));
+			}
+		}
+	}
+
+	// Converts the binary subtree at binaryIndex to 4 wide nodes by repeatedly opening the child with the largest surface area. Returns the node index.
+	static uint32_t CollapseNode(const std::vector<BuildNode>& binaryNodes, const uint32_t binaryIndex, const size_t depth,
+		std::vector<TriangleBVH::Node>& nodes, size_t& maxDepth)
+	{
+		maxDepth = std::max(maxDepth, depth);
+
+		std::array<uint32_t, TriangleBVH::NodeWidth> slots = {};
+		size_t slotCount = 0;
+		const BuildNode& binaryNode = binaryNodes[binaryIndex];
+		if (binaryNode.IsLeaf())
+		{
+			slots[slotCount++] = binaryIndex;
+		}
+		else
+		{
+			slots[slotCount++] = binaryNode.Child1;
+			slots[slotCount++] = binaryNode.Child2;
+		}
+
+		while (slotCount < TriangleBVH::NodeWidth)
+		{
+			size_t largest = TriangleBVH::NodeWidth;
+			float largestArea = -1.0f;
+			for (size_t i = 0; i < slotCount; ++i)
+			{
+				const BuildNode& node = binaryNodes[slots[i]];
+				if ((!node.IsLeaf()) && (node.Box.SurfaceArea() > largestArea))
+				{
+					largest = i;
+					largestArea = node.Box.SurfaceArea();
+				}
+			}
+
+			if (largest == TriangleBVH::NodeWidth)
+			{
+				break;
+			}
+
+			const BuildNode& opened = binaryNodes[slots[largest]];
+			slots[largest] = opened.Child1;
+			slots[slotCount++] = opened.Child2;
+		}
+
+		const uint32_t nodeIndex = static_cast<uint32_t>(nodes.size());
+		nodes.emplace_back();
+		for (size_t i = 0; i < TriangleBVH::NodeWidth; ++i)
+		{
+			TriangleBVH::Node& node = nodes[nodeIndex];
+			for (size_t axis = 0; axis < 3; ++axis)
+			{
+				node.ChildBounds[axis][i] = std::numeric_limits<float>::max();
+				node.ChildBounds[axis + 3][i] = std::numeric_limits<float>::lowest();
+			}
+			node.Children[i] = TriangleBVH::EmptyChild;
+			node.TriangleCounts[i] = 0;
+		}
+
+		for (size_t i = 0; i < slotCount; ++i)
+		{
+			const BuildNode& child = binaryNodes[slots[i]];
+			const uint32_t childIndex = child.IsLeaf() ? child.FirstReference : CollapseNode(binaryNodes, slots[i], depth + 1, nodes, maxDepth);
+
+			// Collapsing children grows nodes so the reference is taken afterwards.
+			TriangleBVH::Node& node = nodes[nodeIndex];
+			for (size_t axis = 0; axis < 3; ++axis)
+			{
+				node.ChildBounds[axis][i] = child.Box.Min[axis];
+				node.ChildBounds[axis + 3][i] = child.Box.Max[axis];
+			}
+			node.Children[i] = childIndex;
+			node.TriangleCounts[i] = child.ReferenceCount;
+		}
+
+		return nodeIndex;
+	}
+
+	// Precomputed ray data for testing the ray against node children.
+	struct TraversalRay
+	{
+		std::array<float, 3> Origin = {};
+		std::array<float, 3> Direction = {};
+		std::array<float, 3> InverseDirection = {};
+		// Index into Node::ChildBounds of the plane entered and exited first on each axis.
+		std::array<size_t, 3> NearPlanes = {};
+		std::array<size_t, 3> FarPlanes = {};
+
+		TraversalRay(const LeviathanCore::BoundingVolumes::Ray& ray)
+		{
+			for (size_t axis = 0; axis < 3; ++axis)
+			{
+				Origin[axis] = ray.Origin.Data()[axis];
+				Direction[axis] = ray.Direction.Data()[axis];
+				const float component = (std::fabs(Direction[axis]) < MinDirectionComponent) ? std::copysign(MinDirectionComponent, Direction[axis]) : Direction[axis];
+				InverseDirection[axis] = 1.0f / component;
+				NearPlanes[axis] = (InverseDirection[axis] < 0.0f) ? axis + 3 : axis;
+				FarPlanes[axis] = (InverseDirection[axis] < 0.0f) ? axis : axis + 3;
+			}
+		}
+	};
+
+	// Returns a bit mask of the children of the node hit by the ray within [0, maxDistance] and their entry distances. Unused children are never hit
+	// because their inverted boxes put the near plane beyond the far plane.
+	static uint32_t IntersectChildren(const TriangleBVH::Node& node, const TraversalRay& ray, const float maxDistance, std::array<float, TriangleBVH::NodeWidth>& outDistances)
+	{
+#ifdef LEVIATHAN_SIMD_SSE
+		__m128 nearDistances = _mm_setzero_ps();
+		__m128 farDistances = _mm_set1_ps(maxDistance);
+		for (size_t axis = 0; axis < 3; ++axis)
+		{
+			const __m128 origin = _mm_set1_ps(ray.Origin[axis]);
+			const __m128 inverseDirection = _mm_set1_ps(ray.InverseDirection[axis]);
+			const __m128 nearPlanes = _mm_load_ps(node.ChildBounds[ray.NearPlanes[axis]].data());
+			const __m128 farPlanes = _mm_load_ps(node.ChildBounds[ray.FarPlanes[axis]].data());
+			nearDistances = _mm_max_ps(nearDistances, _mm_mul_ps(_mm_sub_ps(nearPlanes, origin), inverseDirection));
+			farDistances = _mm_min_ps(farDistances, _mm_mul_ps(_mm_sub_ps(farPlanes, origin), inverseDirection));
+		}
+		_mm_storeu_ps(outDistances.data(), nearDistances);
+		return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(nearDistances, farDistances)));
+#else
+		uint32_t mask = 0;
+		for (size_t i = 0; i < TriangleBVH::NodeWidth; ++i)
+		{
+			float nearDistance = 0.0f;
+			float farDistance = maxDistance;
+			for (size_t axis = 0; axis < 3; ++axis)
+			{
+				nearDistance = std::max(nearDistance, (node.ChildBounds[ray.NearPlanes[axis]][i] - ray.Origin[axis]) * ray.InverseDirection[axis]);
+				farDistance = std::min(farDistance, (node.ChildBounds[ray.FarPlanes[axis]][i] - ray.Origin[axis]) * ray.InverseDirection[axis]);
+			}
+			outDistances[i] = nearDistance;
+			mask |= (nearDistance <= farDistance) ? (1u << i) : 0u;
+		}
+		return mask;
+#endif // LEVIATHAN_SIMD_SSE.
+	}
+
+	// Members are not initialized so that traversal stacks are not cleared for every ray.
+	struct TraversalStackEntry
+	{
+		uint32_t Node;
+		// Entry distance of the node's box. Nodes beyond the closest hit are skipped when popped.
+		float Distance;
+	};
+
+	// Pushes the children onto the stack ordered far to near so that the nearest child is visited first.
+	static void PushFarToNear(std::array<TraversalStackEntry, TriangleBVH::NodeWidth>& children, const size_t childCount,
+		std::array<TraversalStackEntry, TraversalStackSize>& stack, size_t& stackCount)
+	{
+		for (size_t i = 1; i < childCount; ++i)
+		{
+			const TraversalStackEntry entry = children[i];
+			size_t j = i;
+			for (; (j > 0) && (children[j - 1].Distance < entry.Distance); --j)
+			{
+				children[j] = children[j - 1];
+			}
+			children[j] = entry;
+		}
+
+		LEVIATHAN_ASSERT(stackCount + childCount <= TraversalStackSize);
+		for (size_t i = 0; i < childCount; ++i)
+		{
+			stack[stackCount++] = children[i];
+		}
+	}
+
+	// Moller-Trumbore ray triangle intersection. Returns true if the ray hits the triangle within [0, maxDistance].
+	static bool IntersectTriangle(const TriangleBVH::Triangle& triangle, const TraversalRay& ray, const float maxDistance, float& outDistance, float& outU, float& outV)
+	{
+		const std::array<float, 3>& d = ray.Direction;
+		const std::array<float, 3>& e1 = triangle.Edge1;
+		const std::array<float, 3>& e2 = triangle.Edge2;
+
+		const float px = (d[1] * e2[2]) - (d[2] * e2[1]);
+		const float py = (d[2] * e2[0]) - (d[0] * e2[2]);
+		const float pz = (d[0] * e2[1]) - (d[1] * e2[0]);
+		const float determinant = (e1[0] * px) + (e1[1] * py) + (e1[2] * pz);
+		if (determinant == 0.0f)
+		{
+			return false;
+		}
+
+		const float inverseDeterminant = 1.0f / determinant;
+		const float tx = ray.Origin[0] - triangle.Vertex0[0];
+		const float ty = ray.Origin[1] - triangle.Vertex0[1];
+		const float tz = ray.Origin[2] - triangle.Vertex0[2];
+		const float u = ((tx * px) + (ty * py) + (tz * pz)) * inverseDeterminant;
+		if ((u < 0.0f) || (u > 1.0f))
+		{
+			return false;
+		}
+
+		const float qx = (ty * e1[2]) - (tz * e1[1]);
+		const float qy = (tz * e1[0]) - (tx * e1[2]);
+		const float qz = (tx * e1[1]) - (ty * e1[0]);
+		const float v = ((d[0] * qx) + (d[1] * qy) + (d[2] * qz)) * inverseDeterminant;
+		if ((v < 0.0f) || ((u + v) > 1.0f))
+		{
+			return false;
+		}
+
+		const float distance = ((e2[0] * qx) + (e2[1] * qy) + (e2[2] * qz)) * inverseDeterminant;
+		if ((distance < 0.0f) || (distance > maxDistance))
+		{
+			return false;
+		}
+
+		outDistance = distance;
+		outU = u;
+		outV = v;
+		return true;
+	}
+
+	bool TriangleBVH::Build(const AssetTypes::Mesh& mesh)
+	{
+		return Build(mesh.Positions.data(), mesh.Positions.size(), mesh.Indices.data(), mesh.Indices.size());
+	}
+
+	bool TriangleBVH::Build(const LeviathanCore::MathTypes::Vector3* const positions, const size_t positionCount, const uint32_t* const indices, const size_t indexCount)
+	{
+		Clear();
+
+		if ((indexCount < 3) || ((indexCount % 3) != 0) || (indexCount / 3 >= static_cast<size_t>(std::numeric_limits<uint32_t>::max())))
+		{
+			LEVIATHAN_LOG("Failed to build triangle BVH. Index count %zu is not a non zero multiple of 3.", indexCount);
+			return false;
+		}
+
+		for (size_t i = 0; i < indexCount; ++i)
+		{
+			if (indices[i] >= positionCount)
+			{
+				LEVIATHAN_LOG("Failed to build triangle BVH. Index %u is out of range.", indices[i]);
+				return false;
+			}
+		}
+
+		const size_t triangleCount = indexCount / 3;
+		const auto vertex = [positions, indices](const size_t triangle, const size_t corner) -> const float*
+			{
+				return positions[indices[(triangle * 3) + corner]].Data();
+			};
+
+		std::vector<BuildReference> references(triangleCount);
+		LeviathanCore::JobSystem::ParallelFor(triangleCount, ParallelChunkSize, [&references, &vertex](const size_t first, const size_t count, const size_t)
+			{
+				for (size_t i = first; i < first + count; ++i)
+				{
+					BuildReference& reference = references[i];
+					reference.Triangle = static_cast<uint32_t>(i);
+					for (size_t corner = 0; corner < 3; ++corner)
+					{
+						const float* const position = vertex(i, corner);
+						reference.Box.Grow(std::array<float, 3>{ position[0], position[1], position[2] });
+					}
+				}
+			});
+
+		std::vector<BuildNode> binaryNodes = {};
+		BuildBinaryTree(references, binaryNodes);
+
+		Nodes.reserve(binaryNodes.size() / 2);
+		CollapseNode(binaryNodes, 0, 1, Nodes, Depth);
+
+		// Store triangles in leaf order so that leaves reference contiguous ranges.
+		Triangles.resize(triangleCount);
+		LeviathanCore::JobSystem::ParallelFor(triangleCount, ParallelChunkSize, [this, &references, &vertex](const size_t first, const size_t count, const size_t)
+			{
+				for (size_t i = first; i < first + count; ++i)
+				{
+					const uint32_t index = references[i].Triangle;
+					const float* const v0 = vertex(index, 0);
+					const float* const v1 = vertex(index, 1);
+					const float* const v2 = vertex(index, 2);
+
+					Triangle& triangle = Triangles[i];
+					triangle.Index = index;
+					for (size_t axis = 0; axis < 3; ++axis)
+					{
+						triangle.Vertex0[axis] = v0[axis];
+						triangle.Edge1[axis] = v1[axis] - v0[axis];
+						triangle.Edge2[axis] = v2[axis] - v0[axis];
+					}
+				}
+			});
+
+		const BuildBox& rootBox = binaryNodes[0].Box;
+		Bounds = LeviathanCore::BoundingVolumes::AABB{ LeviathanCore::MathTypes::Vector3(rootBox.Min[0], rootBox.Min[1], rootBox.Min[2]),
+			LeviathanCore::MathTypes::Vector3(rootBox.Max[0], rootBox.Max[1], rootBox.Max[2]) };
+
+		return true;
+	}
+
+	void TriangleBVH::Clear()
+	{
+		Nodes.clear();
+		Triangles.clear();
+		Bounds = {};
+		Depth = 0;
+	}
+
+	bool TriangleBVH::Intersect(const LeviathanCore::BoundingVolumes::Ray& ray, const float maxDistance, Hit& outHit) const
+	{
+		return Traverse<false>(ray, maxDistance, outHit);
+	}
+
+	bool TriangleBVH::IntersectAny(const LeviathanCore::BoundingVolumes::Ray& ray, const float maxDistance) const
+	{
+		Hit hit = {};
+		return Traverse<true>(ray, maxDistance, hit);
+	}
+
+	void TriangleBVH::IntersectPacket(const LeviathanCore::BoundingVolumes::Ray* const rays, const size_t rayCount, const float maxDistance, Hit* const outHits) const
+	{
+		std::array<Hit, PacketSize> hits = {};
+		for (size_t first = 0; first < rayCount; first += PacketSize)
+		{
+			const size_t count = std::min(PacketSize, rayCount - first);
+			TraversePacket<false>(rays + first, count, maxDistance, hits);
+			std::copy(hits.begin(), hits.begin() + count, outHits + first);
+		}
+	}
+
+	void TriangleBVH::IntersectAnyPacket(const LeviathanCore::BoundingVolumes::Ray* const rays, const size_t rayCount, const float maxDistance, uint8_t* const outResults) const
+	{
+		std::array<Hit, PacketSize> hits = {};
+		for (size_t first = 0; first < rayCount; first += PacketSize)
+		{
+			const size_t count = std::min(PacketSize, rayCount - first);
+			TraversePacket<true>(rays + first, count, maxDistance, hits);
+			for (size_t i = 0; i < count; ++i)
+			{
+				outResults[first + i] = (hits[i].TriangleIndex != InvalidTriangleIndex) ? 1 : 0;
+			}
+		}
+	}
+
+	template <bool AnyHit>
+	bool TriangleBVH::Traverse(const LeviathanCore::BoundingVolumes::Ray& ray, const float maxDistance, Hit& outHit) const
+	{
+		outHit = {};
+		if (Nodes.empty())
+		{
+			return false;
+		}
+
+		const TraversalRay traversalRay(ray);
+		float closestDistance = maxDistance;
+		bool hit = false;
+
+		std::array<TraversalStackEntry, TraversalStackSize> stack;
+		size_t stackCount = 0;
+		stack[stackCount++] = { 0, 0.0f };
+
+		while (stackCount > 0)
+		{
+			const TraversalStackEntry entry = stack[--stackCount];
+			if (entry.Distance > closestDistance)
+			{
+				continue;
+			}
+
+			const Node& node = Nodes[entry.Node];
+			std::array<float, NodeWidth> distances = {};
+			uint32_t hitMask = IntersectChildren(node, traversalRay, closestDistance, distances);
+
+			std::array<TraversalStackEntry, NodeWidth> internalChildren;
+			size_t internalCount = 0;
+			while (hitMask != 0)
+			{
+				const size_t child = static_cast<size_t>(std::countr_zero(hitMask));
+				hitMask &= hitMask - 1;
+
+				if (node.TriangleCounts[child] == 0)
+				{
+					internalChildren[internalCount++] = { node.Children[child], distances[child] };
+					continue;
+				}
+
+				const uint32_t firstTriangle = node.Children[child];
+				for (uint32_t i = firstTriangle; i < firstTriangle + node.TriangleCounts[child]; ++i)
+				{
+					float distance = 0.0f;
+					float u = 0.0f;
+					float v = 0.0f;
+					if (IntersectTriangle(Triangles[i], traversalRay, closestDistance, distance, u, v))
+					{
+						hit = true;
+						closestDistance = distance;
+						outHit = { distance, u, v, Triangles[i].Index };
+						if constexpr (AnyHit)
+						{
+							return true;
+						}
+					}
+				}
+			}
+
+			PushFarToNear(internalChildren, internalCount, stack, stackCount);
+		}
+
+		return hit;
+	}
+
+	template <bool AnyHit>
+	void TriangleBVH::TraversePacket(const LeviathanCore::BoundingVolumes::Ray* const rays, const size_t rayCount, const float maxDistance,
+		std::array<Hit, PacketSize>& outHits) const
+	{
+		outHits.fill(Hit{});
+		if (Nodes.empty())
+		{
+			return;
+		}
+
+#ifdef LEVIATHAN_SIMD_SSE
+		static_assert(PacketSize == 4, "SSE packet traversal requires 4 rays per packet.");
+
+		// Rays in structure of arrays layout. Unused lanes repeat the first ray with a negative max distance so that they never hit.
+		std::array<std::array<float, PacketSize>, 3> origins = {};
+		std::array<std::array<float, PacketSize>, 3> directions = {};
+		std::array<std::array<float, PacketSize>, 3> inverseDirections = {};
+		std::array<float, PacketSize> maxDistances = {};
+		for (size_t lane = 0; lane < PacketSize; ++lane)
+		{
+			const TraversalRay ray(rays[(lane < rayCount) ? lane : 0]);
+			for (size_t axis = 0; axis < 3; ++axis)
+			{
+				origins[axis][lane] = ray.Origin[axis];
+				directions[axis][lane] = ray.Direction[axis];
+				inverseDirections[axis][lane] = ray.InverseDirection[axis];
+			}
+			maxDistances[lane] = (lane < rayCount) ? maxDistance : -1.0f;
+		}
+
+		__m128 origin[3] = {};
+		__m128 direction[3] = {};
+		__m128 inverseDirection[3] = {};
+		for (size_t axis = 0; axis < 3; ++axis)
+		{
+			origin[axis] = _mm_loadu_ps(origins[axis].data());
+			direction[axis] = _mm_loadu_ps(directions[axis].data());
+			inverseDirection[axis] = _mm_loadu_ps(inverseDirections[axis].data());
+		}
+
+		// Closest distance of every lane. Lanes that are finished have a negative distance.
+		__m128 closest = _mm_loadu_ps(maxDistances.data());
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+
+		std::array<TraversalStackEntry, TraversalStackSize> stack;
+		size_t stackCount = 0;
+		stack[stackCount++] = { 0, 0.0f };
+
+		while (stackCount > 0)
+		{
+			const TraversalStackEntry entry = stack[--stackCount];
+
+			// Skip the node if it is beyond the closest hit of every lane.
+			std::array<float, PacketSize> closestDistances = {};
+			_mm_storeu_ps(closestDistances.data(), closest);
+			if (entry.Distance > *std::max_element(closestDistances.begin(), closestDistances.end()))
+			{
+				continue;
+			}
+
+			const Node& node = Nodes[entry.Node];
+			std::array<TraversalStackEntry, NodeWidth> internalChildren;
+			size_t internalCount = 0;
+			for (size_t child = 0; child < NodeWidth; ++child)
+			{
+				if (node.Children[child] == EmptyChild)
+				{
+					break;
+				}
+
+				// Slab test of the child box against every lane.
+				__m128 nearDistances = zero;
+				__m128 farDistances = closest;
+				for (size_t axis = 0; axis < 3; ++axis)
+				{
+					const __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.ChildBounds[axis][child]), origin[axis]), inverseDirection[axis]);
+					const __m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.ChildBounds[axis + 3][child]), origin[axis]), inverseDirection[axis]);
+					nearDistances = _mm_max_ps(nearDistances, _mm_min_ps(t1, t2));
+					farDistances = _mm_min_ps(farDistances, _mm_max_ps(t1, t2));
+				}
+				const __m128 hitLanes = _mm_cmple_ps(nearDistances, farDistances);
+				if (_mm_movemask_ps(hitLanes) == 0)
+				{
+					continue;
+				}
+
+				if (node.TriangleCounts[child] == 0)
+				{
+					// Order children by the nearest entry distance of the lanes that hit them.
+					std::array<float, PacketSize> entryDistances = {};
+					_mm_storeu_ps(entryDistances.data(), _mm_or_ps(_mm_and_ps(hitLanes, nearDistances), _mm_andnot_ps(hitLanes, _mm_set1_ps(std::numeric_limits<float>::max()))));
+					internalChildren[internalCount++] = { node.Children[child], *std::min_element(entryDistances.begin(), entryDistances.end()) };
+					continue;
+				}
+
+				const uint32_t firstTriangle = node.Children[child];
+				for (uint32_t i = firstTriangle; i < firstTriangle + node.TriangleCounts[child]; ++i)
+				{
+					// Moller-Trumbore for every lane.
+					const Triangle& triangle = Triangles[i];
+					const __m128 e1x = _mm_set1_ps(triangle.Edge1[0]);
+					const __m128 e1y = _mm_set1_ps(triangle.Edge1[1]);
+					const __m128 e1z = _mm_set1_ps(triangle.Edge1[2]);
+					const __m128 e2x = _mm_set1_ps(triangle.Edge2[0]);
+					const __m128 e2y = _mm_set1_ps(triangle.Edge2[1]);
+					const __m128 e2z = _mm_set1_ps(triangle.Edge2[2]);
+
+					const __m128 px = _mm_sub_ps(_mm_mul_ps(direction[1], e2z), _mm_mul_ps(direction[2], e2y));
+					const __m128 py = _mm_sub_ps(_mm_mul_ps(direction[2], e2x), _mm_mul_ps(direction[0], e2z));
+					const __m128 pz = _mm_sub_ps(_mm_mul_ps(direction[0], e2y), _mm_mul_ps(direction[1], e2x));
+					const __m128 determinant = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+					const __m128 inverseDeterminant = _mm_div_ps(one, determinant);
+
+					const __m128 tx = _mm_sub_ps(origin[0], _mm_set1_ps(triangle.Vertex0[0]));
+					const __m128 ty = _mm_sub_ps(origin[1], _mm_set1_ps(triangle.Vertex0[1]));
+					const __m128 tz = _mm_sub_ps(origin[2], _mm_set1_ps(triangle.Vertex0[2]));
+					const __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, px), _mm_mul_ps(ty, py)), _mm_mul_ps(tz, pz)), inverseDeterminant);
+
+					const __m128 qx = _mm_sub_ps(_mm_mul_ps(ty, e1z), _mm_mul_ps(tz, e1y));
+					const __m128 qy = _mm_sub_ps(_mm_mul_ps(tz, e1x), _mm_mul_ps(tx, e1z));
+					const __m128 qz = _mm_sub_ps(_mm_mul_ps(tx, e1y), _mm_mul_ps(ty, e1x));
+					const __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(direction[0], qx), _mm_mul_ps(direction[1], qy)), _mm_mul_ps(direction[2], qz)),
+						inverseDeterminant);
+					const __m128 distance = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), inverseDeterminant);
+
+					__m128 valid = _mm_cmpneq_ps(determinant, zero);
+					valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmple_ps(u, one)));
+					valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpge_ps(v, zero), _mm_cmple_ps(_mm_add_ps(u, v), one)));
+					valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpge_ps(distance, zero), _mm_cmple_ps(distance, closest)));
+
+					uint32_t validMask = static_cast<uint32_t>(_mm_movemask_ps(valid));
+					if (validMask == 0)
+					{
+						continue;
+					}
+
+					std::array<float, PacketSize> distances = {};
+					std::array<float, PacketSize> us = {};
+					std::array<float, PacketSize> vs = {};
+					_mm_storeu_ps(distances.data(), distance);
+					_mm_storeu_ps(us.data(), u);
+					_mm_storeu_ps(vs.data(), v);
+					while (validMask != 0)
+					{
+						const size_t lane = static_cast<size_t>(std::countr_zero(validMask));
+						validMask &= validMask - 1;
+						outHits[lane] = { distances[lane], us[lane], vs[lane], triangle.Index };
+					}
+
+					if constexpr (AnyHit)
+					{
+						// Lanes that hit are finished.
+						closest = _mm_or_ps(_mm_and_ps(valid, _mm_set1_ps(-1.0f)), _mm_andnot_ps(valid, closest));
+						if (_mm_movemask_ps(_mm_cmpge_ps(closest, zero)) == 0)
+						{
+							return;
+						}
+					}
+					else
+					{
+						closest = _mm_or_ps(_mm_and_ps(valid, distance), _mm_andnot_ps(valid, closest));
+					}
+				}
+			}
+
+			PushFarToNear(internalChildren, internalCount, stack, stackCount);
+		}
+#else
+		for (size_t lane = 0; lane < rayCount; ++lane)
+		{
+			Traverse<AnyHit>(rays[lane], maxDistance, outHits[lane]);
+		}
+#endif // LEVIATHAN_SIMD_SSE.
+	}
+}
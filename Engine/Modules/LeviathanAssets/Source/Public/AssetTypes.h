@@ -1,6 +1,7 @@
 #pragma once
 
 #include "MathTypes.h"
+#include "BoundingVolumes.h"
 
 namespace LeviathanAssets
 {
@@ -13,6 +14,15 @@ namespace LeviathanAssets
 			std::vector<LeviathanCore::MathTypes::Vector2> TextureCoordinates = {};
 			std::vector<LeviathanCore::MathTypes::Vector3> Tangents = {};
 			std::vector<uint32_t> Indices = {};
+			LeviathanCore::BoundingVolumes::AABB Bounds = {};
+			LeviathanCore::BoundingVolumes::Sphere BoundingSphere = {};
+
+			// Recalculates Bounds and BoundingSphere from Positions. Must be called after Positions is modified.
+			void CalculateBounds();
+
+			// Returns the average texture coordinate units per object space unit over the mesh's triangles, the square root of the ratio of their total
+			// texture coordinate area to their total area. Returns 0 if the mesh has no texture coordinates or no area.
+			float CalculateTextureCoordinateDensity() const;
 		};
 
 		struct Texture
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "Serialize.h"
+#include "Simd.h"
+
+namespace LeviathanAssets
+{
+	namespace AssetTypes
+	{
+		struct HDRTexture;
+	}
+
+	// Conversion of equirectangular HDR environment textures, e.g. as loaded by TextureImporter::LoadHDRTexture, to cubemaps on the cpu and cubemap
+	// files caching the result. Faces are in the order +X, -X, +Y, -Y, +Z, -Z with rows from the top, as expected by
+	// LeviathanRenderer::TextureCubeDescription. Texels are rgba with alpha 1. Cubemap files also hold mip chains and data derived from the cubemap,
+	// e.g. baked image based lighting.
+	namespace EnvironmentCubemap
+	{
+		static constexpr LeviathanCore::Serialize::FileTag FileTag = { .Magic = 0x4255434c, .Version = 3 }; // "LCUB".
+		static constexpr uint32_t FaceCount = 6;
+		static constexpr uint32_t ChannelCount = 4;
+		static constexpr uint32_t MaxFaceSize = 16384;
+		// Samples per face texel along each axis of box filtered conversions.
+		static constexpr uint32_t MaxSupersampleCount = 8;
+
+		enum class Precision : uint8_t
+		{
+			Float32,
+			// Half floats with a 10 bit mantissa, halving memory. Values beyond 65504 are clamped.
+			Float16
+		};
+
+		enum class Filter : uint8_t
+		{
+			// A single bilinear sample of the equirectangular texture at the direction through the texel center. Aliases when the faces are smaller
+			// than a quarter of the equirectangular texture's width.
+			Bilinear,
+			// Average of a grid of bilinear samples spread over the texel with as many samples along each axis as equirectangular texels fall on a face
+			// texel at the horizon, up to MaxSupersampleCount.
+			Box
+		};
+
+		struct Settings
+		{
+			uint32_t FaceSize = 512;
+			Precision FacePrecision = Precision::Float32;
+			Filter SampleFilter = Filter::Box;
+		};
+
+		struct Header
+		{
+			uint32_t FaceSize = 0;
+			// Mips of the faces, each half the size of the previous. Converted cubemaps have a single mip.
+			uint32_t MipCount = 1;
+			Precision FacePrecision = Precision::Float32;
+			Filter SampleFilter = Filter::Bilinear;
+			// Stamp of the equirectangular source the file was converted from, compared to the source's current stamp to find stale files.
+			LeviathanCore::Serialize::FileStamp Source = {};
+		};
+
+		uint32_t GetBytesPerTexel(Precision precision);
+
+		// Number of mips in the full chain of faces faceSize texels wide down to 1x1.
+		uint32_t GetMaxMipCount(uint32_t faceSize);
+		uint32_t GetMipFaceSize(uint32_t faceSize, uint32_t mip);
+
+		// Bytes of a face of mip 0.
+		size_t GetFaceSizeBytes(const Header& header);
+
+		// Bytes of the faces of every mip, stored back to back from the largest mip.
+		size_t GetFaceDataSizeBytes(const Header& header);
+
+		// Number of samples along each axis of a face texel converted from an equirectangular texture sourceWidth texels wide.
+		uint32_t GetSupersampleCount(uint32_t sourceWidth, uint32_t faceSize, Filter filter);
+
+		// Unnormalized direction through the point (s, t) of a face, where s and t are in [-1, 1] from the left and top of the face.
+		void GetFaceDirection(uint32_t face, float s, float t, float& outX, float& outY, float& outZ);
+
+		// Face and point (s, t) in [-1, 1] the direction passes through. Inverse of GetFaceDirection. The direction must not be 0.
+		void GetFaceCoordinates(float x, float y, float z, uint32_t& outFace, float& outS, float& outT);
+
+		// Solid angle in steradians of texel (x, y) of a face faceSize texels wide. The texels of the six faces sum to 4 Pi.
+		float GetTexelSolidAngle(uint32_t faceSize, uint32_t x, uint32_t y);
+
+		// Adds weight times the bilinear blend of texels x0 and x1 of two rows of rgba float texels to the rgba sum, four channels at once with SSE when
+		// available. fractionX and fractionY are the weights of texel x1 and of row1. Shared by cubemap conversion and image based lighting bakes.
+		inline void AccumulateBilinearSample(const float* const row0, const float* const row1, const size_t x0, const size_t x1, const float fractionX,
+			const float fractionY, const float weight, float* const sum)
+		{
+			const float w00 = (1.0f - fractionX) * (1.0f - fractionY) * weight;
+			const float w10 = fractionX * (1.0f - fractionY) * weight;
+			const float w01 = (1.0f - fractionX) * fractionY * weight;
+			const float w11 = fractionX * fractionY * weight;
+
+#ifdef LEVIATHAN_SIMD_SSE
+			const __m128 top = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(row0 + (x0 * ChannelCount)), _mm_set1_ps(w00)),
+				_mm_mul_ps(_mm_loadu_ps(row0 + (x1 * ChannelCount)), _mm_set1_ps(w10)));
+			const __m128 bottom = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(row1 + (x0 * ChannelCount)), _mm_set1_ps(w01)),
+				_mm_mul_ps(_mm_loadu_ps(row1 + (x1 * ChannelCount)), _mm_set1_ps(w11)));
+			_mm_storeu_ps(sum, _mm_add_ps(_mm_loadu_ps(sum), _mm_add_ps(top, bottom)));
+#else
+			for (uint32_t channel = 0; channel < ChannelCount; ++channel)
+			{
+				sum[channel] += (row0[(x0 * ChannelCount) + channel] * w00) + (row0[(x1 * ChannelCount) + channel] * w10) +
+					(row1[(x0 * ChannelCount) + channel] * w01) + (row1[(x1 * ChannelCount) + channel] * w11);
+			}
+#endif // LEVIATHAN_SIMD_SSE.
+		}
+
+		uint16_t FloatToHalf(float value);
+		float HalfToFloat(uint16_t value);
+
+		// Samples the equirectangular texture for every face texel in parallel across faces and rows on the job system. The equirectangular texture
+		// is rgba with rows from the bottom, longitude wrapping horizontally with +X at the center and latitude clamping vertically. The out face data
+		// holds the faces back to back. Returns false if the texture is empty or the face size is 0 or larger than MaxFaceSize.
+		bool Convert(const AssetTypes::HDRTexture& equirectangular, const Settings& settings, Header& outHeader, std::vector<uint8_t>& outFaceData);
+
+		bool Save(std::string_view file, const Header& header, const std::vector<uint8_t>& faceData);
+
+		// Saves extra data after the faces, e.g. the parts of baked lighting that are not faces, which Load returns unchanged.
+		bool Save(std::string_view file, const Header& header, const std::vector<uint8_t>& faceData, const std::vector<uint8_t>& extraData);
+
+		// Returns false if the file does not exist, is from another version or is truncated.
+		bool Load(std::string_view file, Header& outHeader, std::vector<uint8_t>& outFaceData);
+		bool Load(std::string_view file, Header& outHeader, std::vector<uint8_t>& outFaceData, std::vector<uint8_t>& outExtraData);
+
+		// Widens Float16 faces of every mip to Float32 faces, e.g. for baking image based lighting from them. Float32 faces are copied.
+		void ToFloat32(const Header& header, const std::vector<uint8_t>& faceData, std::vector<float>& outFaceData);
+	}
+}
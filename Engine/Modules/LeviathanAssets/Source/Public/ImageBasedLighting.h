@@ -0,0 +1,91 @@
+#pragma once
+
+#include "Serialize.h"
+
+namespace LeviathanAssets
+{
+	// Offline baking of image based lighting from HDR environment cubemaps, e.g. as converted by EnvironmentCubemap, on the cpu. A bake holds the
+	// diffuse irradiance as third order spherical harmonics, a GGX prefiltered specular cubemap with roughness increasing linearly over its mips and
+	// the split sum environment BRDF lookup table. Every stage runs in parallel on the job system. Bakes are saved as environment cubemap files of the
+	// specular mips, with the irradiance, the lookup table and the bake settings stored after the faces.
+	namespace ImageBasedLighting
+	{
+		// Tags the data stored after the specular faces.
+		static constexpr LeviathanCore::Serialize::FileTag FileTag = { .Magic = 0x4c42494c, .Version = 2 }; // "LIBL".
+		static constexpr uint32_t SHCoefficientCount = 9;
+		static constexpr uint32_t MaxSpecularMipCount = 15;
+		static constexpr uint32_t MaxBrdfLutSize = 4096;
+		// Largest source mip projected to spherical harmonics. Larger mips add cost but no accuracy to the low frequency irradiance.
+		static constexpr uint32_t MaxIrradianceSourceFaceSize = 128;
+
+		struct Settings
+		{
+			uint32_t SpecularFaceSize = 256;
+			// Clamped to the mips of the specular face size.
+			uint32_t SpecularMipCount = 6;
+			// GGX importance samples per specular texel. Mip 0 is a mirror reflection and takes a single sample.
+			uint32_t SpecularSampleCount = 256;
+			uint32_t BrdfLutSize = 128;
+			uint32_t BrdfLutSampleCount = 512;
+
+			inline bool operator==(const Settings& other) const
+			{
+				return (SpecularFaceSize == other.SpecularFaceSize) && (SpecularMipCount == other.SpecularMipCount) &&
+					(SpecularSampleCount == other.SpecularSampleCount) && (BrdfLutSize == other.BrdfLutSize) && (BrdfLutSampleCount == other.BrdfLutSampleCount);
+			}
+		};
+
+		// Wall clock time of each bake stage.
+		struct BakeStats
+		{
+			double SourceMipMilliseconds = 0.0;
+			double IrradianceMilliseconds = 0.0;
+			double SpecularMilliseconds = 0.0;
+			double BrdfLutMilliseconds = 0.0;
+			uint32_t SourceMipCount = 0;
+		};
+
+		struct BakedLighting
+		{
+			// Settings the lighting was baked with, compared to the current settings to find stale bakes.
+			Settings BakeSettings = {};
+			// Rgb coefficients of the irradiance divided by Pi, i.e. the diffuse radiance of a white Lambertian surface, in the order of
+			// EvaluateSHBasis.
+			std::array<float, SHCoefficientCount * 3> IrradianceSH = {};
+			uint32_t SpecularFaceSize = 0;
+			uint32_t SpecularMipCount = 0;
+			// Rgba faces in the order +X, -X, +Y, -Y, +Z, -Z with rows from the top, mips back to back from the largest.
+			std::vector<float> SpecularMips = {};
+			uint32_t BrdfLutSize = 0;
+			// Rg scale and bias applied to F0 with N dot V increasing along rows and roughness increasing down columns, sampled at texel centers.
+			std::vector<float> BrdfLut = {};
+		};
+
+		uint32_t GetSpecularMipFaceSize(uint32_t specularFaceSize, uint32_t mip);
+
+		// Offset in floats of a mip in BakedLighting::SpecularMips.
+		size_t GetSpecularMipOffset(uint32_t specularFaceSize, uint32_t mip);
+
+		// Perceptual roughness a mip is prefiltered for, from 0 at mip 0 to 1 at the last mip.
+		float GetSpecularMipRoughness(uint32_t mip, uint32_t mipCount);
+
+		// Real spherical harmonics basis functions of bands 0 to 2 for a normalized direction.
+		void EvaluateSHBasis(float x, float y, float z, std::array<float, SHCoefficientCount>& outBasis);
+
+		// Diffuse radiance from the irradiance coefficients for a normalized surface normal.
+		void EvaluateIrradiance(const BakedLighting& lighting, float x, float y, float z, std::array<float, 3>& outColor);
+
+		// Split sum scale and bias applied to F0 for the Smith GGX specular BRDF with Schlick Fresnel, integrated with sampleCount GGX importance samples.
+		void IntegrateBrdf(float nDotV, float roughness, uint32_t sampleCount, float& outScale, float& outBias);
+
+		// Bakes the rgba environment faces, faceSize texels wide in the order +X, -X, +Y, -Y, +Z, -Z with rows from the top. Returns false if the
+		// faces are empty or a setting is 0 or out of range.
+		bool Bake(const float* faces, uint32_t faceSize, const Settings& settings, BakedLighting& outLighting, BakeStats& outStats);
+
+		// Saves the specular mips as 32 bit float faces.
+		bool Save(std::string_view file, const BakedLighting& lighting);
+
+		// Returns false if the file does not exist, is from another version, is truncated or is an environment cubemap without baked lighting.
+		bool Load(std::string_view file, BakedLighting& outLighting);
+	}
+}
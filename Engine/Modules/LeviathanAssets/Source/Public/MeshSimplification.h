@@ -0,0 +1,59 @@
+#pragma once
+
+namespace LeviathanAssets
+{
+	namespace AssetTypes
+	{
+		struct Mesh;
+	}
+
+	// Quadric error metric mesh simplification for building levels of detail. Edges are collapsed into one of their vertices so that the simplified mesh
+	// reuses the source vertices and their attributes unchanged. The cost of a collapse is the area weighted squared distance to the planes of the
+	// triangles merged into the removed vertex plus the deviation of the normal, texture coordinate and tangent across those triangles.
+	// Vertices are classified by their topology: vertices on open borders only move along the border, vertices on attribute seams, i.e. vertices split
+	// because their attributes differ at the same position, only move along the seam together with their other side so that seams do not crack, and
+	// vertices with more complex topology, e.g. the poles of a uv sphere, never move.
+	namespace MeshSimplification
+	{
+		struct Settings
+		{
+			// Attribute deviation weights relative to the mesh size, e.g. a normal weight of 0.5 costs a change of the normal by 1 the same as a
+			// geometric deviation of half the mesh's largest extent. Attributes missing from the mesh are ignored.
+			float NormalWeight = 0.5f;
+			float TextureCoordinateWeight = 1.0f;
+			float TangentWeight = 0.25f;
+			// Keeps the vertices of open borders in place.
+			bool LockBorders = false;
+		};
+
+		// Simplifies the mesh to at most targetTriangleCount triangles, stopping early when the next collapse would exceed maxError. outError is the
+		// largest error of a performed collapse in object space units. Returns false if the mesh has no triangles or an index is out of range.
+		bool Simplify(const AssetTypes::Mesh& mesh, size_t targetTriangleCount, float maxError, const Settings& settings, AssetTypes::Mesh& outMesh,
+			float& outError);
+
+		struct LODChainSettings
+		{
+			// Number of levels including the source mesh at level 0.
+			uint32_t MaxLevelCount = 6;
+			// Triangle count of every level relative to the previous level. Must be greater than 0 and less than 1.
+			float TriangleRatio = 0.5f;
+			// Levels are not built below this triangle count or above this error in object space units.
+			size_t MinTriangleCount = 32;
+			float MaxError = std::numeric_limits<float>::max();
+			Settings Simplification = {};
+		};
+
+		// Levels from the source mesh at level 0 to the coarsest level. Errors holds the object space error of every level, 0 for level 0, in
+		// ascending order for selecting a level from the projected size of the error.
+		struct LODChain
+		{
+			std::vector<AssetTypes::Mesh> Levels = {};
+			std::vector<float> Errors = {};
+		};
+
+		// Builds the levels of detail of the mesh. Levels are snapshots of a single simplification of the source mesh so that every level is derived
+		// with the quadrics of the source triangles. Building stops early when a level removes less than half of its requested triangles. Returns
+		// false if the mesh has no triangles, an index is out of range or the triangle ratio is out of range.
+		bool BuildLODChain(const AssetTypes::Mesh& mesh, const LODChainSettings& settings, LODChain& outChain);
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "MathTypes.h"
+#include "BoundingVolumes.h"
+
+namespace LeviathanAssets
+{
+	namespace AssetTypes
+	{
+		struct Mesh;
+	}
+
+	// Partitioning of a mesh's triangles into meshlets, small clusters of adjacent triangles referencing few vertices, for culling parts of a mesh
+	// against the view frustum and by facing.
+	// Meshlets are grown greedily one triangle at a time from triangles sharing vertices with the meshlet, preferring triangles that add no vertices,
+	// then triangles near the meshlet's center facing its average direction. Meshlets without unused neighbors continue with a nearby triangle or are
+	// finished early so that their bounds stay tight. A new meshlet starts next to the previous one, so consecutive meshlets and the triangles and
+	// vertices within a meshlet are close in space and in memory.
+	namespace Meshlets
+	{
+		// Defaults matching common mesh shader limits.
+		static constexpr size_t DefaultMaxVertexCount = 64;
+		static constexpr size_t DefaultMaxTriangleCount = 124;
+		// Meshlet vertices are addressed with 8 bit local indices.
+		static constexpr size_t MaxVertexCountLimit = 255;
+
+		struct Settings
+		{
+			// Limits of every meshlet. MaxVertexCount must be in [3, MaxVertexCountLimit] and MaxTriangleCount must not be 0.
+			size_t MaxVertexCount = DefaultMaxVertexCount;
+			size_t MaxTriangleCount = DefaultMaxTriangleCount;
+			// Importance of grouping triangles facing the same direction over grouping nearby triangles, in [0, 1]. Higher weights narrow the normal
+			// cones so that more meshlets are culled as back facing, at the cost of larger bounding spheres.
+			float ConeWeight = 0.25f;
+		};
+
+		struct Meshlet
+		{
+			// Ranges in MeshletMesh::Vertices and in the triangles of MeshletMesh::Triangles and MeshletMesh::Indices.
+			uint32_t VertexOffset = 0;
+			uint32_t VertexCount = 0;
+			uint32_t TriangleOffset = 0;
+			uint32_t TriangleCount = 0;
+			// Object space bounds of the meshlet's vertices.
+			LeviathanCore::BoundingVolumes::Sphere BoundingSphere = {};
+			// Normal cone. Every triangle faces away from a point p when dot(normalize(ConeApex - p), ConeAxis) > ConeCutoff. ConeCutoff is 1 when the
+			// triangles face too many directions for the meshlet to ever be back facing.
+			LeviathanCore::MathTypes::Vector3 ConeApex = {};
+			LeviathanCore::MathTypes::Vector3 ConeAxis = { 0.0f, 0.0f, 1.0f };
+			float ConeCutoff = 1.0f;
+		};
+
+		struct MeshletMesh
+		{
+			std::vector<Meshlet> Meshlets = {};
+			// Source mesh vertex of every meshlet vertex in the order of first use by the meshlet's triangles.
+			std::vector<uint32_t> Vertices = {};
+			// Three meshlet vertex indices per triangle, for consumers fetching vertices per meshlet.
+			std::vector<uint8_t> Triangles = {};
+			// Three source mesh vertex indices per triangle in meshlet order, for drawing meshlets from the source vertex buffer with an index buffer.
+			std::vector<uint32_t> Indices = {};
+		};
+
+		// Partitions every triangle of the mesh into meshlets. Returns false if the mesh has no triangles, an index is out of range or the settings are
+		// out of range.
+		bool BuildMeshlets(const AssetTypes::Mesh& mesh, const Settings& settings, MeshletMesh& outMeshlets);
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Serialize.h"
+
+namespace LeviathanAssets
+{
+	namespace AssetTypes
+	{
+		struct Texture;
+	}
+
+	// Mip addressable texture files for streaming. A file holds a header, a table of every mip's dimensions and byte range and the mips from the
+	// finest to the coarsest, so any range of consecutive mips is read with a single read without loading the rest of the texture.
+	namespace StreamableTexture
+	{
+		static constexpr LeviathanCore::Serialize::FileTag FileTag = { .Magic = 0x5854534c, .Version = 2 }; // "LSTX".
+		// Mip chains of textures up to 32768 texels wide.
+		static constexpr uint32_t MaxMipCount = 16;
+		// Mips are 8 bit rgba.
+		static constexpr uint32_t BytesPerPixel = 4;
+
+		struct MipLevel
+		{
+			uint32_t Width = 0;
+			uint32_t Height = 0;
+			// Byte range of the mip from the start of the mip data.
+			uint64_t Offset = 0;
+			uint64_t SizeBytes = 0;
+		};
+
+		struct Header
+		{
+			uint32_t Width = 0;
+			uint32_t Height = 0;
+			uint32_t MipCount = 0;
+			bool sRGB = false;
+			// Offset of the mip data from the start of the file.
+			uint64_t DataOffset = 0;
+			std::array<MipLevel, MaxMipCount> Mips = {};
+			// Stamp of the source image the file was cooked from, compared to the source's current stamp to find stale files.
+			LeviathanCore::Serialize::FileStamp Source = {};
+		};
+
+		// Number of mips in the full chain of a texture down to 1x1.
+		uint32_t GetMipCount(uint32_t width, uint32_t height);
+
+		// Builds the full mip chain of an 8 bit rgba texture, e.g. as loaded by TextureImporter::LoadTexture. Each mip is a 2x2 box filter of the previous
+		// mip. Mips of odd sizes are rounded down, ignoring the last row or column of the previous mip. Colors of sRGB textures are filtered in linear
+		// space. Returns false if the texture is empty or too large.
+		bool BuildMipChain(const AssetTypes::Texture& texture, bool sRGB, Header& outHeader, std::vector<uint8_t>& outMipData);
+
+		bool Save(std::string_view file, const Header& header, const std::vector<uint8_t>& mipData);
+
+		// Reads the header and mip table. Returns false if the file does not exist, is from another version or its mip table is inconsistent.
+		bool LoadHeader(std::string_view file, Header& outHeader);
+
+		// Reads mips [firstMip, firstMip + mipCount) back to back into the out buffer.
+		bool ReadMips(std::string_view file, const Header& header, uint32_t firstMip, uint32_t mipCount, std::vector<uint8_t>& outMipData);
+	}
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "MathTypes.h"
+#include "BoundingVolumes.h"
+
+namespace LeviathanAssets
+{
+	namespace AssetTypes
+	{
+		struct Mesh;
+	}
+
+	// Static bounding volume hierarchy over the triangles of a mesh for ray queries such as picking, line of sight and baking. Built top down with binned
+	// surface area heuristic splits on the job system and collapsed to 4 wide nodes so that a ray is tested against every child of a node at once.
+	// Packet queries trace 4 rays together through the tree and are faster than single ray queries when the rays are coherent.
+	class TriangleBVH
+	{
+	public:
+		static constexpr uint32_t InvalidTriangleIndex = std::numeric_limits<uint32_t>::max();
+		static constexpr size_t NodeWidth = 4;
+		static constexpr size_t PacketSize = 4;
+		static constexpr uint32_t EmptyChild = std::numeric_limits<uint32_t>::max();
+
+		struct Hit
+		{
+			// Distance along the ray in multiples of the ray direction length.
+			float Distance = 0.0f;
+			// Barycentric coordinates of the hit point relative to the second and third vertex of the triangle.
+			float U = 0.0f;
+			float V = 0.0f;
+			// Index of the triangle in the source mesh, i.e. the hit triangle's vertices are Indices[TriangleIndex * 3 + 0..2].
+			uint32_t TriangleIndex = InvalidTriangleIndex;
+		};
+
+		// Node and triangle layouts are public for the build and traversal helpers and for debug visualization.
+		struct alignas(64) Node
+		{
+			// Child box planes in structure of arrays layout: minimum x, y, z followed by maximum x, y, z of every child. Unused children have
+			// inverted boxes.
+			std::array<std::array<float, NodeWidth>, 6> ChildBounds = {};
+			// Node index of internal children, the first triangle of leaf children or EmptyChild for unused children.
+			std::array<uint32_t, NodeWidth> Children = {};
+			// Triangle count of leaf children, 0 for internal and unused children.
+			std::array<uint32_t, NodeWidth> TriangleCounts = {};
+		};
+
+		// Triangle in leaf order with the edges precalculated for the intersection test.
+		struct Triangle
+		{
+			std::array<float, 3> Vertex0 = {};
+			std::array<float, 3> Edge1 = {};
+			std::array<float, 3> Edge2 = {};
+			uint32_t Index = 0;
+		};
+
+	private:
+		std::vector<Node> Nodes = {};
+		std::vector<Triangle> Triangles = {};
+		LeviathanCore::BoundingVolumes::AABB Bounds = {};
+		size_t Depth = 0;
+
+	public:
+		// Builds the hierarchy over the triangles of the mesh. Returns false if the mesh has no triangles or an index is out of range.
+		bool Build(const AssetTypes::Mesh& mesh);
+		bool Build(const LeviathanCore::MathTypes::Vector3* const positions, const size_t positionCount, const uint32_t* const indices, const size_t indexCount);
+		void Clear();
+
+		// Finds the closest triangle hit by the ray within [0, maxDistance]. Returns false if no triangle is hit. Triangles are hit from both sides.
+		bool Intersect(const LeviathanCore::BoundingVolumes::Ray& ray, const float maxDistance, Hit& outHit) const;
+
+		// Returns true if any triangle is hit by the ray within [0, maxDistance]. Cheaper than Intersect as traversal stops at the first hit.
+		bool IntersectAny(const LeviathanCore::BoundingVolumes::Ray& ray, const float maxDistance) const;
+
+		// Finds the closest hit of every ray. Rays are traced in packets of PacketSize consecutive rays. outHits[i].TriangleIndex is InvalidTriangleIndex if
+		// ray i hits nothing.
+		void IntersectPacket(const LeviathanCore::BoundingVolumes::Ray* const rays, const size_t rayCount, const float maxDistance, Hit* const outHits) const;
+
+		// Writes 1 to outResults[i] if ray i hits any triangle otherwise, 0. Rays are traced in packets of PacketSize consecutive rays.
+		void IntersectAnyPacket(const LeviathanCore::BoundingVolumes::Ray* const rays, const size_t rayCount, const float maxDistance, uint8_t* const outResults) const;
+
+		inline bool IsEmpty() const { return Nodes.empty(); }
+		inline size_t GetNodeCount() const { return Nodes.size(); }
+		inline size_t GetTriangleCount() const { return Triangles.size(); }
+		inline size_t GetDepth() const { return Depth; }
+		inline const LeviathanCore::BoundingVolumes::AABB& GetBounds() const { return Bounds; }
+
+	private:
+		template <bool AnyHit>
+		bool Traverse(const LeviathanCore::BoundingVolumes::Ray& ray, const float maxDistance, Hit& outHit) const;
+
+		// Traces up to PacketSize rays together. Lanes past rayCount are unused.
+		template <bool AnyHit>
+		void TraversePacket(const LeviathanCore::BoundingVolumes::Ray* const rays, const size_t rayCount, const float maxDistance,
+			std::array<Hit, PacketSize>& outHits) const;
+	};
+}
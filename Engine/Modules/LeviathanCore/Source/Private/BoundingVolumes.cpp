@@ -0,0 +1,855 @@
+#include "BoundingVolumes.h"
+#include "Simd.h"
+#include "LeviathanAssert.h"
+
+namespace LeviathanCore
+{
+	namespace BoundingVolumes
+	{
+		// Returns the element at row, column of a column major matrix.
+		static inline float MatrixElement(const MathTypes::Matrix4x4& matrix, const size_t row, const size_t column)
+		{
+			return matrix.Data()[column * 4 + row];
+		}
+
+		static inline MathTypes::Vector3 TransformPoint(const MathTypes::Matrix4x4& matrix, const MathTypes::Vector3& point)
+		{
+			const float* m = matrix.Data();
+			return MathTypes::Vector3(m[0] * point.X() + m[4] * point.Y() + m[8] * point.Z() + m[12],
+				m[1] * point.X() + m[5] * point.Y() + m[9] * point.Z() + m[13],
+				m[2] * point.X() + m[6] * point.Y() + m[10] * point.Z() + m[14]);
+		}
+
+		// Returns the signed distance of the point to the plane in the same operation order as the batched tests.
+		static inline float PlaneDistance(const Plane& plane, const float x, const float y, const float z)
+		{
+			return ((plane.Normal.X() * x + plane.Normal.Y() * y) + plane.Normal.Z() * z) + plane.Distance;
+		}
+
+		static inline bool FrustumSphereTest(const Frustum& frustum, const float x, const float y, const float z, const float radius)
+		{
+			for (const Plane& plane : frustum.Planes)
+			{
+				if (PlaneDistance(plane, x, y, z) < -radius)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		static inline bool FrustumAABBTest(const Frustum& frustum, const float minX, const float minY, const float minZ, const float maxX, const float maxY, const float maxZ)
+		{
+			for (const Plane& plane : frustum.Planes)
+			{
+				// Test the corner furthest along the plane normal. If it is outside, the whole box is outside.
+				const float x = (plane.Normal.X() >= 0.0f) ? maxX : minX;
+				const float y = (plane.Normal.Y() >= 0.0f) ? maxY : minY;
+				const float z = (plane.Normal.Z() >= 0.0f) ? maxZ : minZ;
+				if (PlaneDistance(plane, x, y, z) < 0.0f)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		static inline bool AABBOverlapTest(const AABB& query, const float minX, const float minY, const float minZ, const float maxX, const float maxY, const float maxZ)
+		{
+			return (minX <= query.Max.X()) && (maxX >= query.Min.X()) &&
+				(minY <= query.Max.Y()) && (maxY >= query.Min.Y()) &&
+				(minZ <= query.Max.Z()) && (maxZ >= query.Min.Z());
+		}
+
+		// Returns whether the sphere overlaps the box in the same operation order as the batched tests.
+		static inline bool AABBSphereTest(const AABB& query, const float x, const float y, const float z, const float radius)
+		{
+			const float outsideX = std::max(std::max(query.Min.X() - x, x - query.Max.X()), 0.0f);
+			const float outsideY = std::max(std::max(query.Min.Y() - y, y - query.Max.Y()), 0.0f);
+			const float outsideZ = std::max(std::max(query.Min.Z() - z, z - query.Max.Z()), 0.0f);
+			return ((outsideX * outsideX + outsideY * outsideY) + outsideZ * outsideZ) <= (radius * radius);
+		}
+
+		// Returns whether the sphere overlaps the cone in the same operation order as the batched tests. cosine and sine are of the cone's angle.
+		static inline bool ConeSphereTest(const Cone& cone, const float cosine, const float sine, const float x, const float y, const float z, const float radius)
+		{
+			const float offsetX = x - cone.Apex.X();
+			const float offsetY = y - cone.Apex.Y();
+			const float offsetZ = z - cone.Apex.Z();
+			const float squaredLength = (offsetX * offsetX + offsetY * offsetY) + offsetZ * offsetZ;
+			const float axial = (offsetX * cone.Direction.X() + offsetY * cone.Direction.Y()) + offsetZ * cone.Direction.Z();
+			const float reach = cone.Range + radius;
+
+			// Distance from the center to the cone's surface, negative inside the cone.
+			const float surfaceDistance = cosine * std::sqrt(std::max(squaredLength - axial * axial, 0.0f)) - axial * sine;
+			return (squaredLength <= reach * reach) && (axial >= -radius) && (surfaceDistance <= radius);
+		}
+
+		// Returns whether the box's bounding sphere overlaps the cone in the same operation order as the batched tests.
+		static inline bool ConeAABBTest(const Cone& cone, const float cosine, const float sine, const float minX, const float minY, const float minZ, const float maxX,
+			const float maxY, const float maxZ)
+		{
+			const float halfX = (maxX - minX) * 0.5f;
+			const float halfY = (maxY - minY) * 0.5f;
+			const float halfZ = (maxZ - minZ) * 0.5f;
+			return ConeSphereTest(cone, cosine, sine, (minX + maxX) * 0.5f, (minY + maxY) * 0.5f, (minZ + maxZ) * 0.5f,
+				std::sqrt((halfX * halfX + halfY * halfY) + halfZ * halfZ));
+		}
+
+		// Slab test. inverseDirection components may be infinite for axis parallel rays.
+		static inline bool RayAABBTest(const float* origin, const float* inverseDirection, const float maxDistance, const float* min, const float* max, float& outDistance)
+		{
+			float nearDistance = 0.0f;
+			float farDistance = maxDistance;
+			for (size_t axis = 0; axis < 3; ++axis)
+			{
+				const float t1 = (min[axis] - origin[axis]) * inverseDirection[axis];
+				const float t2 = (max[axis] - origin[axis]) * inverseDirection[axis];
+				nearDistance = std::max(nearDistance, std::min(t1, t2));
+				farDistance = std::min(farDistance, std::max(t1, t2));
+			}
+			outDistance = nearDistance;
+			return nearDistance <= farDistance;
+		}
+
+		AABB AABB::FromPoints(const MathTypes::Vector3* const points, const size_t count)
+		{
+			if (count == 0)
+			{
+				return AABB{};
+			}
+
+			float min[3] = { points[0].X(), points[0].Y(), points[0].Z() };
+			float max[3] = { points[0].X(), points[0].Y(), points[0].Z() };
+			for (size_t i = 1; i < count; ++i)
+			{
+				const float* point = points[i].Data();
+				for (size_t axis = 0; axis < 3; ++axis)
+				{
+					min[axis] = std::min(min[axis], point[axis]);
+					max[axis] = std::max(max[axis], point[axis]);
+				}
+			}
+
+			return AABB{ MathTypes::Vector3(min[0], min[1], min[2]), MathTypes::Vector3(max[0], max[1], max[2]) };
+		}
+
+		AABB AABB::Merge(const AABB& a, const AABB& b)
+		{
+			return AABB{ MathTypes::Vector3(std::min(a.Min.X(), b.Min.X()), std::min(a.Min.Y(), b.Min.Y()), std::min(a.Min.Z(), b.Min.Z())),
+				MathTypes::Vector3(std::max(a.Max.X(), b.Max.X()), std::max(a.Max.Y(), b.Max.Y()), std::max(a.Max.Z(), b.Max.Z())) };
+		}
+
+		MathTypes::Vector3 AABB::Center() const
+		{
+			return (Min + Max) * 0.5f;
+		}
+
+		MathTypes::Vector3 AABB::HalfExtents() const
+		{
+			return (Max - Min) * 0.5f;
+		}
+
+		float AABB::SurfaceArea() const
+		{
+			const MathTypes::Vector3 size = Max - Min;
+			return 2.0f * ((size.X() * size.Y()) + (size.Y() * size.Z()) + (size.Z() * size.X()));
+		}
+
+		AABB AABB::Transformed(const MathTypes::Matrix4x4& transform) const
+		{
+			// Arvo's method. Each output extent is the translation plus the sum of the smaller and larger products of every input extent.
+			float min[3] = {};
+			float max[3] = {};
+			for (size_t row = 0; row < 3; ++row)
+			{
+				min[row] = MatrixElement(transform, row, 3);
+				max[row] = MatrixElement(transform, row, 3);
+				for (size_t column = 0; column < 3; ++column)
+				{
+					const float element = MatrixElement(transform, row, column);
+					const float a = element * Min.Data()[column];
+					const float b = element * Max.Data()[column];
+					min[row] += std::min(a, b);
+					max[row] += std::max(a, b);
+				}
+			}
+
+			return AABB{ MathTypes::Vector3(min[0], min[1], min[2]), MathTypes::Vector3(max[0], max[1], max[2]) };
+		}
+
+		bool AABB::Contains(const MathTypes::Vector3& point) const
+		{
+			return (point.X() >= Min.X()) && (point.X() <= Max.X()) &&
+				(point.Y() >= Min.Y()) && (point.Y() <= Max.Y()) &&
+				(point.Z() >= Min.Z()) && (point.Z() <= Max.Z());
+		}
+
+		bool AABB::Contains(const AABB& other) const
+		{
+			return (other.Min.X() >= Min.X()) && (other.Max.X() <= Max.X()) &&
+				(other.Min.Y() >= Min.Y()) && (other.Max.Y() <= Max.Y()) &&
+				(other.Min.Z() >= Min.Z()) && (other.Max.Z() <= Max.Z());
+		}
+
+		bool AABB::Intersects(const AABB& other) const
+		{
+			return AABBOverlapTest(*this, other.Min.X(), other.Min.Y(), other.Min.Z(), other.Max.X(), other.Max.Y(), other.Max.Z());
+		}
+
+		float AABB::SquaredDistance(const MathTypes::Vector3& point) const
+		{
+			float squaredDistance = 0.0f;
+			for (size_t axis = 0; axis < 3; ++axis)
+			{
+				const float value = point.Data()[axis];
+				const float outside = std::max(std::max(Min.Data()[axis] - value, value - Max.Data()[axis]), 0.0f);
+				squaredDistance += outside * outside;
+			}
+			return squaredDistance;
+		}
+
+		Sphere Sphere::FromPoints(const MathTypes::Vector3* const points, const size_t count)
+		{
+			const MathTypes::Vector3 center = AABB::FromPoints(points, count).Center();
+
+			float maxSquaredDistance = 0.0f;
+			for (size_t i = 0; i < count; ++i)
+			{
+				maxSquaredDistance = std::max(maxSquaredDistance, (points[i] - center).SquaredLength());
+			}
+
+			return Sphere{ center, std::sqrt(maxSquaredDistance) };
+		}
+
+		Sphere Sphere::Transformed(const MathTypes::Matrix4x4& transform) const
+		{
+			float maxSquaredScale = 0.0f;
+			for (size_t column = 0; column < 3; ++column)
+			{
+				const float x = MatrixElement(transform, 0, column);
+				const float y = MatrixElement(transform, 1, column);
+				const float z = MatrixElement(transform, 2, column);
+				maxSquaredScale = std::max(maxSquaredScale, (x * x) + (y * y) + (z * z));
+			}
+
+			return Sphere{ TransformPoint(transform, Center), Radius * std::sqrt(maxSquaredScale) };
+		}
+
+		bool Sphere::Intersects(const Sphere& other) const
+		{
+			const float radii = Radius + other.Radius;
+			return (Center - other.Center).SquaredLength() <= (radii * radii);
+		}
+
+		bool Sphere::Intersects(const AABB& aabb) const
+		{
+			// Squared distance from the center to the closest point on the box.
+			float squaredDistance = 0.0f;
+			for (size_t axis = 0; axis < 3; ++axis)
+			{
+				const float value = Center.Data()[axis];
+				const float closest = std::clamp(value, aabb.Min.Data()[axis], aabb.Max.Data()[axis]);
+				squaredDistance += (value - closest) * (value - closest);
+			}
+			return squaredDistance <= (Radius * Radius);
+		}
+
+		OBB OBB::FromAABB(const AABB& aabb, const MathTypes::Matrix4x4& transform)
+		{
+			OBB result = {};
+			result.Center = TransformPoint(transform, aabb.Center());
+
+			const MathTypes::Vector3 halfExtents = aabb.HalfExtents();
+			float scaledHalfExtents[3] = {};
+			for (size_t column = 0; column < 3; ++column)
+			{
+				const MathTypes::Vector3 axis(MatrixElement(transform, 0, column), MatrixElement(transform, 1, column), MatrixElement(transform, 2, column));
+				const float scale = axis.Length();
+				result.Axes[column] = (scale > 0.0f) ? axis * (1.0f / scale) : MathTypes::Vector3();
+				scaledHalfExtents[column] = halfExtents.Data()[column] * scale;
+			}
+			result.HalfExtents = MathTypes::Vector3(scaledHalfExtents[0], scaledHalfExtents[1], scaledHalfExtents[2]);
+
+			return result;
+		}
+
+		bool OBB::Intersects(const OBB& other) const
+		{
+			// Separating axis test from Real-Time Collision Detection 4.4.1. Rotation expresses the other box in this box's frame.
+			static constexpr float Epsilon = 1e-6f;
+
+			const float* a = HalfExtents.Data();
+			const float* b = other.HalfExtents.Data();
+
+			float rotation[3][3] = {};
+			float absRotation[3][3] = {};
+			for (size_t i = 0; i < 3; ++i)
+			{
+				for (size_t j = 0; j < 3; ++j)
+				{
+					rotation[i][j] = MathTypes::Vector3::DotProduct(Axes[i], other.Axes[j]);
+					absRotation[i][j] = std::fabs(rotation[i][j]) + Epsilon;
+				}
+			}
+
+			const MathTypes::Vector3 translationWorld = other.Center - Center;
+			const float t[3] = { MathTypes::Vector3::DotProduct(translationWorld, Axes[0]), MathTypes::Vector3::DotProduct(translationWorld, Axes[1]),
+				MathTypes::Vector3::DotProduct(translationWorld, Axes[2]) };
+
+			// Axes of this box.
+			for (size_t i = 0; i < 3; ++i)
+			{
+				const float ra = a[i];
+				const float rb = b[0] * absRotation[i][0] + b[1] * absRotation[i][1] + b[2] * absRotation[i][2];
+				if (std::fabs(t[i]) > ra + rb)
+				{
+					return false;
+				}
+			}
+
+			// Axes of the other box.
+			for (size_t j = 0; j < 3; ++j)
+			{
+				const float ra = a[0] * absRotation[0][j] + a[1] * absRotation[1][j] + a[2] * absRotation[2][j];
+				const float rb = b[j];
+				if (std::fabs(t[0] * rotation[0][j] + t[1] * rotation[1][j] + t[2] * rotation[2][j]) > ra + rb)
+				{
+					return false;
+				}
+			}
+
+			// Cross products of every axis pair.
+			for (size_t i = 0; i < 3; ++i)
+			{
+				const size_t i1 = (i + 1) % 3;
+				const size_t i2 = (i + 2) % 3;
+				for (size_t j = 0; j < 3; ++j)
+				{
+					const size_t j1 = (j + 1) % 3;
+					const size_t j2 = (j + 2) % 3;
+					const float ra = a[i1] * absRotation[i2][j] + a[i2] * absRotation[i1][j];
+					const float rb = b[j1] * absRotation[i][j2] + b[j2] * absRotation[i][j1];
+					if (std::fabs(t[i2] * rotation[i1][j] - t[i1] * rotation[i2][j]) > ra + rb)
+					{
+						return false;
+					}
+				}
+			}
+
+			return true;
+		}
+
+		Plane Plane::FromPointNormal(const MathTypes::Vector3& point, const MathTypes::Vector3& normal)
+		{
+			const MathTypes::Vector3 unitNormal = normal.AsNormalizedSafe();
+			return Plane{ unitNormal, -MathTypes::Vector3::DotProduct(unitNormal, point) };
+		}
+
+		Plane Plane::Normalized() const
+		{
+			const float length = Normal.Length();
+			if (length == 0.0f)
+			{
+				return *this;
+			}
+
+			const float inverseLength = 1.0f / length;
+			return Plane{ Normal * inverseLength, Distance * inverseLength };
+		}
+
+		float Plane::SignedDistance(const MathTypes::Vector3& point) const
+		{
+			return PlaneDistance(*this, point.X(), point.Y(), point.Z());
+		}
+
+		bool Ray::Intersects(const AABB& aabb, const float maxDistance, float& outDistance) const
+		{
+			const float inverseDirection[3] = { 1.0f / Direction.X(), 1.0f / Direction.Y(), 1.0f / Direction.Z() };
+			return RayAABBTest(Origin.Data(), inverseDirection, maxDistance, aabb.Min.Data(), aabb.Max.Data(), outDistance);
+		}
+
+		bool Ray::Intersects(const Sphere& sphere, const float maxDistance, float& outDistance) const
+		{
+			const MathTypes::Vector3 offset = Origin - sphere.Center;
+			const float c = offset.SquaredLength() - (sphere.Radius * sphere.Radius);
+			if (c <= 0.0f)
+			{
+				outDistance = 0.0f;
+				return true;
+			}
+
+			const float a = Direction.SquaredLength();
+			const float b = MathTypes::Vector3::DotProduct(offset, Direction);
+			const float discriminant = (b * b) - (a * c);
+			if ((b > 0.0f) || (discriminant < 0.0f) || (a == 0.0f))
+			{
+				return false;
+			}
+
+			outDistance = (-b - std::sqrt(discriminant)) / a;
+			return outDistance <= maxDistance;
+		}
+
+		bool Cone::Intersects(const Sphere& sphere) const
+		{
+			return ConeSphereTest(*this, std::cos(AngleRadians), std::sin(AngleRadians), sphere.Center.X(), sphere.Center.Y(), sphere.Center.Z(), sphere.Radius);
+		}
+
+		bool Cone::Intersects(const AABB& aabb) const
+		{
+			return ConeAABBTest(*this, std::cos(AngleRadians), std::sin(AngleRadians), aabb.Min.X(), aabb.Min.Y(), aabb.Min.Z(), aabb.Max.X(), aabb.Max.Y(), aabb.Max.Z());
+		}
+
+		Frustum Frustum::FromViewProjection(const MathTypes::Matrix4x4& viewProjection)
+		{
+			const auto row = [&viewProjection](const size_t index)
+				{
+					return std::array<float, 4>{ MatrixElement(viewProjection, index, 0), MatrixElement(viewProjection, index, 1),
+						MatrixElement(viewProjection, index, 2), MatrixElement(viewProjection, index, 3) };
+				};
+
+			const auto makePlane = [](const std::array<float, 4>& a, const std::array<float, 4>& b, const float sign)
+				{
+					return Plane{ MathTypes::Vector3(a[0] + sign * b[0], a[1] + sign * b[1], a[2] + sign * b[2]), a[3] + sign * b[3] }.Normalized();
+				};
+
+			const std::array<float, 4> row0 = row(0);
+			const std::array<float, 4> row1 = row(1);
+			const std::array<float, 4> row2 = row(2);
+			const std::array<float, 4> row3 = row(3);
+
+			Frustum result = {};
+			result.Planes[Left] = makePlane(row3, row0, 1.0f);
+			result.Planes[Right] = makePlane(row3, row0, -1.0f);
+			result.Planes[Bottom] = makePlane(row3, row1, 1.0f);
+			result.Planes[Top] = makePlane(row3, row1, -1.0f);
+			result.Planes[Near] = makePlane(row2, row2, 0.0f);
+			result.Planes[Far] = makePlane(row3, row2, -1.0f);
+			return result;
+		}
+
+		bool Frustum::Intersects(const MathTypes::Vector3& point) const
+		{
+			return FrustumSphereTest(*this, point.X(), point.Y(), point.Z(), 0.0f);
+		}
+
+		bool Frustum::Intersects(const Sphere& sphere) const
+		{
+			return FrustumSphereTest(*this, sphere.Center.X(), sphere.Center.Y(), sphere.Center.Z(), sphere.Radius);
+		}
+
+		bool Frustum::Intersects(const AABB& aabb) const
+		{
+			return FrustumAABBTest(*this, aabb.Min.X(), aabb.Min.Y(), aabb.Min.Z(), aabb.Max.X(), aabb.Max.Y(), aabb.Max.Z());
+		}
+
+		bool Frustum::Intersects(const OBB& obb) const
+		{
+			for (const Plane& plane : Planes)
+			{
+				const float radius = obb.HalfExtents.X() * std::fabs(MathTypes::Vector3::DotProduct(plane.Normal, obb.Axes[0])) +
+					obb.HalfExtents.Y() * std::fabs(MathTypes::Vector3::DotProduct(plane.Normal, obb.Axes[1])) +
+					obb.HalfExtents.Z() * std::fabs(MathTypes::Vector3::DotProduct(plane.Normal, obb.Axes[2]));
+				if (plane.SignedDistance(obb.Center) < -radius)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		Containment Frustum::Classify(const AABB& aabb) const
+		{
+			Containment result = Containment::Inside;
+			for (const Plane& plane : Planes)
+			{
+				// The corner furthest along the normal decides if the box is outside and the opposite corner decides if the box is inside.
+				const bool positiveX = (plane.Normal.X() >= 0.0f);
+				const bool positiveY = (plane.Normal.Y() >= 0.0f);
+				const bool positiveZ = (plane.Normal.Z() >= 0.0f);
+				if (PlaneDistance(plane, positiveX ? aabb.Max.X() : aabb.Min.X(), positiveY ? aabb.Max.Y() : aabb.Min.Y(), positiveZ ? aabb.Max.Z() : aabb.Min.Z()) < 0.0f)
+				{
+					return Containment::Outside;
+				}
+				if (PlaneDistance(plane, positiveX ? aabb.Min.X() : aabb.Max.X(), positiveY ? aabb.Min.Y() : aabb.Max.Y(), positiveZ ? aabb.Min.Z() : aabb.Max.Z()) < 0.0f)
+				{
+					result = Containment::Intersects;
+				}
+			}
+			return result;
+		}
+
+		void SphereArray::Add(const Sphere& sphere)
+		{
+			CenterX.push_back(sphere.Center.X());
+			CenterY.push_back(sphere.Center.Y());
+			CenterZ.push_back(sphere.Center.Z());
+			Radius.push_back(sphere.Radius);
+		}
+
+		void SphereArray::Set(const size_t index, const Sphere& sphere)
+		{
+			CenterX[index] = sphere.Center.X();
+			CenterY[index] = sphere.Center.Y();
+			CenterZ[index] = sphere.Center.Z();
+			Radius[index] = sphere.Radius;
+		}
+
+		Sphere SphereArray::Get(const size_t index) const
+		{
+			return Sphere{ MathTypes::Vector3(CenterX[index], CenterY[index], CenterZ[index]), Radius[index] };
+		}
+
+		void SphereArray::Resize(const size_t count)
+		{
+			CenterX.resize(count, 0.0f);
+			CenterY.resize(count, 0.0f);
+			CenterZ.resize(count, 0.0f);
+			Radius.resize(count, 0.0f);
+		}
+
+		void SphereArray::Clear()
+		{
+			CenterX.clear();
+			CenterY.clear();
+			CenterZ.clear();
+			Radius.clear();
+		}
+
+		SphereSoA SphereArray::View() const
+		{
+			return SphereSoA{ CenterX.data(), CenterY.data(), CenterZ.data(), Radius.data(), Radius.size() };
+		}
+
+		void AABBArray::Add(const AABB& aabb)
+		{
+			MinX.push_back(aabb.Min.X());
+			MinY.push_back(aabb.Min.Y());
+			MinZ.push_back(aabb.Min.Z());
+			MaxX.push_back(aabb.Max.X());
+			MaxY.push_back(aabb.Max.Y());
+			MaxZ.push_back(aabb.Max.Z());
+		}
+
+		void AABBArray::Set(const size_t index, const AABB& aabb)
+		{
+			MinX[index] = aabb.Min.X();
+			MinY[index] = aabb.Min.Y();
+			MinZ[index] = aabb.Min.Z();
+			MaxX[index] = aabb.Max.X();
+			MaxY[index] = aabb.Max.Y();
+			MaxZ[index] = aabb.Max.Z();
+		}
+
+		AABB AABBArray::Get(const size_t index) const
+		{
+			return AABB{ MathTypes::Vector3(MinX[index], MinY[index], MinZ[index]), MathTypes::Vector3(MaxX[index], MaxY[index], MaxZ[index]) };
+		}
+
+		void AABBArray::Resize(const size_t count)
+		{
+			MinX.resize(count, 0.0f);
+			MinY.resize(count, 0.0f);
+			MinZ.resize(count, 0.0f);
+			MaxX.resize(count, 0.0f);
+			MaxY.resize(count, 0.0f);
+			MaxZ.resize(count, 0.0f);
+		}
+
+		void AABBArray::Clear()
+		{
+			MinX.clear();
+			MinY.clear();
+			MinZ.clear();
+			MaxX.clear();
+			MaxY.clear();
+			MaxZ.clear();
+		}
+
+		AABBSoA AABBArray::View() const
+		{
+			return AABBSoA{ MinX.data(), MinY.data(), MinZ.data(), MaxX.data(), MaxY.data(), MaxZ.data(), MinX.size() };
+		}
+
+#ifdef LEVIATHAN_SIMD_SSE
+		// Writes one byte per lane of the four lane mask to out.
+		static inline void StoreMask4(const __m128 mask, uint8_t* out)
+		{
+			const int bits = _mm_movemask_ps(mask);
+			out[0] = static_cast<uint8_t>(bits & 1);
+			out[1] = static_cast<uint8_t>((bits >> 1) & 1);
+			out[2] = static_cast<uint8_t>((bits >> 2) & 1);
+			out[3] = static_cast<uint8_t>((bits >> 3) & 1);
+		}
+
+		static inline __m128 PlaneDistance4(const Plane& plane, const __m128 x, const __m128 y, const __m128 z)
+		{
+			const __m128 xy = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.Normal.X()), x), _mm_mul_ps(_mm_set1_ps(plane.Normal.Y()), y));
+			return _mm_add_ps(_mm_add_ps(xy, _mm_mul_ps(_mm_set1_ps(plane.Normal.Z()), z)), _mm_set1_ps(plane.Distance));
+		}
+#endif // LEVIATHAN_SIMD_SSE.
+
+		void TestFrustumSpheres(const Frustum& frustum, const SphereSoA& spheres, const size_t first, const size_t count, uint8_t* outResults)
+		{
+			LEVIATHAN_ASSERT(first + count <= spheres.Count);
+
+			size_t i = 0;
+#ifdef LEVIATHAN_SIMD_SSE
+			for (; i + 4 <= count; i += 4)
+			{
+				const size_t index = first + i;
+				const __m128 x = _mm_loadu_ps(spheres.CenterX + index);
+				const __m128 y = _mm_loadu_ps(spheres.CenterY + index);
+				const __m128 z = _mm_loadu_ps(spheres.CenterZ + index);
+				const __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(spheres.Radius + index));
+
+				__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+				for (const Plane& plane : frustum.Planes)
+				{
+					inside = _mm_and_ps(inside, _mm_cmpge_ps(PlaneDistance4(plane, x, y, z), negativeRadius));
+				}
+				StoreMask4(inside, outResults + i);
+			}
+#endif // LEVIATHAN_SIMD_SSE.
+			for (; i < count; ++i)
+			{
+				const size_t index = first + i;
+				outResults[i] = FrustumSphereTest(frustum, spheres.CenterX[index], spheres.CenterY[index], spheres.CenterZ[index], spheres.Radius[index]) ? 1 : 0;
+			}
+		}
+
+		void TestFrustumAABBs(const Frustum& frustum, const AABBSoA& aabbs, const size_t first, const size_t count, uint8_t* outResults)
+		{
+			LEVIATHAN_ASSERT(first + count <= aabbs.Count);
+
+			// The corner furthest along each plane normal only depends on the plane so the arrays to read are chosen once per batch.
+			std::array<std::array<const float*, 3>, Frustum::PlaneCount> positiveCorners = {};
+			for (size_t p = 0; p < Frustum::PlaneCount; ++p)
+			{
+				const MathTypes::Vector3& normal = frustum.Planes[p].Normal;
+				positiveCorners[p] = { (normal.X() >= 0.0f) ? aabbs.MaxX : aabbs.MinX, (normal.Y() >= 0.0f) ? aabbs.MaxY : aabbs.MinY,
+					(normal.Z() >= 0.0f) ? aabbs.MaxZ : aabbs.MinZ };
+			}
+
+			size_t i = 0;
+#ifdef LEVIATHAN_SIMD_SSE
+			for (; i + 4 <= count; i += 4)
+			{
+				const size_t index = first + i;
+				__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+				for (size_t p = 0; p < Frustum::PlaneCount; ++p)
+				{
+					const __m128 x = _mm_loadu_ps(positiveCorners[p][0] + index);
+					const __m128 y = _mm_loadu_ps(positiveCorners[p][1] + index);
+					const __m128 z = _mm_loadu_ps(positiveCorners[p][2] + index);
+					inside = _mm_and_ps(inside, _mm_cmpge_ps(PlaneDistance4(frustum.Planes[p], x, y, z), _mm_setzero_ps()));
+				}
+				StoreMask4(inside, outResults + i);
+			}
+#endif // LEVIATHAN_SIMD_SSE.
+			for (; i < count; ++i)
+			{
+				const size_t index = first + i;
+				outResults[i] = FrustumAABBTest(frustum, aabbs.MinX[index], aabbs.MinY[index], aabbs.MinZ[index], aabbs.MaxX[index], aabbs.MaxY[index], aabbs.MaxZ[index]) ? 1 : 0;
+			}
+		}
+
+		void TestAABBAABBs(const AABB& query, const AABBSoA& aabbs, const size_t first, const size_t count, uint8_t* outResults)
+		{
+			LEVIATHAN_ASSERT(first + count <= aabbs.Count);
+
+			size_t i = 0;
+#ifdef LEVIATHAN_SIMD_SSE
+			const __m128 queryMinX = _mm_set1_ps(query.Min.X());
+			const __m128 queryMinY = _mm_set1_ps(query.Min.Y());
+			const __m128 queryMinZ = _mm_set1_ps(query.Min.Z());
+			const __m128 queryMaxX = _mm_set1_ps(query.Max.X());
+			const __m128 queryMaxY = _mm_set1_ps(query.Max.Y());
+			const __m128 queryMaxZ = _mm_set1_ps(query.Max.Z());
+			for (; i + 4 <= count; i += 4)
+			{
+				const size_t index = first + i;
+				__m128 overlap = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(aabbs.MinX + index), queryMaxX), _mm_cmpge_ps(_mm_loadu_ps(aabbs.MaxX + index), queryMinX));
+				overlap = _mm_and_ps(overlap, _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(aabbs.MinY + index), queryMaxY), _mm_cmpge_ps(_mm_loadu_ps(aabbs.MaxY + index), queryMinY)));
+				overlap = _mm_and_ps(overlap, _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(aabbs.MinZ + index), queryMaxZ), _mm_cmpge_ps(_mm_loadu_ps(aabbs.MaxZ + index), queryMinZ)));
+				StoreMask4(overlap, outResults + i);
+			}
+#endif // LEVIATHAN_SIMD_SSE.
+			for (; i < count; ++i)
+			{
+				const size_t index = first + i;
+				outResults[i] = AABBOverlapTest(query, aabbs.MinX[index], aabbs.MinY[index], aabbs.MinZ[index], aabbs.MaxX[index], aabbs.MaxY[index], aabbs.MaxZ[index]) ? 1 : 0;
+			}
+		}
+
+		void TestAABBSpheres(const AABB& query, const SphereSoA& spheres, const size_t first, const size_t count, uint8_t* outResults)
+		{
+			LEVIATHAN_ASSERT(first + count <= spheres.Count);
+
+			size_t i = 0;
+#ifdef LEVIATHAN_SIMD_SSE
+			const __m128 queryMinX = _mm_set1_ps(query.Min.X());
+			const __m128 queryMinY = _mm_set1_ps(query.Min.Y());
+			const __m128 queryMinZ = _mm_set1_ps(query.Min.Z());
+			const __m128 queryMaxX = _mm_set1_ps(query.Max.X());
+			const __m128 queryMaxY = _mm_set1_ps(query.Max.Y());
+			const __m128 queryMaxZ = _mm_set1_ps(query.Max.Z());
+			const __m128 zero = _mm_setzero_ps();
+			for (; i + 4 <= count; i += 4)
+			{
+				const size_t index = first + i;
+				const __m128 x = _mm_loadu_ps(spheres.CenterX + index);
+				const __m128 y = _mm_loadu_ps(spheres.CenterY + index);
+				const __m128 z = _mm_loadu_ps(spheres.CenterZ + index);
+				const __m128 radius = _mm_loadu_ps(spheres.Radius + index);
+
+				// Distance from the center to the box along each axis, 0 inside the box's slab.
+				const __m128 outsideX = _mm_max_ps(_mm_max_ps(_mm_sub_ps(queryMinX, x), _mm_sub_ps(x, queryMaxX)), zero);
+				const __m128 outsideY = _mm_max_ps(_mm_max_ps(_mm_sub_ps(queryMinY, y), _mm_sub_ps(y, queryMaxY)), zero);
+				const __m128 outsideZ = _mm_max_ps(_mm_max_ps(_mm_sub_ps(queryMinZ, z), _mm_sub_ps(z, queryMaxZ)), zero);
+				const __m128 squaredDistance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(outsideX, outsideX), _mm_mul_ps(outsideY, outsideY)), _mm_mul_ps(outsideZ, outsideZ));
+				StoreMask4(_mm_cmple_ps(squaredDistance, _mm_mul_ps(radius, radius)), outResults + i);
+			}
+#endif // LEVIATHAN_SIMD_SSE.
+			for (; i < count; ++i)
+			{
+				const size_t index = first + i;
+				outResults[i] = AABBSphereTest(query, spheres.CenterX[index], spheres.CenterY[index], spheres.CenterZ[index], spheres.Radius[index]) ? 1 : 0;
+			}
+		}
+
+		void TestSphereAABBs(const Sphere& query, const AABBSoA& aabbs, const size_t first, const size_t count, uint8_t* outResults)
+		{
+			LEVIATHAN_ASSERT(first + count <= aabbs.Count);
+
+			size_t i = 0;
+#ifdef LEVIATHAN_SIMD_SSE
+			const __m128 x = _mm_set1_ps(query.Center.X());
+			const __m128 y = _mm_set1_ps(query.Center.Y());
+			const __m128 z = _mm_set1_ps(query.Center.Z());
+			const __m128 squaredRadius = _mm_set1_ps(query.Radius * query.Radius);
+			const __m128 zero = _mm_setzero_ps();
+			for (; i + 4 <= count; i += 4)
+			{
+				const size_t index = first + i;
+				const __m128 outsideX = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(aabbs.MinX + index), x), _mm_sub_ps(x, _mm_loadu_ps(aabbs.MaxX + index))), zero);
+				const __m128 outsideY = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(aabbs.MinY + index), y), _mm_sub_ps(y, _mm_loadu_ps(aabbs.MaxY + index))), zero);
+				const __m128 outsideZ = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(aabbs.MinZ + index), z), _mm_sub_ps(z, _mm_loadu_ps(aabbs.MaxZ + index))), zero);
+				const __m128 squaredDistance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(outsideX, outsideX), _mm_mul_ps(outsideY, outsideY)), _mm_mul_ps(outsideZ, outsideZ));
+				StoreMask4(_mm_cmple_ps(squaredDistance, squaredRadius), outResults + i);
+			}
+#endif // LEVIATHAN_SIMD_SSE.
+			for (; i < count; ++i)
+			{
+				const size_t index = first + i;
+				const AABB aabb{ MathTypes::Vector3(aabbs.MinX[index], aabbs.MinY[index], aabbs.MinZ[index]), MathTypes::Vector3(aabbs.MaxX[index], aabbs.MaxY[index], aabbs.MaxZ[index]) };
+				outResults[i] = AABBSphereTest(aabb, query.Center.X(), query.Center.Y(), query.Center.Z(), query.Radius) ? 1 : 0;
+			}
+		}
+
+		void TestConeAABBs(const Cone& query, const AABBSoA& aabbs, const size_t first, const size_t count, uint8_t* outResults)
+		{
+			LEVIATHAN_ASSERT(first + count <= aabbs.Count);
+
+			const float cosine = std::cos(query.AngleRadians);
+			const float sine = std::sin(query.AngleRadians);
+
+			size_t i = 0;
+#ifdef LEVIATHAN_SIMD_SSE
+			const __m128 apexX = _mm_set1_ps(query.Apex.X());
+			const __m128 apexY = _mm_set1_ps(query.Apex.Y());
+			const __m128 apexZ = _mm_set1_ps(query.Apex.Z());
+			const __m128 directionX = _mm_set1_ps(query.Direction.X());
+			const __m128 directionY = _mm_set1_ps(query.Direction.Y());
+			const __m128 directionZ = _mm_set1_ps(query.Direction.Z());
+			const __m128 range = _mm_set1_ps(query.Range);
+			const __m128 cosine4 = _mm_set1_ps(cosine);
+			const __m128 sine4 = _mm_set1_ps(sine);
+			const __m128 half = _mm_set1_ps(0.5f);
+			const __m128 zero = _mm_setzero_ps();
+			for (; i + 4 <= count; i += 4)
+			{
+				const size_t index = first + i;
+				const __m128 minX = _mm_loadu_ps(aabbs.MinX + index);
+				const __m128 minY = _mm_loadu_ps(aabbs.MinY + index);
+				const __m128 minZ = _mm_loadu_ps(aabbs.MinZ + index);
+				const __m128 maxX = _mm_loadu_ps(aabbs.MaxX + index);
+				const __m128 maxY = _mm_loadu_ps(aabbs.MaxY + index);
+				const __m128 maxZ = _mm_loadu_ps(aabbs.MaxZ + index);
+
+				// Bounding spheres of the boxes.
+				const __m128 halfX = _mm_mul_ps(_mm_sub_ps(maxX, minX), half);
+				const __m128 halfY = _mm_mul_ps(_mm_sub_ps(maxY, minY), half);
+				const __m128 halfZ = _mm_mul_ps(_mm_sub_ps(maxZ, minZ), half);
+				const __m128 radius = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(halfX, halfX), _mm_mul_ps(halfY, halfY)), _mm_mul_ps(halfZ, halfZ)));
+				const __m128 offsetX = _mm_sub_ps(_mm_mul_ps(_mm_add_ps(minX, maxX), half), apexX);
+				const __m128 offsetY = _mm_sub_ps(_mm_mul_ps(_mm_add_ps(minY, maxY), half), apexY);
+				const __m128 offsetZ = _mm_sub_ps(_mm_mul_ps(_mm_add_ps(minZ, maxZ), half), apexZ);
+
+				const __m128 squaredLength = _mm_add_ps(_mm_add_ps(_mm_mul_ps(offsetX, offsetX), _mm_mul_ps(offsetY, offsetY)), _mm_mul_ps(offsetZ, offsetZ));
+				const __m128 axial = _mm_add_ps(_mm_add_ps(_mm_mul_ps(offsetX, directionX), _mm_mul_ps(offsetY, directionY)), _mm_mul_ps(offsetZ, directionZ));
+				const __m128 reach = _mm_add_ps(range, radius);
+				const __m128 surfaceDistance = _mm_sub_ps(_mm_mul_ps(cosine4, _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(squaredLength, _mm_mul_ps(axial, axial)), zero))),
+					_mm_mul_ps(axial, sine4));
+
+				__m128 inside = _mm_cmple_ps(squaredLength, _mm_mul_ps(reach, reach));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(axial, _mm_sub_ps(zero, radius)));
+				inside = _mm_and_ps(inside, _mm_cmple_ps(surfaceDistance, radius));
+				StoreMask4(inside, outResults + i);
+			}
+#endif // LEVIATHAN_SIMD_SSE.
+			for (; i < count; ++i)
+			{
+				const size_t index = first + i;
+				outResults[i] = ConeAABBTest(query, cosine, sine, aabbs.MinX[index], aabbs.MinY[index], aabbs.MinZ[index], aabbs.MaxX[index], aabbs.MaxY[index], aabbs.MaxZ[index]) ? 1 : 0;
+			}
+		}
+
+		void TestRayAABBs(const Ray& ray, const float maxDistance, const AABBSoA& aabbs, const size_t first, const size_t count, uint8_t* outResults, float* outDistances)
+		{
+			LEVIATHAN_ASSERT(first + count <= aabbs.Count);
+
+			const float* origin = ray.Origin.Data();
+			const float inverseDirection[3] = { 1.0f / ray.Direction.X(), 1.0f / ray.Direction.Y(), 1.0f / ray.Direction.Z() };
+			const std::array<const float*, 3> mins = { aabbs.MinX, aabbs.MinY, aabbs.MinZ };
+			const std::array<const float*, 3> maxs = { aabbs.MaxX, aabbs.MaxY, aabbs.MaxZ };
+
+			size_t i = 0;
+#ifdef LEVIATHAN_SIMD_SSE
+			for (; i + 4 <= count; i += 4)
+			{
+				const size_t index = first + i;
+				__m128 nearDistance = _mm_setzero_ps();
+				__m128 farDistance = _mm_set1_ps(maxDistance);
+				for (size_t axis = 0; axis < 3; ++axis)
+				{
+					const __m128 axisOrigin = _mm_set1_ps(origin[axis]);
+					const __m128 axisInverseDirection = _mm_set1_ps(inverseDirection[axis]);
+					const __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(mins[axis] + index), axisOrigin), axisInverseDirection);
+					const __m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(maxs[axis] + index), axisOrigin), axisInverseDirection);
+					nearDistance = _mm_max_ps(nearDistance, _mm_min_ps(t1, t2));
+					farDistance = _mm_min_ps(farDistance, _mm_max_ps(t1, t2));
+				}
+				StoreMask4(_mm_cmple_ps(nearDistance, farDistance), outResults + i);
+				if (outDistances)
+				{
+					_mm_storeu_ps(outDistances + i, nearDistance);
+				}
+			}
+#endif // LEVIATHAN_SIMD_SSE.
+			for (; i < count; ++i)
+			{
+				const size_t index = first + i;
+				const float min[3] = { aabbs.MinX[index], aabbs.MinY[index], aabbs.MinZ[index] };
+				const float max[3] = { aabbs.MaxX[index], aabbs.MaxY[index], aabbs.MaxZ[index] };
+				float distance = 0.0f;
+				outResults[i] = RayAABBTest(origin, inverseDirection, maxDistance, min, max, distance) ? 1 : 0;
+				if (outDistances)
+				{
+					outDistances[i] = distance;
+				}
+			}
+		}
+	}
+}
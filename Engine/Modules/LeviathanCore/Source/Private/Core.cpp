@@ -3,6 +3,7 @@
 #include "PlatformWindow.h"
 #include "Logging.h"
 #include "InputKey.h"
+#include "JobSystem.h"
 
 #ifdef LEVIATHAN_WITH_TOOLS
 #include "LeviathanTools.h"
@@ -127,6 +128,8 @@ namespace LeviathanCore
 			LeviathanTools::Shutdown();
 #endif // LEVIATHAN_WITH_TOOLS.
 
+			JobSystem::Shutdown();
+
 			return true;
 		}
 
@@ -268,6 +271,12 @@ namespace LeviathanCore
 			LeviathanCore::Platform::CreateDebugConsole();
 #endif // !LEVIATHAN_BUILD_CONFIG_MASTER
 
+			// Start job system worker threads.
+			if (!JobSystem::Initialize())
+			{
+				return false;
+			}
+
 			// Create the runtime window.
 			if (!CreateAndInitializeRuntimeWindow())
 			{
@@ -0,0 +1,393 @@
+#include "DynamicAABBTree.h"
+
+namespace LeviathanCore
+{
+	namespace DataStructures
+	{
+		// Proxies are reinserted when their enlarged box has grown beyond aabb expanded by this many margins, e.g. after a fast movement has stopped.
+		static constexpr float MaxMarginMultiplier = 4.0f;
+		// Displacement is scaled by this to predict motion for several updates.
+		static constexpr float DisplacementMultiplier = 4.0f;
+
+		static BoundingVolumes::AABB Expand(const BoundingVolumes::AABB& aabb, const float amount)
+		{
+			const MathTypes::Vector3 offset(amount, amount, amount);
+			return BoundingVolumes::AABB{ aabb.Min - offset, aabb.Max + offset };
+		}
+
+		DynamicAABBTree::DynamicAABBTree(const float margin)
+			: Margin(margin)
+		{
+		}
+
+		DynamicAABBTree::ProxyId DynamicAABBTree::CreateProxy(const BoundingVolumes::AABB& aabb, const uint64_t userData)
+		{
+			const int32_t leaf = AllocateNode();
+			Node& node = Nodes[leaf];
+			node.Box = Expand(aabb, Margin);
+			node.UserData = userData;
+			node.Height = 0;
+
+			InsertLeaf(leaf);
+			++ProxyCount;
+			return static_cast<ProxyId>(leaf);
+		}
+
+		void DynamicAABBTree::DestroyProxy(const ProxyId proxyId)
+		{
+			LEVIATHAN_ASSERT(IsProxy(proxyId));
+
+			RemoveLeaf(proxyId);
+			FreeNode(proxyId);
+			--ProxyCount;
+		}
+
+		bool DynamicAABBTree::MoveProxy(const ProxyId proxyId, const BoundingVolumes::AABB& aabb, const MathTypes::Vector3& displacement)
+		{
+			LEVIATHAN_ASSERT(IsProxy(proxyId));
+
+			const BoundingVolumes::AABB& fatBox = Nodes[proxyId].Box;
+			if ((fatBox.Contains(aabb)) && (Expand(aabb, Margin * MaxMarginMultiplier).Contains(fatBox)))
+			{
+				return false;
+			}
+
+			RemoveLeaf(proxyId);
+
+			// Enlarge by the margin and extend in the direction of motion.
+			BoundingVolumes::AABB newFatBox = Expand(aabb, Margin);
+			float* const min = newFatBox.Min.Data();
+			float* const max = newFatBox.Max.Data();
+			for (size_t axis = 0; axis < 3; ++axis)
+			{
+				const float predicted = displacement.Data()[axis] * DisplacementMultiplier;
+				if (predicted < 0.0f)
+				{
+					min[axis] += predicted;
+				}
+				else
+				{
+					max[axis] += predicted;
+				}
+			}
+
+			Nodes[proxyId].Box = newFatBox;
+			InsertLeaf(proxyId);
+			return true;
+		}
+
+		void DynamicAABBTree::Clear()
+		{
+			Nodes.clear();
+			Root = NullNode;
+			FreeList = NullNode;
+			ProxyCount = 0;
+		}
+
+		float DynamicAABBTree::GetAreaRatio() const
+		{
+			if (Root == NullNode)
+			{
+				return 0.0f;
+			}
+
+			const float rootArea = Nodes[Root].Box.SurfaceArea();
+			if (rootArea <= 0.0f)
+			{
+				return 0.0f;
+			}
+
+			float totalArea = 0.0f;
+			for (const Node& node : Nodes)
+			{
+				if (node.Height > 0)
+				{
+					totalArea += node.Box.SurfaceArea();
+				}
+			}
+			return totalArea / rootArea;
+		}
+
+		bool DynamicAABBTree::Validate() const
+		{
+			if (Root == NullNode)
+			{
+				return ProxyCount == 0;
+			}
+
+			if (Nodes[Root].ParentOrNext != NullNode)
+			{
+				return false;
+			}
+
+			size_t leafCount = 0;
+			TraversalStack stack = {};
+			stack.Push(Root);
+			while (!stack.IsEmpty())
+			{
+				const int32_t nodeIndex = stack.Pop();
+				const Node& node = Nodes[nodeIndex];
+				if (node.IsLeaf())
+				{
+					if ((node.Height != 0) || (node.Child2 != NullNode))
+					{
+						return false;
+					}
+					++leafCount;
+					continue;
+				}
+
+				const Node& child1 = Nodes[node.Child1];
+				const Node& child2 = Nodes[node.Child2];
+				if ((child1.ParentOrNext != nodeIndex) || (child2.ParentOrNext != nodeIndex))
+				{
+					return false;
+				}
+				if (node.Height != 1 + std::max(child1.Height, child2.Height))
+				{
+					return false;
+				}
+				if ((!node.Box.Contains(child1.Box)) || (!node.Box.Contains(child2.Box)))
+				{
+					return false;
+				}
+
+				stack.Push(node.Child1);
+				stack.Push(node.Child2);
+			}
+
+			return leafCount == ProxyCount;
+		}
+
+		int32_t DynamicAABBTree::AllocateNode()
+		{
+			if (FreeList == NullNode)
+			{
+				// Grow the node pool and thread the new nodes onto the free list.
+				const size_t oldCapacity = Nodes.size();
+				const size_t newCapacity = std::max(static_cast<size_t>(16), oldCapacity * 2);
+				Nodes.resize(newCapacity);
+				for (size_t i = oldCapacity; i < newCapacity; ++i)
+				{
+					Nodes[i].ParentOrNext = (i + 1 < newCapacity) ? static_cast<int32_t>(i + 1) : NullNode;
+					Nodes[i].Height = -1;
+				}
+				FreeList = static_cast<int32_t>(oldCapacity);
+			}
+
+			const int32_t node = FreeList;
+			FreeList = Nodes[node].ParentOrNext;
+			Nodes[node].ParentOrNext = NullNode;
+			Nodes[node].Child1 = NullNode;
+			Nodes[node].Child2 = NullNode;
+			Nodes[node].Height = 0;
+			Nodes[node].UserData = 0;
+			return node;
+		}
+
+		void DynamicAABBTree::FreeNode(const int32_t node)
+		{
+			Nodes[node].ParentOrNext = FreeList;
+			Nodes[node].Height = -1;
+			FreeList = node;
+		}
+
+		void DynamicAABBTree::InsertLeaf(const int32_t leaf)
+		{
+			if (Root == NullNode)
+			{
+				Root = leaf;
+				Nodes[leaf].ParentOrNext = NullNode;
+				return;
+			}
+
+			// Descend to the sibling with the lowest surface area cost. Creating a parent at a node costs the area of the new parent plus the area increase
+			// inherited by every ancestor.
+			const BoundingVolumes::AABB leafBox = Nodes[leaf].Box;
+			int32_t index = Root;
+			while (!Nodes[index].IsLeaf())
+			{
+				const Node& node = Nodes[index];
+				const float area = node.Box.SurfaceArea();
+				const float combinedArea = BoundingVolumes::AABB::Merge(node.Box, leafBox).SurfaceArea();
+
+				const float cost = 2.0f * combinedArea;
+				const float inheritanceCost = 2.0f * (combinedArea - area);
+
+				const auto descendCost = [this, &leafBox, inheritanceCost](const int32_t child)
+					{
+						const Node& childNode = Nodes[child];
+						const float mergedArea = BoundingVolumes::AABB::Merge(leafBox, childNode.Box).SurfaceArea();
+						return (childNode.IsLeaf() ? mergedArea : (mergedArea - childNode.Box.SurfaceArea())) + inheritanceCost;
+					};
+
+				const float cost1 = descendCost(node.Child1);
+				const float cost2 = descendCost(node.Child2);
+				if ((cost < cost1) && (cost < cost2))
+				{
+					break;
+				}
+
+				index = (cost1 < cost2) ? node.Child1 : node.Child2;
+			}
+
+			const int32_t sibling = index;
+
+			// Allocating may grow the node pool so node references are taken afterwards.
+			const int32_t newParent = AllocateNode();
+			const int32_t oldParent = Nodes[sibling].ParentOrNext;
+			Node& parentNode = Nodes[newParent];
+			parentNode.ParentOrNext = oldParent;
+			parentNode.Box = BoundingVolumes::AABB::Merge(leafBox, Nodes[sibling].Box);
+			parentNode.Height = Nodes[sibling].Height + 1;
+			parentNode.Child1 = sibling;
+			parentNode.Child2 = leaf;
+			Nodes[sibling].ParentOrNext = newParent;
+			Nodes[leaf].ParentOrNext = newParent;
+
+			if (oldParent == NullNode)
+			{
+				Root = newParent;
+			}
+			else if (Nodes[oldParent].Child1 == sibling)
+			{
+				Nodes[oldParent].Child1 = newParent;
+			}
+			else
+			{
+				Nodes[oldParent].Child2 = newParent;
+			}
+
+			Refit(Nodes[leaf].ParentOrNext);
+		}
+
+		void DynamicAABBTree::RemoveLeaf(const int32_t leaf)
+		{
+			if (leaf == Root)
+			{
+				Root = NullNode;
+				return;
+			}
+
+			const int32_t parent = Nodes[leaf].ParentOrNext;
+			const int32_t grandParent = Nodes[parent].ParentOrNext;
+			const int32_t sibling = (Nodes[parent].Child1 == leaf) ? Nodes[parent].Child2 : Nodes[parent].Child1;
+
+			// Replace the parent with the sibling.
+			Nodes[sibling].ParentOrNext = grandParent;
+			FreeNode(parent);
+
+			if (grandParent == NullNode)
+			{
+				Root = sibling;
+				return;
+			}
+
+			if (Nodes[grandParent].Child1 == parent)
+			{
+				Nodes[grandParent].Child1 = sibling;
+			}
+			else
+			{
+				Nodes[grandParent].Child2 = sibling;
+			}
+
+			Refit(grandParent);
+		}
+
+		int32_t DynamicAABBTree::Balance(const int32_t a)
+		{
+			Node& nodeA = Nodes[a];
+			if ((nodeA.IsLeaf()) || (nodeA.Height < 2))
+			{
+				return a;
+			}
+
+			const int32_t b = nodeA.Child1;
+			const int32_t c = nodeA.Child2;
+			Node& nodeB = Nodes[b];
+			Node& nodeC = Nodes[c];
+			const int32_t balance = nodeC.Height - nodeB.Height;
+
+			// Promotes the child up to replace a. otherNode is a's other child. a takes the place of up's shorter child and up keeps its taller child.
+			const auto rotateUp = [this, a, &nodeA](const int32_t up, Node& upNode, const Node& otherNode, const bool upIsChild2)
+				{
+					const int32_t f = upNode.Child1;
+					const int32_t g = upNode.Child2;
+					Node& nodeF = Nodes[f];
+					Node& nodeG = Nodes[g];
+
+					// Swap a and up.
+					upNode.Child1 = a;
+					upNode.ParentOrNext = nodeA.ParentOrNext;
+					nodeA.ParentOrNext = up;
+
+					if (upNode.ParentOrNext == NullNode)
+					{
+						Root = up;
+					}
+					else if (Nodes[upNode.ParentOrNext].Child1 == a)
+					{
+						Nodes[upNode.ParentOrNext].Child1 = up;
+					}
+					else
+					{
+						Nodes[upNode.ParentOrNext].Child2 = up;
+					}
+
+					// The taller grandchild stays under up and the shorter one moves under a in place of up.
+					const bool keepF = (nodeF.Height > nodeG.Height);
+					const int32_t kept = keepF ? f : g;
+					const int32_t moved = keepF ? g : f;
+					Node& keptNode = Nodes[kept];
+					Node& movedNode = Nodes[moved];
+
+					upNode.Child2 = kept;
+					if (upIsChild2)
+					{
+						nodeA.Child2 = moved;
+					}
+					else
+					{
+						nodeA.Child1 = moved;
+					}
+					movedNode.ParentOrNext = a;
+
+					nodeA.Box = BoundingVolumes::AABB::Merge(otherNode.Box, movedNode.Box);
+					nodeA.Height = 1 + std::max(otherNode.Height, movedNode.Height);
+					upNode.Box = BoundingVolumes::AABB::Merge(nodeA.Box, keptNode.Box);
+					upNode.Height = 1 + std::max(nodeA.Height, keptNode.Height);
+				};
+
+			if (balance > 1)
+			{
+				rotateUp(c, nodeC, nodeB, true);
+				return c;
+			}
+
+			if (balance < -1)
+			{
+				rotateUp(b, nodeB, nodeC, false);
+				return b;
+			}
+
+			return a;
+		}
+
+		void DynamicAABBTree::Refit(int32_t node)
+		{
+			while (node != NullNode)
+			{
+				node = Balance(node);
+
+				Node& current = Nodes[node];
+				const Node& child1 = Nodes[current.Child1];
+				const Node& child2 = Nodes[current.Child2];
+				current.Height = 1 + std::max(child1.Height, child2.Height);
+				current.Box = BoundingVolumes::AABB::Merge(child1.Box, child2.Box);
+
+				node = current.ParentOrNext;
+			}
+		}
+	}
+}
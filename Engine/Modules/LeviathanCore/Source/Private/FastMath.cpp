@@ -0,0 +1,257 @@
+#include "FastMath.h"
+
+namespace LeviathanCore
+{
+	namespace FastMath
+	{
+#ifdef LEVIATHAN_SIMD_SSE
+		static constexpr size_t SimdWidth = 4;
+
+		// Returns a when mask lanes are set otherwise, b.
+		static inline __m128 Select(const __m128 mask, const __m128 a, const __m128 b)
+		{
+			return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+		}
+
+		static inline __m128 SinPolynomial4(const __m128 r, const __m128 r2)
+		{
+			__m128 p = _mm_add_ps(_mm_set1_ps(8.3321608736e-3f), _mm_mul_ps(r2, _mm_set1_ps(-1.9515295891e-4f)));
+			p = _mm_add_ps(_mm_set1_ps(-1.6666654611e-1f), _mm_mul_ps(r2, p));
+			return _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r2), p));
+		}
+
+		static inline __m128 CosPolynomial4(const __m128 r2)
+		{
+			__m128 p = _mm_add_ps(_mm_set1_ps(-1.388731625493765e-3f), _mm_mul_ps(r2, _mm_set1_ps(2.443315711809948e-5f)));
+			p = _mm_add_ps(_mm_set1_ps(4.166664568298827e-2f), _mm_mul_ps(r2, p));
+			return _mm_add_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(_mm_set1_ps(0.5f), r2)), _mm_mul_ps(_mm_mul_ps(r2, r2), p));
+		}
+
+		static inline __m128i ReduceHalfPi4(const __m128 radians, __m128& outR)
+		{
+			const __m128i k = _mm_cvtps_epi32(_mm_mul_ps(radians, _mm_set1_ps(Detail::TwoOverPi)));
+			const __m128 kf = _mm_cvtepi32_ps(k);
+			__m128 r = _mm_sub_ps(radians, _mm_mul_ps(kf, _mm_set1_ps(Detail::HalfPiPart1)));
+			r = _mm_sub_ps(r, _mm_mul_ps(kf, _mm_set1_ps(Detail::HalfPiPart2)));
+			outR = _mm_sub_ps(r, _mm_mul_ps(kf, _mm_set1_ps(Detail::HalfPiPart3)));
+			return k;
+		}
+
+		// Returns a mask with lanes set where bit of quadrant is set.
+		static inline __m128 QuadrantBitMask4(const __m128i quadrant, const int bit)
+		{
+			const __m128i bitValue = _mm_set1_epi32(bit);
+			return _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, bitValue), bitValue));
+		}
+
+		// Negates lanes of value where bit 1 of quadrant is set.
+		static inline __m128 QuadrantSign4(const __m128i quadrant, const __m128 value)
+		{
+			const __m128i signBits = _mm_slli_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(2)), 30);
+			return _mm_xor_ps(value, _mm_castsi128_ps(signBits));
+		}
+
+		static inline __m128 SinCos4(const __m128 radians, const int quadrantOffset)
+		{
+			__m128 r = {};
+			const __m128i quadrant = _mm_add_epi32(ReduceHalfPi4(radians, r), _mm_set1_epi32(quadrantOffset));
+			const __m128 r2 = _mm_mul_ps(r, r);
+			const __m128 result = Select(QuadrantBitMask4(quadrant, 1), CosPolynomial4(r2), SinPolynomial4(r, r2));
+			return QuadrantSign4(quadrant, result);
+		}
+
+		static inline __m128 ATan2_4(const __m128 y, const __m128 x)
+		{
+			const __m128 signMask = _mm_set1_ps(-0.0f);
+			const __m128 absY = _mm_andnot_ps(signMask, y);
+			const __m128 absX = _mm_andnot_ps(signMask, x);
+			const __m128 numerator = _mm_min_ps(absY, absX);
+			const __m128 denominator = _mm_max_ps(absY, absX);
+			const __m128 t = _mm_and_ps(_mm_cmpgt_ps(denominator, _mm_setzero_ps()), _mm_div_ps(numerator, denominator));
+
+			const __m128 one = _mm_set1_ps(1.0f);
+			const __m128 upperRange = _mm_cmpgt_ps(t, _mm_set1_ps(Detail::TanPiOver8));
+			const __m128 reduced = Select(upperRange, _mm_div_ps(_mm_sub_ps(t, one), _mm_add_ps(t, one)), t);
+
+			const __m128 reduced2 = _mm_mul_ps(reduced, reduced);
+			__m128 p = _mm_add_ps(_mm_set1_ps(-1.38776856032e-1f), _mm_mul_ps(reduced2, _mm_set1_ps(8.05374449538e-2f)));
+			p = _mm_add_ps(_mm_set1_ps(1.99777106478e-1f), _mm_mul_ps(reduced2, p));
+			p = _mm_add_ps(_mm_set1_ps(-3.33329491539e-1f), _mm_mul_ps(reduced2, p));
+			__m128 result = _mm_add_ps(reduced, _mm_mul_ps(_mm_mul_ps(reduced, reduced2), p));
+			result = _mm_add_ps(result, _mm_and_ps(upperRange, _mm_set1_ps(Detail::QuarterPi)));
+
+			result = Select(_mm_cmpgt_ps(absY, absX), _mm_sub_ps(_mm_set1_ps(Detail::HalfPi), result), result);
+			result = Select(_mm_cmplt_ps(x, _mm_setzero_ps()), _mm_sub_ps(_mm_set1_ps(Detail::Pi), result), result);
+			return _mm_or_ps(_mm_andnot_ps(signMask, result), _mm_and_ps(signMask, y));
+		}
+
+		static inline __m128 Exp4(const __m128 x)
+		{
+			const __m128 clamped = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(Detail::ExpMinInput)), _mm_set1_ps(Detail::ExpMaxInput));
+			const __m128i ni = _mm_cvtps_epi32(_mm_mul_ps(clamped, _mm_set1_ps(Detail::Log2E)));
+			const __m128 n = _mm_cvtepi32_ps(ni);
+			__m128 r = _mm_sub_ps(clamped, _mm_mul_ps(n, _mm_set1_ps(Detail::Ln2Part1)));
+			r = _mm_sub_ps(r, _mm_mul_ps(n, _mm_set1_ps(Detail::Ln2Part2)));
+			const __m128 r2 = _mm_mul_ps(r, r);
+
+			__m128 p = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(1.9875691500e-4f), r), _mm_set1_ps(1.3981999507e-3f));
+			p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(8.3334519073e-3f));
+			p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(4.1665795894e-2f));
+			p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(1.6666665459e-1f));
+			p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(5.0000001201e-1f));
+			const __m128 mantissa = _mm_add_ps(_mm_add_ps(_mm_mul_ps(p, r2), r), _mm_set1_ps(1.0f));
+
+			const __m128i exponentBits = _mm_slli_epi32(_mm_add_epi32(ni, _mm_set1_epi32(127)), 23);
+			return _mm_mul_ps(mantissa, _mm_castsi128_ps(exponentBits));
+		}
+
+		static inline __m128 Log4(const __m128 x)
+		{
+			const __m128i bits = _mm_castps_si128(x);
+			__m128i e = _mm_sub_epi32(_mm_and_si128(_mm_srli_epi32(bits, 23), _mm_set1_epi32(0xff)), _mm_set1_epi32(126));
+			__m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f000000)));
+
+			// Move mantissas below sqrt(0.5) into [sqrt(0.5), 1) by doubling them and decrementing the exponent. Set mask lanes are -1.
+			const __m128 belowMask = _mm_cmplt_ps(m, _mm_set1_ps(Detail::Sqrt2Over2));
+			m = _mm_add_ps(m, _mm_and_ps(belowMask, m));
+			e = _mm_add_epi32(e, _mm_castps_si128(belowMask));
+
+			const __m128 f = _mm_sub_ps(m, _mm_set1_ps(1.0f));
+			const __m128 f2 = _mm_mul_ps(f, f);
+			__m128 y = _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(7.0376836292e-2f), f), _mm_set1_ps(1.1514610310e-1f));
+			y = _mm_add_ps(_mm_mul_ps(y, f), _mm_set1_ps(1.1676998740e-1f));
+			y = _mm_sub_ps(_mm_mul_ps(y, f), _mm_set1_ps(1.2420140846e-1f));
+			y = _mm_add_ps(_mm_mul_ps(y, f), _mm_set1_ps(1.4249322787e-1f));
+			y = _mm_sub_ps(_mm_mul_ps(y, f), _mm_set1_ps(1.6668057665e-1f));
+			y = _mm_add_ps(_mm_mul_ps(y, f), _mm_set1_ps(2.0000714765e-1f));
+			y = _mm_sub_ps(_mm_mul_ps(y, f), _mm_set1_ps(2.4999993993e-1f));
+			y = _mm_add_ps(_mm_mul_ps(y, f), _mm_set1_ps(3.3333331174e-1f));
+			y = _mm_mul_ps(_mm_mul_ps(y, f), f2);
+
+			const __m128 exponent = _mm_cvtepi32_ps(e);
+			y = _mm_add_ps(y, _mm_mul_ps(exponent, _mm_set1_ps(Detail::Ln2Part2)));
+			y = _mm_add_ps(y, _mm_mul_ps(_mm_set1_ps(-0.5f), f2));
+			return _mm_add_ps(_mm_add_ps(f, y), _mm_mul_ps(exponent, _mm_set1_ps(Detail::Ln2Part1)));
+		}
+
+		static inline __m128 RSqrt4(const __m128 x)
+		{
+			const __m128 estimate = _mm_rsqrt_ps(x);
+			const __m128 halfXEstimate2 = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), x), estimate), estimate);
+			return _mm_mul_ps(estimate, _mm_sub_ps(_mm_set1_ps(1.5f), halfXEstimate2));
+		}
+#endif // LEVIATHAN_SIMD_SSE.
+
+		void Sin(const float* radians, float* outSin, const size_t count)
+		{
+			size_t i = 0;
+#ifdef LEVIATHAN_SIMD_SSE
+			for (; i + SimdWidth <= count; i += SimdWidth)
+			{
+				_mm_storeu_ps(outSin + i, SinCos4(_mm_loadu_ps(radians + i), 0));
+			}
+#endif // LEVIATHAN_SIMD_SSE.
+			for (; i < count; ++i)
+			{
+				outSin[i] = Sin(radians[i]);
+			}
+		}
+
+		void Cos(const float* radians, float* outCos, const size_t count)
+		{
+			size_t i = 0;
+#ifdef LEVIATHAN_SIMD_SSE
+			for (; i + SimdWidth <= count; i += SimdWidth)
+			{
+				_mm_storeu_ps(outCos + i, SinCos4(_mm_loadu_ps(radians + i), 1));
+			}
+#endif // LEVIATHAN_SIMD_SSE.
+			for (; i < count; ++i)
+			{
+				outCos[i] = Cos(radians[i]);
+			}
+		}
+
+		void SinCos(const float* radians, float* outSin, float* outCos, const size_t count)
+		{
+			size_t i = 0;
+#ifdef LEVIATHAN_SIMD_SSE
+			for (; i + SimdWidth <= count; i += SimdWidth)
+			{
+				__m128 r = {};
+				const __m128i quadrant = ReduceHalfPi4(_mm_loadu_ps(radians + i), r);
+				const __m128 r2 = _mm_mul_ps(r, r);
+				const __m128 s = SinPolynomial4(r, r2);
+				const __m128 c = CosPolynomial4(r2);
+				const __m128 oddQuadrant = QuadrantBitMask4(quadrant, 1);
+				_mm_storeu_ps(outSin + i, QuadrantSign4(quadrant, Select(oddQuadrant, c, s)));
+				_mm_storeu_ps(outCos + i, QuadrantSign4(_mm_add_epi32(quadrant, _mm_set1_epi32(1)), Select(oddQuadrant, s, c)));
+			}
+#endif // LEVIATHAN_SIMD_SSE.
+			for (; i < count; ++i)
+			{
+				SinCos(radians[i], outSin[i], outCos[i]);
+			}
+		}
+
+		void ATan2(const float* y, const float* x, float* outRadians, const size_t count)
+		{
+			size_t i = 0;
+#ifdef LEVIATHAN_SIMD_SSE
+			for (; i + SimdWidth <= count; i += SimdWidth)
+			{
+				_mm_storeu_ps(outRadians + i, ATan2_4(_mm_loadu_ps(y + i), _mm_loadu_ps(x + i)));
+			}
+#endif // LEVIATHAN_SIMD_SSE.
+			for (; i < count; ++i)
+			{
+				outRadians[i] = ATan2(y[i], x[i]);
+			}
+		}
+
+		void Exp(const float* x, float* outExp, const size_t count)
+		{
+			size_t i = 0;
+#ifdef LEVIATHAN_SIMD_SSE
+			for (; i + SimdWidth <= count; i += SimdWidth)
+			{
+				_mm_storeu_ps(outExp + i, Exp4(_mm_loadu_ps(x + i)));
+			}
+#endif // LEVIATHAN_SIMD_SSE.
+			for (; i < count; ++i)
+			{
+				outExp[i] = Exp(x[i]);
+			}
+		}
+
+		void Log(const float* x, float* outLog, const size_t count)
+		{
+			size_t i = 0;
+#ifdef LEVIATHAN_SIMD_SSE
+			for (; i + SimdWidth <= count; i += SimdWidth)
+			{
+				_mm_storeu_ps(outLog + i, Log4(_mm_loadu_ps(x + i)));
+			}
+#endif // LEVIATHAN_SIMD_SSE.
+			for (; i < count; ++i)
+			{
+				outLog[i] = Log(x[i]);
+			}
+		}
+
+		void RSqrt(const float* x, float* outRSqrt, const size_t count)
+		{
+			size_t i = 0;
+#ifdef LEVIATHAN_SIMD_SSE
+			for (; i + SimdWidth <= count; i += SimdWidth)
+			{
+				_mm_storeu_ps(outRSqrt + i, RSqrt4(_mm_loadu_ps(x + i)));
+			}
+#endif // LEVIATHAN_SIMD_SSE.
+			for (; i < count; ++i)
+			{
+				outRSqrt[i] = RSqrt(x[i]);
+			}
+		}
+	}
+}
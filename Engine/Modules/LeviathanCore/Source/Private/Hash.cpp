@@ -0,0 +1,31 @@
+#include "Hash.h"
+
+namespace LeviathanCore
+{
+	namespace Hash
+	{
+		uint64_t HashBytes(const void* data, const size_t sizeBytes)
+		{
+			static constexpr uint64_t prime = 1099511628211ull;
+			uint64_t hash = 14695981039346656037ull ^ sizeBytes;
+
+			const uint8_t* const bytes = static_cast<const uint8_t*>(data);
+			size_t i = 0;
+			for (; i + sizeof(uint64_t) <= sizeBytes; i += sizeof(uint64_t))
+			{
+				uint64_t word = 0;
+				memcpy(&word, bytes + i, sizeof(uint64_t));
+				hash = (hash ^ word) * prime;
+			}
+			for (; i < sizeBytes; ++i)
+			{
+				hash = (hash ^ bytes[i]) * prime;
+			}
+
+			hash ^= hash >> 33;
+			hash *= 0xff51afd7ed558ccdull;
+			hash ^= hash >> 33;
+			return hash;
+		}
+	}
+}
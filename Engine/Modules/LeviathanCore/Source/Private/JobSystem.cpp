@@ -0,0 +1,264 @@
+#include "JobSystem.h"
+
+namespace LeviathanCore
+{
+	namespace JobSystem
+	{
+		// Number of times an idle worker yields while polling for a new parallel for before sleeping. Keeps back to back dispatches within a frame from
+		// paying the cost of a wake up.
+		static constexpr size_t WorkerSpinCount = 256;
+
+		struct ParallelForJob
+		{
+			ParallelForFunctionType Function = nullptr;
+			void* UserData = nullptr;
+			size_t Count = 0;
+			size_t ChunkSize = 0;
+			size_t ChunkCount = 0;
+			std::atomic<size_t> NextChunk = 0;
+		};
+
+		static std::vector<std::thread> gWorkers = {};
+		static std::mutex gWakeMutex = {};
+		static std::condition_variable gWakeCondition = {};
+		// Serializes dispatches from threads outside of the job system.
+		static std::mutex gDispatchMutex = {};
+		static std::atomic<bool> gRunning = false;
+		static std::atomic<uint64_t> gJobGeneration = 0;
+		static std::atomic<ParallelForJob*> gActiveJob = nullptr;
+		static std::atomic<size_t> gBusyWorkerCount = 0;
+
+		// Jobs queued to the background thread in queue order. The background thread runs the queued jobs and exits once stopped.
+		struct BackgroundJob
+		{
+			BackgroundJobFunctionType Function = nullptr;
+			void* UserData = nullptr;
+		};
+		static std::thread gBackgroundWorker = {};
+		static std::mutex gBackgroundMutex = {};
+		static std::condition_variable gBackgroundCondition = {};
+		static std::vector<BackgroundJob> gBackgroundJobs = {};
+		static bool gBackgroundRunning = false;
+
+		static thread_local size_t gThreadIndex = 0;
+		static thread_local bool gInsideRange = false;
+
+		static void ExecuteChunks(ParallelForJob& job, const size_t threadIndex)
+		{
+			for (;;)
+			{
+				const size_t chunk = job.NextChunk.fetch_add(1, std::memory_order_relaxed);
+				if (chunk >= job.ChunkCount)
+				{
+					return;
+				}
+
+				const size_t first = chunk * job.ChunkSize;
+				job.Function(first, std::min(job.ChunkSize, job.Count - first), threadIndex, job.UserData);
+			}
+		}
+
+		static void WorkerMain(const size_t threadIndex)
+		{
+			gThreadIndex = threadIndex;
+			// Workers only ever execute inside a range so nested dispatches run inline.
+			gInsideRange = true;
+
+			uint64_t seenGeneration = 0;
+			for (;;)
+			{
+				// Poll briefly before sleeping.
+				size_t spin = 0;
+				while ((spin < WorkerSpinCount) && gRunning.load() && (gJobGeneration.load() == seenGeneration))
+				{
+					std::this_thread::yield();
+					++spin;
+				}
+
+				{
+					std::unique_lock<std::mutex> lock(gWakeMutex);
+					gWakeCondition.wait(lock, [seenGeneration]() { return (!gRunning.load()) || (gJobGeneration.load() != seenGeneration); });
+				}
+
+				if (!gRunning.load())
+				{
+					return;
+				}
+
+				seenGeneration = gJobGeneration.load();
+
+				// Mark the worker as busy before reading the job so that the dispatching thread cannot return while the job is referenced.
+				gBusyWorkerCount.fetch_add(1);
+				ParallelForJob* const job = gActiveJob.load();
+				if (job)
+				{
+					ExecuteChunks(*job, threadIndex);
+				}
+				gBusyWorkerCount.fetch_sub(1);
+			}
+		}
+
+		static void BackgroundWorkerMain()
+		{
+			std::vector<BackgroundJob> jobs = {};
+			for (;;)
+			{
+				{
+					std::unique_lock<std::mutex> lock(gBackgroundMutex);
+					gBackgroundCondition.wait(lock, []() { return (!gBackgroundRunning) || (!gBackgroundJobs.empty()); });
+					if (gBackgroundJobs.empty())
+					{
+						return;
+					}
+					jobs.swap(gBackgroundJobs);
+				}
+
+				for (const BackgroundJob& job : jobs)
+				{
+					job.Function(job.UserData);
+				}
+				jobs.clear();
+			}
+		}
+
+		bool Initialize(size_t workerCount)
+		{
+			if ((!gWorkers.empty()) || (gBackgroundWorker.joinable()))
+			{
+				return false;
+			}
+
+			if (workerCount == 0)
+			{
+				const unsigned int hardwareThreadCount = std::thread::hardware_concurrency();
+				workerCount = (hardwareThreadCount > 1) ? static_cast<size_t>(hardwareThreadCount - 1) : 0;
+			}
+
+			gRunning.store(true);
+			gWorkers.reserve(workerCount);
+			for (size_t i = 0; i < workerCount; ++i)
+			{
+				// Index 0 is reserved for the dispatching thread.
+				gWorkers.emplace_back(&WorkerMain, i + 1);
+			}
+
+			gBackgroundRunning = true;
+			gBackgroundWorker = std::thread(&BackgroundWorkerMain);
+			return true;
+		}
+
+		void Shutdown()
+		{
+			{
+				std::lock_guard<std::mutex> lock(gWakeMutex);
+				gRunning.store(false);
+			}
+			gWakeCondition.notify_all();
+
+			for (std::thread& worker : gWorkers)
+			{
+				worker.join();
+			}
+			gWorkers.clear();
+
+			if (gBackgroundWorker.joinable())
+			{
+				{
+					std::lock_guard<std::mutex> lock(gBackgroundMutex);
+					gBackgroundRunning = false;
+				}
+				gBackgroundCondition.notify_all();
+				gBackgroundWorker.join();
+			}
+		}
+
+		bool IsInitialized()
+		{
+			return !gWorkers.empty();
+		}
+
+		size_t GetThreadCount()
+		{
+			return gWorkers.size() + 1;
+		}
+
+		void RunInBackground(BackgroundJobFunctionType function, void* userData)
+		{
+			bool queued = false;
+			{
+				std::lock_guard<std::mutex> lock(gBackgroundMutex);
+				if (gBackgroundRunning)
+				{
+					gBackgroundJobs.push_back(BackgroundJob{ .Function = function, .UserData = userData });
+					queued = true;
+				}
+			}
+
+			if (!queued)
+			{
+				function(userData);
+				return;
+			}
+			gBackgroundCondition.notify_one();
+		}
+
+		void ParallelFor(const size_t count, size_t chunkSize, ParallelForFunctionType function, void* userData)
+		{
+			if (count == 0)
+			{
+				return;
+			}
+
+			chunkSize = std::max(chunkSize, static_cast<size_t>(1));
+			const size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+
+			// Nested dispatches run inline on the executing thread so that threadIndex stays unique among running ranges.
+			if (gInsideRange)
+			{
+				for (size_t first = 0; first < count; first += chunkSize)
+				{
+					function(first, std::min(chunkSize, count - first), gThreadIndex, userData);
+				}
+				return;
+			}
+
+			std::lock_guard<std::mutex> dispatchLock(gDispatchMutex);
+
+			if ((gWorkers.empty()) || (chunkCount == 1))
+			{
+				gInsideRange = true;
+				for (size_t first = 0; first < count; first += chunkSize)
+				{
+					function(first, std::min(chunkSize, count - first), 0, userData);
+				}
+				gInsideRange = false;
+				return;
+			}
+
+			ParallelForJob job = {};
+			job.Function = function;
+			job.UserData = userData;
+			job.Count = count;
+			job.ChunkSize = chunkSize;
+			job.ChunkCount = chunkCount;
+
+			gActiveJob.store(&job);
+			{
+				std::lock_guard<std::mutex> lock(gWakeMutex);
+				gJobGeneration.fetch_add(1);
+			}
+			gWakeCondition.notify_all();
+
+			gInsideRange = true;
+			ExecuteChunks(job, 0);
+			gInsideRange = false;
+
+			// Every chunk has been claimed. Wait for workers still executing a chunk.
+			gActiveJob.store(nullptr);
+			while (gBusyWorkerCount.load() != 0)
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+}
@@ -12,6 +12,12 @@
 #include <fstream>
 #include <filesystem>
 #include <string>
+#include <cmath>
+#include <bit>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #ifdef LEVIATHAN_BUILD_PLATFORM_WIN32
 // Win32.
@@ -9,8 +9,13 @@ namespace LeviathanCore
 			va_list args;
 			va_start(args, format);
 
+			// The argument list is consumed by each vsnprintf call so measuring the formatted size requires a copy.
+			va_list sizeArgs;
+			va_copy(sizeArgs, args);
+
 			// Convert format string to a string. Requires heap allocation.
-			size_t size = vsnprintf(nullptr, 0, format, args) + 1;
+			size_t size = vsnprintf(nullptr, 0, format, sizeArgs) + 1;
+			va_end(sizeArgs);
 			std::string buffer;
 			buffer.resize(size);
 			vsnprintf(buffer.data(), size, format, args);
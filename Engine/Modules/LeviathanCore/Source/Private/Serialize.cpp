@@ -88,7 +88,7 @@ namespace LeviathanCore
 		bool ReadFile(std::string_view file, bool binary, std::vector<uint8_t>& outBuffer)
 		{
 			std::ifstream ifStream;
-			ifStream.open(file, ((binary) ? std::ifstream::in | std::ifstream::binary : std::ifstream::in));
+			ifStream.open(std::filesystem::path(file), ((binary) ? std::ifstream::in | std::ifstream::binary : std::ifstream::in));
 
 			if (!ifStream.good())
 			{
@@ -103,6 +103,41 @@ namespace LeviathanCore
 			return true;
 		}
 
+		bool ReadFileRange(std::string_view file, const uint64_t offset, const size_t sizeBytes, std::vector<uint8_t>& outBuffer)
+		{
+			std::ifstream ifStream(std::filesystem::path(file), std::ifstream::in | std::ifstream::binary);
+			if (!ifStream.good())
+			{
+				return false;
+			}
+
+			outBuffer.resize(sizeBytes);
+			ifStream.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
+			ifStream.read(reinterpret_cast<char*>(outBuffer.data()), static_cast<std::streamsize>(sizeBytes));
+			return (ifStream.gcount() == static_cast<std::streamsize>(sizeBytes));
+		}
+
+		bool GetFileStamp(std::string_view file, FileStamp& outStamp)
+		{
+			outStamp = {};
+			std::error_code errorCode = {};
+			const std::filesystem::path path(file);
+			const uintmax_t sizeBytes = std::filesystem::file_size(path, errorCode);
+			if (errorCode)
+			{
+				return false;
+			}
+			const std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(path, errorCode);
+			if (errorCode)
+			{
+				return false;
+			}
+
+			outStamp.SizeBytes = static_cast<uint64_t>(sizeBytes);
+			outStamp.WriteTime = static_cast<int64_t>(writeTime.time_since_epoch().count());
+			return true;
+		}
+
 		bool FileExists(std::string_view file)
 		{
 			return std::filesystem::exists(file);
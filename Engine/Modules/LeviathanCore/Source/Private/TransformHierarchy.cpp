@@ -0,0 +1,393 @@
+#include "TransformHierarchy.h"
+#include "JobSystem.h"
+#include "Simd.h"
+
+namespace LeviathanCore
+{
+	namespace Scene
+	{
+		// Levels with more nodes than this are split across the job system.
+		static constexpr size_t UpdateChunkSize = 2048;
+
+		// Writes parent * translation * rotation * scale to out as a column major matrix, or the local matrix alone if parent is nullptr. The parent is
+		// assumed to be affine so the bottom row of the product is not calculated. The rotation is assumed to be normalized.
+		static void ComposeWorldMatrix(const float* const parent, const MathTypes::Vector3& translation, const MathTypes::Quaternion& rotation,
+			const MathTypes::Vector3& scale, float* const out)
+		{
+			const float x = rotation.X();
+			const float y = rotation.Y();
+			const float z = rotation.Z();
+			const float w = rotation.W();
+			const float xx = x * x;
+			const float yy = y * y;
+			const float zz = z * z;
+			const float xy = x * y;
+			const float xz = x * z;
+			const float yz = y * z;
+			const float wx = w * x;
+			const float wy = w * y;
+			const float wz = w * z;
+
+			// Upper 3x3 of the local matrix by column.
+			const float local[3][3] =
+			{
+				{ (1.0f - 2.0f * (yy + zz)) * scale.X(), (2.0f * (xy + wz)) * scale.X(), (2.0f * (xz - wy)) * scale.X() },
+				{ (2.0f * (xy - wz)) * scale.Y(), (1.0f - 2.0f * (xx + zz)) * scale.Y(), (2.0f * (yz + wx)) * scale.Y() },
+				{ (2.0f * (xz + wy)) * scale.Z(), (2.0f * (yz - wx)) * scale.Z(), (1.0f - 2.0f * (xx + yy)) * scale.Z() }
+			};
+
+			if (parent == nullptr)
+			{
+				for (size_t column = 0; column < 3; ++column)
+				{
+					out[column * 4 + 0] = local[column][0];
+					out[column * 4 + 1] = local[column][1];
+					out[column * 4 + 2] = local[column][2];
+					out[column * 4 + 3] = 0.0f;
+				}
+				out[12] = translation.X();
+				out[13] = translation.Y();
+				out[14] = translation.Z();
+				out[15] = 1.0f;
+				return;
+			}
+
+#ifdef LEVIATHAN_SIMD_SSE
+			const __m128 parent0 = _mm_loadu_ps(parent + 0);
+			const __m128 parent1 = _mm_loadu_ps(parent + 4);
+			const __m128 parent2 = _mm_loadu_ps(parent + 8);
+			const __m128 parent3 = _mm_loadu_ps(parent + 12);
+
+			for (size_t column = 0; column < 3; ++column)
+			{
+				const __m128 result = _mm_add_ps(_mm_add_ps(_mm_mul_ps(parent0, _mm_set1_ps(local[column][0])), _mm_mul_ps(parent1, _mm_set1_ps(local[column][1]))),
+					_mm_mul_ps(parent2, _mm_set1_ps(local[column][2])));
+				_mm_storeu_ps(out + column * 4, result);
+			}
+
+			const __m128 translated = _mm_add_ps(_mm_add_ps(_mm_mul_ps(parent0, _mm_set1_ps(translation.X())), _mm_mul_ps(parent1, _mm_set1_ps(translation.Y()))),
+				_mm_add_ps(_mm_mul_ps(parent2, _mm_set1_ps(translation.Z())), parent3));
+			_mm_storeu_ps(out + 12, translated);
+#else
+			for (size_t row = 0; row < 4; ++row)
+			{
+				for (size_t column = 0; column < 3; ++column)
+				{
+					out[column * 4 + row] = parent[row] * local[column][0] + parent[4 + row] * local[column][1] + parent[8 + row] * local[column][2];
+				}
+				out[12 + row] = parent[row] * translation.X() + parent[4 + row] * translation.Y() + parent[8 + row] * translation.Z() + parent[12 + row];
+			}
+#endif // LEVIATHAN_SIMD_SSE.
+		}
+
+		TransformHierarchy::NodeId TransformHierarchy::CreateNode(const NodeId parent)
+		{
+			const uint32_t parentIndex = (parent == InvalidNodeId) ? InvalidIndex : GetIndex(parent);
+			const uint32_t index = static_cast<uint32_t>(Parents.size());
+
+			NodeId node = InvalidNodeId;
+			if (FreeNodeIds.empty())
+			{
+				node = static_cast<NodeId>(NodeToIndex.size());
+				NodeToIndex.push_back(index);
+			}
+			else
+			{
+				node = FreeNodeIds.back();
+				FreeNodeIds.pop_back();
+				NodeToIndex[node] = index;
+			}
+
+			Parents.push_back(parentIndex);
+			LocalTranslations.emplace_back(0.0f, 0.0f, 0.0f);
+			LocalRotations.push_back(MathTypes::Quaternion::Identity());
+			LocalScales.emplace_back(1.0f, 1.0f, 1.0f);
+			WorldMatrices.push_back(MathTypes::Matrix4x4::Identity());
+			Flags.push_back(LocalDirtyFlag);
+			IndexToNode.push_back(node);
+
+			StructureChanged = true;
+			return node;
+		}
+
+		void TransformHierarchy::DestroyNode(const NodeId node)
+		{
+			Flags[GetIndex(node)] |= DestroyedFlag;
+			StructureChanged = true;
+		}
+
+		bool TransformHierarchy::SetParent(const NodeId node, const NodeId parent)
+		{
+			const uint32_t index = GetIndex(node);
+			const uint32_t parentIndex = (parent == InvalidNodeId) ? InvalidIndex : GetIndex(parent);
+
+			for (uint32_t ancestor = parentIndex; ancestor != InvalidIndex; ancestor = Parents[ancestor])
+			{
+				if (ancestor == index)
+				{
+					return false;
+				}
+			}
+
+			Parents[index] = parentIndex;
+			Flags[index] |= LocalDirtyFlag;
+			StructureChanged = true;
+			return true;
+		}
+
+		TransformHierarchy::NodeId TransformHierarchy::GetParent(const NodeId node) const
+		{
+			const uint32_t parentIndex = Parents[GetIndex(node)];
+			return (parentIndex == InvalidIndex) ? InvalidNodeId : IndexToNode[parentIndex];
+		}
+
+		void TransformHierarchy::SetLocalTransform(const NodeId node, const MathTypes::Vector3& translation, const MathTypes::Quaternion& rotation, const MathTypes::Vector3& scale)
+		{
+			const uint32_t index = GetIndex(node);
+			LocalTranslations[index] = translation;
+			LocalRotations[index] = rotation;
+			LocalScales[index] = scale;
+			MarkLocalDirty(index);
+		}
+
+		void TransformHierarchy::SetLocalTranslation(const NodeId node, const MathTypes::Vector3& translation)
+		{
+			const uint32_t index = GetIndex(node);
+			LocalTranslations[index] = translation;
+			MarkLocalDirty(index);
+		}
+
+		void TransformHierarchy::SetLocalRotation(const NodeId node, const MathTypes::Quaternion& rotation)
+		{
+			const uint32_t index = GetIndex(node);
+			LocalRotations[index] = rotation;
+			MarkLocalDirty(index);
+		}
+
+		void TransformHierarchy::SetLocalScale(const NodeId node, const MathTypes::Vector3& scale)
+		{
+			const uint32_t index = GetIndex(node);
+			LocalScales[index] = scale;
+			MarkLocalDirty(index);
+		}
+
+		void TransformHierarchy::Update()
+		{
+			if (StructureChanged)
+			{
+				Rebuild();
+			}
+
+			// A level is skipped when none of its nodes were set and no world matrix in the level above changed.
+			bool parentLevelChanged = false;
+			for (size_t level = 0; level < GetLevelCount(); ++level)
+			{
+				const size_t first = LevelOffsets[level];
+				const size_t count = LevelOffsets[level + 1] - first;
+
+				if ((LevelDirty[level] == 0) && (!parentLevelChanged))
+				{
+					if (LevelWorldChanged[level] != 0)
+					{
+						std::fill(Flags.begin() + first, Flags.begin() + first + count, static_cast<uint8_t>(0));
+						LevelWorldChanged[level] = 0;
+					}
+					continue;
+				}
+
+				bool levelChanged = false;
+				if (count <= UpdateChunkSize)
+				{
+					levelChanged = UpdateRange(first, count);
+				}
+				else
+				{
+					ScratchThreadChanged.assign(JobSystem::GetThreadCount(), 0);
+					JobSystem::ParallelFor(count, UpdateChunkSize, [this, first](const size_t rangeFirst, const size_t rangeCount, const size_t threadIndex)
+						{
+							if (UpdateRange(first + rangeFirst, rangeCount))
+							{
+								ScratchThreadChanged[threadIndex] = 1;
+							}
+						});
+					levelChanged = std::find(ScratchThreadChanged.begin(), ScratchThreadChanged.end(), static_cast<uint8_t>(1)) != ScratchThreadChanged.end();
+				}
+
+				LevelDirty[level] = 0;
+				LevelWorldChanged[level] = levelChanged ? 1 : 0;
+				parentLevelChanged = levelChanged;
+			}
+		}
+
+		void TransformHierarchy::Clear()
+		{
+			Parents.clear();
+			LocalTranslations.clear();
+			LocalRotations.clear();
+			LocalScales.clear();
+			WorldMatrices.clear();
+			Flags.clear();
+			IndexToNode.clear();
+			NodeToIndex.clear();
+			FreeNodeIds.clear();
+			LevelOffsets.assign(1, 0);
+			LevelDirty.clear();
+			LevelWorldChanged.clear();
+			StructureChanged = false;
+		}
+
+		void TransformHierarchy::MarkLocalDirty(const uint32_t index)
+		{
+			Flags[index] |= LocalDirtyFlag;
+
+			// Rebuild finds the dirty levels from the flags after a structural change.
+			if (!StructureChanged)
+			{
+				const auto levelEnd = std::upper_bound(LevelOffsets.begin() + 1, LevelOffsets.end(), index);
+				LevelDirty[static_cast<size_t>(levelEnd - (LevelOffsets.begin() + 1))] = 1;
+			}
+		}
+
+		void TransformHierarchy::Rebuild()
+		{
+			const uint32_t nodeCount = static_cast<uint32_t>(Parents.size());
+
+			// Gather the children of every node in storage order.
+			ScratchChildOffsets.assign(static_cast<size_t>(nodeCount) + 1, 0);
+			for (uint32_t index = 0; index < nodeCount; ++index)
+			{
+				if (Parents[index] != InvalidIndex)
+				{
+					++ScratchChildOffsets[Parents[index] + 1];
+				}
+			}
+			for (uint32_t index = 0; index < nodeCount; ++index)
+			{
+				ScratchChildOffsets[index + 1] += ScratchChildOffsets[index];
+			}
+			ScratchChildren.resize(ScratchChildOffsets[nodeCount]);
+			std::vector<uint32_t> childCursors(ScratchChildOffsets.begin(), ScratchChildOffsets.end() - 1);
+			for (uint32_t index = 0; index < nodeCount; ++index)
+			{
+				if (Parents[index] != InvalidIndex)
+				{
+					ScratchChildren[childCursors[Parents[index]]++] = index;
+				}
+			}
+
+			// Breadth first order sorts nodes by depth and keeps siblings next to each other with their parents in increasing order, so the update reads
+			// parent world matrices sequentially. Destroyed nodes are not visited which also drops their descendants. ScratchOrder maps new storage indices
+			// to old ones.
+			ScratchOrder.clear();
+			for (uint32_t index = 0; index < nodeCount; ++index)
+			{
+				if ((Parents[index] == InvalidIndex) && ((Flags[index] & DestroyedFlag) == 0))
+				{
+					ScratchOrder.push_back(index);
+				}
+			}
+
+			LevelOffsets.assign(1, 0);
+			size_t levelFirst = 0;
+			while (levelFirst < ScratchOrder.size())
+			{
+				const size_t levelLast = ScratchOrder.size();
+				LevelOffsets.push_back(static_cast<uint32_t>(levelLast));
+				for (size_t order = levelFirst; order < levelLast; ++order)
+				{
+					const uint32_t index = ScratchOrder[order];
+					for (uint32_t child = ScratchChildOffsets[index]; child < ScratchChildOffsets[index + 1]; ++child)
+					{
+						if ((Flags[ScratchChildren[child]] & DestroyedFlag) == 0)
+						{
+							ScratchOrder.push_back(ScratchChildren[child]);
+						}
+					}
+				}
+				levelFirst = levelLast;
+			}
+
+			// Release the ids of nodes that were not visited.
+			for (uint32_t index = 0; index < nodeCount; ++index)
+			{
+				NodeToIndex[IndexToNode[index]] = InvalidIndex;
+			}
+			for (uint32_t newIndex = 0; newIndex < ScratchOrder.size(); ++newIndex)
+			{
+				NodeToIndex[IndexToNode[ScratchOrder[newIndex]]] = newIndex;
+			}
+			for (uint32_t index = 0; index < nodeCount; ++index)
+			{
+				if (NodeToIndex[IndexToNode[index]] == InvalidIndex)
+				{
+					FreeNodeIds.push_back(IndexToNode[index]);
+				}
+			}
+
+			const size_t survivorCount = ScratchOrder.size();
+			std::vector<uint32_t> parents(survivorCount);
+			std::vector<MathTypes::Vector3> localTranslations(survivorCount);
+			std::vector<MathTypes::Quaternion> localRotations(survivorCount);
+			std::vector<MathTypes::Vector3> localScales(survivorCount);
+			std::vector<MathTypes::Matrix4x4> worldMatrices(survivorCount);
+			std::vector<uint8_t> flags(survivorCount);
+			std::vector<NodeId> indexToNode(survivorCount);
+			for (size_t newIndex = 0; newIndex < survivorCount; ++newIndex)
+			{
+				const uint32_t index = ScratchOrder[newIndex];
+				parents[newIndex] = (Parents[index] == InvalidIndex) ? InvalidIndex : NodeToIndex[IndexToNode[Parents[index]]];
+				localTranslations[newIndex] = LocalTranslations[index];
+				localRotations[newIndex] = LocalRotations[index];
+				localScales[newIndex] = LocalScales[index];
+				worldMatrices[newIndex] = WorldMatrices[index];
+				flags[newIndex] = Flags[index] & LocalDirtyFlag;
+				indexToNode[newIndex] = IndexToNode[index];
+			}
+
+			Parents = std::move(parents);
+			LocalTranslations = std::move(localTranslations);
+			LocalRotations = std::move(localRotations);
+			LocalScales = std::move(localScales);
+			WorldMatrices = std::move(worldMatrices);
+			Flags = std::move(flags);
+			IndexToNode = std::move(indexToNode);
+
+			const size_t levelCount = GetLevelCount();
+			LevelDirty.assign(levelCount, 0);
+			LevelWorldChanged.assign(levelCount, 0);
+			for (size_t level = 0; level < levelCount; ++level)
+			{
+				for (uint32_t index = LevelOffsets[level]; index < LevelOffsets[level + 1]; ++index)
+				{
+					if (Flags[index] != 0)
+					{
+						LevelDirty[level] = 1;
+						break;
+					}
+				}
+			}
+
+			StructureChanged = false;
+		}
+
+		bool TransformHierarchy::UpdateRange(const size_t first, const size_t count)
+		{
+			// Parents are in the level above so their flags and world matrices are final while this level is updated.
+			bool anyChanged = false;
+			for (size_t index = first; index < first + count; ++index)
+			{
+				const uint32_t parent = Parents[index];
+				const bool changed = ((Flags[index] & LocalDirtyFlag) != 0) || ((parent != InvalidIndex) && ((Flags[parent] & WorldChangedFlag) != 0));
+				if (changed)
+				{
+					ComposeWorldMatrix((parent == InvalidIndex) ? nullptr : WorldMatrices[parent].Data(), LocalTranslations[index], LocalRotations[index],
+						LocalScales[index], WorldMatrices[index].Data());
+				}
+
+				Flags[index] = changed ? WorldChangedFlag : 0;
+				anyChanged = anyChanged || changed;
+			}
+			return anyChanged;
+		}
+	}
+}
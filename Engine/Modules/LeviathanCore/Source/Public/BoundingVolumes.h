@@ -0,0 +1,232 @@
+#pragma once
+
+#include "MathTypes.h"
+
+namespace LeviathanCore
+{
+	namespace BoundingVolumes
+	{
+		enum class Containment : uint8_t
+		{
+			Outside,
+			Intersects,
+			Inside
+		};
+
+		// Axis aligned bounding box.
+		struct AABB
+		{
+			MathTypes::Vector3 Min = {};
+			MathTypes::Vector3 Max = {};
+
+			// Returns the smallest box containing every point. Returns a zero size box at the origin if count is 0.
+			static AABB FromPoints(const MathTypes::Vector3* const points, const size_t count);
+
+			// Returns the smallest box containing both boxes.
+			static AABB Merge(const AABB& a, const AABB& b);
+
+			MathTypes::Vector3 Center() const;
+			MathTypes::Vector3 HalfExtents() const;
+			float SurfaceArea() const;
+
+			// Returns the axis aligned box enclosing this box after transformation by the matrix.
+			AABB Transformed(const MathTypes::Matrix4x4& transform) const;
+
+			bool Contains(const MathTypes::Vector3& point) const;
+			bool Contains(const AABB& other) const;
+			bool Intersects(const AABB& other) const;
+
+			// Returns the squared distance from the point to the closest point in the box. Returns 0 for points inside the box.
+			float SquaredDistance(const MathTypes::Vector3& point) const;
+		};
+
+		struct Sphere
+		{
+			MathTypes::Vector3 Center = {};
+			float Radius = 0.0f;
+
+			// Returns a sphere centered on the box enclosing every point with the radius of the furthest point.
+			static Sphere FromPoints(const MathTypes::Vector3* const points, const size_t count);
+
+			// Returns the sphere enclosing this sphere after transformation by the matrix. Non-uniform scale grows the radius by the largest axis scale.
+			Sphere Transformed(const MathTypes::Matrix4x4& transform) const;
+
+			bool Intersects(const Sphere& other) const;
+			bool Intersects(const AABB& aabb) const;
+		};
+
+		// Oriented bounding box. Axes are unit length and orthogonal.
+		struct OBB
+		{
+			MathTypes::Vector3 Center = {};
+			MathTypes::Vector3 HalfExtents = {};
+			std::array<MathTypes::Vector3, 3> Axes = { MathTypes::Vector3(1.0f, 0.0f, 0.0f), MathTypes::Vector3(0.0f, 1.0f, 0.0f), MathTypes::Vector3(0.0f, 0.0f, 1.0f) };
+
+			// Returns the box after transformation by the matrix. Scale is moved from the axes into the half extents.
+			static OBB FromAABB(const AABB& aabb, const MathTypes::Matrix4x4& transform);
+
+			// Separating axis test against the 15 candidate axes.
+			bool Intersects(const OBB& other) const;
+		};
+
+		// Plane satisfying Dot(Normal, point) + Distance = 0. Points on the side the normal faces have positive signed distances.
+		struct Plane
+		{
+			MathTypes::Vector3 Normal = {};
+			float Distance = 0.0f;
+
+			static Plane FromPointNormal(const MathTypes::Vector3& point, const MathTypes::Vector3& normal);
+
+			// Returns the plane scaled so that the normal has unit length.
+			Plane Normalized() const;
+
+			float SignedDistance(const MathTypes::Vector3& point) const;
+		};
+
+		struct Ray
+		{
+			MathTypes::Vector3 Origin = {};
+			// Does not need to be unit length. Distances are returned in multiples of the direction length.
+			MathTypes::Vector3 Direction = {};
+
+			// Returns true if the ray hits the box within [0, maxDistance] and returns the entry distance in outDistance (0 if the origin is inside).
+			bool Intersects(const AABB& aabb, const float maxDistance, float& outDistance) const;
+
+			// Returns true if the ray hits the sphere within [0, maxDistance] and returns the entry distance in outDistance (0 if the origin is inside).
+			bool Intersects(const Sphere& sphere, const float maxDistance, float& outDistance) const;
+		};
+
+		// Cone capped by the sphere of radius Range around its apex, e.g. the volume lit by a spot light. AngleRadians is the half angle between the
+		// axis and the surface and must be below 90 degrees. Direction is unit length.
+		struct Cone
+		{
+			MathTypes::Vector3 Apex = {};
+			MathTypes::Vector3 Direction = { 0.0f, 0.0f, 1.0f };
+			float AngleRadians = 0.0f;
+			float Range = 0.0f;
+
+			bool Intersects(const Sphere& sphere) const;
+			// Tests the box's bounding sphere, so boxes near the cone's surface may be classified as intersecting when they are outside.
+			bool Intersects(const AABB& aabb) const;
+		};
+
+		// Six inward facing planes. Volumes are considered intersecting when they are not fully outside any plane, which is conservative near the
+		// frustum corners.
+		struct Frustum
+		{
+			enum PlaneIndex : size_t
+			{
+				Left = 0,
+				Right,
+				Bottom,
+				Top,
+				Near,
+				Far,
+				PlaneCount
+			};
+
+			std::array<Plane, PlaneCount> Planes = {};
+
+			// Extracts the normalized planes from a column vector view projection matrix with clip space depth in [0, 1] (Gribb-Hartmann).
+			static Frustum FromViewProjection(const MathTypes::Matrix4x4& viewProjection);
+
+			bool Intersects(const MathTypes::Vector3& point) const;
+			bool Intersects(const Sphere& sphere) const;
+			bool Intersects(const AABB& aabb) const;
+			bool Intersects(const OBB& obb) const;
+
+			// Returns whether the box is fully outside, fully inside or straddling the frustum. Like Intersects, boxes near the frustum corners may be
+			// classified as intersecting when they are outside.
+			Containment Classify(const AABB& aabb) const;
+		};
+
+		// Read only structure of arrays view over bounding spheres. Each array must hold at least Count elements.
+		struct SphereSoA
+		{
+			const float* CenterX = nullptr;
+			const float* CenterY = nullptr;
+			const float* CenterZ = nullptr;
+			const float* Radius = nullptr;
+			size_t Count = 0;
+		};
+
+		// Read only structure of arrays view over axis aligned bounding boxes. Each array must hold at least Count elements.
+		struct AABBSoA
+		{
+			const float* MinX = nullptr;
+			const float* MinY = nullptr;
+			const float* MinZ = nullptr;
+			const float* MaxX = nullptr;
+			const float* MaxY = nullptr;
+			const float* MaxZ = nullptr;
+			size_t Count = 0;
+		};
+
+		// Owning structure of arrays storage for bounding spheres.
+		class SphereArray
+		{
+		private:
+			std::vector<float> CenterX = {};
+			std::vector<float> CenterY = {};
+			std::vector<float> CenterZ = {};
+			std::vector<float> Radius = {};
+
+		public:
+			void Add(const Sphere& sphere);
+			void Set(const size_t index, const Sphere& sphere);
+			Sphere Get(const size_t index) const;
+			void Resize(const size_t count);
+			void Clear();
+
+			inline size_t Size() const { return Radius.size(); }
+			SphereSoA View() const;
+		};
+
+		// Owning structure of arrays storage for axis aligned bounding boxes.
+		class AABBArray
+		{
+		private:
+			std::vector<float> MinX = {};
+			std::vector<float> MinY = {};
+			std::vector<float> MinZ = {};
+			std::vector<float> MaxX = {};
+			std::vector<float> MaxY = {};
+			std::vector<float> MaxZ = {};
+
+		public:
+			void Add(const AABB& aabb);
+			void Set(const size_t index, const AABB& aabb);
+			AABB Get(const size_t index) const;
+			void Resize(const size_t count);
+			void Clear();
+
+			inline size_t Size() const { return MinX.size(); }
+			AABBSoA View() const;
+		};
+
+		// Batched tests over the element range [first, first + count) of a structure of arrays view. outResults[i] receives 1 for element first + i
+		// when the test passes otherwise, 0. Four elements are tested per iteration with SSE when available.
+
+		// Tests spheres against the frustum.
+		void TestFrustumSpheres(const Frustum& frustum, const SphereSoA& spheres, const size_t first, const size_t count, uint8_t* outResults);
+
+		// Tests axis aligned boxes against the frustum.
+		void TestFrustumAABBs(const Frustum& frustum, const AABBSoA& aabbs, const size_t first, const size_t count, uint8_t* outResults);
+
+		// Tests axis aligned boxes for overlap with the query box.
+		void TestAABBAABBs(const AABB& query, const AABBSoA& aabbs, const size_t first, const size_t count, uint8_t* outResults);
+
+		// Tests spheres for overlap with the query box.
+		void TestAABBSpheres(const AABB& query, const SphereSoA& spheres, const size_t first, const size_t count, uint8_t* outResults);
+
+		// Tests axis aligned boxes for overlap with the query sphere.
+		void TestSphereAABBs(const Sphere& query, const AABBSoA& aabbs, const size_t first, const size_t count, uint8_t* outResults);
+
+		// Tests axis aligned boxes against the cone through their bounding spheres like Cone::Intersects.
+		void TestConeAABBs(const Cone& query, const AABBSoA& aabbs, const size_t first, const size_t count, uint8_t* outResults);
+
+		// Tests the ray against axis aligned boxes within [0, maxDistance]. outDistances is optional and receives the entry distance for hits.
+		void TestRayAABBs(const Ray& ray, const float maxDistance, const AABBSoA& aabbs, const size_t first, const size_t count, uint8_t* outResults,
+			float* outDistances);
+	}
+}
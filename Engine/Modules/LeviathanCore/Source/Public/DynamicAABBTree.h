@@ -0,0 +1,325 @@
+#pragma once
+
+#include "BoundingVolumes.h"
+#include "LeviathanAssert.h"
+
+namespace LeviathanCore
+{
+	namespace DataStructures
+	{
+		// Dynamic bounding volume hierarchy of axis aligned boxes for broad phase spatial queries over moving objects. Each proxy is stored in a leaf with a
+		// box enlarged by a margin so that small movements do not modify the tree. Leaves are inserted next to the sibling with the lowest surface area
+		// cost and the tree is kept balanced with rotations. Queries traverse with an explicit stack and do not allocate.
+		class DynamicAABBTree
+		{
+		public:
+			using ProxyId = int32_t;
+			static constexpr ProxyId InvalidProxyId = -1;
+
+		private:
+			static constexpr int32_t NullNode = -1;
+
+			struct Node
+			{
+				BoundingVolumes::AABB Box = {};
+				uint64_t UserData = 0;
+				// Parent node while allocated, next free node while in the free list.
+				int32_t ParentOrNext = NullNode;
+				int32_t Child1 = NullNode;
+				int32_t Child2 = NullNode;
+				// Leaves have a height of 0 and free nodes have a height of -1.
+				int32_t Height = -1;
+
+				inline bool IsLeaf() const { return Child1 == NullNode; }
+			};
+
+			// Node index stack that only allocates when the traversal is deeper than the inline capacity, which a balanced tree does not reach.
+			class TraversalStack
+			{
+			private:
+				static constexpr size_t InlineCapacity = 256;
+
+				std::array<int32_t, InlineCapacity> Inline = {};
+				std::vector<int32_t> Overflow = {};
+				size_t Count = 0;
+
+			public:
+				inline void Push(const int32_t node)
+				{
+					if (Count < InlineCapacity)
+					{
+						Inline[Count] = node;
+					}
+					else
+					{
+						Overflow.push_back(node);
+					}
+					++Count;
+				}
+
+				inline int32_t Pop()
+				{
+					--Count;
+					if (Count < InlineCapacity)
+					{
+						return Inline[Count];
+					}
+
+					const int32_t node = Overflow.back();
+					Overflow.pop_back();
+					return node;
+				}
+
+				inline bool IsEmpty() const { return Count == 0; }
+			};
+
+			std::vector<Node> Nodes = {};
+			int32_t Root = NullNode;
+			int32_t FreeList = NullNode;
+			size_t ProxyCount = 0;
+			float Margin = 0.1f;
+
+		public:
+			// margin is added to every side of proxy boxes.
+			DynamicAABBTree(const float margin = 0.1f);
+
+			ProxyId CreateProxy(const BoundingVolumes::AABB& aabb, const uint64_t userData);
+			void DestroyProxy(const ProxyId proxyId);
+
+			// Updates the box of the proxy. The leaf is only reinserted when aabb is no longer inside the enlarged box or the enlarged box has become much
+			// larger than aabb. displacement is the expected movement until the next update and extends the enlarged box in that direction. Returns true
+			// if the leaf was reinserted.
+			bool MoveProxy(const ProxyId proxyId, const BoundingVolumes::AABB& aabb, const MathTypes::Vector3& displacement = MathTypes::Vector3(0.0f, 0.0f, 0.0f));
+
+			void Clear();
+
+			inline uint64_t GetUserData(const ProxyId proxyId) const { LEVIATHAN_ASSERT(IsProxy(proxyId)); return Nodes[proxyId].UserData; }
+			inline const BoundingVolumes::AABB& GetFatAABB(const ProxyId proxyId) const { LEVIATHAN_ASSERT(IsProxy(proxyId)); return Nodes[proxyId].Box; }
+			inline size_t GetProxyCount() const { return ProxyCount; }
+			inline int32_t GetHeight() const { return (Root == NullNode) ? 0 : Nodes[Root].Height; }
+
+			// Returns the summed surface area of the internal nodes divided by the surface area of the root. Lower values give cheaper queries.
+			float GetAreaRatio() const;
+
+			// Returns true if parent links, heights and boxes are consistent. Intended for debugging.
+			bool Validate() const;
+
+			// Calls bool callback(ProxyId) for every proxy whose enlarged box overlaps aabb. Traversal stops when the callback returns false.
+			template <typename Callback>
+			void QueryOverlap(const BoundingVolumes::AABB& aabb, const Callback& callback) const
+			{
+				if (Root == NullNode)
+				{
+					return;
+				}
+
+				TraversalStack stack = {};
+				stack.Push(Root);
+				while (!stack.IsEmpty())
+				{
+					const Node& node = Nodes[stack.Pop()];
+					if (!node.Box.Intersects(aabb))
+					{
+						continue;
+					}
+
+					if (node.IsLeaf())
+					{
+						if (!callback(static_cast<ProxyId>(&node - Nodes.data())))
+						{
+							return;
+						}
+					}
+					else
+					{
+						stack.Push(node.Child1);
+						stack.Push(node.Child2);
+					}
+				}
+			}
+
+			// Calls bool callback(ProxyId) for every proxy whose enlarged box intersects the frustum. Subtrees fully inside the frustum are reported without
+			// further plane tests. Traversal stops when the callback returns false.
+			template <typename Callback>
+			void QueryFrustum(const BoundingVolumes::Frustum& frustum, const Callback& callback) const
+			{
+				if (Root == NullNode)
+				{
+					return;
+				}
+
+				TraversalStack stack = {};
+				TraversalStack insideStack = {};
+				stack.Push(Root);
+				while (!stack.IsEmpty())
+				{
+					const int32_t nodeIndex = stack.Pop();
+					const Node& node = Nodes[nodeIndex];
+					const BoundingVolumes::Containment containment = frustum.Classify(node.Box);
+					if (containment == BoundingVolumes::Containment::Outside)
+					{
+						continue;
+					}
+
+					if (node.IsLeaf())
+					{
+						if (!callback(static_cast<ProxyId>(nodeIndex)))
+						{
+							return;
+						}
+					}
+					else if (containment == BoundingVolumes::Containment::Inside)
+					{
+						insideStack.Push(nodeIndex);
+						while (!insideStack.IsEmpty())
+						{
+							const int32_t insideIndex = insideStack.Pop();
+							const Node& insideNode = Nodes[insideIndex];
+							if (insideNode.IsLeaf())
+							{
+								if (!callback(static_cast<ProxyId>(insideIndex)))
+								{
+									return;
+								}
+							}
+							else
+							{
+								insideStack.Push(insideNode.Child1);
+								insideStack.Push(insideNode.Child2);
+							}
+						}
+					}
+					else
+					{
+						stack.Push(node.Child1);
+						stack.Push(node.Child2);
+					}
+				}
+			}
+
+			// Calls float callback(ProxyId, float maxDistance) for every proxy whose enlarged box is hit by the ray within maxDistance. The callback
+			// returns the new max distance: the hit distance to clip the ray, maxDistance to continue unchanged or a negative value to stop.
+			template <typename Callback>
+			void RayCast(const BoundingVolumes::Ray& ray, float maxDistance, const Callback& callback) const
+			{
+				if (Root == NullNode)
+				{
+					return;
+				}
+
+				const float origin[3] = { ray.Origin.X(), ray.Origin.Y(), ray.Origin.Z() };
+				const float inverseDirection[3] = { 1.0f / ray.Direction.X(), 1.0f / ray.Direction.Y(), 1.0f / ray.Direction.Z() };
+
+				TraversalStack stack = {};
+				stack.Push(Root);
+				while (!stack.IsEmpty())
+				{
+					const int32_t nodeIndex = stack.Pop();
+					const Node& node = Nodes[nodeIndex];
+
+					// Slab test.
+					float nearDistance = 0.0f;
+					float farDistance = maxDistance;
+					for (size_t axis = 0; axis < 3; ++axis)
+					{
+						const float t1 = (node.Box.Min.Data()[axis] - origin[axis]) * inverseDirection[axis];
+						const float t2 = (node.Box.Max.Data()[axis] - origin[axis]) * inverseDirection[axis];
+						nearDistance = std::max(nearDistance, std::min(t1, t2));
+						farDistance = std::min(farDistance, std::max(t1, t2));
+					}
+					if (nearDistance > farDistance)
+					{
+						continue;
+					}
+
+					if (node.IsLeaf())
+					{
+						const float newMaxDistance = callback(static_cast<ProxyId>(nodeIndex), maxDistance);
+						if (newMaxDistance < 0.0f)
+						{
+							return;
+						}
+						maxDistance = std::min(maxDistance, newMaxDistance);
+					}
+					else
+					{
+						stack.Push(node.Child1);
+						stack.Push(node.Child2);
+					}
+				}
+			}
+
+			// Finds the proxy closest to the point within maxDistance. squaredDistance is float(ProxyId) and returns the squared distance from the point to
+			// the proxy's object, which must not be less than the squared distance to the proxy's enlarged box. Returns false if no proxy is within
+			// maxDistance.
+			template <typename SquaredDistanceFunction>
+			bool FindNearest(const MathTypes::Vector3& point, const float maxDistance, const SquaredDistanceFunction& squaredDistance, ProxyId& outProxyId,
+				float& outDistance) const
+			{
+				outProxyId = InvalidProxyId;
+				if (Root == NullNode)
+				{
+					return false;
+				}
+
+				float bestSquaredDistance = maxDistance * maxDistance;
+
+				TraversalStack stack = {};
+				stack.Push(Root);
+				while (!stack.IsEmpty())
+				{
+					const int32_t nodeIndex = stack.Pop();
+					const Node& node = Nodes[nodeIndex];
+					if (node.Box.SquaredDistance(point) > bestSquaredDistance)
+					{
+						continue;
+					}
+
+					if (node.IsLeaf())
+					{
+						const float proxySquaredDistance = squaredDistance(static_cast<ProxyId>(nodeIndex));
+						if (proxySquaredDistance <= bestSquaredDistance)
+						{
+							bestSquaredDistance = proxySquaredDistance;
+							outProxyId = static_cast<ProxyId>(nodeIndex);
+						}
+					}
+					else
+					{
+						// Visit the closer child first so that the best distance shrinks sooner.
+						const float child1SquaredDistance = Nodes[node.Child1].Box.SquaredDistance(point);
+						const float child2SquaredDistance = Nodes[node.Child2].Box.SquaredDistance(point);
+						const bool child1First = (child1SquaredDistance <= child2SquaredDistance);
+						stack.Push(child1First ? node.Child2 : node.Child1);
+						stack.Push(child1First ? node.Child1 : node.Child2);
+					}
+				}
+
+				if (outProxyId == InvalidProxyId)
+				{
+					return false;
+				}
+
+				outDistance = std::sqrt(bestSquaredDistance);
+				return true;
+			}
+
+		private:
+			inline bool IsProxy(const ProxyId proxyId) const
+			{
+				return (proxyId >= 0) && (static_cast<size_t>(proxyId) < Nodes.size()) && (Nodes[proxyId].Height == 0);
+			}
+
+			int32_t AllocateNode();
+			void FreeNode(const int32_t node);
+			void InsertLeaf(const int32_t leaf);
+			void RemoveLeaf(const int32_t leaf);
+
+			// Rotates the subtree rooted at node if its children's heights differ by more than 1. Returns the index of the new subtree root.
+			int32_t Balance(const int32_t node);
+
+			// Recalculates the box and height of every node from node to the root, balancing along the way.
+			void Refit(int32_t node);
+		};
+	}
+}
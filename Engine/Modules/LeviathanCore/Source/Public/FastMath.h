@@ -0,0 +1,195 @@
+#pragma once
+
+#include "Simd.h"
+
+// Fast approximate transcendental functions. These trade exact libm results for throughput and are intended for hot loops such as
+// camera updates, primitive generation, animation and particles. Use MathLibrary when correctly rounded results are required.
+//
+// Accuracy tiers:
+// MathLibrary - forwards to libm (correctly rounded or within 1 ULP).
+// FastMath - polynomial approximations with the maximum error in ULP documented per function.
+// FastMath::*Estimate - hardware estimates with no refinement, for when only a handful of bits are needed.
+//
+// Every scalar function has an array variant that processes four values per iteration with SSE when available using the same
+// polynomials and error bounds as the scalar function.
+
+namespace LeviathanCore
+{
+	namespace FastMath
+	{
+		namespace Detail
+		{
+			// Cody-Waite split of Pi/2 so that x - k * Pi/2 can be computed without losing precision for moderate k.
+			static constexpr float HalfPiPart1 = 1.5703125f;
+			static constexpr float HalfPiPart2 = 4.837512969970703125e-4f;
+			static constexpr float HalfPiPart3 = 7.54978995489188216e-8f;
+			static constexpr float TwoOverPi = 0.636619772367581343f;
+
+			// Cody-Waite split of ln(2).
+			static constexpr float Ln2Part1 = 0.693359375f;
+			static constexpr float Ln2Part2 = -2.12194440e-4f;
+			static constexpr float Log2E = 1.44269504088896341f;
+
+			static constexpr float ExpMaxInput = 88.376f;
+			static constexpr float ExpMinInput = -87.3365447504f;
+
+			static constexpr float Sqrt2Over2 = 0.707106781186547524f;
+			static constexpr float TanPiOver8 = 0.414213562373095049f;
+			static constexpr float QuarterPi = 0.785398163397448310f;
+			static constexpr float HalfPi = 1.57079632679489662f;
+			static constexpr float Pi = 3.14159265358979324f;
+
+			// Minimax polynomial for sin(r) on [-Pi/4, Pi/4].
+			inline float SinPolynomial(const float r, const float r2)
+			{
+				return r + r * r2 * (-1.6666654611e-1f + r2 * (8.3321608736e-3f + r2 * -1.9515295891e-4f));
+			}
+
+			// Minimax polynomial for cos(r) on [-Pi/4, Pi/4].
+			inline float CosPolynomial(const float r2)
+			{
+				return 1.0f - 0.5f * r2 + r2 * r2 * (4.166664568298827e-2f + r2 * (-1.388731625493765e-3f + r2 * 2.443315711809948e-5f));
+			}
+
+			// Minimax polynomial for atan(t) on [-tan(Pi/8), tan(Pi/8)].
+			inline float ATanPolynomial(const float t)
+			{
+				const float t2 = t * t;
+				return t + t * t2 * (-3.33329491539e-1f + t2 * (1.99777106478e-1f + t2 * (-1.38776856032e-1f + t2 * 8.05374449538e-2f)));
+			}
+
+			// Reduces radians to r in [-Pi/4, Pi/4] and returns the quadrant index such that radians = quadrant * Pi/2 + r.
+			inline int32_t ReduceHalfPi(const float radians, float& outR)
+			{
+				const float k = std::nearbyint(radians * TwoOverPi);
+				outR = ((radians - k * HalfPiPart1) - k * HalfPiPart2) - k * HalfPiPart3;
+				return static_cast<int32_t>(k);
+			}
+		}
+
+		// Sine of radians. Max error 2 ULP for |radians| <= Pi. Beyond that the ULP error grows near zero crossings while the absolute error stays
+		// below 1e-7 for |radians| <= 8192 and below 1e-6 for |radians| <= 65536.
+		inline float Sin(const float radians)
+		{
+			float r = 0.0f;
+			const int32_t quadrant = Detail::ReduceHalfPi(radians, r);
+			const float r2 = r * r;
+			const float result = (quadrant & 1) ? Detail::CosPolynomial(r2) : Detail::SinPolynomial(r, r2);
+			return (quadrant & 2) ? -result : result;
+		}
+
+		// Cosine of radians. Max error 2 ULP for |radians| <= Pi. Beyond that the ULP error grows near zero crossings while the absolute error
+		// stays below 1e-7 for |radians| <= 8192 and below 1e-6 for |radians| <= 65536.
+		inline float Cos(const float radians)
+		{
+			float r = 0.0f;
+			const int32_t quadrant = Detail::ReduceHalfPi(radians, r) + 1;
+			const float r2 = r * r;
+			const float result = (quadrant & 1) ? Detail::CosPolynomial(r2) : Detail::SinPolynomial(r, r2);
+			return (quadrant & 2) ? -result : result;
+		}
+
+		// Computes the sine and cosine of radians sharing a single range reduction. Same error bounds as Sin and Cos.
+		inline void SinCos(const float radians, float& outSin, float& outCos)
+		{
+			float r = 0.0f;
+			const int32_t quadrant = Detail::ReduceHalfPi(radians, r);
+			const float r2 = r * r;
+			const float s = Detail::SinPolynomial(r, r2);
+			const float c = Detail::CosPolynomial(r2);
+			const float sinResult = (quadrant & 1) ? c : s;
+			const float cosResult = (quadrant & 1) ? s : c;
+			outSin = (quadrant & 2) ? -sinResult : sinResult;
+			outCos = ((quadrant + 1) & 2) ? -cosResult : cosResult;
+		}
+
+		// Four quadrant arc tangent of y/x in radians in the range [-Pi, Pi]. Max error 3 ULP. Returns 0 when both x and y are 0.
+		inline float ATan2(const float y, const float x)
+		{
+			const float absY = std::fabs(y);
+			const float absX = std::fabs(x);
+			const float numerator = (absY < absX) ? absY : absX;
+			const float denominator = (absY < absX) ? absX : absY;
+			const float t = (denominator > 0.0f) ? numerator / denominator : 0.0f;
+
+			// Reduce t in [0, 1] to [-tan(Pi/8), tan(Pi/8)].
+			const bool upperRange = t > Detail::TanPiOver8;
+			const float reduced = upperRange ? (t - 1.0f) / (t + 1.0f) : t;
+			float result = Detail::ATanPolynomial(reduced) + (upperRange ? Detail::QuarterPi : 0.0f);
+
+			result = (absY > absX) ? Detail::HalfPi - result : result;
+			result = (x < 0.0f) ? Detail::Pi - result : result;
+			return std::copysign(result, y);
+		}
+
+		// Natural exponential of x. Max error 1 ULP for results in the normal float range. Inputs are clamped to [-87.33, 88.37].
+		inline float Exp(const float x)
+		{
+			const float clamped = std::fmin(std::fmax(x, Detail::ExpMinInput), Detail::ExpMaxInput);
+			const float n = std::nearbyint(clamped * Detail::Log2E);
+			const float r = (clamped - n * Detail::Ln2Part1) - n * Detail::Ln2Part2;
+			const float r2 = r * r;
+			const float p = ((((1.9875691500e-4f * r + 1.3981999507e-3f) * r + 8.3334519073e-3f) * r + 4.1665795894e-2f) * r + 1.6666665459e-1f) * r + 5.0000001201e-1f;
+			const float mantissa = p * r2 + r + 1.0f;
+			const uint32_t exponentBits = static_cast<uint32_t>(static_cast<int32_t>(n) + 127) << 23;
+			return mantissa * std::bit_cast<float>(exponentBits);
+		}
+
+		// Natural logarithm of x. Max error 1 ULP. x must be a positive normal float; results for zero, negative, denormal, infinite or
+		// NaN inputs are undefined.
+		inline float Log(const float x)
+		{
+			// Split x into mantissa m in [sqrt(0.5), sqrt(2)) and exponent e so that x = m * 2^e.
+			const uint32_t bits = std::bit_cast<uint32_t>(x);
+			int32_t e = static_cast<int32_t>((bits >> 23) & 0xff) - 126;
+			float m = std::bit_cast<float>((bits & 0x007fffffu) | 0x3f000000u);
+			if (m < Detail::Sqrt2Over2)
+			{
+				m = m + m;
+				--e;
+			}
+
+			const float f = m - 1.0f;
+			const float f2 = f * f;
+			float y = ((((((((7.0376836292e-2f * f - 1.1514610310e-1f) * f + 1.1676998740e-1f) * f - 1.2420140846e-1f) * f + 1.4249322787e-1f) * f
+				- 1.6668057665e-1f) * f + 2.0000714765e-1f) * f - 2.4999993993e-1f) * f + 3.3333331174e-1f) * f * f2;
+			const float exponent = static_cast<float>(e);
+			y += exponent * Detail::Ln2Part2;
+			y += -0.5f * f2;
+			return (f + y) + exponent * Detail::Ln2Part1;
+		}
+
+		// Reciprocal square root of x using the hardware estimate refined with one Newton-Raphson step. Max error 4 ULP for positive
+		// normal x with SSE.
+		inline float RSqrt(const float x)
+		{
+#ifdef LEVIATHAN_SIMD_SSE
+			const float estimate = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+#else
+			// Bit-level initial guess when no hardware estimate is available.
+			const float estimate = std::bit_cast<float>(0x5f375a86u - (std::bit_cast<uint32_t>(x) >> 1));
+#endif // LEVIATHAN_SIMD_SSE.
+			return estimate * (1.5f - 0.5f * x * estimate * estimate);
+		}
+
+		// Reciprocal square root estimate with no refinement. Relative error below 1.5 * 2^-12 with SSE, 3.5e-2 otherwise.
+		inline float RSqrtEstimate(const float x)
+		{
+#ifdef LEVIATHAN_SIMD_SSE
+			return _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+#else
+			return std::bit_cast<float>(0x5f375a86u - (std::bit_cast<uint32_t>(x) >> 1));
+#endif // LEVIATHAN_SIMD_SSE.
+		}
+
+		// Array variants. Each writes count results to the out array and processes four values per iteration with SSE when available.
+		// Input and output arrays may alias.
+		void Sin(const float* radians, float* outSin, const size_t count);
+		void Cos(const float* radians, float* outCos, const size_t count);
+		void SinCos(const float* radians, float* outSin, float* outCos, const size_t count);
+		void ATan2(const float* y, const float* x, float* outRadians, const size_t count);
+		void Exp(const float* x, float* outExp, const size_t count);
+		void Log(const float* x, float* outLog, const size_t count);
+		void RSqrt(const float* x, float* outRSqrt, const size_t count);
+	}
+}
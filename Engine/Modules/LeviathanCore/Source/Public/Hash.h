@@ -0,0 +1,23 @@
+#pragma once
+
+namespace LeviathanCore
+{
+	// Fast non cryptographic hashes for lookups, change detection and checksums of local files. Hashes of the same bytes differ between platforms of
+	// different byte order.
+	namespace Hash
+	{
+		// 64 bit FNV-1a over 8 byte words with a final avalanche.
+		uint64_t HashBytes(const void* data, size_t sizeBytes);
+
+		inline uint64_t HashString(const std::string_view string)
+		{
+			return HashBytes(string.data(), string.size());
+		}
+
+		// Mixes value into the hash seed. The result depends on the order values are combined in.
+		inline uint64_t HashCombine(const uint64_t seed, const uint64_t value)
+		{
+			return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+		}
+	}
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+namespace LeviathanCore
+{
+	namespace JobSystem
+	{
+		// Called with the element range [first, first + count) and the index of the executing thread in [0, GetThreadCount()). The thread that called
+		// ParallelFor always has index 0 so per thread scratch memory can be indexed with threadIndex.
+		using ParallelForFunctionType = void(*)(size_t /* first */, size_t /* count */, size_t /* threadIndex */, void* /* userData */);
+		using BackgroundJobFunctionType = void(*)(void* /* userData */);
+
+		// Starts the worker threads and the background thread. A workerCount of 0 starts one worker for each hardware thread except the calling
+		// thread.
+		bool Initialize(size_t workerCount = 0);
+		void Shutdown();
+		bool IsInitialized();
+
+		// Returns the number of threads that execute parallel for ranges including the calling thread.
+		size_t GetThreadCount();
+
+		// Splits [0, count) into ranges of at most chunkSize elements and executes them on the worker threads and the calling thread. Returns once every
+		// range has completed. Ranges are executed on the calling thread when the job system is not initialized or when called from inside a range.
+		void ParallelFor(size_t count, size_t chunkSize, ParallelForFunctionType function, void* userData);
+
+		// Queues the function to run on the background thread and returns without waiting for it. The background thread runs jobs that take long
+		// or wait, e.g. file reads, one at a time in queue order, so they hold up neither the calling thread nor parallel for ranges. The function
+		// runs on the calling thread when the job system is not initialized. Shutdown runs the queued jobs before returning.
+		void RunInBackground(BackgroundJobFunctionType function, void* userData);
+
+		// Convenience overload for callables with the signature void(size_t first, size_t count, size_t threadIndex).
+		template <typename Function>
+		void ParallelFor(size_t count, size_t chunkSize, const Function& function)
+		{
+			ParallelFor(count, chunkSize, [](size_t first, size_t rangeCount, size_t threadIndex, void* userData)
+				{
+					(*static_cast<const Function*>(userData))(first, rangeCount, threadIndex);
+				}, const_cast<void*>(static_cast<const void*>(&function)));
+		}
+	}
+}
@@ -6,4 +6,8 @@
 #include "Platform.h"
 #include "Logging.h"
 #include "MathTypes.h"
-#include "MathLibrary.h"
\ No newline at end of file
+#include "MathLibrary.h"
+#include "FastMath.h"
+#include "BoundingVolumes.h"
+#include "JobSystem.h"
+#include "DynamicAABBTree.h"#include "TransformHierarchy.h"
@@ -104,10 +104,10 @@ namespace LeviathanCore
 			inline float Y() const { return Components[YComponent]; }
 			inline float Z() const { return Components[ZComponent]; }
 			inline float W() const { return Components[WComponent]; }
-			inline float SetX(float x) { Components[XComponent] = x; }
-			inline float SetY(float y) { Components[YComponent] = y; }
-			inline float SetZ(float z) { Components[ZComponent] = z; }
-			inline float SetW(float w) { Components[WComponent] = w; }
+			inline void SetX(float x) { Components[XComponent] = x; }
+			inline void SetY(float y) { Components[YComponent] = y; }
+			inline void SetZ(float z) { Components[ZComponent] = z; }
+			inline void SetW(float w) { Components[WComponent] = w; }
 
 			inline const float* Data() const { return Components; }
 			inline float* Data() { return Components; }
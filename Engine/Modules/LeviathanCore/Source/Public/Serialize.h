@@ -25,6 +25,47 @@ namespace LeviathanCore
 		// the function fails.
 		bool ReadFile(std::string_view file, bool binary, std::vector<uint8_t>& outBuffer);
 
+		// Reads sizeBytes bytes starting at offset bytes into the binary file at the location specified into the out buffer. Returns false if the file
+		// could not be opened or is shorter than the range.
+		bool ReadFileRange(std::string_view file, uint64_t offset, size_t sizeBytes, std::vector<uint8_t>& outBuffer);
+
+		// Size and last write time of a file, e.g. of the source a cooked file was built from, so that the cooked file can be rebuilt when its source
+		// changes.
+		struct FileStamp
+		{
+			uint64_t SizeBytes = 0;
+			int64_t WriteTime = 0;
+
+			inline bool operator==(const FileStamp& other) const { return (SizeBytes == other.SizeBytes) && (WriteTime == other.WriteTime); }
+		};
+
+		// Returns false if the file does not exist.
+		bool GetFileStamp(std::string_view file, FileStamp& outStamp);
+
+		// Magic and layout version starting the engine's binary files, e.g. cooked assets and caches. The files are written in native byte order and
+		// a file whose tag does not match is rejected rather than misread, so changing a layout only needs a new version.
+		struct FileTag
+		{
+			uint32_t Magic = 0;
+			uint32_t Version = 0;
+
+			inline bool operator==(const FileTag& other) const { return (Magic == other.Magic) && (Version == other.Version); }
+		};
+
+		// Copies a file header with a FileTag member named Tag from the start of the bytes. Returns false if the bytes are shorter than the header or
+		// the header's tag is not the expected tag.
+		template <typename HeaderType>
+		bool ReadFileHeader(const std::vector<uint8_t>& bytes, const FileTag& expectedTag, HeaderType& outHeader)
+		{
+			static_assert(std::is_trivially_copyable_v<HeaderType>, "File headers are copied as bytes.");
+			if (bytes.size() < sizeof(HeaderType))
+			{
+				return false;
+			}
+			memcpy(&outHeader, bytes.data(), sizeof(HeaderType));
+			return (outHeader.Tag == expectedTag);
+		}
+
 		// Checks if the file or directory exists. Returns true if it does otherwise false.
 		bool FileExists(std::string_view file);
 
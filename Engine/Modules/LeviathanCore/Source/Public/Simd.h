@@ -0,0 +1,12 @@
+#pragma once
+
+// Detects the SIMD instruction sets available to the build and includes their intrinsics. Code paths using intrinsics must be guarded
+// by the matching LEVIATHAN_SIMD_* definition and provide a scalar fallback.
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LEVIATHAN_SIMD_SSE
+#endif
+
+#ifdef LEVIATHAN_SIMD_SSE
+#include <immintrin.h>
+#endif // LEVIATHAN_SIMD_SSE.
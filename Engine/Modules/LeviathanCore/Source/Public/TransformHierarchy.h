@@ -0,0 +1,108 @@
+#pragma once
+
+#include "MathTypes.h"
+#include "LeviathanAssert.h"
+
+namespace LeviathanCore
+{
+	namespace Scene
+	{
+		// Parent child hierarchy of local translation, rotation and scale transforms. Node data is stored in structure of arrays layout in breadth first order
+		// so that every parent precedes its children and each depth level is a contiguous range. Setting a local transform marks the node dirty and Update
+		// recomputes the world matrices of dirty nodes and their descendants one level at a time with the levels split across the job system. Nodes are
+		// referenced by stable ids as storage is reordered when the structure changes.
+		class TransformHierarchy
+		{
+		public:
+			using NodeId = uint32_t;
+			static constexpr NodeId InvalidNodeId = std::numeric_limits<NodeId>::max();
+
+		private:
+			static constexpr uint32_t InvalidIndex = std::numeric_limits<uint32_t>::max();
+
+			// Node state bits.
+			static constexpr uint8_t LocalDirtyFlag = 1 << 0;
+			static constexpr uint8_t WorldChangedFlag = 1 << 1;
+			static constexpr uint8_t DestroyedFlag = 1 << 2;
+
+			// Per node data indexed by storage index. Nodes created since the last Update are appended unsorted until the next Update.
+			std::vector<uint32_t> Parents = {};
+			std::vector<MathTypes::Vector3> LocalTranslations = {};
+			std::vector<MathTypes::Quaternion> LocalRotations = {};
+			std::vector<MathTypes::Vector3> LocalScales = {};
+			std::vector<MathTypes::Matrix4x4> WorldMatrices = {};
+			std::vector<uint8_t> Flags = {};
+			std::vector<NodeId> IndexToNode = {};
+
+			// Storage index of every node id, InvalidIndex for free ids.
+			std::vector<uint32_t> NodeToIndex = {};
+			std::vector<NodeId> FreeNodeIds = {};
+
+			// Level d occupies storage indices [LevelOffsets[d], LevelOffsets[d + 1]).
+			std::vector<uint32_t> LevelOffsets = { 0 };
+			// Levels with nodes whose local transform was set since the last Update.
+			std::vector<uint8_t> LevelDirty = {};
+			// Levels with nodes whose world matrix changed in the last Update and whose WorldChangedFlag needs clearing.
+			std::vector<uint8_t> LevelWorldChanged = {};
+			// Set by node creation, destruction and reparenting. Update sorts storage by depth again before recomputing world matrices.
+			bool StructureChanged = false;
+
+			// Scratch memory reused between updates.
+			std::vector<uint32_t> ScratchChildOffsets = {};
+			std::vector<uint32_t> ScratchChildren = {};
+			std::vector<uint32_t> ScratchOrder = {};
+			std::vector<uint8_t> ScratchThreadChanged = {};
+
+		public:
+			// Creates a node with an identity local transform. The node is a root if parent is InvalidNodeId. Its world matrix is valid after the next Update.
+			NodeId CreateNode(NodeId parent = InvalidNodeId);
+
+			// Destroys the node and its descendants. Their ids stay valid until the next Update releases them.
+			void DestroyNode(NodeId node);
+
+			// Attaches the node to a new parent, or makes it a root if parent is InvalidNodeId, keeping its local transform. Returns false if parent is the
+			// node itself or one of its descendants.
+			bool SetParent(NodeId node, NodeId parent);
+			NodeId GetParent(NodeId node) const;
+
+			void SetLocalTransform(NodeId node, const MathTypes::Vector3& translation, const MathTypes::Quaternion& rotation, const MathTypes::Vector3& scale);
+			void SetLocalTranslation(NodeId node, const MathTypes::Vector3& translation);
+			void SetLocalRotation(NodeId node, const MathTypes::Quaternion& rotation);
+			void SetLocalScale(NodeId node, const MathTypes::Vector3& scale);
+
+			inline const MathTypes::Vector3& GetLocalTranslation(const NodeId node) const { return LocalTranslations[GetIndex(node)]; }
+			inline const MathTypes::Quaternion& GetLocalRotation(const NodeId node) const { return LocalRotations[GetIndex(node)]; }
+			inline const MathTypes::Vector3& GetLocalScale(const NodeId node) const { return LocalScales[GetIndex(node)]; }
+
+			// World matrix as of the last Update.
+			inline const MathTypes::Matrix4x4& GetWorldMatrix(const NodeId node) const { return WorldMatrices[GetIndex(node)]; }
+
+			// Returns true if the world matrix of the node was recomputed by the last Update, e.g. to only move the node's spatial proxy when it changed.
+			inline bool HasWorldChanged(const NodeId node) const { return (Flags[GetIndex(node)] & WorldChangedFlag) != 0; }
+
+			// Applies pending structural changes and recomputes the world matrices of dirty nodes and their descendants.
+			void Update();
+
+			void Clear();
+
+			inline bool IsValid(const NodeId node) const { return (node < NodeToIndex.size()) && (NodeToIndex[node] != InvalidIndex); }
+			inline size_t GetNodeCount() const { return Parents.size(); }
+			inline size_t GetLevelCount() const { return LevelOffsets.size() - 1; }
+
+		private:
+			inline uint32_t GetIndex(const NodeId node) const
+			{
+				LEVIATHAN_ASSERT(IsValid(node));
+				return NodeToIndex[node];
+			}
+
+			void MarkLocalDirty(uint32_t index);
+
+			// Sorts storage in breadth first order, removes destroyed nodes and rebuilds the level ranges.
+			void Rebuild();
+
+			// Recomputes the world matrices of the changed nodes in [first, first + count) of one level. Returns true if any world matrix changed.
+			bool UpdateRange(size_t first, size_t count);
+		};
+	}
+}
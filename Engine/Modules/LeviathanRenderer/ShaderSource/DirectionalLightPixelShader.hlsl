@@ -41,7 +41,12 @@ float4 main(PixelInput input) : SV_TARGET
     float3 baseColor = Texture2DSRVTable[COLOR_TEXTURE2D_SRV_TABLE_INDEX].Sample(TextureSamplerTable[COLOR_TEXTURE_SAMPLER_TABLE_INDEX], input.TexCoord.xy).rgb;
     float roughness = Texture2DSRVTable[ROUGHNESS_TEXTURE2D_SRV_TABLE_INDEX].Sample(TextureSamplerTable[ROUGHNESS_TEXTURE_SAMPLER_TABLE_INDEX], input.TexCoord.xy).r;
     float metallic = Texture2DSRVTable[METALLIC_TEXTURE2D_SRV_TABLE_INDEX].Sample(TextureSamplerTable[METALLIC_TEXTURE_SAMPLER_TABLE_INDEX], input.TexCoord.xy).r;
+#if NORMAL_MAPPING
     float3 surfaceNormal = normalize(Texture2DSRVTable[NORMAL_TEXTURE2D_SRV_TABLE_INDEX].Sample(TextureSamplerTable[NORMAL_TEXTURE_SAMPLER_TABLE_INDEX], input.TexCoord.xy).xyz * 2.0f - 1.0f);
+#else
+    // The interpolated vertex normal is the z axis of tangent space.
+    float3 surfaceNormal = float3(0.0f, 0.0f, 1.0f);
+#endif
     
     float3 surfaceToViewDirectionTangentSpace = normalize(-input.PositionTangentSpace);
     float nDotV = Calculate_nDotV(surfaceToViewDirectionTangentSpace, surfaceNormal);
@@ -1,16 +1,14 @@
-cbuffer ObjectBuffer : register(b0)
-{
-    float4x4 WorldViewMatrix;
-    float4x4 WorldViewProjectionMatrix;
-    float4x4 NormalMatrix;
-};
-
 struct VertexInput
 {
     float3 Position : POSITION;
     float3 Normal : NORMAL;
     float2 UV : UV;
     float3 Tangent : TANGENT;
+
+    // Per instance object data read from the instance stream. Each input register holds a matrix column.
+    column_major float4x4 WorldViewMatrix : WORLD_VIEW_MATRIX;
+    column_major float4x4 WorldViewProjectionMatrix : WORLD_VIEW_PROJECTION_MATRIX;
+    column_major float4x4 NormalMatrix : NORMAL_MATRIX;
 };
 
 struct VertexOutput
@@ -22,7 +20,7 @@ struct VertexOutput
 VertexOutput main(VertexInput input)
 {
     VertexOutput output;
-    output.PositionClipSpace = mul(WorldViewProjectionMatrix, float4(input.Position.xyz, 1.0f));
+    output.PositionClipSpace = mul(input.WorldViewProjectionMatrix, float4(input.Position.xyz, 1.0f));
     output.TexCoord = input.UV;
     return output;
 }
\ No newline at end of file
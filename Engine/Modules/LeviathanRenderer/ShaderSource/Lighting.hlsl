@@ -5,9 +5,11 @@ float Calculate_nDotV(float3 surfaceToViewDirection, float3 surfaceNormal)
     return saturate(dot(surfaceNormal, surfaceToViewDirection));
 }
 
-float Attenuation(float distance)
+// Inverse square falloff windowed to reach 0 at the light's influence radius so that lights can be culled beyond it.
+float Attenuation(float distance, float radius)
 {
-    return 1.0f / Square(distance);
+    float window = saturate(1.0f - Square(Square(distance / radius)));
+    return Square(window) / Square(distance);
 }
 
 float3 Lambert(float3 color)
@@ -1,14 +1,8 @@
-cbuffer ObjectBuffer : register(b0)
-{
-    float4x4 WorldViewMatrix;
-    float4x4 WorldViewProjectionMatrix;
-    float4x4 NormalMatrix;
-};
-
 cbuffer SpotLightBuffer : register(b1)
 {
     float3 Radiance;
     float3 LightPositionViewSpace;
+    float Radius;
     float3 LightDirectionViewSpace;
     float CosineInnerConeAngle;
     float CosineOuterConeAngle;
@@ -20,6 +14,11 @@ struct VertexInput
     float3 Normal : NORMAL;
     float2 UV : UV;
     float3 Tangent : TANGENT;
+
+    // Per instance object data read from the instance stream. Each input register holds a matrix column.
+    column_major float4x4 WorldViewMatrix : WORLD_VIEW_MATRIX;
+    column_major float4x4 WorldViewProjectionMatrix : WORLD_VIEW_PROJECTION_MATRIX;
+    column_major float4x4 NormalMatrix : NORMAL_MATRIX;
 };
 
 struct VertexOutput
@@ -38,12 +37,12 @@ VertexOutput main(VertexInput input)
     const float4 inputPosition4 = float4(input.Position, 1.0f);
 
     VertexOutput output;
-    output.PositionClipSpace = mul(WorldViewProjectionMatrix, inputPosition4);
-    output.PositionViewSpace = mul(WorldViewMatrix, inputPosition4).xyz;
-    output.VertexNormalViewSpace = normalize(mul(NormalMatrix, float4(input.Normal, 0.0f)).xyz);
+    output.PositionClipSpace = mul(input.WorldViewProjectionMatrix, inputPosition4);
+    output.PositionViewSpace = mul(input.WorldViewMatrix, inputPosition4).xyz;
+    output.VertexNormalViewSpace = normalize(mul(input.NormalMatrix, float4(input.Normal, 0.0f)).xyz);
     output.TexCoord = input.UV;
 
-    float3 tangentViewSpace = normalize(mul(WorldViewMatrix, float4(input.Tangent, 0.0f)).xyz);
+    float3 tangentViewSpace = normalize(mul(input.WorldViewMatrix, float4(input.Tangent, 0.0f)).xyz);
     // Re-orthogonalize tangent with respect to normal.
     tangentViewSpace = normalize(tangentViewSpace - dot(tangentViewSpace, output.VertexNormalViewSpace) * output.VertexNormalViewSpace);
     const float3 bitangentViewSpace = normalize(cross(output.VertexNormalViewSpace, tangentViewSpace));
@@ -51,6 +51,11 @@ namespace LeviathanRenderer
         ViewProjectionMatrix = ProjectionMatrix * ViewMatrix;
     }
 
+    LeviathanCore::BoundingVolumes::Frustum Camera::GetFrustum() const
+    {
+        return LeviathanCore::BoundingVolumes::Frustum::FromViewProjection(ViewProjectionMatrix);
+    }
+
     LeviathanCore::MathTypes::Vector3 Camera::GetForwardVector(const LeviathanCore::MathTypes::Vector3& baseForward)
     {
         return LeviathanCore::MathTypes::Quaternion(Orientation) * baseForward;
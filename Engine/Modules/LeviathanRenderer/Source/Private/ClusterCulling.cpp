@@ -0,0 +1,231 @@
+#include "ClusterCulling.h"
+#include "Camera.h"
+#include "JobSystem.h"
+#include "Simd.h"
+
+namespace LeviathanRenderer
+{
+	// Number of clusters tested per batched intersection call.
+	static constexpr size_t TestBlockSize = 256;
+
+	void ClusterCullingStage::SetClusters(const ClusterDescription* const clusters, const size_t count)
+	{
+		ClusterBounds.Resize(count);
+		ConeApexX.resize(count);
+		ConeApexY.resize(count);
+		ConeApexZ.resize(count);
+		ConeAxisX.resize(count);
+		ConeAxisY.resize(count);
+		ConeAxisZ.resize(count);
+		ConeCutoffs.resize(count);
+		FirstIndices.resize(count);
+		IndexCounts.resize(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			const ClusterDescription& cluster = clusters[i];
+			ClusterBounds.Set(i, cluster.Bounds);
+			ConeApexX[i] = cluster.ConeApex.X();
+			ConeApexY[i] = cluster.ConeApex.Y();
+			ConeApexZ[i] = cluster.ConeApex.Z();
+			ConeAxisX[i] = cluster.ConeAxis.X();
+			ConeAxisY[i] = cluster.ConeAxis.Y();
+			ConeAxisZ[i] = cluster.ConeAxis.Z();
+			ConeCutoffs[i] = cluster.ConeCutoff;
+			FirstIndices[i] = cluster.FirstIndex;
+			IndexCounts[i] = cluster.IndexCount;
+		}
+	}
+
+	ClusterCullingStage::ChunkResult ClusterCullingStage::CullRange(const LeviathanCore::BoundingVolumes::Frustum& frustum, const LeviathanCore::MathTypes::Vector3& viewPoint,
+		const bool orthographic, const size_t first, const size_t count, uint32_t* const outClusters) const
+	{
+		const LeviathanCore::BoundingVolumes::SphereSoA bounds = ClusterBounds.View();
+		std::array<uint8_t, TestBlockSize> inFrustum = {};
+		std::array<uint8_t, TestBlockSize> backFacing = {};
+		ChunkResult result = {};
+		const size_t end = first + count;
+		for (size_t blockFirst = first; blockFirst < end; blockFirst += TestBlockSize)
+		{
+			const size_t blockCount = std::min(TestBlockSize, end - blockFirst);
+			LeviathanCore::BoundingVolumes::TestFrustumSpheres(frustum, bounds, blockFirst, blockCount, inFrustum.data());
+
+			// A cluster is back facing when the direction from the view point to its cone apex lies within the cone. Orthographic views look along
+			// a single direction. Cutoffs of 1 are skipped so that rounding never culls clusters facing every direction.
+			size_t i = 0;
+#ifdef LEVIATHAN_SIMD_SSE
+			const __m128 viewX = _mm_set1_ps(viewPoint.X());
+			const __m128 viewY = _mm_set1_ps(viewPoint.Y());
+			const __m128 viewZ = _mm_set1_ps(viewPoint.Z());
+			const __m128 one = _mm_set1_ps(1.0f);
+			for (; i + 4 <= blockCount; i += 4)
+			{
+				const size_t index = blockFirst + i;
+				const __m128 axisX = _mm_loadu_ps(ConeAxisX.data() + index);
+				const __m128 axisY = _mm_loadu_ps(ConeAxisY.data() + index);
+				const __m128 axisZ = _mm_loadu_ps(ConeAxisZ.data() + index);
+				const __m128 cutoff = _mm_loadu_ps(ConeCutoffs.data() + index);
+				__m128 culled = _mm_setzero_ps();
+				if (orthographic)
+				{
+					const __m128 axisDot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(viewX, axisX), _mm_mul_ps(viewY, axisY)), _mm_mul_ps(viewZ, axisZ));
+					culled = _mm_cmpgt_ps(axisDot, cutoff);
+				}
+				else
+				{
+					const __m128 directionX = _mm_sub_ps(_mm_loadu_ps(ConeApexX.data() + index), viewX);
+					const __m128 directionY = _mm_sub_ps(_mm_loadu_ps(ConeApexY.data() + index), viewY);
+					const __m128 directionZ = _mm_sub_ps(_mm_loadu_ps(ConeApexZ.data() + index), viewZ);
+					const __m128 axisDot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(directionX, axisX), _mm_mul_ps(directionY, axisY)), _mm_mul_ps(directionZ, axisZ));
+					const __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(directionX, directionX), _mm_mul_ps(directionY, directionY)),
+						_mm_mul_ps(directionZ, directionZ)));
+					culled = _mm_cmpgt_ps(axisDot, _mm_mul_ps(cutoff, length));
+				}
+				const int mask = _mm_movemask_ps(_mm_and_ps(culled, _mm_cmplt_ps(cutoff, one)));
+				backFacing[i + 0] = static_cast<uint8_t>(mask & 1);
+				backFacing[i + 1] = static_cast<uint8_t>((mask >> 1) & 1);
+				backFacing[i + 2] = static_cast<uint8_t>((mask >> 2) & 1);
+				backFacing[i + 3] = static_cast<uint8_t>((mask >> 3) & 1);
+			}
+#endif // LEVIATHAN_SIMD_SSE.
+			for (; i < blockCount; ++i)
+			{
+				const size_t index = blockFirst + i;
+				const float cutoff = ConeCutoffs[index];
+				bool culled = false;
+				if (orthographic)
+				{
+					culled = ((viewPoint.X() * ConeAxisX[index]) + (viewPoint.Y() * ConeAxisY[index]) + (viewPoint.Z() * ConeAxisZ[index])) > cutoff;
+				}
+				else
+				{
+					const float directionX = ConeApexX[index] - viewPoint.X();
+					const float directionY = ConeApexY[index] - viewPoint.Y();
+					const float directionZ = ConeApexZ[index] - viewPoint.Z();
+					const float axisDot = (directionX * ConeAxisX[index]) + (directionY * ConeAxisY[index]) + (directionZ * ConeAxisZ[index]);
+					culled = axisDot > (cutoff * std::sqrt((directionX * directionX) + (directionY * directionY) + (directionZ * directionZ)));
+				}
+				backFacing[i] = (culled && (cutoff < 1.0f)) ? 1 : 0;
+			}
+
+			// Branchless compaction. A culled cluster is overwritten by the next cluster.
+			for (i = 0; i < blockCount; ++i)
+			{
+				const uint32_t cluster = static_cast<uint32_t>(blockFirst + i);
+				const uint32_t visible = inFrustum[i] & (backFacing[i] ^ 1);
+				outClusters[result.VisibleCount] = cluster;
+				result.VisibleCount += visible;
+				result.IndexCount += IndexCounts[cluster] * visible;
+				result.FrustumCulledCount += inFrustum[i] ^ 1;
+				result.BackFacingCount += inFrustum[i] & backFacing[i];
+			}
+		}
+		return result;
+	}
+
+	void ClusterCullingStage::Cull(const Camera& view, const LeviathanCore::MathTypes::Matrix4x4& transform, const uint32_t* const indices)
+	{
+		const size_t count = ClusterBounds.Size();
+		const size_t chunkCount = std::max<size_t>((count + ChunkSize - 1) / ChunkSize, 1);
+		if (ChunkVisibleClusters.size() < count)
+		{
+			ChunkVisibleClusters.resize(count);
+			VisibleClusters.resize(count);
+		}
+		if (ChunkResults.size() < chunkCount)
+		{
+			ChunkResults.resize(chunkCount);
+		}
+
+		// The frustum of the view projection of the instance transform holds the world frustum's planes in object space.
+		const LeviathanCore::BoundingVolumes::Frustum frustum = LeviathanCore::BoundingVolumes::Frustum::FromViewProjection(view.GetViewProjectionMatrix() * transform);
+		const LeviathanCore::MathTypes::Matrix4x4 inverseTransform = LeviathanCore::MathTypes::Matrix4x4::Inverse(transform);
+		const bool orthographic = (view.GetProjectionMode() == Camera::ProjectionMode::Orthographic);
+		LeviathanCore::MathTypes::Vector3 viewPoint = {};
+		if (orthographic)
+		{
+			// Row 2 of the column major view matrix is the world space view direction.
+			const float* const viewMatrix = view.GetViewMatrix().Data();
+			const LeviathanCore::MathTypes::Vector4 direction = inverseTransform * LeviathanCore::MathTypes::Vector4(viewMatrix[2], viewMatrix[6], viewMatrix[10], 0.0f);
+			viewPoint = LeviathanCore::MathTypes::Vector3(direction.X(), direction.Y(), direction.Z()).AsNormalizedSafe();
+		}
+		else
+		{
+			const LeviathanCore::MathTypes::Vector4 position = inverseTransform * LeviathanCore::MathTypes::Vector4(view.GetPosition(), 1.0f);
+			viewPoint = LeviathanCore::MathTypes::Vector3(position.X(), position.Y(), position.Z());
+		}
+
+		if ((count <= ChunkSize) || (LeviathanCore::JobSystem::GetThreadCount() == 1))
+		{
+			for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+			{
+				const size_t first = chunk * ChunkSize;
+				ChunkResults[chunk] = CullRange(frustum, viewPoint, orthographic, first, std::min(ChunkSize, count - first), ChunkVisibleClusters.data() + first);
+			}
+		}
+		else
+		{
+			LeviathanCore::JobSystem::ParallelFor(count, ChunkSize, [this, &frustum, &viewPoint, orthographic](const size_t first, const size_t rangeCount,
+				[[maybe_unused]] const size_t threadIndex)
+				{
+					ChunkResults[first / ChunkSize] = CullRange(frustum, viewPoint, orthographic, first, rangeCount, ChunkVisibleClusters.data() + first);
+				});
+		}
+
+		// Exclusive prefix sums of the chunk visible cluster and index counts.
+		Stats = {};
+		Stats.TestedClusters = count;
+		size_t visibleOffset = 0;
+		size_t indexOffset = 0;
+		for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+		{
+			ChunkResult& result = ChunkResults[chunk];
+			result.VisibleOffset = visibleOffset;
+			result.IndexOffset = indexOffset;
+			visibleOffset += result.VisibleCount;
+			indexOffset += result.IndexCount;
+			Stats.FrustumCulledClusters += result.FrustumCulledCount;
+			Stats.BackFacingClusters += result.BackFacingCount;
+		}
+		VisibleClusterCount = visibleOffset;
+		VisibleIndexCount = (indices != nullptr) ? indexOffset : 0;
+		Stats.VisibleIndices = indexOffset;
+		if (VisibleIndices.size() < VisibleIndexCount)
+		{
+			VisibleIndices.resize(VisibleIndexCount);
+		}
+
+		// Compact the chunk results and copy the visible clusters' indices.
+		const auto compactChunk = [this, indices](const size_t chunk)
+			{
+				const ChunkResult& result = ChunkResults[chunk];
+				const uint32_t* const chunkClusters = ChunkVisibleClusters.data() + (chunk * ChunkSize);
+				std::copy_n(chunkClusters, result.VisibleCount, VisibleClusters.data() + result.VisibleOffset);
+				if (indices != nullptr)
+				{
+					uint32_t* outIndices = VisibleIndices.data() + result.IndexOffset;
+					for (size_t i = 0; i < result.VisibleCount; ++i)
+					{
+						const uint32_t cluster = chunkClusters[i];
+						outIndices = std::copy_n(indices + FirstIndices[cluster], IndexCounts[cluster], outIndices);
+					}
+				}
+			};
+		if ((count <= ChunkSize) || (LeviathanCore::JobSystem::GetThreadCount() == 1))
+		{
+			for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+			{
+				compactChunk(chunk);
+			}
+		}
+		else
+		{
+			LeviathanCore::JobSystem::ParallelFor(chunkCount, 1, [&compactChunk](const size_t firstChunk, const size_t rangeChunkCount, [[maybe_unused]] const size_t threadIndex)
+				{
+					for (size_t chunk = firstChunk; chunk < firstChunk + rangeChunkCount; ++chunk)
+					{
+						compactChunk(chunk);
+					}
+				});
+		}
+	}
+}
@@ -0,0 +1,269 @@
+#include "ClusteredLighting.h"
+#include "JobSystem.h"
+
+namespace LeviathanRenderer
+{
+	// Number of lights transformed to view space per job.
+	static constexpr size_t LightBoundsChunkSize = 1024;
+
+	// Number of lights tested per batched intersection call.
+	static constexpr size_t LightTestBlockSize = 256;
+
+	// Returns the tangent of the view angle at the lower edge of a tile, tile == tileCount gives the upper edge of the last tile.
+	static inline float TileEdgeTangent(const uint32_t tile, const uint32_t tileCount, const float tanHalfFov)
+	{
+		return tanHalfFov * ((2.0f * static_cast<float>(tile) / static_cast<float>(tileCount)) - 1.0f);
+	}
+
+	// Returns the view space box of the frustum section between the view angle tangents and the view depths.
+	static LeviathanCore::BoundingVolumes::AABB MakeSectionBounds(const float minTanX, const float maxTanX, const float minTanY, const float maxTanY,
+		const float nearDepth, const float farDepth)
+	{
+		return LeviathanCore::BoundingVolumes::AABB{
+			LeviathanCore::MathTypes::Vector3{ std::min(minTanX * nearDepth, minTanX * farDepth), std::min(minTanY * nearDepth, minTanY * farDepth), nearDepth },
+			LeviathanCore::MathTypes::Vector3{ std::max(maxTanX * nearDepth, maxTanX * farDepth), std::max(maxTanY * nearDepth, maxTanY * farDepth), farDepth } };
+	}
+
+	static inline LeviathanCore::MathTypes::Vector3 TransformToViewSpace(const LeviathanCore::MathTypes::Matrix4x4& viewMatrix,
+		const LeviathanCore::MathTypes::Vector3& vector, const float w)
+	{
+		const LeviathanCore::MathTypes::Vector4 viewSpace = viewMatrix * LeviathanCore::MathTypes::Vector4{ vector, w };
+		return LeviathanCore::MathTypes::Vector3{ viewSpace.X(), viewSpace.Y(), viewSpace.Z() };
+	}
+
+	// Returns the smallest sphere enclosing the spot light's cone capped by its radius.
+	static LeviathanCore::BoundingVolumes::Sphere SpotLightBounds(const LeviathanCore::MathTypes::Vector3& position, const LeviathanCore::MathTypes::Vector3& direction,
+		const float outerConeAngleRadians, const float radius)
+	{
+		if (outerConeAngleRadians >= LeviathanCore::MathLibrary::HalfPi)
+		{
+			return LeviathanCore::BoundingVolumes::Sphere{ position, radius };
+		}
+
+		// Wide cones are bounded by the sphere through the cone's rim. Narrow cones are bounded by the sphere through the apex and the rim.
+		const float cosine = LeviathanCore::MathLibrary::Cos(outerConeAngleRadians);
+		if (outerConeAngleRadians > LeviathanCore::MathLibrary::DegreesToRadians(45.0f))
+		{
+			return LeviathanCore::BoundingVolumes::Sphere{ position + direction * (radius * cosine), radius * LeviathanCore::MathLibrary::Sin(outerConeAngleRadians) };
+		}
+
+		const float boundsRadius = radius / (2.0f * cosine);
+		return LeviathanCore::BoundingVolumes::Sphere{ position + direction * boundsRadius, boundsRadius };
+	}
+
+	void ClusteredLightCulling::CandidateLights::Reserve(const size_t capacity)
+	{
+		if (Indices.size() < capacity)
+		{
+			CenterX.resize(capacity);
+			CenterY.resize(capacity);
+			CenterZ.resize(capacity);
+			Radius.resize(capacity);
+			Indices.resize(capacity);
+		}
+	}
+
+	void ClusteredLightCulling::CandidateLights::Gather(const LeviathanCore::BoundingVolumes::AABB& bounds, const LeviathanCore::BoundingVolumes::SphereSoA& lights,
+		const uint32_t* lightIndices)
+	{
+		std::array<uint8_t, LightTestBlockSize> results = {};
+		Count = 0;
+		for (size_t blockFirst = 0; blockFirst < lights.Count; blockFirst += LightTestBlockSize)
+		{
+			const size_t blockCount = std::min(LightTestBlockSize, lights.Count - blockFirst);
+			LeviathanCore::BoundingVolumes::TestAABBSpheres(bounds, lights, blockFirst, blockCount, results.data());
+
+			// Branchless compaction. A rejected light is overwritten by the next light.
+			for (size_t i = 0; i < blockCount; ++i)
+			{
+				const size_t light = blockFirst + i;
+				CenterX[Count] = lights.CenterX[light];
+				CenterY[Count] = lights.CenterY[light];
+				CenterZ[Count] = lights.CenterZ[light];
+				Radius[Count] = lights.Radius[light];
+				Indices[Count] = (lightIndices != nullptr) ? lightIndices[light] : static_cast<uint32_t>(light);
+				Count += results[i];
+			}
+		}
+	}
+
+	LeviathanCore::BoundingVolumes::SphereSoA ClusteredLightCulling::CandidateLights::View() const
+	{
+		return LeviathanCore::BoundingVolumes::SphereSoA{ CenterX.data(), CenterY.data(), CenterZ.data(), Radius.data(), Count };
+	}
+
+	bool ClusteredLightCulling::Initialize(const uint32_t tileCountX, const uint32_t tileCountY, const uint32_t sliceCount)
+	{
+		if ((tileCountX == 0) || (tileCountY == 0) || (sliceCount == 0))
+		{
+			return false;
+		}
+
+		TileCountX = tileCountX;
+		TileCountY = tileCountY;
+		SliceCount = sliceCount;
+		return true;
+	}
+
+	void ClusteredLightCulling::Build(const ClusterView& view, const LightTypes::PointLight* const pointLights, const size_t pointLightCount,
+		const LightTypes::SpotLight* const spotLights, const size_t spotLightCount)
+	{
+		const size_t clusterCount = GetClusterCount();
+		Clusters.resize(clusterCount);
+		SliceLightIndices.resize(SliceCount);
+		SliceOffsets.resize(SliceCount + 1);
+
+		// Slice boundaries with exponential spacing so that clusters keep a similar shape at every depth.
+		TanHalfFovY = std::tan(view.FovYRadians * 0.5f);
+		TanHalfFovX = TanHalfFovY * view.AspectRatio;
+		SliceDepths.resize(SliceCount + 1);
+		const float depthRatio = view.FarZ / view.NearZ;
+		for (uint32_t slice = 0; slice < SliceCount; ++slice)
+		{
+			SliceDepths[slice] = view.NearZ * std::pow(depthRatio, static_cast<float>(slice) / static_cast<float>(SliceCount));
+		}
+		SliceDepths[SliceCount] = view.FarZ;
+
+		LightCount = pointLightCount + spotLightCount;
+		if (LightRadius.size() < LightCount)
+		{
+			LightCenterX.resize(LightCount);
+			LightCenterY.resize(LightCount);
+			LightCenterZ.resize(LightCount);
+			LightRadius.resize(LightCount);
+		}
+
+		const size_t threadCount = LeviathanCore::JobSystem::GetThreadCount();
+		if (Scratch.size() < threadCount)
+		{
+			Scratch.resize(threadCount);
+		}
+		for (ThreadScratch& scratch : Scratch)
+		{
+			scratch.SliceLights.Reserve(LightCount);
+			scratch.RowLights.Reserve(LightCount);
+		}
+
+		// View space bounds of the lights.
+		LeviathanCore::JobSystem::ParallelFor(LightCount, LightBoundsChunkSize,
+			[this, &view, pointLights, pointLightCount, spotLights](const size_t first, const size_t count, [[maybe_unused]] const size_t threadIndex)
+			{
+				for (size_t light = first; light < first + count; ++light)
+				{
+					LeviathanCore::BoundingVolumes::Sphere bounds = {};
+					if (light < pointLightCount)
+					{
+						const LightTypes::PointLight& pointLight = pointLights[light];
+						bounds = LeviathanCore::BoundingVolumes::Sphere{ TransformToViewSpace(view.ViewMatrix, pointLight.Position, 1.0f),
+							LightTypes::GetInfluenceRadius(pointLight) };
+					}
+					else
+					{
+						const LightTypes::SpotLight& spotLight = spotLights[light - pointLightCount];
+						LeviathanCore::MathTypes::Vector3 directionViewSpace = TransformToViewSpace(view.ViewMatrix, spotLight.Direction, 0.0f);
+						directionViewSpace.NormalizeSafe();
+						bounds = SpotLightBounds(TransformToViewSpace(view.ViewMatrix, spotLight.Position, 1.0f), directionViewSpace, spotLight.OuterConeAngleRadians,
+							LightTypes::GetInfluenceRadius(spotLight));
+					}
+
+					LightCenterX[light] = bounds.Center.X();
+					LightCenterY[light] = bounds.Center.Y();
+					LightCenterZ[light] = bounds.Center.Z();
+					LightRadius[light] = bounds.Radius;
+				}
+			});
+
+		LeviathanCore::JobSystem::ParallelFor(SliceCount, 1, [this](const size_t first, const size_t count, const size_t threadIndex)
+			{
+				for (size_t slice = first; slice < first + count; ++slice)
+				{
+					AssignSlice(static_cast<uint32_t>(slice), Scratch[threadIndex]);
+				}
+			});
+
+		// Exclusive prefix sum of the slice light index counts.
+		size_t offset = 0;
+		for (uint32_t slice = 0; slice < SliceCount; ++slice)
+		{
+			SliceOffsets[slice] = offset;
+			offset += SliceLightIndices[slice].size();
+		}
+		SliceOffsets[SliceCount] = offset;
+		LightIndexCount = offset;
+		if (LightIndices.size() < LightIndexCount)
+		{
+			LightIndices.resize(LightIndexCount);
+		}
+
+		// Compact the slice lists and make cluster offsets absolute.
+		const size_t clustersPerSlice = static_cast<size_t>(TileCountX) * TileCountY;
+		LeviathanCore::JobSystem::ParallelFor(SliceCount, 1, [this, clustersPerSlice](const size_t first, const size_t count, [[maybe_unused]] const size_t threadIndex)
+			{
+				for (size_t slice = first; slice < first + count; ++slice)
+				{
+					const std::vector<uint32_t>& sliceIndices = SliceLightIndices[slice];
+					std::copy(sliceIndices.begin(), sliceIndices.end(), LightIndices.begin() + SliceOffsets[slice]);
+
+					const uint32_t sliceOffset = static_cast<uint32_t>(SliceOffsets[slice]);
+					ClusterLights* const sliceClusters = Clusters.data() + (slice * clustersPerSlice);
+					for (size_t cluster = 0; cluster < clustersPerSlice; ++cluster)
+					{
+						sliceClusters[cluster].Offset += sliceOffset;
+					}
+				}
+			});
+	}
+
+	LeviathanCore::BoundingVolumes::AABB ClusteredLightCulling::GetClusterBounds(const uint32_t tileX, const uint32_t tileY, const uint32_t slice) const
+	{
+		return MakeSectionBounds(TileEdgeTangent(tileX, TileCountX, TanHalfFovX), TileEdgeTangent(tileX + 1, TileCountX, TanHalfFovX),
+			TileEdgeTangent(tileY, TileCountY, TanHalfFovY), TileEdgeTangent(tileY + 1, TileCountY, TanHalfFovY), SliceDepths[slice], SliceDepths[slice + 1]);
+	}
+
+	void ClusteredLightCulling::AssignSlice(const uint32_t slice, ThreadScratch& scratch)
+	{
+		std::vector<uint32_t>& sliceIndices = SliceLightIndices[slice];
+		sliceIndices.clear();
+
+		const float nearDepth = SliceDepths[slice];
+		const float farDepth = SliceDepths[slice + 1];
+
+		// Every level's box contains the boxes of the level below so a light rejected by a slice or row cannot overlap any of its clusters.
+		const LeviathanCore::BoundingVolumes::SphereSoA lights{ LightCenterX.data(), LightCenterY.data(), LightCenterZ.data(), LightRadius.data(), LightCount };
+		scratch.SliceLights.Gather(MakeSectionBounds(-TanHalfFovX, TanHalfFovX, -TanHalfFovY, TanHalfFovY, nearDepth, farDepth), lights, nullptr);
+
+		std::array<uint8_t, LightTestBlockSize> results = {};
+		for (uint32_t tileY = 0; tileY < TileCountY; ++tileY)
+		{
+			const float minTanY = TileEdgeTangent(tileY, TileCountY, TanHalfFovY);
+			const float maxTanY = TileEdgeTangent(tileY + 1, TileCountY, TanHalfFovY);
+			scratch.RowLights.Gather(MakeSectionBounds(-TanHalfFovX, TanHalfFovX, minTanY, maxTanY, nearDepth, farDepth), scratch.SliceLights.View(),
+				scratch.SliceLights.Indices.data());
+
+			const LeviathanCore::BoundingVolumes::SphereSoA rowLights = scratch.RowLights.View();
+			for (uint32_t tileX = 0; tileX < TileCountX; ++tileX)
+			{
+				const LeviathanCore::BoundingVolumes::AABB clusterBounds = GetClusterBounds(tileX, tileY, slice);
+
+				// Room for every row light. Trimmed to the cluster's lights after compaction.
+				const size_t clusterOffset = sliceIndices.size();
+				sliceIndices.resize(clusterOffset + rowLights.Count);
+				uint32_t* const clusterIndices = sliceIndices.data() + clusterOffset;
+				size_t clusterLightCount = 0;
+				for (size_t blockFirst = 0; blockFirst < rowLights.Count; blockFirst += LightTestBlockSize)
+				{
+					const size_t blockCount = std::min(LightTestBlockSize, rowLights.Count - blockFirst);
+					LeviathanCore::BoundingVolumes::TestAABBSpheres(clusterBounds, rowLights, blockFirst, blockCount, results.data());
+					for (size_t i = 0; i < blockCount; ++i)
+					{
+						clusterIndices[clusterLightCount] = scratch.RowLights.Indices[blockFirst + i];
+						clusterLightCount += results[i];
+					}
+				}
+				sliceIndices.resize(clusterOffset + clusterLightCount);
+
+				Clusters[GetClusterIndex(tileX, tileY, slice)] = ClusterLights{ static_cast<uint32_t>(clusterOffset), static_cast<uint32_t>(clusterLightCount) };
+			}
+		}
+	}
+}
@@ -5,6 +5,8 @@
 #include "Serialize.h"
 #include "LeviathanRenderer.h"
 #include "ConstantBufferTypes.h"
+#include "ShaderCache.h"
+#include "ShaderPermutations.h"
 
 // Temp.
 #include "LinearColor.h"
@@ -19,6 +21,9 @@ namespace LeviathanRenderer
 	// Device, device context and swap chain.
 	static Microsoft::WRL::ComPtr<ID3D11Device> gD3D11Device = {};
 	static Microsoft::WRL::ComPtr<ID3D11DeviceContext> gD3D11DeviceContext = {};
+	static Microsoft::WRL::ComPtr<ID3D11DeviceContext1> gD3D11DeviceContext1 = {};
+	// True when constant data can be bound as ranges of the constant upload buffer.
+	static bool gConstantBufferRangesSupported = false;
 	static Microsoft::WRL::ComPtr<IDXGISwapChain> gSwapChain = {};
 	static D3D_FEATURE_LEVEL gFeatureLevel = {};
 
@@ -43,19 +48,25 @@ namespace LeviathanRenderer
 	// Scene texture sampler state.
 	static Microsoft::WRL::ComPtr<ID3D11SamplerState> gSceneTextureSamplerState = {};
 
-	// Shader compilation settings.
+	// Shader compilation settings. Compiled shaders are stored in a single pack keyed by their source, includes, macros, entry point and target so only
+	// shaders whose inputs changed are recompiled.
 	static constexpr const char* SHADER_MODEL_5_VERTEX_SHADER = "vs_5_0";
 	static constexpr const char* SHADER_MODEL_5_PIXEL_SHADER = "ps_5_0";
 	static constexpr const char* CompiledShaderCacheDirectory = "Shaders/";
-	static constexpr char CompiledShaderCacheFileTypeSeparatingCharacter = '_';
-	static constexpr const char* CompiledShaderCacheVertexShaderFilePostFixString = "CompiledVertexShader";
-	static constexpr const char* CompiledShaderCachePixelShaderFilePostFixString = "CompiledPixelShader";
-	static constexpr bool ForceShaderRecompilation =
-#ifdef LEVIATHAN_BUILD_CONFIG_MASTER
-		false;
-#else
-		true;
-#endif
+	static constexpr const char* CompiledShaderCachePackFile = "Shaders/ShaderCache.pack";
+	static ShaderCache gShaderCache = {};
+	static ShaderSourceGraph gShaderSources = {};
+
+	// Shader permutations used in the previous run. Prewarmed when pipelines are created so that permutations are not loaded in the first frames
+	// they are drawn in.
+	static constexpr const char* ShaderUsageListFile = "Shaders/ShaderUsage.txt";
+	// Sets with at most this many permutations prewarm all of them, not only the ones in the usage list.
+	static constexpr uint64_t MaxPrewarmedPermutationCount = 16;
+
+	// Lighting pixel shader permutations.
+	static ShaderPermutationSet gDirectionalLightPixelShaderPermutations = {};
+	static ShaderPermutationSet gPointLightPixelShaderPermutations = {};
+	static ShaderPermutationSet gSpotLightPixelShaderPermutations = {};
 
 	// Note: For d3d12 renderer implementation.
 	//static constexpr const wchar_t* SHADER_MODEL_6_VERTEX_SHADER = L"vs_6_0";
@@ -70,23 +81,19 @@ namespace LeviathanRenderer
 		std::string_view SourceCodeFile = {};
 		// The name of the entry point function in the shader.
 		std::string_view EntryPointName = {};
-		// Null terminated list of shader definitions.
-		const D3D_SHADER_MACRO* ShaderMacros = nullptr;
+		// List of shader definitions.
+		const ShaderMacro* ShaderMacros = nullptr;
+		size_t ShaderMacroCount = 0;
 	};
 
-	static bool ReadShaderSourceCodeFileContents(std::string_view file, std::vector<uint8_t>& outBuffer)
-	{
-		return LeviathanCore::Serialize::ReadFile(file, false, outBuffer);
-	}
-
-	static bool ReadShaderSourceCodeFileContentsToString(std::string_view file, std::string& outString)
+	static bool ReadShaderSourceCodeFileContents(std::string_view file, std::string& outSource, [[maybe_unused]] void* userData)
 	{
 		std::vector<uint8_t> shaderSourceCodeBuffer = {};
-		if (!ReadShaderSourceCodeFileContents(file, shaderSourceCodeBuffer))
+		if (!LeviathanCore::Serialize::ReadFile(file, true, shaderSourceCodeBuffer))
 		{
 			return false;
 		}
-		outString = reinterpret_cast<char*>(shaderSourceCodeBuffer.data());
+		outSource.assign(reinterpret_cast<const char*>(shaderSourceCodeBuffer.data()), shaderSourceCodeBuffer.size());
 		return true;
 	}
 
@@ -105,8 +112,8 @@ namespace LeviathanRenderer
 			if (errorBlob)
 			{
 				LEVIATHAN_LOG("Failed to compile shader: %s, Error message: %s", name.data(), static_cast<const char*>(errorBlob->GetBufferPointer()));
-				return false;
 			}
+			return false;
 		}
 
 		// Copy result blob to output buffer.
@@ -179,137 +186,66 @@ namespace LeviathanRenderer
 	//}
 	*/
 
-	static bool CompileShaderSourceCodeString(std::string_view shaderSourceCode, std::string_view entryPoint, std::string_view name, const D3D_SHADER_MACRO* shaderMacros,
-		std::string_view target, std::vector<unsigned char>& outBuffer)
-	{
-		return CompileHLSLStringFXC(shaderSourceCode, entryPoint, name, shaderMacros, target, outBuffer);
-	}
-
-	static bool CompileNewShader(std::string_view sourceCodeFile, std::string_view entryPointName, std::string_view name, const D3D_SHADER_MACRO* shaderMacros,
-		std::string_view target, std::string_view cacheFile, std::vector<uint8_t>& outBuffer)
+	// Compiles a shader cache miss. Called concurrently from job system threads. The source file name is passed to the compiler so that includes are
+	// resolved relative to it as by the shader source graph.
+	static bool CompileShaderSourceCode(const ShaderCompileDescription& description, std::string_view source, std::vector<uint8_t>& outBytecode,
+		[[maybe_unused]] void* userData)
 	{
-		// Get shader source code as string.
-		std::string sourceCodeString = {};
-		if (!ReadShaderSourceCodeFileContentsToString(sourceCodeFile, sourceCodeString))
+		std::vector<D3D_SHADER_MACRO> shaderMacros = {};
+		shaderMacros.reserve(description.MacroCount + 1);
+		for (size_t i = 0; i < description.MacroCount; ++i)
 		{
-			return false;
-		}
-
-		// Compile source code string and store in buffer.
-		if (!CompileShaderSourceCodeString(sourceCodeString, entryPointName, name, shaderMacros, target, outBuffer))
-		{
-			return false;
+			shaderMacros.push_back(D3D_SHADER_MACRO{ .Name = description.Macros[i].Name, .Definition = description.Macros[i].Definition });
 		}
+		shaderMacros.push_back(D3D_SHADER_MACRO{ .Name = nullptr, .Definition = nullptr });
 
-		// Write compiled shader buffer to file on disk.
-		if (!LeviathanCore::Serialize::WriteBytesToFile(cacheFile, outBuffer))
-		{
-			return false;
-		}
-
-		return true;
-	}
-
-	static bool DoesCompiledShaderCacheFileExist(std::string_view file)
-	{
-		return LeviathanCore::Serialize::FileExists(file);
-	}
-
-	static bool ReadCompiledShaderCacheFile(std::string_view file, std::vector<uint8_t>& outBuffer)
-	{
-		return LeviathanCore::Serialize::ReadFile(file, true, outBuffer);
-	}
-
-	static bool TryReadCompiledShaderCacheFileElseCompileNewShader(std::string_view compiledShaderCacheFile, std::string_view shaderSourceCodeFile,
-		std::string_view entryPointName, std::string_view shaderName, const D3D_SHADER_MACRO* shaderMacros, std::string_view shaderTarget, std::vector<uint8_t>& outBuffer)
-	{
-		if (DoesCompiledShaderCacheFileExist(compiledShaderCacheFile))
-		{
-			LEVIATHAN_LOG("%s compiled shader cache file exists. Reading file.", compiledShaderCacheFile.data());
-			return ReadCompiledShaderCacheFile(compiledShaderCacheFile, outBuffer);
-		}
-		else
-		{
-			LEVIATHAN_LOG("%s compiled shader cache file does not exist. Recompiling shader source.", compiledShaderCacheFile.data());
-			return CompileNewShader(shaderSourceCodeFile, entryPointName, shaderName, shaderMacros, shaderTarget, compiledShaderCacheFile, outBuffer);
-		}
+		const std::string name(description.SourceFile);
+		const std::string entryPoint(description.EntryPoint);
+		const std::string target(description.Target);
+		return CompileHLSLStringFXC(source, entryPoint, name, shaderMacros.data(), target, outBytecode);
 	}
 
 	class Pipeline
 	{
 	private:
-		static constexpr char PipelineShaderNameShaderTypeSeparatingCharacter = '_';
-		static constexpr const char* PipelineVertexShaderNamePostFixString = "VertexShader";
-		static constexpr const char* PipelinePixelShaderNamePostFixString = "PixelShader";
-
 		Microsoft::WRL::ComPtr<ID3D11VertexShader> VertexShader = {};
 		Microsoft::WRL::ComPtr<ID3D11InputLayout> InputLayout = {};
 		Microsoft::WRL::ComPtr<ID3D11PixelShader> PixelShader = {};
 
-	public:
-		Pipeline() = default;
-		Pipeline(std::string_view name, const ShaderDescription& vertexShaderDescription, const D3D11_INPUT_ELEMENT_DESC* inputElementDescs, UINT numElements,
-			const ShaderDescription& pixelShaderDescription)
+		// Pixel shader permutations. PixelShader is the default permutation's, other permutations are created from the permutations loaded by
+		// PrewarmPixelShaderPermutations.
+		ShaderPermutationSet* PixelShaderPermutations = nullptr;
+		ShaderPermutationKey DefaultPermutation = 0;
+		std::unordered_map<ShaderPermutationKey, Microsoft::WRL::ComPtr<ID3D11PixelShader>> PixelShaderVariants = {};
+
+		// Creates the pixel shader of a loaded permutation, falling back to the default permutation's if it could not be compiled or created.
+		ID3D11PixelShader* CreatePixelShaderVariant(const ShaderPermutationKey permutation, const std::vector<uint8_t>* const compiledPixelShader)
 		{
-			if (!Create(name, vertexShaderDescription, inputElementDescs, numElements, pixelShaderDescription))
+			Microsoft::WRL::ComPtr<ID3D11PixelShader>& variant = PixelShaderVariants[permutation];
+			if ((compiledPixelShader == nullptr) ||
+				FAILED(gD3D11Device->CreatePixelShader(static_cast<const void*>(compiledPixelShader->data()), compiledPixelShader->size(), nullptr, &variant)))
 			{
-				LEVIATHAN_LOG("Failed to create %s rendering pipeline.", name.data());
+				LEVIATHAN_LOG("Failed to create %s permutation %u.", PixelShaderPermutations->GetName().c_str(), permutation);
+				variant = PixelShader;
 			}
+			return variant.Get();
 		}
 
-		bool Create(std::string_view name, const ShaderDescription& vertexShaderDescription, const D3D11_INPUT_ELEMENT_DESC* inputElementDescs, UINT numElements,
-			const ShaderDescription& pixelShaderDescription)
+	public:
+		// Creates the pipeline from compiled shader bytecode. Shaders are compiled or read from the shader cache by CreatePipelines.
+		bool Create(const std::vector<uint8_t>& compiledVertexShader, const D3D11_INPUT_ELEMENT_DESC* inputElementDescs, UINT numElements,
+			const std::vector<uint8_t>& compiledPixelShader)
 		{
-			// Compile shaders.
-			// If previously compiled shader file exists, read its contents into the buffer and use that instead of recompiling the source code.
-			const std::string compiledVertexShaderCacheFile(std::string(CompiledShaderCacheDirectory) +
-				name.data() + CompiledShaderCacheFileTypeSeparatingCharacter + CompiledShaderCacheVertexShaderFilePostFixString);
-			const std::string compiledPixelShaderCacheFile(std::string(CompiledShaderCacheDirectory) +
-				name.data() + CompiledShaderCacheFileTypeSeparatingCharacter + CompiledShaderCachePixelShaderFilePostFixString);
-			const std::string vertexShaderName(std::string(name.data()) + PipelineShaderNameShaderTypeSeparatingCharacter + PipelineVertexShaderNamePostFixString);
-			const std::string pixelShaderName(std::string(name.data()) + PipelineShaderNameShaderTypeSeparatingCharacter + PipelinePixelShaderNamePostFixString);
-
-			std::vector<uint8_t> compiledVertexShader = {};
-			std::vector<uint8_t> compiledPixelShader = {};
-
-			if (ForceShaderRecompilation)
-			{
-				LEVIATHAN_LOG("Forced recompilation of shaders for %s pipeline.", name.data());
-				if (!CompileNewShader(vertexShaderDescription.SourceCodeFile, vertexShaderDescription.EntryPointName, name, vertexShaderDescription.ShaderMacros,
-					SHADER_MODEL_5_VERTEX_SHADER, compiledVertexShaderCacheFile, compiledVertexShader))
-				{
-					return false;
-				}
-				if (!CompileNewShader(pixelShaderDescription.SourceCodeFile, pixelShaderDescription.EntryPointName, name, pixelShaderDescription.ShaderMacros,
-					SHADER_MODEL_5_PIXEL_SHADER, compiledPixelShaderCacheFile, compiledPixelShader))
-				{
-					return false;
-				}
-			}
-			else
-			{
-				if (!TryReadCompiledShaderCacheFileElseCompileNewShader(compiledVertexShaderCacheFile, vertexShaderDescription.SourceCodeFile, vertexShaderDescription.EntryPointName,
-					vertexShaderName, vertexShaderDescription.ShaderMacros, SHADER_MODEL_5_VERTEX_SHADER, compiledVertexShader))
-				{
-					return false;
-				}
-				if (!TryReadCompiledShaderCacheFileElseCompileNewShader(compiledPixelShaderCacheFile, pixelShaderDescription.SourceCodeFile, pixelShaderDescription.EntryPointName,
-					pixelShaderName, pixelShaderDescription.ShaderMacros, SHADER_MODEL_5_PIXEL_SHADER, compiledPixelShader))
-				{
-					return false;
-				}
-			}
-
 			// Create shaders.
 			HRESULT hr = {};
 			hr = gD3D11Device->CreateVertexShader(static_cast<const void*>(compiledVertexShader.data()), compiledVertexShader.size(), nullptr, &VertexShader);
 			if (FAILED(hr)) { return false; };
-			hr = gD3D11Device->CreatePixelShader(static_cast<void*>(compiledPixelShader.data()), compiledPixelShader.size(), nullptr, &PixelShader);
+			hr = gD3D11Device->CreatePixelShader(static_cast<const void*>(compiledPixelShader.data()), compiledPixelShader.size(), nullptr, &PixelShader);
 			if (FAILED(hr)) { return false; };
 
 			// Create input layout.
 			hr = gD3D11Device->CreateInputLayout(inputElementDescs, numElements,
-				static_cast<void*>(compiledVertexShader.data()), compiledVertexShader.size(), &InputLayout);
+				static_cast<const void*>(compiledVertexShader.data()), compiledVertexShader.size(), &InputLayout);
 			if (FAILED(hr)) { return false; };
 
 			return true;
@@ -320,11 +256,82 @@ namespace LeviathanRenderer
 			VertexShader.Reset();
 			InputLayout.Reset();
 			PixelShader.Reset();
+			PixelShaderPermutations = nullptr;
+			DefaultPermutation = 0;
+			PixelShaderVariants.clear();
+		}
+
+		// Makes the pixel shader permutations of the set selectable by GetPixelShader. The pipeline's pixel shader must be the default permutation's.
+		void SetPixelShaderPermutations(ShaderPermutationSet* const permutations, const ShaderPermutationKey defaultPermutation)
+		{
+			PixelShaderPermutations = permutations;
+			DefaultPermutation = defaultPermutation;
+			PixelShaderVariants.clear();
+		}
+
+		// Loads the permutations recorded in the usage list, or every permutation of small sets, in one batch and creates their pixel shaders. Shaders
+		// are never compiled while drawing.
+		void PrewarmPixelShaderPermutations(const std::vector<ShaderUsageRecord>& usageList)
+		{
+			if (PixelShaderPermutations == nullptr)
+			{
+				return;
+			}
+
+			PrewarmFromUsageList(*PixelShaderPermutations, usageList, gShaderCache, gShaderSources, CompileShaderSourceCode, nullptr);
+			if (PixelShaderPermutations->GetPermutationCount() <= MaxPrewarmedPermutationCount)
+			{
+				std::vector<ShaderPermutationKey> permutations(static_cast<size_t>(PixelShaderPermutations->GetPermutationCount()));
+				for (size_t i = 0; i < permutations.size(); ++i)
+				{
+					permutations[i] = static_cast<ShaderPermutationKey>(i);
+				}
+				PixelShaderPermutations->Prewarm(permutations.data(), permutations.size(), gShaderCache, gShaderSources, CompileShaderSourceCode, nullptr);
+			}
+
+			std::vector<ShaderPermutationKey> residentPermutations = {};
+			PixelShaderPermutations->GetResidentKeys(residentPermutations);
+			for (const ShaderPermutationKey permutation : residentPermutations)
+			{
+				if ((permutation != DefaultPermutation) && !PixelShaderVariants.contains(permutation))
+				{
+					CreatePixelShaderVariant(permutation, PixelShaderPermutations->FindPermutation(permutation));
+				}
+			}
 		}
 
 		inline ID3D11InputLayout* GetInputLayout() const { return InputLayout.Get(); }
 		inline ID3D11VertexShader* GetVertexShader() const { return VertexShader.Get(); }
 		inline ID3D11PixelShader* GetPixelShader() const { return PixelShader.Get(); }
+
+		ID3D11PixelShader* GetPixelShader(const ShaderPermutationKey permutation)
+		{
+			if ((PixelShaderPermutations == nullptr) || (permutation == DefaultPermutation))
+			{
+				return PixelShader.Get();
+			}
+
+			// Permutations that were not prewarmed draw with the default permutation. FindPermutation records them so that the next run prewarms
+			// them.
+			const auto found = PixelShaderVariants.find(permutation);
+			if (found != PixelShaderVariants.end())
+			{
+				return found->second.Get();
+			}
+			const std::vector<uint8_t>* const compiledPixelShader = PixelShaderPermutations->FindPermutation(permutation);
+			return (compiledPixelShader != nullptr) ? CreatePixelShaderVariant(permutation, compiledPixelShader) : PixelShader.Get();
+		}
+	};
+
+	// Pipeline created by CreatePipelines.
+	struct PipelineDescription
+	{
+		Pipeline* Target = nullptr;
+		std::string_view Name = {};
+		ShaderDescription VertexShader = {};
+		const D3D11_INPUT_ELEMENT_DESC* InputElementDescs = nullptr;
+		UINT NumElements = 0;
+		ShaderDescription PixelShader = {};
 	};
 
 	// Depth/stencil states.
@@ -370,6 +377,18 @@ namespace LeviathanRenderer
 	static Microsoft::WRL::ComPtr<ID3D11Buffer> gSpotLightBuffer = {};
 	static Microsoft::WRL::ComPtr<ID3D11Buffer> gObjectBuffer = {};
 
+	// Per instance vertex data read by instanced draws. Grows to fit the largest instance stream uploaded.
+	static Microsoft::WRL::ComPtr<ID3D11Buffer> gInstanceBuffer = {};
+	static size_t gInstanceBufferCapacityBytes = 0;
+
+	// Constant data of the frames in flight. Ranges are bound by offset with the Direct3D 11.1 constant buffer offsetting.
+	static Microsoft::WRL::ComPtr<ID3D11Buffer> gConstantUploadBuffer = {};
+
+	// Frame fences. The event query of a frame is signalled once the gpu completed the frame's commands.
+	static std::array<Microsoft::WRL::ComPtr<ID3D11Query>, RendererConstants::MaxFramesInFlight> gFrameFenceQueries = {};
+	static uint64_t gSignalledFrameFence = 0;
+	static uint64_t gCompletedFrameFence = 0;
+
 	// Shader resource tables.
 	static std::array<Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>, RendererConstants::Texture2DSRVTableLength> gTexture2DSRVTable = { nullptr };
 	static std::array<Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>, RendererConstants::TextureCubeSRVTableLength> gTextureCubeSRVTable = { nullptr };
@@ -459,6 +478,16 @@ namespace LeviathanRenderer
 		return true;
 	}
 
+	// Converts a byte range of the constant upload buffer to the range of 16 byte constants bound by *SetConstantBuffers1. The constant count must be a
+	// multiple of 16 so the width is rounded up, which stays inside the range allocated by the upload ring.
+	static void GetConstantUploadBufferRange(size_t byteOffset, size_t byteWidth, UINT& outFirstConstant, UINT& outConstantCount)
+	{
+		static constexpr size_t constantSizeBytes = 16;
+		outFirstConstant = static_cast<UINT>(byteOffset / constantSizeBytes);
+		outConstantCount = static_cast<UINT>(((byteWidth + RendererConstants::ConstantUploadAlignmentBytes - 1) / RendererConstants::ConstantUploadAlignmentBytes) *
+			(RendererConstants::ConstantUploadAlignmentBytes / constantSizeBytes));
+	}
+
 	static D3D11_FILTER TranslateTextureSamplerFilter(const TextureSamplerFilter filter)
 	{
 		switch (filter)
@@ -535,6 +564,31 @@ namespace LeviathanRenderer
 		return numLevels;
 	}
 
+	static void SaveShaderCache()
+	{
+		if (gShaderCache.IsDirty() && !gShaderCache.Save(CompiledShaderCachePackFile))
+		{
+			LEVIATHAN_LOG("Failed to save shader cache %s.", CompiledShaderCachePackFile);
+		}
+	}
+
+	// Records the permutations used in this run, including the ones drawn with the default permutation because they were not prewarmed.
+	static void SaveShaderUsage()
+	{
+		const std::array<const ShaderPermutationSet*, 3> permutationSets =
+		{
+			&gDirectionalLightPixelShaderPermutations,
+			&gPointLightPixelShaderPermutations,
+			&gSpotLightPixelShaderPermutations
+		};
+
+		if (!SaveShaderUsageList(ShaderUsageListFile, permutationSets.data(), permutationSets.size()))
+		{
+			LEVIATHAN_LOG("Failed to save shader usage list %s.", ShaderUsageListFile);
+		}
+		SaveShaderCache();
+	}
+
 	static bool CreatePipelines()
 	{
 		// Equirectangular to cubemap.
@@ -552,10 +606,6 @@ namespace LeviathanRenderer
 			}
 		};
 
-		bool success = gEquirectangularToCubemapPipeline.Create("EquirectToCubemapPipeline", { .SourceCodeFile = "EquirectToCubemapVertexShader.hlsl", .EntryPointName = "main", .ShaderMacros = nullptr },
-			equirectToCubemapInputLayoutDesc.data(), static_cast<UINT>(equirectToCubemapInputLayoutDesc.size()), { .SourceCodeFile = "EquirectToCubemapPixelShader.hlsl", .EntryPointName = "main", .ShaderMacros = nullptr });
-		if (!success) { return false; }
-
 		// Skybox.
 		static constexpr std::array<D3D11_INPUT_ELEMENT_DESC, 1> skyboxInputLayoutDesc =
 		{
@@ -571,12 +621,8 @@ namespace LeviathanRenderer
 			}
 		};
 
-		success = gSkyboxPipeline.Create("SkyboxPipeline", { .SourceCodeFile = "SkyboxVertexShader.hlsl", .EntryPointName = "main", .ShaderMacros = nullptr },
-			skyboxInputLayoutDesc.data(), static_cast<UINT>(skyboxInputLayoutDesc.size()), { .SourceCodeFile = "SkyboxPixelShader.hlsl", .EntryPointName = "main", .ShaderMacros = nullptr });
-		if (!success) { return false; }
-
-		// Lighting passes.
-		static constexpr std::array<D3D11_INPUT_ELEMENT_DESC, 4> lightingPassInputLayoutDesc =
+		// Lighting passes. Vertex data is read from slot 0 and per instance object data from the instance stream in slot 1.
+		static constexpr std::array<D3D11_INPUT_ELEMENT_DESC, 16> lightingPassInputLayoutDesc =
 		{
 			D3D11_INPUT_ELEMENT_DESC
 			{
@@ -620,63 +666,182 @@ namespace LeviathanRenderer
 				.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT,
 				.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA,
 				.InstanceDataStepRate = 0
+			},
+
+			D3D11_INPUT_ELEMENT_DESC
+			{
+				.SemanticName = "WORLD_VIEW_MATRIX",
+				.SemanticIndex = 0,
+				.Format = DXGI_FORMAT_R32G32B32A32_FLOAT,
+				.InputSlot = 1,
+				.AlignedByteOffset = 0,
+				.InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA,
+				.InstanceDataStepRate = 1
+			},
+
+			D3D11_INPUT_ELEMENT_DESC
+			{
+				.SemanticName = "WORLD_VIEW_MATRIX",
+				.SemanticIndex = 1,
+				.Format = DXGI_FORMAT_R32G32B32A32_FLOAT,
+				.InputSlot = 1,
+				.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT,
+				.InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA,
+				.InstanceDataStepRate = 1
+			},
+
+			D3D11_INPUT_ELEMENT_DESC
+			{
+				.SemanticName = "WORLD_VIEW_MATRIX",
+				.SemanticIndex = 2,
+				.Format = DXGI_FORMAT_R32G32B32A32_FLOAT,
+				.InputSlot = 1,
+				.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT,
+				.InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA,
+				.InstanceDataStepRate = 1
+			},
+
+			D3D11_INPUT_ELEMENT_DESC
+			{
+				.SemanticName = "WORLD_VIEW_MATRIX",
+				.SemanticIndex = 3,
+				.Format = DXGI_FORMAT_R32G32B32A32_FLOAT,
+				.InputSlot = 1,
+				.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT,
+				.InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA,
+				.InstanceDataStepRate = 1
+			},
+
+			D3D11_INPUT_ELEMENT_DESC
+			{
+				.SemanticName = "WORLD_VIEW_PROJECTION_MATRIX",
+				.SemanticIndex = 0,
+				.Format = DXGI_FORMAT_R32G32B32A32_FLOAT,
+				.InputSlot = 1,
+				.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT,
+				.InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA,
+				.InstanceDataStepRate = 1
+			},
+
+			D3D11_INPUT_ELEMENT_DESC
+			{
+				.SemanticName = "WORLD_VIEW_PROJECTION_MATRIX",
+				.SemanticIndex = 1,
+				.Format = DXGI_FORMAT_R32G32B32A32_FLOAT,
+				.InputSlot = 1,
+				.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT,
+				.InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA,
+				.InstanceDataStepRate = 1
+			},
+
+			D3D11_INPUT_ELEMENT_DESC
+			{
+				.SemanticName = "WORLD_VIEW_PROJECTION_MATRIX",
+				.SemanticIndex = 2,
+				.Format = DXGI_FORMAT_R32G32B32A32_FLOAT,
+				.InputSlot = 1,
+				.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT,
+				.InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA,
+				.InstanceDataStepRate = 1
+			},
+
+			D3D11_INPUT_ELEMENT_DESC
+			{
+				.SemanticName = "WORLD_VIEW_PROJECTION_MATRIX",
+				.SemanticIndex = 3,
+				.Format = DXGI_FORMAT_R32G32B32A32_FLOAT,
+				.InputSlot = 1,
+				.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT,
+				.InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA,
+				.InstanceDataStepRate = 1
+			},
+
+			D3D11_INPUT_ELEMENT_DESC
+			{
+				.SemanticName = "NORMAL_MATRIX",
+				.SemanticIndex = 0,
+				.Format = DXGI_FORMAT_R32G32B32A32_FLOAT,
+				.InputSlot = 1,
+				.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT,
+				.InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA,
+				.InstanceDataStepRate = 1
+			},
+
+			D3D11_INPUT_ELEMENT_DESC
+			{
+				.SemanticName = "NORMAL_MATRIX",
+				.SemanticIndex = 1,
+				.Format = DXGI_FORMAT_R32G32B32A32_FLOAT,
+				.InputSlot = 1,
+				.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT,
+				.InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA,
+				.InstanceDataStepRate = 1
+			},
+
+			D3D11_INPUT_ELEMENT_DESC
+			{
+				.SemanticName = "NORMAL_MATRIX",
+				.SemanticIndex = 2,
+				.Format = DXGI_FORMAT_R32G32B32A32_FLOAT,
+				.InputSlot = 1,
+				.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT,
+				.InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA,
+				.InstanceDataStepRate = 1
+			},
+
+			D3D11_INPUT_ELEMENT_DESC
+			{
+				.SemanticName = "NORMAL_MATRIX",
+				.SemanticIndex = 3,
+				.Format = DXGI_FORMAT_R32G32B32A32_FLOAT,
+				.InputSlot = 1,
+				.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT,
+				.InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA,
+				.InstanceDataStepRate = 1
 			}
 		};
 
-		static constexpr std::array<D3D_SHADER_MACRO, 13> environmentLightingPassPixelShaderDefinitions =
+		static constexpr std::array<ShaderMacro, 7> environmentLightingPassPixelShaderDefinitions =
 		{
-			D3D_SHADER_MACRO{.Name = "TEXTURE2D_SRV_TABLE_LENGTH", .Definition = RendererConstants::Texture2DSRVTableLengthString },
-			D3D_SHADER_MACRO{.Name = "TEXTURE_CUBE_SRV_TABLE_LENGTH", .Definition = RendererConstants::TextureCubeSRVTableLengthString },
-			D3D_SHADER_MACRO{.Name = "TEXTURE_SAMPLER_TABLE_LENGTH", .Definition = RendererConstants::TextureSamplerTableLengthString },
-			D3D_SHADER_MACRO{.Name = "ENVIRONMENT_TEXTURE_CUBE_SRV_TABLE_INDEX", .Definition = RendererConstants::EnvironmentTextureSamplerTableIndexString },
-			D3D_SHADER_MACRO{.Name = "ENVIRONMENT_TEXTURE_CUBE_SAMPLER_TABLE_INDEX", .Definition = RendererConstants::EnvironmentTextureCubeSRVTableIndexString },
-			D3D_SHADER_MACRO{.Name = "COLOR_TEXTURE2D_SRV_TABLE_INDEX", .Definition = RendererConstants::ColorTexture2DSRVTableIndexString },
-			D3D_SHADER_MACRO{.Name = "COLOR_TEXTURE_SAMPLER_TABLE_INDEX", .Definition = RendererConstants::ColorTextureSamplerTableIndexString },
-			D3D_SHADER_MACRO{.Name = nullptr, .Definition = nullptr }
+			ShaderMacro{ .Name = "TEXTURE2D_SRV_TABLE_LENGTH", .Definition = RendererConstants::Texture2DSRVTableLengthString },
+			ShaderMacro{ .Name = "TEXTURE_CUBE_SRV_TABLE_LENGTH", .Definition = RendererConstants::TextureCubeSRVTableLengthString },
+			ShaderMacro{ .Name = "TEXTURE_SAMPLER_TABLE_LENGTH", .Definition = RendererConstants::TextureSamplerTableLengthString },
+			ShaderMacro{ .Name = "ENVIRONMENT_TEXTURE_CUBE_SRV_TABLE_INDEX", .Definition = RendererConstants::EnvironmentTextureSamplerTableIndexString },
+			ShaderMacro{ .Name = "ENVIRONMENT_TEXTURE_CUBE_SAMPLER_TABLE_INDEX", .Definition = RendererConstants::EnvironmentTextureCubeSRVTableIndexString },
+			ShaderMacro{ .Name = "COLOR_TEXTURE2D_SRV_TABLE_INDEX", .Definition = RendererConstants::ColorTexture2DSRVTableIndexString },
+			ShaderMacro{ .Name = "COLOR_TEXTURE_SAMPLER_TABLE_INDEX", .Definition = RendererConstants::ColorTextureSamplerTableIndexString }
 		};
 
-		success = gEnvironmentLightPipeline.Create("EnvironmentLightPipeline", { .SourceCodeFile = "EnvironmentLightVertexShader.hlsl", .EntryPointName = "main", .ShaderMacros = nullptr },
-			lightingPassInputLayoutDesc.data(), static_cast<UINT>(lightingPassInputLayoutDesc.size()),
-			{ .SourceCodeFile = "EnvironmentLightPixelShader.hlsl", .EntryPointName = "main", .ShaderMacros = environmentLightingPassPixelShaderDefinitions.data() });
-		if (!success) { return false; }
-
-		static constexpr std::array<D3D_SHADER_MACRO, 13> lightingPassPixelShaderDefinitions =
+		static constexpr std::array<ShaderMacro, 12> lightingPassPixelShaderDefinitions =
 		{
-			D3D_SHADER_MACRO{.Name = "TEXTURE2D_SRV_TABLE_LENGTH", .Definition = RendererConstants::Texture2DSRVTableLengthString },
-			D3D_SHADER_MACRO{.Name = "TEXTURE_SAMPLER_TABLE_LENGTH", .Definition = RendererConstants::TextureSamplerTableLengthString },
-			D3D_SHADER_MACRO{.Name = "ENVIRONMENT_CUBEMAP_SRV_TABLE_INDEX", .Definition = RendererConstants::EnvironmentTextureCubeSRVTableIndexString },
-			D3D_SHADER_MACRO{.Name = "COLOR_TEXTURE2D_SRV_TABLE_INDEX", .Definition = RendererConstants::ColorTexture2DSRVTableIndexString },
-			D3D_SHADER_MACRO{.Name = "ROUGHNESS_TEXTURE2D_SRV_TABLE_INDEX", .Definition = RendererConstants::RoughnessTexture2DSRVTableIndexString },
-			D3D_SHADER_MACRO{.Name = "METALLIC_TEXTURE2D_SRV_TABLE_INDEX", .Definition = RendererConstants::MetallicTexture2DSRVTableIndexString },
-			D3D_SHADER_MACRO{.Name = "NORMAL_TEXTURE2D_SRV_TABLE_INDEX", .Definition = RendererConstants::NormalTexture2DSRVTableIndexString },
-			D3D_SHADER_MACRO{.Name = "COLOR_TEXTURE_SAMPLER_TABLE_INDEX", .Definition = RendererConstants::ColorTextureSamplerTableIndexString },
-			D3D_SHADER_MACRO{.Name = "ROUGHNESS_TEXTURE_SAMPLER_TABLE_INDEX", .Definition = RendererConstants::RoughnessTextureSamplerTableIndexString },
-			D3D_SHADER_MACRO{.Name = "METALLIC_TEXTURE_SAMPLER_TABLE_INDEX", .Definition = RendererConstants::MetallicTextureSamplerTableIndexString },
-			D3D_SHADER_MACRO{.Name = "NORMAL_TEXTURE_SAMPLER_TABLE_INDEX", .Definition = RendererConstants::NormalTextureSamplerTableIndexString },
-			D3D_SHADER_MACRO{.Name = "PI", .Definition = LeviathanCore::MathLibrary::PiString },
-			D3D_SHADER_MACRO{.Name = nullptr, .Definition = nullptr }
+			ShaderMacro{ .Name = "TEXTURE2D_SRV_TABLE_LENGTH", .Definition = RendererConstants::Texture2DSRVTableLengthString },
+			ShaderMacro{ .Name = "TEXTURE_SAMPLER_TABLE_LENGTH", .Definition = RendererConstants::TextureSamplerTableLengthString },
+			ShaderMacro{ .Name = "ENVIRONMENT_CUBEMAP_SRV_TABLE_INDEX", .Definition = RendererConstants::EnvironmentTextureCubeSRVTableIndexString },
+			ShaderMacro{ .Name = "COLOR_TEXTURE2D_SRV_TABLE_INDEX", .Definition = RendererConstants::ColorTexture2DSRVTableIndexString },
+			ShaderMacro{ .Name = "ROUGHNESS_TEXTURE2D_SRV_TABLE_INDEX", .Definition = RendererConstants::RoughnessTexture2DSRVTableIndexString },
+			ShaderMacro{ .Name = "METALLIC_TEXTURE2D_SRV_TABLE_INDEX", .Definition = RendererConstants::MetallicTexture2DSRVTableIndexString },
+			ShaderMacro{ .Name = "NORMAL_TEXTURE2D_SRV_TABLE_INDEX", .Definition = RendererConstants::NormalTexture2DSRVTableIndexString },
+			ShaderMacro{ .Name = "COLOR_TEXTURE_SAMPLER_TABLE_INDEX", .Definition = RendererConstants::ColorTextureSamplerTableIndexString },
+			ShaderMacro{ .Name = "ROUGHNESS_TEXTURE_SAMPLER_TABLE_INDEX", .Definition = RendererConstants::RoughnessTextureSamplerTableIndexString },
+			ShaderMacro{ .Name = "METALLIC_TEXTURE_SAMPLER_TABLE_INDEX", .Definition = RendererConstants::MetallicTextureSamplerTableIndexString },
+			ShaderMacro{ .Name = "NORMAL_TEXTURE_SAMPLER_TABLE_INDEX", .Definition = RendererConstants::NormalTextureSamplerTableIndexString },
+			ShaderMacro{ .Name = "PI", .Definition = LeviathanCore::MathLibrary::PiString }
 		};
 
-		success = gDirectionalLightPipeline.Create("DirectionalLightPipeline",
-			{ .SourceCodeFile = "DirectionalLightVertexShader.hlsl", .EntryPointName = "main", .ShaderMacros = nullptr },
-			lightingPassInputLayoutDesc.data(),
-			static_cast<UINT>(lightingPassInputLayoutDesc.size()),
-			{ .SourceCodeFile = "DirectionalLightPixelShader.hlsl", .EntryPointName = "main", .ShaderMacros = lightingPassPixelShaderDefinitions.data() });
-		if (!success) { return false; }
-
-		success = gPointLightPipeline.Create("PointLightPipeline",
-			{ .SourceCodeFile = "PointLightVertexShader.hlsl", .EntryPointName = "main", .ShaderMacros = nullptr },
-			lightingPassInputLayoutDesc.data(),
-			static_cast<UINT>(lightingPassInputLayoutDesc.size()),
-			{ .SourceCodeFile = "PointLightPixelShader.hlsl", .EntryPointName = "main", .ShaderMacros = lightingPassPixelShaderDefinitions.data() });
-		if (!success) { return false; }
+		// Lighting pixel shaders are permutations of the lighting features. Pipelines are created with the normal mapped permutation, which shares its
+		// macros between the three lighting pixel shaders.
+		const auto createLightingPixelShaderPermutations = [](const std::string_view name, const std::string_view sourceCodeFile)
+			{
+				return ShaderPermutationSet(name, ShaderCompileDescription{ .SourceFile = sourceCodeFile, .EntryPoint = "main", .Target = SHADER_MODEL_5_PIXEL_SHADER,
+					.Macros = lightingPassPixelShaderDefinitions.data(), .MacroCount = lightingPassPixelShaderDefinitions.size() },
+					RendererConstants::LightingPixelShaderFeatures.data(), RendererConstants::LightingPixelShaderFeatures.size());
+			};
+		gDirectionalLightPixelShaderPermutations = createLightingPixelShaderPermutations("DirectionalLightPixelShader", "DirectionalLightPixelShader.hlsl");
+		gPointLightPixelShaderPermutations = createLightingPixelShaderPermutations("PointLightPixelShader", "PointLightPixelShader.hlsl");
+		gSpotLightPixelShaderPermutations = createLightingPixelShaderPermutations("SpotLightPixelShader", "SpotLightPixelShader.hlsl");
 
-		success = gSpotLightPipeline.Create("SpotLightPipeline",
-			{ .SourceCodeFile = "SpotLightVertexShader.hlsl", .EntryPointName = "main", .ShaderMacros = nullptr },
-			lightingPassInputLayoutDesc.data(),
-			static_cast<UINT>(lightingPassInputLayoutDesc.size()),
-			{ .SourceCodeFile = "SpotLightPixelShader.hlsl", .EntryPointName = "main", .ShaderMacros = lightingPassPixelShaderDefinitions.data() });
-		if (!success) { return false; }
+		std::vector<ShaderMacro> lightingPassPixelShaderPermutationDefinitions = {};
+		gDirectionalLightPixelShaderPermutations.GetMacros(RendererConstants::NormalMappedLightingPermutation, lightingPassPixelShaderPermutationDefinitions);
 
 		// Post processing.
 		static constexpr std::array<D3D11_INPUT_ELEMENT_DESC, 2> postProcessPassInputLayoutDesc =
@@ -704,12 +869,89 @@ namespace LeviathanRenderer
 			}
 		};
 
-		success = gPostProcessPipeline.Create("PostProcessPipeline", { .SourceCodeFile = "PostProcessVertexShader.hlsl", .EntryPointName = "main", .ShaderMacros = nullptr },
-			postProcessPassInputLayoutDesc.data(), static_cast<UINT>(postProcessPassInputLayoutDesc.size()),
-			{ .SourceCodeFile = "PostProcessPixelShader.hlsl", .EntryPointName = "main", .ShaderMacros = nullptr });
-		if (!success) { return false; }
+		const std::array<PipelineDescription, 7> pipelines =
+		{
+			PipelineDescription{ .Target = &gEquirectangularToCubemapPipeline, .Name = "EquirectToCubemapPipeline",
+				.VertexShader = { .SourceCodeFile = "EquirectToCubemapVertexShader.hlsl", .EntryPointName = "main", .ShaderMacros = nullptr, .ShaderMacroCount = 0 },
+				.InputElementDescs = equirectToCubemapInputLayoutDesc.data(), .NumElements = static_cast<UINT>(equirectToCubemapInputLayoutDesc.size()),
+				.PixelShader = { .SourceCodeFile = "EquirectToCubemapPixelShader.hlsl", .EntryPointName = "main", .ShaderMacros = nullptr, .ShaderMacroCount = 0 } },
+
+			PipelineDescription{ .Target = &gSkyboxPipeline, .Name = "SkyboxPipeline",
+				.VertexShader = { .SourceCodeFile = "SkyboxVertexShader.hlsl", .EntryPointName = "main", .ShaderMacros = nullptr, .ShaderMacroCount = 0 },
+				.InputElementDescs = skyboxInputLayoutDesc.data(), .NumElements = static_cast<UINT>(skyboxInputLayoutDesc.size()),
+				.PixelShader = { .SourceCodeFile = "SkyboxPixelShader.hlsl", .EntryPointName = "main", .ShaderMacros = nullptr, .ShaderMacroCount = 0 } },
+
+			PipelineDescription{ .Target = &gEnvironmentLightPipeline, .Name = "EnvironmentLightPipeline",
+				.VertexShader = { .SourceCodeFile = "EnvironmentLightVertexShader.hlsl", .EntryPointName = "main", .ShaderMacros = nullptr, .ShaderMacroCount = 0 },
+				.InputElementDescs = lightingPassInputLayoutDesc.data(), .NumElements = static_cast<UINT>(lightingPassInputLayoutDesc.size()),
+				.PixelShader = { .SourceCodeFile = "EnvironmentLightPixelShader.hlsl", .EntryPointName = "main", .ShaderMacros = environmentLightingPassPixelShaderDefinitions.data(), .ShaderMacroCount = environmentLightingPassPixelShaderDefinitions.size() } },
+
+			PipelineDescription{ .Target = &gDirectionalLightPipeline, .Name = "DirectionalLightPipeline",
+				.VertexShader = { .SourceCodeFile = "DirectionalLightVertexShader.hlsl", .EntryPointName = "main", .ShaderMacros = nullptr, .ShaderMacroCount = 0 },
+				.InputElementDescs = lightingPassInputLayoutDesc.data(), .NumElements = static_cast<UINT>(lightingPassInputLayoutDesc.size()),
+				.PixelShader = { .SourceCodeFile = "DirectionalLightPixelShader.hlsl", .EntryPointName = "main", .ShaderMacros = lightingPassPixelShaderPermutationDefinitions.data(), .ShaderMacroCount = lightingPassPixelShaderPermutationDefinitions.size() } },
+
+			PipelineDescription{ .Target = &gPointLightPipeline, .Name = "PointLightPipeline",
+				.VertexShader = { .SourceCodeFile = "PointLightVertexShader.hlsl", .EntryPointName = "main", .ShaderMacros = nullptr, .ShaderMacroCount = 0 },
+				.InputElementDescs = lightingPassInputLayoutDesc.data(), .NumElements = static_cast<UINT>(lightingPassInputLayoutDesc.size()),
+				.PixelShader = { .SourceCodeFile = "PointLightPixelShader.hlsl", .EntryPointName = "main", .ShaderMacros = lightingPassPixelShaderPermutationDefinitions.data(), .ShaderMacroCount = lightingPassPixelShaderPermutationDefinitions.size() } },
+
+			PipelineDescription{ .Target = &gSpotLightPipeline, .Name = "SpotLightPipeline",
+				.VertexShader = { .SourceCodeFile = "SpotLightVertexShader.hlsl", .EntryPointName = "main", .ShaderMacros = nullptr, .ShaderMacroCount = 0 },
+				.InputElementDescs = lightingPassInputLayoutDesc.data(), .NumElements = static_cast<UINT>(lightingPassInputLayoutDesc.size()),
+				.PixelShader = { .SourceCodeFile = "SpotLightPixelShader.hlsl", .EntryPointName = "main", .ShaderMacros = lightingPassPixelShaderPermutationDefinitions.data(), .ShaderMacroCount = lightingPassPixelShaderPermutationDefinitions.size() } },
+
+			PipelineDescription{ .Target = &gPostProcessPipeline, .Name = "PostProcessPipeline",
+				.VertexShader = { .SourceCodeFile = "PostProcessVertexShader.hlsl", .EntryPointName = "main", .ShaderMacros = nullptr, .ShaderMacroCount = 0 },
+				.InputElementDescs = postProcessPassInputLayoutDesc.data(), .NumElements = static_cast<UINT>(postProcessPassInputLayoutDesc.size()),
+				.PixelShader = { .SourceCodeFile = "PostProcessPixelShader.hlsl", .EntryPointName = "main", .ShaderMacros = nullptr, .ShaderMacroCount = 0 } }
+		};
 
-		return success;
+		// Look up every shader in the shader cache. Shaders missing from the cache are compiled in parallel.
+		std::vector<ShaderCompileDescription> shaders = {};
+		shaders.reserve(pipelines.size() * 2);
+		for (const PipelineDescription& pipeline : pipelines)
+		{
+			shaders.push_back(ShaderCompileDescription{ .SourceFile = pipeline.VertexShader.SourceCodeFile, .EntryPoint = pipeline.VertexShader.EntryPointName,
+				.Target = SHADER_MODEL_5_VERTEX_SHADER, .Macros = pipeline.VertexShader.ShaderMacros, .MacroCount = pipeline.VertexShader.ShaderMacroCount });
+			shaders.push_back(ShaderCompileDescription{ .SourceFile = pipeline.PixelShader.SourceCodeFile, .EntryPoint = pipeline.PixelShader.EntryPointName,
+				.Target = SHADER_MODEL_5_PIXEL_SHADER, .Macros = pipeline.PixelShader.ShaderMacros, .MacroCount = pipeline.PixelShader.ShaderMacroCount });
+		}
+
+		std::vector<const std::vector<uint8_t>*> compiledShaders = {};
+		gShaderCache.GetOrCompile(gShaderSources, shaders.data(), shaders.size(), CompileShaderSourceCode, nullptr, compiledShaders);
+		LEVIATHAN_LOG("Shader cache: %llu hits, %llu compiled.", static_cast<unsigned long long>(gShaderCache.GetStats().Hits),
+			static_cast<unsigned long long>(gShaderCache.GetStats().Misses));
+
+		// Store newly compiled shaders before creating pipelines so that they are not compiled again if pipeline creation fails.
+		SaveShaderCache();
+
+		for (size_t i = 0; i < pipelines.size(); ++i)
+		{
+			const PipelineDescription& pipeline = pipelines[i];
+			const std::vector<uint8_t>* const compiledVertexShader = compiledShaders[i * 2];
+			const std::vector<uint8_t>* const compiledPixelShader = compiledShaders[(i * 2) + 1];
+			if ((compiledVertexShader == nullptr) || (compiledPixelShader == nullptr) ||
+				!pipeline.Target->Create(*compiledVertexShader, pipeline.InputElementDescs, pipeline.NumElements, *compiledPixelShader))
+			{
+				LEVIATHAN_LOG("Failed to create %s rendering pipeline.", pipeline.Name.data());
+				return false;
+			}
+		}
+
+		// Prewarm the lighting permutations used in the previous run.
+		gDirectionalLightPipeline.SetPixelShaderPermutations(&gDirectionalLightPixelShaderPermutations, RendererConstants::NormalMappedLightingPermutation);
+		gPointLightPipeline.SetPixelShaderPermutations(&gPointLightPixelShaderPermutations, RendererConstants::NormalMappedLightingPermutation);
+		gSpotLightPipeline.SetPixelShaderPermutations(&gSpotLightPixelShaderPermutations, RendererConstants::NormalMappedLightingPermutation);
+
+		std::vector<ShaderUsageRecord> shaderUsageList = {};
+		LoadShaderUsageList(ShaderUsageListFile, shaderUsageList);
+		gDirectionalLightPipeline.PrewarmPixelShaderPermutations(shaderUsageList);
+		gPointLightPipeline.PrewarmPixelShaderPermutations(shaderUsageList);
+		gSpotLightPipeline.PrewarmPixelShaderPermutations(shaderUsageList);
+		SaveShaderCache();
+
+		return true;
 	}
 
 	bool Renderer::InitializeRendererApi(unsigned int width, unsigned int height, void* windowPlatformHandle, bool vsync, unsigned int bufferCount)
@@ -761,6 +1003,22 @@ namespace LeviathanRenderer
 			&gD3D11Device, &gFeatureLevel, &gD3D11DeviceContext);
 		if (FAILED(hr)) { return false; };
 
+		// Constant data is bound as ranges of one upload buffer written without renaming, which requires Direct3D 11.1 constant buffer offsetting and
+		// no overwrite maps of dynamic constant buffers. Without them constant data is written to a buffer per constant buffer type bound whole.
+		gConstantBufferRangesSupported = false;
+		hr = gD3D11DeviceContext.As(&gD3D11DeviceContext1);
+		if (SUCCEEDED(hr))
+		{
+			D3D11_FEATURE_DATA_D3D11_OPTIONS options = {};
+			hr = gD3D11Device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options));
+			gConstantBufferRangesSupported = (SUCCEEDED(hr)) && (options.ConstantBufferOffsetting) && (options.MapNoOverwriteOnDynamicConstantBuffer);
+		}
+		if (!gConstantBufferRangesSupported)
+		{
+			gD3D11DeviceContext1.Reset();
+			LEVIATHAN_LOG("Constant buffer offsetting is not supported. Constant buffers are updated and bound whole.");
+		}
+
 		// Create the swap chain.
 		DXGI_SWAP_CHAIN_DESC1 swapChainDesc = {};
 		swapChainDesc.Width = width;
@@ -913,6 +1171,10 @@ namespace LeviathanRenderer
 			LeviathanCore::Serialize::MakeDirectory(CompiledShaderCacheDirectory);
 		}
 
+		// Load compiled shaders from previous runs. A missing or invalid pack leaves the cache empty and every shader is compiled.
+		gShaderSources.SetReadFunction(ReadShaderSourceCodeFileContents, nullptr);
+		gShaderCache.Load(CompiledShaderCachePackFile);
+
 		// Create pipelines.
 		if (!CreatePipelines())
 		{
@@ -933,6 +1195,32 @@ namespace LeviathanRenderer
 		success = CreateDefaultConstantBuffer<ConstantBufferTypes::ObjectConstantBuffer>(&gObjectBuffer);
 		if (!success) { return false; }
 
+		// Create constant upload buffer.
+		if (gConstantBufferRangesSupported)
+		{
+			D3D11_BUFFER_DESC constantUploadBufferDesc = {};
+			constantUploadBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+			constantUploadBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+			constantUploadBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+			constantUploadBufferDesc.MiscFlags = 0;
+			constantUploadBufferDesc.ByteWidth = static_cast<UINT>(RendererConstants::ConstantUploadBufferSizeBytes);
+			constantUploadBufferDesc.StructureByteStride = 0;
+			hr = gD3D11Device->CreateBuffer(&constantUploadBufferDesc, nullptr, &gConstantUploadBuffer);
+			if (FAILED(hr)) { return false; }
+		}
+
+		// Create frame fence queries.
+		D3D11_QUERY_DESC frameFenceQueryDesc = {};
+		frameFenceQueryDesc.Query = D3D11_QUERY_EVENT;
+		frameFenceQueryDesc.MiscFlags = 0;
+		for (Microsoft::WRL::ComPtr<ID3D11Query>& query : gFrameFenceQueries)
+		{
+			hr = gD3D11Device->CreateQuery(&frameFenceQueryDesc, &query);
+			if (FAILED(hr)) { return false; }
+		}
+		gSignalledFrameFence = 0;
+		gCompletedFrameFence = 0;
+
 		// Set primitive topology.
 		gD3D11DeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
@@ -947,6 +1235,8 @@ namespace LeviathanRenderer
 
 		gD3D11Device.Reset();
 		gD3D11DeviceContext.Reset();
+		gD3D11DeviceContext1.Reset();
+		gConstantBufferRangesSupported = false;
 		gSwapChain.Reset();
 		gFeatureLevel = {};
 		gBackBufferRenderTargetView.Reset();
@@ -966,6 +1256,7 @@ namespace LeviathanRenderer
 		gBlendStateAdditive.Reset();
 		gViewport = {};
 
+		SaveShaderUsage();
 		gEquirectangularToCubemapPipeline.Destroy();
 		gSkyboxPipeline.Destroy();
 		gEnvironmentLightPipeline.Destroy();
@@ -973,6 +1264,11 @@ namespace LeviathanRenderer
 		gPointLightPipeline.Destroy();
 		gSpotLightPipeline.Destroy();
 		gPostProcessPipeline.Destroy();
+		gDirectionalLightPixelShaderPermutations.ClearPermutations();
+		gPointLightPixelShaderPermutations.ClearPermutations();
+		gSpotLightPixelShaderPermutations.ClearPermutations();
+		gShaderCache.Clear();
+		gShaderSources.Clear();
 
 		gEquirectangularToCubemapBuffer.Reset();
 		gSkyboxBuffer.Reset();
@@ -980,6 +1276,15 @@ namespace LeviathanRenderer
 		gPointLightBuffer.Reset();
 		gSpotLightBuffer.Reset();
 		gObjectBuffer.Reset();
+		gInstanceBuffer.Reset();
+		gInstanceBufferCapacityBytes = 0;
+		gConstantUploadBuffer.Reset();
+		for (Microsoft::WRL::ComPtr<ID3D11Query>& query : gFrameFenceQueries)
+		{
+			query.Reset();
+		}
+		gSignalledFrameFence = 0;
+		gCompletedFrameFence = 0;
 
 		gVertexBuffers.clear();
 		gIndexBuffers.clear();
@@ -1168,6 +1473,110 @@ namespace LeviathanRenderer
 		resourceID = RendererResourceId::InvalidId;
 	}
 
+	static bool CreateTexture2DMipsView(const D3D11_TEXTURE2D_DESC& texture2DDesc, const D3D11_SUBRESOURCE_DATA* initDatas,
+		Microsoft::WRL::ComPtr<ID3D11Texture2D>& outTexture, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>& outView)
+	{
+		HRESULT hr = gD3D11Device->CreateTexture2D(&texture2DDesc, initDatas, outTexture.ReleaseAndGetAddressOf());
+		if (FAILED(hr)) { return false; }
+
+		D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+		srvDesc.Format = texture2DDesc.Format;
+		srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+		srvDesc.Texture2D.MipLevels = texture2DDesc.MipLevels;
+		srvDesc.Texture2D.MostDetailedMip = 0;
+
+		hr = gD3D11Device->CreateShaderResourceView(outTexture.Get(), &srvDesc, outView.ReleaseAndGetAddressOf());
+		return SUCCEEDED(hr);
+	}
+
+	bool Renderer::CreateTexture2DMips(uint32_t width, uint32_t height, uint32_t mipCount, const void* const* mipData, bool sRGB, RendererResourceId::IdType& outId)
+	{
+		static constexpr uint32_t bytesPerPixel = 4;
+
+		D3D11_TEXTURE2D_DESC texture2DDesc = {};
+		texture2DDesc.Width = width;
+		texture2DDesc.Height = height;
+		texture2DDesc.MipLevels = mipCount;
+		texture2DDesc.ArraySize = 1;
+		texture2DDesc.Format = ((sRGB) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM);
+		texture2DDesc.SampleDesc.Count = 1;
+		texture2DDesc.SampleDesc.Quality = 0;
+		texture2DDesc.Usage = D3D11_USAGE_DEFAULT;
+		texture2DDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+		texture2DDesc.CPUAccessFlags = 0;
+		texture2DDesc.MiscFlags = 0;
+
+		std::vector<D3D11_SUBRESOURCE_DATA> initDatas(mipCount, D3D11_SUBRESOURCE_DATA{});
+		for (uint32_t mip = 0; mip < mipCount; ++mip)
+		{
+			initDatas[mip].pSysMem = mipData[mip];
+			initDatas[mip].SysMemPitch = static_cast<UINT>(std::max(width >> mip, 1u) * bytesPerPixel);
+		}
+
+		Microsoft::WRL::ComPtr<ID3D11Texture2D> tex = nullptr;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> view = nullptr;
+		if (!CreateTexture2DMipsView(texture2DDesc, initDatas.data(), tex, view))
+		{
+			return false;
+		}
+
+		outId = RendererResourceId::GetAvailableId();
+		gShaderResourceViews.emplace(outId, view);
+		return true;
+	}
+
+	bool Renderer::SetTexture2DMips(RendererResourceId::IdType id, uint32_t width, uint32_t height, uint32_t mipCount, const void* const* loadedMipData,
+		uint32_t loadedMipCount)
+	{
+		static constexpr uint32_t bytesPerPixel = 4;
+
+		const auto found = gShaderResourceViews.find(id);
+		if ((found == gShaderResourceViews.end()) || (found->second == nullptr) || (loadedMipCount > mipCount))
+		{
+			return false;
+		}
+
+		Microsoft::WRL::ComPtr<ID3D11Resource> currentResource = nullptr;
+		found->second->GetResource(currentResource.GetAddressOf());
+		Microsoft::WRL::ComPtr<ID3D11Texture2D> currentTexture = nullptr;
+		if (FAILED(currentResource.As(&currentTexture))) { return false; }
+		D3D11_TEXTURE2D_DESC texture2DDesc = {};
+		currentTexture->GetDesc(&texture2DDesc);
+
+		// The copied mips end at the same coarsest mip as the current texture's chain.
+		const uint32_t copiedMipCount = mipCount - loadedMipCount;
+		if (copiedMipCount > texture2DDesc.MipLevels)
+		{
+			return false;
+		}
+		const uint32_t firstCopiedMip = texture2DDesc.MipLevels - copiedMipCount;
+
+		texture2DDesc.Width = width;
+		texture2DDesc.Height = height;
+		texture2DDesc.MipLevels = mipCount;
+
+		Microsoft::WRL::ComPtr<ID3D11Texture2D> tex = nullptr;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> view = nullptr;
+		if (!CreateTexture2DMipsView(texture2DDesc, nullptr, tex, view))
+		{
+			return false;
+		}
+
+		// Subresources of a texture that is not an array are its mips.
+		for (uint32_t mip = 0; mip < loadedMipCount; ++mip)
+		{
+			const UINT rowPitch = static_cast<UINT>(std::max(width >> mip, 1u) * bytesPerPixel);
+			gD3D11DeviceContext->UpdateSubresource(tex.Get(), mip, nullptr, loadedMipData[mip], rowPitch, 0);
+		}
+		for (uint32_t mip = 0; mip < copiedMipCount; ++mip)
+		{
+			gD3D11DeviceContext->CopySubresourceRegion(tex.Get(), loadedMipCount + mip, 0, 0, 0, currentTexture.Get(), firstCopiedMip + mip, nullptr);
+		}
+
+		found->second = view;
+		return true;
+	}
+
 	bool Renderer::CreateSampler(TextureSamplerFilter filter, TextureSamplerBorderMode borderMode, const float* borderColor, const uint32_t anisotropy, RendererResourceId::IdType& outId)
 	{
 		D3D11_SAMPLER_DESC samplerDesc = {};
@@ -1200,14 +1609,17 @@ namespace LeviathanRenderer
 		resourceID = RendererResourceId::InvalidId;
 	}
 
-	bool Renderer::CreateTextureCube(uint32_t faceWidth, const void* const * pFaceDatas, bool sRGB, RendererResourceId::IdType& outId)
+	bool Renderer::CreateTextureCube(uint32_t faceWidth, const void* const * pFaceDatas, bool sRGB, bool HDR, bool halfFloat, RendererResourceId::IdType& outId)
 	{
+		const DXGI_FORMAT HDRFormat = (halfFloat) ? DXGI_FORMAT_R16G16B16A16_FLOAT : DXGI_FORMAT_R32G32B32A32_FLOAT;
+		const UINT bytesPerPixel = (HDR) ? ((halfFloat) ? 8 : 16) : 4;
+
 		D3D11_TEXTURE2D_DESC faceDesc = {};
 		faceDesc.Width = faceWidth;
 		faceDesc.Height = faceWidth;
 		faceDesc.MipLevels = 1;
 		faceDesc.ArraySize = 6;
-		faceDesc.Format = ((sRGB) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM); 
+		faceDesc.Format = ((HDR) ? (HDRFormat) : ((sRGB) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM));
 		faceDesc.CPUAccessFlags = 0;
 		faceDesc.SampleDesc.Count = 1;
 		faceDesc.SampleDesc.Quality = 0;
@@ -1230,7 +1642,7 @@ namespace LeviathanRenderer
 			// Pointer to the pixel data.
 			data[cubemapFaceIndex].pSysMem = pFaceDatas[cubemapFaceIndex];
 			// Line width in bytes.
-			data[cubemapFaceIndex].SysMemPitch = faceDesc.Width * 4; // Texture width * bytes per pixel.
+			data[cubemapFaceIndex].SysMemPitch = faceDesc.Width * bytesPerPixel;
 			// Only used for 3D textures.
 			data[cubemapFaceIndex].SysMemSlicePitch = 0;
 		}
@@ -1276,13 +1688,13 @@ namespace LeviathanRenderer
 		gD3D11DeviceContext->IASetInputLayout(gSkyboxPipeline.GetInputLayout());
 		gD3D11DeviceContext->VSSetShader(gSkyboxPipeline.GetVertexShader(), nullptr, 0);
 		gD3D11DeviceContext->PSSetShader(gSkyboxPipeline.GetPixelShader(), nullptr, 0);
-		gD3D11DeviceContext->VSSetConstantBuffers(0, 1, gSkyboxBuffer.GetAddressOf());
 		gD3D11DeviceContext->PSSetShaderResources(0, 1, gShaderResourceViews.at(skyboxTextureCubeId).GetAddressOf());
 		gD3D11DeviceContext->PSSetSamplers(0, 1, gSamplerStates.at(skyboxTextureCubeSamplerId).GetAddressOf());
 	}
 
 	bool Renderer::UpdateSkyboxBufferData(size_t byteOffsetIntoBuffer, const void* pNewData, size_t byteWidth)
 	{
+		gD3D11DeviceContext->VSSetConstantBuffers(0, 1, gSkyboxBuffer.GetAddressOf());
 		return UpdateConstantBuffer(gSkyboxBuffer.Get(), byteOffsetIntoBuffer, pNewData, byteWidth);
 	}
 
@@ -1326,7 +1738,6 @@ namespace LeviathanRenderer
 		gD3D11DeviceContext->IASetInputLayout(gEnvironmentLightPipeline.GetInputLayout());
 		gD3D11DeviceContext->VSSetShader(gEnvironmentLightPipeline.GetVertexShader(), nullptr, 0);
 		gD3D11DeviceContext->PSSetShader(gEnvironmentLightPipeline.GetPixelShader(), nullptr, 0);
-		gD3D11DeviceContext->VSSetConstantBuffers(0, 1, gObjectBuffer.GetAddressOf());
 		gD3D11DeviceContext->PSSetShaderResources(0, RendererConstants::Texture2DSRVTableLength, gTexture2DSRVTable[0].GetAddressOf());
 		gD3D11DeviceContext->PSSetShaderResources(1, RendererConstants::TextureCubeSRVTableLength, gTextureCubeSRVTable[0].GetAddressOf());
 		gD3D11DeviceContext->PSSetSamplers(0, RendererConstants::TextureSamplerTableLength, gTextureSamplerTable[0].GetAddressOf());
@@ -1338,38 +1749,29 @@ namespace LeviathanRenderer
 		gD3D11DeviceContext->PSSetShaderResources(0, 1, &nullShaderResourceView);
 	}
 
-	void Renderer::SetDirectionalLightPipeline()
+	void Renderer::SetDirectionalLightPipeline(const uint32_t permutation)
 	{
 		gD3D11DeviceContext->IASetInputLayout(gDirectionalLightPipeline.GetInputLayout());
 		gD3D11DeviceContext->VSSetShader(gDirectionalLightPipeline.GetVertexShader(), nullptr, 0);
-		gD3D11DeviceContext->PSSetShader(gDirectionalLightPipeline.GetPixelShader(), nullptr, 0);
-		gD3D11DeviceContext->VSSetConstantBuffers(0, 1, gObjectBuffer.GetAddressOf());
-		gD3D11DeviceContext->VSSetConstantBuffers(1, 1, gDirectionalLightBuffer.GetAddressOf());
-		gD3D11DeviceContext->PSSetConstantBuffers(0, 1, gDirectionalLightBuffer.GetAddressOf());
+		gD3D11DeviceContext->PSSetShader(gDirectionalLightPipeline.GetPixelShader(permutation), nullptr, 0);
 		gD3D11DeviceContext->PSSetShaderResources(0, RendererConstants::Texture2DSRVTableLength, gTexture2DSRVTable[0].GetAddressOf());
 		gD3D11DeviceContext->PSSetSamplers(0, RendererConstants::TextureSamplerTableLength, gTextureSamplerTable[0].GetAddressOf());
 	}
 
-	void Renderer::SetPointLightPipeline()
+	void Renderer::SetPointLightPipeline(const uint32_t permutation)
 	{
 		gD3D11DeviceContext->IASetInputLayout(gPointLightPipeline.GetInputLayout());
 		gD3D11DeviceContext->VSSetShader(gPointLightPipeline.GetVertexShader(), nullptr, 0);
-		gD3D11DeviceContext->PSSetShader(gPointLightPipeline.GetPixelShader(), nullptr, 0);
-		gD3D11DeviceContext->VSSetConstantBuffers(0, 1, gObjectBuffer.GetAddressOf());
-		gD3D11DeviceContext->VSSetConstantBuffers(1, 1, gPointLightBuffer.GetAddressOf());
-		gD3D11DeviceContext->PSSetConstantBuffers(0, 1, gPointLightBuffer.GetAddressOf());
+		gD3D11DeviceContext->PSSetShader(gPointLightPipeline.GetPixelShader(permutation), nullptr, 0);
 		gD3D11DeviceContext->PSSetShaderResources(0, RendererConstants::Texture2DSRVTableLength, gTexture2DSRVTable[0].GetAddressOf());
 		gD3D11DeviceContext->PSSetSamplers(0, RendererConstants::TextureSamplerTableLength, gTextureSamplerTable[0].GetAddressOf());
 	}
 
-	void Renderer::SetSpotLightPipeline()
+	void Renderer::SetSpotLightPipeline(const uint32_t permutation)
 	{
 		gD3D11DeviceContext->IASetInputLayout(gSpotLightPipeline.GetInputLayout());
 		gD3D11DeviceContext->VSSetShader(gSpotLightPipeline.GetVertexShader(), nullptr, 0);
-		gD3D11DeviceContext->PSSetShader(gSpotLightPipeline.GetPixelShader(), nullptr, 0);
-		gD3D11DeviceContext->VSSetConstantBuffers(0, 1, gObjectBuffer.GetAddressOf());
-		gD3D11DeviceContext->VSSetConstantBuffers(1, 1, gSpotLightBuffer.GetAddressOf());
-		gD3D11DeviceContext->PSSetConstantBuffers(0, 1, gSpotLightBuffer.GetAddressOf());
+		gD3D11DeviceContext->PSSetShader(gSpotLightPipeline.GetPixelShader(permutation), nullptr, 0);
 		gD3D11DeviceContext->PSSetShaderResources(0, RendererConstants::Texture2DSRVTableLength, gTexture2DSRVTable[0].GetAddressOf());
 		gD3D11DeviceContext->PSSetSamplers(0, RendererConstants::TextureSamplerTableLength, gTextureSamplerTable[0].GetAddressOf());
 	}
@@ -1398,26 +1800,186 @@ namespace LeviathanRenderer
 		gD3D11DeviceContext->DrawIndexed(indexCount, 0, 0);
 	}
 
+	void Renderer::DrawIndexedInstanced(const unsigned int indexCount, size_t singleVertexStrideBytes, const RendererResourceId::IdType vertexBufferId,
+		const RendererResourceId::IdType indexBufferId, const unsigned int instanceCount, const unsigned int firstInstance)
+	{
+		ID3D11Buffer* const vertexBuffers[] = { gVertexBuffers.at(static_cast<size_t>(vertexBufferId)).Get(), gInstanceBuffer.Get() };
+		const UINT strides[] = { static_cast<UINT>(singleVertexStrideBytes), static_cast<UINT>(sizeof(ConstantBufferTypes::ObjectConstantBuffer)) };
+		const UINT offsets[] = { 0, 0 };
+		gD3D11DeviceContext->IASetVertexBuffers(0, 2, vertexBuffers, strides, offsets);
+		gD3D11DeviceContext->IASetIndexBuffer(gIndexBuffers.at(static_cast<size_t>(indexBufferId)).Get(), DXGI_FORMAT_R32_UINT, 0);
+
+		gD3D11DeviceContext->DrawIndexedInstanced(indexCount, instanceCount, 0, 0, firstInstance);
+	}
+
+	bool Renderer::UpdateInstanceBufferData(const void* pNewData, size_t byteWidth)
+	{
+		if (byteWidth == 0)
+		{
+			return true;
+		}
+
+		// Recreate the buffer with at least double the capacity when the instance stream does not fit.
+		if (byteWidth > gInstanceBufferCapacityBytes)
+		{
+			const size_t capacityBytes = std::max(byteWidth, 2 * gInstanceBufferCapacityBytes);
+
+			D3D11_BUFFER_DESC desc = {};
+			desc.Usage = D3D11_USAGE_DYNAMIC;
+			desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+			desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+			desc.MiscFlags = 0;
+			desc.ByteWidth = static_cast<UINT>(capacityBytes);
+			desc.StructureByteStride = 0;
+
+			gInstanceBuffer.Reset();
+			gInstanceBufferCapacityBytes = 0;
+			HRESULT hr = gD3D11Device->CreateBuffer(&desc, nullptr, &gInstanceBuffer);
+			if (FAILED(hr)) { return false; }
+			gInstanceBufferCapacityBytes = capacityBytes;
+		}
+
+		D3D11_MAPPED_SUBRESOURCE mappedResource = {};
+		HRESULT hr = gD3D11DeviceContext->Map(gInstanceBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+		if (FAILED(hr)) { return false; }
+
+		memcpy(mappedResource.pData, pNewData, byteWidth);
+
+		gD3D11DeviceContext->Unmap(gInstanceBuffer.Get(), 0);
+
+		return true;
+	}
+
 	bool Renderer::UpdateObjectBufferData(size_t byteOffsetIntoBuffer, const void* pNewData, size_t byteWidth)
 	{
+		gD3D11DeviceContext->VSSetConstantBuffers(0, 1, gObjectBuffer.GetAddressOf());
 		return UpdateConstantBuffer(gObjectBuffer.Get(), byteOffsetIntoBuffer, pNewData, byteWidth);
 	}
 
 	bool Renderer::UpdateDirectionalLightBufferData(size_t byteOffsetIntoBuffer, const void* pNewData, size_t byteWidth)
 	{
+		gD3D11DeviceContext->VSSetConstantBuffers(1, 1, gDirectionalLightBuffer.GetAddressOf());
+		gD3D11DeviceContext->PSSetConstantBuffers(0, 1, gDirectionalLightBuffer.GetAddressOf());
 		return UpdateConstantBuffer(gDirectionalLightBuffer.Get(), byteOffsetIntoBuffer, pNewData, byteWidth);
 	}
 
 	bool Renderer::UpdatePointLightBufferData(size_t byteOffsetIntoBuffer, const void* pNewData, size_t byteWidth)
 	{
+		gD3D11DeviceContext->VSSetConstantBuffers(1, 1, gPointLightBuffer.GetAddressOf());
+		gD3D11DeviceContext->PSSetConstantBuffers(0, 1, gPointLightBuffer.GetAddressOf());
 		return UpdateConstantBuffer(gPointLightBuffer.Get(), byteOffsetIntoBuffer, pNewData, byteWidth);
 	}
 
 	bool Renderer::UpdateSpotLightBufferData(size_t byteOffsetIntoBuffer, const void* pNewData, size_t byteWidth)
 	{
+		gD3D11DeviceContext->VSSetConstantBuffers(1, 1, gSpotLightBuffer.GetAddressOf());
+		gD3D11DeviceContext->PSSetConstantBuffers(0, 1, gSpotLightBuffer.GetAddressOf());
 		return UpdateConstantBuffer(gSpotLightBuffer.Get(), byteOffsetIntoBuffer, pNewData, byteWidth);
 	}
 
+	bool Renderer::SupportsConstantBufferRanges()
+	{
+		return gConstantBufferRangesSupported;
+	}
+
+	bool Renderer::MapConstantUploadBuffer(bool discard, void*& outData)
+	{
+		D3D11_MAPPED_SUBRESOURCE mappedResource = {};
+		HRESULT hr = gD3D11DeviceContext->Map(gConstantUploadBuffer.Get(), 0, ((discard) ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE), 0,
+			&mappedResource);
+		if (FAILED(hr)) { return false; }
+
+		outData = mappedResource.pData;
+		return true;
+	}
+
+	void Renderer::UnmapConstantUploadBuffer()
+	{
+		gD3D11DeviceContext->Unmap(gConstantUploadBuffer.Get(), 0);
+	}
+
+	void Renderer::SetObjectBufferRange(size_t byteOffset, size_t byteWidth)
+	{
+		UINT firstConstant = 0;
+		UINT constantCount = 0;
+		GetConstantUploadBufferRange(byteOffset, byteWidth, firstConstant, constantCount);
+		gD3D11DeviceContext1->VSSetConstantBuffers1(0, 1, gConstantUploadBuffer.GetAddressOf(), &firstConstant, &constantCount);
+	}
+
+	void Renderer::SetDirectionalLightBufferRange(size_t byteOffset, size_t byteWidth)
+	{
+		UINT firstConstant = 0;
+		UINT constantCount = 0;
+		GetConstantUploadBufferRange(byteOffset, byteWidth, firstConstant, constantCount);
+		gD3D11DeviceContext1->VSSetConstantBuffers1(1, 1, gConstantUploadBuffer.GetAddressOf(), &firstConstant, &constantCount);
+		gD3D11DeviceContext1->PSSetConstantBuffers1(0, 1, gConstantUploadBuffer.GetAddressOf(), &firstConstant, &constantCount);
+	}
+
+	void Renderer::SetPointLightBufferRange(size_t byteOffset, size_t byteWidth)
+	{
+		UINT firstConstant = 0;
+		UINT constantCount = 0;
+		GetConstantUploadBufferRange(byteOffset, byteWidth, firstConstant, constantCount);
+		gD3D11DeviceContext1->VSSetConstantBuffers1(1, 1, gConstantUploadBuffer.GetAddressOf(), &firstConstant, &constantCount);
+		gD3D11DeviceContext1->PSSetConstantBuffers1(0, 1, gConstantUploadBuffer.GetAddressOf(), &firstConstant, &constantCount);
+	}
+
+	void Renderer::SetSpotLightBufferRange(size_t byteOffset, size_t byteWidth)
+	{
+		UINT firstConstant = 0;
+		UINT constantCount = 0;
+		GetConstantUploadBufferRange(byteOffset, byteWidth, firstConstant, constantCount);
+		gD3D11DeviceContext1->VSSetConstantBuffers1(1, 1, gConstantUploadBuffer.GetAddressOf(), &firstConstant, &constantCount);
+		gD3D11DeviceContext1->PSSetConstantBuffers1(0, 1, gConstantUploadBuffer.GetAddressOf(), &firstConstant, &constantCount);
+	}
+
+	void Renderer::SetSkyboxBufferRange(size_t byteOffset, size_t byteWidth)
+	{
+		UINT firstConstant = 0;
+		UINT constantCount = 0;
+		GetConstantUploadBufferRange(byteOffset, byteWidth, firstConstant, constantCount);
+		gD3D11DeviceContext1->VSSetConstantBuffers1(0, 1, gConstantUploadBuffer.GetAddressOf(), &firstConstant, &constantCount);
+	}
+
+	void Renderer::SignalFrameFence(uint64_t fenceValue)
+	{
+		gD3D11DeviceContext->End(gFrameFenceQueries[fenceValue % RendererConstants::MaxFramesInFlight].Get());
+		gSignalledFrameFence = fenceValue;
+	}
+
+	uint64_t Renderer::GetCompletedFrameFence()
+	{
+		// Queries complete in submission order.
+		while (gCompletedFrameFence < gSignalledFrameFence)
+		{
+			const uint64_t fenceValue = gCompletedFrameFence + 1;
+			HRESULT hr = gD3D11DeviceContext->GetData(gFrameFenceQueries[fenceValue % RendererConstants::MaxFramesInFlight].Get(), nullptr, 0,
+				D3D11_ASYNC_GETDATA_DONOTFLUSH);
+			if (hr != S_OK) { break; }
+			gCompletedFrameFence = fenceValue;
+		}
+		return gCompletedFrameFence;
+	}
+
+	void Renderer::WaitForFrameFence(uint64_t fenceValue)
+	{
+		while ((gCompletedFrameFence < fenceValue) && (gCompletedFrameFence < gSignalledFrameFence))
+		{
+			const uint64_t nextFenceValue = gCompletedFrameFence + 1;
+			HRESULT hr = gD3D11DeviceContext->GetData(gFrameFenceQueries[nextFenceValue % RendererConstants::MaxFramesInFlight].Get(), nullptr, 0, 0);
+			if (FAILED(hr))
+			{
+				// The device was removed. Nothing is in flight anymore.
+				gCompletedFrameFence = gSignalledFrameFence;
+				break;
+			}
+			if (hr == S_OK)
+			{
+				gCompletedFrameFence = nextFenceValue;
+			}
+		}
+	}
+
 	void Renderer::SetDepthStencilStateWriteDepthDepthFuncLessStencilDisabled()
 	{
 		gD3D11DeviceContext->OMSetDepthStencilState(gDepthStencilStateWriteDepthDepthFuncLessStencilDisabled.Get(), 0);
@@ -0,0 +1,297 @@
+#include "GpuMemory.h"
+
+namespace LeviathanRenderer
+{
+	const char* GetGpuMemoryCategoryName(const GpuMemoryCategory category)
+	{
+		switch (category)
+		{
+		case GpuMemoryCategory::VertexBuffer: return "Vertex buffers";
+		case GpuMemoryCategory::IndexBuffer: return "Index buffers";
+		case GpuMemoryCategory::ConstantBuffer: return "Constant buffers";
+		case GpuMemoryCategory::Texture2D: return "Textures";
+		case GpuMemoryCategory::TextureCube: return "Texture cubes";
+		case GpuMemoryCategory::StreamedTexture: return "Streamed textures";
+		case GpuMemoryCategory::RenderTarget: return "Render targets";
+		case GpuMemoryCategory::MAX: return "Total";
+		}
+		return "";
+	}
+
+	uint32_t GetGpuTextureFormatBytesPerTexel(const GpuTextureFormat format)
+	{
+		switch (format)
+		{
+		case GpuTextureFormat::RGBA8: return 4;
+		case GpuTextureFormat::RGBA16Float: return 8;
+		case GpuTextureFormat::RGBA32Float: return 16;
+		case GpuTextureFormat::Depth24Stencil8: return 4;
+		}
+		return 0;
+	}
+
+	size_t GetGpuTextureBytes(const uint32_t width, const uint32_t height, const uint32_t mipCount, const uint32_t faceCount, const GpuTextureFormat format)
+	{
+		size_t texels = 0;
+		for (uint32_t mip = 0; mip < mipCount; ++mip)
+		{
+			texels += static_cast<size_t>(std::max(width >> mip, 1u)) * std::max(height >> mip, 1u);
+		}
+		return texels * faceCount * GetGpuTextureFormatBytesPerTexel(format);
+	}
+
+	GpuMemoryTracker::GpuMemoryTracker()
+	{
+		Budgets.fill(Unlimited);
+		for (GpuMemoryCategoryStats& category : Stats.Categories)
+		{
+			category.BudgetBytes = Unlimited;
+		}
+		Stats.BudgetBytes = Unlimited;
+	}
+
+	GpuAllocationId GpuMemoryTracker::Track(const GpuMemoryCategory category, const size_t sizeBytes, const uint64_t resource)
+	{
+		if (category == GpuMemoryCategory::MAX)
+		{
+			return InvalidGpuAllocationId;
+		}
+
+		GpuAllocationId id = InvalidGpuAllocationId;
+		if (!FreeIds.empty())
+		{
+			id = FreeIds.back();
+			FreeIds.pop_back();
+		}
+		else
+		{
+			id = static_cast<GpuAllocationId>(Allocations.size());
+			Allocations.emplace_back();
+		}
+
+		Allocations[id] = Allocation{ .Tracked = true, .Category = category, .SizeBytes = sizeBytes, .Resource = resource, .LastUsedFrame = FrameIndex };
+		++Stats.Categories[static_cast<size_t>(category)].Allocations;
+		AddBytes(category, sizeBytes);
+		return id;
+	}
+
+	void GpuMemoryTracker::Untrack(GpuAllocationId& allocation)
+	{
+		if (IsValid(allocation))
+		{
+			const Allocation& tracked = Allocations[allocation];
+			--Stats.Categories[static_cast<size_t>(tracked.Category)].Allocations;
+			RemoveBytes(tracked.Category, tracked.SizeBytes);
+			Allocations[allocation] = {};
+			FreeIds.push_back(allocation);
+		}
+		allocation = InvalidGpuAllocationId;
+	}
+
+	void GpuMemoryTracker::Resize(const GpuAllocationId allocation, const size_t sizeBytes)
+	{
+		if (!IsValid(allocation))
+		{
+			return;
+		}
+
+		Allocation& tracked = Allocations[allocation];
+		if (sizeBytes > tracked.SizeBytes)
+		{
+			AddBytes(tracked.Category, sizeBytes - tracked.SizeBytes);
+		}
+		else
+		{
+			RemoveBytes(tracked.Category, tracked.SizeBytes - sizeBytes);
+		}
+		tracked.SizeBytes = sizeBytes;
+		tracked.ReclaimRequested = false;
+	}
+
+	void GpuMemoryTracker::SetReclaimPriority(const GpuAllocationId allocation, const uint8_t priority)
+	{
+		if (IsValid(allocation))
+		{
+			Allocations[allocation].ReclaimPriority = priority;
+		}
+	}
+
+	void GpuMemoryTracker::SetBudget(const GpuMemoryCategory category, const size_t budgetBytes)
+	{
+		if (category != GpuMemoryCategory::MAX)
+		{
+			Budgets[static_cast<size_t>(category)] = budgetBytes;
+			Stats.Categories[static_cast<size_t>(category)].BudgetBytes = budgetBytes;
+		}
+	}
+
+	void GpuMemoryTracker::SetTotalBudget(const size_t budgetBytes)
+	{
+		TotalBudget = budgetBytes;
+		Stats.BudgetBytes = budgetBytes;
+	}
+
+	void GpuMemoryTracker::SetBudgetExceededCallback(const GpuMemoryBudgetExceededCallbackType callback, void* const userData)
+	{
+		BudgetExceededCallback = callback;
+		BudgetExceededUserData = userData;
+	}
+
+	void GpuMemoryTracker::PlanReclaims()
+	{
+		Reclaims.clear();
+
+		// Bytes of every category and the total once the allocations already asked to release their memory do so.
+		std::array<size_t, GpuMemoryCategoryCount> categoryBytes = {};
+		for (size_t category = 0; category < GpuMemoryCategoryCount; ++category)
+		{
+			categoryBytes[category] = Stats.Categories[category].UsedBytes;
+		}
+		size_t totalBytes = Stats.UsedBytes;
+
+		ReclaimCandidates.clear();
+		for (GpuAllocationId id = 0; id < Allocations.size(); ++id)
+		{
+			const Allocation& allocation = Allocations[id];
+			if (!allocation.Tracked)
+			{
+				continue;
+			}
+
+			if (allocation.ReclaimRequested)
+			{
+				categoryBytes[static_cast<size_t>(allocation.Category)] -= allocation.SizeBytes;
+				totalBytes -= allocation.SizeBytes;
+			}
+			else if ((allocation.ReclaimPriority != NotReclaimable) && (allocation.LastUsedFrame < FrameIndex) && (allocation.SizeBytes > 0))
+			{
+				ReclaimCandidates.push_back(id);
+			}
+		}
+
+		bool exceeded = (totalBytes > TotalBudget);
+		for (size_t category = 0; category < GpuMemoryCategoryCount; ++category)
+		{
+			exceeded = exceeded || (categoryBytes[category] > Budgets[category]);
+		}
+		if (!exceeded || ReclaimCandidates.empty())
+		{
+			return;
+		}
+
+		// Lowest priority first, then least recently used, then largest.
+		std::sort(ReclaimCandidates.begin(), ReclaimCandidates.end(), [this](const GpuAllocationId a, const GpuAllocationId b)
+			{
+				const Allocation& allocationA = Allocations[a];
+				const Allocation& allocationB = Allocations[b];
+				if (allocationA.ReclaimPriority != allocationB.ReclaimPriority)
+				{
+					return allocationA.ReclaimPriority < allocationB.ReclaimPriority;
+				}
+				if (allocationA.LastUsedFrame != allocationB.LastUsedFrame)
+				{
+					return allocationA.LastUsedFrame < allocationB.LastUsedFrame;
+				}
+				return (allocationA.SizeBytes != allocationB.SizeBytes) ? (allocationA.SizeBytes > allocationB.SizeBytes) : (a < b);
+			});
+
+		const auto reclaim = [this, &categoryBytes, &totalBytes](const GpuAllocationId id)
+			{
+				Allocation& allocation = Allocations[id];
+				allocation.ReclaimRequested = true;
+				categoryBytes[static_cast<size_t>(allocation.Category)] -= allocation.SizeBytes;
+				totalBytes -= allocation.SizeBytes;
+				Reclaims.push_back(PlannedReclaim{ .Allocation = id, .SizeBytes = allocation.SizeBytes });
+			};
+
+		// Categories over their budget first, then the total over its budget from any category.
+		for (size_t category = 0; category < GpuMemoryCategoryCount; ++category)
+		{
+			for (size_t i = 0; (i < ReclaimCandidates.size()) && (categoryBytes[category] > Budgets[category]); ++i)
+			{
+				const Allocation& allocation = Allocations[ReclaimCandidates[i]];
+				if ((static_cast<size_t>(allocation.Category) == category) && !allocation.ReclaimRequested)
+				{
+					reclaim(ReclaimCandidates[i]);
+				}
+			}
+		}
+		for (size_t i = 0; (i < ReclaimCandidates.size()) && (totalBytes > TotalBudget); ++i)
+		{
+			if (!Allocations[ReclaimCandidates[i]].ReclaimRequested)
+			{
+				reclaim(ReclaimCandidates[i]);
+			}
+		}
+	}
+
+	void GpuMemoryTracker::CompleteFrame()
+	{
+		uint32_t reclaims = 0;
+		size_t reclaimBytes = 0;
+		for (size_t i = 0; i < Reclaims.size(); ++i)
+		{
+			if (ReclaimResults[i] != 0)
+			{
+				++reclaims;
+				reclaimBytes += Reclaims[i].SizeBytes;
+			}
+			else
+			{
+				// Refused reclaims may be asked again next frame.
+				Allocations[Reclaims[i].Allocation].ReclaimRequested = false;
+			}
+		}
+
+		// Report budgets exceeded now that were within budget at the end of the previous frame.
+		uint32_t exceededBudgets = 0;
+		for (size_t category = 0; category < GpuMemoryCategoryCount; ++category)
+		{
+			exceededBudgets |= (Stats.Categories[category].UsedBytes > Budgets[category]) ? (1u << category) : 0u;
+		}
+		exceededBudgets |= (Stats.UsedBytes > TotalBudget) ? (1u << GpuMemoryCategoryCount) : 0u;
+		const uint32_t newlyExceededBudgets = exceededBudgets & ~Stats.ExceededBudgets;
+		Stats.ExceededBudgets = exceededBudgets;
+		for (size_t category = 0; category <= GpuMemoryCategoryCount; ++category)
+		{
+			if ((newlyExceededBudgets & (1u << category)) == 0)
+			{
+				continue;
+			}
+
+			++Stats.BudgetExceededEvents;
+			if (BudgetExceededCallback != nullptr)
+			{
+				const bool total = (category == GpuMemoryCategoryCount);
+				BudgetExceededCallback(static_cast<GpuMemoryCategory>(category), total ? Stats.UsedBytes : Stats.Categories[category].UsedBytes,
+					total ? TotalBudget : Budgets[category], BudgetExceededUserData);
+			}
+		}
+
+		Stats.FrameAllocatedBytes = FrameAllocatedBytes;
+		Stats.FrameReleasedBytes = FrameReleasedBytes;
+		Stats.FrameReclaims = reclaims;
+		Stats.FrameReclaimBytes = reclaimBytes;
+		Stats.Reclaims += reclaims;
+		FrameAllocatedBytes = 0;
+		FrameReleasedBytes = 0;
+		++FrameIndex;
+	}
+
+	void GpuMemoryTracker::AddBytes(const GpuMemoryCategory category, const size_t sizeBytes)
+	{
+		GpuMemoryCategoryStats& categoryStats = Stats.Categories[static_cast<size_t>(category)];
+		categoryStats.UsedBytes += sizeBytes;
+		categoryStats.PeakBytes = std::max(categoryStats.PeakBytes, categoryStats.UsedBytes);
+		Stats.UsedBytes += sizeBytes;
+		Stats.PeakBytes = std::max(Stats.PeakBytes, Stats.UsedBytes);
+		FrameAllocatedBytes += sizeBytes;
+	}
+
+	void GpuMemoryTracker::RemoveBytes(const GpuMemoryCategory category, const size_t sizeBytes)
+	{
+		Stats.Categories[static_cast<size_t>(category)].UsedBytes -= sizeBytes;
+		Stats.UsedBytes -= sizeBytes;
+		FrameReleasedBytes += sizeBytes;
+	}
+}
@@ -0,0 +1,158 @@
+#include "InstanceBatching.h"
+#include "RenderWorld.h"
+#include "JobSystem.h"
+#include "Hash.h"
+#include "Simd.h"
+
+namespace LeviathanRenderer
+{
+	// Number of draws processed per job when building instance batches.
+	static constexpr size_t InstanceBatchChunkSize = 1024;
+
+	// Initial size and empty slot value of the batch hash table.
+	static constexpr size_t MinBatchTableSize = 256;
+	static constexpr uint32_t EmptyBatchSlot = std::numeric_limits<uint32_t>::max();
+
+	static constexpr size_t ObjectDataFloatCount = sizeof(ConstantBufferTypes::ObjectConstantBuffer) / sizeof(float);
+	static_assert(ObjectDataFloatCount % 4 == 0);
+
+	// Hash of the mesh and material fields that must match for draws to share an instanced draw. Mesh bounds are not part of the key.
+	static uint64_t MakeBatchKey(const RenderMesh& mesh, const RenderMaterial& material)
+	{
+		const uint64_t fields[] = { mesh.VertexBuffer, mesh.IndexBuffer, (static_cast<uint64_t>(mesh.IndexCount) << 32) | mesh.VertexStrideBytes,
+			material.ColorTexture, material.MetallicTexture, material.RoughnessTexture, material.NormalTexture, material.Sampler };
+		return LeviathanCore::Hash::HashBytes(fields, sizeof(fields));
+	}
+
+	// Guards batches against batch key collisions.
+	static bool CanShareBatch(const RenderWorld& world, const uint32_t a, const uint32_t b)
+	{
+		const RenderMesh& meshA = world.GetMesh(a);
+		const RenderMesh& meshB = world.GetMesh(b);
+		const RenderMaterial& materialA = world.GetMaterial(a);
+		const RenderMaterial& materialB = world.GetMaterial(b);
+		return (meshA.VertexBuffer == meshB.VertexBuffer) && (meshA.IndexBuffer == meshB.IndexBuffer) && (meshA.IndexCount == meshB.IndexCount) &&
+			(meshA.VertexStrideBytes == meshB.VertexStrideBytes) && (materialA.ColorTexture == materialB.ColorTexture) &&
+			(materialA.MetallicTexture == materialB.MetallicTexture) && (materialA.RoughnessTexture == materialB.RoughnessTexture) &&
+			(materialA.NormalTexture == materialB.NormalTexture) && (materialA.Sampler == materialB.Sampler);
+	}
+
+	static inline void CopyObjectData(const ConstantBufferTypes::ObjectConstantBuffer& source, ConstantBufferTypes::ObjectConstantBuffer& destination)
+	{
+#ifdef LEVIATHAN_SIMD_SSE
+		const float* const sourceFloats = reinterpret_cast<const float*>(&source);
+		float* const destinationFloats = reinterpret_cast<float*>(&destination);
+		for (size_t i = 0; i < ObjectDataFloatCount; i += 4)
+		{
+			_mm_storeu_ps(destinationFloats + i, _mm_loadu_ps(sourceFloats + i));
+		}
+#else
+		destination = source;
+#endif // LEVIATHAN_SIMD_SSE.
+	}
+
+	// Inserts a batch index into an open addressing table with linear probing. The table size is a power of 2.
+	static void InsertBatch(std::vector<uint32_t>& table, const uint64_t batchKey, const uint32_t batch)
+	{
+		const size_t mask = table.size() - 1;
+		size_t slot = static_cast<size_t>(batchKey) & mask;
+		while (table[slot] != EmptyBatchSlot)
+		{
+			slot = (slot + 1) & mask;
+		}
+		table[slot] = batch;
+	}
+
+	void BuildInstanceBatches(const RenderWorld& world, const DrawList& drawList, InstanceBatchList& outBatches)
+	{
+		const size_t drawCount = drawList.GetCount();
+		outBatches.Batches.clear();
+		outBatches.ScratchBatchKeys.clear();
+		outBatches.ScratchDrawKeys.resize(drawCount);
+		outBatches.ScratchDrawBatches.resize(drawCount);
+		outBatches.InstanceDraws.resize(drawCount);
+		outBatches.InstanceData.resize(drawCount);
+
+		// Batch key of every draw.
+		LeviathanCore::JobSystem::ParallelFor(drawCount, InstanceBatchChunkSize,
+			[&world, &drawList, &outBatches](const size_t first, const size_t count, [[maybe_unused]] const size_t threadIndex)
+			{
+				for (size_t i = first; i < first + count; ++i)
+				{
+					const uint32_t renderable = drawList.Renderables[i];
+					outBatches.ScratchDrawKeys[i] = MakeBatchKey(world.GetMesh(renderable), world.GetMaterial(renderable));
+				}
+			});
+
+		// Assign every draw to the batch of its mesh and material. Batches are created in draw list order so each batch's first draw is its first
+		// instance and batches are ordered like the draw list.
+		std::vector<uint32_t>& table = outBatches.ScratchBatchTable;
+		table.assign(std::max(MinBatchTableSize, table.size()), EmptyBatchSlot);
+		for (size_t i = 0; i < drawCount; ++i)
+		{
+			const uint64_t batchKey = outBatches.ScratchDrawKeys[i];
+			const uint32_t renderable = drawList.Renderables[i];
+
+			const size_t mask = table.size() - 1;
+			size_t slot = static_cast<size_t>(batchKey) & mask;
+			uint32_t batch = EmptyBatchSlot;
+			while (table[slot] != EmptyBatchSlot)
+			{
+				const uint32_t candidate = table[slot];
+				if ((outBatches.ScratchBatchKeys[candidate] == batchKey) && (CanShareBatch(world, outBatches.Batches[candidate].Renderable, renderable)))
+				{
+					batch = candidate;
+					break;
+				}
+				slot = (slot + 1) & mask;
+			}
+
+			if (batch == EmptyBatchSlot)
+			{
+				batch = static_cast<uint32_t>(outBatches.Batches.size());
+				outBatches.Batches.push_back(InstanceBatch{ renderable, 0, 0, drawList.SortKeys[i] });
+				outBatches.ScratchBatchKeys.push_back(batchKey);
+				table[slot] = batch;
+
+				// Keep the table at most half full.
+				if (2 * outBatches.Batches.size() > table.size())
+				{
+					table.assign(2 * table.size(), EmptyBatchSlot);
+					for (uint32_t b = 0; b < static_cast<uint32_t>(outBatches.Batches.size()); ++b)
+					{
+						InsertBatch(table, outBatches.ScratchBatchKeys[b], b);
+					}
+				}
+			}
+
+			++outBatches.Batches[batch].InstanceCount;
+			outBatches.ScratchDrawBatches[i] = batch;
+		}
+
+		// Instance ranges of the batches.
+		outBatches.ScratchBatchCursors.resize(outBatches.Batches.size());
+		uint32_t firstInstance = 0;
+		for (size_t batch = 0; batch < outBatches.Batches.size(); ++batch)
+		{
+			outBatches.Batches[batch].FirstInstance = firstInstance;
+			outBatches.ScratchBatchCursors[batch] = firstInstance;
+			firstInstance += outBatches.Batches[batch].InstanceCount;
+		}
+
+		// Stable counting sort of the draws by batch.
+		for (size_t i = 0; i < drawCount; ++i)
+		{
+			outBatches.InstanceDraws[outBatches.ScratchBatchCursors[outBatches.ScratchDrawBatches[i]]++] = static_cast<uint32_t>(i);
+		}
+
+		// Pack the object data of every instance in batch order.
+		LeviathanCore::JobSystem::ParallelFor(drawCount, InstanceBatchChunkSize,
+			[&drawList, &outBatches](const size_t first, const size_t count, [[maybe_unused]] const size_t threadIndex)
+			{
+				for (size_t i = first; i < first + count; ++i)
+				{
+					CopyObjectData(drawList.ObjectData[outBatches.InstanceDraws[i]], outBatches.InstanceData[i]);
+				}
+			});
+	}
+}
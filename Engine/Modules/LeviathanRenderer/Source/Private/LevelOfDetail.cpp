@@ -0,0 +1,34 @@
+#include "LevelOfDetail.h"
+#include "Camera.h"
+
+namespace LeviathanRenderer
+{
+	float GetProjectedSize(const Camera& view, const LeviathanCore::BoundingVolumes::Sphere& worldBounds, const float worldLength, const float viewportHeight)
+	{
+		// Column major projection matrix. Element (1, 1) scales view space y to clip space.
+		const float projectionScaleY = view.GetProjectionMatrix().Data()[5];
+		const float pixelsPerUnit = projectionScaleY * 0.5f * viewportHeight;
+		if (view.GetProjectionMode() == Camera::ProjectionMode::Orthographic)
+		{
+			return worldLength * pixelsPerUnit;
+		}
+
+		// The distance to the bounds rather than the view depth keeps the size constant while the camera turns.
+		const float distance = std::max((worldBounds.Center - view.GetPosition()).Length() - worldBounds.Radius, view.GetNearZ());
+		return worldLength * pixelsPerUnit / distance;
+	}
+
+	uint32_t SelectLevelOfDetail(const Camera& view, const LeviathanCore::BoundingVolumes::Sphere& worldBounds, const float worldScale, const float* const levelErrors,
+		const uint32_t levelCount, const float viewportHeight, const float maxPixelError)
+	{
+		const float pixelsPerError = GetProjectedSize(view, worldBounds, worldScale, viewportHeight);
+		for (uint32_t level = levelCount; level > 1; --level)
+		{
+			if (levelErrors[level - 1] * pixelsPerError <= maxPixelError)
+			{
+				return level - 1;
+			}
+		}
+		return 0;
+	}
+}
@@ -5,6 +5,18 @@
 #include "ConstantBufferTypes.h"
 #include "Camera.h"
 #include "VertexTypes.h"
+#include "VisibilityCulling.h"
+#include "RenderCommands.h"
+#include "RenderStateFilter.h"
+#include "RenderWorld.h"
+#include "OcclusionCulling.h"
+#include "InstanceBatching.h"
+#include "LightInfluence.h"
+#include "UploadRing.h"
+#include "UploadQueue.h"
+#include "TextureStreaming.h"
+#include "GpuMemory.h"
+#include "RendererConstants.h"
 
 namespace LeviathanRenderer
 {
@@ -14,6 +26,423 @@ namespace LeviathanRenderer
 	static int renderWidth = 0;
 	static int renderHeight = 0;
 
+	// Renderables registered by titles, the stage culling them against the scene view and the draw list of the visible renderables built by Render.
+	static RenderWorld gRenderWorld = {};
+	static FrustumCullingStage gFrustumCullingStage = {};
+	static DrawList gDrawList = {};
+
+	// Occluders registered by titles. Renderables inside the view hidden by them are culled before the draw list is built.
+	static OcclusionCullingStage gOcclusionCullingStage = {};
+
+	// Visible renderables sharing a mesh and material grouped into instanced draws, and the frame's instance stream.
+	static InstanceBatchList gInstanceBatches = {};
+
+	// Instance batches lit by each point and spot light of the frame. Lighting passes skip batches outside a light's influence volume.
+	static LightInfluenceCulling gLightInfluence = {};
+
+	// Ranges of the constant upload buffer holding the light and skybox constants of the frames in flight. Render writes a frame's constants to
+	// ranges allocated from the ring and commands bind them by offset. A frame's ranges are reused once its fence signalled. Unused when the renderer
+	// api cannot bind constant buffer ranges, constants are then written to a buffer per constant buffer type.
+	static UploadRing gConstantUploadRing = {};
+	static uint64_t gFrameFence = 0;
+
+	// Asynchronously created resources. Created at the start of Render within the upload budget.
+	static UploadQueue gUploadQueue(RendererConstants::UploadBudgetBytesPerFrame);
+
+	// Streamed textures by streaming id and the streaming id of every streamed texture resource. Render adds the demand of the visible renderables
+	// for the mips of their materials' streamed textures and streams mips within the pool and the frame's streaming budget.
+	struct StreamedTexture2D
+	{
+		RendererResourceId::IdType Resource = RendererResourceId::InvalidId;
+		StreamedTexture2DDescription Description = {};
+	};
+	static TextureStreamer gTextureStreamer(TextureStreamingSettings{ .PoolBytes = RendererConstants::TextureStreamingPoolBytes,
+		.MaxStreamInBytesPerUpdate = RendererConstants::TextureStreamingBytesPerFrame, .TailSize = RendererConstants::TextureStreamingTailSize,
+		.HysteresisUpdates = RendererConstants::TextureStreamingHysteresisFrames });
+	static std::vector<StreamedTexture2D> gStreamedTextures = {};
+	static std::unordered_map<RendererResourceId::IdType, StreamedTextureId> gStreamedTextureIds = {};
+	// Tail mips read by the last streamed texture creation.
+	static std::vector<uint8_t> gStreamedMipData = {};
+	// Mips of the stream ins read in background jobs. Render queues the finished reads for upload and does not wait for the others.
+	static TextureMipReader gStreamedMipReader = {};
+	// Mip updates of streamed textures waiting in the upload queue. Stream ins become resident once uploaded and are reverted if they fail.
+	struct StreamedMipUpload
+	{
+		StreamedTextureId Texture = InvalidStreamedTextureId;
+		uint32_t FirstMip = 0;
+		uint32_t PreviousMip = 0;
+	};
+	static std::unordered_map<UploadTicket, StreamedMipUpload> gStreamedMipUploads = {};
+
+	// Gpu memory of every resource created through the renderer with the callback releasing the memory of reclaimable resources, and of the
+	// window's render targets and the constant upload buffer. Constant and instance buffers created by the renderer api are not tracked.
+	struct GpuResourceMemory
+	{
+		GpuAllocationId Allocation = InvalidGpuAllocationId;
+		GpuMemoryReclaimCallbackType Reclaim = nullptr;
+		void* UserData = nullptr;
+	};
+	static GpuMemoryTracker gGpuMemory = {};
+	static std::unordered_map<RendererResourceId::IdType, GpuResourceMemory> gGpuResourceMemory = {};
+	static GpuAllocationId gRenderTargetMemory = InvalidGpuAllocationId;
+	static GpuAllocationId gConstantUploadMemory = InvalidGpuAllocationId;
+	static constexpr unsigned int SwapChainBufferCount = 3;
+
+	// Render passes in execution order. Used as the pass field of render command sort keys.
+	enum class RenderPass : uint8_t
+	{
+		BeginFrame,
+		AmbientLight,
+		DirectionalLight,
+		PointLight,
+		SpotLight,
+		Skybox,
+		PostProcess
+	};
+
+	// Commands recorded by Render, sorted and executed with the renderer api at the end of Render.
+	static RenderCommands::CommandQueue gRenderCommands = {};
+
+	// Backend calls issued and elided while executing the last frame's commands.
+	static RenderCommands::StateFilterStats gStateFilterStats = {};
+
+	// Executes render commands with the renderer api.
+	struct RendererApiBackend
+	{
+		void ClearRenderTarget(const RenderCommands::RenderTarget target, const float* color)
+		{
+			if (target == RenderCommands::RenderTarget::Screen)
+			{
+				Renderer::ClearScreenRenderTarget(color);
+			}
+			else
+			{
+				Renderer::ClearSceneRenderTarget(color);
+			}
+		}
+
+		void ClearDepthStencil(const float depth, const uint8_t stencil)
+		{
+			Renderer::ClearDepthStencil(depth, stencil);
+		}
+
+		void SetRenderTarget(const RenderCommands::RenderTarget target)
+		{
+			if (target == RenderCommands::RenderTarget::Screen)
+			{
+				Renderer::SetScreenRenderTarget();
+			}
+			else
+			{
+				Renderer::SetSceneRenderTarget();
+			}
+		}
+
+		void SetPipeline(const RenderCommands::Pipeline pipeline, const uint32_t permutation)
+		{
+			switch (pipeline)
+			{
+			case RenderCommands::Pipeline::AmbientLight: Renderer::SetAmbientLightPipeline(); break;
+			case RenderCommands::Pipeline::DirectionalLight: Renderer::SetDirectionalLightPipeline(permutation); break;
+			case RenderCommands::Pipeline::PointLight: Renderer::SetPointLightPipeline(permutation); break;
+			case RenderCommands::Pipeline::SpotLight: Renderer::SetSpotLightPipeline(permutation); break;
+			case RenderCommands::Pipeline::PostProcess: Renderer::SetPostProcessPipeline(); break;
+			}
+		}
+
+		void SetSkyboxPipeline(const RendererResourceId::IdType textureCubeId, const RendererResourceId::IdType samplerId)
+		{
+			Renderer::SetSkyboxPipeline(textureCubeId, samplerId);
+		}
+
+		void SetBlendState(const RenderCommands::BlendState state)
+		{
+			if (state == RenderCommands::BlendState::Additive)
+			{
+				Renderer::SetBlendStateAdditive();
+			}
+			else
+			{
+				Renderer::SetBlendStateBlendDisabled();
+			}
+		}
+
+		void SetDepthStencilState(const RenderCommands::DepthStencilState state)
+		{
+			switch (state)
+			{
+			case RenderCommands::DepthStencilState::WriteDepthDepthFuncLess: Renderer::SetDepthStencilStateWriteDepthDepthFuncLessStencilDisabled(); break;
+			case RenderCommands::DepthStencilState::WriteDepthDepthFuncLessEqual: Renderer::SetDepthStencilStateWriteDepthDepthFuncLessEqualStencilDisabled(); break;
+			case RenderCommands::DepthStencilState::NoWriteDepthDepthFuncEqual: Renderer::SetDepthStencilStateNoWriteDepthDepthFuncEqualStencilDisabled(); break;
+			case RenderCommands::DepthStencilState::NoWriteDepthDepthFuncLess: Renderer::SetDepthStencilStateNoWriteDepthDepthFuncLessStencilDisabled(); break;
+			case RenderCommands::DepthStencilState::Disabled: Renderer::SetDepthStencilStateDepthStencilDisabled(); break;
+			}
+		}
+
+		void SetTexture(const RenderCommands::TextureSlot slot, const RendererResourceId::IdType textureId)
+		{
+			switch (slot)
+			{
+			case RenderCommands::TextureSlot::Environment: Renderer::SetEnvironmentTextureCubeResource(textureId); break;
+			case RenderCommands::TextureSlot::Color: Renderer::SetColorTexture2DResource(textureId); break;
+			case RenderCommands::TextureSlot::Metallic: Renderer::SetMetallicTexture2DResource(textureId); break;
+			case RenderCommands::TextureSlot::Roughness: Renderer::SetRoughnessTexture2DResource(textureId); break;
+			case RenderCommands::TextureSlot::Normal: Renderer::SetNormalTexture2DResource(textureId); break;
+			}
+		}
+
+		void SetSampler(const RenderCommands::TextureSlot slot, const RendererResourceId::IdType samplerId)
+		{
+			switch (slot)
+			{
+			case RenderCommands::TextureSlot::Environment: Renderer::SetEnvironmentTextureSampler(samplerId); break;
+			case RenderCommands::TextureSlot::Color: Renderer::SetColorTextureSampler(samplerId); break;
+			case RenderCommands::TextureSlot::Metallic: Renderer::SetMetallicTextureSampler(samplerId); break;
+			case RenderCommands::TextureSlot::Roughness: Renderer::SetRoughnessTextureSampler(samplerId); break;
+			case RenderCommands::TextureSlot::Normal: Renderer::SetNormalTextureSampler(samplerId); break;
+			}
+		}
+
+		void UpdateConstantBuffer(const RenderCommands::ConstantBuffer buffer, const void* data, const uint32_t byteWidth)
+		{
+			bool success = false;
+			switch (buffer)
+			{
+			case RenderCommands::ConstantBuffer::Object: success = Renderer::UpdateObjectBufferData(0, data, byteWidth); break;
+			case RenderCommands::ConstantBuffer::DirectionalLight: success = Renderer::UpdateDirectionalLightBufferData(0, data, byteWidth); break;
+			case RenderCommands::ConstantBuffer::PointLight: success = Renderer::UpdatePointLightBufferData(0, data, byteWidth); break;
+			case RenderCommands::ConstantBuffer::SpotLight: success = Renderer::UpdateSpotLightBufferData(0, data, byteWidth); break;
+			case RenderCommands::ConstantBuffer::Skybox: success = Renderer::UpdateSkyboxBufferData(0, data, byteWidth); break;
+			}
+
+			if (!success)
+			{
+				LEVIATHAN_LOG("Failed to update constant buffer data during render.");
+			}
+		}
+
+		void SetConstantBufferRange(const RenderCommands::ConstantBuffer buffer, const uint32_t offset, const uint32_t byteWidth)
+		{
+			switch (buffer)
+			{
+			case RenderCommands::ConstantBuffer::Object: Renderer::SetObjectBufferRange(offset, byteWidth); break;
+			case RenderCommands::ConstantBuffer::DirectionalLight: Renderer::SetDirectionalLightBufferRange(offset, byteWidth); break;
+			case RenderCommands::ConstantBuffer::PointLight: Renderer::SetPointLightBufferRange(offset, byteWidth); break;
+			case RenderCommands::ConstantBuffer::SpotLight: Renderer::SetSpotLightBufferRange(offset, byteWidth); break;
+			case RenderCommands::ConstantBuffer::Skybox: Renderer::SetSkyboxBufferRange(offset, byteWidth); break;
+			}
+		}
+
+		void DrawIndexed(const uint32_t indexCount, const uint32_t vertexStrideBytes, const RendererResourceId::IdType vertexBufferId,
+			const RendererResourceId::IdType indexBufferId)
+		{
+			Renderer::DrawIndexed(indexCount, vertexStrideBytes, vertexBufferId, indexBufferId);
+		}
+
+		void DrawIndexedInstanced(const uint32_t indexCount, const uint32_t vertexStrideBytes, const RendererResourceId::IdType vertexBufferId,
+			const RendererResourceId::IdType indexBufferId, const uint32_t instanceCount, const uint32_t firstInstance)
+		{
+			Renderer::DrawIndexedInstanced(indexCount, vertexStrideBytes, vertexBufferId, indexBufferId, instanceCount, firstInstance);
+		}
+
+		void UnbindShaderResources()
+		{
+			Renderer::UnbindShaderResources();
+		}
+	};
+
+	static void TrackGpuMemory(const RendererResourceId::IdType id, const GpuMemoryCategory category, const size_t sizeBytes)
+	{
+		gGpuResourceMemory[id] = GpuResourceMemory{ .Allocation = gGpuMemory.Track(category, sizeBytes, id) };
+	}
+
+	static void UntrackGpuMemory(const RendererResourceId::IdType id)
+	{
+		const auto found = gGpuResourceMemory.find(id);
+		if (found != gGpuResourceMemory.end())
+		{
+			gGpuMemory.Untrack(found->second.Allocation);
+			gGpuResourceMemory.erase(found);
+		}
+	}
+
+	static void ResizeGpuMemory(const RendererResourceId::IdType id, const size_t sizeBytes)
+	{
+		const auto found = gGpuResourceMemory.find(id);
+		if (found != gGpuResourceMemory.end())
+		{
+			gGpuMemory.Resize(found->second.Allocation, sizeBytes);
+		}
+	}
+
+	static void MarkGpuMemoryUsed(const RendererResourceId::IdType id)
+	{
+		const auto found = gGpuResourceMemory.find(id);
+		if (found != gGpuResourceMemory.end())
+		{
+			gGpuMemory.MarkUsed(found->second.Allocation);
+		}
+	}
+
+	// Bytes of the swap chain's back buffers and the scene color and depth stencil targets of the render area.
+	static size_t GetWindowRenderTargetBytes(const int width, const int height)
+	{
+		const uint32_t targetWidth = static_cast<uint32_t>(std::max(width, 0));
+		const uint32_t targetHeight = static_cast<uint32_t>(std::max(height, 0));
+		return GetGpuTextureBytes(targetWidth, targetHeight, 1, SwapChainBufferCount, GpuTextureFormat::RGBA8) +
+			GetGpuTextureBytes(targetWidth, targetHeight, 1, 1, GpuTextureFormat::RGBA32Float) +
+			GetGpuTextureBytes(targetWidth, targetHeight, 1, 1, GpuTextureFormat::Depth24Stencil8);
+	}
+
+	// Asks the owners of reclaimable resources to release their memory.
+	struct RendererGpuMemoryBackend
+	{
+		bool Reclaim(GpuAllocationId, const uint64_t resource)
+		{
+			const auto found = gGpuResourceMemory.find(resource);
+			if ((found == gGpuResourceMemory.end()) || (found->second.Reclaim == nullptr))
+			{
+				return false;
+			}
+
+			// The callback may destroy the resource.
+			const GpuResourceMemory memory = found->second;
+			return memory.Reclaim(resource, memory.UserData);
+		}
+	};
+
+	// Creates asynchronously requested resources with the renderer api. Created resources are tracked like resources created immediately.
+	struct RendererUploadBackend
+	{
+		bool CreateVertexBuffer(const void* vertexData, const uint32_t vertexCount, const size_t strideBytes, RendererResourceId::IdType& outId)
+		{
+			return LeviathanRenderer::CreateVertexBuffer(vertexData, vertexCount, strideBytes, outId);
+		}
+
+		bool CreateIndexBuffer(const uint32_t* indexData, const uint32_t indexCount, RendererResourceId::IdType& outId)
+		{
+			return LeviathanRenderer::CreateIndexBuffer(indexData, indexCount, outId);
+		}
+
+		bool CreateTexture2D(const uint32_t width, const uint32_t height, const void* data, const uint32_t rowSizeBytes, const bool sRGB, const bool HDR,
+			const bool generateMipmaps, RendererResourceId::IdType& outId)
+		{
+			const Texture2DDescription description = { .Width = width, .Height = height, .Data = data, .RowSizeBytes = rowSizeBytes, .sRGB = sRGB,
+				.GenerateMipmaps = generateMipmaps, .HDR = HDR };
+			return LeviathanRenderer::CreateTexture2D(description, outId);
+		}
+
+		bool CreateTextureCube(const uint32_t faceWidth, const void* const* faceData, const bool sRGB, const bool HDR, const bool halfFloat,
+			RendererResourceId::IdType& outId)
+		{
+			TextureCubeDescription description = { .FaceWidth = faceWidth, .sRGB = sRGB, .HDR = HDR, .HalfFloat = halfFloat };
+			std::copy(faceData, faceData + description.FaceTextureData.size(), description.FaceTextureData.begin());
+			return LeviathanRenderer::CreateTextureCube(description, outId);
+		}
+
+		bool SetTexture2DMips(const RendererResourceId::IdType id, const uint32_t width, const uint32_t height, const uint32_t mipCount,
+			const void* const* loadedMipData, const uint32_t loadedMipCount)
+		{
+			if (!Renderer::SetTexture2DMips(id, width, height, mipCount, loadedMipData, loadedMipCount))
+			{
+				return false;
+			}
+			ResizeGpuMemory(id, GetGpuTextureBytes(width, height, mipCount, 1, GpuTextureFormat::RGBA8));
+			return true;
+		}
+	};
+
+	static size_t GetStreamedMipBytes(const StreamedTexture2DDescription& description, const uint32_t firstMip, const uint32_t endMip)
+	{
+		size_t sizeBytes = 0;
+		for (uint32_t mip = firstMip; mip < endMip; ++mip)
+		{
+			sizeBytes += static_cast<size_t>(std::max(description.Width >> mip, 1u)) * std::max(description.Height >> mip, 1u) *
+				UploadQueue::Texture2DMipsBytesPerPixel;
+		}
+		return sizeBytes;
+	}
+
+	static void OnStreamedMipsUploaded(const UploadResult& result, void*)
+	{
+		const auto found = gStreamedMipUploads.find(result.Ticket);
+		if (found == gStreamedMipUploads.end())
+		{
+			return;
+		}
+
+		const StreamedMipUpload upload = found->second;
+		gStreamedMipUploads.erase(found);
+		if (result.Status == UploadStatus::Created)
+		{
+			gTextureStreamer.CompleteStreamIn(upload.Texture, upload.FirstMip);
+			return;
+		}
+		if (result.Status == UploadStatus::Failed)
+		{
+			LEVIATHAN_LOG("Failed to set mips from %u of streamed texture %u.", upload.FirstMip, upload.Texture);
+		}
+		gTextureStreamer.RevertStreamIn(upload.Texture, upload.FirstMip, upload.PreviousMip);
+	}
+
+	// Queues the replacement of the streamed texture's mips with the chain from firstMip. loadedMipData holds the mips [firstMip, previousMip) and the
+	// coarser mips are kept, so no loaded mips release the mips finer than firstMip.
+	static bool EnqueueStreamedTextureMips(const StreamedTextureId texture, const uint32_t firstMip, const uint32_t previousMip, const void* const loadedMipData)
+	{
+		const StreamedTexture2D& streamedTexture = gStreamedTextures[texture];
+		const StreamedTexture2DDescription& description = streamedTexture.Description;
+		const uint32_t loadedMipCount = (previousMip > firstMip) ? (previousMip - firstMip) : 0;
+		const UploadTicket ticket = gUploadQueue.EnqueueTexture2DMips(streamedTexture.Resource, std::max(description.Width >> firstMip, 1u),
+			std::max(description.Height >> firstMip, 1u), description.MipCount - firstMip, loadedMipData, loadedMipCount,
+			UploadDescription{ .Callback = OnStreamedMipsUploaded });
+		if (ticket == UploadQueue::InvalidTicket)
+		{
+			return false;
+		}
+		gStreamedMipUploads.emplace(ticket, StreamedMipUpload{ .Texture = texture, .FirstMip = firstMip, .PreviousMip = previousMip });
+		return true;
+	}
+
+	// Starts reading the mips of a streaming update's stream ins in background jobs and queues the stream outs. Mips are set through the upload queue
+	// within the upload budget.
+	struct RendererStreamingBackend
+	{
+		StreamInResult StreamIn(const StreamedTextureId texture, const uint32_t firstMip, const uint32_t residentMip)
+		{
+			const StreamedTexture2DDescription& description = gStreamedTextures[texture].Description;
+			gStreamedMipReader.Read(texture, firstMip, residentMip, description.ReadMips, description.UserData);
+			return StreamInResult::Loading;
+		}
+
+		void StreamOut(const StreamedTextureId texture, const uint32_t firstMip)
+		{
+			if (!EnqueueStreamedTextureMips(texture, firstMip, firstMip, nullptr))
+			{
+				LEVIATHAN_LOG("Failed to stream out mips of streamed texture %u.", texture);
+			}
+		}
+	};
+
+	// Queues the mips of the finished stream in reads for upload. Stream ins whose mips could not be read are reverted.
+	static void UploadStreamedMipReads()
+	{
+		gStreamedMipReader.CollectFinished([](const TextureMipRead& read)
+			{
+				const StreamedTexture2DDescription& description = gStreamedTextures[read.Texture].Description;
+				if (!read.Read || (read.MipData.size() < GetStreamedMipBytes(description, read.FirstMip, read.PreviousMip)) ||
+					!EnqueueStreamedTextureMips(read.Texture, read.FirstMip, read.PreviousMip, read.MipData.data()))
+				{
+					LEVIATHAN_LOG("Failed to stream in mips %u to %u of streamed texture %u.", read.FirstMip, read.PreviousMip - 1, read.Texture);
+					gTextureStreamer.RevertStreamIn(read.Texture, read.FirstMip, read.PreviousMip);
+				}
+			});
+	}
+
+	static inline uint64_t MakePassSortKey(const RenderPass pass)
+	{
+		return RenderCommands::MakeSortKey(static_cast<uint8_t>(pass), 0, 0, 0);
+	}
+
 #ifdef LEVIATHAN_WITH_TOOLS
 	static LeviathanCore::Callback<RenderImGuiCallbackType> RenderImGuiCallback = {};
 #endif // LEVIATHAN_WITH_TOOLS.
@@ -27,6 +456,7 @@ namespace LeviathanRenderer
 		}
 		renderWidth = renderAreaWidth;
 		renderHeight = renderAreaHeight;
+		gGpuMemory.Resize(gRenderTargetMemory, GetWindowRenderTargetBytes(renderWidth, renderHeight));
 	}
 
 #ifdef LEVIATHAN_WITH_TOOLS
@@ -85,7 +515,6 @@ namespace LeviathanRenderer
 
 	bool Initialize()
 	{
-		static constexpr unsigned int bufferCount = 3;
 		static constexpr bool vsync = false;
 
 #ifdef LEVIATHAN_WITH_TOOLS
@@ -109,10 +538,23 @@ namespace LeviathanRenderer
 			return false;
 		}
 
-		if (!Renderer::InitializeRendererApi(static_cast<unsigned int>(renderWidth), static_cast<unsigned int>(renderHeight), platformHandle, vsync, bufferCount))
+		if (!Renderer::InitializeRendererApi(static_cast<unsigned int>(renderWidth), static_cast<unsigned int>(renderHeight), platformHandle, vsync, SwapChainBufferCount))
+		{
+			return false;
+		}
+		gRenderTargetMemory = gGpuMemory.Track(GpuMemoryCategory::RenderTarget, GetWindowRenderTargetBytes(renderWidth, renderHeight), RendererResourceId::InvalidId);
+
+		if (!gConstantUploadRing.Initialize(RendererConstants::ConstantUploadBufferSizeBytes, RendererConstants::ConstantUploadAlignmentBytes,
+			RendererConstants::MaxFramesInFlight))
 		{
 			return false;
 		}
+		gFrameFence = 0;
+		if (Renderer::SupportsConstantBufferRanges())
+		{
+			gConstantUploadMemory = gGpuMemory.Track(GpuMemoryCategory::ConstantBuffer, RendererConstants::ConstantUploadBufferSizeBytes,
+				RendererResourceId::InvalidId);
+		}
 
 #ifdef LEVIATHAN_WITH_TOOLS
 		if (!Renderer::ImGuiRendererInitialize())
@@ -144,6 +586,37 @@ namespace LeviathanRenderer
 		Renderer::ImGuiRendererShutdown();
 #endif // LEVIATHAN_WITH_TOOLS.
 
+		// Release renderables. Their meshes and materials are owned by the title.
+		gRenderWorld.Clear();
+		gOcclusionCullingStage.ClearOccluders();
+
+		gConstantUploadRing.Reset();
+		gFrameFence = 0;
+
+		// Wait for the mip reads that are still running. Uploads that were not created are reported as cancelled.
+		gStreamedMipReader.Clear();
+		gUploadQueue.Clear();
+		gStreamedMipUploads.clear();
+
+		// Release streamed textures the title did not destroy.
+		for (auto& [resource, texture] : gStreamedTextureIds)
+		{
+			gTextureStreamer.Unregister(texture);
+			RendererResourceId::IdType id = resource;
+			Renderer::DestroyTexture(id);
+		}
+		gStreamedTextureIds.clear();
+		gStreamedTextures.clear();
+
+		// Resources the title did not destroy are released with the renderer api.
+		for (auto& [resource, memory] : gGpuResourceMemory)
+		{
+			gGpuMemory.Untrack(memory.Allocation);
+		}
+		gGpuResourceMemory.clear();
+		gGpuMemory.Untrack(gRenderTargetMemory);
+		gGpuMemory.Untrack(gConstantUploadMemory);
+
 		if (!Renderer::ShutdownRendererApi())
 		{
 			return false;
@@ -154,25 +627,37 @@ namespace LeviathanRenderer
 
 	bool CreateVertexBuffer(const void* vertexData, unsigned int vertexCount, size_t singleVertexStrideBytes, RendererResourceId::IdType& outId)
 	{
-		return Renderer::CreateVertexBuffer(vertexData, vertexCount, singleVertexStrideBytes, outId);
+		if (!Renderer::CreateVertexBuffer(vertexData, vertexCount, singleVertexStrideBytes, outId))
+		{
+			return false;
+		}
+		TrackGpuMemory(outId, GpuMemoryCategory::VertexBuffer, static_cast<size_t>(vertexCount) * singleVertexStrideBytes);
+		return true;
 	}
 
 	bool CreateIndexBuffer(const unsigned int* indexData, unsigned int indexCount, RendererResourceId::IdType& outId)
 	{
-		return Renderer::CreateIndexBuffer(indexData, indexCount, outId);
+		if (!Renderer::CreateIndexBuffer(indexData, indexCount, outId))
+		{
+			return false;
+		}
+		TrackGpuMemory(outId, GpuMemoryCategory::IndexBuffer, static_cast<size_t>(indexCount) * sizeof(unsigned int));
+		return true;
 	}
 
 	void DestroyVertexBuffer(RendererResourceId::IdType& id)
 	{
+		UntrackGpuMemory(id);
 		Renderer::DestroyVertexBuffer(id);
 	}
 
 	void DestroyIndexBuffer(RendererResourceId::IdType& id)
 	{
+		UntrackGpuMemory(id);
 		Renderer::DestroyIndexBuffer(id);
 	}
 
-	bool CreateTexture2D(const Texture2DDescription& description, RendererResourceId::IdType& outID)
+	static bool IsValidTexture2DDescription(const Texture2DDescription& description)
 	{
 		if (description.GenerateMipmaps)
 		{
@@ -182,11 +667,34 @@ namespace LeviathanRenderer
 				return false;
 			}
 		}
-		return Renderer::CreateTexture2D(description.Width, description.Height, description.Data, description.RowSizeBytes, description.sRGB, description.HDR, description.GenerateMipmaps, outID);
+		return true;
+	}
+
+	bool CreateTexture2D(const Texture2DDescription& description, RendererResourceId::IdType& outID)
+	{
+		if (!IsValidTexture2DDescription(description))
+		{
+			return false;
+		}
+		if (!Renderer::CreateTexture2D(description.Width, description.Height, description.Data, description.RowSizeBytes, description.sRGB, description.HDR, description.GenerateMipmaps, outID))
+		{
+			return false;
+		}
+
+		// Generated chains stop at the first mip 1 texel wide or high.
+		uint32_t mipCount = 1;
+		for (uint32_t size = std::min(description.Width, description.Height); description.GenerateMipmaps && (size > 1); size >>= 1)
+		{
+			++mipCount;
+		}
+		TrackGpuMemory(outID, GpuMemoryCategory::Texture2D, GetGpuTextureBytes(description.Width, description.Height, mipCount, 1,
+			(description.HDR) ? GpuTextureFormat::RGBA32Float : GpuTextureFormat::RGBA8));
+		return true;
 	}
 
 	void DestroyTexture2D(RendererResourceId::IdType& id)
 	{
+		UntrackGpuMemory(id);
 		Renderer::DestroyTexture(id);
 	}
 
@@ -202,80 +710,461 @@ namespace LeviathanRenderer
 
 	bool CreateTextureCube(const TextureCubeDescription& description, RendererResourceId::IdType& outId)
 	{
-		return Renderer::CreateTextureCube(description.FaceWidth, description.FaceTextureData.data(), description.sRGB, outId);
+		if (!Renderer::CreateTextureCube(description.FaceWidth, description.FaceTextureData.data(), description.sRGB, description.HDR, description.HalfFloat,
+			outId))
+		{
+			return false;
+		}
+		const GpuTextureFormat format = (description.HDR) ? ((description.HalfFloat) ? GpuTextureFormat::RGBA16Float : GpuTextureFormat::RGBA32Float) :
+			GpuTextureFormat::RGBA8;
+		TrackGpuMemory(outId, GpuMemoryCategory::TextureCube, GetGpuTextureBytes(description.FaceWidth, description.FaceWidth, 1, 6, format));
+		return true;
 	}
 
 	void DestroyTextureCube(RendererResourceId::IdType& id)
 	{
+		UntrackGpuMemory(id);
 		Renderer::DestroyTextureCube(id);
 	}
 
+	UploadTicket CreateVertexBufferAsync(const void* vertexData, unsigned int vertexCount, size_t singleVertexStrideBytes, const UploadDescription& uploadDescription)
+	{
+		return gUploadQueue.EnqueueVertexBuffer(vertexData, vertexCount, singleVertexStrideBytes, uploadDescription);
+	}
+
+	UploadTicket CreateIndexBufferAsync(const unsigned int* indexData, unsigned int indexCount, const UploadDescription& uploadDescription)
+	{
+		return gUploadQueue.EnqueueIndexBuffer(indexData, indexCount, uploadDescription);
+	}
+
+	UploadTicket CreateTexture2DAsync(const Texture2DDescription& description, const UploadDescription& uploadDescription)
+	{
+		if (!IsValidTexture2DDescription(description))
+		{
+			return UploadQueue::InvalidTicket;
+		}
+		return gUploadQueue.EnqueueTexture2D(description.Width, description.Height, description.Data, description.RowSizeBytes, description.sRGB, description.HDR,
+			description.GenerateMipmaps, uploadDescription);
+	}
+
+	UploadTicket CreateTextureCubeAsync(const TextureCubeDescription& description, const UploadDescription& uploadDescription)
+	{
+		return gUploadQueue.EnqueueTextureCube(description.FaceWidth, description.FaceTextureData.data(), description.sRGB, description.HDR,
+			description.HalfFloat, uploadDescription);
+	}
+
+	bool CancelUpload(const UploadTicket ticket)
+	{
+		return gUploadQueue.Cancel(ticket);
+	}
+
+	void SetUploadBudget(const size_t budgetBytesPerFrame)
+	{
+		gUploadQueue.SetBudget(budgetBytesPerFrame);
+	}
+
+	void FlushUploads()
+	{
+		RendererUploadBackend backend = {};
+		gUploadQueue.Flush(backend);
+	}
+
+	const UploadQueueStats& GetUploadQueueStats()
+	{
+		return gUploadQueue.GetStats();
+	}
+
+	bool CreateStreamedTexture2D(const StreamedTexture2DDescription& description, RendererResourceId::IdType& outId)
+	{
+		static constexpr uint32_t bytesPerPixel = 4;
+
+		outId = RendererResourceId::InvalidId;
+		if (description.ReadMips == nullptr)
+		{
+			LEVIATHAN_LOG("Failed to create streamed texture 2D. The description has no mip reader.");
+			return false;
+		}
+
+		StreamedTextureId texture = gTextureStreamer.Register(description.Width, description.Height, description.MipCount, bytesPerPixel);
+		if (texture == InvalidStreamedTextureId)
+		{
+			LEVIATHAN_LOG("Failed to create streamed texture 2D. The texture has no mips or more than %u mips.", TextureStreamer::MaxMipCount);
+			return false;
+		}
+
+		// Create the texture with the tail and stream the rest.
+		const uint32_t tailMip = gTextureStreamer.GetTailMip(texture);
+		const uint32_t tailMipCount = description.MipCount - tailMip;
+		std::array<const void*, TextureStreamer::MaxMipCount> tailMipData = { nullptr };
+		bool created = description.ReadMips(tailMip, tailMipCount, gStreamedMipData, description.UserData);
+		if (created)
+		{
+			size_t offset = 0;
+			for (uint32_t mip = 0; mip < tailMipCount; ++mip)
+			{
+				tailMipData[mip] = gStreamedMipData.data() + offset;
+				offset += static_cast<size_t>(std::max(description.Width >> (tailMip + mip), 1u)) * std::max(description.Height >> (tailMip + mip), 1u) * bytesPerPixel;
+			}
+			created = (offset <= gStreamedMipData.size()) && Renderer::CreateTexture2DMips(std::max(description.Width >> tailMip, 1u),
+				std::max(description.Height >> tailMip, 1u), tailMipCount, tailMipData.data(), description.sRGB, outId);
+		}
+		if (!created)
+		{
+			LEVIATHAN_LOG("Failed to create streamed texture 2D. The tail mips could not be read or created.");
+			gTextureStreamer.Unregister(texture);
+			outId = RendererResourceId::InvalidId;
+			return false;
+		}
+
+		if (gStreamedTextures.size() <= texture)
+		{
+			gStreamedTextures.resize(static_cast<size_t>(texture) + 1);
+		}
+		gStreamedTextures[texture] = StreamedTexture2D{ .Resource = outId, .Description = description };
+		gStreamedTextureIds.emplace(outId, texture);
+		TrackGpuMemory(outId, GpuMemoryCategory::StreamedTexture, GetGpuTextureBytes(std::max(description.Width >> tailMip, 1u),
+			std::max(description.Height >> tailMip, 1u), tailMipCount, 1, GpuTextureFormat::RGBA8));
+		return true;
+	}
+
+	void DestroyStreamedTexture2D(RendererResourceId::IdType& id)
+	{
+		const auto found = gStreamedTextureIds.find(id);
+		if (found != gStreamedTextureIds.end())
+		{
+			StreamedTextureId texture = found->second;
+
+			// Wait for the texture's mip reads so that its user data can be released.
+			gStreamedMipReader.Cancel(texture);
+
+			// Cancel the texture's waiting mip updates. Cancelling removes them from the waiting updates.
+			std::vector<UploadTicket> tickets = {};
+			for (const auto& [ticket, upload] : gStreamedMipUploads)
+			{
+				if (upload.Texture == texture)
+				{
+					tickets.push_back(ticket);
+				}
+			}
+			for (const UploadTicket ticket : tickets)
+			{
+				gUploadQueue.Cancel(ticket);
+			}
+
+			gStreamedTextures[texture] = {};
+			gTextureStreamer.Unregister(texture);
+			gStreamedTextureIds.erase(found);
+			UntrackGpuMemory(id);
+			Renderer::DestroyTexture(id);
+		}
+		id = RendererResourceId::InvalidId;
+	}
+
+	void SetTextureStreamingBudget(const size_t poolBytes, const size_t bytesPerFrame)
+	{
+		TextureStreamingSettings settings = gTextureStreamer.GetSettings();
+		settings.PoolBytes = poolBytes;
+		settings.MaxStreamInBytesPerUpdate = bytesPerFrame;
+		gTextureStreamer.SetSettings(settings);
+	}
+
+	const TextureStreamingStats& GetTextureStreamingStats()
+	{
+		return gTextureStreamer.GetStats();
+	}
+
+	void SetGpuMemoryBudget(const GpuMemoryCategory category, const size_t budgetBytes)
+	{
+		gGpuMemory.SetBudget(category, budgetBytes);
+	}
+
+	void SetGpuMemoryTotalBudget(const size_t budgetBytes)
+	{
+		gGpuMemory.SetTotalBudget(budgetBytes);
+	}
+
+	void SetGpuMemoryBudgetExceededCallback(const GpuMemoryBudgetExceededCallbackType callback, void* const userData)
+	{
+		gGpuMemory.SetBudgetExceededCallback(callback, userData);
+	}
+
+	bool SetResourceReclaimPriority(const RendererResourceId::IdType id, const uint8_t priority, const GpuMemoryReclaimCallbackType reclaim, void* const userData)
+	{
+		const auto found = gGpuResourceMemory.find(id);
+		if ((found == gGpuResourceMemory.end()) || (gStreamedTextureIds.find(id) != gStreamedTextureIds.end()))
+		{
+			LEVIATHAN_LOG("Failed to set reclaim priority. The resource is not a tracked vertex buffer, index buffer, texture or cubemap.");
+			return false;
+		}
+
+		found->second.Reclaim = reclaim;
+		found->second.UserData = userData;
+		gGpuMemory.SetReclaimPriority(found->second.Allocation, (reclaim != nullptr) ? priority : GpuMemoryTracker::NotReclaimable);
+		return true;
+	}
+
+	const GpuMemoryStats& GetGpuMemoryStats()
+	{
+		return gGpuMemory.GetStats();
+	}
+
+	RenderableId CreateRenderable(const RenderableDescription& description)
+	{
+		return gRenderWorld.Create(description);
+	}
+
+	void DestroyRenderable(RenderableId& id)
+	{
+		if (gRenderWorld.IsValid(id))
+		{
+			gRenderWorld.Destroy(id);
+		}
+		id = InvalidRenderableId;
+	}
+
+	void SetRenderableTransform(const RenderableId id, const LeviathanCore::MathTypes::Matrix4x4& transform)
+	{
+		gRenderWorld.SetTransform(id, transform);
+	}
+
+	void SetRenderableMesh(const RenderableId id, const RenderMesh& mesh)
+	{
+		gRenderWorld.SetMesh(id, mesh);
+	}
+
+	void SetRenderableMaterial(const RenderableId id, const RenderMaterial& material)
+	{
+		gRenderWorld.SetMaterial(id, material);
+	}
+
+	OccluderId CreateOccluder(const OccluderDescription& description)
+	{
+		return gOcclusionCullingStage.CreateOccluder(description);
+	}
+
+	void DestroyOccluder(OccluderId& id)
+	{
+		if (gOcclusionCullingStage.IsValid(id))
+		{
+			gOcclusionCullingStage.DestroyOccluder(id);
+		}
+		id = InvalidOccluderId;
+	}
+
+	void SetOccluderTransform(const OccluderId id, const LeviathanCore::MathTypes::Matrix4x4& transform)
+	{
+		gOcclusionCullingStage.SetOccluderTransform(id, transform);
+	}
+
 	void Render([[maybe_unused]] const LeviathanRenderer::Camera& sceneView, [[maybe_unused]] const LeviathanRenderer::Camera& skyboxView,
 		[[maybe_unused]] RendererResourceId::IdType skyboxVertexBufferId, [[maybe_unused]] RendererResourceId::IdType skyboxIndexBufferId,
 		[[maybe_unused]] const LeviathanRenderer::LightTypes::DirectionalLight* const pSceneDirectionalLights, [[maybe_unused]] const size_t numDirectionalLights,
 		[[maybe_unused]] const LeviathanRenderer::LightTypes::PointLight* const pScenePointLights, [[maybe_unused]] const size_t numPointLights,
 		[[maybe_unused]] const LeviathanRenderer::LightTypes::SpotLight* const pSceneSpotLights, [[maybe_unused]] const size_t numSpotLights,
-		[[maybe_unused]] const RendererResourceId::IdType skyboxTextureCubeResourceId, [[maybe_unused]] const RendererResourceId::IdType skyboxTextureCubeSamplerId,
-		[[maybe_unused]] RendererResourceId::IdType colorTextureResourceId, [[maybe_unused]] RendererResourceId::IdType metallicTextureResourceId,
-		[[maybe_unused]] RendererResourceId::IdType roughnessTextureResourceId, [[maybe_unused]] RendererResourceId::IdType normalTextureResourceId,
-		[[maybe_unused]] RendererResourceId::IdType samplerResourceId, [[maybe_unused]] const LeviathanCore::MathTypes::Matrix4x4& objectTransformMatrix,
-		[[maybe_unused]] const uint32_t objectIndexCount, [[maybe_unused]] RendererResourceId::IdType objectVertexBufferResourceId,
-		[[maybe_unused]] RendererResourceId::IdType objectIndexBufferResourceId)
+		[[maybe_unused]] const RendererResourceId::IdType skyboxTextureCubeResourceId, [[maybe_unused]] const RendererResourceId::IdType skyboxTextureCubeSamplerId)
 	{
+		// Create asynchronously requested resources and the mips of the finished streamed mip reads within the frame's upload budget. Callbacks run
+		// before the render world is culled so that renderables updated with the new resources draw with them this frame.
+		UploadStreamedMipReads();
+		RendererUploadBackend uploadBackend = {};
+		gUploadQueue.Process(uploadBackend);
+
+		// Visibility.
+		// Cull the render world against the scene view and the occluders and build the draw list of visible renderables. Lighting passes only draw
+		// visible renderables.
+		BuildDrawList(gRenderWorld, sceneView, gFrustumCullingStage, gOcclusionCullingStage, gDrawList);
+
+		// Mark the resources of the visible renderables and the skybox used so that they are not reclaimed at the end of the frame. Add the demand
+		// of the visible renderables for the mips of their streamed textures and stream mips within the pool and the frame's streaming budget.
+		// Streamed mips are read in background jobs and set within the upload budget from the first frame after their read finished.
+		for (const RendererResourceId::IdType resource : { skyboxVertexBufferId, skyboxIndexBufferId, skyboxTextureCubeResourceId })
+		{
+			MarkGpuMemoryUsed(resource);
+		}
+		const bool streamingTextures = !gStreamedTextureIds.empty();
+		for (const uint32_t renderable : gDrawList.Renderables)
+		{
+			const RenderMesh& mesh = gRenderWorld.GetMesh(renderable);
+			const RenderMaterial& material = gRenderWorld.GetMaterial(renderable);
+			for (const RendererResourceId::IdType resource : { mesh.VertexBuffer, mesh.IndexBuffer, material.ColorTexture, material.MetallicTexture,
+				material.RoughnessTexture, material.NormalTexture })
+			{
+				MarkGpuMemoryUsed(resource);
+			}
+
+			if (streamingTextures)
+			{
+				const LeviathanCore::BoundingVolumes::Sphere localBounds = { .Center = mesh.LocalBounds.Center(), .Radius = mesh.LocalBounds.HalfExtents().Length() };
+				const LeviathanCore::BoundingVolumes::Sphere worldBounds = localBounds.Transformed(gRenderWorld.GetWorldMatrix(renderable));
+				const float worldScale = (localBounds.Radius > 0.0f) ? (worldBounds.Radius / localBounds.Radius) : 1.0f;
+
+				for (const RendererResourceId::IdType textureId : { material.ColorTexture, material.MetallicTexture, material.RoughnessTexture, material.NormalTexture })
+				{
+					const auto found = gStreamedTextureIds.find(textureId);
+					if (found != gStreamedTextureIds.end())
+					{
+						const StreamedTexture2DDescription& description = gStreamedTextures[found->second].Description;
+						const float texelsPerWorldUnit = static_cast<float>(std::max(description.Width, description.Height)) * mesh.TextureCoordinateDensity / worldScale;
+						gTextureStreamer.AddDemand(found->second, GetTextureMipDemand(sceneView, worldBounds, texelsPerWorldUnit, static_cast<float>(renderHeight)));
+					}
+				}
+			}
+		}
+		RendererStreamingBackend streamingBackend = {};
+		gTextureStreamer.Update(streamingBackend);
+
+		// Group visible renderables sharing a mesh and material into instanced draws. Object data is read from the instance stream.
+		BuildInstanceBatches(gRenderWorld, gDrawList, gInstanceBatches);
+		const size_t batchCount = gInstanceBatches.GetBatchCount();
+
+		// Test the visible objects against the influence volumes of the point and spot lights.
+		gLightInfluence.Build(gRenderWorld, gDrawList, gInstanceBatches, pScenePointLights, numPointLights, pSceneSpotLights, numSpotLights);
+
+		// Recycle the constant data ranges of frames the gpu completed. Wait for the oldest frame if the maximum number of frames is in flight.
+		gConstantUploadRing.Retire(Renderer::GetCompletedFrameFence());
+		if (!gConstantUploadRing.BeginFrame())
+		{
+			Renderer::WaitForFrameFence(gConstantUploadRing.GetOldestFrameFence());
+			gConstantUploadRing.Retire(Renderer::GetCompletedFrameFence());
+			gConstantUploadRing.BeginFrame();
+		}
+
+		// Map the constant upload buffer once for the frame. Ranges of frames in flight are not written so the gpu can keep reading them.
+		const bool constantBufferRanges = Renderer::SupportsConstantBufferRanges();
+		void* constantUploadData = nullptr;
+		if ((constantBufferRanges) && (!Renderer::MapConstantUploadBuffer((gConstantUploadRing.GetFrameInFlightCount() == 0), constantUploadData)))
+		{
+			LEVIATHAN_LOG("Failed to map constant upload buffer during render.");
+			constantUploadData = nullptr;
+		}
+
+		// Record the frame's commands. Each pass starts with a packet setting its state followed by packets for its draws.
+		gRenderCommands.Reset(1);
+		RenderCommands::CommandBuffer& commands = gRenderCommands.GetBuffer(0);
+
+		// Writes constant data to a range of the frame's constant upload buffer and records binding it. Waits for frames in flight while the ring is
+		// full. Without constant buffer ranges the data is recorded to update and bind the whole constant buffer instead. Returns false if the data
+		// could not be written.
+		const auto recordConstantData = [&commands, constantBufferRanges, constantUploadData](const RenderCommands::ConstantBuffer buffer, const void* data,
+			const uint32_t byteWidth)
+			{
+				if (!constantBufferRanges)
+				{
+					commands.UpdateConstantBuffer(buffer, data, byteWidth);
+					return true;
+				}
+
+				if (constantUploadData == nullptr)
+				{
+					return false;
+				}
+
+				size_t offset = gConstantUploadRing.Allocate(byteWidth);
+				while ((offset == UploadRing::InvalidOffset) && (gConstantUploadRing.GetFrameInFlightCount() > 0))
+				{
+					Renderer::WaitForFrameFence(gConstantUploadRing.GetOldestFrameFence());
+					gConstantUploadRing.Retire(Renderer::GetCompletedFrameFence());
+					offset = gConstantUploadRing.Allocate(byteWidth);
+				}
+
+				if (offset == UploadRing::InvalidOffset)
+				{
+					LEVIATHAN_LOG("Failed to allocate constant data during render.");
+					return false;
+				}
+
+				memcpy(static_cast<uint8_t*>(constantUploadData) + offset, data, byteWidth);
+				commands.SetConstantBufferRange(buffer, static_cast<uint32_t>(offset), byteWidth);
+				return true;
+			};
+
+		// Records the material bindings and instanced draw of an instance batch for a lighting pass. The pipeline is set after the material's
+		// textures so that the shader resource tables are bound with them, with the pixel shader permutation of the material's features.
+		const auto recordObjectLightingDraw = [&commands](const RenderCommands::Pipeline pipeline, const size_t batchIndex)
+			{
+				const InstanceBatch& batch = gInstanceBatches.Batches[batchIndex];
+				const RenderMaterial& material = gRenderWorld.GetMaterial(batch.Renderable);
+				const RenderMesh& mesh = gRenderWorld.GetMesh(batch.Renderable);
+				const bool normalMapping = (material.NormalTexture != RendererResourceId::InvalidId);
+
+				// Update shader resource table data.
+				commands.SetTexture(RenderCommands::TextureSlot::Color, material.ColorTexture);
+				commands.SetTexture(RenderCommands::TextureSlot::Metallic, material.MetallicTexture);
+				commands.SetTexture(RenderCommands::TextureSlot::Roughness, material.RoughnessTexture);
+				if (normalMapping)
+				{
+					commands.SetTexture(RenderCommands::TextureSlot::Normal, material.NormalTexture);
+				}
+
+				commands.SetSampler(RenderCommands::TextureSlot::Color, material.Sampler);
+				commands.SetSampler(RenderCommands::TextureSlot::Roughness, material.Sampler);
+				commands.SetSampler(RenderCommands::TextureSlot::Metallic, material.Sampler);
+				if (normalMapping)
+				{
+					commands.SetSampler(RenderCommands::TextureSlot::Normal, material.Sampler);
+				}
+
+				commands.SetPipeline(pipeline, normalMapping ? RendererConstants::NormalMappedLightingPermutation : 0);
+
+				// Draw.
+				commands.DrawIndexedInstanced(mesh.IndexCount, mesh.VertexStrideBytes, mesh.VertexBuffer, mesh.IndexBuffer, batch.InstanceCount, batch.FirstInstance);
+			};
+
 		// Begin frame.
+		commands.BeginPacket(MakePassSortKey(RenderPass::BeginFrame));
 
 		// Clear screen render target, scene render target and depth/stencil buffer.
 		static constexpr float clearColor[] = { 0.0f, 0.0f, 0.0f, 0.0f };
-		Renderer::ClearScreenRenderTarget(clearColor);
-		Renderer::ClearSceneRenderTarget(clearColor);
+		commands.ClearRenderTarget(RenderCommands::RenderTarget::Screen, clearColor);
+		commands.ClearRenderTarget(RenderCommands::RenderTarget::Scene, clearColor);
 		static constexpr float clearDepth = 1.0f;
 		static constexpr uint8_t clearStencil = 0;
-		Renderer::ClearDepthStencil(clearDepth, clearStencil);
+		commands.ClearDepthStencil(clearDepth, clearStencil);
 
 		// Set offscreen render target.
-		Renderer::SetSceneRenderTarget();
+		commands.SetRenderTarget(RenderCommands::RenderTarget::Scene);
+
+		// Ambient indirect lighting pass. 
+		// TODO: Replace with HDRI image based lighting.
+		// TODO: Implement fallback base lighting pass if HDRI is not present or being used. Possibly just a depth pass to write to the depth buffer.
+		commands.BeginPacket(MakePassSortKey(RenderPass::AmbientLight));
 
 		// Disable blending.
-		Renderer::SetBlendStateBlendDisabled();
+		commands.SetBlendState(RenderCommands::BlendState::Disabled);
 
 		// Enable depth writes and less than depth tests.
-		Renderer::SetDepthStencilStateWriteDepthDepthFuncLessStencilDisabled();
+		commands.SetDepthStencilState(RenderCommands::DepthStencilState::WriteDepthDepthFuncLess);
 
-		// Ambient indirect lighting pass. 
-		// TODO: Replace with HDRI image based lighting.
-		// TODO: Implement fallback base lighting pass if HDRI is not present or being used. Possibly just a depth pass to write to the depth buffer.
-		Renderer::SetAmbientLightPipeline();
+		commands.SetPipeline(RenderCommands::Pipeline::AmbientLight);
+		for (size_t batchIndex = 0; batchIndex < batchCount; ++batchIndex)
 		{
-			Renderer::SetEnvironmentTextureCubeResource(skyboxTextureCubeResourceId);
-			Renderer::SetEnvironmentTextureSampler(skyboxTextureCubeSamplerId);
-			Renderer::SetColorTexture2DResource(colorTextureResourceId);
-			Renderer::SetColorTextureSampler(samplerResourceId);
+			const InstanceBatch& batch = gInstanceBatches.Batches[batchIndex];
+			const RenderMaterial& material = gRenderWorld.GetMaterial(batch.Renderable);
+			const RenderMesh& mesh = gRenderWorld.GetMesh(batch.Renderable);
 
-			const LeviathanCore::MathTypes::Matrix4x4 worldMatrix = objectTransformMatrix;
-			const LeviathanCore::MathTypes::Matrix4x4 worldViewMatrix = sceneView.GetViewMatrix() * worldMatrix;
-			const LeviathanCore::MathTypes::Matrix4x4 normalMatrix = LeviathanCore::MathTypes::Matrix4x4::Transpose(LeviathanCore::MathTypes::Matrix4x4::Inverse(worldViewMatrix));
-			const LeviathanCore::MathTypes::Matrix4x4 worldViewProjectionMatrix = sceneView.GetViewProjectionMatrix() * worldMatrix;
+			// Batch sort keys hold the material and depth fields of the batch's nearest instance.
+			commands.BeginPacket(RenderCommands::MakeSortKey(static_cast<uint8_t>(RenderPass::AmbientLight), static_cast<uint8_t>(RenderCommands::Pipeline::AmbientLight),
+				0, 0) | batch.SortKey);
 
-			// Update object data.
-			LeviathanRenderer::ConstantBufferTypes::ObjectConstantBuffer objectData = {};
-			memcpy(objectData.WorldViewMatrix, worldViewMatrix.Data(), sizeof(float) * 16);
-			memcpy(objectData.WorldViewProjectionMatrix, worldViewProjectionMatrix.Data(), sizeof(float) * 16);
-			memcpy(objectData.NormalMatrix, worldViewMatrix.Data(), sizeof(float) * 16);
-			Renderer::UpdateObjectBufferData(0, &objectData, sizeof(LeviathanRenderer::ConstantBufferTypes::ObjectConstantBuffer));
+			commands.SetTexture(RenderCommands::TextureSlot::Environment, skyboxTextureCubeResourceId);
+			commands.SetSampler(RenderCommands::TextureSlot::Environment, skyboxTextureCubeSamplerId);
+			commands.SetTexture(RenderCommands::TextureSlot::Color, material.ColorTexture);
+			commands.SetSampler(RenderCommands::TextureSlot::Color, material.Sampler);
 
 			// Draw.
-			Renderer::DrawIndexed(objectIndexCount, sizeof(LeviathanRenderer::VertexTypes::VertexPos3Norm3UV2Tang3), objectVertexBufferResourceId, objectIndexBufferResourceId);
+			commands.DrawIndexedInstanced(mesh.IndexCount, mesh.VertexStrideBytes, mesh.VertexBuffer, mesh.IndexBuffer, batch.InstanceCount, batch.FirstInstance);
 		}
 
+		// Directional light pass.
+		commands.BeginPacket(MakePassSortKey(RenderPass::DirectionalLight));
+
 		// Disable depth buffer writes and set depth test function to equal.
-		Renderer::SetDepthStencilStateNoWriteDepthDepthFuncEqualStencilDisabled();
+		commands.SetDepthStencilState(RenderCommands::DepthStencilState::NoWriteDepthDepthFuncEqual);
 
 		// Set additive blending.
-		Renderer::SetBlendStateAdditive();
+		commands.SetBlendState(RenderCommands::BlendState::Additive);
 
-		// Directional light pass.
-		Renderer::SetDirectionalLightPipeline();
-		for (size_t i = 0; i < numDirectionalLights; ++i)
+		for (size_t i = 0; (batchCount > 0) && (i < numDirectionalLights); ++i)
 		{
 			LeviathanCore::MathTypes::Vector3 directionalLightRadiance = pSceneDirectionalLights[i].Color * pSceneDirectionalLights[i].Brightness;
 			LeviathanCore::MathTypes::Vector4 lightDirectionViewSpace4 = sceneView.GetViewMatrix() * LeviathanCore::MathTypes::Vector4(pSceneDirectionalLights[i].Direction, 0.0f);
@@ -284,41 +1173,29 @@ namespace LeviathanRenderer
 			LeviathanRenderer::ConstantBufferTypes::DirectionalLightConstantBuffer directionalLightData = {};
 			memcpy(&directionalLightData.Radiance, directionalLightRadiance.Data(), sizeof(float) * 3);
 			memcpy(&directionalLightData.LightDirectionViewSpace, lightDirectionViewSpace.Data(), sizeof(float) * 3);
-			Renderer::UpdateDirectionalLightBufferData(0, static_cast<const void*>(&directionalLightData), sizeof(LeviathanRenderer::ConstantBufferTypes::DirectionalLightConstantBuffer));
-
-			// TODO: For each object affected by light, daw.
-			// TODO: Material properties for object.
-			// Update shader resource table data.
-			Renderer::SetColorTexture2DResource(colorTextureResourceId);
-			Renderer::SetMetallicTexture2DResource(metallicTextureResourceId);
-			Renderer::SetRoughnessTexture2DResource(roughnessTextureResourceId);
-			Renderer::SetNormalTexture2DResource(normalTextureResourceId);
-
-			Renderer::SetColorTextureSampler(samplerResourceId);
-			Renderer::SetRoughnessTextureSampler(samplerResourceId);
-			Renderer::SetMetallicTextureSampler(samplerResourceId);
-			Renderer::SetNormalTextureSampler(samplerResourceId);
-
-			const LeviathanCore::MathTypes::Matrix4x4 worldMatrix = objectTransformMatrix;
-			const LeviathanCore::MathTypes::Matrix4x4 worldViewMatrix = sceneView.GetViewMatrix() * worldMatrix;
-			const LeviathanCore::MathTypes::Matrix4x4 normalMatrix = LeviathanCore::MathTypes::Matrix4x4::Transpose(LeviathanCore::MathTypes::Matrix4x4::Inverse(worldViewMatrix));
-			const LeviathanCore::MathTypes::Matrix4x4 worldViewProjectionMatrix = sceneView.GetViewProjectionMatrix() * worldMatrix;
-
-			// Update object data.
-			LeviathanRenderer::ConstantBufferTypes::ObjectConstantBuffer objectData = {};
-			memcpy(objectData.WorldViewMatrix, worldViewMatrix.Data(), sizeof(float) * 16);
-			memcpy(objectData.WorldViewProjectionMatrix, worldViewProjectionMatrix.Data(), sizeof(float) * 16);
-			memcpy(objectData.NormalMatrix, worldViewMatrix.Data(), sizeof(float) * 16);
-			Renderer::UpdateObjectBufferData(0, &objectData, sizeof(LeviathanRenderer::ConstantBufferTypes::ObjectConstantBuffer));
+			if (!recordConstantData(RenderCommands::ConstantBuffer::DirectionalLight, &directionalLightData,
+				sizeof(LeviathanRenderer::ConstantBufferTypes::DirectionalLightConstantBuffer)))
+			{
+				continue;
+			}
 
-			// Draw.
-			Renderer::DrawIndexed(objectIndexCount, sizeof(LeviathanRenderer::VertexTypes::VertexPos3Norm3UV2Tang3), objectVertexBufferResourceId, objectIndexBufferResourceId);
+			// TODO: Only draw objects affected by light.
+			for (size_t batchIndex = 0; batchIndex < batchCount; ++batchIndex)
+			{
+				recordObjectLightingDraw(RenderCommands::Pipeline::DirectionalLight, batchIndex);
+			}
 		}
 
 		// Point light pass.
-		Renderer::SetPointLightPipeline();
+		commands.BeginPacket(MakePassSortKey(RenderPass::PointLight));
 		for (size_t i = 0; i < numPointLights; ++i)
 		{
+			const size_t litBatchCount = gLightInfluence.GetLightBatchCount(i);
+			if (litBatchCount == 0)
+			{
+				continue;
+			}
+
 			// Update point light data.
 			LeviathanRenderer::ConstantBufferTypes::PointLightConstantBuffer pointLightData = {};
 
@@ -328,42 +1205,32 @@ namespace LeviathanRenderer
 
 			memcpy(&pointLightData.Radiance, pointLightRadiance.Data(), sizeof(float) * 3);
 			memcpy(&pointLightData.LightPositionViewSpace, pointLightPositionViewSpace.Data(), sizeof(float) * 3);
+			pointLightData.Radius = LightTypes::GetInfluenceRadius(pScenePointLights[i]);
 
-			Renderer::UpdatePointLightBufferData(0, static_cast<const void*>(&pointLightData), sizeof(LeviathanRenderer::ConstantBufferTypes::PointLightConstantBuffer));
-
-			// TODO: For each object affected by light, daw.
-			// TODO: Material properties for object.
-			// Update shader resource table data.
-			Renderer::SetColorTexture2DResource(colorTextureResourceId);
-			Renderer::SetMetallicTexture2DResource(metallicTextureResourceId);
-			Renderer::SetRoughnessTexture2DResource(roughnessTextureResourceId);
-			Renderer::SetNormalTexture2DResource(normalTextureResourceId);
-
-			Renderer::SetColorTextureSampler(samplerResourceId);
-			Renderer::SetRoughnessTextureSampler(samplerResourceId);
-			Renderer::SetMetallicTextureSampler(samplerResourceId);
-			Renderer::SetNormalTextureSampler(samplerResourceId);
-
-			const LeviathanCore::MathTypes::Matrix4x4 worldMatrix = objectTransformMatrix;
-			const LeviathanCore::MathTypes::Matrix4x4 worldViewMatrix = sceneView.GetViewMatrix() * worldMatrix;
-			const LeviathanCore::MathTypes::Matrix4x4 normalMatrix = LeviathanCore::MathTypes::Matrix4x4::Transpose(LeviathanCore::MathTypes::Matrix4x4::Inverse(worldViewMatrix));
-			const LeviathanCore::MathTypes::Matrix4x4 worldViewProjectionMatrix = sceneView.GetViewProjectionMatrix() * worldMatrix;
-
-			// Update object data.
-			LeviathanRenderer::ConstantBufferTypes::ObjectConstantBuffer objectData = {};
-			memcpy(objectData.WorldViewMatrix, worldViewMatrix.Data(), sizeof(float) * 16);
-			memcpy(objectData.WorldViewProjectionMatrix, worldViewProjectionMatrix.Data(), sizeof(float) * 16);
-			memcpy(objectData.NormalMatrix, worldViewMatrix.Data(), sizeof(float) * 16);
-			Renderer::UpdateObjectBufferData(0, &objectData, sizeof(LeviathanRenderer::ConstantBufferTypes::ObjectConstantBuffer));
+			if (!recordConstantData(RenderCommands::ConstantBuffer::PointLight, &pointLightData, sizeof(LeviathanRenderer::ConstantBufferTypes::PointLightConstantBuffer)))
+			{
+				continue;
+			}
 
-			// Draw.
-			Renderer::DrawIndexed(objectIndexCount, sizeof(LeviathanRenderer::VertexTypes::VertexPos3Norm3UV2Tang3), objectVertexBufferResourceId, objectIndexBufferResourceId);
+			// Only draw batches with an instance inside the light's influence volume.
+			const uint32_t* const litBatches = gLightInfluence.GetLightBatches(i);
+			for (size_t litBatch = 0; litBatch < litBatchCount; ++litBatch)
+			{
+				recordObjectLightingDraw(RenderCommands::Pipeline::PointLight, litBatches[litBatch]);
+			}
 		}
 
 		// Spot light pass.
-		Renderer::SetSpotLightPipeline();
+		commands.BeginPacket(MakePassSortKey(RenderPass::SpotLight));
 		for (size_t i = 0; i < numSpotLights; ++i)
 		{
+			const size_t light = numPointLights + i;
+			const size_t litBatchCount = gLightInfluence.GetLightBatchCount(light);
+			if (litBatchCount == 0)
+			{
+				continue;
+			}
+
 			// Update spot light data.
 			LeviathanRenderer::ConstantBufferTypes::SpotLightConstantBuffer spotLightData = {};
 
@@ -377,83 +1244,110 @@ namespace LeviathanRenderer
 			memcpy(&spotLightData.Radiance, spotLightRadiance.Data(), sizeof(float) * 3);
 			memcpy(&spotLightData.LightPositionViewSpace, spotLightPositionViewSpace.Data(), sizeof(float) * 3);
 			memcpy(&spotLightData.LightDirectionViewSpace, spotLightDirectionViewSpace.Data(), sizeof(float) * 3);
+			spotLightData.Radius = LightTypes::GetInfluenceRadius(pSceneSpotLights[i]);
 			spotLightData.CosineInnerConeAngle = LeviathanCore::MathLibrary::Cos(pSceneSpotLights[i].InnerConeAngleRadians);
 			spotLightData.CosineOuterConeAngle = LeviathanCore::MathLibrary::Cos(pSceneSpotLights[i].OuterConeAngleRadians);
 
-			Renderer::UpdateSpotLightBufferData(0, static_cast<const void*>(&spotLightData), sizeof(LeviathanRenderer::ConstantBufferTypes::SpotLightConstantBuffer));
-
-			// TODO: For each object affected by light, daw.
-			// TODO: Material properties for object.
-			// Update shader resource table data.
-			Renderer::SetColorTexture2DResource(colorTextureResourceId);
-			Renderer::SetMetallicTexture2DResource(metallicTextureResourceId);
-			Renderer::SetRoughnessTexture2DResource(roughnessTextureResourceId);
-			Renderer::SetNormalTexture2DResource(normalTextureResourceId);
-
-			Renderer::SetColorTextureSampler(samplerResourceId);
-			Renderer::SetRoughnessTextureSampler(samplerResourceId);
-			Renderer::SetMetallicTextureSampler(samplerResourceId);
-			Renderer::SetNormalTextureSampler(samplerResourceId);
-
-			const LeviathanCore::MathTypes::Matrix4x4 worldMatrix = objectTransformMatrix;
-			const LeviathanCore::MathTypes::Matrix4x4 worldViewMatrix = sceneView.GetViewMatrix() * worldMatrix;
-			const LeviathanCore::MathTypes::Matrix4x4 normalMatrix = LeviathanCore::MathTypes::Matrix4x4::Transpose(LeviathanCore::MathTypes::Matrix4x4::Inverse(worldViewMatrix));
-			const LeviathanCore::MathTypes::Matrix4x4 worldViewProjectionMatrix = sceneView.GetViewProjectionMatrix() * worldMatrix;
-
-			// Update object data.
-			LeviathanRenderer::ConstantBufferTypes::ObjectConstantBuffer objectData = {};
-			memcpy(objectData.WorldViewMatrix, worldViewMatrix.Data(), sizeof(float) * 16);
-			memcpy(objectData.WorldViewProjectionMatrix, worldViewProjectionMatrix.Data(), sizeof(float) * 16);
-			memcpy(objectData.NormalMatrix, worldViewMatrix.Data(), sizeof(float) * 16);
-			Renderer::UpdateObjectBufferData(0, &objectData, sizeof(LeviathanRenderer::ConstantBufferTypes::ObjectConstantBuffer));
+			if (!recordConstantData(RenderCommands::ConstantBuffer::SpotLight, &spotLightData, sizeof(LeviathanRenderer::ConstantBufferTypes::SpotLightConstantBuffer)))
+			{
+				continue;
+			}
 
-			// Draw.
-			Renderer::DrawIndexed(objectIndexCount, sizeof(LeviathanRenderer::VertexTypes::VertexPos3Norm3UV2Tang3), objectVertexBufferResourceId, objectIndexBufferResourceId);
+			// Only draw batches with an instance inside the light's influence volume.
+			const uint32_t* const litBatches = gLightInfluence.GetLightBatches(light);
+			for (size_t litBatch = 0; litBatch < litBatchCount; ++litBatch)
+			{
+				recordObjectLightingDraw(RenderCommands::Pipeline::SpotLight, litBatches[litBatch]);
+			}
 		}
 
+		// Draw skybox.
+		commands.BeginPacket(MakePassSortKey(RenderPass::Skybox));
+
 		// Disable blending.
-		Renderer::SetBlendStateBlendDisabled();
+		commands.SetBlendState(RenderCommands::BlendState::Disabled);
 
 		// Disable depth writes with less than depth tests.
-		Renderer::SetDepthStencilStateWriteDepthDepthFuncLessEqualStencilDisabled();
+		commands.SetDepthStencilState(RenderCommands::DepthStencilState::WriteDepthDepthFuncLessEqual);
 
-		// Draw skybox.
 		// Set skybox pipeline.
-		Renderer::SetSkyboxPipeline(skyboxTextureCubeResourceId, skyboxTextureCubeSamplerId);
+		commands.SetSkyboxPipeline(skyboxTextureCubeResourceId, skyboxTextureCubeSamplerId);
 
 		// Update constant buffer data.
 		LeviathanRenderer::ConstantBufferTypes::SkyboxConstantBuffer skyboxBufferData = {};
 		memcpy(skyboxBufferData.ViewProjectionMatrix, skyboxView.GetViewProjectionMatrix().Data(), sizeof(float) * 16);
-		if (!Renderer::UpdateSkyboxBufferData(0, static_cast<const void*>(&skyboxBufferData), sizeof(LeviathanRenderer::ConstantBufferTypes::SkyboxConstantBuffer)))
+		if (recordConstantData(RenderCommands::ConstantBuffer::Skybox, &skyboxBufferData, sizeof(LeviathanRenderer::ConstantBufferTypes::SkyboxConstantBuffer)))
 		{
-			LEVIATHAN_LOG("Failed to update skybox buffer data during render.");
+			// Draw large cube with front facing faces facing inwards at world origin.
+			commands.DrawIndexed(36, sizeof(LeviathanRenderer::VertexTypes::VertexPos3), skyboxVertexBufferId, skyboxIndexBufferId);
 		}
 
-		// Draw large cube with front facing faces facing inwards at world origin.
-		Renderer::DrawIndexed(36, sizeof(LeviathanRenderer::VertexTypes::VertexPos3), skyboxVertexBufferId, skyboxIndexBufferId);
+		// Begin post processing.
+		commands.BeginPacket(MakePassSortKey(RenderPass::PostProcess));
 
 		// Disable blending.
-		Renderer::SetBlendStateBlendDisabled();
+		commands.SetBlendState(RenderCommands::BlendState::Disabled);
 
 		// Disable depth testing.
-		Renderer::SetDepthStencilStateDepthStencilDisabled();
+		commands.SetDepthStencilState(RenderCommands::DepthStencilState::Disabled);
 
-		// Begin post processing.
 		// Set screen render target.
-		Renderer::SetScreenRenderTarget();
+		commands.SetRenderTarget(RenderCommands::RenderTarget::Screen);
 
 		// Post process pass.
-		Renderer::SetPostProcessPipeline();
-		Renderer::DrawIndexed(gScreenQuadIndexCount, sizeof(VertexTypes::VertexPos2UV2), gScreenQuadVertexBufferResourceId, gScreenQuadIndexBufferResourceId);
+		commands.SetPipeline(RenderCommands::Pipeline::PostProcess);
+		commands.DrawIndexed(gScreenQuadIndexCount, sizeof(VertexTypes::VertexPos2UV2), gScreenQuadVertexBufferResourceId, gScreenQuadIndexBufferResourceId);
 
 		// Unbind shader resources.
-		Renderer::UnbindShaderResources();
+		commands.UnbindShaderResources();
+
+		// The frame's constant data is written. The buffer must be unmapped before drawing.
+		if (constantUploadData != nullptr)
+		{
+			Renderer::UnmapConstantUploadBuffer();
+		}
 
-		// End frame.
+		// Upload the frame's instance stream once. Every lighting pass reads it.
+		if (!Renderer::UpdateInstanceBufferData(gInstanceBatches.InstanceData.data(),
+			gInstanceBatches.GetInstanceCount() * sizeof(LeviathanRenderer::ConstantBufferTypes::ObjectConstantBuffer)))
+		{
+			LEVIATHAN_LOG("Failed to update instance buffer data during render.");
+		}
+
+		// Execute the frame's commands with the renderer api. Redundant state changes, e.g. rebinding a batch's material for every light, are filtered
+		// out. Renderer api state set outside of Render is unknown so filtering starts fresh every frame.
+		gRenderCommands.Sort();
+		RendererApiBackend backend = {};
+		RenderCommands::StateFilteringBackend<RendererApiBackend> filteringBackend(backend);
+		gRenderCommands.Execute(filteringBackend);
+		gStateFilterStats = filteringBackend.GetStats();
+
+		// End frame. The frame's constant data ranges are reused once the gpu signals the frame's fence.
+		gConstantUploadRing.EndFrame(++gFrameFence);
+		Renderer::SignalFrameFence(gFrameFence);
+
+		// Reclaim the memory of resources the frame did not use if a budget is exceeded and start the next frame's memory stats.
+		RendererGpuMemoryBackend gpuMemoryBackend = {};
+		gGpuMemory.EndFrame(gpuMemoryBackend);
 	}
 
 	void Present()
 	{
 		Renderer::Present();
 	}
+
+	const RenderCommands::StateFilterStats& GetStateFilterStats()
+	{
+		return gStateFilterStats;
+	}
+
+	const LightInfluenceStats& GetLightInfluenceStats()
+	{
+		return gLightInfluence.GetStats();
+	}
+
+	const OcclusionCullingStats& GetOcclusionCullingStats()
+	{
+		return gOcclusionCullingStage.GetStats();
+	}
 }
@@ -2,9 +2,17 @@
 
 // Standard library.
 #include <string>
+#include <vector>
 #include <cassert>
 #include <array>
 #include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <mutex>
+#include <atomic>
+#include <thread>
 
 #ifdef LEVIATHAN_BUILD_PLATFORM_WIN32
 // Windows.
@@ -24,6 +32,7 @@
 #ifdef LEVIATHAN_BUILD_RENDERER_API_DIRECT3D11_PC
 // Direct3D11 PC.
 #include <d3d11.h>
+#include <d3d11_1.h>
 #include <dxgi1_6.h>
 #include <wrl.h>
 #include <d3dcompiler.h>
@@ -0,0 +1,134 @@
+#include "LightInfluence.h"
+#include "RenderWorld.h"
+#include "InstanceBatching.h"
+#include "JobSystem.h"
+
+namespace LeviathanRenderer
+{
+	// Number of objects whose world bounds are gathered per job.
+	static constexpr size_t ObjectBoundsChunkSize = 4096;
+
+	LeviathanCore::BoundingVolumes::Sphere GetInfluenceSphere(const LightTypes::PointLight& light)
+	{
+		return LeviathanCore::BoundingVolumes::Sphere{ light.Position, LightTypes::GetInfluenceRadius(light) };
+	}
+
+	LeviathanCore::BoundingVolumes::Sphere GetInfluenceSphere(const LightTypes::SpotLight& light)
+	{
+		return LeviathanCore::BoundingVolumes::Sphere{ light.Position, LightTypes::GetInfluenceRadius(light) };
+	}
+
+	LeviathanCore::BoundingVolumes::Cone GetInfluenceCone(const LightTypes::SpotLight& light)
+	{
+		return LeviathanCore::BoundingVolumes::Cone{ light.Position, light.Direction.AsNormalizedSafe(), light.OuterConeAngleRadians,
+			LightTypes::GetInfluenceRadius(light) };
+	}
+
+	void LightInfluenceCulling::Build(const RenderWorld& world, const DrawList& drawList, const InstanceBatchList& batches, const LightTypes::PointLight* const pointLights,
+		const size_t pointLightCount, const LightTypes::SpotLight* const spotLights, const size_t spotLightCount)
+	{
+		const size_t drawCount = drawList.GetCount();
+		const size_t batchCount = batches.GetBatchCount();
+		LightCount = pointLightCount + spotLightCount;
+		if (LightDraws.size() < LightCount)
+		{
+			LightDraws.resize(LightCount);
+			LightBatches.resize(LightCount);
+		}
+
+		const size_t threadCount = LeviathanCore::JobSystem::GetThreadCount();
+		if (Scratch.size() < threadCount)
+		{
+			Scratch.resize(threadCount);
+		}
+		for (ThreadScratch& scratch : Scratch)
+		{
+			if (scratch.Results.size() < drawCount)
+			{
+				scratch.Results.resize(drawCount);
+				scratch.Draws.resize(drawCount);
+			}
+			scratch.BatchMarks.assign(std::max(batchCount, scratch.BatchMarks.size()), 0);
+		}
+
+		// World bounds of the objects in draw order.
+		ObjectBounds.Resize(drawCount);
+		const LeviathanCore::BoundingVolumes::AABBSoA worldBounds = world.GetWorldBounds();
+		LeviathanCore::JobSystem::ParallelFor(drawCount, ObjectBoundsChunkSize,
+			[this, &drawList, &worldBounds](const size_t first, const size_t count, [[maybe_unused]] const size_t threadIndex)
+			{
+				for (size_t draw = first; draw < first + count; ++draw)
+				{
+					const uint32_t renderable = drawList.Renderables[draw];
+					ObjectBounds.Set(draw, LeviathanCore::BoundingVolumes::AABB{
+						LeviathanCore::MathTypes::Vector3(worldBounds.MinX[renderable], worldBounds.MinY[renderable], worldBounds.MinZ[renderable]),
+						LeviathanCore::MathTypes::Vector3(worldBounds.MaxX[renderable], worldBounds.MaxY[renderable], worldBounds.MaxZ[renderable]) });
+				}
+			});
+
+		// Objects and batches lit by each light.
+		const LeviathanCore::BoundingVolumes::AABBSoA objectBounds = ObjectBounds.View();
+		LeviathanCore::JobSystem::ParallelFor(LightCount, LightsPerJob,
+			[this, &batches, drawCount, &objectBounds, pointLights, pointLightCount, spotLights](const size_t first, const size_t count, const size_t threadIndex)
+			{
+				ThreadScratch& scratch = Scratch[threadIndex];
+				for (size_t light = first; light < first + count; ++light)
+				{
+					if (light < pointLightCount)
+					{
+						LeviathanCore::BoundingVolumes::TestSphereAABBs(GetInfluenceSphere(pointLights[light]), objectBounds, 0, drawCount, scratch.Results.data());
+					}
+					else
+					{
+						const LightTypes::SpotLight& spotLight = spotLights[light - pointLightCount];
+						if (spotLight.OuterConeAngleRadians < LeviathanCore::MathLibrary::HalfPi)
+						{
+							LeviathanCore::BoundingVolumes::TestConeAABBs(GetInfluenceCone(spotLight), objectBounds, 0, drawCount, scratch.Results.data());
+						}
+						else
+						{
+							LeviathanCore::BoundingVolumes::TestSphereAABBs(GetInfluenceSphere(spotLight), objectBounds, 0, drawCount, scratch.Results.data());
+						}
+					}
+
+					// Branchless compaction. The index of an unlit object is overwritten by the next object.
+					size_t litCount = 0;
+					for (size_t draw = 0; draw < drawCount; ++draw)
+					{
+						scratch.Draws[litCount] = static_cast<uint32_t>(draw);
+						litCount += scratch.Results[draw];
+					}
+					std::vector<uint32_t>& lightDraws = LightDraws[light];
+					lightDraws.assign(scratch.Draws.begin(), scratch.Draws.begin() + litCount);
+
+					// Batches with at least one lit instance.
+					std::vector<uint32_t>& lightBatches = LightBatches[light];
+					lightBatches.clear();
+					const uint32_t mark = static_cast<uint32_t>(light) + 1;
+					for (const uint32_t draw : lightDraws)
+					{
+						const uint32_t batch = batches.ScratchDrawBatches[draw];
+						if (scratch.BatchMarks[batch] != mark)
+						{
+							scratch.BatchMarks[batch] = mark;
+							lightBatches.push_back(batch);
+						}
+					}
+					std::sort(lightBatches.begin(), lightBatches.end());
+				}
+			});
+
+		size_t litPairCount = 0;
+		size_t batchDrawCount = 0;
+		for (size_t light = 0; light < LightCount; ++light)
+		{
+			litPairCount += LightDraws[light].size();
+			batchDrawCount += LightBatches[light].size();
+		}
+
+		Stats.TestedPairs = static_cast<uint64_t>(LightCount) * drawCount;
+		Stats.CulledPairs = Stats.TestedPairs - litPairCount;
+		Stats.BatchPairs = static_cast<uint64_t>(LightCount) * batchCount;
+		Stats.SkippedDraws = Stats.BatchPairs - batchDrawCount;
+	}
+}
@@ -0,0 +1,572 @@
+#include "OcclusionCulling.h"
+#include "Camera.h"
+#include "JobSystem.h"
+#include "Simd.h"
+#include "LeviathanAssert.h"
+
+namespace LeviathanRenderer
+{
+	// Clip space position of an occluder vertex. The clip space z is not needed as the depth buffer holds inverse view depth, the reciprocal of w.
+	struct ClipVertex
+	{
+		float X = 0.0f;
+		float Y = 0.0f;
+		float W = 0.0f;
+	};
+
+	bool OcclusionCullingStage::Initialize(const uint32_t width, const uint32_t height)
+	{
+		if ((width == 0) || (height == 0) || ((width % TileSize) != 0) || ((height % TileSize) != 0))
+		{
+			return false;
+		}
+
+		Width = width;
+		Height = height;
+		return true;
+	}
+
+	OccluderId OcclusionCullingStage::CreateOccluder(const OccluderDescription& description)
+	{
+		OccluderId occluder = InvalidOccluderId;
+		if (!FreeOccluderIds.empty())
+		{
+			occluder = FreeOccluderIds.back();
+			FreeOccluderIds.pop_back();
+		}
+		else
+		{
+			occluder = static_cast<OccluderId>(Occluders.size());
+			Occluders.emplace_back();
+		}
+
+		Occluder& data = Occluders[occluder];
+		data.Positions = description.Positions;
+		data.Indices = description.Indices;
+		data.Transform = description.Transform;
+		data.DoubleSided = description.DoubleSided;
+		data.Valid = true;
+		return occluder;
+	}
+
+	void OcclusionCullingStage::DestroyOccluder(const OccluderId occluder)
+	{
+		LEVIATHAN_ASSERT(IsValid(occluder));
+		Occluder& data = Occluders[occluder];
+		data.Positions.clear();
+		data.Indices.clear();
+		data.Valid = false;
+		FreeOccluderIds.push_back(occluder);
+	}
+
+	void OcclusionCullingStage::SetOccluderTransform(const OccluderId occluder, const LeviathanCore::MathTypes::Matrix4x4& transform)
+	{
+		LEVIATHAN_ASSERT(IsValid(occluder));
+		Occluders[occluder].Transform = transform;
+	}
+
+	void OcclusionCullingStage::ClearOccluders()
+	{
+		Occluders.clear();
+		FreeOccluderIds.clear();
+	}
+
+	void OcclusionCullingStage::SetupTriangle(const Occluder& occluder, const LeviathanCore::MathTypes::Matrix4x4& clipMatrix, const size_t triangle,
+		ThreadScratch& scratch) const
+	{
+		// Column major clip matrix. Rows 0, 1 and 3 give the clip space x, y and w.
+		const float* const m = clipMatrix.Data();
+		std::array<ClipVertex, 3> vertices = {};
+		for (size_t i = 0; i < 3; ++i)
+		{
+			const LeviathanCore::MathTypes::Vector3& position = occluder.Positions[occluder.Indices[(triangle * 3) + i]];
+			vertices[i].X = m[0] * position.X() + m[4] * position.Y() + m[8] * position.Z() + m[12];
+			vertices[i].Y = m[1] * position.X() + m[5] * position.Y() + m[9] * position.Z() + m[13];
+			vertices[i].W = m[3] * position.X() + m[7] * position.Y() + m[11] * position.Z() + m[15];
+		}
+
+		// Clip against the near plane w = NearZ. A triangle crossing it becomes a triangle or a quad.
+		std::array<ClipVertex, 4> polygon = {};
+		size_t polygonCount = 0;
+		for (size_t i = 0; i < 3; ++i)
+		{
+			const ClipVertex& current = vertices[i];
+			const ClipVertex& next = vertices[(i + 1) % 3];
+			const bool currentInside = current.W >= NearZ;
+			const bool nextInside = next.W >= NearZ;
+			if (currentInside)
+			{
+				polygon[polygonCount++] = current;
+			}
+			if (currentInside != nextInside)
+			{
+				const float t = (NearZ - current.W) / (next.W - current.W);
+				polygon[polygonCount++] = ClipVertex{ current.X + (next.X - current.X) * t, current.Y + (next.Y - current.Y) * t, NearZ };
+			}
+		}
+		if (polygonCount < 3)
+		{
+			return;
+		}
+
+		// Pixel coordinates and inverse view depth.
+		std::array<float, 4> screenX = {};
+		std::array<float, 4> screenY = {};
+		std::array<float, 4> depth = {};
+		for (size_t i = 0; i < polygonCount; ++i)
+		{
+			depth[i] = 1.0f / polygon[i].W;
+			screenX[i] = (polygon[i].X * depth[i] * 0.5f + 0.5f) * static_cast<float>(Width);
+			screenY[i] = (0.5f - polygon[i].Y * depth[i] * 0.5f) * static_cast<float>(Height);
+		}
+
+		const uint32_t binCountX = GetBinCountX();
+		for (size_t fan = 1; fan + 1 < polygonCount; ++fan)
+		{
+			const std::array<size_t, 3> corners = { 0, fan, fan + 1 };
+
+			// Pixels whose centers can be covered. Clamped in float first as clipped vertices close to the near plane can be far off screen.
+			float minX = screenX[corners[0]];
+			float minY = screenY[corners[0]];
+			float maxX = minX;
+			float maxY = minY;
+			for (size_t i = 1; i < 3; ++i)
+			{
+				minX = std::min(minX, screenX[corners[i]]);
+				minY = std::min(minY, screenY[corners[i]]);
+				maxX = std::max(maxX, screenX[corners[i]]);
+				maxY = std::max(maxY, screenY[corners[i]]);
+			}
+			const int32_t pixelMinX = static_cast<int32_t>(std::ceil(std::clamp(minX - 0.5f, -1.0f, static_cast<float>(Width))));
+			const int32_t pixelMinY = static_cast<int32_t>(std::ceil(std::clamp(minY - 0.5f, -1.0f, static_cast<float>(Height))));
+			const int32_t pixelMaxX = static_cast<int32_t>(std::floor(std::clamp(maxX - 0.5f, -1.0f, static_cast<float>(Width))));
+			const int32_t pixelMaxY = static_cast<int32_t>(std::floor(std::clamp(maxY - 0.5f, -1.0f, static_cast<float>(Height))));
+
+			TriangleSetup setup = {};
+			setup.MinX = std::max(pixelMinX, 0);
+			setup.MinY = std::max(pixelMinY, 0);
+			setup.MaxX = std::min(pixelMaxX, static_cast<int32_t>(Width) - 1);
+			setup.MaxY = std::min(pixelMaxY, static_cast<int32_t>(Height) - 1);
+			if ((setup.MinX > setup.MaxX) || (setup.MinY > setup.MaxY))
+			{
+				continue;
+			}
+
+			// Edge functions and the depth plane are set up in double precision as clipped vertices can have large pixel coordinates.
+			const std::array<double, 3> x = { screenX[corners[0]], screenX[corners[1]], screenX[corners[2]] };
+			const std::array<double, 3> y = { screenY[corners[0]], screenY[corners[1]], screenY[corners[2]] };
+			const std::array<double, 3> z = { depth[corners[0]], depth[corners[1]], depth[corners[2]] };
+			// Positive for clockwise triangles on screen, the front faces.
+			const double area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+			if ((area == 0.0) || ((area < 0.0) && !occluder.DoubleSided))
+			{
+				continue;
+			}
+
+			// Edges of back faces of double sided occluders are flipped so that the inside of the triangle is positive.
+			const double orientation = (area > 0.0) ? 1.0 : -1.0;
+			for (size_t edge = 0; edge < 3; ++edge)
+			{
+				const size_t i = edge;
+				const size_t j = (edge + 1) % 3;
+				setup.EdgeA[edge] = static_cast<float>(orientation * (y[i] - y[j]));
+				setup.EdgeB[edge] = static_cast<float>(orientation * (x[j] - x[i]));
+				setup.EdgeC[edge] = static_cast<float>(orientation * (x[i] * y[j] - x[j] * y[i]));
+			}
+
+			const double depthA = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) / area;
+			const double depthB = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) / area;
+			const double depthC = z[0] - depthA * x[0] - depthB * y[0];
+			setup.DepthA = static_cast<float>(depthA);
+			setup.DepthB = static_cast<float>(depthB);
+			setup.DepthC = static_cast<float>(depthC - 0.5 * (std::fabs(depthA) + std::fabs(depthB)));
+			setup.DepthMin = static_cast<float>(std::min({ z[0], z[1], z[2] }));
+			setup.DepthMax = static_cast<float>(std::max({ z[0], z[1], z[2] }));
+
+			const uint32_t index = static_cast<uint32_t>(scratch.Triangles.size());
+			scratch.Triangles.push_back(setup);
+			for (int32_t binY = setup.MinY / static_cast<int32_t>(BinHeight); binY <= setup.MaxY / static_cast<int32_t>(BinHeight); ++binY)
+			{
+				for (int32_t binX = setup.MinX / static_cast<int32_t>(BinWidth); binX <= setup.MaxX / static_cast<int32_t>(BinWidth); ++binX)
+				{
+					scratch.BinTriangles[(static_cast<size_t>(binY) * binCountX) + binX].push_back(index);
+				}
+			}
+		}
+	}
+
+	void OcclusionCullingStage::RasterizeBin(const uint32_t binX, const uint32_t binY, ThreadScratch& scratch)
+	{
+		const int32_t binMinX = static_cast<int32_t>(binX * BinWidth);
+		const int32_t binMinY = static_cast<int32_t>(binY * BinHeight);
+		const int32_t binMaxX = static_cast<int32_t>(std::min((binX + 1) * BinWidth, Width)) - 1;
+		const int32_t binMaxY = static_cast<int32_t>(std::min((binY + 1) * BinHeight, Height)) - 1;
+		for (int32_t y = binMinY; y <= binMaxY; ++y)
+		{
+			float* const row = DepthBuffer.data() + (static_cast<size_t>(y) * Width);
+			std::fill(row + binMinX, row + binMaxX + 1, 0.0f);
+		}
+
+		// Nearest triangles first so that farther triangles find their pixels covered.
+		const size_t bin = (static_cast<size_t>(binY) * GetBinCountX()) + binX;
+		scratch.SortedTriangles.clear();
+		for (const ThreadScratch& setupScratch : Scratch)
+		{
+			for (const uint32_t index : setupScratch.BinTriangles[bin])
+			{
+				scratch.SortedTriangles.push_back(&setupScratch.Triangles[index]);
+			}
+		}
+		std::sort(scratch.SortedTriangles.begin(), scratch.SortedTriangles.end(), [](const TriangleSetup* const a, const TriangleSetup* const b)
+			{
+				return a->DepthMax > b->DepthMax;
+			});
+
+		for (const TriangleSetup* const sortedTriangle : scratch.SortedTriangles)
+		{
+			const TriangleSetup& triangle = *sortedTriangle;
+
+			const int32_t minY = std::max(triangle.MinY, binMinY);
+			const int32_t maxY = std::min(triangle.MaxY, binMaxY);
+			for (int32_t y = minY; y <= maxY; ++y)
+			{
+				float* const row = DepthBuffer.data() + (static_cast<size_t>(y) * Width);
+				const float pixelY = static_cast<float>(y) + 0.5f;
+				const float rowEdge0 = triangle.EdgeB[0] * pixelY + triangle.EdgeC[0];
+				const float rowEdge1 = triangle.EdgeB[1] * pixelY + triangle.EdgeC[1];
+				const float rowEdge2 = triangle.EdgeB[2] * pixelY + triangle.EdgeC[2];
+				const float rowDepth = triangle.DepthB * pixelY + triangle.DepthC;
+
+				// Span of the row inside all three edges, widened by a pixel on both sides as coverage is still tested per pixel. Spans start at a
+				// multiple of four pixels. Bins are multiples of four pixels wide so groups of four never leave the bin.
+				float spanMinX = static_cast<float>(std::max(triangle.MinX, binMinX));
+				float spanMaxX = static_cast<float>(std::min(triangle.MaxX, binMaxX));
+				const std::array<float, 3> rowEdges = { rowEdge0, rowEdge1, rowEdge2 };
+				for (size_t edge = 0; edge < 3; ++edge)
+				{
+					const float a = triangle.EdgeA[edge];
+					if (a > 0.0f)
+					{
+						spanMinX = std::max(spanMinX, (-rowEdges[edge] / a) - 1.5f);
+					}
+					else if (a < 0.0f)
+					{
+						spanMaxX = std::min(spanMaxX, (-rowEdges[edge] / a) + 0.5f);
+					}
+					else if (rowEdges[edge] < 0.0f)
+					{
+						spanMaxX = -1.0f;
+					}
+				}
+				if (spanMinX > spanMaxX)
+				{
+					continue;
+				}
+				const int32_t maxX = static_cast<int32_t>(spanMaxX);
+				int32_t x = static_cast<int32_t>(spanMinX) & ~3;
+#ifdef LEVIATHAN_SIMD_SSE
+				const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+				const __m128 zero = _mm_setzero_ps();
+				const __m128 nearest = _mm_set1_ps(triangle.DepthMax);
+				for (; x <= maxX; x += 4)
+				{
+					const __m128 stored = _mm_loadu_ps(row + x);
+					if (_mm_movemask_ps(_mm_cmplt_ps(stored, nearest)) == 0)
+					{
+						continue;
+					}
+
+					const __m128 pixelX = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneOffsets);
+					const __m128 edge0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(triangle.EdgeA[0]), pixelX), _mm_set1_ps(rowEdge0));
+					const __m128 edge1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(triangle.EdgeA[1]), pixelX), _mm_set1_ps(rowEdge1));
+					const __m128 edge2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(triangle.EdgeA[2]), pixelX), _mm_set1_ps(rowEdge2));
+					const __m128 covered = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(edge0, zero), _mm_cmpge_ps(edge1, zero)), _mm_cmpge_ps(edge2, zero));
+					const __m128 depth = _mm_max_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(triangle.DepthA), pixelX), _mm_set1_ps(rowDepth)), _mm_set1_ps(triangle.DepthMin));
+					_mm_storeu_ps(row + x, _mm_max_ps(stored, _mm_and_ps(covered, depth)));
+				}
+#endif // LEVIATHAN_SIMD_SSE.
+				for (; x <= maxX; ++x)
+				{
+					const float pixelX = static_cast<float>(x) + 0.5f;
+					const bool covered = ((triangle.EdgeA[0] * pixelX + rowEdge0) >= 0.0f) && ((triangle.EdgeA[1] * pixelX + rowEdge1) >= 0.0f) &&
+						((triangle.EdgeA[2] * pixelX + rowEdge2) >= 0.0f);
+					const float depth = std::max(triangle.DepthA * pixelX + rowDepth, triangle.DepthMin);
+					row[x] = std::max(row[x], covered ? depth : 0.0f);
+				}
+			}
+		}
+
+		// Farthest depth of the bin's tiles.
+		const uint32_t tileCountX = GetTileCountX();
+		for (int32_t tileY = binMinY / static_cast<int32_t>(TileSize); tileY <= binMaxY / static_cast<int32_t>(TileSize); ++tileY)
+		{
+			for (int32_t tileX = binMinX / static_cast<int32_t>(TileSize); tileX <= binMaxX / static_cast<int32_t>(TileSize); ++tileX)
+			{
+				float tileDepth = std::numeric_limits<float>::max();
+				for (uint32_t y = 0; y < TileSize; ++y)
+				{
+					const float* const row = DepthBuffer.data() + ((static_cast<size_t>(tileY) * TileSize + y) * Width) + (static_cast<size_t>(tileX) * TileSize);
+					tileDepth = std::min(tileDepth, *std::min_element(row, row + TileSize));
+				}
+				TileDepths[(static_cast<size_t>(tileY) * tileCountX) + tileX] = tileDepth;
+			}
+		}
+	}
+
+	void OcclusionCullingStage::RenderOccluders(const Camera& view)
+	{
+		ViewProjectionMatrix = view.GetViewProjectionMatrix();
+		NearZ = view.GetNearZ();
+		DepthBuffer.resize(static_cast<size_t>(Width) * Height);
+		TileDepths.resize(static_cast<size_t>(GetTileCountX()) * GetTileCountY());
+
+		const size_t binCount = static_cast<size_t>(GetBinCountX()) * GetBinCountY();
+		const size_t threadCount = LeviathanCore::JobSystem::GetThreadCount();
+		if (Scratch.size() < threadCount)
+		{
+			Scratch.resize(threadCount);
+		}
+		for (ThreadScratch& scratch : Scratch)
+		{
+			scratch.Triangles.clear();
+			scratch.BinTriangles.resize(binCount);
+			for (std::vector<uint32_t>& binTriangles : scratch.BinTriangles)
+			{
+				binTriangles.clear();
+			}
+		}
+
+		// Triangle range of every occluder.
+		OccluderClipMatrices.resize(Occluders.size());
+		OccluderTriangleOffsets.resize(Occluders.size() + 1);
+		size_t triangleCount = 0;
+		for (size_t occluder = 0; occluder < Occluders.size(); ++occluder)
+		{
+			OccluderTriangleOffsets[occluder] = triangleCount;
+			if (Occluders[occluder].Valid)
+			{
+				OccluderClipMatrices[occluder] = ViewProjectionMatrix * Occluders[occluder].Transform;
+				triangleCount += Occluders[occluder].Indices.size() / 3;
+			}
+		}
+		OccluderTriangleOffsets[Occluders.size()] = triangleCount;
+
+		// Clip, set up and bin the triangles.
+		LeviathanCore::JobSystem::ParallelFor(triangleCount, TrianglesPerJob, [this](const size_t first, const size_t count, const size_t threadIndex)
+			{
+				// Last occluder starting at or before the first triangle. Occluders without triangles share their offset with the next occluder.
+				size_t occluder = static_cast<size_t>(std::upper_bound(OccluderTriangleOffsets.begin(), OccluderTriangleOffsets.end(), first) - OccluderTriangleOffsets.begin()) - 1;
+				for (size_t triangle = first; triangle < first + count; ++triangle)
+				{
+					while (triangle >= OccluderTriangleOffsets[occluder + 1])
+					{
+						++occluder;
+					}
+					SetupTriangle(Occluders[occluder], OccluderClipMatrices[occluder], triangle - OccluderTriangleOffsets[occluder], Scratch[threadIndex]);
+				}
+			});
+
+		// Rasterize the bins. Every bin owns its pixels and tiles.
+		const uint32_t binCountX = GetBinCountX();
+		LeviathanCore::JobSystem::ParallelFor(binCount, 1, [this, binCountX](const size_t first, const size_t count, const size_t threadIndex)
+			{
+				for (size_t bin = first; bin < first + count; ++bin)
+				{
+					RasterizeBin(static_cast<uint32_t>(bin % binCountX), static_cast<uint32_t>(bin / binCountX), Scratch[threadIndex]);
+				}
+			});
+
+		Stats = {};
+		Stats.OccluderTriangles = triangleCount;
+		for (const ThreadScratch& scratch : Scratch)
+		{
+			Stats.RasterizedTriangles += scratch.Triangles.size();
+		}
+	}
+
+	bool OcclusionCullingStage::IsOccluded(const LeviathanCore::BoundingVolumes::AABB& bounds) const
+	{
+		if (Stats.RasterizedTriangles == 0)
+		{
+			return false;
+		}
+
+		// Projected bounds and nearest inverse view depth of the box corners.
+		const float* const m = ViewProjectionMatrix.Data();
+		float minX = std::numeric_limits<float>::max();
+		float minY = std::numeric_limits<float>::max();
+		float maxX = std::numeric_limits<float>::lowest();
+		float maxY = std::numeric_limits<float>::lowest();
+		float nearestDepth = 0.0f;
+		uint32_t corner = 0;
+#ifdef LEVIATHAN_SIMD_SSE
+		// Corners 0 to 3 and 4 to 7 differ only in z.
+		{
+			const __m128 cornerX = _mm_setr_ps(bounds.Min.X(), bounds.Max.X(), bounds.Min.X(), bounds.Max.X());
+			const __m128 cornerY = _mm_setr_ps(bounds.Min.Y(), bounds.Min.Y(), bounds.Max.Y(), bounds.Max.Y());
+			const __m128 clipX = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[0]), cornerX), _mm_mul_ps(_mm_set1_ps(m[4]), cornerY));
+			const __m128 clipY = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[1]), cornerX), _mm_mul_ps(_mm_set1_ps(m[5]), cornerY));
+			const __m128 clipW = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[3]), cornerX), _mm_mul_ps(_mm_set1_ps(m[7]), cornerY));
+			__m128 boundsMinX = _mm_set1_ps(minX);
+			__m128 boundsMinY = _mm_set1_ps(minY);
+			__m128 boundsMaxX = _mm_set1_ps(maxX);
+			__m128 boundsMaxY = _mm_set1_ps(maxY);
+			__m128 nearest = _mm_setzero_ps();
+			for (const float cornerZ : { bounds.Min.Z(), bounds.Max.Z() })
+			{
+				const __m128 z = _mm_set1_ps(cornerZ);
+				const __m128 w = _mm_add_ps(_mm_add_ps(clipW, _mm_mul_ps(_mm_set1_ps(m[11]), z)), _mm_set1_ps(m[15]));
+				if (_mm_movemask_ps(_mm_cmplt_ps(w, _mm_set1_ps(NearZ))) != 0)
+				{
+					return false;
+				}
+
+				const __m128 depth = _mm_div_ps(_mm_set1_ps(1.0f), w);
+				const __m128 screenX = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(_mm_add_ps(_mm_add_ps(clipX, _mm_mul_ps(_mm_set1_ps(m[8]), z)),
+					_mm_set1_ps(m[12])), depth), _mm_set1_ps(0.5f)), _mm_set1_ps(0.5f)), _mm_set1_ps(static_cast<float>(Width)));
+				const __m128 screenY = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(0.5f), _mm_mul_ps(_mm_mul_ps(_mm_add_ps(_mm_add_ps(clipY, _mm_mul_ps(_mm_set1_ps(m[9]), z)),
+					_mm_set1_ps(m[13])), depth), _mm_set1_ps(0.5f))), _mm_set1_ps(static_cast<float>(Height)));
+				boundsMinX = _mm_min_ps(boundsMinX, screenX);
+				boundsMinY = _mm_min_ps(boundsMinY, screenY);
+				boundsMaxX = _mm_max_ps(boundsMaxX, screenX);
+				boundsMaxY = _mm_max_ps(boundsMaxY, screenY);
+				nearest = _mm_max_ps(nearest, depth);
+			}
+
+			alignas(16) std::array<float, 4> lanes = {};
+			_mm_store_ps(lanes.data(), boundsMinX);
+			minX = std::min({ lanes[0], lanes[1], lanes[2], lanes[3] });
+			_mm_store_ps(lanes.data(), boundsMinY);
+			minY = std::min({ lanes[0], lanes[1], lanes[2], lanes[3] });
+			_mm_store_ps(lanes.data(), boundsMaxX);
+			maxX = std::max({ lanes[0], lanes[1], lanes[2], lanes[3] });
+			_mm_store_ps(lanes.data(), boundsMaxY);
+			maxY = std::max({ lanes[0], lanes[1], lanes[2], lanes[3] });
+			_mm_store_ps(lanes.data(), nearest);
+			nearestDepth = std::max({ lanes[0], lanes[1], lanes[2], lanes[3] });
+			corner = 8;
+		}
+#endif // LEVIATHAN_SIMD_SSE.
+		for (; corner < 8; ++corner)
+		{
+			const float cornerX = (corner & 1) ? bounds.Max.X() : bounds.Min.X();
+			const float cornerY = (corner & 2) ? bounds.Max.Y() : bounds.Min.Y();
+			const float cornerZ = (corner & 4) ? bounds.Max.Z() : bounds.Min.Z();
+			const float w = m[3] * cornerX + m[7] * cornerY + m[11] * cornerZ + m[15];
+			if (w < NearZ)
+			{
+				return false;
+			}
+
+			const float depth = 1.0f / w;
+			const float screenX = ((m[0] * cornerX + m[4] * cornerY + m[8] * cornerZ + m[12]) * depth * 0.5f + 0.5f) * static_cast<float>(Width);
+			const float screenY = (0.5f - (m[1] * cornerX + m[5] * cornerY + m[9] * cornerZ + m[13]) * depth * 0.5f) * static_cast<float>(Height);
+			minX = std::min(minX, screenX);
+			minY = std::min(minY, screenY);
+			maxX = std::max(maxX, screenX);
+			maxY = std::max(maxY, screenY);
+			nearestDepth = std::max(nearestDepth, depth);
+		}
+		if ((maxX < 0.0f) || (maxY < 0.0f) || (minX >= static_cast<float>(Width)) || (minY >= static_cast<float>(Height)))
+		{
+			return false;
+		}
+
+		// Pixels touched by the projected bounds dilated by one pixel.
+		const int32_t pixelMinX = static_cast<int32_t>(std::max(std::floor(minX) - 1.0f, 0.0f));
+		const int32_t pixelMinY = static_cast<int32_t>(std::max(std::floor(minY) - 1.0f, 0.0f));
+		const int32_t pixelMaxX = static_cast<int32_t>(std::min(std::floor(maxX) + 1.0f, static_cast<float>(Width - 1)));
+		const int32_t pixelMaxY = static_cast<int32_t>(std::min(std::floor(maxY) + 1.0f, static_cast<float>(Height - 1)));
+
+		const int32_t tileSize = static_cast<int32_t>(TileSize);
+		const uint32_t tileCountX = GetTileCountX();
+		for (int32_t tileY = pixelMinY / tileSize; tileY <= pixelMaxY / tileSize; ++tileY)
+		{
+			for (int32_t tileX = pixelMinX / tileSize; tileX <= pixelMaxX / tileSize; ++tileX)
+			{
+				// Tiles whose farthest depth is in front of the box are hidden entirely.
+				if (TileDepths[(static_cast<size_t>(tileY) * tileCountX) + tileX] > nearestDepth)
+				{
+					continue;
+				}
+
+				const int32_t tileMinX = std::max(tileX * tileSize, pixelMinX);
+				const int32_t tileMaxX = std::min((tileX * tileSize) + tileSize - 1, pixelMaxX);
+				const int32_t tileMinY = std::max(tileY * tileSize, pixelMinY);
+				const int32_t tileMaxY = std::min((tileY * tileSize) + tileSize - 1, pixelMaxY);
+				for (int32_t y = tileMinY; y <= tileMaxY; ++y)
+				{
+					const float* const row = DepthBuffer.data() + (static_cast<size_t>(y) * Width);
+					int32_t x = tileMinX;
+#ifdef LEVIATHAN_SIMD_SSE
+					// Groups of four pixels aligned to the tile, masked to the pixels inside the bounds.
+					const __m128 nearest = _mm_set1_ps(nearestDepth);
+					const __m128i firstLane = _mm_set1_epi32(tileMinX - 1);
+					const __m128i lastLane = _mm_set1_epi32(tileMaxX + 1);
+					for (int32_t group = tileX * tileSize; group < (tileX * tileSize) + tileSize; group += 4)
+					{
+						const __m128i lanes = _mm_add_epi32(_mm_set1_epi32(group), _mm_setr_epi32(0, 1, 2, 3));
+						const __m128 inside = _mm_castsi128_ps(_mm_and_si128(_mm_cmpgt_epi32(lanes, firstLane), _mm_cmplt_epi32(lanes, lastLane)));
+						if (_mm_movemask_ps(_mm_and_ps(inside, _mm_cmple_ps(_mm_loadu_ps(row + group), nearest))) != 0)
+						{
+							return false;
+						}
+					}
+					x = tileMaxX + 1;
+#endif // LEVIATHAN_SIMD_SSE.
+					for (; x <= tileMaxX; ++x)
+					{
+						if (row[x] <= nearestDepth)
+						{
+							return false;
+						}
+					}
+				}
+			}
+		}
+		return true;
+	}
+
+	void OcclusionCullingStage::Cull(const LeviathanCore::BoundingVolumes::AABBSoA& worldBounds, const uint32_t* const indices, const size_t count)
+	{
+		if (VisibleIndices.size() < count)
+		{
+			VisibleIndices.resize(count);
+		}
+		Stats.TestedObjects = count;
+
+		if (Stats.RasterizedTriangles == 0)
+		{
+			std::copy_n(indices, count, VisibleIndices.data());
+			VisibleCount = count;
+			Stats.OccludedObjects = 0;
+			return;
+		}
+
+		if (ScratchResults.size() < count)
+		{
+			ScratchResults.resize(count);
+		}
+		LeviathanCore::JobSystem::ParallelFor(count, ObjectsPerJob, [this, &worldBounds, indices](const size_t first, const size_t rangeCount, [[maybe_unused]] const size_t threadIndex)
+			{
+				for (size_t i = first; i < first + rangeCount; ++i)
+				{
+					const uint32_t index = indices[i];
+					const LeviathanCore::BoundingVolumes::AABB bounds{
+						LeviathanCore::MathTypes::Vector3(worldBounds.MinX[index], worldBounds.MinY[index], worldBounds.MinZ[index]),
+						LeviathanCore::MathTypes::Vector3(worldBounds.MaxX[index], worldBounds.MaxY[index], worldBounds.MaxZ[index]) };
+					ScratchResults[i] = IsOccluded(bounds) ? 0 : 1;
+				}
+			});
+
+		// Branchless compaction. The index of an occluded object is overwritten by the next object.
+		size_t visibleCount = 0;
+		for (size_t i = 0; i < count; ++i)
+		{
+			VisibleIndices[visibleCount] = indices[i];
+			visibleCount += ScratchResults[i];
+		}
+		VisibleCount = visibleCount;
+		Stats.OccludedObjects = count - visibleCount;
+	}
+}
@@ -0,0 +1,225 @@
+#include "RenderCommands.h"
+#include "JobSystem.h"
+
+namespace LeviathanRenderer
+{
+	namespace RenderCommands
+	{
+		static bool SortedPacketLess(const CommandQueue::SortedPacket& a, const CommandQueue::SortedPacket& b)
+		{
+			return a.SortKey < b.SortKey;
+		}
+
+		uint32_t QuantizeDepth(const float viewDepth, const float nearZ, const float farZ)
+		{
+			const float normalized = (viewDepth - nearZ) / (farZ - nearZ);
+			const float clamped = (normalized > 0.0f) ? ((normalized < 1.0f) ? normalized : 1.0f) : 0.0f;
+			return static_cast<uint32_t>(clamped * static_cast<float>(SortKeyDepthMask));
+		}
+
+		void CommandBuffer::BeginPacket(const uint64_t sortKey)
+		{
+			const uint32_t first = static_cast<uint32_t>(Words.size());
+			Packets.push_back(Packet{ sortKey, first, first });
+		}
+
+		void CommandBuffer::ClearRenderTarget(const RenderTarget target, const float* color)
+		{
+			ClearRenderTargetCommand command = {};
+			command.Target = target;
+			memcpy(command.Color.data(), color, sizeof(float) * 4);
+			Write(command);
+		}
+
+		void CommandBuffer::ClearDepthStencil(const float depth, const uint8_t stencil)
+		{
+			ClearDepthStencilCommand command = {};
+			command.Depth = depth;
+			command.Stencil = stencil;
+			Write(command);
+		}
+
+		void CommandBuffer::SetRenderTarget(const RenderTarget target)
+		{
+			SetRenderTargetCommand command = {};
+			command.Target = target;
+			Write(command);
+		}
+
+		void CommandBuffer::SetPipeline(const Pipeline pipeline, const uint32_t permutation)
+		{
+			SetPipelineCommand command = {};
+			command.PipelineType = pipeline;
+			command.Permutation = permutation;
+			Write(command);
+		}
+
+		void CommandBuffer::SetSkyboxPipeline(const RendererResourceId::IdType textureCubeId, const RendererResourceId::IdType samplerId)
+		{
+			SetSkyboxPipelineCommand command = {};
+			command.TextureCube = textureCubeId;
+			command.Sampler = samplerId;
+			Write(command);
+		}
+
+		void CommandBuffer::SetBlendState(const BlendState state)
+		{
+			SetBlendStateCommand command = {};
+			command.State = state;
+			Write(command);
+		}
+
+		void CommandBuffer::SetDepthStencilState(const DepthStencilState state)
+		{
+			SetDepthStencilStateCommand command = {};
+			command.State = state;
+			Write(command);
+		}
+
+		void CommandBuffer::SetTexture(const TextureSlot slot, const RendererResourceId::IdType textureId)
+		{
+			SetResourceCommand command = {};
+			command.Type = CommandType::SetTexture;
+			command.Slot = slot;
+			command.Resource = textureId;
+			Write(command);
+		}
+
+		void CommandBuffer::SetSampler(const TextureSlot slot, const RendererResourceId::IdType samplerId)
+		{
+			SetResourceCommand command = {};
+			command.Type = CommandType::SetSampler;
+			command.Slot = slot;
+			command.Resource = samplerId;
+			Write(command);
+		}
+
+		void CommandBuffer::UpdateConstantBuffer(const ConstantBuffer buffer, const void* data, const uint32_t byteWidth)
+		{
+			UpdateConstantBufferCommand command = {};
+			command.Buffer = buffer;
+			command.ByteWidth = byteWidth;
+			Write(command, data, byteWidth);
+		}
+
+		void CommandBuffer::SetConstantBufferRange(const ConstantBuffer buffer, const uint32_t offset, const uint32_t byteWidth)
+		{
+			SetConstantBufferRangeCommand command = {};
+			command.Buffer = buffer;
+			command.Offset = offset;
+			command.ByteWidth = byteWidth;
+			Write(command);
+		}
+
+		void CommandBuffer::DrawIndexed(const uint32_t indexCount, const uint32_t vertexStrideBytes, const RendererResourceId::IdType vertexBufferId,
+			const RendererResourceId::IdType indexBufferId)
+		{
+			DrawIndexedCommand command = {};
+			command.IndexCount = indexCount;
+			command.VertexStrideBytes = vertexStrideBytes;
+			command.VertexBuffer = vertexBufferId;
+			command.IndexBuffer = indexBufferId;
+			Write(command);
+		}
+
+		void CommandBuffer::DrawIndexedInstanced(const uint32_t indexCount, const uint32_t vertexStrideBytes, const RendererResourceId::IdType vertexBufferId,
+			const RendererResourceId::IdType indexBufferId, const uint32_t instanceCount, const uint32_t firstInstance)
+		{
+			DrawIndexedInstancedCommand command = {};
+			command.IndexCount = indexCount;
+			command.VertexStrideBytes = vertexStrideBytes;
+			command.InstanceCount = instanceCount;
+			command.FirstInstance = firstInstance;
+			command.VertexBuffer = vertexBufferId;
+			command.IndexBuffer = indexBufferId;
+			Write(command);
+		}
+
+		void CommandBuffer::UnbindShaderResources()
+		{
+			Write(UnbindShaderResourcesCommand{});
+		}
+
+		void CommandBuffer::Reset()
+		{
+			Words.clear();
+			Packets.clear();
+		}
+
+		template <typename Command>
+		void CommandBuffer::Write(const Command& command, const void* payload, const size_t payloadSizeBytes)
+		{
+			static_assert(std::is_trivially_copyable_v<Command>, "Render commands must be trivially copyable.");
+
+			if (Packets.empty())
+			{
+				BeginPacket(0);
+			}
+
+			const size_t first = Words.size();
+			Words.resize(first + WordCount(sizeof(Command)) + WordCount(payloadSizeBytes));
+			memcpy(&Words[first], &command, sizeof(Command));
+			if (payloadSizeBytes > 0)
+			{
+				memcpy(&Words[first + WordCount(sizeof(Command))], payload, payloadSizeBytes);
+			}
+
+			Packets.back().End = static_cast<uint32_t>(Words.size());
+		}
+
+		void CommandQueue::Reset(const size_t bufferCount)
+		{
+			if (Buffers.size() < bufferCount)
+			{
+				Buffers.resize(bufferCount);
+			}
+
+			for (CommandBuffer& buffer : Buffers)
+			{
+				buffer.Reset();
+			}
+			Order.clear();
+		}
+
+		void CommandQueue::Sort()
+		{
+			// Gather the packets of every buffer into one run per buffer.
+			RunOffsets.assign(1, 0);
+			Order.clear();
+			for (size_t bufferIndex = 0; bufferIndex < Buffers.size(); ++bufferIndex)
+			{
+				const std::vector<CommandBuffer::Packet>& packets = Buffers[bufferIndex].GetPackets();
+				for (size_t packetIndex = 0; packetIndex < packets.size(); ++packetIndex)
+				{
+					Order.push_back(SortedPacket{ packets[packetIndex].SortKey, static_cast<uint32_t>(bufferIndex), static_cast<uint32_t>(packetIndex) });
+				}
+				RunOffsets.push_back(Order.size());
+			}
+
+			// Sort the runs in parallel.
+			const size_t runCount = Buffers.size();
+			LeviathanCore::JobSystem::ParallelFor(runCount, 1, [this](const size_t first, const size_t count, [[maybe_unused]] const size_t threadIndex)
+				{
+					for (size_t run = first; run < first + count; ++run)
+					{
+						std::stable_sort(Order.begin() + RunOffsets[run], Order.begin() + RunOffsets[run + 1], &SortedPacketLess);
+					}
+				});
+
+			// Merge neighbouring runs until one run is left. Merging the earlier run first keeps packets with equal keys in buffer order.
+			ScratchOrder.resize(Order.size());
+			for (size_t width = 1; width < runCount; width *= 2)
+			{
+				for (size_t run = 0; run < runCount; run += width * 2)
+				{
+					const size_t first = RunOffsets[run];
+					const size_t middle = RunOffsets[std::min(run + width, runCount)];
+					const size_t end = RunOffsets[std::min(run + width * 2, runCount)];
+					std::merge(Order.begin() + first, Order.begin() + middle, Order.begin() + middle, Order.begin() + end, ScratchOrder.begin() + first,
+						&SortedPacketLess);
+				}
+				Order.swap(ScratchOrder);
+			}
+		}
+	}
+}
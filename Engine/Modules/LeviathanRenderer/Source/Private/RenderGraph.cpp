@@ -0,0 +1,281 @@
+#include "RenderGraph.h"
+
+namespace LeviathanRenderer
+{
+	static inline uint64_t AlignUp(const uint64_t value, const uint64_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	uint32_t RenderGraph::GetBytesPerPixel(const RenderGraphFormat format)
+	{
+		switch (format)
+		{
+		case RenderGraphFormat::R8Unorm: return 1;
+		case RenderGraphFormat::R8G8B8A8Unorm: return 4;
+		case RenderGraphFormat::R16G16B16A16Float: return 8;
+		case RenderGraphFormat::R32Float: return 4;
+		case RenderGraphFormat::R32G32B32A32Float: return 16;
+		case RenderGraphFormat::D24UnormS8Uint: return 4;
+		default: return 0;
+		}
+	}
+
+	void RenderGraph::Reset()
+	{
+		Resources.clear();
+		Passes.clear();
+		Accesses.clear();
+		DeclarationError = false;
+		CompiledPasses.clear();
+		PassCulled.clear();
+		FirstUse.clear();
+		LastUse.clear();
+		HeapOffsets.clear();
+		FirstUseOffsets.clear();
+		FirstUseResources.clear();
+		Stats = {};
+	}
+
+	RenderGraph::ResourceHandle RenderGraph::AddResource(const RenderGraphTextureDescription& description, const bool imported)
+	{
+		Resource resource = {};
+		resource.Description = description;
+		resource.SizeBytes = AlignUp(static_cast<uint64_t>(description.Width) * description.Height * GetBytesPerPixel(description.Format), PlacementAlignmentBytes);
+		resource.Imported = imported;
+		Resources.push_back(resource);
+		return static_cast<ResourceHandle>(Resources.size() - 1);
+	}
+
+	RenderGraph::ResourceHandle RenderGraph::CreateTexture(const RenderGraphTextureDescription& description)
+	{
+		return AddResource(description, false);
+	}
+
+	RenderGraph::ResourceHandle RenderGraph::ImportTexture(const RenderGraphTextureDescription& description)
+	{
+		return AddResource(description, true);
+	}
+
+	void RenderGraph::MarkOutput(const ResourceHandle resource)
+	{
+		if (resource >= Resources.size())
+		{
+			DeclarationError = true;
+			return;
+		}
+		Resources[resource].Output = true;
+	}
+
+	uint32_t RenderGraph::AddPass(const bool hasSideEffects)
+	{
+		Pass pass = {};
+		pass.FirstAccess = static_cast<uint32_t>(Accesses.size());
+		pass.HasSideEffects = hasSideEffects;
+		Passes.push_back(pass);
+		return static_cast<uint32_t>(Passes.size() - 1);
+	}
+
+	void RenderGraph::AddAccess(const ResourceHandle resource, const bool write)
+	{
+		if (Passes.empty() || (resource >= Resources.size()))
+		{
+			DeclarationError = true;
+			return;
+		}
+		Accesses.push_back(Access{ resource, write });
+		++Passes.back().AccessCount;
+	}
+
+	void RenderGraph::Read(const ResourceHandle resource)
+	{
+		AddAccess(resource, false);
+	}
+
+	void RenderGraph::Write(const ResourceHandle resource)
+	{
+		AddAccess(resource, true);
+	}
+
+	bool RenderGraph::Compile()
+	{
+		const size_t passCount = Passes.size();
+		const size_t resourceCount = Resources.size();
+		CompiledPasses.clear();
+		PassCulled.assign(passCount, 1);
+		FirstUse.assign(resourceCount, InvalidPass);
+		LastUse.assign(resourceCount, InvalidPass);
+		HeapOffsets.assign(resourceCount, 0);
+		FirstUseOffsets.clear();
+		FirstUseResources.clear();
+		Stats = {};
+		Stats.PassCount = passCount;
+		if (DeclarationError)
+		{
+			return false;
+		}
+
+		// Walk the passes backwards tracking which resources hold contents a later pass or the graph's outputs need. A pass survives if it has side
+		// effects or writes a needed resource. Its writes define the contents so they are no longer needed before it, its reads are.
+		Needed.resize(resourceCount);
+		for (size_t resource = 0; resource < resourceCount; ++resource)
+		{
+			Needed[resource] = Resources[resource].Output ? 1 : 0;
+		}
+		size_t survivingPassCount = 0;
+		for (size_t passIndex = passCount; passIndex-- > 0;)
+		{
+			const Pass& pass = Passes[passIndex];
+			const Access* const accesses = Accesses.data() + pass.FirstAccess;
+			bool survives = pass.HasSideEffects;
+			for (uint32_t i = 0; i < pass.AccessCount; ++i)
+			{
+				survives |= (accesses[i].Write && (Needed[accesses[i].Resource] != 0));
+			}
+			if (!survives)
+			{
+				continue;
+			}
+
+			PassCulled[passIndex] = 0;
+			++survivingPassCount;
+			for (uint32_t i = 0; i < pass.AccessCount; ++i)
+			{
+				if (accesses[i].Write)
+				{
+					Needed[accesses[i].Resource] = 0;
+				}
+			}
+			for (uint32_t i = 0; i < pass.AccessCount; ++i)
+			{
+				if (!accesses[i].Write)
+				{
+					Needed[accesses[i].Resource] = 1;
+				}
+			}
+		}
+		Stats.CulledPassCount = passCount - survivingPassCount;
+
+		// Contents of transient resources still needed before the first pass are undefined.
+		for (size_t resource = 0; resource < resourceCount; ++resource)
+		{
+			if ((Needed[resource] != 0) && !Resources[resource].Imported)
+			{
+				return false;
+			}
+		}
+
+		// Lifetimes of transient resources in compiled pass indices. Outputs live until the end of the graph.
+		CompiledPasses.reserve(survivingPassCount);
+		for (uint32_t passIndex = 0; passIndex < passCount; ++passIndex)
+		{
+			if (PassCulled[passIndex] != 0)
+			{
+				continue;
+			}
+
+			const uint32_t compiledPass = static_cast<uint32_t>(CompiledPasses.size());
+			CompiledPasses.push_back(passIndex);
+			const Pass& pass = Passes[passIndex];
+			for (uint32_t i = 0; i < pass.AccessCount; ++i)
+			{
+				const ResourceHandle resource = Accesses[pass.FirstAccess + i].Resource;
+				if (FirstUse[resource] == InvalidPass)
+				{
+					FirstUse[resource] = compiledPass;
+				}
+				LastUse[resource] = compiledPass;
+			}
+		}
+
+		PlacementOrder.clear();
+		for (ResourceHandle resource = 0; resource < resourceCount; ++resource)
+		{
+			const Resource& description = Resources[resource];
+			if (description.Imported)
+			{
+				FirstUse[resource] = InvalidPass;
+				LastUse[resource] = InvalidPass;
+				continue;
+			}
+
+			++Stats.TransientResourceCount;
+			if (FirstUse[resource] == InvalidPass)
+			{
+				continue;
+			}
+			if (description.Output)
+			{
+				LastUse[resource] = static_cast<uint32_t>(survivingPassCount - 1);
+			}
+			PlacementOrder.push_back(resource);
+			Stats.TransientBytes += description.SizeBytes;
+		}
+		Stats.AllocatedResourceCount = PlacementOrder.size();
+
+		// Place the largest resources first. Each resource takes the lowest offset that does not overlap the memory of a placed resource whose
+		// lifetime overlaps its own. Placed resources are kept in offset order so gaps are found in a single scan.
+		std::sort(PlacementOrder.begin(), PlacementOrder.end(), [this](const ResourceHandle a, const ResourceHandle b)
+			{
+				return (Resources[a].SizeBytes != Resources[b].SizeBytes) ? (Resources[a].SizeBytes > Resources[b].SizeBytes) : (a < b);
+			});
+		PlacedByOffset.clear();
+		for (const ResourceHandle resource : PlacementOrder)
+		{
+			const uint64_t sizeBytes = Resources[resource].SizeBytes;
+			const uint32_t first = FirstUse[resource];
+			const uint32_t last = LastUse[resource];
+			uint64_t offset = 0;
+			size_t insertPosition = PlacedByOffset.size();
+			for (size_t i = 0; i < PlacedByOffset.size(); ++i)
+			{
+				const ResourceHandle placed = PlacedByOffset[i];
+				if ((FirstUse[placed] > last) || (LastUse[placed] < first))
+				{
+					continue;
+				}
+				if (HeapOffsets[placed] >= offset + sizeBytes)
+				{
+					insertPosition = i;
+					break;
+				}
+				offset = std::max(offset, HeapOffsets[placed] + Resources[placed].SizeBytes);
+			}
+
+			HeapOffsets[resource] = offset;
+			while ((insertPosition > 0) && (HeapOffsets[PlacedByOffset[insertPosition - 1]] > offset))
+			{
+				--insertPosition;
+			}
+			PlacedByOffset.insert(PlacedByOffset.begin() + insertPosition, resource);
+			Stats.HeapBytes = std::max(Stats.HeapBytes, offset + sizeBytes);
+		}
+
+		// Group allocated resources by their first compiled pass.
+		FirstUseOffsets.assign(survivingPassCount + 1, 0);
+		for (const ResourceHandle resource : PlacementOrder)
+		{
+			++FirstUseOffsets[FirstUse[resource] + 1];
+		}
+		for (size_t compiledPass = 0; compiledPass < survivingPassCount; ++compiledPass)
+		{
+			FirstUseOffsets[compiledPass + 1] += FirstUseOffsets[compiledPass];
+		}
+		FirstUseResources.resize(PlacementOrder.size());
+		for (ResourceHandle resource = 0; resource < resourceCount; ++resource)
+		{
+			if (!Resources[resource].Imported && (FirstUse[resource] != InvalidPass))
+			{
+				FirstUseResources[FirstUseOffsets[FirstUse[resource]]++] = resource;
+			}
+		}
+		// Filling advanced every group's offset to the start of the next group.
+		for (size_t compiledPass = survivingPassCount; compiledPass > 0; --compiledPass)
+		{
+			FirstUseOffsets[compiledPass] = FirstUseOffsets[compiledPass - 1];
+		}
+		FirstUseOffsets[0] = 0;
+
+		return true;
+	}
+}
@@ -0,0 +1,33 @@
+#include "RenderStateFilter.h"
+#include "Hash.h"
+
+namespace LeviathanRenderer
+{
+	namespace RenderCommands
+	{
+		uint32_t StateFilterStats::GetIssuedCallCount() const
+		{
+			uint32_t count = 0;
+			for (const uint32_t calls : IssuedCalls)
+			{
+				count += calls;
+			}
+			return count;
+		}
+
+		uint32_t StateFilterStats::GetElidedCallCount() const
+		{
+			uint32_t count = 0;
+			for (const uint32_t calls : ElidedCalls)
+			{
+				count += calls;
+			}
+			return count;
+		}
+
+		uint64_t HashConstantBufferData(const void* data, const size_t sizeBytes)
+		{
+			return LeviathanCore::Hash::HashBytes(data, sizeBytes);
+		}
+	}
+}
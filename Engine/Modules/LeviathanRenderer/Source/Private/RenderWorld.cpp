@@ -0,0 +1,176 @@
+#include "RenderWorld.h"
+#include "Camera.h"
+#include "VisibilityCulling.h"
+#include "OcclusionCulling.h"
+#include "RenderCommands.h"
+#include "JobSystem.h"
+
+namespace LeviathanRenderer
+{
+	// Number of draws processed per job when building draw lists.
+	static constexpr size_t DrawListChunkSize = 1024;
+
+	RenderableId RenderWorld::Create(const RenderableDescription& description)
+	{
+		RenderableId renderable = InvalidRenderableId;
+		if (!FreeRenderableIds.empty())
+		{
+			renderable = FreeRenderableIds.back();
+			FreeRenderableIds.pop_back();
+		}
+		else
+		{
+			renderable = static_cast<RenderableId>(RenderableToIndex.size());
+			RenderableToIndex.push_back(InvalidIndex);
+		}
+
+		RenderableToIndex[renderable] = static_cast<uint32_t>(Meshes.size());
+		IndexToRenderable.push_back(renderable);
+		Meshes.push_back(description.Mesh);
+		Materials.push_back(description.Material);
+		WorldMatrices.push_back(description.Transform);
+		WorldBounds.Add(description.Mesh.LocalBounds.Transformed(description.Transform));
+		return renderable;
+	}
+
+	void RenderWorld::Destroy(const RenderableId renderable)
+	{
+		const uint32_t index = GetIndex(renderable);
+		const uint32_t last = static_cast<uint32_t>(Meshes.size() - 1);
+
+		// Move the last renderable into the destroyed renderable's slot.
+		if (index != last)
+		{
+			Meshes[index] = Meshes[last];
+			Materials[index] = Materials[last];
+			WorldMatrices[index] = WorldMatrices[last];
+			WorldBounds.Set(index, WorldBounds.Get(last));
+			IndexToRenderable[index] = IndexToRenderable[last];
+			RenderableToIndex[IndexToRenderable[index]] = index;
+		}
+
+		Meshes.pop_back();
+		Materials.pop_back();
+		WorldMatrices.pop_back();
+		WorldBounds.Resize(last);
+		IndexToRenderable.pop_back();
+
+		RenderableToIndex[renderable] = InvalidIndex;
+		FreeRenderableIds.push_back(renderable);
+	}
+
+	void RenderWorld::SetTransform(const RenderableId renderable, const LeviathanCore::MathTypes::Matrix4x4& transform)
+	{
+		const uint32_t index = GetIndex(renderable);
+		WorldMatrices[index] = transform;
+		WorldBounds.Set(index, Meshes[index].LocalBounds.Transformed(transform));
+	}
+
+	void RenderWorld::SetMesh(const RenderableId renderable, const RenderMesh& mesh)
+	{
+		const uint32_t index = GetIndex(renderable);
+		Meshes[index] = mesh;
+		WorldBounds.Set(index, mesh.LocalBounds.Transformed(WorldMatrices[index]));
+	}
+
+	void RenderWorld::SetMaterial(const RenderableId renderable, const RenderMaterial& material)
+	{
+		Materials[GetIndex(renderable)] = material;
+	}
+
+	void RenderWorld::Clear()
+	{
+		Meshes.clear();
+		Materials.clear();
+		WorldMatrices.clear();
+		WorldBounds.Clear();
+		IndexToRenderable.clear();
+		RenderableToIndex.clear();
+		FreeRenderableIds.clear();
+	}
+
+	// Builds the draw list of the visible renderables in visibleIndices.
+	static void BuildDrawListFromVisible(const RenderWorld& world, const Camera& view, const uint32_t* const visibleIndices, const size_t visibleCount,
+		DrawList& outDrawList)
+	{
+		const LeviathanCore::BoundingVolumes::AABBSoA worldBounds = world.GetWorldBounds();
+
+		// Sort keys from the material and the view depth of the world bounds center.
+		const LeviathanCore::MathTypes::Matrix4x4& viewMatrix = view.GetViewMatrix();
+		const float* const viewData = viewMatrix.Data();
+		const float nearZ = view.GetNearZ();
+		const float farZ = view.GetFarZ();
+		outDrawList.ScratchEntries.resize(visibleCount);
+		LeviathanCore::JobSystem::ParallelFor(visibleCount, DrawListChunkSize,
+			[&world, &worldBounds, &outDrawList, visibleIndices, viewData, nearZ, farZ](const size_t first, const size_t count, [[maybe_unused]] const size_t threadIndex)
+			{
+				for (size_t i = first; i < first + count; ++i)
+				{
+					const uint32_t index = visibleIndices[i];
+					const float centerX = 0.5f * (worldBounds.MinX[index] + worldBounds.MaxX[index]);
+					const float centerY = 0.5f * (worldBounds.MinY[index] + worldBounds.MaxY[index]);
+					const float centerZ = 0.5f * (worldBounds.MinZ[index] + worldBounds.MaxZ[index]);
+					// Column major view matrix. Row 2 gives the view space z.
+					const float viewDepth = viewData[2] * centerX + viewData[6] * centerY + viewData[10] * centerZ + viewData[14];
+					const uint32_t material = static_cast<uint32_t>(world.GetMaterial(index).ColorTexture);
+					outDrawList.ScratchEntries[i] = DrawList::SortEntry{ RenderCommands::MakeSortKey(0, 0, material, RenderCommands::QuantizeDepth(viewDepth, nearZ, farZ)),
+						index };
+				}
+			});
+
+		// Ties are broken by storage index so the order does not depend on culling order.
+		std::sort(outDrawList.ScratchEntries.begin(), outDrawList.ScratchEntries.end(), [](const DrawList::SortEntry& a, const DrawList::SortEntry& b)
+			{
+				return (a.SortKey < b.SortKey) || ((a.SortKey == b.SortKey) && (a.Renderable < b.Renderable));
+			});
+
+		// Object data in draw order.
+		outDrawList.Renderables.resize(visibleCount);
+		outDrawList.SortKeys.resize(visibleCount);
+		outDrawList.ObjectData.resize(visibleCount);
+		const LeviathanCore::MathTypes::Matrix4x4& viewProjectionMatrix = view.GetViewProjectionMatrix();
+		LeviathanCore::JobSystem::ParallelFor(visibleCount, DrawListChunkSize,
+			[&world, &outDrawList, &viewMatrix, &viewProjectionMatrix](const size_t first, const size_t count, [[maybe_unused]] const size_t threadIndex)
+			{
+				for (size_t i = first; i < first + count; ++i)
+				{
+					const DrawList::SortEntry& entry = outDrawList.ScratchEntries[i];
+					outDrawList.Renderables[i] = entry.Renderable;
+					outDrawList.SortKeys[i] = entry.SortKey;
+
+					const LeviathanCore::MathTypes::Matrix4x4& worldMatrix = world.GetWorldMatrix(entry.Renderable);
+					const LeviathanCore::MathTypes::Matrix4x4 worldViewMatrix = viewMatrix * worldMatrix;
+					const LeviathanCore::MathTypes::Matrix4x4 worldViewProjectionMatrix = viewProjectionMatrix * worldMatrix;
+					ConstantBufferTypes::ObjectConstantBuffer& objectData = outDrawList.ObjectData[i];
+					memcpy(objectData.WorldViewMatrix, worldViewMatrix.Data(), sizeof(float) * 16);
+					memcpy(objectData.WorldViewProjectionMatrix, worldViewProjectionMatrix.Data(), sizeof(float) * 16);
+					memcpy(objectData.NormalMatrix, worldViewMatrix.Data(), sizeof(float) * 16);
+				}
+			});
+	}
+
+	void BuildDrawList(const RenderWorld& world, const Camera& view, FrustumCullingStage& cullingStage, DrawList& outDrawList)
+	{
+		cullingStage.Cull(view.GetFrustum(), world.GetWorldBounds());
+		BuildDrawListFromVisible(world, view, cullingStage.GetVisibleIndices(), cullingStage.GetVisibleCount(), outDrawList);
+	}
+
+	void BuildDrawList(const RenderWorld& world, const Camera& view, FrustumCullingStage& cullingStage, OcclusionCullingStage& occlusionStage,
+		DrawList& outDrawList)
+	{
+		const LeviathanCore::BoundingVolumes::AABBSoA worldBounds = world.GetWorldBounds();
+		cullingStage.Cull(view.GetFrustum(), worldBounds);
+
+		// Occluders are only rasterized for perspective views. Without occluders nothing can be hidden.
+		if ((view.GetProjectionMode() != Camera::ProjectionMode::Perspective) || (occlusionStage.GetOccluderCount() == 0))
+		{
+			occlusionStage.ResetStats();
+			BuildDrawListFromVisible(world, view, cullingStage.GetVisibleIndices(), cullingStage.GetVisibleCount(), outDrawList);
+			return;
+		}
+
+		occlusionStage.RenderOccluders(view);
+		occlusionStage.Cull(worldBounds, cullingStage.GetVisibleIndices(), cullingStage.GetVisibleCount());
+		BuildDrawListFromVisible(world, view, occlusionStage.GetVisibleIndices(), occlusionStage.GetVisibleCount(), outDrawList);
+	}
+}
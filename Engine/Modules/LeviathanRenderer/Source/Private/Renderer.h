@@ -18,9 +18,16 @@ namespace LeviathanRenderer
 		void DestroyIndexBuffer(RendererResourceId::IdType& resourceID);
 		bool CreateTexture2D(uint32_t width, uint32_t height, const void* data, uint32_t rowPitchBytes, bool sRGB, bool HDR, bool generateMips, RendererResourceId::IdType& outID);
 		void DestroyTexture(RendererResourceId::IdType& resourceID);
+		// Creates an 8 bit rgba texture from mipCount mips down from a width x height mip 0, finest first. The texture's mips can be replaced with
+		// SetTexture2DMips.
+		bool CreateTexture2DMips(uint32_t width, uint32_t height, uint32_t mipCount, const void* const* mipData, bool sRGB, RendererResourceId::IdType& outId);
+		// Replaces the texture's mips with mipCount mips down from a width x height mip 0 keeping the texture's id. The first loadedMipCount mips are
+		// created from loadedMipData and the remaining mips are copied from the coarsest mips of the current texture.
+		bool SetTexture2DMips(RendererResourceId::IdType id, uint32_t width, uint32_t height, uint32_t mipCount, const void* const* loadedMipData,
+			uint32_t loadedMipCount);
 		bool CreateSampler(TextureSamplerFilter filter, TextureSamplerBorderMode borderMode, const float* borderColor, const uint32_t anisotropy, RendererResourceId::IdType& outID);
 		void DestroySampler(RendererResourceId::IdType& resourceID);
-		bool CreateTextureCube(uint32_t faceWidth, const void* const * pFaceDatas, bool sRGB, RendererResourceId::IdType& outId);
+		bool CreateTextureCube(uint32_t faceWidth, const void* const * pFaceDatas, bool sRGB, bool HDR, bool halfFloat, RendererResourceId::IdType& outId);
 		void DestroyTextureCube(RendererResourceId::IdType& resourceID);
 
 		// Render commands.
@@ -38,16 +45,42 @@ namespace LeviathanRenderer
 		void SetSceneRenderTarget();
 		void SetRenderTarget(const RendererResourceId::IdType renderTargetId);
 		void SetAmbientLightPipeline();
-		void SetDirectionalLightPipeline();
-		void SetPointLightPipeline();
-		void SetSpotLightPipeline();
+		// Lighting pipelines draw with the pixel shader permutation of the key, see RendererConstants::LightingPixelShaderFeatures.
+		void SetDirectionalLightPipeline(uint32_t permutation);
+		void SetPointLightPipeline(uint32_t permutation);
+		void SetSpotLightPipeline(uint32_t permutation);
 		void SetPostProcessPipeline();
 		void Present();
 		void DrawIndexed(const unsigned int indexCount, size_t singleVertexStrideBytes, const RendererResourceId::IdType vertexBufferId, const RendererResourceId::IdType indexBufferId);
+		// Draws instances reading per instance data from the instance buffer starting at firstInstance. Used by the lighting pipelines.
+		void DrawIndexedInstanced(const unsigned int indexCount, size_t singleVertexStrideBytes, const RendererResourceId::IdType vertexBufferId,
+			const RendererResourceId::IdType indexBufferId, const unsigned int instanceCount, const unsigned int firstInstance);
+		// Replaces the contents of the instance buffer, growing it if needed.
+		bool UpdateInstanceBufferData(const void* pNewData, size_t byteWidth);
 		bool UpdateObjectBufferData(size_t byteOffsetIntoBuffer, const void* pNewData, size_t byteWidth);
 		bool UpdateDirectionalLightBufferData(size_t byteOffsetIntoBuffer, const void* pNewData, size_t byteWidth);
 		bool UpdatePointLightBufferData(size_t byteOffsetIntoBuffer, const void* pNewData, size_t byteWidth);
 		bool UpdateSpotLightBufferData(size_t byteOffsetIntoBuffer, const void* pNewData, size_t byteWidth);
+
+		// Constant upload buffer. Ranges handed out by an UploadRing are written while the buffer is mapped and bound by offset. A range must not be
+		// written while a frame reading it is in flight, discard may only be used when no frame is in flight. Offsets are multiples of
+		// RendererConstants::ConstantUploadAlignmentBytes. Only available when SupportsConstantBufferRanges returns true, otherwise constant data is
+		// written with the Update*BufferData functions.
+		bool SupportsConstantBufferRanges();
+		bool MapConstantUploadBuffer(bool discard, void*& outData);
+		void UnmapConstantUploadBuffer();
+		void SetObjectBufferRange(size_t byteOffset, size_t byteWidth);
+		void SetDirectionalLightBufferRange(size_t byteOffset, size_t byteWidth);
+		void SetPointLightBufferRange(size_t byteOffset, size_t byteWidth);
+		void SetSpotLightBufferRange(size_t byteOffset, size_t byteWidth);
+		void SetSkyboxBufferRange(size_t byteOffset, size_t byteWidth);
+
+		// Frame fences. Fence values increase by 1 every frame. Signalling reuses the fence of the frame RendererConstants::MaxFramesInFlight frames
+		// earlier, which must have completed.
+		void SignalFrameFence(uint64_t fenceValue);
+		// Returns the largest fence value the gpu completed without waiting.
+		uint64_t GetCompletedFrameFence();
+		void WaitForFrameFence(uint64_t fenceValue);
 		void UnbindShaderResources();
 		void SetDepthStencilStateWriteDepthDepthFuncLessStencilDisabled();
 		void SetDepthStencilStateWriteDepthDepthFuncLessEqualStencilDisabled();
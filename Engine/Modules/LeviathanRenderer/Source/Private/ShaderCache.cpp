@@ -0,0 +1,477 @@
+#include "ShaderCache.h"
+#include "Hash.h"
+#include "JobSystem.h"
+#include "Logging.h"
+#include "Serialize.h"
+
+namespace LeviathanRenderer
+{
+	struct ShaderPackHeader
+	{
+		LeviathanCore::Serialize::FileTag Tag = {};
+		uint32_t EntryCount = 0;
+		uint32_t Reserved = 0;
+	};
+
+	struct ShaderPackIndexEntry
+	{
+		uint64_t Key = 0;
+		// Byte range of the entry's bytecode from the start of the pack.
+		uint64_t Offset = 0;
+		uint64_t SizeBytes = 0;
+		uint64_t Checksum = 0;
+	};
+
+	using LeviathanCore::Hash::HashBytes;
+	using LeviathanCore::Hash::HashCombine;
+	using LeviathanCore::Hash::HashString;
+
+	ShaderSourceGraph::ShaderSourceGraph(const ShaderSourceReadFunctionType readFunction, void* const userData)
+		: ReadFunction(readFunction)
+		, ReadUserData(userData)
+	{
+	}
+
+	void ShaderSourceGraph::SetReadFunction(const ShaderSourceReadFunctionType readFunction, void* const userData)
+	{
+		ReadFunction = readFunction;
+		ReadUserData = userData;
+		Clear();
+	}
+
+	void ShaderSourceGraph::Clear()
+	{
+		Files.clear();
+		FileIndices.clear();
+		VisitMarks.clear();
+		VisitGeneration = 0;
+	}
+
+	std::string ShaderSourceGraph::ResolveIncludePath(const std::string_view includingFile, const std::string_view include)
+	{
+		std::string path = {};
+		const bool absolute = (!include.empty() && ((include.front() == '/') || (include.front() == '\\'))) || (include.find(':') != std::string_view::npos);
+		if (!absolute)
+		{
+			const size_t separator = includingFile.find_last_of("/\\");
+			if (separator != std::string_view::npos)
+			{
+				path.assign(includingFile.substr(0, separator + 1));
+			}
+		}
+		path.append(include);
+		std::replace(path.begin(), path.end(), '\\', '/');
+
+		// Remove . segments and .. segments following a named segment. Leading .. segments of relative paths are kept.
+		std::string normalized = {};
+		normalized.reserve(path.size());
+		const bool rooted = !path.empty() && (path.front() == '/');
+		size_t keptSegmentCount = 0;
+		size_t segmentStart = 0;
+		while (segmentStart <= path.size())
+		{
+			size_t segmentEnd = path.find('/', segmentStart);
+			segmentEnd = (segmentEnd == std::string::npos) ? path.size() : segmentEnd;
+			const std::string_view segment(path.data() + segmentStart, segmentEnd - segmentStart);
+			segmentStart = segmentEnd + 1;
+			if (segment.empty() || (segment == "."))
+			{
+				continue;
+			}
+			if ((segment == "..") && (keptSegmentCount > 0))
+			{
+				const size_t separator = normalized.find_last_of('/');
+				normalized.resize((separator == std::string::npos) ? 0 : separator);
+				--keptSegmentCount;
+				continue;
+			}
+			if ((segment == "..") && rooted)
+			{
+				continue;
+			}
+
+			if (!normalized.empty() || rooted)
+			{
+				normalized.push_back('/');
+			}
+			normalized.append(segment);
+			keptSegmentCount += (segment != "..") ? 1 : 0;
+		}
+		if (rooted && normalized.empty())
+		{
+			normalized.push_back('/');
+		}
+		return normalized;
+	}
+
+	void ShaderSourceGraph::ParseIncludes(const std::string_view source, std::vector<std::string_view>& outIncludes)
+	{
+		static constexpr std::string_view includeDirective = "include";
+		const size_t size = source.size();
+		const auto skipBlanks = [&source, size](size_t i)
+			{
+				while ((i < size) && ((source[i] == ' ') || (source[i] == '\t')))
+				{
+					++i;
+				}
+				return i;
+			};
+
+		// Directives start with # as the first token of a line. Comments between the start of the line and # do not change that.
+		bool lineStart = true;
+		size_t i = 0;
+		while (i < size)
+		{
+			const char c = source[i];
+			if (c == '\n')
+			{
+				lineStart = true;
+				++i;
+			}
+			else if ((c == ' ') || (c == '\t') || (c == '\r'))
+			{
+				++i;
+			}
+			else if ((c == '/') && (i + 1 < size) && (source[i + 1] == '/'))
+			{
+				const size_t end = source.find('\n', i + 2);
+				i = (end == std::string_view::npos) ? size : end;
+			}
+			else if ((c == '/') && (i + 1 < size) && (source[i + 1] == '*'))
+			{
+				const size_t end = source.find("*/", i + 2);
+				i = (end == std::string_view::npos) ? size : end + 2;
+			}
+			else if ((c == '#') && lineStart)
+			{
+				lineStart = false;
+				i = skipBlanks(i + 1);
+				if (source.substr(i, includeDirective.size()) != includeDirective)
+				{
+					continue;
+				}
+
+				i = skipBlanks(i + includeDirective.size());
+				if ((i < size) && ((source[i] == '"') || (source[i] == '<')))
+				{
+					const char close = (source[i] == '"') ? '"' : '>';
+					const size_t end = source.find_first_of(close == '"' ? "\"\n" : ">\n", i + 1);
+					if ((end != std::string_view::npos) && (source[end] == close) && (end > i + 1))
+					{
+						outIncludes.push_back(source.substr(i + 1, end - i - 1));
+						i = end + 1;
+					}
+				}
+			}
+			else if (c == '"')
+			{
+				// Skip string literals so that comment markers inside them are not treated as comments.
+				lineStart = false;
+				++i;
+				while ((i < size) && (source[i] != '"') && (source[i] != '\n'))
+				{
+					i += (source[i] == '\\') ? 2 : 1;
+				}
+				++i;
+			}
+			else
+			{
+				lineStart = false;
+				++i;
+			}
+		}
+	}
+
+	uint32_t ShaderSourceGraph::FindOrReadFile(const std::string& path)
+	{
+		const auto found = FileIndices.find(path);
+		if (found != FileIndices.end())
+		{
+			return found->second;
+		}
+
+		// The file is added before its includes are read so that include cycles end at it.
+		const uint32_t fileIndex = static_cast<uint32_t>(Files.size());
+		FileIndices.emplace(path, fileIndex);
+		Files.emplace_back();
+		SourceFile& file = Files.back();
+		file.Path = path;
+		file.Readable = (ReadFunction != nullptr) && ReadFunction(path, file.Source, ReadUserData);
+		file.ContentHash = HashString(file.Source);
+		if (!file.Readable)
+		{
+			return fileIndex;
+		}
+
+		// Include paths are resolved before reading the included files, which may move this file's source.
+		std::vector<std::string_view> includes = {};
+		ParseIncludes(file.Source, includes);
+		std::vector<std::string> includePaths = {};
+		includePaths.reserve(includes.size());
+		for (const std::string_view include : includes)
+		{
+			includePaths.push_back(ResolveIncludePath(path, include));
+		}
+
+		std::vector<uint32_t> includeIndices = {};
+		includeIndices.reserve(includePaths.size());
+		for (const std::string& includePath : includePaths)
+		{
+			includeIndices.push_back(FindOrReadFile(includePath));
+		}
+		Files[fileIndex].Includes = std::move(includeIndices);
+		return fileIndex;
+	}
+
+	template<typename Function>
+	bool ShaderSourceGraph::VisitSourceTree(const std::string_view file, const Function& visit)
+	{
+		const uint32_t root = FindOrReadFile(ResolveIncludePath({}, file));
+		if (VisitMarks.size() < Files.size())
+		{
+			VisitMarks.resize(Files.size(), 0);
+		}
+		++VisitGeneration;
+
+		bool readable = true;
+		VisitStack.clear();
+		VisitStack.push_back(root);
+		while (!VisitStack.empty())
+		{
+			const uint32_t fileIndex = VisitStack.back();
+			VisitStack.pop_back();
+			if (VisitMarks[fileIndex] == VisitGeneration)
+			{
+				continue;
+			}
+
+			VisitMarks[fileIndex] = VisitGeneration;
+			const SourceFile& sourceFile = Files[fileIndex];
+			readable &= sourceFile.Readable;
+			visit(fileIndex);
+			// Pushed in reverse so that includes are visited in include order.
+			VisitStack.insert(VisitStack.end(), sourceFile.Includes.rbegin(), sourceFile.Includes.rend());
+		}
+		return readable;
+	}
+
+	bool ShaderSourceGraph::HashSourceTree(const std::string_view file, uint64_t& outHash)
+	{
+		uint64_t hash = 0;
+		const bool readable = VisitSourceTree(file, [this, &hash](const uint32_t fileIndex)
+			{
+				hash = HashCombine(hash, HashString(Files[fileIndex].Path));
+				hash = HashCombine(hash, Files[fileIndex].ContentHash);
+			});
+		outHash = hash;
+		return readable;
+	}
+
+	bool ShaderSourceGraph::GetDependencies(const std::string_view file, std::vector<std::string>& outFiles)
+	{
+		bool root = true;
+		return VisitSourceTree(file, [this, &root, &outFiles](const uint32_t fileIndex)
+			{
+				if (!root)
+				{
+					outFiles.push_back(Files[fileIndex].Path);
+				}
+				root = false;
+			});
+	}
+
+	std::string_view ShaderSourceGraph::GetSource(const std::string_view file) const
+	{
+		const auto found = FileIndices.find(ResolveIncludePath({}, file));
+		return (found != FileIndices.end()) ? std::string_view(Files[found->second].Source) : std::string_view();
+	}
+
+	uint64_t ShaderCache::ComputeKey(const uint64_t sourceTreeHash, const ShaderCompileDescription& description)
+	{
+		uint64_t key = HashCombine(PackTag.Version, sourceTreeHash);
+		key = HashCombine(key, HashString(description.EntryPoint));
+		key = HashCombine(key, HashString(description.Target));
+		key = HashCombine(key, description.MacroCount);
+		for (size_t i = 0; i < description.MacroCount; ++i)
+		{
+			const ShaderMacro& macro = description.Macros[i];
+			key = HashCombine(key, HashString((macro.Name != nullptr) ? std::string_view(macro.Name) : std::string_view()));
+			key = HashCombine(key, HashString((macro.Definition != nullptr) ? std::string_view(macro.Definition) : std::string_view()));
+		}
+		return key;
+	}
+
+	bool ShaderCache::Load(const std::string_view packFile)
+	{
+		Clear();
+		std::vector<uint8_t> pack = {};
+		if (!LeviathanCore::Serialize::FileExists(packFile) || !LeviathanCore::Serialize::ReadFile(packFile, true, pack))
+		{
+			return false;
+		}
+
+		ShaderPackHeader header = {};
+		const bool tagged = LeviathanCore::Serialize::ReadFileHeader(pack, PackTag, header);
+		const uint64_t indexEnd = sizeof(ShaderPackHeader) + (static_cast<uint64_t>(header.EntryCount) * sizeof(ShaderPackIndexEntry));
+		if (!tagged || (indexEnd > pack.size()))
+		{
+			LEVIATHAN_LOG("Failed to load shader cache %s. The pack is from another version or truncated.", std::string(packFile).c_str());
+			return false;
+		}
+
+		Entries.reserve(header.EntryCount);
+		for (uint32_t entryIndex = 0; entryIndex < header.EntryCount; ++entryIndex)
+		{
+			ShaderPackIndexEntry entry = {};
+			memcpy(&entry, pack.data() + sizeof(ShaderPackHeader) + (entryIndex * sizeof(ShaderPackIndexEntry)), sizeof(ShaderPackIndexEntry));
+			const bool inBounds = (entry.Offset >= indexEnd) && (entry.Offset <= pack.size()) && (entry.SizeBytes <= pack.size() - entry.Offset);
+			if (!inBounds || (HashBytes(pack.data() + entry.Offset, static_cast<size_t>(entry.SizeBytes)) != entry.Checksum))
+			{
+				LEVIATHAN_LOG("Failed to load shader cache %s. Entry %u is corrupt.", std::string(packFile).c_str(), entryIndex);
+				Clear();
+				return false;
+			}
+			Entries[entry.Key].assign(pack.begin() + static_cast<ptrdiff_t>(entry.Offset), pack.begin() + static_cast<ptrdiff_t>(entry.Offset + entry.SizeBytes));
+		}
+		return true;
+	}
+
+	bool ShaderCache::Save(const std::string_view packFile)
+	{
+		// Entries not used since the last load are dropped so that the pack does not grow with stale shaders.
+		for (auto entry = Entries.begin(); entry != Entries.end();)
+		{
+			entry = (UsedKeys.find(entry->first) != UsedKeys.end()) ? std::next(entry) : Entries.erase(entry);
+		}
+
+		uint64_t sizeBytes = sizeof(ShaderPackHeader) + (Entries.size() * sizeof(ShaderPackIndexEntry));
+		for (const auto& [key, bytecode] : Entries)
+		{
+			sizeBytes += bytecode.size();
+		}
+
+		std::vector<uint8_t> pack(static_cast<size_t>(sizeBytes), 0);
+		ShaderPackHeader header = {};
+		header.Tag = PackTag;
+		header.EntryCount = static_cast<uint32_t>(Entries.size());
+		memcpy(pack.data(), &header, sizeof(ShaderPackHeader));
+
+		uint64_t offset = sizeof(ShaderPackHeader) + (Entries.size() * sizeof(ShaderPackIndexEntry));
+		size_t entryIndex = 0;
+		for (const auto& [key, bytecode] : Entries)
+		{
+			ShaderPackIndexEntry entry = {};
+			entry.Key = key;
+			entry.Offset = offset;
+			entry.SizeBytes = bytecode.size();
+			entry.Checksum = HashBytes(bytecode.data(), bytecode.size());
+			memcpy(pack.data() + sizeof(ShaderPackHeader) + (entryIndex * sizeof(ShaderPackIndexEntry)), &entry, sizeof(ShaderPackIndexEntry));
+			if (!bytecode.empty())
+			{
+				memcpy(pack.data() + offset, bytecode.data(), bytecode.size());
+			}
+			offset += bytecode.size();
+			++entryIndex;
+		}
+
+		if (!LeviathanCore::Serialize::WriteBytesToFile(packFile, pack))
+		{
+			return false;
+		}
+		Dirty = false;
+		return true;
+	}
+
+	void ShaderCache::Clear()
+	{
+		Entries.clear();
+		UsedKeys.clear();
+		Dirty = false;
+	}
+
+	const std::vector<uint8_t>* ShaderCache::Find(const uint64_t key) const
+	{
+		const auto found = Entries.find(key);
+		return (found != Entries.end()) ? &found->second : nullptr;
+	}
+
+	void ShaderCache::Insert(const uint64_t key, std::vector<uint8_t> bytecode)
+	{
+		Entries[key] = std::move(bytecode);
+		UsedKeys.insert(key);
+		Dirty = true;
+	}
+
+	bool ShaderCache::GetOrCompile(ShaderSourceGraph& sources, const ShaderCompileDescription* const descriptions, const size_t count,
+		const ShaderCompileFunctionType compileFunction, void* const userData, std::vector<const std::vector<uint8_t>*>& outBytecode)
+	{
+		static constexpr uint64_t invalidKey = 0;
+
+		// Keys of every description. Misses sharing a key are compiled once.
+		outBytecode.assign(count, nullptr);
+		Keys.resize(count);
+		PendingCompiles.clear();
+		for (size_t i = 0; i < count; ++i)
+		{
+			uint64_t sourceTreeHash = 0;
+			if (!sources.HashSourceTree(descriptions[i].SourceFile, sourceTreeHash))
+			{
+				LEVIATHAN_LOG("Failed to read shader source %s or one of its includes.", std::string(descriptions[i].SourceFile).c_str());
+				++Stats.SourceErrors;
+				Keys[i] = invalidKey;
+				continue;
+			}
+
+			Keys[i] = ComputeKey(sourceTreeHash, descriptions[i]);
+			if (Find(Keys[i]) != nullptr)
+			{
+				UsedKeys.insert(Keys[i]);
+				++Stats.Hits;
+				continue;
+			}
+
+			++Stats.Misses;
+			const uint64_t key = Keys[i];
+			if (std::none_of(PendingCompiles.begin(), PendingCompiles.end(), [key](const PendingCompile& pending) { return pending.Key == key; }))
+			{
+				PendingCompile pending = {};
+				pending.Key = key;
+				pending.Description = i;
+				PendingCompiles.push_back(std::move(pending));
+			}
+		}
+
+		// Compile misses in parallel from the sources read while computing keys. Sources are looked up once every file was read.
+		for (PendingCompile& pending : PendingCompiles)
+		{
+			pending.Source = sources.GetSource(descriptions[pending.Description].SourceFile);
+		}
+		LeviathanCore::JobSystem::ParallelFor(PendingCompiles.size(), 1, [this, descriptions, compileFunction, userData](const size_t first,
+			const size_t rangeCount, [[maybe_unused]] const size_t threadIndex)
+			{
+				for (size_t i = first; i < first + rangeCount; ++i)
+				{
+					PendingCompile& pending = PendingCompiles[i];
+					pending.Compiled = compileFunction(descriptions[pending.Description], pending.Source, pending.Bytecode, userData);
+				}
+			});
+
+		for (PendingCompile& pending : PendingCompiles)
+		{
+			if (!pending.Compiled)
+			{
+				++Stats.CompileFailures;
+				continue;
+			}
+			Insert(pending.Key, std::move(pending.Bytecode));
+		}
+
+		bool success = true;
+		for (size_t i = 0; i < count; ++i)
+		{
+			outBytecode[i] = (Keys[i] != invalidKey) ? Find(Keys[i]) : nullptr;
+			success &= (outBytecode[i] != nullptr);
+		}
+		return success;
+	}
+}
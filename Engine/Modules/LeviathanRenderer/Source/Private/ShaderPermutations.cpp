@@ -0,0 +1,236 @@
+#include "ShaderPermutations.h"
+#include "Logging.h"
+#include "Serialize.h"
+
+namespace LeviathanRenderer
+{
+	// Definitions of every feature value.
+	static constexpr std::array<const char*, 1u << ShaderFeature::MaxBitCount> FeatureValueStrings =
+	{
+		"0", "1", "2", "3", "4", "5", "6", "7", "8", "9", "10", "11", "12", "13", "14", "15"
+	};
+
+	ShaderPermutationSet::ShaderPermutationSet(const std::string_view name, const ShaderCompileDescription& base, const ShaderFeature* const features,
+		const size_t featureCount)
+		: Name(name)
+		, Base(base)
+		, Features(features, features + featureCount)
+	{
+		KeyBitCount = GetShaderFeatureBitOffset(features, featureCount);
+		for (const ShaderFeature& feature : Features)
+		{
+			if ((feature.BitCount == 0) || (feature.BitCount > ShaderFeature::MaxBitCount) || (KeyBitCount > MaxFeatureBits))
+			{
+				LEVIATHAN_LOG("Failed to create shader permutation set %s. Feature %s has an invalid bit count.", Name.c_str(), feature.Name);
+				Features.clear();
+				KeyBitCount = 0;
+				break;
+			}
+		}
+	}
+
+	bool ShaderPermutationSet::IsValidKey(const ShaderPermutationKey key) const
+	{
+		return (KeyBitCount >= MaxFeatureBits) || ((key >> KeyBitCount) == 0);
+	}
+
+	void ShaderPermutationSet::GetMacros(const ShaderPermutationKey key, std::vector<ShaderMacro>& outMacros) const
+	{
+		outMacros.insert(outMacros.end(), Base.Macros, Base.Macros + Base.MacroCount);
+		for (size_t feature = 0; feature < Features.size(); ++feature)
+		{
+			outMacros.push_back(ShaderMacro{ .Name = Features[feature].Name, .Definition = FeatureValueStrings[GetShaderFeature(Features.data(), feature, key)] });
+		}
+	}
+
+	const std::vector<uint8_t>* ShaderPermutationSet::GetPermutation(const ShaderPermutationKey key, ShaderCache& cache, ShaderSourceGraph& sources,
+		const ShaderCompileFunctionType compileFunction, void* const userData)
+	{
+		const auto found = Permutations.find(key);
+		if (found != Permutations.end())
+		{
+			return found->second;
+		}
+		if (!IsValidKey(key))
+		{
+			return nullptr;
+		}
+
+		++Stats.FirstUseLoads;
+		LoadPermutations(&key, 1, cache, sources, compileFunction, userData);
+		return Permutations[key];
+	}
+
+	const std::vector<uint8_t>* ShaderPermutationSet::FindPermutation(const ShaderPermutationKey key)
+	{
+		const auto found = Permutations.find(key);
+		if (found != Permutations.end())
+		{
+			return found->second;
+		}
+
+		if (IsValidKey(key) && MissedKeys.insert(key).second)
+		{
+			++Stats.MissedPermutations;
+		}
+		return nullptr;
+	}
+
+	bool ShaderPermutationSet::Prewarm(const ShaderPermutationKey* const keys, const size_t count, ShaderCache& cache, ShaderSourceGraph& sources,
+		const ShaderCompileFunctionType compileFunction, void* const userData)
+	{
+		const bool success = LoadPermutations(keys, count, cache, sources, compileFunction, userData);
+		Stats.PrewarmedPermutations += PendingKeys.size();
+		return success;
+	}
+
+	bool ShaderPermutationSet::LoadPermutations(const ShaderPermutationKey* const keys, const size_t count, ShaderCache& cache, ShaderSourceGraph& sources,
+		const ShaderCompileFunctionType compileFunction, void* const userData)
+	{
+		PendingKeys.clear();
+		for (size_t i = 0; i < count; ++i)
+		{
+			if (IsValidKey(keys[i]) && !Permutations.contains(keys[i]))
+			{
+				PendingKeys.push_back(keys[i]);
+			}
+		}
+		std::sort(PendingKeys.begin(), PendingKeys.end());
+		PendingKeys.erase(std::unique(PendingKeys.begin(), PendingKeys.end()), PendingKeys.end());
+		if (PendingKeys.empty())
+		{
+			return true;
+		}
+
+		// Macros of every permutation are built before descriptions point into them.
+		const size_t macroCount = Base.MacroCount + Features.size();
+		PendingMacros.clear();
+		PendingMacros.reserve(PendingKeys.size() * macroCount);
+		for (const ShaderPermutationKey key : PendingKeys)
+		{
+			GetMacros(key, PendingMacros);
+		}
+		PendingDescriptions.resize(PendingKeys.size());
+		for (size_t i = 0; i < PendingKeys.size(); ++i)
+		{
+			PendingDescriptions[i] = Base;
+			PendingDescriptions[i].Macros = PendingMacros.data() + (i * macroCount);
+			PendingDescriptions[i].MacroCount = macroCount;
+		}
+
+		const bool success = cache.GetOrCompile(sources, PendingDescriptions.data(), PendingDescriptions.size(), compileFunction, userData, PendingBytecode);
+		for (size_t i = 0; i < PendingKeys.size(); ++i)
+		{
+			Permutations[PendingKeys[i]] = PendingBytecode[i];
+			Stats.Failures += (PendingBytecode[i] == nullptr) ? 1 : 0;
+		}
+		return success;
+	}
+
+	void ShaderPermutationSet::GetResidentKeys(std::vector<ShaderPermutationKey>& outKeys) const
+	{
+		const size_t first = outKeys.size();
+		for (const auto& [key, bytecode] : Permutations)
+		{
+			if (bytecode != nullptr)
+			{
+				outKeys.push_back(key);
+			}
+		}
+		std::sort(outKeys.begin() + static_cast<ptrdiff_t>(first), outKeys.end());
+	}
+
+	void ShaderPermutationSet::GetUsedKeys(std::vector<ShaderPermutationKey>& outKeys) const
+	{
+		const size_t first = outKeys.size();
+		GetResidentKeys(outKeys);
+		outKeys.insert(outKeys.end(), MissedKeys.begin(), MissedKeys.end());
+		std::sort(outKeys.begin() + static_cast<ptrdiff_t>(first), outKeys.end());
+		outKeys.erase(std::unique(outKeys.begin() + static_cast<ptrdiff_t>(first), outKeys.end()), outKeys.end());
+	}
+
+	void ShaderPermutationSet::ClearPermutations()
+	{
+		Permutations.clear();
+		MissedKeys.clear();
+	}
+
+	bool SaveShaderUsageList(const std::string_view file, const ShaderPermutationSet* const* const sets, const size_t setCount)
+	{
+		std::string list = {};
+		std::vector<ShaderPermutationKey> keys = {};
+		for (size_t i = 0; i < setCount; ++i)
+		{
+			keys.clear();
+			sets[i]->GetUsedKeys(keys);
+			for (const ShaderPermutationKey key : keys)
+			{
+				list.append(sets[i]->GetName()).append(" ").append(std::to_string(key)).append("\n");
+			}
+		}
+
+		const std::vector<uint8_t> bytes(list.begin(), list.end());
+		return LeviathanCore::Serialize::WriteBytesToFile(file, bytes);
+	}
+
+	bool LoadShaderUsageList(const std::string_view file, std::vector<ShaderUsageRecord>& outRecords)
+	{
+		std::vector<uint8_t> bytes = {};
+		if (!LeviathanCore::Serialize::FileExists(file) || !LeviathanCore::Serialize::ReadFile(file, true, bytes))
+		{
+			return false;
+		}
+
+		const std::string_view list(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+		size_t lineStart = 0;
+		while (lineStart < list.size())
+		{
+			size_t lineEnd = list.find('\n', lineStart);
+			lineEnd = (lineEnd == std::string_view::npos) ? list.size() : lineEnd;
+			std::string_view line = list.substr(lineStart, lineEnd - lineStart);
+			lineStart = lineEnd + 1;
+			if (!line.empty() && (line.back() == '\r'))
+			{
+				line.remove_suffix(1);
+			}
+
+			// Set name, a space and the decimal key.
+			const size_t separator = line.rfind(' ');
+			if ((separator == std::string_view::npos) || (separator == 0) || (separator + 1 == line.size()))
+			{
+				continue;
+			}
+			uint64_t key = 0;
+			bool valid = true;
+			for (const char c : line.substr(separator + 1))
+			{
+				valid &= (c >= '0') && (c <= '9');
+				key = (key * 10) + static_cast<uint64_t>(c - '0');
+				valid &= (key <= std::numeric_limits<ShaderPermutationKey>::max());
+				if (!valid)
+				{
+					break;
+				}
+			}
+			if (valid)
+			{
+				outRecords.push_back(ShaderUsageRecord{ std::string(line.substr(0, separator)), static_cast<ShaderPermutationKey>(key) });
+			}
+		}
+		return true;
+	}
+
+	bool PrewarmFromUsageList(ShaderPermutationSet& set, const std::vector<ShaderUsageRecord>& records, ShaderCache& cache, ShaderSourceGraph& sources,
+		const ShaderCompileFunctionType compileFunction, void* const userData)
+	{
+		std::vector<ShaderPermutationKey> keys = {};
+		for (const ShaderUsageRecord& record : records)
+		{
+			if (record.Set == set.GetName())
+			{
+				keys.push_back(record.Key);
+			}
+		}
+		return set.Prewarm(keys.data(), keys.size(), cache, sources, compileFunction, userData);
+	}
+}
@@ -0,0 +1,421 @@
+#include "TextureStreaming.h"
+#include "LevelOfDetail.h"
+#include "JobSystem.h"
+
+namespace LeviathanRenderer
+{
+	float GetTextureMipDemand(const Camera& view, const LeviathanCore::BoundingVolumes::Sphere& worldBounds, const float texelsPerWorldUnit,
+		const float viewportHeight)
+	{
+		const float pixelsPerWorldUnit = GetProjectedSize(view, worldBounds, 1.0f, viewportHeight);
+		if ((pixelsPerWorldUnit <= 0.0f) || (texelsPerWorldUnit <= 0.0f))
+		{
+			return std::numeric_limits<float>::max();
+		}
+		return std::log2(texelsPerWorldUnit / pixelsPerWorldUnit);
+	}
+
+	TextureStreamer::TextureStreamer(const TextureStreamingSettings& settings)
+		: Settings(settings)
+	{
+	}
+
+	void TextureStreamer::SetSettings(const TextureStreamingSettings& settings)
+	{
+		Settings = settings;
+	}
+
+	StreamedTextureId TextureStreamer::Register(const uint32_t width, const uint32_t height, const uint32_t mipCount, const uint32_t bytesPerPixel)
+	{
+		if ((width == 0) || (height == 0) || (mipCount == 0) || (mipCount > MaxMipCount) || (bytesPerPixel == 0))
+		{
+			return InvalidStreamedTextureId;
+		}
+
+		StreamedTextureId id = InvalidStreamedTextureId;
+		if (!FreeIds.empty())
+		{
+			id = FreeIds.back();
+			FreeIds.pop_back();
+		}
+		else
+		{
+			id = static_cast<StreamedTextureId>(Textures.size());
+			Textures.emplace_back();
+		}
+
+		StreamedTexture& texture = Textures[id];
+		texture = {};
+		texture.Registered = true;
+		texture.MipCount = mipCount;
+		texture.ChainBytes[mipCount] = 0;
+		for (uint32_t mip = mipCount; mip > 0; --mip)
+		{
+			const size_t mipWidth = std::max(width >> (mip - 1), 1u);
+			const size_t mipHeight = std::max(height >> (mip - 1), 1u);
+			texture.ChainBytes[mip - 1] = texture.ChainBytes[mip] + (mipWidth * mipHeight * bytesPerPixel);
+		}
+
+		texture.TailMip = mipCount - 1;
+		while ((texture.TailMip > 0) && (std::max(width >> (texture.TailMip - 1), 1u) <= Settings.TailSize) &&
+			(std::max(height >> (texture.TailMip - 1), 1u) <= Settings.TailSize))
+		{
+			--texture.TailMip;
+		}
+		texture.ResidentMip = texture.TailMip;
+		texture.LoadingMip = texture.TailMip;
+		texture.TargetMip = texture.TailMip;
+		ResidentBytes += texture.ChainBytes[texture.TailMip];
+		Stats.ResidentBytes = ResidentBytes;
+		return id;
+	}
+
+	void TextureStreamer::Unregister(StreamedTextureId& texture)
+	{
+		if (IsValid(texture))
+		{
+			ResidentBytes -= Textures[texture].ChainBytes[Textures[texture].LoadingMip];
+			Stats.ResidentBytes = ResidentBytes;
+			Textures[texture] = {};
+			FreeIds.push_back(texture);
+		}
+		texture = InvalidStreamedTextureId;
+	}
+
+	void TextureStreamer::PlanUpdate()
+	{
+		Operations.clear();
+
+		// Hold each texture's finest demand for the hysteresis window. Textures without demand target their tail once the window passed.
+		size_t targetBytes = 0;
+		for (StreamedTexture& texture : Textures)
+		{
+			if (!texture.Registered)
+			{
+				continue;
+			}
+
+			uint32_t demandedMip = texture.TailMip;
+			if (texture.Demand != std::numeric_limits<float>::max())
+			{
+				texture.LastDemandUpdate = UpdateIndex;
+				const float mip = std::floor(texture.Demand + Settings.MipBias);
+				demandedMip = (mip <= 0.0f) ? 0 : static_cast<uint32_t>(std::min(mip, static_cast<float>(texture.TailMip)));
+			}
+
+			if ((demandedMip <= texture.TargetMip) || (UpdateIndex - texture.TargetUpdate >= Settings.HysteresisUpdates))
+			{
+				texture.TargetMip = demandedMip;
+				texture.TargetUpdate = UpdateIndex;
+			}
+			targetBytes += texture.ChainBytes[texture.TargetMip];
+		}
+
+		// Bias every target coarser until the targets fit the pool. Tails are never biased away, so the targets of textures whose tails alone exceed
+		// the pool stop at their tails.
+		uint32_t bias = 0;
+		size_t budgetedBytes = targetBytes;
+		while ((budgetedBytes > Settings.PoolBytes) && (bias < MaxMipCount))
+		{
+			++bias;
+			budgetedBytes = 0;
+			for (const StreamedTexture& texture : Textures)
+			{
+				if (texture.Registered)
+				{
+					budgetedBytes += texture.ChainBytes[std::min(texture.TargetMip + bias, texture.TailMip)];
+				}
+			}
+		}
+
+		BudgetedMips.resize(Textures.size());
+		StreamInOrder.clear();
+		EvictionOrder.clear();
+		for (StreamedTextureId id = 0; id < Textures.size(); ++id)
+		{
+			const StreamedTexture& texture = Textures[id];
+			if (!texture.Registered)
+			{
+				continue;
+			}
+
+			BudgetedMips[id] = std::min(texture.TargetMip + bias, texture.TailMip);
+
+			// Textures wait for their loading stream in before streaming further.
+			if (IsLoading(id))
+			{
+				continue;
+			}
+			if (texture.ResidentMip > BudgetedMips[id])
+			{
+				StreamInOrder.push_back(id);
+			}
+			else if (texture.ResidentMip < BudgetedMips[id])
+			{
+				EvictionOrder.push_back(id);
+			}
+		}
+
+		// Most recently demanded textures missing the most mips stream in first. Least recently demanded textures are evicted first.
+		std::sort(StreamInOrder.begin(), StreamInOrder.end(), [this](const StreamedTextureId a, const StreamedTextureId b)
+			{
+				const StreamedTexture& textureA = Textures[a];
+				const StreamedTexture& textureB = Textures[b];
+				if (textureA.LastDemandUpdate != textureB.LastDemandUpdate)
+				{
+					return textureA.LastDemandUpdate > textureB.LastDemandUpdate;
+				}
+				const uint32_t missingA = textureA.ResidentMip - BudgetedMips[a];
+				const uint32_t missingB = textureB.ResidentMip - BudgetedMips[b];
+				return (missingA != missingB) ? (missingA > missingB) : (a < b);
+			});
+		std::sort(EvictionOrder.begin(), EvictionOrder.end(), [this](const StreamedTextureId a, const StreamedTextureId b)
+			{
+				const uint64_t lastDemandA = Textures[a].LastDemandUpdate;
+				const uint64_t lastDemandB = Textures[b].LastDemandUpdate;
+				return (lastDemandA != lastDemandB) ? (lastDemandA < lastDemandB) : (a < b);
+			});
+
+		size_t streamInBytesRemaining = (Settings.MaxStreamInBytesPerUpdate > 0) ? Settings.MaxStreamInBytesPerUpdate : std::numeric_limits<size_t>::max();
+		size_t evicted = 0;
+		bool streamedIn = false;
+		for (const StreamedTextureId id : StreamInOrder)
+		{
+			StreamedTexture& texture = Textures[id];
+			const size_t residentChainBytes = texture.ChainBytes[texture.ResidentMip];
+
+			// Coarse mips first. Textures after the first one that does not fit the stream in limit wait for the next update so that they keep their
+			// order.
+			uint32_t firstMip = BudgetedMips[id];
+			while ((firstMip < texture.ResidentMip) && (texture.ChainBytes[firstMip] - residentChainBytes > streamInBytesRemaining))
+			{
+				++firstMip;
+			}
+			if (firstMip == texture.ResidentMip)
+			{
+				if (streamedIn)
+				{
+					break;
+				}
+				firstMip = texture.ResidentMip - 1;
+			}
+
+			const size_t bytes = texture.ChainBytes[firstMip] - residentChainBytes;
+			while ((ResidentBytes + bytes > Settings.PoolBytes) && (evicted < EvictionOrder.size()))
+			{
+				const StreamedTextureId evictedId = EvictionOrder[evicted++];
+				StreamedTexture& evictedTexture = Textures[evictedId];
+				Operations.push_back(Operation{ .Texture = evictedId, .FirstMip = BudgetedMips[evictedId], .PreviousMip = evictedTexture.ResidentMip, .StreamIn = false });
+				ResidentBytes -= evictedTexture.ChainBytes[evictedTexture.ResidentMip] - evictedTexture.ChainBytes[BudgetedMips[evictedId]];
+				evictedTexture.ResidentMip = BudgetedMips[evictedId];
+				evictedTexture.LoadingMip = BudgetedMips[evictedId];
+			}
+			if (ResidentBytes + bytes > Settings.PoolBytes)
+			{
+				// Only reached when the tails exceed the pool.
+				continue;
+			}
+
+			Operations.push_back(Operation{ .Texture = id, .FirstMip = firstMip, .PreviousMip = texture.ResidentMip, .StreamIn = true });
+			ResidentBytes += bytes;
+			texture.ResidentMip = firstMip;
+			texture.LoadingMip = firstMip;
+			streamInBytesRemaining -= std::min(bytes, streamInBytesRemaining);
+			streamedIn = true;
+		}
+
+		Stats.TargetBytes = targetBytes;
+		Stats.BudgetMipBias = bias;
+	}
+
+	void TextureStreamer::CompleteStreamIn(const StreamedTextureId texture, const uint32_t firstMip)
+	{
+		if (!IsValid(texture) || !IsLoading(texture) || (Textures[texture].LoadingMip != firstMip))
+		{
+			return;
+		}
+
+		StreamedTexture& streamedTexture = Textures[texture];
+		Stats.StreamedInMips += streamedTexture.ResidentMip - firstMip;
+		Stats.StreamedInBytes += streamedTexture.ChainBytes[firstMip] - streamedTexture.ChainBytes[streamedTexture.ResidentMip];
+		streamedTexture.ResidentMip = firstMip;
+	}
+
+	void TextureStreamer::RevertStreamIn(const StreamedTextureId texture, const uint32_t firstMip, const uint32_t previousMip)
+	{
+		if (!IsValid(texture) || (firstMip >= previousMip) || (Textures[texture].LoadingMip != firstMip) || (previousMip > Textures[texture].TailMip))
+		{
+			return;
+		}
+
+		StreamedTexture& streamedTexture = Textures[texture];
+		const bool loading = IsLoading(texture);
+		if (loading && (streamedTexture.ResidentMip != previousMip))
+		{
+			return;
+		}
+
+		// Loaded stream ins were counted by their Update.
+		const size_t bytes = streamedTexture.ChainBytes[firstMip] - streamedTexture.ChainBytes[previousMip];
+		if (!loading)
+		{
+			Stats.StreamedInMips -= std::min<uint64_t>(previousMip - firstMip, Stats.StreamedInMips);
+			Stats.StreamedInBytes -= std::min<uint64_t>(bytes, Stats.StreamedInBytes);
+		}
+		streamedTexture.ResidentMip = previousMip;
+		streamedTexture.LoadingMip = previousMip;
+		ResidentBytes -= bytes;
+		++Stats.FailedStreamIns;
+		Stats.ResidentBytes = ResidentBytes;
+	}
+
+	void TextureStreamer::CompleteUpdate()
+	{
+		for (size_t i = 0; i < Operations.size(); ++i)
+		{
+			const Operation& operation = Operations[i];
+			StreamedTexture& texture = Textures[operation.Texture];
+			const size_t bytes = (operation.StreamIn) ? (texture.ChainBytes[operation.FirstMip] - texture.ChainBytes[operation.PreviousMip]) :
+				(texture.ChainBytes[operation.PreviousMip] - texture.ChainBytes[operation.FirstMip]);
+			if (!operation.StreamIn)
+			{
+				Stats.EvictedMips += operation.FirstMip - operation.PreviousMip;
+				Stats.EvictedBytes += bytes;
+			}
+			else if (OperationResults[i] == StreamInResult::Loaded)
+			{
+				Stats.StreamedInMips += operation.PreviousMip - operation.FirstMip;
+				Stats.StreamedInBytes += bytes;
+			}
+			else if (OperationResults[i] == StreamInResult::Loading)
+			{
+				// The mips stay reserved in the pool.
+				texture.ResidentMip = operation.PreviousMip;
+			}
+			else
+			{
+				texture.ResidentMip = operation.PreviousMip;
+				texture.LoadingMip = operation.PreviousMip;
+				ResidentBytes -= bytes;
+				++Stats.FailedStreamIns;
+			}
+		}
+
+		uint32_t waitingTextures = 0;
+		for (StreamedTextureId id = 0; id < Textures.size(); ++id)
+		{
+			StreamedTexture& texture = Textures[id];
+			if (texture.Registered)
+			{
+				waitingTextures += (texture.ResidentMip > BudgetedMips[id]) ? 1 : 0;
+				texture.Demand = std::numeric_limits<float>::max();
+			}
+		}
+		Stats.WaitingTextures = waitingTextures;
+		Stats.ResidentBytes = ResidentBytes;
+		++UpdateIndex;
+	}
+
+	struct TextureMipReader::Job
+	{
+		TextureMipRead Read = {};
+		ReadCallbackType ReadMips = nullptr;
+		void* UserData = nullptr;
+		std::atomic<bool> Finished = false;
+	};
+
+	static void WaitForMipRead(const std::atomic<bool>& finished)
+	{
+		while (!finished.load(std::memory_order_acquire))
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	TextureMipReader::~TextureMipReader()
+	{
+		Clear();
+		for (Job* job : FreeJobs)
+		{
+			delete job;
+		}
+	}
+
+	void TextureMipReader::Read(const StreamedTextureId texture, const uint32_t firstMip, const uint32_t previousMip, const ReadCallbackType readMips,
+		void* const userData)
+	{
+		Job* job = nullptr;
+		if (!FreeJobs.empty())
+		{
+			job = FreeJobs.back();
+			FreeJobs.pop_back();
+		}
+		else
+		{
+			job = new Job();
+		}
+
+		job->Read.Texture = texture;
+		job->Read.FirstMip = firstMip;
+		job->Read.PreviousMip = previousMip;
+		job->Read.Read = false;
+		job->ReadMips = readMips;
+		job->UserData = userData;
+		job->Finished.store(false, std::memory_order_relaxed);
+		Jobs.push_back(job);
+
+		LeviathanCore::JobSystem::RunInBackground([](void* jobData)
+			{
+				Job& job = *static_cast<Job*>(jobData);
+				job.Read.Read = (job.Read.FirstMip < job.Read.PreviousMip) &&
+					job.ReadMips(job.Read.FirstMip, job.Read.PreviousMip - job.Read.FirstMip, job.Read.MipData, job.UserData);
+				job.Finished.store(true, std::memory_order_release);
+			}, job);
+	}
+
+	void TextureMipReader::CollectFinished(const CollectCallbackType callback, void* const userData)
+	{
+		size_t runningCount = 0;
+		for (Job* job : Jobs)
+		{
+			if (job->Finished.load(std::memory_order_acquire))
+			{
+				callback(job->Read, userData);
+				FreeJobs.push_back(job);
+			}
+			else
+			{
+				Jobs[runningCount++] = job;
+			}
+		}
+		Jobs.resize(runningCount);
+	}
+
+	void TextureMipReader::Cancel(const StreamedTextureId texture)
+	{
+		size_t keptCount = 0;
+		for (Job* job : Jobs)
+		{
+			if (job->Read.Texture == texture)
+			{
+				WaitForMipRead(job->Finished);
+				FreeJobs.push_back(job);
+			}
+			else
+			{
+				Jobs[keptCount++] = job;
+			}
+		}
+		Jobs.resize(keptCount);
+	}
+
+	void TextureMipReader::Clear()
+	{
+		for (Job* job : Jobs)
+		{
+			WaitForMipRead(job->Finished);
+			FreeJobs.push_back(job);
+		}
+		Jobs.clear();
+	}
+}
@@ -0,0 +1,239 @@
+#include "UploadQueue.h"
+
+namespace LeviathanRenderer
+{
+	static void ReportUpload(const UploadCompletedCallbackType callback, void* const userData, const UploadResult& result)
+	{
+		if (callback != nullptr)
+		{
+			callback(result, userData);
+		}
+	}
+
+	UploadQueue::UploadQueue(const size_t budgetBytesPerFrame)
+		: BudgetBytesPerFrame(budgetBytesPerFrame)
+	{
+	}
+
+	void UploadQueue::SetBudget(const size_t budgetBytesPerFrame)
+	{
+		BudgetBytesPerFrame = budgetBytesPerFrame;
+	}
+
+	UploadTicket UploadQueue::EnqueueVertexBuffer(const void* const vertexData, const uint32_t vertexCount, const size_t strideBytes,
+		const UploadDescription& description)
+	{
+		if ((vertexData == nullptr) || (vertexCount == 0) || (strideBytes == 0))
+		{
+			return InvalidTicket;
+		}
+
+		const uint8_t* const bytes = static_cast<const uint8_t*>(vertexData);
+		return Enqueue(Upload{ .Type = UploadResourceType::VertexBuffer, .Count = vertexCount, .StrideBytes = strideBytes,
+			.Data = std::vector<uint8_t>(bytes, bytes + (vertexCount * strideBytes)) }, description);
+	}
+
+	UploadTicket UploadQueue::EnqueueIndexBuffer(const uint32_t* const indexData, const uint32_t indexCount, const UploadDescription& description)
+	{
+		if ((indexData == nullptr) || (indexCount == 0))
+		{
+			return InvalidTicket;
+		}
+
+		const uint8_t* const bytes = reinterpret_cast<const uint8_t*>(indexData);
+		return Enqueue(Upload{ .Type = UploadResourceType::IndexBuffer, .Count = indexCount, .StrideBytes = sizeof(uint32_t),
+			.Data = std::vector<uint8_t>(bytes, bytes + (indexCount * sizeof(uint32_t))) }, description);
+	}
+
+	UploadTicket UploadQueue::EnqueueTexture2D(const uint32_t width, const uint32_t height, const void* const data, const uint32_t rowSizeBytes,
+		const bool sRGB, const bool HDR, const bool generateMipmaps, const UploadDescription& description)
+	{
+		if ((data == nullptr) || (width == 0) || (height == 0) || (rowSizeBytes == 0))
+		{
+			return InvalidTicket;
+		}
+
+		const uint8_t* const bytes = static_cast<const uint8_t*>(data);
+		return Enqueue(Upload{ .Type = UploadResourceType::Texture2D, .sRGB = sRGB, .HDR = HDR, .GenerateMipmaps = generateMipmaps, .Count = width,
+			.Height = height, .StrideBytes = rowSizeBytes, .Data = std::vector<uint8_t>(bytes, bytes + (static_cast<size_t>(rowSizeBytes) * height)) },
+			description);
+	}
+
+	UploadTicket UploadQueue::EnqueueTextureCube(const uint32_t faceWidth, const void* const* const faceData, const bool sRGB, const bool HDR,
+		const bool halfFloat, const UploadDescription& description)
+	{
+		if ((faceData == nullptr) || (faceWidth == 0))
+		{
+			return InvalidTicket;
+		}
+
+		// Faces are staged back to back.
+		const uint32_t bytesPerPixel = (HDR) ? ((halfFloat) ? HalfFloatTextureCubeBytesPerPixel : HDRTextureCubeBytesPerPixel) : TextureCubeBytesPerPixel;
+		const size_t faceSizeBytes = static_cast<size_t>(faceWidth) * faceWidth * bytesPerPixel;
+		Upload upload = { .Type = UploadResourceType::TextureCube, .sRGB = sRGB, .HDR = HDR, .HalfFloat = (HDR && halfFloat), .Count = faceWidth, .Height = faceWidth,
+			.StrideBytes = faceWidth * bytesPerPixel };
+		upload.Data.resize(faceSizeBytes * TextureCubeFaceCount);
+		for (size_t face = 0; face < TextureCubeFaceCount; ++face)
+		{
+			if (faceData[face] == nullptr)
+			{
+				return InvalidTicket;
+			}
+			memcpy(upload.Data.data() + (face * faceSizeBytes), faceData[face], faceSizeBytes);
+		}
+		return Enqueue(std::move(upload), description);
+	}
+
+	UploadTicket UploadQueue::EnqueueTexture2DMips(const RendererResourceId::IdType id, const uint32_t width, const uint32_t height, const uint32_t mipCount,
+		const void* const loadedMipData, const uint32_t loadedMipCount, const UploadDescription& description)
+	{
+		if ((id == RendererResourceId::InvalidId) || (width == 0) || (height == 0) || (mipCount == 0) || (mipCount > MaxTexture2DMipCount) ||
+			(loadedMipCount > mipCount) || ((loadedMipCount > 0) && (loadedMipData == nullptr)))
+		{
+			return InvalidTicket;
+		}
+
+		size_t sizeBytes = 0;
+		for (uint32_t mip = 0; mip < loadedMipCount; ++mip)
+		{
+			sizeBytes += GetMipSizeBytes(width, height, mip);
+		}
+		const uint8_t* const bytes = static_cast<const uint8_t*>(loadedMipData);
+		return Enqueue(Upload{ .Type = UploadResourceType::Texture2DMips, .Count = width, .Height = height,
+			.StrideBytes = static_cast<size_t>(width) * Texture2DMipsBytesPerPixel, .Resource = id, .MipCount = mipCount, .LoadedMipCount = loadedMipCount,
+			.Data = std::vector<uint8_t>(bytes, bytes + sizeBytes) }, description);
+	}
+
+	UploadTicket UploadQueue::Enqueue(Upload&& upload, const UploadDescription& description)
+	{
+		upload.Priority = description.Priority;
+		upload.Callback = description.Callback;
+		upload.UserData = description.UserData;
+
+		std::lock_guard<std::mutex> lock(RequestMutex);
+		upload.Ticket = NextTicket++;
+		const UploadTicket ticket = upload.Ticket;
+		Requests.push_back(std::move(upload));
+		return ticket;
+	}
+
+	bool UploadQueue::Cancel(const UploadTicket ticket)
+	{
+		Upload cancelled = {};
+		const auto isTicket = [ticket](const Upload& upload) { return upload.Ticket == ticket; };
+		auto found = std::find_if(Pending.begin(), Pending.end(), isTicket);
+		if (found != Pending.end())
+		{
+			PendingBytes -= found->Data.size();
+			cancelled = std::move(*found);
+			Pending.erase(found);
+		}
+		else
+		{
+			std::lock_guard<std::mutex> lock(RequestMutex);
+			found = std::find_if(Requests.begin(), Requests.end(), isTicket);
+			if (found == Requests.end())
+			{
+				return false;
+			}
+			cancelled = std::move(*found);
+			Requests.erase(found);
+			++Stats.Requests;
+		}
+
+		++Stats.Cancelled;
+		Stats.PendingBytes = PendingBytes;
+		ReportUpload(cancelled.Callback, cancelled.UserData, UploadResult{ .Ticket = cancelled.Ticket, .Type = cancelled.Type,
+			.Status = UploadStatus::Cancelled, .ResourceId = RendererResourceId::InvalidId });
+		return true;
+	}
+
+	void UploadQueue::ScheduleFrame(const size_t budgetBytes)
+	{
+		// Requests have increasing tickets and are appended after the pending uploads, so a stable sort by priority keeps request order within a
+		// priority.
+		const size_t firstRequest = Pending.size();
+		{
+			std::lock_guard<std::mutex> lock(RequestMutex);
+			Stats.Requests += Requests.size();
+			for (Upload& request : Requests)
+			{
+				PendingBytes += request.Data.size();
+				Pending.push_back(std::move(request));
+			}
+			Requests.clear();
+		}
+		if (Pending.size() > firstRequest)
+		{
+			std::stable_sort(Pending.begin(), Pending.end(), [](const Upload& a, const Upload& b) { return a.Priority > b.Priority; });
+		}
+
+		size_t frameBytes = 0;
+		size_t scheduledCount = 0;
+		for (; scheduledCount < Pending.size(); ++scheduledCount)
+		{
+			const size_t sizeBytes = Pending[scheduledCount].Data.size();
+			const bool firstUpload = (scheduledCount == 0);
+			if (!firstUpload && ((sizeBytes > budgetBytes) || (frameBytes > budgetBytes - sizeBytes)))
+			{
+				break;
+			}
+			Stats.OversizedUploads += ((budgetBytes > 0) && (sizeBytes > budgetBytes)) ? 1 : 0;
+			frameBytes += sizeBytes;
+			if (frameBytes >= budgetBytes)
+			{
+				++scheduledCount;
+				break;
+			}
+		}
+
+		FrameUploads.clear();
+		FrameUploads.insert(FrameUploads.end(), std::make_move_iterator(Pending.begin()), std::make_move_iterator(Pending.begin() + scheduledCount));
+		Pending.erase(Pending.begin(), Pending.begin() + scheduledCount);
+		PendingBytes -= frameBytes;
+		Stats.LastFrameUploads = static_cast<uint32_t>(scheduledCount);
+		Stats.LastFrameBytes = frameBytes;
+		Stats.PendingBytes = PendingBytes;
+	}
+
+	void UploadQueue::CompleteFrame()
+	{
+		for (size_t i = 0; i < FrameUploads.size(); ++i)
+		{
+			const UploadResult& result = FrameResults[i];
+			if (result.Status == UploadStatus::Created)
+			{
+				++Stats.Created;
+				Stats.CreatedBytes += FrameUploads[i].Data.size();
+			}
+			else
+			{
+				++Stats.Failed;
+			}
+			ReportUpload(FrameUploads[i].Callback, FrameUploads[i].UserData, result);
+		}
+		FrameUploads.clear();
+		FrameResults.clear();
+	}
+
+	void UploadQueue::Clear()
+	{
+		std::vector<Upload> cancelled = std::move(Pending);
+		Pending.clear();
+		PendingBytes = 0;
+		{
+			std::lock_guard<std::mutex> lock(RequestMutex);
+			Stats.Requests += Requests.size();
+			cancelled.insert(cancelled.end(), std::make_move_iterator(Requests.begin()), std::make_move_iterator(Requests.end()));
+			Requests.clear();
+		}
+
+		Stats.Cancelled += cancelled.size();
+		Stats.PendingBytes = 0;
+		for (const Upload& upload : cancelled)
+		{
+			ReportUpload(upload.Callback, upload.UserData, UploadResult{ .Ticket = upload.Ticket, .Type = upload.Type, .Status = UploadStatus::Cancelled,
+				.ResourceId = RendererResourceId::InvalidId });
+		}
+	}
+}
@@ -0,0 +1,94 @@
+#include "UploadRing.h"
+
+namespace LeviathanRenderer
+{
+	bool UploadRing::Initialize(const size_t capacityBytes, const size_t alignmentBytes, const size_t maxFramesInFlight)
+	{
+		if ((alignmentBytes == 0) || ((alignmentBytes & (alignmentBytes - 1)) != 0))
+		{
+			return false;
+		}
+
+		if ((capacityBytes == 0) || ((capacityBytes % alignmentBytes) != 0) || (maxFramesInFlight == 0))
+		{
+			return false;
+		}
+
+		CapacityBytes = capacityBytes;
+		AlignmentBytes = alignmentBytes;
+		MaxFramesInFlight = maxFramesInFlight;
+		FramesInFlight.reserve(maxFramesInFlight);
+		Reset();
+		return true;
+	}
+
+	void UploadRing::Reset()
+	{
+		Head = 0;
+		Tail = 0;
+		FrameOpen = false;
+		FramesInFlight.clear();
+		FailedAllocationCount = 0;
+	}
+
+	bool UploadRing::BeginFrame()
+	{
+		if ((FrameOpen) || (FramesInFlight.size() >= MaxFramesInFlight))
+		{
+			return false;
+		}
+
+		FrameOpen = true;
+		return true;
+	}
+
+	size_t UploadRing::Allocate(const size_t sizeBytes)
+	{
+		if ((!FrameOpen) || (sizeBytes == 0) || (sizeBytes > CapacityBytes))
+		{
+			++FailedAllocationCount;
+			return InvalidOffset;
+		}
+
+		// Head is always aligned as sizes are rounded up and the capacity is a multiple of the alignment.
+		const size_t alignedSizeBytes = (sizeBytes + AlignmentBytes - 1) & ~(AlignmentBytes - 1);
+		uint64_t position = Head;
+		size_t offset = static_cast<size_t>(position % CapacityBytes);
+		if (offset + alignedSizeBytes > CapacityBytes)
+		{
+			position += CapacityBytes - offset;
+			offset = 0;
+		}
+
+		if (position + alignedSizeBytes - Tail > CapacityBytes)
+		{
+			++FailedAllocationCount;
+			return InvalidOffset;
+		}
+
+		Head = position + alignedSizeBytes;
+		return offset;
+	}
+
+	void UploadRing::EndFrame(const uint64_t fenceValue)
+	{
+		if (!FrameOpen)
+		{
+			return;
+		}
+
+		FrameOpen = false;
+		FramesInFlight.push_back(Frame{ fenceValue, Head });
+	}
+
+	void UploadRing::Retire(const uint64_t completedFenceValue)
+	{
+		size_t retiredCount = 0;
+		while ((retiredCount < FramesInFlight.size()) && (FramesInFlight[retiredCount].Fence <= completedFenceValue))
+		{
+			Tail = FramesInFlight[retiredCount].End;
+			++retiredCount;
+		}
+		FramesInFlight.erase(FramesInFlight.begin(), FramesInFlight.begin() + retiredCount);
+	}
+}
@@ -0,0 +1,99 @@
+#include "VisibilityCulling.h"
+#include "JobSystem.h"
+
+namespace LeviathanRenderer
+{
+	// Number of renderables tested per batched intersection call.
+	static constexpr size_t TestBlockSize = 256;
+
+	// Tests the renderables in [first, first + count) and writes the indices of visible renderables to outIndices. outIndices must have room for count
+	// indices. Returns the number of visible renderables.
+	template <typename TestFunction>
+	static size_t CullRange(const TestFunction& test, const size_t first, const size_t count, uint32_t* outIndices)
+	{
+		std::array<uint8_t, TestBlockSize> results = {};
+		size_t visibleCount = 0;
+		const size_t end = first + count;
+		for (size_t blockFirst = first; blockFirst < end; blockFirst += TestBlockSize)
+		{
+			const size_t blockCount = std::min(TestBlockSize, end - blockFirst);
+			test(blockFirst, blockCount, results.data());
+
+			// Branchless compaction. The index of a culled renderable is overwritten by the next renderable.
+			for (size_t i = 0; i < blockCount; ++i)
+			{
+				outIndices[visibleCount] = static_cast<uint32_t>(blockFirst + i);
+				visibleCount += results[i];
+			}
+		}
+		return visibleCount;
+	}
+
+	template <typename TestFunction>
+	void FrustumCullingStage::CullWithTest(const size_t count, const TestFunction& test)
+	{
+		if (VisibleIndices.size() < count)
+		{
+			VisibleIndices.resize(count);
+		}
+
+		if ((count <= ChunkSize) || (LeviathanCore::JobSystem::GetThreadCount() == 1))
+		{
+			VisibleCount = CullRange(test, 0, count, VisibleIndices.data());
+			return;
+		}
+
+		const size_t chunkCount = (count + ChunkSize - 1) / ChunkSize;
+		if (ChunkVisibleIndices.size() < count)
+		{
+			ChunkVisibleIndices.resize(count);
+		}
+		if (ChunkVisibleOffsets.size() < chunkCount + 1)
+		{
+			ChunkVisibleOffsets.resize(chunkCount + 1);
+		}
+
+		LeviathanCore::JobSystem::ParallelFor(count, ChunkSize, [this, &test](const size_t first, const size_t rangeCount, [[maybe_unused]] const size_t threadIndex)
+			{
+				ChunkVisibleOffsets[first / ChunkSize] = CullRange(test, first, rangeCount, ChunkVisibleIndices.data() + first);
+			});
+
+		// Exclusive prefix sum of the chunk visible counts.
+		size_t offset = 0;
+		for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+		{
+			const size_t chunkVisibleCount = ChunkVisibleOffsets[chunk];
+			ChunkVisibleOffsets[chunk] = offset;
+			offset += chunkVisibleCount;
+		}
+		ChunkVisibleOffsets[chunkCount] = offset;
+		VisibleCount = offset;
+
+		// Compact the chunk results.
+		static constexpr size_t compactChunksPerJob = 4;
+		LeviathanCore::JobSystem::ParallelFor(chunkCount, compactChunksPerJob, [this](const size_t firstChunk, const size_t rangeChunkCount, [[maybe_unused]] const size_t threadIndex)
+			{
+				for (size_t chunk = firstChunk; chunk < firstChunk + rangeChunkCount; ++chunk)
+				{
+					const size_t chunkOffset = ChunkVisibleOffsets[chunk];
+					std::copy_n(ChunkVisibleIndices.data() + (chunk * ChunkSize), ChunkVisibleOffsets[chunk + 1] - chunkOffset, VisibleIndices.data() + chunkOffset);
+				}
+			});
+	}
+
+	void FrustumCullingStage::Cull(const LeviathanCore::BoundingVolumes::Frustum& frustum, const LeviathanCore::BoundingVolumes::AABBSoA& worldBounds)
+	{
+		CullWithTest(worldBounds.Count, [&frustum, &worldBounds](const size_t first, const size_t count, uint8_t* outResults)
+			{
+				LeviathanCore::BoundingVolumes::TestFrustumAABBs(frustum, worldBounds, first, count, outResults);
+			});
+	}
+
+	void FrustumCullingStage::Cull(const LeviathanCore::BoundingVolumes::Frustum& frustum, const LeviathanCore::BoundingVolumes::SphereSoA& worldBounds)
+	{
+		CullWithTest(worldBounds.Count, [&frustum, &worldBounds](const size_t first, const size_t count, uint8_t* outResults)
+			{
+				LeviathanCore::BoundingVolumes::TestFrustumSpheres(frustum, worldBounds, first, count, outResults);
+			});
+	}
+}
@@ -2,6 +2,7 @@
 
 #include "MathTypes.h"
 #include "MathLibrary.h"
+#include "BoundingVolumes.h"
 
 namespace LeviathanRenderer
 {
@@ -41,7 +42,11 @@ namespace LeviathanRenderer
 		inline void SetOrthoWidth(float orthoWidth) { OrthoWidth = orthoWidth; }
 		inline const LeviathanCore::MathTypes::Vector3& GetPosition() const { return Position; }
 		inline const LeviathanCore::MathTypes::Euler& GetOrientation() const { return Orientation; }
+		inline float GetNearZ() const { return NearZ; }
+		inline float GetFarZ() const { return FarZ; }
+		inline ProjectionMode GetProjectionMode() const { return Projection; }
 		inline const LeviathanCore::MathTypes::Matrix4x4& GetViewMatrix() const { return ViewMatrix; }
+		inline const LeviathanCore::MathTypes::Matrix4x4& GetProjectionMatrix() const { return ProjectionMatrix; }
 		inline const LeviathanCore::MathTypes::Matrix4x4& GetViewProjectionMatrix() const { return ViewProjectionMatrix; }
 
 		void AddYawRotation(const float yawDeltaRadians);
@@ -51,6 +56,9 @@ namespace LeviathanRenderer
 		void UpdateProjectionMatrix(int renderAreaWidth, int renderAreaHeight);
 		void UpdateViewProjectionMatrix();
 
+		// Returns the frustum planes of the current view projection matrix in world space.
+		LeviathanCore::BoundingVolumes::Frustum GetFrustum() const;
+
 		LeviathanCore::MathTypes::Vector3 GetForwardVector(const LeviathanCore::MathTypes::Vector3& baseForward);
 		LeviathanCore::MathTypes::Vector3 GetRightVector(const LeviathanCore::MathTypes::Vector3& baseRight);
 		LeviathanCore::MathTypes::Vector3 GetUpVector(const LeviathanCore::MathTypes::Vector3& baseUp);
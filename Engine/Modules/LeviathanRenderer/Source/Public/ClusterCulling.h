@@ -0,0 +1,98 @@
+#pragma once
+
+#include "MathTypes.h"
+#include "BoundingVolumes.h"
+
+namespace LeviathanRenderer
+{
+	class Camera;
+
+	// Object space culling data of a cluster of a mesh's triangles, e.g. a meshlet. Every triangle of the cluster faces away from a point p when
+	// dot(normalize(ConeApex - p), ConeAxis) > ConeCutoff. A cutoff of 1 never culls the cluster as back facing.
+	struct ClusterDescription
+	{
+		LeviathanCore::BoundingVolumes::Sphere Bounds = {};
+		LeviathanCore::MathTypes::Vector3 ConeApex = {};
+		LeviathanCore::MathTypes::Vector3 ConeAxis = { 0.0f, 0.0f, 1.0f };
+		float ConeCutoff = 1.0f;
+		// Range of the cluster's triangles in the mesh's index buffer.
+		uint32_t FirstIndex = 0;
+		uint32_t IndexCount = 0;
+	};
+
+	struct ClusterCullingStats
+	{
+		uint64_t TestedClusters = 0;
+		// Clusters outside the frustum, and clusters inside the frustum culled as back facing.
+		uint64_t FrustumCulledClusters = 0;
+		uint64_t BackFacingClusters = 0;
+		uint64_t VisibleIndices = 0;
+	};
+
+	// Culls the clusters of a mesh instance against the view frustum and as back facing, and builds the compact index buffer of the visible clusters'
+	// triangles for a single draw. Tests run in object space, where the frustum planes, the view position and every cluster's normal cone keep their
+	// meaning under any affine instance transform, so cluster data is set once per mesh and shared by its instances.
+	// Clusters are culled in chunks in parallel on the job system, four at a time with SSE when available, and the visible clusters and their indices
+	// are compacted in cluster order. Scratch memory is retained between calls. Does not depend on a renderer api and can be used headless.
+	class ClusterCullingStage
+	{
+	public:
+		// Number of clusters culled per job. Counts at or below this are culled on the calling thread.
+		static constexpr size_t ChunkSize = 1024;
+
+	private:
+		struct ChunkResult
+		{
+			size_t VisibleCount = 0;
+			size_t IndexCount = 0;
+			size_t FrustumCulledCount = 0;
+			size_t BackFacingCount = 0;
+			// Offsets of the chunk's visible clusters and indices in the compacted outputs.
+			size_t VisibleOffset = 0;
+			size_t IndexOffset = 0;
+		};
+
+		LeviathanCore::BoundingVolumes::SphereArray ClusterBounds = {};
+		std::vector<float> ConeApexX = {};
+		std::vector<float> ConeApexY = {};
+		std::vector<float> ConeApexZ = {};
+		std::vector<float> ConeAxisX = {};
+		std::vector<float> ConeAxisY = {};
+		std::vector<float> ConeAxisZ = {};
+		std::vector<float> ConeCutoffs = {};
+		std::vector<uint32_t> FirstIndices = {};
+		std::vector<uint32_t> IndexCounts = {};
+
+		std::vector<uint32_t> VisibleClusters = {};
+		size_t VisibleClusterCount = 0;
+		std::vector<uint32_t> VisibleIndices = {};
+		size_t VisibleIndexCount = 0;
+
+		// Visible clusters of each chunk written at the chunk's first cluster before compaction into VisibleClusters.
+		std::vector<uint32_t> ChunkVisibleClusters = {};
+		std::vector<ChunkResult> ChunkResults = {};
+		ClusterCullingStats Stats = {};
+
+	public:
+		// Replaces the clusters of the mesh.
+		void SetClusters(const ClusterDescription* clusters, size_t count);
+
+		inline size_t GetClusterCount() const { return ClusterBounds.Size(); }
+
+		// Culls the clusters of the mesh instance with the object to world transform for the view. indices is the mesh's index buffer the cluster
+		// index ranges refer to. The index buffer of the visible clusters is not built if indices is null.
+		void Cull(const Camera& view, const LeviathanCore::MathTypes::Matrix4x4& transform, const uint32_t* indices);
+
+		inline const uint32_t* GetVisibleClusters() const { return VisibleClusters.data(); }
+		inline size_t GetVisibleClusterCount() const { return VisibleClusterCount; }
+		inline const uint32_t* GetVisibleIndices() const { return VisibleIndices.data(); }
+		inline size_t GetVisibleIndexCount() const { return VisibleIndexCount; }
+		inline const ClusterCullingStats& GetStats() const { return Stats; }
+
+	private:
+		// Culls the clusters in [first, first + count) and writes the visible clusters to outClusters. viewPoint is the object space view position,
+		// or the object space view direction for orthographic views.
+		ChunkResult CullRange(const LeviathanCore::BoundingVolumes::Frustum& frustum, const LeviathanCore::MathTypes::Vector3& viewPoint, bool orthographic,
+			size_t first, size_t count, uint32_t* outClusters) const;
+	};
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "BoundingVolumes.h"
+#include "LightTypes.h"
+
+namespace LeviathanRenderer
+{
+	// Perspective view a cluster grid is built for. View space is left handed with +Z forward like Matrix4x4::View.
+	struct ClusterView
+	{
+		LeviathanCore::MathTypes::Matrix4x4 ViewMatrix = {};
+		float FovYRadians = LeviathanCore::MathLibrary::DegreesToRadians(45.0f);
+		float AspectRatio = 1.0f;
+		float NearZ = 0.1f;
+		float FarZ = 1000.0f;
+	};
+
+	// Assigns point and spot lights to the clusters of a view frustum grid for forward+ shading. The frustum is split into TileCountX * TileCountY screen
+	// tiles and SliceCount depth slices spaced exponentially between the near and far planes. Every light is bounded by a view space sphere, its
+	// influence radius for point lights and the sphere enclosing the cone for spot lights, which is tested against the view space boxes of the
+	// clusters. Lights are narrowed down per slice, then per tile row and then per cluster, testing four lights at a time with SSE when available.
+	// Slices are assigned in parallel on the job system.
+	// Every cluster receives a compact range of the light index list. Point light i has light index i and spot light i has light index
+	// pointLightCount + i. Lights of a cluster are in ascending index order. Scratch memory is retained between builds so that steady state builds do
+	// not allocate. Does not depend on a renderer api and can be used headless.
+	class ClusteredLightCulling
+	{
+	public:
+		static constexpr uint32_t DefaultTileCountX = 16;
+		static constexpr uint32_t DefaultTileCountY = 9;
+		static constexpr uint32_t DefaultSliceCount = 24;
+
+		// Range of a cluster's lights in the light index list.
+		struct ClusterLights
+		{
+			uint32_t Offset = 0;
+			uint32_t Count = 0;
+		};
+
+	private:
+		// Candidate lights of a slice or tile row in structure of arrays layout for batched tests.
+		struct CandidateLights
+		{
+			std::vector<float> CenterX = {};
+			std::vector<float> CenterY = {};
+			std::vector<float> CenterZ = {};
+			std::vector<float> Radius = {};
+			std::vector<uint32_t> Indices = {};
+			size_t Count = 0;
+
+			// Grows the arrays to hold capacity candidates.
+			void Reserve(size_t capacity);
+
+			// Replaces the candidates with the lights overlapping the bounds. lightIndices maps the lights to light indices, nullptr if
+			// the lights are in light index order.
+			void Gather(const LeviathanCore::BoundingVolumes::AABB& bounds, const LeviathanCore::BoundingVolumes::SphereSoA& lights, const uint32_t* lightIndices);
+
+			LeviathanCore::BoundingVolumes::SphereSoA View() const;
+		};
+
+		struct ThreadScratch
+		{
+			CandidateLights SliceLights = {};
+			CandidateLights RowLights = {};
+		};
+
+		uint32_t TileCountX = DefaultTileCountX;
+		uint32_t TileCountY = DefaultTileCountY;
+		uint32_t SliceCount = DefaultSliceCount;
+
+		// Tangents of the half field of view angles and the view depth of every slice boundary of the last build.
+		float TanHalfFovX = 0.0f;
+		float TanHalfFovY = 0.0f;
+		std::vector<float> SliceDepths = {};
+
+		// View space bounding spheres of the lights, point lights first.
+		std::vector<float> LightCenterX = {};
+		std::vector<float> LightCenterY = {};
+		std::vector<float> LightCenterZ = {};
+		std::vector<float> LightRadius = {};
+		size_t LightCount = 0;
+
+		std::vector<ClusterLights> Clusters = {};
+		std::vector<uint32_t> LightIndices = {};
+		size_t LightIndexCount = 0;
+
+		// Light indices of each slice before compaction into LightIndices. Cluster offsets are relative to their slice's list until compaction.
+		std::vector<std::vector<uint32_t>> SliceLightIndices = {};
+		std::vector<size_t> SliceOffsets = {};
+		std::vector<ThreadScratch> Scratch = {};
+
+	public:
+		// Sets the grid resolution. Fails if any count is 0.
+		bool Initialize(uint32_t tileCountX, uint32_t tileCountY, uint32_t sliceCount);
+
+		void Build(const ClusterView& view, const LightTypes::PointLight* const pointLights, const size_t pointLightCount,
+			const LightTypes::SpotLight* const spotLights, const size_t spotLightCount);
+
+		inline uint32_t GetTileCountX() const { return TileCountX; }
+		inline uint32_t GetTileCountY() const { return TileCountY; }
+		inline uint32_t GetSliceCount() const { return SliceCount; }
+		inline size_t GetClusterCount() const { return static_cast<size_t>(TileCountX) * TileCountY * SliceCount; }
+		inline size_t GetClusterIndex(const uint32_t tileX, const uint32_t tileY, const uint32_t slice) const
+		{
+			return (static_cast<size_t>(slice) * TileCountY + tileY) * TileCountX + tileX;
+		}
+
+		inline const ClusterLights* GetClusters() const { return Clusters.data(); }
+		inline const uint32_t* GetLightIndices() const { return LightIndices.data(); }
+		inline size_t GetLightIndexCount() const { return LightIndexCount; }
+
+		// View space bounding sphere of a light of the last build.
+		inline LeviathanCore::BoundingVolumes::Sphere GetLightBounds(const size_t light) const
+		{
+			return LeviathanCore::BoundingVolumes::Sphere{ LeviathanCore::MathTypes::Vector3{ LightCenterX[light], LightCenterY[light], LightCenterZ[light] },
+				LightRadius[light] };
+		}
+
+		// View space box of a cluster of the last build.
+		LeviathanCore::BoundingVolumes::AABB GetClusterBounds(uint32_t tileX, uint32_t tileY, uint32_t slice) const;
+
+		// Returns the view depth of the boundary between slice - 1 and slice. Slice 0 starts at the near plane and slice SliceCount ends at the far plane.
+		inline float GetSliceDepth(const uint32_t slice) const { return SliceDepths[slice]; }
+
+	private:
+		void AssignSlice(uint32_t slice, ThreadScratch& scratch);
+	};
+}
@@ -48,7 +48,7 @@ namespace LeviathanRenderer
 			char Padding0[4] = { 0 };
 
 			float LightPositionViewSpace[3] = { 0.0f };
-			char Padding1[4] = { 0 };
+			float Radius = 0.0f;
 		};
 
 		struct SpotLightConstantBuffer
@@ -57,7 +57,7 @@ namespace LeviathanRenderer
 			char Padding0[4] = { 0 };
 
 			float LightPositionViewSpace[3] = { 0.0f };
-			char Padding1[4] = { 0 };
+			float Radius = 0.0f;
 
 			float LightDirectionViewSpace[3] = { 0.0f };
 			float CosineInnerConeAngle = 0.0f;
@@ -0,0 +1,172 @@
+#pragma once
+
+namespace LeviathanRenderer
+{
+	enum class GpuMemoryCategory : uint8_t
+	{
+		VertexBuffer,
+		IndexBuffer,
+		ConstantBuffer,
+		Texture2D,
+		TextureCube,
+		StreamedTexture,
+		RenderTarget,
+		MAX
+	};
+
+	static constexpr size_t GpuMemoryCategoryCount = static_cast<size_t>(GpuMemoryCategory::MAX);
+
+	// Display name of the category, e.g. for stats overlays. "Total" for GpuMemoryCategory::MAX.
+	const char* GetGpuMemoryCategoryName(GpuMemoryCategory category);
+
+	enum class GpuTextureFormat : uint8_t
+	{
+		RGBA8,
+		RGBA16Float,
+		RGBA32Float,
+		Depth24Stencil8
+	};
+
+	uint32_t GetGpuTextureFormatBytesPerTexel(GpuTextureFormat format);
+
+	// Bytes of faceCount faces of mipCount mips down from a width x height mip 0, e.g. 6 faces for a cubemap. Mip n is max(width >> n, 1) by
+	// max(height >> n, 1) texels.
+	size_t GetGpuTextureBytes(uint32_t width, uint32_t height, uint32_t mipCount, uint32_t faceCount, GpuTextureFormat format);
+
+	using GpuAllocationId = uint32_t;
+	static constexpr GpuAllocationId InvalidGpuAllocationId = std::numeric_limits<GpuAllocationId>::max();
+
+	// Called when a budget is first exceeded after being within it, with GpuMemoryCategory::MAX for the total budget.
+	using GpuMemoryBudgetExceededCallbackType = void(*)(GpuMemoryCategory /* category */, size_t /* usedBytes */, size_t /* budgetBytes */,
+		void* /* userData */);
+
+	struct GpuMemoryCategoryStats
+	{
+		size_t UsedBytes = 0;
+		size_t PeakBytes = 0;
+		size_t BudgetBytes = 0;
+		uint32_t Allocations = 0;
+	};
+
+	struct GpuMemoryStats
+	{
+		std::array<GpuMemoryCategoryStats, GpuMemoryCategoryCount> Categories = {};
+		size_t UsedBytes = 0;
+		size_t PeakBytes = 0;
+		size_t BudgetBytes = 0;
+		// Bytes tracked and released by allocations, resizes and releases in the last frame.
+		size_t FrameAllocatedBytes = 0;
+		size_t FrameReleasedBytes = 0;
+		// Allocations asked to release memory at the end of the last frame and the bytes they hold.
+		uint32_t FrameReclaims = 0;
+		size_t FrameReclaimBytes = 0;
+		// Bit per category, and bit GpuMemoryCategoryCount for the total, set for every budget exceeded at the end of the last frame.
+		uint32_t ExceededBudgets = 0;
+		uint64_t Reclaims = 0;
+		uint64_t BudgetExceededEvents = 0;
+	};
+
+	// Accounting of gpu memory by category against per category and total budgets. Every resource is tracked with its size as computed from its
+	// dimensions and format, so the accounting does not depend on a renderer api and does not include driver padding or alignment.
+	// Allocations given a reclaim priority may be asked to release memory at the end of a frame in which a budget is exceeded, lowest priority
+	// first and then least recently used first. Allocations used in the ending frame are not reclaimed. Memory is reclaimed by a Backend with
+	// the function
+	//     bool Reclaim(GpuAllocationId allocation, uint64_t resource); // Evict or demote the resource and Untrack or Resize the allocation.
+	// which returns false if the resource can not release memory now. Reclaimed allocations are not asked again until they are resized.
+	class GpuMemoryTracker
+	{
+	public:
+		static constexpr size_t Unlimited = std::numeric_limits<size_t>::max();
+		static constexpr uint8_t NotReclaimable = std::numeric_limits<uint8_t>::max();
+
+	private:
+		struct Allocation
+		{
+			bool Tracked = false;
+			GpuMemoryCategory Category = GpuMemoryCategory::MAX;
+			size_t SizeBytes = 0;
+			uint64_t Resource = 0;
+			uint8_t ReclaimPriority = NotReclaimable;
+			bool ReclaimRequested = false;
+			uint64_t LastUsedFrame = 0;
+		};
+
+		std::vector<Allocation> Allocations = {};
+		std::vector<GpuAllocationId> FreeIds = {};
+		std::array<size_t, GpuMemoryCategoryCount> Budgets = {};
+		size_t TotalBudget = Unlimited;
+		uint64_t FrameIndex = 1;
+
+		GpuMemoryBudgetExceededCallbackType BudgetExceededCallback = nullptr;
+		void* BudgetExceededUserData = nullptr;
+
+		GpuMemoryStats Stats = {};
+		size_t FrameAllocatedBytes = 0;
+		size_t FrameReleasedBytes = 0;
+
+		// Allocations planned to be reclaimed at the end of the frame in reclaim order with their bytes when planned, and their results.
+		struct PlannedReclaim
+		{
+			GpuAllocationId Allocation = InvalidGpuAllocationId;
+			size_t SizeBytes = 0;
+		};
+		std::vector<PlannedReclaim> Reclaims = {};
+		std::vector<uint8_t> ReclaimResults = {};
+		std::vector<GpuAllocationId> ReclaimCandidates = {};
+
+	public:
+		GpuMemoryTracker();
+
+		GpuAllocationId Track(GpuMemoryCategory category, size_t sizeBytes, uint64_t resource);
+		void Untrack(GpuAllocationId& allocation);
+		// Sets the size of a resource that changed, e.g. a texture whose mips were streamed or demoted.
+		void Resize(GpuAllocationId allocation, size_t sizeBytes);
+
+		inline bool IsValid(const GpuAllocationId allocation) const { return (allocation < Allocations.size()) && Allocations[allocation].Tracked; }
+
+		// Lower priorities are reclaimed first. NotReclaimable allocations are never reclaimed, which is the default.
+		void SetReclaimPriority(GpuAllocationId allocation, uint8_t priority);
+		// Marks the allocation used by the current frame.
+		inline void MarkUsed(const GpuAllocationId allocation) { Allocations[allocation].LastUsedFrame = FrameIndex; }
+
+		// Unlimited by default.
+		void SetBudget(GpuMemoryCategory category, size_t budgetBytes);
+		void SetTotalBudget(size_t budgetBytes);
+		inline size_t GetBudget(const GpuMemoryCategory category) const { return Budgets[static_cast<size_t>(category)]; }
+		inline size_t GetTotalBudget() const { return TotalBudget; }
+		void SetBudgetExceededCallback(GpuMemoryBudgetExceededCallbackType callback, void* userData);
+
+		inline size_t GetUsedBytes(const GpuMemoryCategory category) const { return Stats.Categories[static_cast<size_t>(category)].UsedBytes; }
+		inline size_t GetUsedBytes() const { return Stats.UsedBytes; }
+		inline size_t GetSizeBytes(const GpuAllocationId allocation) const { return Allocations[allocation].SizeBytes; }
+
+		// Reclaims memory for the exceeded budgets, reports budgets exceeded after reclaiming and starts the next frame's stats. The backend may
+		// Track, Untrack and Resize allocations while reclaiming.
+		template <typename Backend>
+		void EndFrame(Backend& backend)
+		{
+			PlanReclaims();
+			ReclaimResults.assign(Reclaims.size(), 0);
+			for (size_t i = 0; i < Reclaims.size(); ++i)
+			{
+				const GpuAllocationId allocation = Reclaims[i].Allocation;
+				ReclaimResults[i] = backend.Reclaim(allocation, Allocations[allocation].Resource) ? 1 : 0;
+			}
+			CompleteFrame();
+		}
+
+		inline uint64_t GetFrameIndex() const { return FrameIndex; }
+		// Used and peak bytes are current. Frame stats are of the last ended frame.
+		inline const GpuMemoryStats& GetStats() const { return Stats; }
+
+	private:
+		// Picks the reclaimable allocations whose bytes bring every category and the total within budget.
+		void PlanReclaims();
+
+		// Keeps the requests of reclaimed allocations, calls the budget exceeded callback and resets the frame stats.
+		void CompleteFrame();
+
+		void AddBytes(GpuMemoryCategory category, size_t sizeBytes);
+		void RemoveBytes(GpuMemoryCategory category, size_t sizeBytes);
+	};
+}
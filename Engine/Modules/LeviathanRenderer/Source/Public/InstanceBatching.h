@@ -0,0 +1,47 @@
+#pragma once
+
+#include "ConstantBufferTypes.h"
+
+namespace LeviathanRenderer
+{
+	class RenderWorld;
+	struct DrawList;
+
+	// Draws of a draw list sharing a mesh and material that are submitted as one instanced draw.
+	struct InstanceBatch
+	{
+		// Storage index into the render world of the renderable providing the batch's mesh and material.
+		uint32_t Renderable = 0;
+		// Range of the batch's instances in the instance stream.
+		uint32_t FirstInstance = 0;
+		uint32_t InstanceCount = 0;
+		// Draw list sort key of the batch's first instance.
+		uint64_t SortKey = 0;
+	};
+
+	// Instance batches of a draw list and the instance stream holding the object data of every instance. Instances of a batch are contiguous in the
+	// stream and keep their draw list order, e.g. front to back. Batches are in draw list order of their first instance. Memory is retained between
+	// builds.
+	struct InstanceBatchList
+	{
+		std::vector<InstanceBatch> Batches = {};
+		std::vector<ConstantBufferTypes::ObjectConstantBuffer> InstanceData = {};
+		// Draw list index of every instance.
+		std::vector<uint32_t> InstanceDraws = {};
+
+		// Batch key and batch index of each draw, batch key and instance write cursor of each batch and the open addressing table of batch indices
+		// reused between builds.
+		std::vector<uint64_t> ScratchDrawKeys = {};
+		std::vector<uint32_t> ScratchDrawBatches = {};
+		std::vector<uint64_t> ScratchBatchKeys = {};
+		std::vector<uint32_t> ScratchBatchCursors = {};
+		std::vector<uint32_t> ScratchBatchTable = {};
+
+		inline size_t GetBatchCount() const { return Batches.size(); }
+		inline size_t GetInstanceCount() const { return InstanceData.size(); }
+	};
+
+	// Groups the draws of a draw list with identical mesh and material into instance batches and packs their object data into the instance stream.
+	// Draws are grouped with a hash table and a stable counting sort in linear time. Batch keys and the instance stream are computed on the job system.
+	void BuildInstanceBatches(const RenderWorld& world, const DrawList& drawList, InstanceBatchList& outBatches);
+}
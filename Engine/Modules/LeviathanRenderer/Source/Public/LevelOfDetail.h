@@ -0,0 +1,18 @@
+#pragma once
+
+#include "BoundingVolumes.h"
+
+namespace LeviathanRenderer
+{
+	class Camera;
+
+	// Returns the number of pixels a world space length covers on a viewport of the given height when seen at the nearest point of the world bounds,
+	// or at the near plane for bounds containing the camera. Lengths do not shrink with distance under an orthographic projection.
+	float GetProjectedSize(const Camera& view, const LeviathanCore::BoundingVolumes::Sphere& worldBounds, float worldLength, float viewportHeight);
+
+	// Returns the coarsest level of detail whose error projects to at most maxPixelError pixels. levelErrors holds the object space error of every
+	// level in ascending order with level 0 the full detail mesh, e.g. the errors of a LeviathanAssets::MeshSimplification::LODChain. worldScale converts
+	// object space errors to world space, e.g. the largest axis scale of the object's transform.
+	uint32_t SelectLevelOfDetail(const Camera& view, const LeviathanCore::BoundingVolumes::Sphere& worldBounds, float worldScale, const float* levelErrors,
+		uint32_t levelCount, float viewportHeight, float maxPixelError);
+}
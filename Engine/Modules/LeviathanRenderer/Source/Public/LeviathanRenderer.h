@@ -2,6 +2,11 @@
 
 #include "Callback.h"
 #include "RendererResourceId.h"
+#include "RenderWorld.h"
+#include "OcclusionCulling.h"
+#include "UploadQueue.h"
+#include "TextureStreaming.h"
+#include "GpuMemory.h"
 
 namespace LeviathanCore
 {
@@ -21,6 +26,12 @@ namespace LeviathanRenderer
 	}
 
 	class Camera;
+	struct LightInfluenceStats;
+
+	namespace RenderCommands
+	{
+		struct StateFilterStats;
+	}
 
 	enum class TextureSamplerFilter : uint8_t
 	{
@@ -56,8 +67,33 @@ namespace LeviathanRenderer
 		// Array of pointers to 2D texture data for each face. Array pointers are in the order +X, -X, +Y, -Y, +Z, -Z.
 		std::array<const void*, 6> FaceTextureData = { nullptr };
 		bool sRGB = false;
+		// Faces of HDR cubes are 32 bit float rgba, or 16 bit float rgba with HalfFloat.
+		bool HDR = false;
+		bool HalfFloat = false;
+	};
+
+	// Reads mips [firstMip, firstMip + mipCount) of a streamed texture back to back from the finest into the out buffer. Called on the thread creating
+	// the texture for its tail and on the job system's background thread for streamed mips, so reads of different textures may run concurrently.
+	// Render does not wait for streamed mip reads.
+	using StreamedTextureReadCallbackType = bool(*)(uint32_t /* firstMip */, uint32_t /* mipCount */, std::vector<uint8_t>& /* outMipData */,
+		void* /* userData */);
+
+	struct StreamedTexture2DDescription
+	{
+		// Mip 0 size and number of mips of the full chain. Mip n is max(Width >> n, 1) by max(Height >> n, 1) 8 bit rgba texels.
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+		uint32_t MipCount = 0;
+		bool sRGB = false;
+		StreamedTextureReadCallbackType ReadMips = nullptr;
+		// Must stay valid until the texture is destroyed.
+		void* UserData = nullptr;
 	};
 
+	// Asks the owner of a reclaimable resource to release its gpu memory, e.g. by destroying it or replacing it with a lower resolution version, now
+	// or in a later frame. Called on the thread calling Render. Returns false if the resource can not release memory now.
+	using GpuMemoryReclaimCallbackType = bool(*)(RendererResourceId::IdType /* id */, void* /* userData */);
+
 	struct TextureSamplerDescription
 	{
 		TextureSamplerFilter Filter = TextureSamplerFilter::MAX;
@@ -86,15 +122,72 @@ namespace LeviathanRenderer
 	void DestroyTextureSampler(RendererResourceId::IdType& id);
 	bool CreateTextureCube(const TextureCubeDescription& description, RendererResourceId::IdType& outId);
 	void DestroyTextureCube(RendererResourceId::IdType& id);
+
+	// Asynchronous resource creation. Callable from any thread. Data is copied before returning so it can be released immediately. Resources are
+	// created by the following Renders within the upload budget in priority order and passed to the description's callback on the thread calling
+	// Render. Returns UploadQueue::InvalidTicket if the request is invalid.
+	UploadTicket CreateVertexBufferAsync(const void* vertexData, unsigned int vertexCount, size_t singleVertexStrideBytes, const UploadDescription& uploadDescription);
+	UploadTicket CreateIndexBufferAsync(const unsigned int* indexData, unsigned int indexCount, const UploadDescription& uploadDescription);
+	UploadTicket CreateTexture2DAsync(const Texture2DDescription& description, const UploadDescription& uploadDescription);
+	UploadTicket CreateTextureCubeAsync(const TextureCubeDescription& description, const UploadDescription& uploadDescription);
+	// Cancels an upload that was not created yet. Call from the thread calling Render.
+	bool CancelUpload(UploadTicket ticket);
+	// Bytes of resource data created per Render. Defaults to RendererConstants::UploadBudgetBytesPerFrame.
+	void SetUploadBudget(size_t budgetBytesPerFrame);
+	// Creates every waiting upload now, e.g. behind a loading screen. Call from the thread calling Render.
+	void FlushUploads();
+	const UploadQueueStats& GetUploadQueueStats();
+
+	// Creates a texture streamed from the description's mip reader, e.g. reading a LeviathanAssets::StreamableTexture file. The tail mips are read
+	// and created immediately and finer mips are streamed in and out of the texture streaming pool by the following Renders as the visible
+	// renderables whose materials use the texture need them. Returns false if the tail could not be read or created.
+	bool CreateStreamedTexture2D(const StreamedTexture2DDescription& description, RendererResourceId::IdType& outId);
+	void DestroyStreamedTexture2D(RendererResourceId::IdType& id);
+	// Bytes of the streaming pool and mips streamed in per Render. Default to RendererConstants::TextureStreamingPoolBytes and
+	// RendererConstants::TextureStreamingBytesPerFrame.
+	void SetTextureStreamingBudget(size_t poolBytes, size_t bytesPerFrame);
+	const TextureStreamingStats& GetTextureStreamingStats();
+
+	// Gpu memory of the resources created through the renderer by category, computed from their sizes, formats and mip chains. Budgets are
+	// unlimited by default. When a budget is exceeded at the end of a Render, the reclaimable resources not used by the Render are asked to release
+	// their memory, lowest priority and least recently used first, and the callback is called if the budget stays exceeded.
+	void SetGpuMemoryBudget(GpuMemoryCategory category, size_t budgetBytes);
+	void SetGpuMemoryTotalBudget(size_t budgetBytes);
+	void SetGpuMemoryBudgetExceededCallback(GpuMemoryBudgetExceededCallbackType callback, void* userData);
+	// Makes a vertex buffer, index buffer, texture or cubemap reclaimable by the callback. Lower priorities are reclaimed first. Returns false if
+	// the resource is not tracked.
+	bool SetResourceReclaimPriority(RendererResourceId::IdType id, uint8_t priority, GpuMemoryReclaimCallbackType reclaim, void* userData);
+	// Memory in use and the last Render's allocations, releases and reclaims.
+	const GpuMemoryStats& GetGpuMemoryStats();
+
+	// Registers a renderable drawn by every Render until it is destroyed.
+	RenderableId CreateRenderable(const RenderableDescription& description);
+	void DestroyRenderable(RenderableId& id);
+	// Only needs calling when the renderable's transform, mesh or material changes.
+	void SetRenderableTransform(RenderableId id, const LeviathanCore::MathTypes::Matrix4x4& transform);
+	void SetRenderableMesh(RenderableId id, const RenderMesh& mesh);
+	void SetRenderableMaterial(RenderableId id, const RenderMaterial& material);
+
+	// Registers an occluder hiding renderables behind it from every Render until it is destroyed.
+	OccluderId CreateOccluder(const OccluderDescription& description);
+	void DestroyOccluder(OccluderId& id);
+	void SetOccluderTransform(OccluderId id, const LeviathanCore::MathTypes::Matrix4x4& transform);
+
+	// Draws the registered renderables visible from the view.
 	void Render(const LeviathanRenderer::Camera& view, const LeviathanRenderer::Camera& skyboxView,
 		RendererResourceId::IdType skyboxVertexBufferId, RendererResourceId::IdType skyboxIndexBufferId,
 		const LeviathanRenderer::LightTypes::DirectionalLight* const pSceneDirectionalLights, const size_t numDirectionalLights,
 		const LeviathanRenderer::LightTypes::PointLight* const pScenePointLights, const size_t numPointLights,
 		const LeviathanRenderer::LightTypes::SpotLight* const pSceneSpotLights, const size_t numSpotLights, 
-		const RendererResourceId::IdType skyboxTextureCubeResourceId, const RendererResourceId::IdType skyboxTextureCubeSamplerId,
-		RendererResourceId::IdType colorTextureResourceId, RendererResourceId::IdType metallicTextureResourceId,
-		RendererResourceId::IdType roughnessTextureResourceId, RendererResourceId::IdType normalTextureResourceId, RendererResourceId::IdType samplerResourceId,
-		const LeviathanCore::MathTypes::Matrix4x4& objectTransformMatrix, const uint32_t objectIndexCount, RendererResourceId::IdType vertexBufferResourceId,
-		RendererResourceId::IdType indexBufferResourceId);
+		const RendererResourceId::IdType skyboxTextureCubeResourceId, const RendererResourceId::IdType skyboxTextureCubeSamplerId);
 	void Present();
+
+	// Renderer api calls issued and elided as redundant while executing the commands of the last Render.
+	const RenderCommands::StateFilterStats& GetStateFilterStats();
+
+	// Light and object pairs culled and lighting draws skipped by point and spot light influence culling in the last Render.
+	const LightInfluenceStats& GetLightInfluenceStats();
+
+	// Occluder triangles rasterized and renderables culled by software occlusion culling in the last Render.
+	const OcclusionCullingStats& GetOcclusionCullingStats();
 }
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "BoundingVolumes.h"
+#include "LightTypes.h"
+
+namespace LeviathanRenderer
+{
+	class RenderWorld;
+	struct DrawList;
+	struct InstanceBatchList;
+
+	struct LightInfluenceStats
+	{
+		// Point and spot light and visible object pairs tested, and the pairs culled because the object is outside the light's volume.
+		uint64_t TestedPairs = 0;
+		uint64_t CulledPairs = 0;
+		// Point and spot light and instance batch pairs, and the pairs whose lighting draw is skipped because no instance of the batch is lit.
+		uint64_t BatchPairs = 0;
+		uint64_t SkippedDraws = 0;
+	};
+
+	// World space volumes lit by a light. Spot lights with an outer cone angle of 90 degrees or more are bounded by their influence sphere.
+	LeviathanCore::BoundingVolumes::Sphere GetInfluenceSphere(const LightTypes::PointLight& light);
+	LeviathanCore::BoundingVolumes::Sphere GetInfluenceSphere(const LightTypes::SpotLight& light);
+	LeviathanCore::BoundingVolumes::Cone GetInfluenceCone(const LightTypes::SpotLight& light);
+
+	// Visible objects of a draw list and instance batches lit by each light. The world bounds of the objects are tested against the influence sphere of
+	// every point light and the influence cone of every spot light, four objects at a time with SSE when available. Lights are tested in parallel on the
+	// job system.
+	// Point light i has light index i and spot light i has light index pointLightCount + i. Directional lights light every object and are not listed.
+	// Object and batch lists are in ascending order. Memory is retained between builds. Does not depend on a renderer api and can be used headless.
+	class LightInfluenceCulling
+	{
+	public:
+		// Number of lights tested per job.
+		static constexpr size_t LightsPerJob = 8;
+
+	private:
+		struct ThreadScratch
+		{
+			std::vector<uint8_t> Results = {};
+			std::vector<uint32_t> Draws = {};
+			// Last light that marked each batch, offset by 1 so that 0 is unmarked.
+			std::vector<uint32_t> BatchMarks = {};
+		};
+
+		// World bounds of the draw list's objects in draw order.
+		LeviathanCore::BoundingVolumes::AABBArray ObjectBounds = {};
+
+		// Objects and instance batches lit by each light.
+		std::vector<std::vector<uint32_t>> LightDraws = {};
+		std::vector<std::vector<uint32_t>> LightBatches = {};
+		size_t LightCount = 0;
+
+		std::vector<ThreadScratch> Scratch = {};
+		LightInfluenceStats Stats = {};
+
+	public:
+		// batches must be built from drawList.
+		void Build(const RenderWorld& world, const DrawList& drawList, const InstanceBatchList& batches, const LightTypes::PointLight* const pointLights,
+			const size_t pointLightCount, const LightTypes::SpotLight* const spotLights, const size_t spotLightCount);
+
+		inline size_t GetLightCount() const { return LightCount; }
+		inline const uint32_t* GetLightBatches(const size_t light) const { return LightBatches[light].data(); }
+		inline size_t GetLightBatchCount(const size_t light) const { return LightBatches[light].size(); }
+		inline const uint32_t* GetLightObjects(const size_t light) const { return LightDraws[light].data(); }
+		inline size_t GetLightObjectCount(const size_t light) const { return LightDraws[light].size(); }
+
+		inline size_t GetObjectCount() const { return ObjectBounds.Size(); }
+
+		inline const LightInfluenceStats& GetStats() const { return Stats; }
+	};
+}
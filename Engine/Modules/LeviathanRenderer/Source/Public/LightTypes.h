@@ -20,6 +20,9 @@ namespace LeviathanRenderer
 			float Brightness = 1.0f;
 			// Position in world space.
 			LeviathanCore::MathTypes::Vector3 Position{ 0.0f, 0.0f, 0.0f };
+			// Attenuation radius in world units. Surfaces further from the light are not lit by it, bounding the light's volume for light culling.
+			// Dim lights are limited to a smaller radius by GetInfluenceRadius.
+			float Radius = 10.0f;
 		};
 
 		struct SpotLight
@@ -32,6 +35,31 @@ namespace LeviathanRenderer
 			LeviathanCore::MathTypes::Vector3 Direction{ 0.0f, -1.0f, 0.0f };
 			float InnerConeAngleRadians = LeviathanCore::MathLibrary::DegreesToRadians(0.0f);
 			float OuterConeAngleRadians = LeviathanCore::MathLibrary::DegreesToRadians(17.5f);
+			// Attenuation radius in world units along the cone. Surfaces further from the light are not lit by it, bounding the light's volume for light
+			// culling. Dim lights are limited to a smaller radius by GetInfluenceRadius.
+			float Radius = 10.0f;
 		};
+
+		// Radiance below which a light's contribution is treated as 0 when deriving its influence radius.
+		static constexpr float InfluenceRadianceCutoff = 0.01f;
+
+		// Returns the distance at which the inverse square attenuated radiance of the light's brightest color channel falls to the cutoff.
+		inline float CalculateCutoffRadius(const LeviathanCore::MathTypes::Vector3& color, const float brightness, const float radianceCutoff = InfluenceRadianceCutoff)
+		{
+			const float peakRadiance = std::max({ color.X(), color.Y(), color.Z() }) * brightness;
+			return (peakRadiance > 0.0f) ? std::sqrt(peakRadiance / radianceCutoff) : 0.0f;
+		}
+
+		// Returns the radius of the volume lit by the light, its attenuation radius limited to the brightness cutoff radius. Shading fades the light
+		// out to 0 at this distance.
+		inline float GetInfluenceRadius(const PointLight& light)
+		{
+			return std::min(light.Radius, CalculateCutoffRadius(light.Color, light.Brightness));
+		}
+
+		inline float GetInfluenceRadius(const SpotLight& light)
+		{
+			return std::min(light.Radius, CalculateCutoffRadius(light.Color, light.Brightness));
+		}
 	}
 }
\ No newline at end of file
@@ -0,0 +1,164 @@
+#pragma once
+
+#include "MathTypes.h"
+#include "BoundingVolumes.h"
+
+namespace LeviathanRenderer
+{
+	class Camera;
+
+	using OccluderId = uint32_t;
+	static constexpr OccluderId InvalidOccluderId = std::numeric_limits<OccluderId>::max();
+
+	// Triangle mesh hiding what is behind it, in object space. Occluders should be low triangle count stand ins lying inside the geometry they represent,
+	// e.g. the walls of a building, as every rasterized pixel of an occluder is treated as opaque.
+	struct OccluderDescription
+	{
+		std::vector<LeviathanCore::MathTypes::Vector3> Positions = {};
+		std::vector<uint32_t> Indices = {};
+		LeviathanCore::MathTypes::Matrix4x4 Transform = {};
+		// Back faces, triangles wound counter clockwise on screen, are culled unless the occluder is double sided, e.g. a single plane seen from
+		// both sides. Back faces of closed meshes are always behind their front faces.
+		bool DoubleSided = false;
+	};
+
+	struct OcclusionCullingStats
+	{
+		// Occluder triangles submitted, and the triangles rasterized after near plane clipping and rejecting back faces and triangles covering no pixel
+		// center.
+		uint64_t OccluderTriangles = 0;
+		uint64_t RasterizedTriangles = 0;
+		// Objects tested against the occluder depth and the objects found hidden.
+		uint64_t TestedObjects = 0;
+		uint64_t OccludedObjects = 0;
+	};
+
+	// Software occlusion culling for a perspective view. Designated occluder meshes are rasterized on the cpu into a low resolution depth buffer and
+	// the world bounds of objects are tested against it before draws are issued.
+	// Occluder triangles are clipped against the near plane, set up and binned to screen bins in parallel on the job system. Bins are then rasterized
+	// in parallel, front to back and four pixels at a time with SSE when available, skipping pixels already nearer than the whole triangle. The buffer
+	// holds the inverse view depth of the nearest occluder at each pixel center.
+	// Depth is conservative: every pixel stores the farthest depth of the covering triangle's plane over the pixel's area. The farthest depth of every
+	// TileSize * TileSize tile is kept as a second level so that most objects are resolved from a few tiles.
+	// An object is occluded when its nearest depth is behind the stored depth of every pixel its projected bounds touch, dilated by one pixel so that
+	// objects seen past an occluder's silhouette through partially covered pixels stay visible. Objects crossing the near plane are always visible.
+	// Scratch memory is retained between frames. Does not depend on a renderer api and can be used headless.
+	class OcclusionCullingStage
+	{
+	public:
+		static constexpr uint32_t DefaultWidth = 320;
+		static constexpr uint32_t DefaultHeight = 192;
+		static constexpr uint32_t TileSize = 8;
+		// Screen bins rasterized per job. Multiples of TileSize.
+		static constexpr uint32_t BinWidth = 64;
+		static constexpr uint32_t BinHeight = 32;
+		// Number of occluder triangles set up per job and objects tested per job.
+		static constexpr size_t TrianglesPerJob = 128;
+		static constexpr size_t ObjectsPerJob = 512;
+
+	private:
+		struct Occluder
+		{
+			std::vector<LeviathanCore::MathTypes::Vector3> Positions = {};
+			std::vector<uint32_t> Indices = {};
+			LeviathanCore::MathTypes::Matrix4x4 Transform = {};
+			bool DoubleSided = false;
+			bool Valid = false;
+		};
+
+		// Screen space triangle ready for rasterization. Edge functions are positive inside the triangle. Depth is the plane of the inverse view
+		// depth lowered by its largest change over half a pixel, but never below the depth of the triangle's farthest vertex.
+		struct TriangleSetup
+		{
+			float EdgeA[3] = {};
+			float EdgeB[3] = {};
+			float EdgeC[3] = {};
+			float DepthA = 0.0f;
+			float DepthB = 0.0f;
+			float DepthC = 0.0f;
+			float DepthMin = 0.0f;
+			// Depth of the triangle's nearest vertex.
+			float DepthMax = 0.0f;
+			// Inclusive pixel bounds of the covered pixel centers clamped to the buffer.
+			int32_t MinX = 0;
+			int32_t MinY = 0;
+			int32_t MaxX = 0;
+			int32_t MaxY = 0;
+		};
+
+		struct ThreadScratch
+		{
+			std::vector<TriangleSetup> Triangles = {};
+			// Indices into Triangles of the triangles overlapping each bin.
+			std::vector<std::vector<uint32_t>> BinTriangles = {};
+			// Triangles of the bin being rasterized in front to back order.
+			std::vector<const TriangleSetup*> SortedTriangles = {};
+		};
+
+		uint32_t Width = DefaultWidth;
+		uint32_t Height = DefaultHeight;
+
+		std::vector<Occluder> Occluders = {};
+		std::vector<OccluderId> FreeOccluderIds = {};
+
+		// Clip matrix of every occluder and the first triangle of every occluder in the frame's triangle range. Invalid occluders have no triangles.
+		std::vector<LeviathanCore::MathTypes::Matrix4x4> OccluderClipMatrices = {};
+		std::vector<size_t> OccluderTriangleOffsets = {};
+
+		// View projection matrix and near plane depth of the last RenderOccluders.
+		LeviathanCore::MathTypes::Matrix4x4 ViewProjectionMatrix = {};
+		float NearZ = 0.1f;
+
+		// Inverse view depth of the nearest occluder at every pixel, 0 where no occluder was rasterized. Row 0 is the top of the view.
+		std::vector<float> DepthBuffer = {};
+		// Farthest inverse view depth of every tile.
+		std::vector<float> TileDepths = {};
+
+		std::vector<uint32_t> VisibleIndices = {};
+		size_t VisibleCount = 0;
+		std::vector<uint8_t> ScratchResults = {};
+
+		std::vector<ThreadScratch> Scratch = {};
+		OcclusionCullingStats Stats = {};
+
+	public:
+		// Sets the depth buffer resolution. Fails if a dimension is 0 or not a multiple of TileSize.
+		bool Initialize(uint32_t width, uint32_t height);
+
+		OccluderId CreateOccluder(const OccluderDescription& description);
+		void DestroyOccluder(OccluderId occluder);
+		void SetOccluderTransform(OccluderId occluder, const LeviathanCore::MathTypes::Matrix4x4& transform);
+		void ClearOccluders();
+
+		inline bool IsValid(const OccluderId occluder) const { return (occluder < Occluders.size()) && Occluders[occluder].Valid; }
+		inline size_t GetOccluderCount() const { return Occluders.size() - FreeOccluderIds.size(); }
+
+		// Rasterizes the occluders seen from the view. The view must use a perspective projection.
+		void RenderOccluders(const Camera& view);
+
+		// Tests the world bounds of the objects in indices against the depth of the last RenderOccluders and produces the list of visible objects in the
+		// order of indices.
+		void Cull(const LeviathanCore::BoundingVolumes::AABBSoA& worldBounds, const uint32_t* indices, size_t count);
+
+		// Returns whether the world space box is hidden by the occluders of the last RenderOccluders.
+		bool IsOccluded(const LeviathanCore::BoundingVolumes::AABB& bounds) const;
+
+		inline const uint32_t* GetVisibleIndices() const { return VisibleIndices.data(); }
+		inline size_t GetVisibleCount() const { return VisibleCount; }
+
+		inline uint32_t GetWidth() const { return Width; }
+		inline uint32_t GetHeight() const { return Height; }
+		inline const float* GetDepthBuffer() const { return DepthBuffer.data(); }
+		inline const OcclusionCullingStats& GetStats() const { return Stats; }
+		inline void ResetStats() { Stats = {}; }
+
+	private:
+		inline uint32_t GetTileCountX() const { return Width / TileSize; }
+		inline uint32_t GetTileCountY() const { return Height / TileSize; }
+		inline uint32_t GetBinCountX() const { return (Width + BinWidth - 1) / BinWidth; }
+		inline uint32_t GetBinCountY() const { return (Height + BinHeight - 1) / BinHeight; }
+
+		void SetupTriangle(const Occluder& occluder, const LeviathanCore::MathTypes::Matrix4x4& clipMatrix, size_t triangle, ThreadScratch& scratch) const;
+		void RasterizeBin(uint32_t binX, uint32_t binY, ThreadScratch& scratch);
+	};
+}
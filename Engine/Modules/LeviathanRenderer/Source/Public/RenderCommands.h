@@ -0,0 +1,437 @@
+#pragma once
+
+#include "RendererResourceId.h"
+
+namespace LeviathanRenderer
+{
+	namespace RenderCommands
+	{
+		enum class Pipeline : uint8_t
+		{
+			AmbientLight,
+			DirectionalLight,
+			PointLight,
+			SpotLight,
+			PostProcess
+		};
+
+		enum class RenderTarget : uint8_t
+		{
+			Screen,
+			Scene
+		};
+
+		enum class BlendState : uint8_t
+		{
+			Disabled,
+			Additive
+		};
+
+		enum class DepthStencilState : uint8_t
+		{
+			WriteDepthDepthFuncLess,
+			WriteDepthDepthFuncLessEqual,
+			NoWriteDepthDepthFuncEqual,
+			NoWriteDepthDepthFuncLess,
+			Disabled
+		};
+
+		// Texture and sampler binding slots. Every slot has a shader resource and a sampler.
+		enum class TextureSlot : uint8_t
+		{
+			Environment,
+			Color,
+			Metallic,
+			Roughness,
+			Normal
+		};
+
+		static constexpr size_t TextureSlotCount = static_cast<size_t>(TextureSlot::Normal) + 1;
+
+		enum class ConstantBuffer : uint8_t
+		{
+			Object,
+			DirectionalLight,
+			PointLight,
+			SpotLight,
+			Skybox
+		};
+
+		static constexpr size_t ConstantBufferCount = static_cast<size_t>(ConstantBuffer::Skybox) + 1;
+
+		enum class CommandType : uint8_t
+		{
+			ClearRenderTarget,
+			ClearDepthStencil,
+			SetRenderTarget,
+			SetPipeline,
+			SetSkyboxPipeline,
+			SetBlendState,
+			SetDepthStencilState,
+			SetTexture,
+			SetSampler,
+			UpdateConstantBuffer,
+			SetConstantBufferRange,
+			DrawIndexed,
+			DrawIndexedInstanced,
+			UnbindShaderResources
+		};
+
+		static constexpr size_t CommandTypeCount = static_cast<size_t>(CommandType::UnbindShaderResources) + 1;
+
+		// Commands are stored in 8 byte words. Every command starts with its type. UpdateConstantBufferCommand is followed by ByteWidth bytes of data.
+		struct ClearRenderTargetCommand
+		{
+			CommandType Type = CommandType::ClearRenderTarget;
+			RenderTarget Target = RenderTarget::Screen;
+			std::array<float, 4> Color = {};
+		};
+
+		struct ClearDepthStencilCommand
+		{
+			CommandType Type = CommandType::ClearDepthStencil;
+			uint8_t Stencil = 0;
+			float Depth = 1.0f;
+		};
+
+		struct SetRenderTargetCommand
+		{
+			CommandType Type = CommandType::SetRenderTarget;
+			RenderTarget Target = RenderTarget::Screen;
+		};
+
+		struct SetPipelineCommand
+		{
+			CommandType Type = CommandType::SetPipeline;
+			Pipeline PipelineType = Pipeline::AmbientLight;
+			// Shader permutation key of the pipeline's pixel shader. Pipelines without permutations ignore it.
+			uint32_t Permutation = 0;
+		};
+
+		struct SetSkyboxPipelineCommand
+		{
+			CommandType Type = CommandType::SetSkyboxPipeline;
+			RendererResourceId::IdType TextureCube = RendererResourceId::InvalidId;
+			RendererResourceId::IdType Sampler = RendererResourceId::InvalidId;
+		};
+
+		struct SetBlendStateCommand
+		{
+			CommandType Type = CommandType::SetBlendState;
+			BlendState State = BlendState::Disabled;
+		};
+
+		struct SetDepthStencilStateCommand
+		{
+			CommandType Type = CommandType::SetDepthStencilState;
+			DepthStencilState State = DepthStencilState::Disabled;
+		};
+
+		// Used for both SetTexture and SetSampler.
+		struct SetResourceCommand
+		{
+			CommandType Type = CommandType::SetTexture;
+			TextureSlot Slot = TextureSlot::Color;
+			RendererResourceId::IdType Resource = RendererResourceId::InvalidId;
+		};
+
+		struct UpdateConstantBufferCommand
+		{
+			CommandType Type = CommandType::UpdateConstantBuffer;
+			ConstantBuffer Buffer = ConstantBuffer::Object;
+			uint32_t ByteWidth = 0;
+		};
+
+		// Binds ByteWidth bytes at Offset of the frame's constant upload buffer to a constant buffer.
+		struct SetConstantBufferRangeCommand
+		{
+			CommandType Type = CommandType::SetConstantBufferRange;
+			ConstantBuffer Buffer = ConstantBuffer::Object;
+			uint32_t Offset = 0;
+			uint32_t ByteWidth = 0;
+		};
+
+		struct DrawIndexedCommand
+		{
+			CommandType Type = CommandType::DrawIndexed;
+			uint32_t IndexCount = 0;
+			uint32_t VertexStrideBytes = 0;
+			RendererResourceId::IdType VertexBuffer = RendererResourceId::InvalidId;
+			RendererResourceId::IdType IndexBuffer = RendererResourceId::InvalidId;
+		};
+
+		// Draws instanceCount instances reading per instance data from the frame's instance stream starting at firstInstance.
+		struct DrawIndexedInstancedCommand
+		{
+			CommandType Type = CommandType::DrawIndexedInstanced;
+			uint32_t IndexCount = 0;
+			uint32_t VertexStrideBytes = 0;
+			uint32_t InstanceCount = 0;
+			uint32_t FirstInstance = 0;
+			RendererResourceId::IdType VertexBuffer = RendererResourceId::InvalidId;
+			RendererResourceId::IdType IndexBuffer = RendererResourceId::InvalidId;
+		};
+
+		struct UnbindShaderResourcesCommand
+		{
+			CommandType Type = CommandType::UnbindShaderResources;
+		};
+
+		// Sort key layout from the most to the least significant bits: pass (8), pipeline (8), material (24) and depth (24). Packets execute in ascending
+		// key order so draws are grouped by pass, then by pipeline and material to minimize state changes, then front to back.
+		static constexpr uint32_t SortKeyMaterialMask = (1u << 24) - 1;
+		static constexpr uint32_t SortKeyDepthMask = (1u << 24) - 1;
+
+		inline constexpr uint64_t MakeSortKey(const uint8_t pass, const uint8_t pipeline, const uint32_t material, const uint32_t depth)
+		{
+			return (static_cast<uint64_t>(pass) << 56) | (static_cast<uint64_t>(pipeline) << 48) | (static_cast<uint64_t>(material & SortKeyMaterialMask) << 24) |
+				static_cast<uint64_t>(depth & SortKeyDepthMask);
+		}
+
+		// Quantizes a view space depth in [nearZ, farZ] to the depth field of a sort key. Back to front ordering, e.g. for blended draws, can use
+		// SortKeyDepthMask - QuantizeDepth(...).
+		uint32_t QuantizeDepth(float viewDepth, float nearZ, float farZ);
+
+		// Linear buffer of render commands grouped into packets. Each packet is a sequence of commands tagged with a sort key that executes as a unit so
+		// state set inside a packet applies to the draws recorded after it in the same packet. Buffers retain their memory between frames and can be
+		// executed any number of times. A buffer must only be recorded from one thread at a time.
+		class CommandBuffer
+		{
+		public:
+			struct Packet
+			{
+				uint64_t SortKey = 0;
+				// Range of the packet's commands in words.
+				uint32_t First = 0;
+				uint32_t End = 0;
+			};
+
+		private:
+			std::vector<uint64_t> Words = {};
+			std::vector<Packet> Packets = {};
+
+		public:
+			// Starts a new packet. Commands recorded before the first BeginPacket go into a packet with a sort key of 0.
+			void BeginPacket(uint64_t sortKey);
+
+			void ClearRenderTarget(RenderTarget target, const float* color);
+			void ClearDepthStencil(float depth, uint8_t stencil);
+			void SetRenderTarget(RenderTarget target);
+			void SetPipeline(Pipeline pipeline, uint32_t permutation = 0);
+			void SetSkyboxPipeline(RendererResourceId::IdType textureCubeId, RendererResourceId::IdType samplerId);
+			void SetBlendState(BlendState state);
+			void SetDepthStencilState(DepthStencilState state);
+			void SetTexture(TextureSlot slot, RendererResourceId::IdType textureId);
+			void SetSampler(TextureSlot slot, RendererResourceId::IdType samplerId);
+			// Copies byteWidth bytes of data into the buffer.
+			void UpdateConstantBuffer(ConstantBuffer buffer, const void* data, uint32_t byteWidth);
+			// References data already written to the frame's constant upload buffer, see UploadRing.
+			void SetConstantBufferRange(ConstantBuffer buffer, uint32_t offset, uint32_t byteWidth);
+			void DrawIndexed(uint32_t indexCount, uint32_t vertexStrideBytes, RendererResourceId::IdType vertexBufferId, RendererResourceId::IdType indexBufferId);
+			void DrawIndexedInstanced(uint32_t indexCount, uint32_t vertexStrideBytes, RendererResourceId::IdType vertexBufferId,
+				RendererResourceId::IdType indexBufferId, uint32_t instanceCount, uint32_t firstInstance);
+			void UnbindShaderResources();
+
+			// Removes every command and packet and keeps the memory.
+			void Reset();
+
+			inline const std::vector<Packet>& GetPackets() const { return Packets; }
+			inline size_t GetSizeBytes() const { return Words.size() * sizeof(uint64_t); }
+
+			// Decodes the commands of a packet and calls the matching backend functions. Backend is any type with the member functions
+			// ClearRenderTarget(RenderTarget, const float*), ClearDepthStencil(float, uint8_t), SetRenderTarget(RenderTarget), SetPipeline(Pipeline, uint32_t),
+			// SetSkyboxPipeline(IdType, IdType), SetBlendState(BlendState), SetDepthStencilState(DepthStencilState), SetTexture(TextureSlot, IdType),
+			// SetSampler(TextureSlot, IdType), UpdateConstantBuffer(ConstantBuffer, const void*, uint32_t),
+			// SetConstantBufferRange(ConstantBuffer, uint32_t, uint32_t), DrawIndexed(uint32_t, uint32_t, IdType, IdType),
+			// DrawIndexedInstanced(uint32_t, uint32_t, IdType, IdType, uint32_t, uint32_t) and UnbindShaderResources().
+			template <typename Backend>
+			void ExecutePacket(size_t packetIndex, Backend& backend) const;
+
+			// Executes every packet in recording order.
+			template <typename Backend>
+			void Execute(Backend& backend) const
+			{
+				for (size_t i = 0; i < Packets.size(); ++i)
+				{
+					ExecutePacket(i, backend);
+				}
+			}
+
+		private:
+			template <typename Command>
+			void Write(const Command& command, const void* payload = nullptr, size_t payloadSizeBytes = 0);
+
+			template <typename Command>
+			inline Command Read(const size_t word) const
+			{
+				Command command = {};
+				memcpy(static_cast<void*>(&command), &Words[word], sizeof(Command));
+				return command;
+			}
+
+			static constexpr size_t WordCount(const size_t sizeBytes) { return (sizeBytes + sizeof(uint64_t) - 1) / sizeof(uint64_t); }
+		};
+
+		// Set of command buffers, one for each recording thread, that are sorted together by packet sort key and executed as one stream. Threads record
+		// into the buffer of their job system thread index in parallel. Sort orders the packets of every buffer on the job system and merges the sorted
+		// buffers. Packets with equal keys execute in buffer order then recording order.
+		class CommandQueue
+		{
+		public:
+			struct SortedPacket
+			{
+				uint64_t SortKey = 0;
+				uint32_t Buffer = 0;
+				uint32_t Packet = 0;
+			};
+
+		private:
+			std::vector<CommandBuffer> Buffers = {};
+			std::vector<SortedPacket> Order = {};
+			std::vector<SortedPacket> ScratchOrder = {};
+			std::vector<size_t> RunOffsets = {};
+
+		public:
+			// Resets every buffer and makes sure there is a buffer for each of bufferCount threads, e.g. JobSystem::GetThreadCount().
+			void Reset(size_t bufferCount);
+
+			inline CommandBuffer& GetBuffer(const size_t bufferIndex) { return Buffers[bufferIndex]; }
+			inline const CommandBuffer& GetBuffer(const size_t bufferIndex) const { return Buffers[bufferIndex]; }
+			inline size_t GetBufferCount() const { return Buffers.size(); }
+
+			// Sorts the packets of all buffers. Must be called after recording and before Execute.
+			void Sort();
+
+			inline const std::vector<SortedPacket>& GetSortedPackets() const { return Order; }
+
+			// Executes the packets of all buffers in sort key order. See CommandBuffer::ExecutePacket for the backend requirements.
+			template <typename Backend>
+			void Execute(Backend& backend) const
+			{
+				for (const SortedPacket& packet : Order)
+				{
+					Buffers[packet.Buffer].ExecutePacket(packet.Packet, backend);
+				}
+			}
+		};
+
+		template <typename Backend>
+		void CommandBuffer::ExecutePacket(const size_t packetIndex, Backend& backend) const
+		{
+			const Packet& packet = Packets[packetIndex];
+			size_t word = packet.First;
+			while (word < packet.End)
+			{
+				CommandType type = {};
+				memcpy(&type, &Words[word], sizeof(CommandType));
+
+				switch (type)
+				{
+				case CommandType::ClearRenderTarget:
+				{
+					const ClearRenderTargetCommand command = Read<ClearRenderTargetCommand>(word);
+					backend.ClearRenderTarget(command.Target, command.Color.data());
+					word += WordCount(sizeof(command));
+					break;
+				}
+				case CommandType::ClearDepthStencil:
+				{
+					const ClearDepthStencilCommand command = Read<ClearDepthStencilCommand>(word);
+					backend.ClearDepthStencil(command.Depth, command.Stencil);
+					word += WordCount(sizeof(command));
+					break;
+				}
+				case CommandType::SetRenderTarget:
+				{
+					const SetRenderTargetCommand command = Read<SetRenderTargetCommand>(word);
+					backend.SetRenderTarget(command.Target);
+					word += WordCount(sizeof(command));
+					break;
+				}
+				case CommandType::SetPipeline:
+				{
+					const SetPipelineCommand command = Read<SetPipelineCommand>(word);
+					backend.SetPipeline(command.PipelineType, command.Permutation);
+					word += WordCount(sizeof(command));
+					break;
+				}
+				case CommandType::SetSkyboxPipeline:
+				{
+					const SetSkyboxPipelineCommand command = Read<SetSkyboxPipelineCommand>(word);
+					backend.SetSkyboxPipeline(command.TextureCube, command.Sampler);
+					word += WordCount(sizeof(command));
+					break;
+				}
+				case CommandType::SetBlendState:
+				{
+					const SetBlendStateCommand command = Read<SetBlendStateCommand>(word);
+					backend.SetBlendState(command.State);
+					word += WordCount(sizeof(command));
+					break;
+				}
+				case CommandType::SetDepthStencilState:
+				{
+					const SetDepthStencilStateCommand command = Read<SetDepthStencilStateCommand>(word);
+					backend.SetDepthStencilState(command.State);
+					word += WordCount(sizeof(command));
+					break;
+				}
+				case CommandType::SetTexture:
+				{
+					const SetResourceCommand command = Read<SetResourceCommand>(word);
+					backend.SetTexture(command.Slot, command.Resource);
+					word += WordCount(sizeof(command));
+					break;
+				}
+				case CommandType::SetSampler:
+				{
+					const SetResourceCommand command = Read<SetResourceCommand>(word);
+					backend.SetSampler(command.Slot, command.Resource);
+					word += WordCount(sizeof(command));
+					break;
+				}
+				case CommandType::UpdateConstantBuffer:
+				{
+					const UpdateConstantBufferCommand command = Read<UpdateConstantBufferCommand>(word);
+					word += WordCount(sizeof(command));
+					backend.UpdateConstantBuffer(command.Buffer, &Words[word], command.ByteWidth);
+					word += WordCount(command.ByteWidth);
+					break;
+				}
+				case CommandType::SetConstantBufferRange:
+				{
+					const SetConstantBufferRangeCommand command = Read<SetConstantBufferRangeCommand>(word);
+					backend.SetConstantBufferRange(command.Buffer, command.Offset, command.ByteWidth);
+					word += WordCount(sizeof(command));
+					break;
+				}
+				case CommandType::DrawIndexed:
+				{
+					const DrawIndexedCommand command = Read<DrawIndexedCommand>(word);
+					backend.DrawIndexed(command.IndexCount, command.VertexStrideBytes, command.VertexBuffer, command.IndexBuffer);
+					word += WordCount(sizeof(command));
+					break;
+				}
+				case CommandType::DrawIndexedInstanced:
+				{
+					const DrawIndexedInstancedCommand command = Read<DrawIndexedInstancedCommand>(word);
+					backend.DrawIndexedInstanced(command.IndexCount, command.VertexStrideBytes, command.VertexBuffer, command.IndexBuffer, command.InstanceCount,
+						command.FirstInstance);
+					word += WordCount(sizeof(command));
+					break;
+				}
+				case CommandType::UnbindShaderResources:
+				{
+					backend.UnbindShaderResources();
+					word += WordCount(sizeof(UnbindShaderResourcesCommand));
+					break;
+				}
+				default:
+				{
+					return;
+				}
+				}
+			}
+		}
+	}
+}
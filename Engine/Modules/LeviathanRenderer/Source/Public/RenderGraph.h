@@ -0,0 +1,149 @@
+#pragma once
+
+namespace LeviathanRenderer
+{
+	enum class RenderGraphFormat : uint8_t
+	{
+		R8Unorm,
+		R8G8B8A8Unorm,
+		R16G16B16A16Float,
+		R32Float,
+		R32G32B32A32Float,
+		D24UnormS8Uint
+	};
+
+	struct RenderGraphTextureDescription
+	{
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+		RenderGraphFormat Format = RenderGraphFormat::R8G8B8A8Unorm;
+	};
+
+	struct RenderGraphStats
+	{
+		size_t PassCount = 0;
+		size_t CulledPassCount = 0;
+		size_t TransientResourceCount = 0;
+		// Transient resources accessed by passes that were not culled. Only these are placed in the transient heap.
+		size_t AllocatedResourceCount = 0;
+		// Bytes of the allocated transient resources if each had its own memory, and the transient heap size with aliasing.
+		uint64_t TransientBytes = 0;
+		uint64_t HeapBytes = 0;
+	};
+
+	// Render graph front end. Passes are declared in execution order with the virtual resources they read and write. Compiling culls passes that
+	// contribute nothing to the graph's outputs, computes the lifetime of every transient resource as the range of surviving passes accessing it and
+	// places transient resources in a single heap, aliasing the memory of resources whose lifetimes do not overlap.
+	// A pass that partially updates a resource, e.g. blending into a render target or depth testing against a depth buffer, reads and writes it.
+	// Imported resources, e.g. the back buffer or history from the previous frame, are owned outside the graph and never aliased.
+	// Heap offsets are aligned to PlacementAlignmentBytes, the tile size of tiled and placed resources. Declarations and scratch memory are retained
+	// between frames. Does not depend on a renderer api and can be used headless.
+	class RenderGraph
+	{
+	public:
+		using ResourceHandle = uint32_t;
+		static constexpr ResourceHandle InvalidResource = std::numeric_limits<ResourceHandle>::max();
+		static constexpr uint32_t InvalidPass = std::numeric_limits<uint32_t>::max();
+		static constexpr uint64_t PlacementAlignmentBytes = 64 * 1024;
+
+	private:
+		struct Resource
+		{
+			RenderGraphTextureDescription Description = {};
+			uint64_t SizeBytes = 0;
+			bool Imported = false;
+			bool Output = false;
+		};
+
+		struct Pass
+		{
+			uint32_t FirstAccess = 0;
+			uint32_t AccessCount = 0;
+			bool HasSideEffects = false;
+		};
+
+		struct Access
+		{
+			ResourceHandle Resource = 0;
+			bool Write = false;
+		};
+
+		// Declarations.
+		std::vector<Resource> Resources = {};
+		std::vector<Pass> Passes = {};
+		std::vector<Access> Accesses = {};
+		bool DeclarationError = false;
+
+		// Compiled graph. Lifetimes are indices into CompiledPasses, heap offsets are only valid for allocated transient resources.
+		std::vector<uint32_t> CompiledPasses = {};
+		std::vector<uint8_t> PassCulled = {};
+		std::vector<uint32_t> FirstUse = {};
+		std::vector<uint32_t> LastUse = {};
+		std::vector<uint64_t> HeapOffsets = {};
+		// Allocated transient resources first used by each compiled pass, for aliasing barriers or discards before the pass writes them.
+		std::vector<uint32_t> FirstUseOffsets = {};
+		std::vector<ResourceHandle> FirstUseResources = {};
+		RenderGraphStats Stats = {};
+
+		// Compile scratch memory.
+		std::vector<uint8_t> Needed = {};
+		std::vector<ResourceHandle> PlacementOrder = {};
+		std::vector<ResourceHandle> PlacedByOffset = {};
+
+	public:
+		// Removes every pass and resource. Memory is kept for the next frame's declarations.
+		void Reset();
+
+		// Declares a transient resource allocated and aliased by the graph.
+		ResourceHandle CreateTexture(const RenderGraphTextureDescription& description);
+		// Declares a resource owned outside the graph. Its contents are defined before the first pass.
+		ResourceHandle ImportTexture(const RenderGraphTextureDescription& description);
+		// Marks a resource as a result of the graph, read after the last pass. Passes producing it are never culled.
+		void MarkOutput(ResourceHandle resource);
+
+		// Adds a pass after every declared pass and returns its index. Reads and writes declared next belong to it. Passes with side effects outside
+		// the graph, e.g. readbacks, are never culled.
+		uint32_t AddPass(bool hasSideEffects = false);
+		void Read(ResourceHandle resource);
+		void Write(ResourceHandle resource);
+
+		// Culls passes, computes lifetimes and places transient resources. Returns false if a declaration referenced an invalid resource or pass, or
+		// a surviving pass reads a transient resource no earlier pass wrote. Compiling again without changing declarations gives the same result.
+		bool Compile();
+
+		// Calls executor.ExecutePass(passIndex) for every pass that was not culled in declaration order.
+		template<typename Executor>
+		void Execute(Executor& executor) const
+		{
+			for (const uint32_t pass : CompiledPasses)
+			{
+				executor.ExecutePass(pass);
+			}
+		}
+
+		inline size_t GetPassCount() const { return Passes.size(); }
+		inline size_t GetResourceCount() const { return Resources.size(); }
+		inline const uint32_t* GetCompiledPasses() const { return CompiledPasses.data(); }
+		inline size_t GetCompiledPassCount() const { return CompiledPasses.size(); }
+		inline bool IsPassCulled(const uint32_t pass) const { return PassCulled[pass] != 0; }
+		inline bool IsImported(const ResourceHandle resource) const { return Resources[resource].Imported; }
+		inline const RenderGraphTextureDescription& GetDescription(const ResourceHandle resource) const { return Resources[resource].Description; }
+		inline uint64_t GetSizeBytes(const ResourceHandle resource) const { return Resources[resource].SizeBytes; }
+		// Whether a transient resource is accessed by a pass that was not culled and has memory in the transient heap.
+		inline bool IsAllocated(const ResourceHandle resource) const { return FirstUse[resource] != InvalidPass; }
+		// Compiled pass indices of the first and last pass accessing an allocated transient resource.
+		inline uint32_t GetFirstUse(const ResourceHandle resource) const { return FirstUse[resource]; }
+		inline uint32_t GetLastUse(const ResourceHandle resource) const { return LastUse[resource]; }
+		inline uint64_t GetHeapOffset(const ResourceHandle resource) const { return HeapOffsets[resource]; }
+		inline uint64_t GetHeapSizeBytes() const { return Stats.HeapBytes; }
+		inline const ResourceHandle* GetFirstUseResources(const size_t compiledPass) const { return FirstUseResources.data() + FirstUseOffsets[compiledPass]; }
+		inline size_t GetFirstUseResourceCount(const size_t compiledPass) const { return FirstUseOffsets[compiledPass + 1] - FirstUseOffsets[compiledPass]; }
+		inline const RenderGraphStats& GetStats() const { return Stats; }
+
+		static uint32_t GetBytesPerPixel(RenderGraphFormat format);
+
+	private:
+		ResourceHandle AddResource(const RenderGraphTextureDescription& description, bool imported);
+		void AddAccess(ResourceHandle resource, bool write);
+	};
+}
@@ -0,0 +1,258 @@
+#pragma once
+
+#include "RenderCommands.h"
+
+namespace LeviathanRenderer
+{
+	namespace RenderCommands
+	{
+		// Number of backend calls issued and elided by a StateFilteringBackend for each command type.
+		struct StateFilterStats
+		{
+			std::array<uint32_t, CommandTypeCount> IssuedCalls = {};
+			std::array<uint32_t, CommandTypeCount> ElidedCalls = {};
+
+			uint32_t GetIssuedCallCount() const;
+			uint32_t GetElidedCallCount() const;
+		};
+
+		// Hash of constant buffer data used to detect uploads of unchanged contents.
+		uint64_t HashConstantBufferData(const void* data, size_t sizeBytes);
+
+		// Command execution backend that forwards to another backend and drops calls that would set state the target already has. Shadows the render
+		// target, blend and depth stencil states, the bound pipeline and its permutation, the texture and sampler of every slot and the hash of every
+		// constant buffer's contents or the upload buffer range bound to it. Clears and draws are always forwarded.
+		// Textures and samplers are written to tables that are bound when a pipeline is set, so setting the current pipeline again is only elided when no
+		// texture or sampler changed since. Unbinding shader resources or changing the render target forgets the bound pipeline for the same reason.
+		// Shadowed state starts unknown so the first call of every kind is forwarded. Use a new filter or call Invalidate when the target's state may have
+		// changed outside of the filter, e.g. at the start of a frame.
+		template <typename Backend>
+		class StateFilteringBackend
+		{
+		private:
+			static constexpr uint8_t UnknownState = 0xff;
+			// Shadowed pipeline value for the skybox pipeline, which is set with its resources.
+			static constexpr uint8_t SkyboxPipeline = 0xfe;
+
+			// Constant buffers either hold uploaded contents identified by their hash or are bound to a range of the upload buffer.
+			struct ConstantBufferState
+			{
+				uint64_t Hash = 0;
+				uint32_t Offset = 0;
+				uint32_t ByteWidth = 0;
+				bool Known = false;
+				bool Range = false;
+			};
+
+			Backend& Target;
+			StateFilterStats Stats = {};
+
+			uint8_t CurrentRenderTarget = UnknownState;
+			uint8_t CurrentBlendState = UnknownState;
+			uint8_t CurrentDepthStencilState = UnknownState;
+			uint8_t CurrentPipeline = UnknownState;
+			uint32_t CurrentPermutation = 0;
+			RendererResourceId::IdType CurrentSkyboxTextureCube = RendererResourceId::InvalidId;
+			RendererResourceId::IdType CurrentSkyboxSampler = RendererResourceId::InvalidId;
+			std::array<RendererResourceId::IdType, TextureSlotCount> CurrentTextures = {};
+			std::array<RendererResourceId::IdType, TextureSlotCount> CurrentSamplers = {};
+			std::array<bool, TextureSlotCount> TextureKnown = {};
+			std::array<bool, TextureSlotCount> SamplerKnown = {};
+			std::array<ConstantBufferState, ConstantBufferCount> ConstantBuffers = {};
+
+		public:
+			explicit StateFilteringBackend(Backend& target)
+				: Target(target)
+			{
+			}
+
+			// Forgets all shadowed state so the next call of every kind is forwarded. Does not reset stats.
+			void Invalidate()
+			{
+				CurrentRenderTarget = UnknownState;
+				CurrentBlendState = UnknownState;
+				CurrentDepthStencilState = UnknownState;
+				CurrentPipeline = UnknownState;
+				TextureKnown = {};
+				SamplerKnown = {};
+				ConstantBuffers = {};
+			}
+
+			inline void ResetStats() { Stats = {}; }
+			inline const StateFilterStats& GetStats() const { return Stats; }
+
+			void ClearRenderTarget(const RenderTarget target, const float* color)
+			{
+				Issue(CommandType::ClearRenderTarget);
+				Target.ClearRenderTarget(target, color);
+			}
+
+			void ClearDepthStencil(const float depth, const uint8_t stencil)
+			{
+				Issue(CommandType::ClearDepthStencil);
+				Target.ClearDepthStencil(depth, stencil);
+			}
+
+			void SetRenderTarget(const RenderTarget target)
+			{
+				if (Filter(CommandType::SetRenderTarget, CurrentRenderTarget, static_cast<uint8_t>(target)))
+				{
+					// Binding a render target unbinds shader resource views of the same texture.
+					CurrentPipeline = UnknownState;
+					Target.SetRenderTarget(target);
+				}
+			}
+
+			void SetPipeline(const Pipeline pipeline, const uint32_t permutation)
+			{
+				if ((CurrentPipeline == static_cast<uint8_t>(pipeline)) && (CurrentPermutation == permutation))
+				{
+					Elide(CommandType::SetPipeline);
+					return;
+				}
+
+				CurrentPipeline = static_cast<uint8_t>(pipeline);
+				CurrentPermutation = permutation;
+				Issue(CommandType::SetPipeline);
+				Target.SetPipeline(pipeline, permutation);
+			}
+
+			void SetSkyboxPipeline(const RendererResourceId::IdType textureCubeId, const RendererResourceId::IdType samplerId)
+			{
+				if ((CurrentPipeline == SkyboxPipeline) && (CurrentSkyboxTextureCube == textureCubeId) && (CurrentSkyboxSampler == samplerId))
+				{
+					Elide(CommandType::SetSkyboxPipeline);
+					return;
+				}
+
+				CurrentPipeline = SkyboxPipeline;
+				CurrentSkyboxTextureCube = textureCubeId;
+				CurrentSkyboxSampler = samplerId;
+				Issue(CommandType::SetSkyboxPipeline);
+				Target.SetSkyboxPipeline(textureCubeId, samplerId);
+			}
+
+			void SetBlendState(const BlendState state)
+			{
+				if (Filter(CommandType::SetBlendState, CurrentBlendState, static_cast<uint8_t>(state)))
+				{
+					Target.SetBlendState(state);
+				}
+			}
+
+			void SetDepthStencilState(const DepthStencilState state)
+			{
+				if (Filter(CommandType::SetDepthStencilState, CurrentDepthStencilState, static_cast<uint8_t>(state)))
+				{
+					Target.SetDepthStencilState(state);
+				}
+			}
+
+			void SetTexture(const TextureSlot slot, const RendererResourceId::IdType textureId)
+			{
+				if (FilterResource(CommandType::SetTexture, TextureKnown[static_cast<size_t>(slot)], CurrentTextures[static_cast<size_t>(slot)], textureId))
+				{
+					Target.SetTexture(slot, textureId);
+				}
+			}
+
+			void SetSampler(const TextureSlot slot, const RendererResourceId::IdType samplerId)
+			{
+				if (FilterResource(CommandType::SetSampler, SamplerKnown[static_cast<size_t>(slot)], CurrentSamplers[static_cast<size_t>(slot)], samplerId))
+				{
+					Target.SetSampler(slot, samplerId);
+				}
+			}
+
+			void UpdateConstantBuffer(const ConstantBuffer buffer, const void* data, const uint32_t byteWidth)
+			{
+				ConstantBufferState& state = ConstantBuffers[static_cast<size_t>(buffer)];
+				const uint64_t hash = HashConstantBufferData(data, byteWidth);
+				if ((state.Known) && (!state.Range) && (state.Hash == hash) && (state.ByteWidth == byteWidth))
+				{
+					Elide(CommandType::UpdateConstantBuffer);
+					return;
+				}
+
+				state.Hash = hash;
+				state.ByteWidth = byteWidth;
+				state.Known = true;
+				state.Range = false;
+				Issue(CommandType::UpdateConstantBuffer);
+				Target.UpdateConstantBuffer(buffer, data, byteWidth);
+			}
+
+			void SetConstantBufferRange(const ConstantBuffer buffer, const uint32_t offset, const uint32_t byteWidth)
+			{
+				ConstantBufferState& state = ConstantBuffers[static_cast<size_t>(buffer)];
+				if ((state.Known) && (state.Range) && (state.Offset == offset) && (state.ByteWidth == byteWidth))
+				{
+					Elide(CommandType::SetConstantBufferRange);
+					return;
+				}
+
+				state.Offset = offset;
+				state.ByteWidth = byteWidth;
+				state.Known = true;
+				state.Range = true;
+				Issue(CommandType::SetConstantBufferRange);
+				Target.SetConstantBufferRange(buffer, offset, byteWidth);
+			}
+
+			void DrawIndexed(const uint32_t indexCount, const uint32_t vertexStrideBytes, const RendererResourceId::IdType vertexBufferId,
+				const RendererResourceId::IdType indexBufferId)
+			{
+				Issue(CommandType::DrawIndexed);
+				Target.DrawIndexed(indexCount, vertexStrideBytes, vertexBufferId, indexBufferId);
+			}
+
+			void DrawIndexedInstanced(const uint32_t indexCount, const uint32_t vertexStrideBytes, const RendererResourceId::IdType vertexBufferId,
+				const RendererResourceId::IdType indexBufferId, const uint32_t instanceCount, const uint32_t firstInstance)
+			{
+				Issue(CommandType::DrawIndexedInstanced);
+				Target.DrawIndexedInstanced(indexCount, vertexStrideBytes, vertexBufferId, indexBufferId, instanceCount, firstInstance);
+			}
+
+			void UnbindShaderResources()
+			{
+				CurrentPipeline = UnknownState;
+				Issue(CommandType::UnbindShaderResources);
+				Target.UnbindShaderResources();
+			}
+
+		private:
+			inline void Issue(const CommandType type) { ++Stats.IssuedCalls[static_cast<size_t>(type)]; }
+			inline void Elide(const CommandType type) { ++Stats.ElidedCalls[static_cast<size_t>(type)]; }
+
+			// Returns true if the call changes the shadowed state and must be forwarded.
+			bool Filter(const CommandType type, uint8_t& current, const uint8_t value)
+			{
+				if (current == value)
+				{
+					Elide(type);
+					return false;
+				}
+
+				current = value;
+				Issue(type);
+				return true;
+			}
+
+			// Returns true if the call changes the shadowed resource and must be forwarded. A changed resource table is bound by the next pipeline set.
+			bool FilterResource(const CommandType type, bool& known, RendererResourceId::IdType& current, const RendererResourceId::IdType value)
+			{
+				if ((known) && (current == value))
+				{
+					Elide(type);
+					return false;
+				}
+
+				known = true;
+				current = value;
+				CurrentPipeline = UnknownState;
+				Issue(type);
+				return true;
+			}
+		};
+	}
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "BoundingVolumes.h"
+#include "RendererResourceId.h"
+#include "ConstantBufferTypes.h"
+#include "LeviathanAssert.h"
+
+namespace LeviathanRenderer
+{
+	class Camera;
+	class FrustumCullingStage;
+	class OcclusionCullingStage;
+
+	using RenderableId = uint32_t;
+	static constexpr RenderableId InvalidRenderableId = std::numeric_limits<RenderableId>::max();
+
+	struct RenderMesh
+	{
+		RendererResourceId::IdType VertexBuffer = RendererResourceId::InvalidId;
+		RendererResourceId::IdType IndexBuffer = RendererResourceId::InvalidId;
+		uint32_t IndexCount = 0;
+		uint32_t VertexStrideBytes = 0;
+		// Mesh bounds in object space.
+		LeviathanCore::BoundingVolumes::AABB LocalBounds = {};
+		// Texture coordinate units per object space unit, e.g. LeviathanAssets::AssetTypes::Mesh::CalculateTextureCoordinateDensity. Selects the
+		// mips of streamed textures the mesh needs.
+		float TextureCoordinateDensity = 1.0f;
+	};
+
+	struct RenderMaterial
+	{
+		RendererResourceId::IdType ColorTexture = RendererResourceId::InvalidId;
+		RendererResourceId::IdType MetallicTexture = RendererResourceId::InvalidId;
+		RendererResourceId::IdType RoughnessTexture = RendererResourceId::InvalidId;
+		RendererResourceId::IdType NormalTexture = RendererResourceId::InvalidId;
+		RendererResourceId::IdType Sampler = RendererResourceId::InvalidId;
+	};
+
+	struct RenderableDescription
+	{
+		RenderMesh Mesh = {};
+		RenderMaterial Material = {};
+		LeviathanCore::MathTypes::Matrix4x4 Transform = {};
+	};
+
+	// Persistent set of renderables drawn every frame. Renderables are registered once and their transform, mesh or material is only touched when it
+	// changes, which updates the renderable's cached world bounds. Data is stored in dense arrays indexed by storage index so that per frame passes, e.g.
+	// culling the world bounds, stream over contiguous memory. Renderables are referenced by stable ids as destroying a renderable moves the last
+	// renderable into its storage slot.
+	class RenderWorld
+	{
+	private:
+		static constexpr uint32_t InvalidIndex = std::numeric_limits<uint32_t>::max();
+
+		std::vector<RenderMesh> Meshes = {};
+		std::vector<RenderMaterial> Materials = {};
+		std::vector<LeviathanCore::MathTypes::Matrix4x4> WorldMatrices = {};
+		LeviathanCore::BoundingVolumes::AABBArray WorldBounds = {};
+		std::vector<RenderableId> IndexToRenderable = {};
+
+		// Storage index of every renderable id, InvalidIndex for free ids.
+		std::vector<uint32_t> RenderableToIndex = {};
+		std::vector<RenderableId> FreeRenderableIds = {};
+
+	public:
+		RenderableId Create(const RenderableDescription& description);
+		void Destroy(RenderableId renderable);
+
+		void SetTransform(RenderableId renderable, const LeviathanCore::MathTypes::Matrix4x4& transform);
+		void SetMesh(RenderableId renderable, const RenderMesh& mesh);
+		void SetMaterial(RenderableId renderable, const RenderMaterial& material);
+
+		void Clear();
+
+		inline bool IsValid(const RenderableId renderable) const
+		{
+			return (renderable < RenderableToIndex.size()) && (RenderableToIndex[renderable] != InvalidIndex);
+		}
+
+		inline size_t GetCount() const { return Meshes.size(); }
+
+		// Dense per renderable data indexed by storage index in [0, GetCount()).
+		inline const RenderMesh& GetMesh(const size_t index) const { return Meshes[index]; }
+		inline const RenderMaterial& GetMaterial(const size_t index) const { return Materials[index]; }
+		inline const LeviathanCore::MathTypes::Matrix4x4& GetWorldMatrix(const size_t index) const { return WorldMatrices[index]; }
+		inline RenderableId GetRenderableId(const size_t index) const { return IndexToRenderable[index]; }
+		inline LeviathanCore::BoundingVolumes::AABBSoA GetWorldBounds() const { return WorldBounds.View(); }
+
+	private:
+		inline uint32_t GetIndex(const RenderableId renderable) const
+		{
+			LEVIATHAN_ASSERT(IsValid(renderable));
+			return RenderableToIndex[renderable];
+		}
+	};
+
+	// Visible renderables of a view in draw order, grouped by material and front to back within a material, with the object constant buffer data of
+	// each draw. Memory is retained between builds.
+	struct DrawList
+	{
+		// Storage index into the render world of each draw.
+		std::vector<uint32_t> Renderables = {};
+		std::vector<ConstantBufferTypes::ObjectConstantBuffer> ObjectData = {};
+		// Sort key of each draw with the pass and pipeline fields left 0.
+		std::vector<uint64_t> SortKeys = {};
+
+		// Sort key and storage index of each visible renderable reused between builds.
+		struct SortEntry
+		{
+			uint64_t SortKey = 0;
+			uint32_t Renderable = 0;
+		};
+		std::vector<SortEntry> ScratchEntries = {};
+
+		inline size_t GetCount() const { return Renderables.size(); }
+	};
+
+	// Culls the world against the view and builds the draw list of the visible renderables. Object data and sort keys are computed on the job system.
+	void BuildDrawList(const RenderWorld& world, const Camera& view, FrustumCullingStage& cullingStage, DrawList& outDrawList);
+
+	// Culls the world against the view, rasterizes the occlusion stage's occluders and culls the renderables inside the view hidden by them before
+	// building the draw list. Occlusion culling is skipped for views without a perspective projection and when the stage has no occluders.
+	void BuildDrawList(const RenderWorld& world, const Camera& view, FrustumCullingStage& cullingStage, OcclusionCullingStage& occlusionStage,
+		DrawList& outDrawList);
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "ShaderPermutations.h"
+
 namespace LeviathanRenderer
 {
 	namespace RendererConstants
@@ -33,5 +35,29 @@ namespace LeviathanRenderer
 		static constexpr const char* MetallicTextureSamplerTableIndexString = "3";
 		static constexpr size_t NormalTextureSamplerTableIndex = 4;
 		static constexpr const char* NormalTextureSamplerTableIndexString = "4";
+
+		// Features of the directional, point and spot light pixel shaders. Without normal mapping the surface normal is the interpolated vertex normal
+		// and the material's normal texture is not sampled.
+		static constexpr size_t LightingNormalMappingFeature = 0;
+		static constexpr std::array<ShaderFeature, 1> LightingPixelShaderFeatures =
+		{
+			ShaderFeature{ .Name = "NORMAL_MAPPING", .BitCount = 1 }
+		};
+		static constexpr ShaderPermutationKey NormalMappedLightingPermutation = SetShaderFeature(LightingPixelShaderFeatures.data(), LightingNormalMappingFeature, 0, 1);
+
+		// Frames recorded by the cpu ahead of the gpu and the size and range alignment of the upload buffer holding their constant data.
+		static constexpr size_t MaxFramesInFlight = 3;
+		static constexpr size_t ConstantUploadBufferSizeBytes = 1024 * 1024;
+		static constexpr size_t ConstantUploadAlignmentBytes = 256;
+
+		// Bytes of resource data created asynchronously per frame, e.g. a 1024x1024 rgba texture.
+		static constexpr size_t UploadBudgetBytesPerFrame = 4 * 1024 * 1024;
+
+		// Memory pool of the resident mips of streamed textures, mips streamed in per frame and the size of the tail mips always resident.
+		static constexpr size_t TextureStreamingPoolBytes = 256 * 1024 * 1024;
+		static constexpr size_t TextureStreamingBytesPerFrame = 4 * 1024 * 1024;
+		static constexpr uint32_t TextureStreamingTailSize = 64;
+		// Frames a streamed texture keeps its finest recent mips after its demand becomes coarser.
+		static constexpr uint32_t TextureStreamingHysteresisFrames = 60;
 	}
 }
\ No newline at end of file
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "Serialize.h"
+
+namespace LeviathanRenderer
+{
+	// Preprocessor definition passed to the shader compiler. Strings are null terminated so lists convert directly to renderer api macro lists.
+	struct ShaderMacro
+	{
+		const char* Name = nullptr;
+		const char* Definition = nullptr;
+	};
+
+	struct ShaderCompileDescription
+	{
+		// Path of the shader source file. Includes are resolved relative to the directory of the including file.
+		std::string_view SourceFile = {};
+		std::string_view EntryPoint = {};
+		// Compiler target profile, e.g. vs_5_0.
+		std::string_view Target = {};
+		const ShaderMacro* Macros = nullptr;
+		size_t MacroCount = 0;
+	};
+
+	// Reads the contents of a shader source file. Returns false if the file does not exist or could not be read.
+	using ShaderSourceReadFunctionType = bool(*)(std::string_view /* file */, std::string& /* outSource */, void* /* userData */);
+
+	// Compiles the source of the description's source file to bytecode. Called concurrently from job system threads. Returns false if compilation
+	// failed.
+	using ShaderCompileFunctionType = bool(*)(const ShaderCompileDescription& /* description */, std::string_view /* source */,
+		std::vector<uint8_t>& /* outBytecode */, void* /* userData */);
+
+	// Shader source files and the files they include. Files are read once and their #include directives resolved, skipping directives inside
+	// comments. Every include is treated as a dependency, including ones inside inactive preprocessor branches, so a change to any file a shader may
+	// see invalidates it.
+	class ShaderSourceGraph
+	{
+	private:
+		struct SourceFile
+		{
+			std::string Path = {};
+			std::string Source = {};
+			uint64_t ContentHash = 0;
+			// Indices of included files in include order.
+			std::vector<uint32_t> Includes = {};
+			bool Readable = false;
+		};
+
+		ShaderSourceReadFunctionType ReadFunction = nullptr;
+		void* ReadUserData = nullptr;
+		std::vector<SourceFile> Files = {};
+		std::unordered_map<std::string, uint32_t> FileIndices = {};
+
+		// Traversal scratch memory.
+		std::vector<uint32_t> VisitMarks = {};
+		uint32_t VisitGeneration = 0;
+		std::vector<uint32_t> VisitStack = {};
+
+	public:
+		ShaderSourceGraph() = default;
+		ShaderSourceGraph(ShaderSourceReadFunctionType readFunction, void* userData);
+
+		void SetReadFunction(ShaderSourceReadFunctionType readFunction, void* userData);
+
+		// Forgets every file so that changed files are read again.
+		void Clear();
+
+		// Hashes the contents and paths of the file and every file it includes directly or indirectly. Returns false if one of the files could not be
+		// read.
+		bool HashSourceTree(std::string_view file, uint64_t& outHash);
+
+		// Appends the paths of every file the file includes directly or indirectly in first include order. Returns false if one of the files could not
+		// be read.
+		bool GetDependencies(std::string_view file, std::vector<std::string>& outFiles);
+
+		// Contents of a file read by HashSourceTree or GetDependencies. Empty if the file was not read.
+		std::string_view GetSource(std::string_view file) const;
+
+		inline size_t GetFileCount() const { return Files.size(); }
+
+		// Joins an include path to the directory of the including file and removes . and .. segments. Paths use forward slashes.
+		static std::string ResolveIncludePath(std::string_view includingFile, std::string_view include);
+
+		// Appends the paths of the #include "..." and #include <...> directives outside of comments in source order.
+		static void ParseIncludes(std::string_view source, std::vector<std::string_view>& outIncludes);
+
+	private:
+		uint32_t FindOrReadFile(const std::string& path);
+		// Visits the file and its includes depth first, calling visit(fileIndex) the first time each file is reached. Returns false if a file could not
+		// be read.
+		template<typename Function>
+		bool VisitSourceTree(std::string_view file, const Function& visit);
+	};
+
+	struct ShaderCacheStats
+	{
+		uint64_t Hits = 0;
+		uint64_t Misses = 0;
+		uint64_t CompileFailures = 0;
+		uint64_t SourceErrors = 0;
+	};
+
+	// Compiled shader bytecode keyed by a hash of the shader's source tree, macros, entry point and target, stored in a single pack file of an index
+	// followed by the bytecode of every entry. Changing any file a shader includes, a macro, the entry point or the target changes the key, so stale
+	// bytecode is never used. Bytecode of the keys a batch misses is compiled in parallel on the job system.
+	// Does not depend on a renderer api. The pack is a local cache, discarded if its tag or index do not match or an entry fails its checksum.
+	class ShaderCache
+	{
+	public:
+		// Changes to the pack layout or to the key computation invalidate existing packs.
+		static constexpr LeviathanCore::Serialize::FileTag PackTag = { .Magic = 0x4b50534c, .Version = 1 }; // "LSPK".
+
+	private:
+		std::unordered_map<uint64_t, std::vector<uint8_t>> Entries = {};
+		// Keys looked up by GetOrCompile or inserted since the last load. Entries of shaders no longer used are not saved.
+		std::unordered_set<uint64_t> UsedKeys = {};
+		bool Dirty = false;
+		ShaderCacheStats Stats = {};
+
+		// Compile scratch memory.
+		struct PendingCompile
+		{
+			uint64_t Key = 0;
+			size_t Description = 0;
+			std::string_view Source = {};
+			std::vector<uint8_t> Bytecode = {};
+			bool Compiled = false;
+		};
+		std::vector<uint64_t> Keys = {};
+		std::vector<PendingCompile> PendingCompiles = {};
+
+	public:
+		// Key of a shader from the hash of its source tree.
+		static uint64_t ComputeKey(uint64_t sourceTreeHash, const ShaderCompileDescription& description);
+
+		// Replaces the entries with the pack file's. Returns false and leaves the cache empty if the file does not exist or is not a valid pack.
+		bool Load(std::string_view packFile);
+		// Writes the entries looked up by GetOrCompile or inserted since the last load to the pack file.
+		bool Save(std::string_view packFile);
+		void Clear();
+
+		// Returns the bytecode of the key or null.
+		const std::vector<uint8_t>* Find(uint64_t key) const;
+		void Insert(uint64_t key, std::vector<uint8_t> bytecode);
+
+		// Looks up the bytecode of every description, compiling misses in parallel and adding them to the cache. outBytecode receives a pointer per
+		// description that stays valid until the entry is replaced or the cache is cleared, or null if the source could not be read or compilation
+		// failed. Returns false if any description has no bytecode.
+		bool GetOrCompile(ShaderSourceGraph& sources, const ShaderCompileDescription* descriptions, size_t count, ShaderCompileFunctionType compileFunction,
+			void* userData, std::vector<const std::vector<uint8_t>*>& outBytecode);
+
+		inline size_t GetEntryCount() const { return Entries.size(); }
+		inline size_t GetUsedEntryCount() const { return UsedKeys.size(); }
+		// Whether saving would change the pack, i.e. entries were added or loaded entries were not used since the last load or save.
+		inline bool IsDirty() const { return Dirty || (UsedKeys.size() < Entries.size()); }
+		inline const ShaderCacheStats& GetStats() const { return Stats; }
+		inline void ResetStats() { Stats = {}; }
+	};
+}
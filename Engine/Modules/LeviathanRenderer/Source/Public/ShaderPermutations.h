@@ -0,0 +1,139 @@
+#pragma once
+
+#include "ShaderCache.h"
+
+namespace LeviathanRenderer
+{
+	// Values of every feature of a shader packed into bit fields in feature declaration order.
+	using ShaderPermutationKey = uint32_t;
+
+	// Preprocessor definition a shader's source branches on, e.g. #if NORMAL_MAPPING. A feature takes values in [0, 2^BitCount) and is defined to its
+	// value in every permutation.
+	struct ShaderFeature
+	{
+		static constexpr uint32_t MaxBitCount = 4;
+
+		const char* Name = nullptr;
+		uint32_t BitCount = 1;
+	};
+
+	inline constexpr uint32_t GetShaderFeatureBitOffset(const ShaderFeature* const features, const size_t feature)
+	{
+		uint32_t offset = 0;
+		for (size_t i = 0; i < feature; ++i)
+		{
+			offset += features[i].BitCount;
+		}
+		return offset;
+	}
+
+	// Returns the key with the feature set to value. Values outside of the feature's range are truncated. Evaluated at compile time when the features
+	// and value are constant.
+	inline constexpr ShaderPermutationKey SetShaderFeature(const ShaderFeature* const features, const size_t feature, const ShaderPermutationKey key,
+		const uint32_t value)
+	{
+		const uint32_t offset = GetShaderFeatureBitOffset(features, feature);
+		const uint32_t mask = ((1u << features[feature].BitCount) - 1) << offset;
+		return (key & ~mask) | ((value << offset) & mask);
+	}
+
+	inline constexpr uint32_t GetShaderFeature(const ShaderFeature* const features, const size_t feature, const ShaderPermutationKey key)
+	{
+		return (key >> GetShaderFeatureBitOffset(features, feature)) & ((1u << features[feature].BitCount) - 1);
+	}
+
+	struct ShaderPermutationStats
+	{
+		// Permutations requested before they were loaded, each stalling the caller on the cache or the compiler.
+		uint64_t FirstUseLoads = 0;
+		// Permutations loaded ahead of use by Prewarm.
+		uint64_t PrewarmedPermutations = 0;
+		// Permutations FindPermutation was asked for before they were loaded.
+		uint64_t MissedPermutations = 0;
+		uint64_t Failures = 0;
+	};
+
+	// Permutations of a shader over its features. Permutations are compiled or loaded through the shader cache on first use and kept resident, so a
+	// permutation is only looked up once. The resident keys form the usage list that prewarms the set in the next run, moving cache lookups and
+	// compilation out of the first frames a permutation is drawn in.
+	// Bytecode pointers point into the shader cache's entries. Call ClearPermutations when the cache is cleared.
+	class ShaderPermutationSet
+	{
+	public:
+		static constexpr size_t MaxFeatureBits = 32;
+
+	private:
+		std::string Name = {};
+		// Source file, entry point, target and macros shared by every permutation. Referenced strings and macros must outlive the set.
+		ShaderCompileDescription Base = {};
+		std::vector<ShaderFeature> Features = {};
+		uint32_t KeyBitCount = 0;
+		std::unordered_map<ShaderPermutationKey, const std::vector<uint8_t>*> Permutations = {};
+		// Keys FindPermutation was asked for that were not resident, recorded in the usage list so that the next run prewarms them.
+		std::unordered_set<ShaderPermutationKey> MissedKeys = {};
+		ShaderPermutationStats Stats = {};
+
+		// Load scratch memory.
+		std::vector<ShaderPermutationKey> PendingKeys = {};
+		std::vector<ShaderMacro> PendingMacros = {};
+		std::vector<ShaderCompileDescription> PendingDescriptions = {};
+		std::vector<const std::vector<uint8_t>*> PendingBytecode = {};
+
+	public:
+		ShaderPermutationSet() = default;
+		ShaderPermutationSet(std::string_view name, const ShaderCompileDescription& base, const ShaderFeature* features, size_t featureCount);
+
+		// Whether the key only sets bits of the set's features.
+		bool IsValidKey(ShaderPermutationKey key) const;
+
+		// Appends the base macros followed by every feature defined to its value in the permutation.
+		void GetMacros(ShaderPermutationKey key, std::vector<ShaderMacro>& outMacros) const;
+
+		// Bytecode of the permutation, loaded through the cache on first use. Returns null if the key is invalid or the permutation could not be
+		// compiled. Failed permutations are not retried until ClearPermutations.
+		const std::vector<uint8_t>* GetPermutation(ShaderPermutationKey key, ShaderCache& cache, ShaderSourceGraph& sources, ShaderCompileFunctionType compileFunction,
+			void* userData);
+
+		// Bytecode of the permutation if it is resident, otherwise null. Never loads or compiles so it can be called while drawing, e.g. falling back to
+		// a default permutation. Valid keys that are not resident are recorded for the usage list.
+		const std::vector<uint8_t>* FindPermutation(ShaderPermutationKey key);
+
+		// Loads every permutation that is not resident in one batch, compiling cache misses in parallel. Invalid keys, e.g. from a usage list recorded
+		// before the features changed, are skipped. Returns false if a permutation could not be compiled.
+		bool Prewarm(const ShaderPermutationKey* keys, size_t count, ShaderCache& cache, ShaderSourceGraph& sources, ShaderCompileFunctionType compileFunction,
+			void* userData);
+
+		// Appends the keys of the loaded permutations in ascending order.
+		void GetResidentKeys(std::vector<ShaderPermutationKey>& outKeys) const;
+		// Appends the keys of the loaded permutations and the keys FindPermutation missed in ascending order.
+		void GetUsedKeys(std::vector<ShaderPermutationKey>& outKeys) const;
+
+		void ClearPermutations();
+
+		inline const std::string& GetName() const { return Name; }
+		inline size_t GetFeatureCount() const { return Features.size(); }
+		inline size_t GetResidentCount() const { return Permutations.size(); }
+		inline uint64_t GetPermutationCount() const { return static_cast<uint64_t>(1) << KeyBitCount; }
+		inline const ShaderPermutationStats& GetStats() const { return Stats; }
+		inline void ResetStats() { Stats = {}; }
+
+	private:
+		// Loads the valid keys that are not resident into PendingKeys' permutations.
+		bool LoadPermutations(const ShaderPermutationKey* keys, size_t count, ShaderCache& cache, ShaderSourceGraph& sources,
+			ShaderCompileFunctionType compileFunction, void* userData);
+	};
+
+	struct ShaderUsageRecord
+	{
+		std::string Set = {};
+		ShaderPermutationKey Key = 0;
+	};
+
+	// Writes the used permutations of every set to a text file with a line of set name and key per permutation.
+	bool SaveShaderUsageList(std::string_view file, const ShaderPermutationSet* const* sets, size_t setCount);
+	// Appends the records of a usage list. Malformed lines are skipped. Returns false if the file does not exist or could not be read.
+	bool LoadShaderUsageList(std::string_view file, std::vector<ShaderUsageRecord>& outRecords);
+	// Prewarms the set with the keys recorded for it.
+	bool PrewarmFromUsageList(ShaderPermutationSet& set, const std::vector<ShaderUsageRecord>& records, ShaderCache& cache, ShaderSourceGraph& sources,
+		ShaderCompileFunctionType compileFunction, void* userData);
+}
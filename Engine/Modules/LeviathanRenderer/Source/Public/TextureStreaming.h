@@ -0,0 +1,254 @@
+#pragma once
+
+#include "BoundingVolumes.h"
+
+namespace LeviathanRenderer
+{
+	class Camera;
+
+	using StreamedTextureId = uint32_t;
+	static constexpr StreamedTextureId InvalidStreamedTextureId = std::numeric_limits<StreamedTextureId>::max();
+
+	// Returns the mip level a surface within the world bounds samples when seen from the view, the log2 of texels per pixel at its projected size.
+	// texelsPerWorldUnit is the mip 0 texel density of the surface, e.g. a texture's width times the mesh's texture coordinate density divided by
+	// the object's scale. Negative for magnified textures. Measured at the nearest point of the bounds, so the demand does not include anisotropy.
+	float GetTextureMipDemand(const Camera& view, const LeviathanCore::BoundingVolumes::Sphere& worldBounds, float texelsPerWorldUnit, float viewportHeight);
+
+	enum class StreamInResult : uint8_t
+	{
+		Failed,
+		Loaded,
+		// The mips are loading after Update returns. Reported with CompleteStreamIn or RevertStreamIn.
+		Loading
+	};
+
+	struct TextureStreamingSettings
+	{
+		// Bytes of the pool holding the resident mips of every streamed texture.
+		size_t PoolBytes = 0;
+		// Bytes of mips streamed in per Update. The first stream in of an Update loads at least one mip, so that mips larger than the limit are
+		// streamed. 0 does not limit streaming.
+		size_t MaxStreamInBytesPerUpdate = 0;
+		// Mips whose width and height are at most this size form the tail of a texture that is resident while the texture is registered.
+		uint32_t TailSize = 64;
+		// Updates a texture keeps the target of its finest recent demand after its demand becomes coarser, so that textures near a mip boundary
+		// or briefly out of view are not streamed out and back in.
+		uint32_t HysteresisUpdates = 30;
+		// Added to every demand. Positive biases stream coarser mips.
+		float MipBias = 0.0f;
+	};
+
+	struct TextureStreamingStats
+	{
+		uint64_t StreamedInMips = 0;
+		uint64_t StreamedInBytes = 0;
+		// Mips released to make room for mips of other textures.
+		uint64_t EvictedMips = 0;
+		uint64_t EvictedBytes = 0;
+		uint64_t FailedStreamIns = 0;
+		// Bytes of the resident and loading mips at the end of the last Update.
+		size_t ResidentBytes = 0;
+		// Bytes of every texture's target mips in the last Update before the budget bias.
+		size_t TargetBytes = 0;
+		// Mips added to every target in the last Update so that the targets fit the pool.
+		uint32_t BudgetMipBias = 0;
+		// Textures whose resident mips were coarser than their budgeted target at the end of the last Update.
+		uint32_t WaitingTextures = 0;
+	};
+
+	// Mip residency of streamed textures in a fixed memory pool. Textures register their mip chain and the tail of mips up to TailSize is resident
+	// from registration. Each frame, the finest demand of every texture's visible surfaces is added and Update moves every texture's resident mips
+	// towards the demanded mip:
+	// - A texture's target is its finest demand held for HysteresisUpdates updates.
+	// - If the targets of every texture do not fit the pool, every target is biased coarser by the same number of mips until they fit.
+	// - Textures missing mips of their budgeted target stream them in, most recently demanded textures first and coarse mips first, within the
+	//   update's stream in limit.
+	// - Mips finer than a texture's budgeted target stay resident as a cache and are evicted when room is needed, least recently demanded
+	//   textures first.
+	// Mips are loaded and released by a Backend with the functions
+	//     StreamInResult StreamIn(StreamedTextureId texture, uint32_t firstMip, uint32_t residentMip); // Load mips [firstMip, residentMip).
+	//     void StreamOut(StreamedTextureId texture, uint32_t firstMip); // Release mips finer than firstMip.
+	// A stream in the backend is still loading when Update returns keeps the texture's resident mip and reserves the pool memory of its mips until
+	// it is reported with CompleteStreamIn or RevertStreamIn. Textures with a loading stream in are not streamed in or evicted further.
+	// Does not depend on a renderer api.
+	class TextureStreamer
+	{
+	public:
+		static constexpr uint32_t MaxMipCount = 16;
+
+		// A stream in or eviction planned by Update.
+		struct Operation
+		{
+			StreamedTextureId Texture = InvalidStreamedTextureId;
+			// Finest resident mip after the operation.
+			uint32_t FirstMip = 0;
+			// Finest resident mip before the operation.
+			uint32_t PreviousMip = 0;
+			bool StreamIn = false;
+		};
+
+	private:
+		static constexpr uint64_t NeverDemanded = 0;
+
+		struct StreamedTexture
+		{
+			bool Registered = false;
+			uint32_t MipCount = 0;
+			// First mip of the tail.
+			uint32_t TailMip = 0;
+			// Finest resident mip.
+			uint32_t ResidentMip = 0;
+			// Finest mip of the loading stream in, ResidentMip while no stream in is loading.
+			uint32_t LoadingMip = 0;
+			// Finest mip demanded in the current update.
+			float Demand = std::numeric_limits<float>::max();
+			// Target mip and the update it was last demanded.
+			uint32_t TargetMip = 0;
+			uint64_t TargetUpdate = NeverDemanded;
+			uint64_t LastDemandUpdate = NeverDemanded;
+			// Bytes of the mips from each mip to the end of the chain.
+			std::array<size_t, MaxMipCount + 1> ChainBytes = {};
+		};
+
+		TextureStreamingSettings Settings = {};
+		std::vector<StreamedTexture> Textures = {};
+		std::vector<StreamedTextureId> FreeIds = {};
+		size_t ResidentBytes = 0;
+		// Updates start at 1 so that 0 means never demanded.
+		uint64_t UpdateIndex = 1;
+		TextureStreamingStats Stats = {};
+
+		// Update scratch memory.
+		std::vector<uint32_t> BudgetedMips = {};
+		std::vector<StreamedTextureId> StreamInOrder = {};
+		std::vector<StreamedTextureId> EvictionOrder = {};
+		std::vector<Operation> Operations = {};
+		std::vector<StreamInResult> OperationResults = {};
+
+	public:
+		explicit TextureStreamer(const TextureStreamingSettings& settings = {});
+
+		// New settings apply from the next Update. Tails of registered textures keep their size.
+		void SetSettings(const TextureStreamingSettings& settings);
+		inline const TextureStreamingSettings& GetSettings() const { return Settings; }
+
+		// Registers a texture with mipCount mips down from a width x height mip 0 with the tail resident. The caller creates the tail. Returns
+		// InvalidStreamedTextureId if the texture has no mips or more than MaxMipCount.
+		StreamedTextureId Register(uint32_t width, uint32_t height, uint32_t mipCount, uint32_t bytesPerPixel);
+		// Releases the texture's mips from the pool. The caller releases the texture.
+		void Unregister(StreamedTextureId& texture);
+
+		inline bool IsValid(const StreamedTextureId texture) const { return (texture < Textures.size()) && Textures[texture].Registered; }
+
+		// Adds a demand for the texture in the current update, e.g. a GetTextureMipDemand of a visible surface. The finest demand of the update is
+		// kept.
+		inline void AddDemand(const StreamedTextureId texture, const float mip)
+		{
+			Textures[texture].Demand = std::min(Textures[texture].Demand, mip);
+		}
+
+		// Plans and issues the update's stream ins and evictions and starts the next update's demand.
+		template <typename Backend>
+		void Update(Backend& backend)
+		{
+			PlanUpdate();
+			OperationResults.assign(Operations.size(), StreamInResult::Loaded);
+			for (size_t i = 0; i < Operations.size(); ++i)
+			{
+				const Operation& operation = Operations[i];
+				if (operation.StreamIn)
+				{
+					OperationResults[i] = backend.StreamIn(operation.Texture, operation.FirstMip, operation.PreviousMip);
+				}
+				else
+				{
+					backend.StreamOut(operation.Texture, operation.FirstMip);
+				}
+			}
+			CompleteUpdate();
+		}
+
+		// Makes the mips of the texture's loading stream in from firstMip resident.
+		void CompleteStreamIn(StreamedTextureId texture, uint32_t firstMip);
+		// Releases the mips [firstMip, previousMip) of a loading stream in or of a stream in that failed after its Update, unless a later Update
+		// changed the texture's resident mips.
+		void RevertStreamIn(StreamedTextureId texture, uint32_t firstMip, uint32_t previousMip);
+
+		inline uint32_t GetResidentMip(const StreamedTextureId texture) const { return Textures[texture].ResidentMip; }
+		inline bool IsLoading(const StreamedTextureId texture) const { return Textures[texture].LoadingMip != Textures[texture].ResidentMip; }
+		inline uint32_t GetTargetMip(const StreamedTextureId texture) const { return Textures[texture].TargetMip; }
+		inline uint32_t GetTailMip(const StreamedTextureId texture) const { return Textures[texture].TailMip; }
+		inline size_t GetResidentBytes() const { return ResidentBytes; }
+		// Operations issued by the last Update in issue order.
+		inline const std::vector<Operation>& GetOperations() const { return Operations; }
+		inline const TextureStreamingStats& GetStats() const { return Stats; }
+		inline void ResetStats() { Stats = {}; }
+
+	private:
+		// Updates the targets, solves the budget bias and plans the operations assuming every stream in succeeds.
+		void PlanUpdate();
+
+		// Reverts failed stream ins, updates the stats and resets the demands.
+		void CompleteUpdate();
+	};
+
+	// Mips [FirstMip, PreviousMip) of a stream in read by a TextureMipReader. Read is false if the read callback failed.
+	struct TextureMipRead
+	{
+		StreamedTextureId Texture = InvalidStreamedTextureId;
+		uint32_t FirstMip = 0;
+		uint32_t PreviousMip = 0;
+		bool Read = false;
+		std::vector<uint8_t> MipData = {};
+	};
+
+	// Reads the mips of stream ins in background jobs of the job system, so that slow reads hold up neither the frame nor the streaming update, and
+	// returns the finished reads to the thread that started them, e.g. at the start of the next frame. Reads are started and collected on one thread.
+	// Mip buffers are reused by later reads.
+	class TextureMipReader
+	{
+	public:
+		// Reads mips [firstMip, firstMip + mipCount) back to back from the finest into the out buffer. Called on the job system's background thread.
+		using ReadCallbackType = bool(*)(uint32_t /* firstMip */, uint32_t /* mipCount */, std::vector<uint8_t>& /* outMipData */, void* /* userData */);
+		using CollectCallbackType = void(*)(const TextureMipRead& /* read */, void* /* userData */);
+
+	private:
+		struct Job;
+
+		// Started reads in start order and finished jobs kept for reuse.
+		std::vector<Job*> Jobs = {};
+		std::vector<Job*> FreeJobs = {};
+
+	public:
+		TextureMipReader() = default;
+		TextureMipReader(const TextureMipReader&) = delete;
+		TextureMipReader& operator=(const TextureMipReader&) = delete;
+		// Waits for the reads that are still running.
+		~TextureMipReader();
+
+		// Starts reading the mips [firstMip, previousMip) of the texture with the callback. The user data must stay valid until the read is collected
+		// or cancelled.
+		void Read(StreamedTextureId texture, uint32_t firstMip, uint32_t previousMip, ReadCallbackType readMips, void* userData);
+
+		// Calls the callback with each finished read in start order and releases it. Reads that are still running are kept.
+		void CollectFinished(CollectCallbackType callback, void* userData);
+
+		// Convenience overload for callables with the signature void(const TextureMipRead& read).
+		template <typename Function>
+		void CollectFinished(const Function& function)
+		{
+			CollectFinished([](const TextureMipRead& read, void* userData)
+				{
+					(*static_cast<const Function*>(userData))(read);
+				}, const_cast<void*>(static_cast<const void*>(&function)));
+		}
+
+		// Waits for the texture's reads and releases them without collecting them, e.g. before the texture's user data is released.
+		void Cancel(StreamedTextureId texture);
+		// Waits for every read and releases them without collecting them.
+		void Clear();
+
+		// Reads started and not collected or cancelled.
+		inline size_t GetReadCount() const { return Jobs.size(); }
+	};
+}
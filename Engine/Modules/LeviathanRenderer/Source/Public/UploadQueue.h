@@ -0,0 +1,252 @@
+#pragma once
+
+#include "RendererResourceId.h"
+
+namespace LeviathanRenderer
+{
+	enum class UploadResourceType : uint8_t
+	{
+		VertexBuffer,
+		IndexBuffer,
+		Texture2D,
+		TextureCube,
+		// Replaces the mips of an existing texture.
+		Texture2DMips
+	};
+
+	enum class UploadStatus : uint8_t
+	{
+		Created,
+		Failed,
+		// The upload was cancelled or the queue was cleared before the resource was created.
+		Cancelled
+	};
+
+	using UploadTicket = uint64_t;
+
+	struct UploadResult
+	{
+		UploadTicket Ticket = 0;
+		UploadResourceType Type = UploadResourceType::VertexBuffer;
+		UploadStatus Status = UploadStatus::Failed;
+		// Only valid if the status is Created. The receiver owns the resource. Mip updates report the updated texture.
+		RendererResourceId::IdType ResourceId = RendererResourceId::InvalidId;
+	};
+
+	using UploadCompletedCallbackType = void(*)(const UploadResult& /* result */, void* /* userData */);
+
+	// Scheduling of an upload and the callback receiving its resource.
+	struct UploadDescription
+	{
+		// Uploads of higher priority are created first. Uploads of the same priority are created in request order.
+		uint8_t Priority = 0;
+		UploadCompletedCallbackType Callback = nullptr;
+		void* UserData = nullptr;
+	};
+
+	struct UploadQueueStats
+	{
+		// Requests taken from the queue by Process, Cancel or Clear.
+		uint64_t Requests = 0;
+		uint64_t Created = 0;
+		uint64_t Failed = 0;
+		uint64_t Cancelled = 0;
+		uint64_t CreatedBytes = 0;
+		// Uploads larger than a nonzero budget, each created alone in its frame.
+		uint64_t OversizedUploads = 0;
+		uint32_t LastFrameUploads = 0;
+		size_t LastFrameBytes = 0;
+		// Bytes staged by uploads waiting to be created at the end of the last Process.
+		size_t PendingBytes = 0;
+	};
+
+	// Resource creation requests whose data is copied to staging memory when they are requested and that are created over the following frames.
+	// Requests are accepted from any thread. Process creates the waiting uploads in priority order until the frame's byte budget is used and reports
+	// each result to the upload's callback on the calling thread, so creating many resources, e.g. while loading a level, does not stall a frame.
+	// An upload larger than the budget is created alone in a frame. A large upload that does not fit the rest of a frame's budget waits for the next
+	// frame instead of being passed by smaller uploads of the same or lower priority, so it cannot be starved.
+	// Resources are created by a Backend with the functions
+	//     bool CreateVertexBuffer(const void* vertexData, uint32_t vertexCount, size_t strideBytes, RendererResourceId::IdType& outId);
+	//     bool CreateIndexBuffer(const uint32_t* indexData, uint32_t indexCount, RendererResourceId::IdType& outId);
+	//     bool CreateTexture2D(uint32_t width, uint32_t height, const void* data, uint32_t rowSizeBytes, bool sRGB, bool HDR, bool generateMipmaps,
+	//         RendererResourceId::IdType& outId);
+	//     bool CreateTextureCube(uint32_t faceWidth, const void* const* faceData, bool sRGB, bool HDR, bool halfFloat,
+	//         RendererResourceId::IdType& outId);
+	//     bool SetTexture2DMips(RendererResourceId::IdType id, uint32_t width, uint32_t height, uint32_t mipCount, const void* const* loadedMipData,
+	//         uint32_t loadedMipCount);
+	// Does not depend on a renderer api.
+	class UploadQueue
+	{
+	public:
+		static constexpr UploadTicket InvalidTicket = 0;
+		// Texture cube faces are 8 bit rgba, or 32 bit float rgba for HDR cubes and 16 bit float rgba for half float HDR cubes.
+		static constexpr uint32_t TextureCubeBytesPerPixel = 4;
+		static constexpr uint32_t HDRTextureCubeBytesPerPixel = 16;
+		static constexpr uint32_t HalfFloatTextureCubeBytesPerPixel = 8;
+		static constexpr size_t TextureCubeFaceCount = 6;
+		// Texture mips are 8 bit rgba.
+		static constexpr uint32_t Texture2DMipsBytesPerPixel = 4;
+		static constexpr uint32_t MaxTexture2DMipCount = 16;
+
+	private:
+		struct Upload
+		{
+			UploadTicket Ticket = InvalidTicket;
+			UploadResourceType Type = UploadResourceType::VertexBuffer;
+			uint8_t Priority = 0;
+			bool sRGB = false;
+			bool HDR = false;
+			bool HalfFloat = false;
+			bool GenerateMipmaps = false;
+			// Vertex or index count or texture or cube face width.
+			uint32_t Count = 0;
+			uint32_t Height = 0;
+			// Vertex stride or texture row size.
+			size_t StrideBytes = 0;
+			// Texture whose mips are replaced, its mip count and the number of finest mips in the data.
+			RendererResourceId::IdType Resource = RendererResourceId::InvalidId;
+			uint32_t MipCount = 0;
+			uint32_t LoadedMipCount = 0;
+			std::vector<uint8_t> Data = {};
+			UploadCompletedCallbackType Callback = nullptr;
+			void* UserData = nullptr;
+		};
+
+		size_t BudgetBytesPerFrame = 0;
+
+		// Requests waiting to be moved to the pending uploads by the next Process.
+		std::mutex RequestMutex = {};
+		std::vector<Upload> Requests = {};
+		UploadTicket NextTicket = InvalidTicket + 1;
+
+		// Uploads waiting to be created in creation order.
+		std::vector<Upload> Pending = {};
+		size_t PendingBytes = 0;
+
+		// Uploads created by the current Process and their results.
+		std::vector<Upload> FrameUploads = {};
+		std::vector<UploadResult> FrameResults = {};
+
+		UploadQueueStats Stats = {};
+
+	public:
+		explicit UploadQueue(size_t budgetBytesPerFrame = 0);
+
+		// Bytes of staged data created per Process. 0 creates a single upload per Process.
+		void SetBudget(size_t budgetBytesPerFrame);
+		inline size_t GetBudget() const { return BudgetBytesPerFrame; }
+
+		// Copy the resource data and return the upload's ticket, or InvalidTicket if there is no data. Callable from any thread.
+		UploadTicket EnqueueVertexBuffer(const void* vertexData, uint32_t vertexCount, size_t strideBytes, const UploadDescription& description);
+		UploadTicket EnqueueIndexBuffer(const uint32_t* indexData, uint32_t indexCount, const UploadDescription& description);
+		UploadTicket EnqueueTexture2D(uint32_t width, uint32_t height, const void* data, uint32_t rowSizeBytes, bool sRGB, bool HDR, bool generateMipmaps,
+			const UploadDescription& description);
+		UploadTicket EnqueueTextureCube(uint32_t faceWidth, const void* const* faceData, bool sRGB, bool HDR, bool halfFloat,
+			const UploadDescription& description);
+		// Replaces the texture's mips with mipCount mips down from a width x height mip 0. The loadedMipCount finest mips are read back to back from
+		// loadedMipData and the rest are kept from the texture's coarsest mips, so no loaded mips release the finest mips. Mip updates of a texture
+		// are applied in request order when they have the same priority.
+		UploadTicket EnqueueTexture2DMips(RendererResourceId::IdType id, uint32_t width, uint32_t height, uint32_t mipCount, const void* loadedMipData,
+			uint32_t loadedMipCount, const UploadDescription& description);
+
+		// Removes an upload that was not created yet and reports it as cancelled. Call from the thread calling Process. Returns false if the upload
+		// was already created or cancelled.
+		bool Cancel(UploadTicket ticket);
+
+		// Creates the waiting uploads within the frame's budget and calls their callbacks. Callbacks may enqueue and cancel uploads but must not call
+		// Process or Flush.
+		template <typename Backend>
+		void Process(Backend& backend)
+		{
+			ScheduleFrame(BudgetBytesPerFrame);
+			CreateFrameUploads(backend);
+		}
+
+		// Creates every waiting upload regardless of the budget, e.g. behind a loading screen.
+		template <typename Backend>
+		void Flush(Backend& backend)
+		{
+			ScheduleFrame(std::numeric_limits<size_t>::max());
+			CreateFrameUploads(backend);
+		}
+
+		// Cancels every upload.
+		void Clear();
+
+		inline const UploadQueueStats& GetStats() const { return Stats; }
+		inline void ResetStats() { Stats = {}; }
+
+	private:
+		static inline size_t GetMipSizeBytes(const uint32_t width, const uint32_t height, const uint32_t mip)
+		{
+			return static_cast<size_t>(std::max(width >> mip, 1u)) * std::max(height >> mip, 1u) * Texture2DMipsBytesPerPixel;
+		}
+
+		UploadTicket Enqueue(Upload&& upload, const UploadDescription& description);
+
+		// Moves requests to the pending uploads and the uploads fitting the budget from the front of the pending uploads to the frame's uploads.
+		void ScheduleFrame(size_t budgetBytes);
+
+		// Reports the frame's results and releases the frame's staging memory.
+		void CompleteFrame();
+
+		template <typename Backend>
+		void CreateFrameUploads(Backend& backend)
+		{
+			FrameResults.resize(FrameUploads.size());
+			for (size_t i = 0; i < FrameUploads.size(); ++i)
+			{
+				const Upload& upload = FrameUploads[i];
+				UploadResult& result = FrameResults[i];
+				result = UploadResult{ .Ticket = upload.Ticket, .Type = upload.Type, .Status = UploadStatus::Failed, .ResourceId = RendererResourceId::InvalidId };
+
+				bool created = false;
+				switch (upload.Type)
+				{
+				case UploadResourceType::VertexBuffer:
+					created = backend.CreateVertexBuffer(upload.Data.data(), upload.Count, upload.StrideBytes, result.ResourceId);
+					break;
+
+				case UploadResourceType::IndexBuffer:
+					created = backend.CreateIndexBuffer(reinterpret_cast<const uint32_t*>(upload.Data.data()), upload.Count, result.ResourceId);
+					break;
+
+				case UploadResourceType::Texture2D:
+					created = backend.CreateTexture2D(upload.Count, upload.Height, upload.Data.data(), static_cast<uint32_t>(upload.StrideBytes), upload.sRGB,
+						upload.HDR, upload.GenerateMipmaps, result.ResourceId);
+					break;
+
+				case UploadResourceType::TextureCube:
+				{
+					std::array<const void*, TextureCubeFaceCount> faceData = {};
+					for (size_t face = 0; face < TextureCubeFaceCount; ++face)
+					{
+						faceData[face] = upload.Data.data() + (face * (upload.Data.size() / TextureCubeFaceCount));
+					}
+					created = backend.CreateTextureCube(upload.Count, faceData.data(), upload.sRGB, upload.HDR, upload.HalfFloat, result.ResourceId);
+					break;
+				}
+
+				case UploadResourceType::Texture2DMips:
+				{
+					std::array<const void*, MaxTexture2DMipCount> mipData = { nullptr };
+					size_t offset = 0;
+					for (uint32_t mip = 0; mip < upload.LoadedMipCount; ++mip)
+					{
+						mipData[mip] = upload.Data.data() + offset;
+						offset += GetMipSizeBytes(upload.Count, upload.Height, mip);
+					}
+					created = backend.SetTexture2DMips(upload.Resource, upload.Count, upload.Height, upload.MipCount, mipData.data(), upload.LoadedMipCount);
+					result.ResourceId = created ? upload.Resource : RendererResourceId::InvalidId;
+					break;
+				}
+
+				default:
+					break;
+				}
+				result.Status = created ? UploadStatus::Created : UploadStatus::Failed;
+			}
+			CompleteFrame();
+		}
+	};
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+namespace LeviathanRenderer
+{
+	// Linear ring allocator handing out aligned byte ranges of an upload buffer, e.g. the constant data of a frame. Allocations are grouped into frames
+	// that retire together once the gpu signalled the frame's fence value, so a range is only handed out again after every frame reading it completed.
+	// Only tracks offsets and is independent of the renderer api owning the memory.
+	// Allocation sizes are rounded up to the alignment. An allocation never straddles the end of the buffer, the unused tail is skipped and the
+	// allocation wraps to offset 0 instead.
+	class UploadRing
+	{
+	public:
+		static constexpr size_t InvalidOffset = std::numeric_limits<size_t>::max();
+
+	private:
+		struct Frame
+		{
+			uint64_t Fence = 0;
+			// Ring position one past the frame's last allocation.
+			uint64_t End = 0;
+		};
+
+		size_t CapacityBytes = 0;
+		size_t AlignmentBytes = 1;
+		size_t MaxFramesInFlight = 0;
+
+		// Positions increase monotonically and map to the buffer offset position % CapacityBytes. Bytes in [Tail, Head) are in use.
+		uint64_t Head = 0;
+		uint64_t Tail = 0;
+		bool FrameOpen = false;
+
+		// Closed frames waiting for their fence in submission order.
+		std::vector<Frame> FramesInFlight = {};
+
+		uint64_t FailedAllocationCount = 0;
+
+	public:
+		// Capacity must be a non zero multiple of the alignment. Alignment must be a power of 2, e.g. 256 for constant buffer ranges. At most
+		// maxFramesInFlight closed frames can wait for their fence.
+		bool Initialize(size_t capacityBytes, size_t alignmentBytes, size_t maxFramesInFlight);
+
+		// Forgets every allocation and frame, e.g. after the gpu is idle or the upload buffer is recreated.
+		void Reset();
+
+		// Opens a frame. Fails if a frame is already open or MaxFramesInFlight frames are waiting for their fence, in which case the caller waits for
+		// the oldest frame's fence and calls Retire.
+		bool BeginFrame();
+
+		// Returns the offset of an aligned range of sizeBytes bytes in the open frame or InvalidOffset if the range does not fit without overwriting
+		// a frame in flight.
+		size_t Allocate(size_t sizeBytes);
+
+		// Closes the open frame. Its ranges are reused once Retire is called with a completed fence value of at least fenceValue. Fence values must
+		// increase from frame to frame.
+		void EndFrame(uint64_t fenceValue);
+
+		// Releases the ranges of every frame in flight with a fence value of at most completedFenceValue.
+		void Retire(uint64_t completedFenceValue);
+
+		inline size_t GetCapacityBytes() const { return CapacityBytes; }
+		inline size_t GetAlignmentBytes() const { return AlignmentBytes; }
+		inline size_t GetUsedBytes() const { return static_cast<size_t>(Head - Tail); }
+		inline size_t GetFrameInFlightCount() const { return FramesInFlight.size(); }
+		inline bool IsFrameOpen() const { return FrameOpen; }
+		// Fence value of the oldest frame in flight. Only valid if a frame is in flight.
+		inline uint64_t GetOldestFrameFence() const { return FramesInFlight.front().Fence; }
+		// Number of times allocation passed the end of the buffer and continued at offset 0.
+		inline uint64_t GetWrapCount() const { return (CapacityBytes > 0) ? (Head / CapacityBytes) : 0; }
+		inline uint64_t GetFailedAllocationCount() const { return FailedAllocationCount; }
+	};
+}
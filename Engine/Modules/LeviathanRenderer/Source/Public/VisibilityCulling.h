@@ -0,0 +1,36 @@
+#pragma once
+
+#include "BoundingVolumes.h"
+
+namespace LeviathanRenderer
+{
+	// Culls renderable world bounds against a view frustum and produces a compact list of visible renderable indices in ascending order. Large renderable
+	// counts are split into chunks that are culled in parallel on the job system. Scratch memory is retained between calls so that steady state culling
+	// does not allocate. Does not depend on a renderer api and can be used headless.
+	class FrustumCullingStage
+	{
+	public:
+		// Number of renderables culled per job. Counts at or below this are culled on the calling thread.
+		static constexpr size_t ChunkSize = 8192;
+
+	private:
+		std::vector<uint32_t> VisibleIndices = {};
+		size_t VisibleCount = 0;
+
+		// Visible indices of each chunk written at the chunk's first renderable index before compaction into VisibleIndices.
+		std::vector<uint32_t> ChunkVisibleIndices = {};
+		// Visible count of each chunk, converted in place to each chunk's offset into VisibleIndices.
+		std::vector<size_t> ChunkVisibleOffsets = {};
+
+	public:
+		void Cull(const LeviathanCore::BoundingVolumes::Frustum& frustum, const LeviathanCore::BoundingVolumes::AABBSoA& worldBounds);
+		void Cull(const LeviathanCore::BoundingVolumes::Frustum& frustum, const LeviathanCore::BoundingVolumes::SphereSoA& worldBounds);
+
+		inline const uint32_t* GetVisibleIndices() const { return VisibleIndices.data(); }
+		inline size_t GetVisibleCount() const { return VisibleCount; }
+
+	private:
+		template <typename TestFunction>
+		void CullWithTest(const size_t count, const TestFunction& test);
+	};
+}
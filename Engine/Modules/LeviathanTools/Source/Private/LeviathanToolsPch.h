@@ -2,6 +2,7 @@
 
 // Standard library.
 #include <string>
+#include <limits>
 
 // Note: ImGui platform/renderer backend headers are included in Leviathan core and renderer modules.
 
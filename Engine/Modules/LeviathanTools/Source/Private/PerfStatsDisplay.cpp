@@ -3,8 +3,45 @@
 
 void LeviathanTools::PerfStatsDisplay::Render([[maybe_unused]] const unsigned int FPS, [[maybe_unused]] const float Ms)
 {
-	ImGui::SetNextWindowSize(ImVec2(200.0f, 100.0f), ImGuiCond_FirstUseEver);
+	Render(FPS, Ms, nullptr, 0);
+}
+
+void LeviathanTools::PerfStatsDisplay::Render(const unsigned int FPS, const float Ms, const GpuMemoryUsage* gpuMemory, const size_t gpuMemoryCount)
+{
+	static constexpr float BytesPerMiB = 1024.0f * 1024.0f;
+
+	ImGui::SetNextWindowSize((gpuMemoryCount > 0) ? ImVec2(320.0f, 240.0f) : ImVec2(200.0f, 100.0f), ImGuiCond_FirstUseEver);
 	ImGui::Begin("Perf stats");
 	ImGui::Text(LeviathanCore::String::Printf("FPS: %d\nMs: %f", FPS, Ms).c_str());
+
+	if ((gpuMemory != nullptr) && (gpuMemoryCount > 0) && ImGui::BeginTable("Gpu memory", 3))
+	{
+		ImGui::TableSetupColumn("Gpu memory");
+		ImGui::TableSetupColumn("Used MiB");
+		ImGui::TableSetupColumn("Budget MiB");
+		ImGui::TableHeadersRow();
+		for (size_t i = 0; i < gpuMemoryCount; ++i)
+		{
+			const GpuMemoryUsage& usage = gpuMemory[i];
+			const bool unlimited = (usage.BudgetBytes == std::numeric_limits<size_t>::max());
+			const ImVec4 color = (!unlimited && (usage.UsedBytes > usage.BudgetBytes)) ? ImVec4(1.0f, 0.3f, 0.3f, 1.0f) : ImGui::GetStyleColorVec4(ImGuiCol_Text);
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::TextColored(color, "%s", (usage.Category != nullptr) ? usage.Category : "");
+			ImGui::TableNextColumn();
+			ImGui::TextColored(color, "%.1f", static_cast<float>(usage.UsedBytes) / BytesPerMiB);
+			ImGui::TableNextColumn();
+			if (unlimited)
+			{
+				ImGui::TextColored(color, "-");
+			}
+			else
+			{
+				ImGui::TextColored(color, "%.1f", static_cast<float>(usage.BudgetBytes) / BytesPerMiB);
+			}
+		}
+		ImGui::EndTable();
+	}
+
 	ImGui::End();
-}
+}
\ No newline at end of file
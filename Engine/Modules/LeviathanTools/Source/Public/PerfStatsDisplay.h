@@ -2,9 +2,20 @@
 
 namespace LeviathanTools
 {
+	// Gpu memory used by a category of resources and its budget, e.g. from the renderer's gpu memory stats. A budget of
+	// std::numeric_limits<size_t>::max() is unlimited.
+	struct GpuMemoryUsage
+	{
+		const char* Category = nullptr;
+		size_t UsedBytes = 0;
+		size_t BudgetBytes = 0;
+	};
+
 	class PerfStatsDisplay
 	{
 	public:
 		void Render(const unsigned int FPS, const float Ms);
+		// Also lists the gpu memory used by each category against its budget, with exceeded budgets highlighted.
+		void Render(const unsigned int FPS, const float Ms, const GpuMemoryUsage* gpuMemory, const size_t gpuMemoryCount);
 	};
 }
\ No newline at end of file
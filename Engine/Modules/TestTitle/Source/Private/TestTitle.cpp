@@ -7,14 +7,19 @@
 #include "AssetTypes.h"
 #include "ModelImporter.h"
 #include "TextureImporter.h"
+#include "StreamableTexture.h"
+#include "EnvironmentCubemap.h"
+#include "ImageBasedLighting.h"
 #include "MathTypes.h"
 #include "MathLibrary.h"
 #include "Camera.h"
-#include "RendererResourceID.h"
+#include "RendererResourceId.h"
 #include "DataStructures.h"
 #include "VertexTypes.h"
 #include "LinearColor.h"
 #include "LightTypes.h"
+#include "TransformHierarchy.h"
+#include "Serialize.h"
 
 #ifdef LEVIATHAN_WITH_TOOLS
 #include "DemoTool.h"
@@ -28,25 +33,6 @@ namespace TestTitle
 		int Number = 0;
 	};
 
-	struct Transform
-	{
-		LeviathanCore::MathTypes::Vector3 Translation = { 0.0f, 0.0f, 0.0f };
-		LeviathanCore::MathTypes::Euler Rotation = { 0.0f, 0.0f, 0.0f };
-		LeviathanCore::MathTypes::Vector3 Scale = LeviathanCore::MathTypes::Vector3(1.0f, 1.0f, 1.0f);
-
-		Transform() = default;
-		Transform(const LeviathanCore::MathTypes::Vector3& translation, const LeviathanCore::MathTypes::Euler& rotation, const LeviathanCore::MathTypes::Vector3& scale)
-			: Translation(translation), Rotation(rotation), Scale(scale)
-		{}
-
-		LeviathanCore::MathTypes::Matrix4x4 Matrix()
-		{
-			return LeviathanCore::MathTypes::Matrix4x4::Translation(Translation) *
-				LeviathanCore::MathTypes::Matrix4x4::Rotation(Rotation) *
-				LeviathanCore::MathTypes::Matrix4x4::Scaling(Scale);
-		}
-	};
-
 #ifdef LEVIATHAN_WITH_TOOLS
 	static LeviathanTools::DemoTool gDemoTool = {};
 	static LeviathanTools::PerfStatsDisplay gPerfStatsDisplay = {};
@@ -60,7 +46,11 @@ namespace TestTitle
 	static LeviathanRenderer::RendererResourceId::IdType gSkyboxVertexBufferId = LeviathanRenderer::RendererResourceId::InvalidId;
 	static LeviathanRenderer::RendererResourceId::IdType gSkyboxIndexBufferId = LeviathanRenderer::RendererResourceId::InvalidId;
 
-	static Transform gObjectTransform = {};
+	static LeviathanCore::Scene::TransformHierarchy gSceneHierarchy = {};
+	static LeviathanCore::Scene::TransformHierarchy::NodeId gObjectNode = LeviathanCore::Scene::TransformHierarchy::InvalidNodeId;
+	static LeviathanCore::BoundingVolumes::AABB gObjectBounds = {};
+	static float gObjectTextureCoordinateDensity = 1.0f;
+	static LeviathanRenderer::RenderableId gObjectRenderable = LeviathanRenderer::InvalidRenderableId;
 
 	static LeviathanRenderer::Camera gSceneCamera = {};
 	static LeviathanRenderer::Camera gSkyboxCamera = {};
@@ -69,7 +59,6 @@ namespace TestTitle
 	static std::vector<LeviathanRenderer::LightTypes::PointLight> gScenePointLights = {};
 	static std::vector<LeviathanRenderer::LightTypes::SpotLight> gSceneSpotLights = {};
 
-	static LeviathanRenderer::RendererResourceId::IdType gHDRTexture2DResourceId = LeviathanRenderer::RendererResourceId::InvalidId;
 	static LeviathanRenderer::RendererResourceId::IdType gEnvironmentTextureCubeId = LeviathanRenderer::RendererResourceId::InvalidId;
 
 	static LeviathanRenderer::RendererResourceId::IdType gColorTextureId = LeviathanRenderer::RendererResourceId::InvalidId;
@@ -82,6 +71,163 @@ namespace TestTitle
 	static LeviathanRenderer::RendererResourceId::IdType gLinearTextureSamplerId = LeviathanRenderer::RendererResourceId::InvalidId;
 	static LeviathanRenderer::RendererResourceId::IdType gPointTextureSamplerId = LeviathanRenderer::RendererResourceId::InvalidId;
 
+	static LeviathanRenderer::RenderMaterial MakeObjectMaterial()
+	{
+		LeviathanRenderer::RenderMaterial material = {};
+		material.ColorTexture = gColorTextureId;
+		material.MetallicTexture = gMetallicTextureId;
+		material.RoughnessTexture = gRoughnessTextureId;
+		material.NormalTexture = gNormalTextureId;
+		material.Sampler = gAnisotropicTextureSamplerId;
+		return material;
+	}
+
+	// Streamable texture file of a streamed texture read by the renderer when it streams the texture's mips.
+	struct StreamedTextureFile
+	{
+		std::string File = {};
+		LeviathanAssets::StreamableTexture::Header Header = {};
+		// Whether the texture was created as a streamed texture rather than a fallback texture.
+		bool Streamed = false;
+	};
+
+	static std::array<StreamedTextureFile, 3> gBrickTextureFiles = {};
+
+	static bool ReadStreamedTextureMips(uint32_t firstMip, uint32_t mipCount, std::vector<uint8_t>& outMipData, void* userData)
+	{
+		const StreamedTextureFile& file = *static_cast<const StreamedTextureFile*>(userData);
+		return LeviathanAssets::StreamableTexture::ReadMips(file.File, file.Header, firstMip, mipCount, outMipData);
+	}
+
+	// Creates a streamed texture from a streamable texture file, cooking the file from the source image if it does not exist or the source image
+	// changed since it was cooked.
+	static bool CreateBrickTexture(std::string_view sourceFile, std::string_view streamableFile, bool sRGB, StreamedTextureFile& outFile,
+		LeviathanRenderer::RendererResourceId::IdType& outId)
+	{
+		outFile.File = streamableFile;
+		LeviathanCore::Serialize::FileStamp sourceStamp = {};
+		const bool hasSource = LeviathanCore::Serialize::GetFileStamp(sourceFile, sourceStamp);
+		if (!LeviathanAssets::StreamableTexture::LoadHeader(streamableFile, outFile.Header) || (hasSource && !(outFile.Header.Source == sourceStamp)))
+		{
+			LeviathanAssets::AssetTypes::Texture texture = {};
+			if (!LeviathanAssets::TextureImporter::LoadTexture(sourceFile, texture))
+			{
+				LEVIATHAN_LOG("Failed to load texture %s from disk.", sourceFile.data());
+				return false;
+			}
+
+			std::vector<uint8_t> mipData = {};
+			const bool built = LeviathanAssets::StreamableTexture::BuildMipChain(texture, sRGB, outFile.Header, mipData);
+			LeviathanAssets::TextureImporter::FreeTexture(texture.Data);
+			outFile.Header.Source = sourceStamp;
+			if (!built || !LeviathanAssets::StreamableTexture::Save(streamableFile, outFile.Header, mipData))
+			{
+				LEVIATHAN_LOG("Failed to cook streamable texture %s.", streamableFile.data());
+				return false;
+			}
+		}
+
+		LeviathanRenderer::StreamedTexture2DDescription description = {};
+		description.Width = outFile.Header.Width;
+		description.Height = outFile.Header.Height;
+		description.MipCount = outFile.Header.MipCount;
+		description.sRGB = outFile.Header.sRGB;
+		description.ReadMips = &ReadStreamedTextureMips;
+		description.UserData = &outFile;
+		outFile.Streamed = LeviathanRenderer::CreateStreamedTexture2D(description, outId);
+		return outFile.Streamed;
+	}
+
+	static void DestroyBrickTexture(StreamedTextureFile& file, LeviathanRenderer::RendererResourceId::IdType& id)
+	{
+		if (file.Streamed)
+		{
+			LeviathanRenderer::DestroyStreamedTexture2D(id);
+		}
+		else
+		{
+			LeviathanRenderer::DestroyTexture2D(id);
+		}
+		file.Streamed = false;
+	}
+
+	// Bakes image based lighting from the environment cubemap's faces to a file, logging the time of each bake stage.
+	static bool CookImageBasedLighting(const std::vector<float>& faces, uint32_t faceSize, const LeviathanAssets::ImageBasedLighting::Settings& settings,
+		std::string_view lightingFile)
+	{
+		LeviathanAssets::ImageBasedLighting::BakedLighting lighting = {};
+		LeviathanAssets::ImageBasedLighting::BakeStats stats = {};
+		if (!LeviathanAssets::ImageBasedLighting::Bake(faces.data(), faceSize, settings, lighting, stats) ||
+			!LeviathanAssets::ImageBasedLighting::Save(lightingFile, lighting))
+		{
+			LEVIATHAN_LOG("Failed to bake image based lighting %s.", lightingFile.data());
+			return false;
+		}
+
+		LEVIATHAN_LOG("Baked image based lighting %s. Source mips %.1f ms, irradiance %.1f ms, specular %.1f ms, BRDF lookup table %.1f ms.", lightingFile.data(),
+			stats.SourceMipMilliseconds, stats.IrradianceMilliseconds, stats.SpecularMilliseconds, stats.BrdfLutMilliseconds);
+		return true;
+	}
+
+	// Creates an HDR cubemap from an environment cubemap file, converting the file from the equirectangular source image if it does not exist, was
+	// converted with other settings or the source image changed since it was converted. Image based lighting is baked from the cubemap whenever it
+	// is converted or the lighting file does not exist or was baked with other settings. Half float faces are uploaded as they are stored.
+	static bool CreateHDREnvironmentCubemap(std::string_view sourceFile, std::string_view cubemapFile, std::string_view lightingFile,
+		const LeviathanAssets::EnvironmentCubemap::Settings& settings, const LeviathanAssets::ImageBasedLighting::Settings& lightingSettings,
+		LeviathanRenderer::RendererResourceId::IdType& outId)
+	{
+		LeviathanAssets::EnvironmentCubemap::Header header = {};
+		std::vector<uint8_t> faceData = {};
+		LeviathanCore::Serialize::FileStamp sourceStamp = {};
+		const bool hasSource = LeviathanCore::Serialize::GetFileStamp(sourceFile, sourceStamp);
+		LeviathanAssets::ImageBasedLighting::BakedLighting lighting = {};
+		bool bakeLighting = !LeviathanAssets::ImageBasedLighting::Load(lightingFile, lighting) || !(lighting.BakeSettings == lightingSettings);
+		if (!LeviathanAssets::EnvironmentCubemap::Load(cubemapFile, header, faceData) || (header.MipCount != 1) || (header.FaceSize != settings.FaceSize) ||
+			(header.FacePrecision != settings.FacePrecision) || (header.SampleFilter != settings.SampleFilter) || (hasSource && !(header.Source == sourceStamp)))
+		{
+			bakeLighting = true;
+			LeviathanAssets::AssetTypes::HDRTexture equirectangularTexture = {};
+			if (!LeviathanAssets::TextureImporter::LoadHDRTexture(sourceFile, equirectangularTexture))
+			{
+				LEVIATHAN_LOG("Failed to load HDR environment texture %s from disk.", sourceFile.data());
+				return false;
+			}
+
+			const bool converted = LeviathanAssets::EnvironmentCubemap::Convert(equirectangularTexture, settings, header, faceData);
+			LeviathanAssets::TextureImporter::FreeTexture(equirectangularTexture.Data);
+			header.Source = sourceStamp;
+			if (!converted || !LeviathanAssets::EnvironmentCubemap::Save(cubemapFile, header, faceData))
+			{
+				LEVIATHAN_LOG("Failed to convert environment cubemap %s.", cubemapFile.data());
+				return false;
+			}
+		}
+
+		if (bakeLighting)
+		{
+			std::vector<float> faces = {};
+			LeviathanAssets::EnvironmentCubemap::ToFloat32(header, faceData, faces);
+			CookImageBasedLighting(faces, header.FaceSize, lightingSettings, lightingFile);
+		}
+
+		const size_t faceSizeBytes = LeviathanAssets::EnvironmentCubemap::GetFaceSizeBytes(header);
+
+		LeviathanRenderer::TextureCubeDescription description = {};
+		description.FaceWidth = header.FaceSize;
+		for (size_t face = 0; face < description.FaceTextureData.size(); ++face)
+		{
+			description.FaceTextureData[face] = faceData.data() + (face * faceSizeBytes);
+		}
+		description.HDR = true;
+		description.HalfFloat = (header.FacePrecision == LeviathanAssets::EnvironmentCubemap::Precision::Float16);
+		return LeviathanRenderer::CreateTextureCube(description, outId);
+	}
+
+	static void OnGpuMemoryBudgetExceeded(LeviathanRenderer::GpuMemoryCategory category, size_t usedBytes, size_t budgetBytes, [[maybe_unused]] void* userData)
+	{
+		LEVIATHAN_LOG("Gpu memory budget of category %u exceeded. %zu of %zu bytes used.", static_cast<uint32_t>(category), usedBytes, budgetBytes);
+	}
+
 	static void OnRuntimeWindowResized(int renderAreaWidth, int renderAreaHeight)
 	{
 		gSceneCamera.UpdateProjectionMatrix(renderAreaWidth, renderAreaHeight);
@@ -176,8 +322,18 @@ namespace TestTitle
 		}
 
 		// Update object transform.
-		//gObjectTransform.Rotation.SetYawRadians(gObjectTransform.Rotation.YawRadians() + (0.75f * deltaSeconds));
-		//gObjectTransform.Rotation.SetPitchRadians(gObjectTransform.Rotation.PitchRadians() + (0.75f * deltaSeconds));
+		//static float objectYawRadians = 0.0f;
+		//objectYawRadians += (0.75f * deltaSeconds);
+		//gSceneHierarchy.SetLocalRotation(gObjectNode, LeviathanCore::MathTypes::Quaternion(LeviathanCore::MathTypes::Euler(0.0f, objectYawRadians, 0.0f)));
+
+		// Update world matrices of changed scene transforms.
+		gSceneHierarchy.Update();
+
+		// Only renderables whose transform changed are updated in the render world.
+		if (gSceneHierarchy.HasWorldChanged(gObjectNode))
+		{
+			LeviathanRenderer::SetRenderableTransform(gObjectRenderable, gSceneHierarchy.GetWorldMatrix(gObjectNode));
+		}
 	}
 
 	static void OnPostTick()
@@ -313,16 +469,25 @@ namespace TestTitle
 			gSceneDirectionalLights.data(), gSceneDirectionalLights.size(),
 			gScenePointLights.data(), gScenePointLights.size(),
 			gSceneSpotLights.data(), gSceneSpotLights.size(),
-			gEnvironmentTextureCubeId, gLinearTextureSamplerId,
-			gColorTextureId, gMetallicTextureId, gRoughnessTextureId, gNormalTextureId, gAnisotropicTextureSamplerId,
-			gObjectTransform.Matrix(), gIndexCount, gVertexBufferId, gIndexBufferId);
+			gEnvironmentTextureCubeId, gLinearTextureSamplerId);
 	}
 
 #ifdef LEVIATHAN_WITH_TOOLS
 	static void OnRenderImGui()
 	{
 		//gDemoTool.Render();
-		//gPerfStatsDisplay.Render(LeviathanCore::Core::GetPerfFPS(), LeviathanCore::Core::GetPerfMs());
+
+		// Gpu memory used by each category and in total against the budgets.
+		const LeviathanRenderer::GpuMemoryStats& gpuMemoryStats = LeviathanRenderer::GetGpuMemoryStats();
+		std::array<LeviathanTools::GpuMemoryUsage, LeviathanRenderer::GpuMemoryCategoryCount + 1> gpuMemory = {};
+		for (size_t category = 0; category < LeviathanRenderer::GpuMemoryCategoryCount; ++category)
+		{
+			gpuMemory[category] = LeviathanTools::GpuMemoryUsage{ .Category = LeviathanRenderer::GetGpuMemoryCategoryName(static_cast<LeviathanRenderer::GpuMemoryCategory>(category)),
+				.UsedBytes = gpuMemoryStats.Categories[category].UsedBytes, .BudgetBytes = gpuMemoryStats.Categories[category].BudgetBytes };
+		}
+		gpuMemory.back() = LeviathanTools::GpuMemoryUsage{ .Category = LeviathanRenderer::GetGpuMemoryCategoryName(LeviathanRenderer::GpuMemoryCategory::MAX),
+			.UsedBytes = gpuMemoryStats.UsedBytes, .BudgetBytes = gpuMemoryStats.BudgetBytes };
+		gPerfStatsDisplay.Render(LeviathanCore::Core::GetPerfFPS(), LeviathanCore::Core::GetPerfMs(), gpuMemory.data(), gpuMemory.size());
 	}
 #endif // LEVIATHAN_WITH_TOOLS.
 
@@ -333,6 +498,20 @@ namespace TestTitle
 
 	static void OnCleanup()
 	{
+		// Remove title renderables.
+		LeviathanRenderer::DestroyRenderable(gObjectRenderable);
+
+		// Destroy material textures. The normal texture is the default normal texture if the brick normal texture could not be created.
+		DestroyBrickTexture(gBrickTextureFiles[0], gColorTextureId);
+		DestroyBrickTexture(gBrickTextureFiles[1], gRoughnessTextureId);
+		if (gBrickTextureFiles[2].Streamed)
+		{
+			DestroyBrickTexture(gBrickTextureFiles[2], gNormalTextureId);
+		}
+		gNormalTextureId = LeviathanRenderer::RendererResourceId::InvalidId;
+		LeviathanRenderer::DestroyTexture2D(gDefaultNormalTextureId);
+		LeviathanRenderer::DestroyTexture2D(gMetallicTextureId);
+
 		// Shutdown engine modules used by title.
 		LeviathanAssets::Shutdown();
 		LeviathanRenderer::Shutdown();
@@ -374,6 +553,11 @@ namespace TestTitle
 			return false;
 		}
 
+		// Gpu memory budget of the title's resources and render targets.
+		static constexpr size_t gpuMemoryBudgetBytes = 1024ull * 1024 * 1024;
+		LeviathanRenderer::SetGpuMemoryTotalBudget(gpuMemoryBudgetBytes);
+		LeviathanRenderer::SetGpuMemoryBudgetExceededCallback(&OnGpuMemoryBudgetExceeded, nullptr);
+
 		if (!LeviathanAssets::Initialize())
 		{
 			return false;
@@ -422,6 +606,8 @@ namespace TestTitle
 
 			gSingleVertexStrideBytes = sizeof(LeviathanRenderer::VertexTypes::VertexPos3Norm3UV2Tang3);
 			gIndexCount = static_cast<unsigned int>(combinedModel.Indices.size());
+			gObjectBounds = combinedModel.Bounds;
+			gObjectTextureCoordinateDensity = combinedModel.CalculateTextureCoordinateDensity();
 
 			// Build render mesh.
 			// For each vertex in the mesh.
@@ -513,149 +699,107 @@ namespace TestTitle
 			LEVIATHAN_LOG("Failed to create point texture sampler.");
 		}
 
-		// Create test cubemap.
-		LeviathanAssets::AssetTypes::Texture positiveXTexture = {};
-		if (!LeviathanAssets::TextureImporter::LoadTexture("skybox/right.png", positiveXTexture))
+		// Create the skybox from the HDR environment cubemap, converting the equirectangular HDR environment texture on the cpu on first run. A face
+		// spans a quarter of the 4k texture's width, so 1024 texel faces keep its detail at the horizon. Image based lighting is baked from the
+		// cubemap alongside it. The low dynamic range skybox images are the fallback.
+		LeviathanAssets::EnvironmentCubemap::Settings environmentCubemapSettings = {};
+		environmentCubemapSettings.FaceSize = 1024;
+		environmentCubemapSettings.FacePrecision = LeviathanAssets::EnvironmentCubemap::Precision::Float16;
+		environmentCubemapSettings.SampleFilter = LeviathanAssets::EnvironmentCubemap::Filter::Box;
+		const LeviathanAssets::ImageBasedLighting::Settings imageBasedLightingSettings = {};
+		if (!CreateHDREnvironmentCubemap("blocky_photo_studio_4k.hdr", "blocky_photo_studio_4k.lcube", "blocky_photo_studio_4k_lighting.lcube",
+			environmentCubemapSettings, imageBasedLightingSettings, gEnvironmentTextureCubeId))
 		{
-			LEVIATHAN_LOG("Failed to load cubemap right texture.");
-		}
-
-		LeviathanAssets::AssetTypes::Texture negativeXTexture = {};
-		if (!LeviathanAssets::TextureImporter::LoadTexture("skybox/left.png", negativeXTexture))
-		{
-			LEVIATHAN_LOG("Failed to load cubemap left texture.");
-		}
-
-		LeviathanAssets::AssetTypes::Texture positiveYTexture = {};
-		if (!LeviathanAssets::TextureImporter::LoadTexture("skybox/top.png", positiveYTexture))
-		{
-			LEVIATHAN_LOG("Failed to load cubemap top texture.");
-		}
-
-		LeviathanAssets::AssetTypes::Texture negativeYTexture = {};
-		if (!LeviathanAssets::TextureImporter::LoadTexture("skybox/bottom.png", negativeYTexture))
-		{
-			LEVIATHAN_LOG("Failed to load cubemap bottom texture.");
-		}
-
-		LeviathanAssets::AssetTypes::Texture positiveZTexture = {};
-		if (!LeviathanAssets::TextureImporter::LoadTexture("skybox/front.png", positiveZTexture))
-		{
-			LEVIATHAN_LOG("Failed to load cubemap front texture.");
-		}
+			LEVIATHAN_LOG("Failed to create HDR environment cubemap resource.");
 
-		LeviathanAssets::AssetTypes::Texture negativeZTexture = {};
-		if (!LeviathanAssets::TextureImporter::LoadTexture("skybox/back.png", negativeZTexture))
-		{
-			LEVIATHAN_LOG("Failed to load cubemap back texture.");
-		}
-
-		LeviathanRenderer::TextureCubeDescription textureCubeDesc = {};
-		textureCubeDesc.FaceWidth = positiveXTexture.Width;
-		textureCubeDesc.FaceTextureData[0] = positiveXTexture.Data;
-		textureCubeDesc.FaceTextureData[1] = negativeXTexture.Data;
-		textureCubeDesc.FaceTextureData[2] = positiveYTexture.Data;
-		textureCubeDesc.FaceTextureData[3] = negativeYTexture.Data;
-		textureCubeDesc.FaceTextureData[4] = positiveZTexture.Data;
-		textureCubeDesc.FaceTextureData[5] = negativeZTexture.Data;
-		textureCubeDesc.sRGB = true;
-		if (!LeviathanRenderer::CreateTextureCube(textureCubeDesc, gEnvironmentTextureCubeId))
-		{
-			LEVIATHAN_LOG("Failed to create cube texture.");
-		}
+			LeviathanAssets::AssetTypes::Texture positiveXTexture = {};
+			if (!LeviathanAssets::TextureImporter::LoadTexture("skybox/right.png", positiveXTexture))
+			{
+				LEVIATHAN_LOG("Failed to load cubemap right texture.");
+			}
 
-		// Import HDR environment texture and convert equirectangular to cubemap.
-		// Import HDR environment texture. Imported image is in equirectangular format.
-		LeviathanAssets::AssetTypes::HDRTexture hdrEnvTexture = {};
-		if (!LeviathanAssets::TextureImporter::LoadHDRTexture("blocky_photo_studio_4k.hdr", hdrEnvTexture))
-		{
-			LEVIATHAN_LOG("Failed to load HDR environment texture from disk.");
-		}
+			LeviathanAssets::AssetTypes::Texture negativeXTexture = {};
+			if (!LeviathanAssets::TextureImporter::LoadTexture("skybox/left.png", negativeXTexture))
+			{
+				LEVIATHAN_LOG("Failed to load cubemap left texture.");
+			}
 
-		// Create texture resource for equirectangular format.
-		static constexpr uint32_t hdrBytesPerPixel = 16;
+			LeviathanAssets::AssetTypes::Texture positiveYTexture = {};
+			if (!LeviathanAssets::TextureImporter::LoadTexture("skybox/top.png", positiveYTexture))
+			{
+				LEVIATHAN_LOG("Failed to load cubemap top texture.");
+			}
 
-		LeviathanRenderer::Texture2DDescription HDRTexture2DResourceDesc = {};
-		HDRTexture2DResourceDesc.Width = hdrEnvTexture.Width;
-		HDRTexture2DResourceDesc.Height = hdrEnvTexture.Height;
-		HDRTexture2DResourceDesc.Data = static_cast<void*>(hdrEnvTexture.Data);
-		HDRTexture2DResourceDesc.RowSizeBytes = hdrBytesPerPixel * hdrEnvTexture.Width;
-		HDRTexture2DResourceDesc.HDR = true;
-		if (!LeviathanRenderer::CreateTexture2D(HDRTexture2DResourceDesc, gHDRTexture2DResourceId))
-		{
-			LEVIATHAN_LOG("Failed to create HDR texture 2D resource.");
-		}
+			LeviathanAssets::AssetTypes::Texture negativeYTexture = {};
+			if (!LeviathanAssets::TextureImporter::LoadTexture("skybox/bottom.png", negativeYTexture))
+			{
+				LEVIATHAN_LOG("Failed to load cubemap bottom texture.");
+			}
 
-		// Import textures.
-		LeviathanAssets::AssetTypes::Texture brickDiffuseTexture = {};
-		if (!LeviathanAssets::TextureImporter::LoadTexture("red_bricks_04_diff_1k.png", brickDiffuseTexture))
-		{
-			LEVIATHAN_LOG("Failed to load brick diffuse texture from disk.");
-		}
+			LeviathanAssets::AssetTypes::Texture positiveZTexture = {};
+			if (!LeviathanAssets::TextureImporter::LoadTexture("skybox/front.png", positiveZTexture))
+			{
+				LEVIATHAN_LOG("Failed to load cubemap front texture.");
+			}
 
-		LeviathanAssets::AssetTypes::Texture brickRoughnessTexture = {};
-		if (!LeviathanAssets::TextureImporter::LoadTexture("red_bricks_04_rough_1k.png", brickRoughnessTexture))
-		{
-			LEVIATHAN_LOG("Failed to load brick roughness texture from disk.");
-		}
+			LeviathanAssets::AssetTypes::Texture negativeZTexture = {};
+			if (!LeviathanAssets::TextureImporter::LoadTexture("skybox/back.png", negativeZTexture))
+			{
+				LEVIATHAN_LOG("Failed to load cubemap back texture.");
+			}
 
-		LeviathanAssets::AssetTypes::Texture brickNormalTexture = {};
-		if (!LeviathanAssets::TextureImporter::LoadTexture("red_bricks_04_nor_dx_1k.png", brickNormalTexture))
-		{
-			LEVIATHAN_LOG("Failed to load brick normal texture from disk.");
+			LeviathanRenderer::TextureCubeDescription textureCubeDesc = {};
+			textureCubeDesc.FaceWidth = positiveXTexture.Width;
+			textureCubeDesc.FaceTextureData[0] = positiveXTexture.Data;
+			textureCubeDesc.FaceTextureData[1] = negativeXTexture.Data;
+			textureCubeDesc.FaceTextureData[2] = positiveYTexture.Data;
+			textureCubeDesc.FaceTextureData[3] = negativeYTexture.Data;
+			textureCubeDesc.FaceTextureData[4] = positiveZTexture.Data;
+			textureCubeDesc.FaceTextureData[5] = negativeZTexture.Data;
+			textureCubeDesc.sRGB = true;
+			if (!LeviathanRenderer::CreateTextureCube(textureCubeDesc, gEnvironmentTextureCubeId))
+			{
+				LEVIATHAN_LOG("Failed to create cube texture.");
+			}
 		}
 
-		// Create texture resources.
+		// Create streamed brick textures, cooking their mip chains to streamable texture files on first run. The tail mips are created now and finer
+		// mips are streamed as the object needs them.
 		static constexpr uint32_t bytesPerPixel = 4;
-
-		LeviathanRenderer::Texture2DDescription brickDiffuseTextureDesc = {};
-		if (brickDiffuseTexture.Data)
-		{
-			brickDiffuseTextureDesc.Width = brickDiffuseTexture.Width;
-			brickDiffuseTextureDesc.Height = brickDiffuseTexture.Height;
-			brickDiffuseTextureDesc.Data = brickDiffuseTexture.Data;
-			brickDiffuseTextureDesc.RowSizeBytes = bytesPerPixel * brickDiffuseTexture.Width;
-			brickDiffuseTextureDesc.sRGB = true;
-			brickDiffuseTextureDesc.GenerateMipmaps = true;
-		}
-		else
-		{
-			brickDiffuseTextureDesc.Width = 1;
-			brickDiffuseTextureDesc.Height = 1;
-			const LeviathanRenderer::LinearColor fallbackColor(255, 0, 255, 255);
-			brickDiffuseTextureDesc.Data = &fallbackColor;
-			brickDiffuseTextureDesc.RowSizeBytes = bytesPerPixel * 1;
-			brickDiffuseTextureDesc.sRGB = false;
-			brickDiffuseTextureDesc.GenerateMipmaps = false;
-		}
-		if (!LeviathanRenderer::CreateTexture2D(brickDiffuseTextureDesc, gColorTextureId))
+		if (!CreateBrickTexture("red_bricks_04_diff_1k.png", "red_bricks_04_diff_1k.lstx", true, gBrickTextureFiles[0], gColorTextureId))
 		{
 			LEVIATHAN_LOG("Failed to create brick diffuse texture resource.");
-		}
 
-		LeviathanRenderer::Texture2DDescription brickRoughnessTextureDesc = {};
-		if (brickRoughnessTexture.Data)
-		{
-			brickRoughnessTextureDesc.Width = brickRoughnessTexture.Width;
-			brickRoughnessTextureDesc.Height = brickRoughnessTexture.Height;
-			brickRoughnessTextureDesc.Data = brickRoughnessTexture.Data;
-			brickRoughnessTextureDesc.RowSizeBytes = bytesPerPixel * brickRoughnessTexture.Width;
-			brickRoughnessTextureDesc.sRGB = false;
-			brickRoughnessTextureDesc.GenerateMipmaps = true;
-		}
-		else
-		{
-			brickRoughnessTextureDesc.Width = 1;
-			brickRoughnessTextureDesc.Height = 1;
-			const LeviathanRenderer::LinearColor fallbackRoughness(254, 0, 0, 0);
-			brickRoughnessTextureDesc.Data = &fallbackRoughness;
-			brickRoughnessTextureDesc.RowSizeBytes = bytesPerPixel * 1;
-			brickRoughnessTextureDesc.sRGB = false;
-			brickRoughnessTextureDesc.GenerateMipmaps = false;
+			LeviathanRenderer::Texture2DDescription fallbackColorTextureDesc = {};
+			fallbackColorTextureDesc.Width = 1;
+			fallbackColorTextureDesc.Height = 1;
+			const LeviathanRenderer::LinearColor fallbackColor(255, 0, 255, 255);
+			fallbackColorTextureDesc.Data = &fallbackColor;
+			fallbackColorTextureDesc.RowSizeBytes = bytesPerPixel * 1;
+			fallbackColorTextureDesc.sRGB = false;
+			fallbackColorTextureDesc.GenerateMipmaps = false;
+			if (!LeviathanRenderer::CreateTexture2D(fallbackColorTextureDesc, gColorTextureId))
+			{
+				LEVIATHAN_LOG("Failed to create fallback color texture resource.");
+			}
 		}
-		if (!LeviathanRenderer::CreateTexture2D(brickRoughnessTextureDesc, gRoughnessTextureId))
+
+		if (!CreateBrickTexture("red_bricks_04_rough_1k.png", "red_bricks_04_rough_1k.lstx", false, gBrickTextureFiles[1], gRoughnessTextureId))
 		{
 			LEVIATHAN_LOG("Failed to create brick roughness texture resource.");
+
+			LeviathanRenderer::Texture2DDescription fallbackRoughnessTextureDesc = {};
+			fallbackRoughnessTextureDesc.Width = 1;
+			fallbackRoughnessTextureDesc.Height = 1;
+			const LeviathanRenderer::LinearColor fallbackRoughness(254, 0, 0, 0);
+			fallbackRoughnessTextureDesc.Data = &fallbackRoughness;
+			fallbackRoughnessTextureDesc.RowSizeBytes = bytesPerPixel * 1;
+			fallbackRoughnessTextureDesc.sRGB = false;
+			fallbackRoughnessTextureDesc.GenerateMipmaps = false;
+			if (!LeviathanRenderer::CreateTexture2D(fallbackRoughnessTextureDesc, gRoughnessTextureId))
+			{
+				LEVIATHAN_LOG("Failed to create fallback roughness texture resource.");
+			}
 		}
 
 		LeviathanRenderer::Texture2DDescription metallicTextureDesc = {};
@@ -684,27 +828,28 @@ namespace TestTitle
 			LEVIATHAN_LOG("Failed to create default normal texture resource.");
 		}
 
-		LeviathanRenderer::Texture2DDescription brickNormalTextureDesc = {};
-		if (brickNormalTexture.Data)
-		{
-			brickNormalTextureDesc.Width = brickNormalTexture.Width;
-			brickNormalTextureDesc.Height = brickNormalTexture.Height;
-			brickNormalTextureDesc.Data = brickNormalTexture.Data;
-			brickNormalTextureDesc.RowSizeBytes = bytesPerPixel * brickNormalTexture.Width;
-			brickNormalTextureDesc.sRGB = false;
-			brickNormalTextureDesc.GenerateMipmaps = true;
-		}
-		else
-		{
-			brickNormalTextureDesc = defaultNormalTextureDesc;
-		}
-		if (!LeviathanRenderer::CreateTexture2D(brickNormalTextureDesc, gNormalTextureId))
+		if (!CreateBrickTexture("red_bricks_04_nor_dx_1k.png", "red_bricks_04_nor_dx_1k.lstx", false, gBrickTextureFiles[2], gNormalTextureId))
 		{
 			LEVIATHAN_LOG("Failed to create brick normal texture resource.");
+			gNormalTextureId = gDefaultNormalTextureId;
 		}
 
 		// Define object transform.
-		gObjectTransform = {};
+		gSceneHierarchy.Clear();
+		gObjectNode = gSceneHierarchy.CreateNode();
+		gSceneHierarchy.Update();
+
+		// Register object renderable.
+		LeviathanRenderer::RenderableDescription objectRenderable = {};
+		objectRenderable.Mesh.VertexBuffer = gVertexBufferId;
+		objectRenderable.Mesh.IndexBuffer = gIndexBufferId;
+		objectRenderable.Mesh.IndexCount = gIndexCount;
+		objectRenderable.Mesh.VertexStrideBytes = static_cast<uint32_t>(gSingleVertexStrideBytes);
+		objectRenderable.Mesh.LocalBounds = gObjectBounds;
+		objectRenderable.Mesh.TextureCoordinateDensity = gObjectTextureCoordinateDensity;
+		objectRenderable.Material = MakeObjectMaterial();
+		objectRenderable.Transform = gSceneHierarchy.GetWorldMatrix(gObjectNode);
+		gObjectRenderable = LeviathanRenderer::CreateRenderable(objectRenderable);
 
 		// Define cameras.
 		int windowWidth = 0;
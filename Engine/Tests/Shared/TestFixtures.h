@@ -0,0 +1,47 @@
+#pragma once
+
+#include "MathTypes.h"
+#include "BoundingVolumes.h"
+#include "JobSystem.h"
+
+// Scenes and helpers shared by the tests and the benchmarks.
+namespace LeviathanTestFixtures
+{
+	// Camera at the origin looking down +z with a 60 degree vertical field of view.
+	inline LeviathanCore::MathTypes::Matrix4x4 MakeViewProjection(const float farPlane)
+	{
+		const LeviathanCore::MathTypes::Matrix4x4 view = LeviathanCore::MathTypes::Matrix4x4::View(LeviathanCore::MathTypes::Vector3(0.0f, 0.0f, 0.0f),
+			LeviathanCore::MathTypes::Euler(0.0f, 0.0f, 0.0f));
+		const LeviathanCore::MathTypes::Matrix4x4 projection = LeviathanCore::MathTypes::Matrix4x4::PerspectiveProjection(1.0471975512f, 16.0f / 9.0f, 0.1f, farPlane);
+		return projection * view;
+	}
+
+	inline LeviathanCore::BoundingVolumes::Frustum MakeFrustum(const float farPlane)
+	{
+		return LeviathanCore::BoundingVolumes::Frustum::FromViewProjection(MakeViewProjection(farPlane));
+	}
+
+	// Position 20 to 800 units inside the view frustum of the camera.
+	inline LeviathanCore::MathTypes::Vector3 RandomVisiblePosition(std::mt19937& random)
+	{
+		std::uniform_real_distribution<float> depthDistribution(20.0f, 800.0f);
+		std::uniform_real_distribution<float> offsetDistribution(-0.25f, 0.25f);
+		const float z = depthDistribution(random);
+		return LeviathanCore::MathTypes::Vector3(offsetDistribution(random) * z, offsetDistribution(random) * z, z);
+	}
+
+	// Calls the function with the threading name "SingleThread" while the job system is not initialized so that the work runs on the calling
+	// thread, then with "JobSystem" on a job system of workerCount workers, 0 for one per hardware thread.
+	template <typename Function>
+	void RunSingleThreadAndJobSystem(const size_t workerCount, Function&& function)
+	{
+		function(std::string_view("SingleThread"));
+
+		const bool startedJobSystem = LeviathanCore::JobSystem::Initialize(workerCount);
+		function(std::string_view("JobSystem"));
+		if (startedJobSystem)
+		{
+			LeviathanCore::JobSystem::Shutdown();
+		}
+	}
+}
@@ -0,0 +1,144 @@
+#include "TestSuites.h"
+#include "Test.h"
+#include "TestFixtures.h"
+#include "MathTypes.h"
+#include "MathLibrary.h"
+#include "BoundingVolumes.h"
+
+namespace LeviathanTests
+{
+	static constexpr size_t BoundingVolumeCount = 10007;
+	static constexpr size_t FrustumPointCount = 1 << 16;
+	static constexpr float SceneHalfSize = 500.0f;
+	static constexpr float FarPlane = 400.0f;
+
+	// Returns the number of elements where the batched result differs from the scalar result over the whole array and over a range that does not
+	// start or end on a SIMD lane boundary.
+	template <typename Batch, typename Scalar>
+	static size_t CountBatchMismatches(Batch&& batch, Scalar&& scalar)
+	{
+		size_t mismatches = 0;
+		for (const std::pair<size_t, size_t>& range : { std::pair<size_t, size_t>(0, BoundingVolumeCount), std::pair<size_t, size_t>(5, BoundingVolumeCount - 13) })
+		{
+			std::vector<uint8_t> results(range.second, 0xff);
+			batch(range.first, range.second, results.data());
+			for (size_t i = 0; i < range.second; ++i)
+			{
+				mismatches += (results[i] != (scalar(range.first + i) ? 1 : 0)) ? 1 : 0;
+			}
+		}
+		return mismatches;
+	}
+
+	void RunBoundingVolumeTests(Tester& tester)
+	{
+		using namespace LeviathanCore;
+
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> positionDistribution(-SceneHalfSize, SceneHalfSize);
+		std::uniform_real_distribution<float> sizeDistribution(0.1f, 8.0f);
+
+		BoundingVolumes::SphereArray spheres = {};
+		BoundingVolumes::AABBArray aabbs = {};
+		for (size_t i = 0; i < BoundingVolumeCount; ++i)
+		{
+			const MathTypes::Vector3 center(positionDistribution(random), positionDistribution(random), positionDistribution(random));
+			const MathTypes::Vector3 halfExtents(sizeDistribution(random), sizeDistribution(random), sizeDistribution(random));
+			spheres.Add(BoundingVolumes::Sphere{ center, halfExtents.Length() });
+			aabbs.Add(BoundingVolumes::AABB{ center - halfExtents, center + halfExtents });
+		}
+
+		const MathTypes::Matrix4x4 viewProjection = LeviathanTestFixtures::MakeViewProjection(FarPlane);
+		const BoundingVolumes::Frustum frustum = BoundingVolumes::Frustum::FromViewProjection(viewProjection);
+		const BoundingVolumes::SphereSoA sphereView = spheres.View();
+		const BoundingVolumes::AABBSoA aabbView = aabbs.View();
+
+		// Points are classified against the clip space volume and the frustum planes, skipping points near the boundary.
+		tester.Run("BoundingVolumes.Frustum.FromViewProjection.MatchesClipSpace", [&]()
+			{
+				size_t mismatches = 0;
+				for (size_t i = 0; i < FrustumPointCount; ++i)
+				{
+					const MathTypes::Vector3 point(positionDistribution(random), positionDistribution(random), positionDistribution(random) * 0.5f + 250.0f);
+					const MathTypes::Vector4 clip = viewProjection * MathTypes::Vector4(point, 1.0f);
+					const float w = clip.W();
+					const float margin = std::min({ w - std::fabs(clip.X()), w - std::fabs(clip.Y()), clip.Z(), w - clip.Z() });
+					if (std::fabs(margin) < 1e-3f * std::max(1.0f, std::fabs(w)))
+					{
+						continue;
+					}
+					mismatches += ((margin >= 0.0f) != frustum.Intersects(point)) ? 1 : 0;
+				}
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, mismatches, 0);
+			});
+
+		tester.Run("BoundingVolumes.FrustumSpheres.BatchMatchesScalar", [&]()
+			{
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountBatchMismatches(
+					[&](const size_t first, const size_t count, uint8_t* results) { BoundingVolumes::TestFrustumSpheres(frustum, sphereView, first, count, results); },
+					[&](const size_t i) { return frustum.Intersects(spheres.Get(i)); }), 0);
+			});
+
+		tester.Run("BoundingVolumes.FrustumAABBs.BatchMatchesScalar", [&]()
+			{
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountBatchMismatches(
+					[&](const size_t first, const size_t count, uint8_t* results) { BoundingVolumes::TestFrustumAABBs(frustum, aabbView, first, count, results); },
+					[&](const size_t i) { return frustum.Intersects(aabbs.Get(i)); }), 0);
+			});
+
+		const BoundingVolumes::AABB query{ MathTypes::Vector3(-100.0f, -100.0f, -100.0f), MathTypes::Vector3(100.0f, 100.0f, 100.0f) };
+
+		tester.Run("BoundingVolumes.AABBAABBs.BatchMatchesScalar", [&]()
+			{
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountBatchMismatches(
+					[&](const size_t first, const size_t count, uint8_t* results) { BoundingVolumes::TestAABBAABBs(query, aabbView, first, count, results); },
+					[&](const size_t i) { return query.Intersects(aabbs.Get(i)); }), 0);
+			});
+
+		tester.Run("BoundingVolumes.AABBSpheres.BatchMatchesScalar", [&]()
+			{
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountBatchMismatches(
+					[&](const size_t first, const size_t count, uint8_t* results) { BoundingVolumes::TestAABBSpheres(query, sphereView, first, count, results); },
+					[&](const size_t i) { return spheres.Get(i).Intersects(query); }), 0);
+			});
+
+		const BoundingVolumes::Sphere querySphere{ MathTypes::Vector3(20.0f, -10.0f, 5.0f), 150.0f };
+
+		tester.Run("BoundingVolumes.SphereAABBs.BatchMatchesScalar", [&]()
+			{
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountBatchMismatches(
+					[&](const size_t first, const size_t count, uint8_t* results) { BoundingVolumes::TestSphereAABBs(querySphere, aabbView, first, count, results); },
+					[&](const size_t i) { return querySphere.Intersects(aabbs.Get(i)); }), 0);
+			});
+
+		const BoundingVolumes::Cone queryCone{ MathTypes::Vector3(-50.0f, 0.0f, -50.0f), MathTypes::Vector3(1.0f, 0.2f, 1.0f).AsNormalizedSafe(),
+			MathLibrary::DegreesToRadians(30.0f), 400.0f };
+
+		tester.Run("BoundingVolumes.ConeAABBs.BatchMatchesScalar", [&]()
+			{
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountBatchMismatches(
+					[&](const size_t first, const size_t count, uint8_t* results) { BoundingVolumes::TestConeAABBs(queryCone, aabbView, first, count, results); },
+					[&](const size_t i) { return queryCone.Intersects(aabbs.Get(i)); }), 0);
+			});
+
+		const BoundingVolumes::Ray ray{ MathTypes::Vector3(-SceneHalfSize, -3.0f, 2.0f), MathTypes::Vector3(1.0f, 0.01f, -0.005f).AsNormalizedSafe() };
+		const float rayLength = 2.0f * SceneHalfSize;
+
+		tester.Run("BoundingVolumes.RayAABBs.BatchMatchesScalar", [&]()
+			{
+				std::vector<float> distances(BoundingVolumeCount, 0.0f);
+				size_t hits = 0;
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountBatchMismatches(
+					[&](const size_t first, const size_t count, uint8_t* results) { BoundingVolumes::TestRayAABBs(ray, rayLength, aabbView, first, count, results, distances.data()); },
+					[&](const size_t i)
+					{
+						float distance = 0.0f;
+						const bool hit = ray.Intersects(aabbs.Get(i), rayLength, distance);
+						hits += hit ? 1 : 0;
+						return hit;
+					}), 0);
+				// The ray must hit something for the comparison to cover the hit path.
+				LEVIATHAN_TEST_CHECK(tester, hits > 0);
+			});
+	}
+}
@@ -0,0 +1,157 @@
+#include "TestSuites.h"
+#include "Test.h"
+#include "TestFixtures.h"
+#include "MathTypes.h"
+#include "BoundingVolumes.h"
+#include "LightTypes.h"
+#include "ClusteredLighting.h"
+
+namespace LeviathanTests
+{
+	static constexpr size_t ClusteredPointLightCount = 2000;
+	static constexpr size_t ClusteredSpotLightCount = 500;
+	static constexpr size_t SpotConeSamplesPerLight = 64;
+	static constexpr size_t JobSystemWorkerCount = 3;
+
+	struct ClusteredLightScene
+	{
+		LeviathanRenderer::ClusterView View = {};
+		std::vector<LeviathanRenderer::LightTypes::PointLight> PointLights = {};
+		std::vector<LeviathanRenderer::LightTypes::SpotLight> SpotLights = {};
+	};
+
+	// Camera slightly above the origin looking down +z with a 60 degree vertical field of view. Lights with radii of 1 to 20 units are scattered over a
+	// box enclosing the first 600 units of the frustum and some space behind the camera. Lights are bright enough for the radius to bound their
+	// influence.
+	static ClusteredLightScene MakeClusteredLightScene()
+	{
+		ClusteredLightScene scene = {};
+		scene.View.ViewMatrix = LeviathanCore::MathTypes::Matrix4x4::View(LeviathanCore::MathTypes::Vector3(0.0f, 10.0f, -20.0f),
+			LeviathanCore::MathTypes::Euler(0.0f, 0.0f, 0.0f));
+		scene.View.FovYRadians = 1.0471975512f;
+		scene.View.AspectRatio = 16.0f / 9.0f;
+		scene.View.NearZ = 0.1f;
+		scene.View.FarZ = 800.0f;
+
+		std::mt19937 random(9753);
+		std::uniform_real_distribution<float> horizontalDistribution(-400.0f, 400.0f);
+		std::uniform_real_distribution<float> verticalDistribution(-250.0f, 250.0f);
+		std::uniform_real_distribution<float> depthDistribution(-50.0f, 600.0f);
+		std::uniform_real_distribution<float> radiusDistribution(1.0f, 20.0f);
+		std::uniform_real_distribution<float> unitDistribution(-1.0f, 1.0f);
+		std::uniform_real_distribution<float> coneAngleDistribution(LeviathanCore::MathLibrary::DegreesToRadians(5.0f), LeviathanCore::MathLibrary::DegreesToRadians(70.0f));
+
+		scene.PointLights.resize(ClusteredPointLightCount);
+		for (LeviathanRenderer::LightTypes::PointLight& light : scene.PointLights)
+		{
+			light.Position = LeviathanCore::MathTypes::Vector3(horizontalDistribution(random), verticalDistribution(random), depthDistribution(random));
+			light.Brightness = 4.0f;
+			light.Radius = radiusDistribution(random);
+		}
+
+		scene.SpotLights.resize(ClusteredSpotLightCount);
+		for (LeviathanRenderer::LightTypes::SpotLight& light : scene.SpotLights)
+		{
+			light.Position = LeviathanCore::MathTypes::Vector3(horizontalDistribution(random), verticalDistribution(random), depthDistribution(random));
+			light.Direction = LeviathanCore::MathTypes::Vector3(unitDistribution(random), unitDistribution(random), unitDistribution(random)).AsNormalizedSafe();
+			light.OuterConeAngleRadians = coneAngleDistribution(random);
+			light.Brightness = 4.0f;
+			light.Radius = radiusDistribution(random);
+		}
+		return scene;
+	}
+
+	// Returns the number of cluster light assignments that differ from testing every light against every cluster with the scalar sphere box test. Light
+	// lists out of ascending order also count as mismatches.
+	static size_t CountClusterMismatches(const LeviathanRenderer::ClusteredLightCulling& culling, const size_t lightCount)
+	{
+		std::vector<uint8_t> assigned(lightCount, 0);
+		size_t mismatches = 0;
+		for (uint32_t slice = 0; slice < culling.GetSliceCount(); ++slice)
+		{
+			for (uint32_t tileY = 0; tileY < culling.GetTileCountY(); ++tileY)
+			{
+				for (uint32_t tileX = 0; tileX < culling.GetTileCountX(); ++tileX)
+				{
+					const LeviathanRenderer::ClusteredLightCulling::ClusterLights& cluster = culling.GetClusters()[culling.GetClusterIndex(tileX, tileY, slice)];
+					const uint32_t* const lights = culling.GetLightIndices() + cluster.Offset;
+					std::fill(assigned.begin(), assigned.end(), static_cast<uint8_t>(0));
+					for (uint32_t i = 0; i < cluster.Count; ++i)
+					{
+						assigned[lights[i]] = 1;
+						mismatches += ((i > 0) && (lights[i - 1] >= lights[i])) ? 1 : 0;
+					}
+
+					const LeviathanCore::BoundingVolumes::AABB bounds = culling.GetClusterBounds(tileX, tileY, slice);
+					for (size_t light = 0; light < lightCount; ++light)
+					{
+						mismatches += ((assigned[light] != 0) != culling.GetLightBounds(light).Intersects(bounds)) ? 1 : 0;
+					}
+				}
+			}
+		}
+		return mismatches;
+	}
+
+	// Returns the number of points sampled inside the spot light cones that fall outside the light's view space bounding sphere.
+	static size_t CountSpotConeSamplesOutsideBounds(const LeviathanRenderer::ClusteredLightCulling& culling, const ClusteredLightScene& scene)
+	{
+		std::mt19937 random(8642);
+		std::uniform_real_distribution<float> unitDistribution(0.0f, 1.0f);
+
+		size_t outside = 0;
+		for (size_t spot = 0; spot < scene.SpotLights.size(); ++spot)
+		{
+			const LeviathanRenderer::LightTypes::SpotLight& light = scene.SpotLights[spot];
+			const LeviathanCore::BoundingVolumes::Sphere bounds = culling.GetLightBounds(scene.PointLights.size() + spot);
+			const float radius = LeviathanRenderer::LightTypes::GetInfluenceRadius(light);
+
+			// Orthonormal basis around the cone axis.
+			const LeviathanCore::MathTypes::Vector3 helper = (std::fabs(light.Direction.Y()) < 0.9f) ? LeviathanCore::MathTypes::Vector3(0.0f, 1.0f, 0.0f) :
+				LeviathanCore::MathTypes::Vector3(1.0f, 0.0f, 0.0f);
+			const LeviathanCore::MathTypes::Vector3 tangent = LeviathanCore::MathTypes::Vector3::CrossProduct(light.Direction, helper).AsNormalizedSafe();
+			const LeviathanCore::MathTypes::Vector3 bitangent = LeviathanCore::MathTypes::Vector3::CrossProduct(light.Direction, tangent);
+
+			for (size_t sample = 0; sample < SpotConeSamplesPerLight; ++sample)
+			{
+				// Every other sample lies on the cone's surface at the full radius.
+				const bool onSurface = (sample % 2) == 0;
+				const float angle = onSurface ? light.OuterConeAngleRadians : light.OuterConeAngleRadians * unitDistribution(random);
+				const float azimuth = LeviathanCore::MathLibrary::TwoPi * unitDistribution(random);
+				const float distance = onSurface ? radius : radius * unitDistribution(random);
+				const LeviathanCore::MathTypes::Vector3 direction = light.Direction * LeviathanCore::MathLibrary::Cos(angle) +
+					(tangent * LeviathanCore::MathLibrary::Cos(azimuth) + bitangent * LeviathanCore::MathLibrary::Sin(azimuth)) * LeviathanCore::MathLibrary::Sin(angle);
+
+				const LeviathanCore::MathTypes::Vector4 pointViewSpace = scene.View.ViewMatrix * LeviathanCore::MathTypes::Vector4(light.Position + direction * distance, 1.0f);
+				const LeviathanCore::MathTypes::Vector3 offset = LeviathanCore::MathTypes::Vector3(pointViewSpace.X(), pointViewSpace.Y(), pointViewSpace.Z()) - bounds.Center;
+				outside += (offset.Length() > bounds.Radius * 1.001f) ? 1 : 0;
+			}
+		}
+		return outside;
+	}
+
+	static void RunClusterAssignmentTests(Tester& tester, const std::string_view threadingName, const ClusteredLightScene& scene)
+	{
+		tester.Run("ClusteredLighting.Assign." + std::string(threadingName), [&]()
+			{
+				const size_t lightCount = scene.PointLights.size() + scene.SpotLights.size();
+				LeviathanRenderer::ClusteredLightCulling culling = {};
+				// Building twice checks that retained light lists are reset.
+				culling.Build(scene.View, scene.PointLights.data(), scene.PointLights.size(), scene.SpotLights.data(), scene.SpotLights.size());
+				culling.Build(scene.View, scene.PointLights.data(), scene.PointLights.size(), scene.SpotLights.data(), scene.SpotLights.size());
+				LEVIATHAN_TEST_CHECK(tester, culling.GetLightIndexCount() > 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountClusterMismatches(culling, lightCount), 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountSpotConeSamplesOutsideBounds(culling, scene), 0);
+			});
+	}
+
+	void RunClusteredLightingTests(Tester& tester)
+	{
+		const ClusteredLightScene scene = MakeClusteredLightScene();
+
+		LeviathanTestFixtures::RunSingleThreadAndJobSystem(JobSystemWorkerCount, [&](const std::string_view threadingName)
+			{
+				RunClusterAssignmentTests(tester, threadingName, scene);
+			});
+	}
+}
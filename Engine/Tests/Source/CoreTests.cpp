@@ -0,0 +1,89 @@
+#include "TestSuites.h"
+#include "Test.h"
+#include "Serialize.h"
+
+namespace LeviathanTests
+{
+	static constexpr size_t SerializeUIntCount = 1 << 16;
+
+	void RunCoreTests(Tester& tester)
+	{
+		std::vector<uint32_t> uints(SerializeUIntCount, 0);
+		std::mt19937 random(1234);
+		for (uint32_t& value : uints)
+		{
+			value = static_cast<uint32_t>(random());
+		}
+
+		tester.Run("Serialize.UInt32Buffer.RoundTrips", [&]()
+			{
+				for (const LeviathanCore::Serialize::Endianness endianness : { LeviathanCore::Serialize::Endianness::LittleEndian, LeviathanCore::Serialize::Endianness::BigEndian })
+				{
+					const std::vector<uint8_t> bytes = LeviathanCore::Serialize::UInt32BufferToBytes(uints, endianness);
+					LEVIATHAN_TEST_CHECK_EQUAL(tester, bytes.size(), uints.size() * sizeof(uint32_t));
+					LEVIATHAN_TEST_CHECK(tester, LeviathanCore::Serialize::BytesToUInt32Buffer(bytes, endianness) == uints);
+				}
+			});
+
+		tester.Run("Serialize.UInt32.ByteOrder", [&]()
+			{
+				const std::array<uint8_t, 4> little = LeviathanCore::Serialize::UInt32ToBytes(0x01020304u, LeviathanCore::Serialize::Endianness::LittleEndian);
+				const std::array<uint8_t, 4> big = LeviathanCore::Serialize::UInt32ToBytes(0x01020304u, LeviathanCore::Serialize::Endianness::BigEndian);
+				LEVIATHAN_TEST_CHECK(tester, (little == std::array<uint8_t, 4>{ 0x04, 0x03, 0x02, 0x01 }));
+				LEVIATHAN_TEST_CHECK(tester, (big == std::array<uint8_t, 4>{ 0x01, 0x02, 0x03, 0x04 }));
+			});
+
+		tester.Run("Serialize.File.RoundTrips", [&]()
+			{
+				const std::vector<uint8_t> bytes = LeviathanCore::Serialize::UInt32BufferToBytes(uints, LeviathanCore::Serialize::Endianness::LittleEndian);
+				const std::string file = (std::filesystem::temp_directory_path() / "LeviathanTestsSerialize.bin").string();
+
+				LEVIATHAN_TEST_CHECK(tester, LeviathanCore::Serialize::WriteBytesToFile(file, bytes));
+				LEVIATHAN_TEST_CHECK(tester, LeviathanCore::Serialize::FileExists(file));
+
+				std::vector<uint8_t> read = {};
+				LEVIATHAN_TEST_CHECK(tester, LeviathanCore::Serialize::ReadFile(file, true, read));
+				LEVIATHAN_TEST_CHECK(tester, read == bytes);
+
+				std::vector<uint8_t> range = {};
+				LEVIATHAN_TEST_CHECK(tester, LeviathanCore::Serialize::ReadFileRange(file, 16, 64, range));
+				LEVIATHAN_TEST_CHECK(tester, std::equal(range.begin(), range.end(), bytes.begin() + 16) && (range.size() == 64));
+				LEVIATHAN_TEST_CHECK(tester, !LeviathanCore::Serialize::ReadFileRange(file, bytes.size() - 8, 64, range));
+
+				// The stamp changes with the file's contents.
+				LeviathanCore::Serialize::FileStamp stamp = {};
+				LeviathanCore::Serialize::FileStamp rewrittenStamp = {};
+				LEVIATHAN_TEST_CHECK(tester, LeviathanCore::Serialize::GetFileStamp(file, stamp));
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, stamp.SizeBytes, bytes.size());
+				LEVIATHAN_TEST_CHECK(tester, LeviathanCore::Serialize::WriteBytesToFile(file, std::vector<uint8_t>(bytes.begin(), bytes.end() - 4)));
+				LEVIATHAN_TEST_CHECK(tester, LeviathanCore::Serialize::GetFileStamp(file, rewrittenStamp));
+				LEVIATHAN_TEST_CHECK(tester, !(rewrittenStamp == stamp));
+
+				std::error_code errorCode = {};
+				std::filesystem::remove(file, errorCode);
+				LEVIATHAN_TEST_CHECK(tester, !LeviathanCore::Serialize::GetFileStamp(file, stamp));
+			});
+
+		// Headers are read only from enough bytes starting with the expected tag.
+		tester.Run("Serialize.FileHeader.ChecksTag", [&]()
+			{
+				struct TestFileHeader
+				{
+					LeviathanCore::Serialize::FileTag Tag = {};
+					uint32_t Value = 0;
+				};
+
+				static constexpr LeviathanCore::Serialize::FileTag Tag = { .Magic = 0x5453454c, .Version = 3 };
+				const TestFileHeader written = { .Tag = Tag, .Value = 42 };
+				std::vector<uint8_t> bytes(sizeof(TestFileHeader) + 4, 0);
+				memcpy(bytes.data(), &written, sizeof(TestFileHeader));
+
+				TestFileHeader read = {};
+				LEVIATHAN_TEST_CHECK(tester, LeviathanCore::Serialize::ReadFileHeader(bytes, Tag, read));
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, read.Value, 42);
+				LEVIATHAN_TEST_CHECK(tester, !LeviathanCore::Serialize::ReadFileHeader(bytes, { .Magic = Tag.Magic, .Version = Tag.Version + 1 }, read));
+				LEVIATHAN_TEST_CHECK(tester, !LeviathanCore::Serialize::ReadFileHeader(bytes, { .Magic = Tag.Magic + 1, .Version = Tag.Version }, read));
+				LEVIATHAN_TEST_CHECK(tester, !LeviathanCore::Serialize::ReadFileHeader(std::vector<uint8_t>(bytes.begin(), bytes.begin() + 8), Tag, read));
+			});
+	}
+}
@@ -0,0 +1,335 @@
+#include "TestSuites.h"
+#include "Test.h"
+#include "EnvironmentCubemap.h"
+#include "AssetTypes.h"
+#include "JobSystem.h"
+#include "Serialize.h"
+
+namespace LeviathanTests
+{
+	static constexpr size_t JobSystemWorkerCount = 3;
+	static constexpr int32_t EnvironmentWidth = 1024;
+	static constexpr int32_t EnvironmentHeight = 512;
+	static constexpr float EnvironmentPi = 3.14159265358979324f;
+	// Relative error of a converted texel to the environment at the texel's center direction counted as an error.
+	static constexpr double EnvironmentTexelTolerance = 1.0e-2;
+	static constexpr double EnvironmentMeanTolerance = 1.0e-3;
+
+	// Smooth sky gradient with a bright sun lobe, so a converted texel matches the radiance at its center direction to within the filter's error.
+	static std::array<float, 3> EvaluateEnvironment(const float x, const float y, const float z)
+	{
+		static constexpr std::array<float, 3> sun = { 0.48f, 0.64f, 0.6f };
+		const float sunCosine = std::max((x * sun[0]) + (y * sun[1]) + (z * sun[2]), 0.0f);
+		const float sunLobe = 6.0f * std::pow(sunCosine, 16.0f);
+		return { 2.0f + x + (0.5f * y * z) + sunLobe, 2.0f + y + sunLobe, 2.0f + z + (0.5f * x * y) + (0.5f * sunLobe) };
+	}
+
+	// Rgba texels with rows from the bottom as loaded by TextureImporter::LoadHDRTexture, and the solid angle weighted mean of every channel.
+	static void MakeEnvironmentTexture(std::vector<float>& outTexels, std::array<double, 3>& outMean)
+	{
+		outTexels.resize(static_cast<size_t>(EnvironmentWidth) * EnvironmentHeight * LeviathanAssets::EnvironmentCubemap::ChannelCount);
+		outMean = {};
+		double totalSolidAngle = 0.0;
+		for (int32_t row = 0; row < EnvironmentHeight; ++row)
+		{
+			const float latitude = (((static_cast<float>(row) + 0.5f) / static_cast<float>(EnvironmentHeight)) - 0.5f) * EnvironmentPi;
+			const double rowBottom = ((static_cast<double>(row) / EnvironmentHeight) - 0.5) * EnvironmentPi;
+			const double rowTop = ((static_cast<double>(row + 1) / EnvironmentHeight) - 0.5) * EnvironmentPi;
+			const double texelSolidAngle = (2.0 * EnvironmentPi / EnvironmentWidth) * (std::sin(rowTop) - std::sin(rowBottom));
+			for (int32_t column = 0; column < EnvironmentWidth; ++column)
+			{
+				const float longitude = (((static_cast<float>(column) + 0.5f) / static_cast<float>(EnvironmentWidth)) - 0.5f) * 2.0f * EnvironmentPi;
+				const std::array<float, 3> radiance = EvaluateEnvironment(std::cos(latitude) * std::cos(longitude), std::sin(latitude),
+					std::cos(latitude) * std::sin(longitude));
+				float* const texel = outTexels.data() + (((static_cast<size_t>(row) * EnvironmentWidth) + column) * LeviathanAssets::EnvironmentCubemap::ChannelCount);
+				texel[0] = radiance[0];
+				texel[1] = radiance[1];
+				texel[2] = radiance[2];
+				texel[3] = 1.0f;
+				for (size_t channel = 0; channel < 3; ++channel)
+				{
+					outMean[channel] += radiance[channel] * texelSolidAngle;
+				}
+				totalSolidAngle += texelSolidAngle;
+			}
+		}
+
+		for (double& mean : outMean)
+		{
+			mean /= totalSolidAngle;
+		}
+	}
+
+	struct EnvironmentConversionErrors
+	{
+		size_t TexelsOverTolerance = 0;
+		double MaxRelativeError = 0.0;
+		double MeanRadianceError = 0.0;
+		// Texels with an alpha other than 1.
+		size_t AlphaErrors = 0;
+	};
+
+	// Compares every converted texel to the environment at the texel's center direction, and the solid angle weighted mean of the faces to the mean of
+	// the equirectangular texture.
+	static EnvironmentConversionErrors MeasureConversionErrors(const LeviathanAssets::EnvironmentCubemap::Header& header, const std::vector<uint8_t>& faceData,
+		const std::array<double, 3>& sourceMean)
+	{
+		EnvironmentConversionErrors errors = {};
+		std::vector<float> faces = {};
+		LeviathanAssets::EnvironmentCubemap::ToFloat32(header, faceData, faces);
+		if (faces.empty())
+		{
+			errors.TexelsOverTolerance = 1;
+			return errors;
+		}
+
+		const uint32_t faceSize = header.FaceSize;
+		std::array<double, 3> mean = {};
+		double totalSolidAngle = 0.0;
+		for (uint32_t face = 0; face < LeviathanAssets::EnvironmentCubemap::FaceCount; ++face)
+		{
+			for (uint32_t y = 0; y < faceSize; ++y)
+			{
+				for (uint32_t x = 0; x < faceSize; ++x)
+				{
+					const float s = (2.0f * (static_cast<float>(x) + 0.5f) / static_cast<float>(faceSize)) - 1.0f;
+					const float t = (2.0f * (static_cast<float>(y) + 0.5f) / static_cast<float>(faceSize)) - 1.0f;
+					float directionX = 0.0f;
+					float directionY = 0.0f;
+					float directionZ = 0.0f;
+					LeviathanAssets::EnvironmentCubemap::GetFaceDirection(face, s, t, directionX, directionY, directionZ);
+					const float inverseLength = 1.0f / std::sqrt((directionX * directionX) + (directionY * directionY) + (directionZ * directionZ));
+					const std::array<float, 3> expected = EvaluateEnvironment(directionX * inverseLength, directionY * inverseLength, directionZ * inverseLength);
+
+					const float* const texel = faces.data() +
+						(((((static_cast<size_t>(face) * faceSize) + y) * faceSize) + x) * LeviathanAssets::EnvironmentCubemap::ChannelCount);
+					const double solidAngle = LeviathanAssets::EnvironmentCubemap::GetTexelSolidAngle(faceSize, x, y);
+					double texelError = 0.0;
+					for (size_t channel = 0; channel < 3; ++channel)
+					{
+						texelError = std::max(texelError, std::fabs(static_cast<double>(texel[channel]) - expected[channel]) / expected[channel]);
+						mean[channel] += texel[channel] * solidAngle;
+					}
+					totalSolidAngle += solidAngle;
+					errors.MaxRelativeError = std::max(errors.MaxRelativeError, texelError);
+					errors.TexelsOverTolerance += (texelError > EnvironmentTexelTolerance) ? 1 : 0;
+					errors.AlphaErrors += (texel[3] != 1.0f) ? 1 : 0;
+				}
+			}
+		}
+
+		for (size_t channel = 0; channel < 3; ++channel)
+		{
+			errors.MeanRadianceError = std::max(errors.MeanRadianceError, std::fabs((mean[channel] / totalSolidAngle) - sourceMean[channel]) / sourceMean[channel]);
+		}
+		return errors;
+	}
+
+	// An environment texture with the solid angle weighted mean of its channels.
+	struct EnvironmentFixture
+	{
+		std::vector<float> Texels = {};
+		std::array<double, 3> SourceMean = {};
+		LeviathanAssets::AssetTypes::HDRTexture Texture = {};
+
+		EnvironmentFixture()
+		{
+			MakeEnvironmentTexture(Texels, SourceMean);
+			Texture.Width = EnvironmentWidth;
+			Texture.Height = EnvironmentHeight;
+			Texture.NumComponentsPerPixel = static_cast<int>(LeviathanAssets::EnvironmentCubemap::ChannelCount);
+			Texture.Data = Texels.data();
+		}
+	};
+
+	static LeviathanAssets::EnvironmentCubemap::Settings MakeEnvironmentSettings(const uint32_t faceSize, const LeviathanAssets::EnvironmentCubemap::Precision precision,
+		const LeviathanAssets::EnvironmentCubemap::Filter filter)
+	{
+		LeviathanAssets::EnvironmentCubemap::Settings settings = {};
+		settings.FaceSize = faceSize;
+		settings.FacePrecision = precision;
+		settings.SampleFilter = filter;
+		return settings;
+	}
+
+	static std::string MakeCubemapFile(const std::string_view name)
+	{
+		return (std::filesystem::temp_directory_path() / ("LeviathanTests" + std::string(name) + ".lcube")).string();
+	}
+
+	void RunEnvironmentCubemapTests(Tester& tester)
+	{
+		const EnvironmentFixture fixture = {};
+
+		// Converted texels match the environment at their center direction and the faces keep the environment's mean radiance.
+		const auto checkConversion = [&](const LeviathanAssets::EnvironmentCubemap::Settings& settings)
+			{
+				LeviathanAssets::EnvironmentCubemap::Header header = {};
+				std::vector<uint8_t> faceData = {};
+				LeviathanAssets::EnvironmentCubemap::Convert(fixture.Texture, settings, header, faceData);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, header.FaceSize, settings.FaceSize);
+				LEVIATHAN_TEST_CHECK(tester, header.FacePrecision == settings.FacePrecision);
+				LEVIATHAN_TEST_CHECK(tester, header.SampleFilter == settings.SampleFilter);
+
+				const EnvironmentConversionErrors errors = MeasureConversionErrors(header, faceData, fixture.SourceMean);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, errors.TexelsOverTolerance, 0);
+				LEVIATHAN_TEST_CHECK_LESS_OR_EQUAL(tester, errors.MeanRadianceError, EnvironmentMeanTolerance);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, errors.AlphaErrors, 0);
+			};
+
+		// Faces a quarter of the texture's width take a single bilinear sample per texel.
+		tester.Run("EnvironmentCubemap.Convert.Bilinear.Float32", [&]()
+			{
+				checkConversion(MakeEnvironmentSettings(EnvironmentWidth / 4, LeviathanAssets::EnvironmentCubemap::Precision::Float32,
+					LeviathanAssets::EnvironmentCubemap::Filter::Bilinear));
+			});
+
+		// Smaller faces average a grid of samples per texel.
+		tester.Run("EnvironmentCubemap.Convert.Box.Float16", [&]()
+			{
+				checkConversion(MakeEnvironmentSettings(EnvironmentWidth / 16, LeviathanAssets::EnvironmentCubemap::Precision::Float16,
+					LeviathanAssets::EnvironmentCubemap::Filter::Box));
+			});
+
+		// Conversion on the job system matches the single thread conversion byte for byte.
+		tester.Run("EnvironmentCubemap.Convert.JobSystemMatchesSingleThread", [&]()
+			{
+				const LeviathanAssets::EnvironmentCubemap::Settings settings = MakeEnvironmentSettings(EnvironmentWidth / 8,
+					LeviathanAssets::EnvironmentCubemap::Precision::Float16, LeviathanAssets::EnvironmentCubemap::Filter::Box);
+				LeviathanAssets::EnvironmentCubemap::Header singleThreadHeader = {};
+				std::vector<uint8_t> singleThreadFaceData = {};
+				LeviathanAssets::EnvironmentCubemap::Convert(fixture.Texture, settings, singleThreadHeader, singleThreadFaceData);
+
+				const bool startedJobSystem = LeviathanCore::JobSystem::Initialize(JobSystemWorkerCount);
+				LeviathanAssets::EnvironmentCubemap::Header header = {};
+				std::vector<uint8_t> faceData = {};
+				LeviathanAssets::EnvironmentCubemap::Convert(fixture.Texture, settings, header, faceData);
+				if (startedJobSystem)
+				{
+					LeviathanCore::JobSystem::Shutdown();
+				}
+				LEVIATHAN_TEST_CHECK(tester, !faceData.empty());
+				LEVIATHAN_TEST_CHECK(tester, faceData == singleThreadFaceData);
+			});
+
+		// Saved cubemaps load back with their settings and faces, and truncated or foreign files are rejected.
+		tester.Run("EnvironmentCubemap.File.RoundTrip", [&]()
+			{
+				LeviathanAssets::EnvironmentCubemap::Header header = {};
+				std::vector<uint8_t> faceData = {};
+				LeviathanAssets::EnvironmentCubemap::Convert(fixture.Texture, MakeEnvironmentSettings(64, LeviathanAssets::EnvironmentCubemap::Precision::Float16,
+					LeviathanAssets::EnvironmentCubemap::Filter::Box), header, faceData);
+				header.Source = { .SizeBytes = 1234, .WriteTime = -5678 };
+
+				const std::string file = MakeCubemapFile("EnvironmentCubemap");
+				LEVIATHAN_TEST_CHECK(tester, LeviathanAssets::EnvironmentCubemap::Save(file, header, faceData));
+				LeviathanAssets::EnvironmentCubemap::Header loadedHeader = {};
+				std::vector<uint8_t> loadedFaceData = {};
+				LEVIATHAN_TEST_CHECK(tester, LeviathanAssets::EnvironmentCubemap::Load(file, loadedHeader, loadedFaceData));
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, loadedHeader.FaceSize, header.FaceSize);
+				LEVIATHAN_TEST_CHECK(tester, loadedHeader.FacePrecision == header.FacePrecision);
+				LEVIATHAN_TEST_CHECK(tester, loadedHeader.SampleFilter == header.SampleFilter);
+				LEVIATHAN_TEST_CHECK(tester, loadedHeader.Source == header.Source);
+				LEVIATHAN_TEST_CHECK(tester, loadedFaceData == faceData);
+
+				std::vector<uint8_t> bytes = {};
+				LEVIATHAN_TEST_CHECK(tester, LeviathanCore::Serialize::ReadFile(file, true, bytes));
+				LEVIATHAN_TEST_CHECK(tester, !bytes.empty());
+				if (!bytes.empty())
+				{
+					const std::vector<uint8_t> truncated(bytes.begin(), bytes.end() - 1);
+					LEVIATHAN_TEST_CHECK(tester, LeviathanCore::Serialize::WriteBytesToFile(file, truncated));
+					LEVIATHAN_TEST_CHECK(tester, !LeviathanAssets::EnvironmentCubemap::Load(file, loadedHeader, loadedFaceData));
+
+					std::vector<uint8_t> foreign = bytes;
+					foreign[0] ^= 0xff;
+					LEVIATHAN_TEST_CHECK(tester, LeviathanCore::Serialize::WriteBytesToFile(file, foreign));
+					LEVIATHAN_TEST_CHECK(tester, !LeviathanAssets::EnvironmentCubemap::Load(file, loadedHeader, loadedFaceData));
+				}
+
+				std::error_code errorCode = {};
+				std::filesystem::remove(file, errorCode);
+			});
+
+		// Mip chains and extra data load back unchanged, and face data not matching the mip count is not saved.
+		tester.Run("EnvironmentCubemap.File.MipsAndExtraData", [&]()
+			{
+				LeviathanAssets::EnvironmentCubemap::Header header = {};
+				header.FaceSize = 16;
+				header.MipCount = LeviathanAssets::EnvironmentCubemap::GetMaxMipCount(header.FaceSize);
+				header.FacePrecision = LeviathanAssets::EnvironmentCubemap::Precision::Float16;
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, header.MipCount, 5);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, LeviathanAssets::EnvironmentCubemap::GetFaceDataSizeBytes(header), (16 * 16 + 8 * 8 + 4 * 4 + 2 * 2 + 1) * 8 * 6);
+
+				std::vector<uint8_t> faceData(LeviathanAssets::EnvironmentCubemap::GetFaceDataSizeBytes(header), 0);
+				for (size_t i = 0; i < faceData.size(); ++i)
+				{
+					faceData[i] = static_cast<uint8_t>(i * 31);
+				}
+				const std::vector<uint8_t> extraData = { 1, 2, 3, 4, 5 };
+
+				const std::string file = MakeCubemapFile("EnvironmentCubemapMips");
+				LEVIATHAN_TEST_CHECK(tester, LeviathanAssets::EnvironmentCubemap::Save(file, header, faceData, extraData));
+				LeviathanAssets::EnvironmentCubemap::Header loadedHeader = {};
+				std::vector<uint8_t> loadedFaceData = {};
+				std::vector<uint8_t> loadedExtraData = {};
+				LEVIATHAN_TEST_CHECK(tester, LeviathanAssets::EnvironmentCubemap::Load(file, loadedHeader, loadedFaceData, loadedExtraData));
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, loadedHeader.MipCount, header.MipCount);
+				LEVIATHAN_TEST_CHECK(tester, loadedFaceData == faceData);
+				LEVIATHAN_TEST_CHECK(tester, loadedExtraData == extraData);
+
+				std::vector<float> widened = {};
+				LeviathanAssets::EnvironmentCubemap::ToFloat32(loadedHeader, loadedFaceData, widened);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, widened.size(), faceData.size() / sizeof(uint16_t));
+
+				header.MipCount = 1;
+				LEVIATHAN_TEST_CHECK(tester, !LeviathanAssets::EnvironmentCubemap::Save(file, header, faceData));
+				header.MipCount = 6;
+				LEVIATHAN_TEST_CHECK(tester, !LeviathanAssets::EnvironmentCubemap::Save(file, header, faceData));
+
+				std::error_code errorCode = {};
+				std::filesystem::remove(file, errorCode);
+			});
+
+		// Every half other than NaNs and infinities converts to a float and back to itself.
+		tester.Run("EnvironmentCubemap.Half.RoundTrip", [&]()
+			{
+				size_t roundTripMismatches = 0;
+				for (uint32_t bits = 0; bits <= 0xffff; ++bits)
+				{
+					const uint16_t half = static_cast<uint16_t>(bits);
+					const bool nan = ((half & 0x7c00u) == 0x7c00u) && ((half & 0x03ffu) != 0);
+					const bool infinity = ((half & 0x7fffu) == 0x7c00u);
+					if (!nan && !infinity)
+					{
+						roundTripMismatches += (LeviathanAssets::EnvironmentCubemap::FloatToHalf(LeviathanAssets::EnvironmentCubemap::HalfToFloat(half)) != half) ? 1 : 0;
+					}
+				}
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, roundTripMismatches, 0);
+			});
+
+		// No half is closer to a value than its conversion.
+		tester.Run("EnvironmentCubemap.Half.RoundsToNearest", [&]()
+			{
+				static constexpr size_t ValueCount = 64 * 1024;
+				std::mt19937 random(49);
+				std::uniform_real_distribution<float> exponentDistribution(-16.0f, 16.0f);
+				size_t roundingErrors = 0;
+				for (size_t i = 0; i < ValueCount; ++i)
+				{
+					const float value = std::exp2(exponentDistribution(random));
+					const uint16_t half = LeviathanAssets::EnvironmentCubemap::FloatToHalf(value);
+					const double error = std::fabs(static_cast<double>(LeviathanAssets::EnvironmentCubemap::HalfToFloat(half)) - value);
+					for (const uint16_t neighbor : { static_cast<uint16_t>(half - 1), static_cast<uint16_t>(half + 1) })
+					{
+						const float neighborValue = LeviathanAssets::EnvironmentCubemap::HalfToFloat(neighbor);
+						if (std::isfinite(neighborValue) && (neighborValue >= 0.0f) && (std::fabs(static_cast<double>(neighborValue) - value) < error))
+						{
+							++roundingErrors;
+						}
+					}
+				}
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, roundingErrors, 0);
+			});
+	}
+}
@@ -0,0 +1,270 @@
+#include "TestSuites.h"
+#include "Test.h"
+#include "GpuMemory.h"
+
+namespace LeviathanTests
+{
+	static constexpr size_t GpuMemoryResourceCount = 2048;
+	static constexpr size_t GpuMemoryFrameCount = 120;
+	static constexpr size_t GpuMemoryChurnPerFrame = 16;
+	// Resources used by each frame out of every 4.
+	static constexpr uint32_t GpuMemoryUsedFraction = 4;
+	// Demoted textures are evicted once they are smaller than this.
+	static constexpr size_t GpuMemoryMinDemotedBytes = 64 * 1024;
+
+	// A resource of the simulated title and the state the tracker is expected to hold for it.
+	struct GpuMemoryResourceRecord
+	{
+		LeviathanRenderer::GpuMemoryCategory Category = LeviathanRenderer::GpuMemoryCategory::VertexBuffer;
+		size_t SizeBytes = 0;
+		uint8_t Priority = LeviathanRenderer::GpuMemoryTracker::NotReclaimable;
+		uint64_t LastUsedFrame = 0;
+		LeviathanRenderer::GpuAllocationId Allocation = LeviathanRenderer::InvalidGpuAllocationId;
+	};
+
+	static GpuMemoryResourceRecord MakeGpuMemoryResource(std::mt19937& random)
+	{
+		GpuMemoryResourceRecord resource = {};
+		switch (random() % 5)
+		{
+		case 0:
+			resource.Category = LeviathanRenderer::GpuMemoryCategory::VertexBuffer;
+			resource.SizeBytes = (256 + (random() % 65536)) * 44;
+			break;
+
+		case 1:
+			resource.Category = LeviathanRenderer::GpuMemoryCategory::IndexBuffer;
+			resource.SizeBytes = (384 + (random() % 196608)) * sizeof(uint32_t);
+			break;
+
+		case 2:
+		case 3:
+		{
+			const uint32_t width = 64u << (random() % 6);
+			const uint32_t height = width >> (random() % 2);
+			const bool HDR = (random() % 8) == 0;
+			resource.Category = LeviathanRenderer::GpuMemoryCategory::Texture2D;
+			resource.SizeBytes = LeviathanRenderer::GetGpuTextureBytes(width, height, static_cast<uint32_t>(std::bit_width(std::min(width, height))), 1,
+				HDR ? LeviathanRenderer::GpuTextureFormat::RGBA32Float : LeviathanRenderer::GpuTextureFormat::RGBA8);
+			break;
+		}
+
+		default:
+			resource.Category = LeviathanRenderer::GpuMemoryCategory::TextureCube;
+			resource.SizeBytes = LeviathanRenderer::GetGpuTextureBytes(32u << (random() % 4), 32u << (random() % 4), 1, 6, LeviathanRenderer::GpuTextureFormat::RGBA8);
+			break;
+		}
+
+		// Three of four resources are reclaimable at one of four priorities.
+		const uint32_t priority = random() % 4;
+		resource.Priority = (random() % 4 != 0) ? static_cast<uint8_t>(priority) : LeviathanRenderer::GpuMemoryTracker::NotReclaimable;
+		return resource;
+	}
+
+	// Demotes textures to a quarter of their size, evicts buffers and small textures and refuses every 11th reclaim, checking every reclaim
+	// against the simulated resources.
+	struct RecordingGpuMemoryBackend
+	{
+		LeviathanRenderer::GpuMemoryTracker* Tracker = nullptr;
+		std::vector<GpuMemoryResourceRecord>* Resources = nullptr;
+		uint64_t Frame = 0;
+		size_t Reclaims = 0;
+		size_t ReclaimedUsedResources = 0;
+		size_t ReclaimedNotReclaimable = 0;
+		size_t ReclaimOrderViolations = 0;
+		size_t Evictions = 0;
+		size_t Demotions = 0;
+		// Priority, last used frame and category of the previous reclaim of the frame.
+		std::pair<uint8_t, uint64_t> PreviousReclaim = { 0, 0 };
+		LeviathanRenderer::GpuMemoryCategory PreviousCategory = LeviathanRenderer::GpuMemoryCategory::MAX;
+
+		bool Reclaim(const LeviathanRenderer::GpuAllocationId allocation, const uint64_t resource)
+		{
+			GpuMemoryResourceRecord& record = (*Resources)[resource];
+			ReclaimedUsedResources += (record.LastUsedFrame >= Frame) ? 1 : 0;
+			ReclaimedNotReclaimable += ((record.Priority == LeviathanRenderer::GpuMemoryTracker::NotReclaimable) || (record.Allocation != allocation)) ? 1 : 0;
+
+			// Reclaims of each budget are ordered. Categories are reclaimed one after the other, so order is only checked within a category.
+			const std::pair<uint8_t, uint64_t> order = { record.Priority, record.LastUsedFrame };
+			ReclaimOrderViolations += ((Reclaims > 0) && (order < PreviousReclaim) && (PreviousCategory == record.Category)) ? 1 : 0;
+			PreviousReclaim = order;
+			PreviousCategory = record.Category;
+			++Reclaims;
+
+			if (Reclaims % 11 == 0)
+			{
+				return false;
+			}
+
+			const bool texture = (record.Category == LeviathanRenderer::GpuMemoryCategory::Texture2D) ||
+				(record.Category == LeviathanRenderer::GpuMemoryCategory::TextureCube);
+			if (texture && (record.SizeBytes / 4 >= GpuMemoryMinDemotedBytes))
+			{
+				record.SizeBytes /= 4;
+				Tracker->Resize(record.Allocation, record.SizeBytes);
+				++Demotions;
+			}
+			else
+			{
+				Tracker->Untrack(record.Allocation);
+				record.SizeBytes = 0;
+				++Evictions;
+			}
+			return true;
+		}
+	};
+
+	struct GpuMemoryBudgetEvents
+	{
+		size_t Events = 0;
+		std::array<size_t, LeviathanRenderer::GpuMemoryCategoryCount + 1> CategoryEvents = {};
+	};
+
+	static void OnGpuMemoryBudgetExceeded(const LeviathanRenderer::GpuMemoryCategory category, size_t, size_t, void* const userData)
+	{
+		GpuMemoryBudgetEvents& events = *static_cast<GpuMemoryBudgetEvents*>(userData);
+		++events.Events;
+		++events.CategoryEvents[static_cast<size_t>(category)];
+	}
+
+	static void TrackGpuMemoryResource(LeviathanRenderer::GpuMemoryTracker& tracker, std::vector<GpuMemoryResourceRecord>& resources, const size_t index)
+	{
+		GpuMemoryResourceRecord& resource = resources[index];
+		resource.Allocation = tracker.Track(resource.Category, resource.SizeBytes, index);
+		tracker.SetReclaimPriority(resource.Allocation, resource.Priority);
+		resource.LastUsedFrame = tracker.GetFrameIndex();
+	}
+
+	// Marks a quarter of the resources used by the frame and replaces the churned resources with new ones.
+	static void SimulateGpuMemoryFrame(LeviathanRenderer::GpuMemoryTracker& tracker, std::vector<GpuMemoryResourceRecord>& resources, std::mt19937& random)
+	{
+		for (size_t i = 0; i < GpuMemoryChurnPerFrame; ++i)
+		{
+			const size_t index = random() % resources.size();
+			tracker.Untrack(resources[index].Allocation);
+			resources[index] = MakeGpuMemoryResource(random);
+			TrackGpuMemoryResource(tracker, resources, index);
+		}
+
+		for (GpuMemoryResourceRecord& resource : resources)
+		{
+			if ((resource.Allocation != LeviathanRenderer::InvalidGpuAllocationId) && (random() % GpuMemoryUsedFraction == 0))
+			{
+				tracker.MarkUsed(resource.Allocation);
+				resource.LastUsedFrame = tracker.GetFrameIndex();
+			}
+		}
+	}
+
+	void RunGpuMemoryTests(Tester& tester)
+	{
+		// Frames checked against the simulated resources: the tracked bytes of every category match the resources, only unused reclaimable
+		// resources are reclaimed, lowest priority and least recently used first, budgets stay exceeded only while no resource can be reclaimed and
+		// the callback reports every budget once each time it becomes exceeded.
+		tester.Run("GpuMemory.EndFrame.ReclaimWithinBudgets", [&]()
+			{
+				std::mt19937 sceneRandom(48);
+				std::vector<GpuMemoryResourceRecord> resources(GpuMemoryResourceCount);
+				size_t sceneBytes = 0;
+				for (GpuMemoryResourceRecord& resource : resources)
+				{
+					resource = MakeGpuMemoryResource(sceneRandom);
+					sceneBytes += resource.SizeBytes;
+				}
+
+				// Budgets holding about two thirds of the scene, so that every frame reclaims the memory of resources churned in.
+				const size_t totalBudget = sceneBytes * 2 / 3;
+				const size_t textureBudget = totalBudget / 2;
+
+				std::mt19937 random(480);
+				LeviathanRenderer::GpuMemoryTracker tracker = {};
+				tracker.SetTotalBudget(totalBudget);
+				tracker.SetBudget(LeviathanRenderer::GpuMemoryCategory::Texture2D, textureBudget);
+				GpuMemoryBudgetEvents events = {};
+				tracker.SetBudgetExceededCallback(&OnGpuMemoryBudgetExceeded, &events);
+				for (size_t i = 0; i < resources.size(); ++i)
+				{
+					TrackGpuMemoryResource(tracker, resources, i);
+				}
+
+				RecordingGpuMemoryBackend backend = { .Tracker = &tracker, .Resources = &resources };
+				size_t accountingMismatches = 0;
+				size_t unreclaimedExceededBudgets = 0;
+				size_t expectedEvents = 0;
+				uint32_t previousExceeded = 0;
+				for (size_t frame = 0; frame < GpuMemoryFrameCount; ++frame)
+				{
+					SimulateGpuMemoryFrame(tracker, resources, random);
+					backend.Frame = tracker.GetFrameIndex();
+					backend.Reclaims = 0;
+					backend.PreviousCategory = LeviathanRenderer::GpuMemoryCategory::MAX;
+					tracker.EndFrame(backend);
+
+					std::array<size_t, LeviathanRenderer::GpuMemoryCategoryCount> categoryBytes = {};
+					std::array<uint32_t, LeviathanRenderer::GpuMemoryCategoryCount> categoryAllocations = {};
+					// Bytes of resources that could still be reclaimed at the end of the frame.
+					std::array<size_t, LeviathanRenderer::GpuMemoryCategoryCount> reclaimableBytes = {};
+					for (const GpuMemoryResourceRecord& resource : resources)
+					{
+						if (resource.Allocation == LeviathanRenderer::InvalidGpuAllocationId)
+						{
+							continue;
+						}
+						const size_t category = static_cast<size_t>(resource.Category);
+						categoryBytes[category] += resource.SizeBytes;
+						++categoryAllocations[category];
+						accountingMismatches += (tracker.GetSizeBytes(resource.Allocation) != resource.SizeBytes) ? 1 : 0;
+						const bool reclaimable = (resource.Priority != LeviathanRenderer::GpuMemoryTracker::NotReclaimable) && (resource.LastUsedFrame < backend.Frame);
+						reclaimableBytes[category] += reclaimable ? resource.SizeBytes : 0;
+					}
+
+					const LeviathanRenderer::GpuMemoryStats& stats = tracker.GetStats();
+					size_t totalBytes = 0;
+					size_t totalReclaimableBytes = 0;
+					uint32_t exceeded = 0;
+					for (size_t category = 0; category < LeviathanRenderer::GpuMemoryCategoryCount; ++category)
+					{
+						accountingMismatches += ((stats.Categories[category].UsedBytes != categoryBytes[category]) ||
+							(stats.Categories[category].Allocations != categoryAllocations[category])) ? 1 : 0;
+						totalBytes += categoryBytes[category];
+						totalReclaimableBytes += reclaimableBytes[category];
+						const bool categoryExceeded = (categoryBytes[category] > tracker.GetBudget(static_cast<LeviathanRenderer::GpuMemoryCategory>(category)));
+						exceeded |= categoryExceeded ? (1u << category) : 0u;
+					}
+					accountingMismatches += (stats.UsedBytes != totalBytes) ? 1 : 0;
+					exceeded |= (totalBytes > totalBudget) ? (1u << LeviathanRenderer::GpuMemoryCategoryCount) : 0u;
+					accountingMismatches += (stats.ExceededBudgets != exceeded) ? 1 : 0;
+					expectedEvents += static_cast<size_t>(std::popcount(exceeded & ~previousExceeded));
+					previousExceeded = exceeded;
+
+					// Refused reclaims may leave a budget exceeded for a frame, so only budgets exceeded by more than the reclaimable bytes count.
+					const size_t textureCategory = static_cast<size_t>(LeviathanRenderer::GpuMemoryCategory::Texture2D);
+					const bool textureUnreclaimed = (categoryBytes[textureCategory] > textureBudget) && (reclaimableBytes[textureCategory] > 0) &&
+						(stats.FrameReclaims == 0);
+					const bool totalUnreclaimed = (totalBytes > totalBudget) && (totalReclaimableBytes > 0) && (stats.FrameReclaims == 0);
+					unreclaimedExceededBudgets += (textureUnreclaimed || totalUnreclaimed) ? 1 : 0;
+				}
+
+				LEVIATHAN_TEST_CHECK(tester, backend.Evictions > 0);
+				LEVIATHAN_TEST_CHECK(tester, backend.Demotions > 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, accountingMismatches, 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, backend.ReclaimedUsedResources, 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, backend.ReclaimedNotReclaimable, 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, backend.ReclaimOrderViolations, 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, unreclaimedExceededBudgets, 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, events.Events, expectedEvents);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, tracker.GetStats().BudgetExceededEvents, expectedEvents);
+			});
+
+		// Texture sizes include every mip and face of their format.
+		tester.Run("GpuMemory.GetGpuTextureBytes", [&]()
+			{
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, LeviathanRenderer::GetGpuTextureBytes(1024, 1024, 11, 1, LeviathanRenderer::GpuTextureFormat::RGBA8), 4 * ((4194304 - 1) / 3));
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, LeviathanRenderer::GetGpuTextureBytes(256, 64, 9, 1, LeviathanRenderer::GpuTextureFormat::RGBA8), 4 * 21847);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, LeviathanRenderer::GetGpuTextureBytes(512, 512, 1, 6, LeviathanRenderer::GpuTextureFormat::RGBA8), 6 * 512 * 512 * 4);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, LeviathanRenderer::GetGpuTextureBytes(4096, 2048, 1, 1, LeviathanRenderer::GpuTextureFormat::RGBA32Float), 4096 * 2048 * 16);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, LeviathanRenderer::GetGpuTextureBytes(1024, 1024, 1, 6, LeviathanRenderer::GpuTextureFormat::RGBA16Float), 1024 * 1024 * 8 * 6);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, LeviathanRenderer::GetGpuTextureBytes(1920, 1080, 1, 1, LeviathanRenderer::GpuTextureFormat::Depth24Stencil8), 1920 * 1080 * 4);
+			});
+	}
+}
@@ -0,0 +1,228 @@
+#include "TestSuites.h"
+#include "Test.h"
+#include "TestFixtures.h"
+#include "MathTypes.h"
+#include "TransformHierarchy.h"
+
+namespace LeviathanTests
+{
+	using TransformHierarchy = LeviathanCore::Scene::TransformHierarchy;
+
+	static constexpr size_t HierarchyNodeCount = 50000;
+	static constexpr size_t HierarchyRootCount = 100;
+	// Every level has this many times the nodes of the level above until the node count is reached.
+	static constexpr size_t HierarchyBranchingFactor = 4;
+	static constexpr size_t DirtyNodeCount = HierarchyNodeCount / 10;
+	static constexpr size_t JobSystemWorkerCount = 3;
+	static constexpr float MaxWorldMatrixError = 1e-3f;
+
+	static LeviathanCore::MathTypes::Quaternion RandomRotation(std::mt19937& random)
+	{
+		std::uniform_real_distribution<float> angleDistribution(-3.14159265f, 3.14159265f);
+		return LeviathanCore::MathTypes::Quaternion(LeviathanCore::MathTypes::Euler(angleDistribution(random), angleDistribution(random), angleDistribution(random)));
+	}
+
+	// Creates HierarchyNodeCount nodes with random local transforms. Each node below the roots has a random parent in the level above. Returns node ids
+	// in creation order so that every parent precedes its children.
+	static std::vector<TransformHierarchy::NodeId> CreateHierarchy(TransformHierarchy& hierarchy, std::mt19937& random)
+	{
+		std::uniform_real_distribution<float> translationDistribution(-2.0f, 2.0f);
+		std::uniform_real_distribution<float> scaleDistribution(0.8f, 1.25f);
+
+		std::vector<TransformHierarchy::NodeId> nodes = {};
+		nodes.reserve(HierarchyNodeCount);
+
+		size_t levelFirst = 0;
+		size_t levelCount = 0;
+		size_t nextLevelCount = HierarchyRootCount;
+		while (nodes.size() < HierarchyNodeCount)
+		{
+			const size_t createCount = std::min(nextLevelCount, HierarchyNodeCount - nodes.size());
+			std::uniform_int_distribution<size_t> parentDistribution(0, (levelCount > 0) ? (levelCount - 1) : 0);
+			const size_t createFirst = nodes.size();
+			for (size_t i = 0; i < createCount; ++i)
+			{
+				const TransformHierarchy::NodeId parent = (levelCount > 0) ? nodes[levelFirst + parentDistribution(random)] : TransformHierarchy::InvalidNodeId;
+				const TransformHierarchy::NodeId node = hierarchy.CreateNode(parent);
+				hierarchy.SetLocalTransform(node,
+					LeviathanCore::MathTypes::Vector3(translationDistribution(random), translationDistribution(random), translationDistribution(random)),
+					RandomRotation(random),
+					LeviathanCore::MathTypes::Vector3(scaleDistribution(random), scaleDistribution(random), scaleDistribution(random)));
+				nodes.push_back(node);
+			}
+
+			levelFirst = createFirst;
+			levelCount = createCount;
+			nextLevelCount = createCount * HierarchyBranchingFactor;
+		}
+		return nodes;
+	}
+
+	// Recomputes the world matrices of the nodes with Matrix4x4 products, walking up to the closest ancestor with a known world matrix, and counts world
+	// matrices of the hierarchy with an element further than MaxWorldMatrixError away.
+	static size_t CountReferenceMismatches(const TransformHierarchy& hierarchy, const std::vector<TransformHierarchy::NodeId>& nodes)
+	{
+		TransformHierarchy::NodeId maxNode = 0;
+		for (const TransformHierarchy::NodeId node : nodes)
+		{
+			maxNode = std::max(maxNode, node);
+		}
+
+		std::vector<LeviathanCore::MathTypes::Matrix4x4> referenceWorlds(static_cast<size_t>(maxNode) + 1);
+		std::vector<uint8_t> known(static_cast<size_t>(maxNode) + 1, 0);
+		std::vector<TransformHierarchy::NodeId> chain = {};
+
+		size_t mismatches = 0;
+		for (const TransformHierarchy::NodeId node : nodes)
+		{
+			TransformHierarchy::NodeId ancestor = node;
+			while ((ancestor != TransformHierarchy::InvalidNodeId) && (known[ancestor] == 0))
+			{
+				chain.push_back(ancestor);
+				ancestor = hierarchy.GetParent(ancestor);
+			}
+
+			while (!chain.empty())
+			{
+				const TransformHierarchy::NodeId current = chain.back();
+				chain.pop_back();
+
+				const LeviathanCore::MathTypes::Matrix4x4 local = LeviathanCore::MathTypes::Matrix4x4::Translation(hierarchy.GetLocalTranslation(current)) *
+					LeviathanCore::MathTypes::Matrix4x4::Rotation(hierarchy.GetLocalRotation(current)) *
+					LeviathanCore::MathTypes::Matrix4x4::Scaling(hierarchy.GetLocalScale(current));
+
+				const TransformHierarchy::NodeId parent = hierarchy.GetParent(current);
+				referenceWorlds[current] = (parent == TransformHierarchy::InvalidNodeId) ? local : (referenceWorlds[parent] * local);
+				known[current] = 1;
+			}
+
+			const float* const expected = referenceWorlds[node].Data();
+			const float* const actual = hierarchy.GetWorldMatrix(node).Data();
+			float maxError = 0.0f;
+			for (size_t element = 0; element < 16; ++element)
+			{
+				maxError = std::max(maxError, std::fabs(expected[element] - actual[element]));
+			}
+			mismatches += (maxError > MaxWorldMatrixError) ? 1 : 0;
+		}
+		return mismatches;
+	}
+
+	static void RunUpdateTests(Tester& tester, const std::string_view threadingName, TransformHierarchy& hierarchy, const std::vector<TransformHierarchy::NodeId>& nodes,
+		std::mt19937& random)
+	{
+		tester.Run("TransformHierarchy.Update.Dirty." + std::string(threadingName), [&]()
+			{
+				std::uniform_int_distribution<size_t> nodeDistribution(0, nodes.size() - 1);
+				std::vector<TransformHierarchy::NodeId> dirtyNodes(DirtyNodeCount);
+				for (TransformHierarchy::NodeId& node : dirtyNodes)
+				{
+					node = nodes[nodeDistribution(random)];
+					hierarchy.SetLocalRotation(node, RandomRotation(random));
+				}
+				hierarchy.Update();
+
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountReferenceMismatches(hierarchy, nodes), 0);
+
+				// Every dirty node and every descendant of one reports a changed world matrix, and nothing else does.
+				size_t changedFlagMismatches = 0;
+				std::vector<uint8_t> dirty(nodes.size(), 0);
+				for (const TransformHierarchy::NodeId node : dirtyNodes)
+				{
+					dirty[node] = 1;
+				}
+				for (const TransformHierarchy::NodeId node : nodes)
+				{
+					const TransformHierarchy::NodeId parent = hierarchy.GetParent(node);
+					dirty[node] = ((dirty[node] != 0) || ((parent != TransformHierarchy::InvalidNodeId) && (dirty[parent] != 0))) ? 1 : 0;
+					changedFlagMismatches += ((dirty[node] != 0) != hierarchy.HasWorldChanged(node)) ? 1 : 0;
+				}
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, changedFlagMismatches, 0);
+
+				// An update with nothing to do clears the changed flags.
+				hierarchy.Update();
+				size_t changedAfterCleanUpdate = 0;
+				for (const TransformHierarchy::NodeId node : nodes)
+				{
+					changedAfterCleanUpdate += hierarchy.HasWorldChanged(node) ? 1 : 0;
+				}
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, changedAfterCleanUpdate, 0);
+			});
+	}
+
+	void RunHierarchyTests(Tester& tester)
+	{
+		std::mt19937 random(4321);
+
+		TransformHierarchy hierarchy = {};
+		const std::vector<TransformHierarchy::NodeId> nodes = CreateHierarchy(hierarchy, random);
+
+		tester.Run("TransformHierarchy.Build", [&]()
+			{
+				hierarchy.Update();
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, hierarchy.GetNodeCount(), HierarchyNodeCount);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountReferenceMismatches(hierarchy, nodes), 0);
+			});
+
+		LeviathanTestFixtures::RunSingleThreadAndJobSystem(JobSystemWorkerCount, [&](const std::string_view threadingName)
+			{
+				RunUpdateTests(tester, threadingName, hierarchy, nodes, random);
+			});
+
+		tester.Run("TransformHierarchy.Reparent", [&]()
+			{
+				// Moving root subtrees under other roots re-sorts storage by depth and recomputes every moved subtree.
+				const size_t levelCount = hierarchy.GetLevelCount();
+				for (size_t root = 0; root + 1 < HierarchyRootCount; root += (HierarchyRootCount / 10))
+				{
+					LEVIATHAN_TEST_CHECK(tester, hierarchy.SetParent(nodes[root], nodes[root + 1]));
+				}
+				hierarchy.Update();
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, hierarchy.GetLevelCount(), levelCount + 1);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountReferenceMismatches(hierarchy, nodes), 0);
+
+				// A node can not be attached to itself or its descendants.
+				LEVIATHAN_TEST_CHECK(tester, !hierarchy.SetParent(nodes[1], nodes[1]));
+				LEVIATHAN_TEST_CHECK(tester, !hierarchy.SetParent(nodes[1], nodes[0]));
+
+				for (size_t root = 0; root + 1 < HierarchyRootCount; root += (HierarchyRootCount / 10))
+				{
+					LEVIATHAN_TEST_CHECK(tester, hierarchy.SetParent(nodes[root], TransformHierarchy::InvalidNodeId));
+				}
+				hierarchy.Update();
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, hierarchy.GetLevelCount(), levelCount);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountReferenceMismatches(hierarchy, nodes), 0);
+			});
+
+		tester.Run("TransformHierarchy.Destroy", [&]()
+			{
+				// Destroyed subtrees must release exactly their nodes and leave the remaining world matrices intact.
+				for (size_t root = 5; root < HierarchyRootCount; root += (HierarchyRootCount / 10))
+				{
+					hierarchy.DestroyNode(nodes[root]);
+				}
+				hierarchy.Update();
+
+				std::vector<TransformHierarchy::NodeId> survivors = {};
+				for (const TransformHierarchy::NodeId node : nodes)
+				{
+					if (hierarchy.IsValid(node))
+					{
+						survivors.push_back(node);
+					}
+				}
+				LEVIATHAN_TEST_CHECK(tester, survivors.size() < HierarchyNodeCount);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, hierarchy.GetNodeCount(), survivors.size());
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountReferenceMismatches(hierarchy, survivors), 0);
+
+				// Every survivor's ancestors survive too.
+				size_t orphans = 0;
+				for (const TransformHierarchy::NodeId node : survivors)
+				{
+					const TransformHierarchy::NodeId parent = hierarchy.GetParent(node);
+					orphans += ((parent != TransformHierarchy::InvalidNodeId) && !hierarchy.IsValid(parent)) ? 1 : 0;
+				}
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, orphans, 0);
+			});
+	}
+}
@@ -0,0 +1,392 @@
+#include "TestSuites.h"
+#include "Test.h"
+#include "ImageBasedLighting.h"
+#include "EnvironmentCubemap.h"
+#include "JobSystem.h"
+#include "Serialize.h"
+
+namespace LeviathanTests
+{
+	static constexpr size_t JobSystemWorkerCount = 3;
+	static constexpr uint32_t LightingSourceFaceSize = 64;
+	static constexpr float LightingPi = 3.14159265358979324f;
+	static constexpr size_t LightingIrradianceDirectionCount = 4096;
+	// Relative error of the irradiance to the analytic irradiance of the environment counted as an error.
+	static constexpr double LightingIrradianceTolerance = 1.0e-2;
+	// Relative error of a mirror mip texel to the environment at the texel's center direction counted as an error.
+	static constexpr double LightingMirrorTolerance = 1.0e-3;
+	// Absolute error of a lookup table texel to the quadrature of the BRDF counted as an error.
+	static constexpr double LightingBrdfTolerance = 1.0e-2;
+
+	// Constant, linear and second band terms only, so the environment is exactly represented by third order spherical harmonics.
+	static std::array<float, 3> EvaluateLightingEnvironment(const float x, const float y, const float z)
+	{
+		return { 2.0f + (0.6f * x) + (0.4f * x * z) + (0.2f * ((3.0f * y * y) - 1.0f)), 2.0f + (0.5f * y) + (0.3f * ((x * x) - (z * z))),
+			1.5f + (0.4f * z) - (0.3f * y) + (0.3f * x * y) };
+	}
+
+	// Cosine convolution scales the linear terms by 2 / 3 and the second band terms by 1 / 4.
+	static std::array<float, 3> EvaluateLightingIrradiance(const float x, const float y, const float z)
+	{
+		return { 2.0f + ((2.0f / 3.0f) * 0.6f * x) + (0.25f * ((0.4f * x * z) + (0.2f * ((3.0f * y * y) - 1.0f)))),
+			2.0f + ((2.0f / 3.0f) * 0.5f * y) + (0.25f * 0.3f * ((x * x) - (z * z))),
+			1.5f + ((2.0f / 3.0f) * ((0.4f * z) - (0.3f * y))) + (0.25f * 0.3f * x * y) };
+	}
+
+	static void GetLightingTexelDirection(const uint32_t faceSize, const uint32_t face, const uint32_t x, const uint32_t y, float& outX, float& outY, float& outZ)
+	{
+		const float s = (2.0f * (static_cast<float>(x) + 0.5f) / static_cast<float>(faceSize)) - 1.0f;
+		const float t = (2.0f * (static_cast<float>(y) + 0.5f) / static_cast<float>(faceSize)) - 1.0f;
+		LeviathanAssets::EnvironmentCubemap::GetFaceDirection(face, s, t, outX, outY, outZ);
+		const float inverseLength = 1.0f / std::sqrt((outX * outX) + (outY * outY) + (outZ * outZ));
+		outX *= inverseLength;
+		outY *= inverseLength;
+		outZ *= inverseLength;
+	}
+
+	// Rgba faces of the environment at every texel's center direction.
+	static void MakeLightingEnvironmentFaces(const uint32_t faceSize, std::vector<float>& outFaces)
+	{
+		outFaces.resize(static_cast<size_t>(faceSize) * faceSize * LeviathanAssets::EnvironmentCubemap::FaceCount * LeviathanAssets::EnvironmentCubemap::ChannelCount);
+		for (uint32_t face = 0; face < LeviathanAssets::EnvironmentCubemap::FaceCount; ++face)
+		{
+			for (uint32_t y = 0; y < faceSize; ++y)
+			{
+				for (uint32_t x = 0; x < faceSize; ++x)
+				{
+					float directionX = 0.0f;
+					float directionY = 0.0f;
+					float directionZ = 0.0f;
+					GetLightingTexelDirection(faceSize, face, x, y, directionX, directionY, directionZ);
+					const std::array<float, 3> radiance = EvaluateLightingEnvironment(directionX, directionY, directionZ);
+					float* const texel = outFaces.data() + (((((static_cast<size_t>(face) * faceSize) + y) * faceSize) + x) * LeviathanAssets::EnvironmentCubemap::ChannelCount);
+					texel[0] = radiance[0];
+					texel[1] = radiance[1];
+					texel[2] = radiance[2];
+					texel[3] = 1.0f;
+				}
+			}
+		}
+	}
+
+	struct LightingBakeErrors
+	{
+		size_t IrradianceOverTolerance = 0;
+		double IrradianceMaxRelativeError = 0.0;
+		size_t MirrorTexelsOverTolerance = 0;
+		double MirrorMaxRelativeError = 0.0;
+		// Prefiltered texels outside the environment's range, which a normalized non negative filter cannot produce.
+		size_t TexelsOutsideEnvironmentRange = 0;
+		size_t AlphaErrors = 0;
+		// Lookup table texels with a negative scale or bias, or reflecting more than all light.
+		size_t BrdfOutOfRange = 0;
+	};
+
+	static LightingBakeErrors MeasureBakeErrors(const LeviathanAssets::ImageBasedLighting::BakedLighting& lighting, const std::vector<float>& sourceFaces)
+	{
+		LightingBakeErrors errors = {};
+
+		std::mt19937 random(50);
+		std::normal_distribution<float> distribution(0.0f, 1.0f);
+		for (size_t i = 0; i < LightingIrradianceDirectionCount; ++i)
+		{
+			float x = distribution(random);
+			float y = distribution(random);
+			float z = distribution(random);
+			const float inverseLength = 1.0f / std::max(std::sqrt((x * x) + (y * y) + (z * z)), 1e-6f);
+			x *= inverseLength;
+			y *= inverseLength;
+			z *= inverseLength;
+			std::array<float, 3> irradiance = {};
+			LeviathanAssets::ImageBasedLighting::EvaluateIrradiance(lighting, x, y, z, irradiance);
+			const std::array<float, 3> expected = EvaluateLightingIrradiance(x, y, z);
+			double error = 0.0;
+			for (size_t channel = 0; channel < 3; ++channel)
+			{
+				error = std::max(error, std::fabs(static_cast<double>(irradiance[channel]) - expected[channel]) / expected[channel]);
+			}
+			errors.IrradianceMaxRelativeError = std::max(errors.IrradianceMaxRelativeError, error);
+			errors.IrradianceOverTolerance += (error > LightingIrradianceTolerance) ? 1 : 0;
+		}
+
+		std::array<float, 3> minimum = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+		std::array<float, 3> maximum = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+		for (size_t i = 0; i < sourceFaces.size(); i += LeviathanAssets::EnvironmentCubemap::ChannelCount)
+		{
+			for (size_t channel = 0; channel < 3; ++channel)
+			{
+				minimum[channel] = std::min(minimum[channel], sourceFaces[i + channel]);
+				maximum[channel] = std::max(maximum[channel], sourceFaces[i + channel]);
+			}
+		}
+
+		for (uint32_t mip = 0; mip < lighting.SpecularMipCount; ++mip)
+		{
+			const uint32_t faceSize = LeviathanAssets::ImageBasedLighting::GetSpecularMipFaceSize(lighting.SpecularFaceSize, mip);
+			const float* const texels = lighting.SpecularMips.data() + LeviathanAssets::ImageBasedLighting::GetSpecularMipOffset(lighting.SpecularFaceSize, mip);
+			for (uint32_t face = 0; face < LeviathanAssets::EnvironmentCubemap::FaceCount; ++face)
+			{
+				for (uint32_t y = 0; y < faceSize; ++y)
+				{
+					for (uint32_t x = 0; x < faceSize; ++x)
+					{
+						const float* const texel = texels + (((((static_cast<size_t>(face) * faceSize) + y) * faceSize) + x) * LeviathanAssets::EnvironmentCubemap::ChannelCount);
+						for (size_t channel = 0; channel < 3; ++channel)
+						{
+							const float slack = 1e-4f * maximum[channel];
+							errors.TexelsOutsideEnvironmentRange += ((texel[channel] < minimum[channel] - slack) || (texel[channel] > maximum[channel] + slack)) ? 1 : 0;
+						}
+						errors.AlphaErrors += (texel[3] != 1.0f) ? 1 : 0;
+
+						if (mip == 0)
+						{
+							float directionX = 0.0f;
+							float directionY = 0.0f;
+							float directionZ = 0.0f;
+							GetLightingTexelDirection(faceSize, face, x, y, directionX, directionY, directionZ);
+							const std::array<float, 3> expected = EvaluateLightingEnvironment(directionX, directionY, directionZ);
+							double error = 0.0;
+							for (size_t channel = 0; channel < 3; ++channel)
+							{
+								error = std::max(error, std::fabs(static_cast<double>(texel[channel]) - expected[channel]) / expected[channel]);
+							}
+							errors.MirrorMaxRelativeError = std::max(errors.MirrorMaxRelativeError, error);
+							errors.MirrorTexelsOverTolerance += (error > LightingMirrorTolerance) ? 1 : 0;
+						}
+					}
+				}
+			}
+		}
+
+		for (size_t i = 0; i < lighting.BrdfLut.size(); i += 2)
+		{
+			const float scale = lighting.BrdfLut[i];
+			const float bias = lighting.BrdfLut[i + 1];
+			errors.BrdfOutOfRange += ((scale < 0.0f) || (bias < 0.0f) || (scale + bias > 1.0f + 1e-3f)) ? 1 : 0;
+		}
+		return errors;
+	}
+
+	// Split sum scale and bias by midpoint quadrature of the BRDF over the hemisphere, independent of importance sampling.
+	static void IntegrateBrdfReference(const double nDotV, const double roughness, double& outScale, double& outBias)
+	{
+		static constexpr uint32_t ThetaSteps = 1024;
+		static constexpr uint32_t PhiSteps = 256;
+		const double vX = std::sqrt(1.0 - (nDotV * nDotV));
+		const double alpha = roughness * roughness;
+		const double alphaSquared = alpha * alpha;
+		const double k = alpha * 0.5;
+		const double geometryV = nDotV / ((nDotV * (1.0 - k)) + k);
+		const double thetaStep = (0.5 * LightingPi) / ThetaSteps;
+		// The BRDF is symmetric about the plane of N and V, so phi only covers half the hemisphere.
+		const double phiStep = LightingPi / PhiSteps;
+		outScale = 0.0;
+		outBias = 0.0;
+		for (uint32_t i = 0; i < ThetaSteps; ++i)
+		{
+			const double theta = (static_cast<double>(i) + 0.5) * thetaStep;
+			const double nDotL = std::cos(theta);
+			const double sinTheta = std::sin(theta);
+			for (uint32_t j = 0; j < PhiSteps; ++j)
+			{
+				const double phi = (static_cast<double>(j) + 0.5) * phiStep;
+				const double lX = sinTheta * std::cos(phi);
+				const double lY = sinTheta * std::sin(phi);
+				double hX = lX + vX;
+				double hY = lY;
+				double hZ = nDotL + nDotV;
+				const double inverseLength = 1.0 / std::sqrt((hX * hX) + (hY * hY) + (hZ * hZ));
+				hX *= inverseLength;
+				hZ *= inverseLength;
+				const double vDotH = (vX * hX) + (nDotV * hZ);
+				const double denominator = (hZ * hZ * (alphaSquared - 1.0)) + 1.0;
+				const double distribution = alphaSquared / (LightingPi * denominator * denominator);
+				const double geometry = geometryV * (nDotL / ((nDotL * (1.0 - k)) + k));
+				const double fresnel = std::pow(1.0 - vDotH, 5.0);
+				const double integrand = (distribution * geometry / (4.0 * nDotV)) * sinTheta * thetaStep * phiStep * 2.0;
+				outScale += (1.0 - fresnel) * integrand;
+				outBias += fresnel * integrand;
+			}
+		}
+	}
+
+	static bool IsSameBake(const LeviathanAssets::ImageBasedLighting::BakedLighting& a, const LeviathanAssets::ImageBasedLighting::BakedLighting& b)
+	{
+		return (a.BakeSettings == b.BakeSettings) && (a.IrradianceSH == b.IrradianceSH) && (a.SpecularFaceSize == b.SpecularFaceSize) && (a.SpecularMipCount == b.SpecularMipCount) &&
+			(a.SpecularMips == b.SpecularMips) && (a.BrdfLutSize == b.BrdfLutSize) && (a.BrdfLut == b.BrdfLut);
+	}
+
+	static LeviathanAssets::ImageBasedLighting::Settings MakeLightingSettings()
+	{
+		LeviathanAssets::ImageBasedLighting::Settings settings = {};
+		settings.SpecularFaceSize = 32;
+		settings.SpecularMipCount = 5;
+		settings.SpecularSampleCount = 64;
+		settings.BrdfLutSize = 32;
+		settings.BrdfLutSampleCount = 256;
+		return settings;
+	}
+
+	static std::string MakeLightingFile(const std::string_view name)
+	{
+		return (std::filesystem::temp_directory_path() / ("LeviathanTests" + std::string(name) + ".lcube")).string();
+	}
+
+	void RunImageBasedLightingTests(Tester& tester)
+	{
+		std::vector<float> sourceFaces = {};
+		MakeLightingEnvironmentFaces(LightingSourceFaceSize, sourceFaces);
+		const LeviathanAssets::ImageBasedLighting::Settings settings = MakeLightingSettings();
+
+		// The bake matches the analytic irradiance and mirror reflection of the environment and stays within the environment's range.
+		tester.Run("ImageBasedLighting.Bake.MatchesEnvironment", [&]()
+			{
+				LeviathanAssets::ImageBasedLighting::BakedLighting lighting = {};
+				LeviathanAssets::ImageBasedLighting::BakeStats stats = {};
+				LEVIATHAN_TEST_CHECK(tester, LeviathanAssets::ImageBasedLighting::Bake(sourceFaces.data(), LightingSourceFaceSize, settings, lighting, stats));
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, lighting.SpecularMipCount, settings.SpecularMipCount);
+
+				const LightingBakeErrors errors = MeasureBakeErrors(lighting, sourceFaces);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, errors.IrradianceOverTolerance, 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, errors.MirrorTexelsOverTolerance, 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, errors.TexelsOutsideEnvironmentRange, 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, errors.AlphaErrors, 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, errors.BrdfOutOfRange, 0);
+			});
+
+		// Every prefiltered texel of a constant environment and its irradiance equal the constant.
+		tester.Run("ImageBasedLighting.Bake.ConstantEnvironment", [&]()
+			{
+				static constexpr uint32_t FaceSize = 32;
+				static constexpr std::array<float, 3> Radiance = { 1.5f, 0.75f, 3.0f };
+				std::vector<float> faces(static_cast<size_t>(FaceSize) * FaceSize * LeviathanAssets::EnvironmentCubemap::FaceCount * LeviathanAssets::EnvironmentCubemap::ChannelCount);
+				for (size_t i = 0; i < faces.size(); i += LeviathanAssets::EnvironmentCubemap::ChannelCount)
+				{
+					faces[i] = Radiance[0];
+					faces[i + 1] = Radiance[1];
+					faces[i + 2] = Radiance[2];
+					faces[i + 3] = 1.0f;
+				}
+
+				LeviathanAssets::ImageBasedLighting::Settings constantSettings = settings;
+				constantSettings.SpecularFaceSize = FaceSize;
+				LeviathanAssets::ImageBasedLighting::BakedLighting lighting = {};
+				LeviathanAssets::ImageBasedLighting::BakeStats stats = {};
+				LEVIATHAN_TEST_CHECK(tester, LeviathanAssets::ImageBasedLighting::Bake(faces.data(), FaceSize, constantSettings, lighting, stats));
+
+				size_t errors = 0;
+				for (size_t i = 0; i < lighting.SpecularMips.size(); i += LeviathanAssets::EnvironmentCubemap::ChannelCount)
+				{
+					for (size_t channel = 0; channel < 3; ++channel)
+					{
+						errors += (std::fabs(lighting.SpecularMips[i + channel] - Radiance[channel]) > 1e-5f * Radiance[channel]) ? 1 : 0;
+					}
+				}
+				for (const std::array<float, 3>& direction : { std::array<float, 3>{ 1.0f, 0.0f, 0.0f }, std::array<float, 3>{ 0.0f, -1.0f, 0.0f },
+					std::array<float, 3>{ 0.6f, 0.0f, 0.8f } })
+				{
+					std::array<float, 3> irradiance = {};
+					LeviathanAssets::ImageBasedLighting::EvaluateIrradiance(lighting, direction[0], direction[1], direction[2], irradiance);
+					for (size_t channel = 0; channel < 3; ++channel)
+					{
+						errors += (std::fabs(irradiance[channel] - Radiance[channel]) > 1e-3f * Radiance[channel]) ? 1 : 0;
+					}
+				}
+				LEVIATHAN_TEST_CHECK(tester, !lighting.SpecularMips.empty());
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, errors, 0);
+			});
+
+		// Baking on the job system matches the single thread bake exactly.
+		tester.Run("ImageBasedLighting.Bake.JobSystemMatchesSingleThread", [&]()
+			{
+				LeviathanAssets::ImageBasedLighting::BakedLighting singleThreadLighting = {};
+				LeviathanAssets::ImageBasedLighting::BakeStats stats = {};
+				LEVIATHAN_TEST_CHECK(tester, LeviathanAssets::ImageBasedLighting::Bake(sourceFaces.data(), LightingSourceFaceSize, settings, singleThreadLighting, stats));
+
+				const bool startedJobSystem = LeviathanCore::JobSystem::Initialize(JobSystemWorkerCount);
+				LeviathanAssets::ImageBasedLighting::BakedLighting lighting = {};
+				LEVIATHAN_TEST_CHECK(tester, LeviathanAssets::ImageBasedLighting::Bake(sourceFaces.data(), LightingSourceFaceSize, settings, lighting, stats));
+				if (startedJobSystem)
+				{
+					LeviathanCore::JobSystem::Shutdown();
+				}
+				LEVIATHAN_TEST_CHECK(tester, IsSameBake(lighting, singleThreadLighting));
+			});
+
+		// Lookup table texels match quadrature of the BRDF at rough enough texels for quadrature to resolve the GGX lobe, and a smooth surface viewed
+		// head on reflects F0.
+		tester.Run("ImageBasedLighting.IntegrateBrdf.MatchesQuadrature", [&]()
+			{
+				static constexpr uint32_t LutSize = 128;
+				static constexpr uint32_t SampleCount = 512;
+				size_t overTolerance = 0;
+				for (uint32_t y = 40; y < LutSize; y += 29)
+				{
+					for (uint32_t x = 12; x < LutSize; x += 23)
+					{
+						const float nDotV = (static_cast<float>(x) + 0.5f) / LutSize;
+						const float roughness = (static_cast<float>(y) + 0.5f) / LutSize;
+						float scale = 0.0f;
+						float bias = 0.0f;
+						LeviathanAssets::ImageBasedLighting::IntegrateBrdf(nDotV, roughness, SampleCount, scale, bias);
+						double expectedScale = 0.0;
+						double expectedBias = 0.0;
+						IntegrateBrdfReference((static_cast<double>(x) + 0.5) / LutSize, (static_cast<double>(y) + 0.5) / LutSize, expectedScale, expectedBias);
+						overTolerance += (std::max(std::fabs(scale - expectedScale), std::fabs(bias - expectedBias)) > LightingBrdfTolerance) ? 1 : 0;
+					}
+				}
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, overTolerance, 0);
+
+				float smoothScale = 0.0f;
+				float smoothBias = 0.0f;
+				LeviathanAssets::ImageBasedLighting::IntegrateBrdf(1.0f, 0.0f, SampleCount, smoothScale, smoothBias);
+				LEVIATHAN_TEST_CHECK_LESS_OR_EQUAL(tester, std::fabs(smoothScale - 1.0f), 1e-4f);
+				LEVIATHAN_TEST_CHECK_LESS_OR_EQUAL(tester, smoothBias, 1e-4f);
+			});
+
+		// Saved bakes load back unchanged with their settings, and truncated or foreign files are rejected.
+		tester.Run("ImageBasedLighting.File.RoundTrip", [&]()
+			{
+				LeviathanAssets::ImageBasedLighting::Settings fileSettings = settings;
+				fileSettings.SpecularSampleCount = 16;
+				fileSettings.BrdfLutSampleCount = 16;
+				LeviathanAssets::ImageBasedLighting::BakedLighting lighting = {};
+				LeviathanAssets::ImageBasedLighting::BakeStats stats = {};
+				LEVIATHAN_TEST_CHECK(tester, LeviathanAssets::ImageBasedLighting::Bake(sourceFaces.data(), LightingSourceFaceSize, fileSettings, lighting, stats));
+
+				const std::string file = MakeLightingFile("ImageBasedLighting");
+				LEVIATHAN_TEST_CHECK(tester, LeviathanAssets::ImageBasedLighting::Save(file, lighting));
+				LeviathanAssets::ImageBasedLighting::BakedLighting loadedLighting = {};
+				LEVIATHAN_TEST_CHECK(tester, LeviathanAssets::ImageBasedLighting::Load(file, loadedLighting));
+				LEVIATHAN_TEST_CHECK(tester, IsSameBake(lighting, loadedLighting));
+				LEVIATHAN_TEST_CHECK(tester, loadedLighting.BakeSettings == fileSettings);
+
+				// Environment cubemaps without baked lighting are not lighting files.
+				LeviathanAssets::EnvironmentCubemap::Header cubemapHeader = {};
+				std::vector<uint8_t> faceData = {};
+				LEVIATHAN_TEST_CHECK(tester, LeviathanAssets::EnvironmentCubemap::Load(file, cubemapHeader, faceData));
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, cubemapHeader.MipCount, lighting.SpecularMipCount);
+				LEVIATHAN_TEST_CHECK(tester, LeviathanAssets::EnvironmentCubemap::Save(file, cubemapHeader, faceData));
+				LEVIATHAN_TEST_CHECK(tester, !LeviathanAssets::ImageBasedLighting::Load(file, loadedLighting));
+				LEVIATHAN_TEST_CHECK(tester, LeviathanAssets::ImageBasedLighting::Save(file, lighting));
+
+				std::vector<uint8_t> bytes = {};
+				LEVIATHAN_TEST_CHECK(tester, LeviathanCore::Serialize::ReadFile(file, true, bytes));
+				LEVIATHAN_TEST_CHECK(tester, !bytes.empty());
+				if (!bytes.empty())
+				{
+					const std::vector<uint8_t> truncated(bytes.begin(), bytes.end() - 1);
+					LEVIATHAN_TEST_CHECK(tester, LeviathanCore::Serialize::WriteBytesToFile(file, truncated));
+					LEVIATHAN_TEST_CHECK(tester, !LeviathanAssets::ImageBasedLighting::Load(file, loadedLighting));
+
+					std::vector<uint8_t> foreign = bytes;
+					foreign[0] ^= 0xff;
+					LEVIATHAN_TEST_CHECK(tester, LeviathanCore::Serialize::WriteBytesToFile(file, foreign));
+					LEVIATHAN_TEST_CHECK(tester, !LeviathanAssets::ImageBasedLighting::Load(file, loadedLighting));
+				}
+
+				std::error_code errorCode = {};
+				std::filesystem::remove(file, errorCode);
+			});
+	}
+}
@@ -0,0 +1,229 @@
+#include "TestSuites.h"
+#include "Test.h"
+#include "TestFixtures.h"
+#include "MathTypes.h"
+#include "Camera.h"
+#include "VisibilityCulling.h"
+#include "RenderWorld.h"
+#include "InstanceBatching.h"
+#include "RenderCommands.h"
+#include "RenderStateFilter.h"
+
+namespace LeviathanTests
+{
+	namespace RenderCommands = LeviathanRenderer::RenderCommands;
+
+	static constexpr size_t CopyCount = 10000;
+	static constexpr size_t MixedRenderableCount = 20000;
+	static constexpr uint32_t MixedMeshCount = 16;
+	static constexpr uint32_t MixedMaterialCount = 64;
+	static constexpr size_t JobSystemWorkerCount = 3;
+
+	// Backend counting draws and the instances they draw.
+	struct DrawCountingBackend
+	{
+		uint64_t CallCount = 0;
+		uint64_t DrawCallCount = 0;
+		uint64_t InstanceCount = 0;
+
+		void ClearRenderTarget(RenderCommands::RenderTarget, const float*) { ++CallCount; }
+		void ClearDepthStencil(float, uint8_t) { ++CallCount; }
+		void SetRenderTarget(RenderCommands::RenderTarget) { ++CallCount; }
+		void SetPipeline(RenderCommands::Pipeline, uint32_t) { ++CallCount; }
+		void SetSkyboxPipeline(LeviathanRenderer::RendererResourceId::IdType, LeviathanRenderer::RendererResourceId::IdType) { ++CallCount; }
+		void SetBlendState(RenderCommands::BlendState) { ++CallCount; }
+		void SetDepthStencilState(RenderCommands::DepthStencilState) { ++CallCount; }
+		void SetTexture(RenderCommands::TextureSlot, LeviathanRenderer::RendererResourceId::IdType) { ++CallCount; }
+		void SetSampler(RenderCommands::TextureSlot, LeviathanRenderer::RendererResourceId::IdType) { ++CallCount; }
+
+		void UpdateConstantBuffer(RenderCommands::ConstantBuffer, const void*, uint32_t) { ++CallCount; }
+
+		void SetConstantBufferRange(RenderCommands::ConstantBuffer, uint32_t, uint32_t) { ++CallCount; }
+
+		void DrawIndexed(uint32_t, uint32_t, LeviathanRenderer::RendererResourceId::IdType, LeviathanRenderer::RendererResourceId::IdType)
+		{
+			++CallCount;
+			++DrawCallCount;
+			++InstanceCount;
+		}
+
+		void DrawIndexedInstanced(uint32_t, uint32_t, LeviathanRenderer::RendererResourceId::IdType, LeviathanRenderer::RendererResourceId::IdType,
+			const uint32_t instanceCount, uint32_t)
+		{
+			++CallCount;
+			++DrawCallCount;
+			InstanceCount += instanceCount;
+		}
+
+		void UnbindShaderResources() { ++CallCount; }
+	};
+
+	static LeviathanRenderer::RenderableDescription MakeRenderable(const uint32_t mesh, const uint32_t material, const LeviathanCore::MathTypes::Vector3& position)
+	{
+		LeviathanRenderer::RenderableDescription description = {};
+		description.Mesh.VertexBuffer = mesh;
+		description.Mesh.IndexBuffer = 1000 + mesh;
+		description.Mesh.IndexCount = 36 * mesh;
+		description.Mesh.VertexStrideBytes = 44;
+		description.Mesh.LocalBounds = LeviathanCore::BoundingVolumes::AABB{ LeviathanCore::MathTypes::Vector3(-0.5f, -0.5f, -0.5f),
+			LeviathanCore::MathTypes::Vector3(0.5f, 0.5f, 0.5f) };
+		description.Material.ColorTexture = 2000 + material;
+		description.Material.MetallicTexture = 3000 + material;
+		description.Material.RoughnessTexture = 4000 + material;
+		description.Material.NormalTexture = 5000 + (material % 4);
+		description.Material.Sampler = 1;
+		description.Transform = LeviathanCore::MathTypes::Matrix4x4::Translation(position);
+		return description;
+	}
+
+	static bool SameMeshAndMaterial(const LeviathanRenderer::RenderWorld& world, const uint32_t a, const uint32_t b)
+	{
+		const LeviathanRenderer::RenderMesh& meshA = world.GetMesh(a);
+		const LeviathanRenderer::RenderMesh& meshB = world.GetMesh(b);
+		const LeviathanRenderer::RenderMaterial& materialA = world.GetMaterial(a);
+		const LeviathanRenderer::RenderMaterial& materialB = world.GetMaterial(b);
+		return (meshA.VertexBuffer == meshB.VertexBuffer) && (meshA.IndexBuffer == meshB.IndexBuffer) && (meshA.IndexCount == meshB.IndexCount) &&
+			(meshA.VertexStrideBytes == meshB.VertexStrideBytes) && (materialA.ColorTexture == materialB.ColorTexture) &&
+			(materialA.MetallicTexture == materialB.MetallicTexture) && (materialA.RoughnessTexture == materialB.RoughnessTexture) &&
+			(materialA.NormalTexture == materialB.NormalTexture) && (materialA.Sampler == materialB.Sampler);
+	}
+
+	// Counts draws that are missing, duplicated, out of draw list order within their batch, batched with a different mesh or material or whose
+	// instance data differs from the draw list, batches out of sort key order and mesh and material combinations split over several batches.
+	static size_t CountBatchMismatches(const LeviathanRenderer::RenderWorld& world, const LeviathanRenderer::DrawList& drawList,
+		const LeviathanRenderer::InstanceBatchList& batches)
+	{
+		size_t mismatches = (batches.GetInstanceCount() > drawList.GetCount()) ? (batches.GetInstanceCount() - drawList.GetCount()) :
+			(drawList.GetCount() - batches.GetInstanceCount());
+
+		std::vector<uint8_t> drawn(drawList.GetCount(), 0);
+		std::vector<std::array<uint64_t, 9>> combinations = {};
+		for (size_t batchIndex = 0; batchIndex < batches.GetBatchCount(); ++batchIndex)
+		{
+			const LeviathanRenderer::InstanceBatch& batch = batches.Batches[batchIndex];
+			if (batchIndex > 0)
+			{
+				mismatches += (batch.SortKey < batches.Batches[batchIndex - 1].SortKey) ? 1 : 0;
+			}
+
+			for (size_t instance = batch.FirstInstance; instance < batch.FirstInstance + batch.InstanceCount; ++instance)
+			{
+				const uint32_t draw = batches.InstanceDraws[instance];
+				mismatches += (drawn[draw] != 0) ? 1 : 0;
+				drawn[draw] = 1;
+				mismatches += SameMeshAndMaterial(world, batch.Renderable, drawList.Renderables[draw]) ? 0 : 1;
+				mismatches += (memcmp(&batches.InstanceData[instance], &drawList.ObjectData[draw], sizeof(LeviathanRenderer::ConstantBufferTypes::ObjectConstantBuffer)) == 0) ? 0 : 1;
+				if (instance > batch.FirstInstance)
+				{
+					mismatches += (draw < batches.InstanceDraws[instance - 1]) ? 1 : 0;
+				}
+			}
+
+			const LeviathanRenderer::RenderMesh& mesh = world.GetMesh(batch.Renderable);
+			const LeviathanRenderer::RenderMaterial& material = world.GetMaterial(batch.Renderable);
+			combinations.push_back({ mesh.VertexBuffer, mesh.IndexBuffer, mesh.IndexCount, mesh.VertexStrideBytes, material.ColorTexture, material.MetallicTexture,
+				material.RoughnessTexture, material.NormalTexture, material.Sampler });
+		}
+
+		std::sort(combinations.begin(), combinations.end());
+		mismatches += static_cast<size_t>(combinations.end() - std::unique(combinations.begin(), combinations.end()));
+		return mismatches;
+	}
+
+	// Records the same lighting pass with one instanced draw per batch.
+	static void RecordInstancedPass(RenderCommands::CommandBuffer& commands, const LeviathanRenderer::RenderWorld& world,
+		const LeviathanRenderer::InstanceBatchList& batches)
+	{
+		commands.Reset();
+		commands.BeginPacket(0);
+		commands.SetPipeline(RenderCommands::Pipeline::PointLight);
+		for (const LeviathanRenderer::InstanceBatch& batch : batches.Batches)
+		{
+			const LeviathanRenderer::RenderMaterial& material = world.GetMaterial(batch.Renderable);
+			const LeviathanRenderer::RenderMesh& mesh = world.GetMesh(batch.Renderable);
+			commands.SetTexture(RenderCommands::TextureSlot::Color, material.ColorTexture);
+			commands.SetTexture(RenderCommands::TextureSlot::Metallic, material.MetallicTexture);
+			commands.SetTexture(RenderCommands::TextureSlot::Roughness, material.RoughnessTexture);
+			commands.SetTexture(RenderCommands::TextureSlot::Normal, material.NormalTexture);
+			commands.SetSampler(RenderCommands::TextureSlot::Color, material.Sampler);
+			commands.SetSampler(RenderCommands::TextureSlot::Metallic, material.Sampler);
+			commands.SetSampler(RenderCommands::TextureSlot::Roughness, material.Sampler);
+			commands.SetSampler(RenderCommands::TextureSlot::Normal, material.Sampler);
+			commands.DrawIndexedInstanced(mesh.IndexCount, mesh.VertexStrideBytes, mesh.VertexBuffer, mesh.IndexBuffer, batch.InstanceCount, batch.FirstInstance);
+		}
+	}
+
+	static void RunBuildTests(Tester& tester, const std::string_view sceneName, const std::string_view threadingName,
+		const LeviathanRenderer::RenderWorld& world, const LeviathanRenderer::DrawList& drawList, const size_t expectedBatchCount)
+	{
+		tester.Run("InstanceBatching.Build." + std::string(sceneName) + "." + std::string(threadingName), [&]()
+			{
+				LeviathanRenderer::InstanceBatchList batches = {};
+				// Building twice checks that the retained batch list is reset.
+				LeviathanRenderer::BuildInstanceBatches(world, drawList, batches);
+				LeviathanRenderer::BuildInstanceBatches(world, drawList, batches);
+				LEVIATHAN_TEST_CHECK(tester, drawList.GetCount() > 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, batches.GetBatchCount(), expectedBatchCount);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountBatchMismatches(world, drawList, batches), 0);
+
+				// Instanced submission must draw every draw list entry exactly once with one draw call per batch.
+				RenderCommands::CommandBuffer commands = {};
+				RecordInstancedPass(commands, world, batches);
+				DrawCountingBackend backend = {};
+				commands.Execute(backend);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, backend.DrawCallCount, batches.GetBatchCount());
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, backend.InstanceCount, drawList.GetCount());
+			});
+	}
+
+	// Number of distinct mesh and material combinations among the draw list entries.
+	static size_t CountCombinations(const LeviathanRenderer::RenderWorld& world, const LeviathanRenderer::DrawList& drawList)
+	{
+		std::vector<std::array<uint64_t, 2>> combinations(drawList.GetCount());
+		for (size_t i = 0; i < drawList.GetCount(); ++i)
+		{
+			combinations[i] = { world.GetMesh(drawList.Renderables[i]).VertexBuffer, world.GetMaterial(drawList.Renderables[i]).ColorTexture };
+		}
+		std::sort(combinations.begin(), combinations.end());
+		return static_cast<size_t>(std::unique(combinations.begin(), combinations.end()) - combinations.begin());
+	}
+
+	void RunInstanceBatchingTests(Tester& tester)
+	{
+		std::mt19937 random(97531);
+		LeviathanRenderer::Camera camera = {};
+		camera.UpdateViewMatrix();
+		camera.UpdateProjectionMatrix(1920, 1080);
+		camera.UpdateViewProjectionMatrix();
+		LeviathanRenderer::FrustumCullingStage cullingStage = {};
+
+		// Visible copies of one mesh with one material.
+		LeviathanRenderer::RenderWorld copiesWorld = {};
+		for (size_t i = 0; i < CopyCount; ++i)
+		{
+			copiesWorld.Create(MakeRenderable(1, 1, LeviathanTestFixtures::RandomVisiblePosition(random)));
+		}
+		LeviathanRenderer::DrawList copiesDrawList = {};
+		LeviathanRenderer::BuildDrawList(copiesWorld, camera, cullingStage, copiesDrawList);
+
+		// Visible renderables with 16 meshes and 64 materials.
+		std::uniform_int_distribution<uint32_t> meshDistribution(1, MixedMeshCount);
+		std::uniform_int_distribution<uint32_t> materialDistribution(1, MixedMaterialCount);
+		LeviathanRenderer::RenderWorld mixedWorld = {};
+		for (size_t i = 0; i < MixedRenderableCount; ++i)
+		{
+			const uint32_t mesh = meshDistribution(random);
+			const uint32_t material = materialDistribution(random);
+			mixedWorld.Create(MakeRenderable(mesh, material, LeviathanTestFixtures::RandomVisiblePosition(random)));
+		}
+		LeviathanRenderer::DrawList mixedDrawList = {};
+		LeviathanRenderer::BuildDrawList(mixedWorld, camera, cullingStage, mixedDrawList);
+		const size_t mixedCombinationCount = CountCombinations(mixedWorld, mixedDrawList);
+
+		LeviathanTestFixtures::RunSingleThreadAndJobSystem(JobSystemWorkerCount, [&](const std::string_view threadingName)
+			{
+				RunBuildTests(tester, "Copies", threadingName, copiesWorld, copiesDrawList, 1);
+				RunBuildTests(tester, "Mixed", threadingName, mixedWorld, mixedDrawList, mixedCombinationCount);
+			});
+	}
+}
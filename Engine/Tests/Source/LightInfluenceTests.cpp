@@ -0,0 +1,184 @@
+#include "TestSuites.h"
+#include "Test.h"
+#include "TestFixtures.h"
+#include "MathTypes.h"
+#include "BoundingVolumes.h"
+#include "Camera.h"
+#include "VisibilityCulling.h"
+#include "RenderWorld.h"
+#include "InstanceBatching.h"
+#include "LightTypes.h"
+#include "LightInfluence.h"
+
+namespace LeviathanTests
+{
+	static constexpr size_t InfluenceRenderableCount = 5000;
+	static constexpr uint32_t InfluenceMeshCount = 16;
+	static constexpr uint32_t InfluenceMaterialCount = 64;
+	static constexpr size_t InfluencePointLightCount = 256;
+	static constexpr size_t InfluenceSpotLightCount = 64;
+	static constexpr size_t JobSystemWorkerCount = 3;
+
+	struct LightInfluenceScene
+	{
+		LeviathanRenderer::RenderWorld World = {};
+		LeviathanRenderer::DrawList DrawList = {};
+		LeviathanRenderer::InstanceBatchList Batches = {};
+		std::vector<LeviathanRenderer::LightTypes::PointLight> PointLights = {};
+		std::vector<LeviathanRenderer::LightTypes::SpotLight> SpotLights = {};
+	};
+
+	// Unit cubes of mixed meshes and materials and point and spot lights spread over the view frustum. Light radii of 10 to 60 units are limited
+	// further by the brightness cutoff of dim lights.
+	static void MakeLightInfluenceScene(LightInfluenceScene& scene)
+	{
+		std::mt19937 random(4321);
+		std::uniform_int_distribution<uint32_t> meshDistribution(1, InfluenceMeshCount);
+		std::uniform_int_distribution<uint32_t> materialDistribution(1, InfluenceMaterialCount);
+		for (size_t i = 0; i < InfluenceRenderableCount; ++i)
+		{
+			LeviathanRenderer::RenderableDescription description = {};
+			const uint32_t mesh = meshDistribution(random);
+			const uint32_t material = materialDistribution(random);
+			description.Mesh.VertexBuffer = mesh;
+			description.Mesh.IndexBuffer = 1000 + mesh;
+			description.Mesh.IndexCount = 36 * mesh;
+			description.Mesh.VertexStrideBytes = 44;
+			description.Mesh.LocalBounds = LeviathanCore::BoundingVolumes::AABB{ LeviathanCore::MathTypes::Vector3(-0.5f, -0.5f, -0.5f),
+				LeviathanCore::MathTypes::Vector3(0.5f, 0.5f, 0.5f) };
+			description.Material.ColorTexture = 2000 + material;
+			description.Material.MetallicTexture = 3000 + material;
+			description.Material.RoughnessTexture = 4000 + material;
+			description.Material.NormalTexture = 5000 + material;
+			description.Material.Sampler = 1;
+			description.Transform = LeviathanCore::MathTypes::Matrix4x4::Translation(LeviathanTestFixtures::RandomVisiblePosition(random));
+			scene.World.Create(description);
+		}
+
+		LeviathanRenderer::Camera camera = {};
+		camera.UpdateViewMatrix();
+		camera.UpdateProjectionMatrix(1920, 1080);
+		camera.UpdateViewProjectionMatrix();
+		LeviathanRenderer::FrustumCullingStage cullingStage = {};
+		LeviathanRenderer::BuildDrawList(scene.World, camera, cullingStage, scene.DrawList);
+		LeviathanRenderer::BuildInstanceBatches(scene.World, scene.DrawList, scene.Batches);
+
+		std::uniform_real_distribution<float> radiusDistribution(10.0f, 60.0f);
+		std::uniform_real_distribution<float> brightnessDistribution(1.0f, 50.0f);
+		std::uniform_real_distribution<float> unitDistribution(-1.0f, 1.0f);
+		std::uniform_real_distribution<float> coneAngleDistribution(LeviathanCore::MathLibrary::DegreesToRadians(10.0f), LeviathanCore::MathLibrary::DegreesToRadians(60.0f));
+
+		scene.PointLights.resize(InfluencePointLightCount);
+		for (LeviathanRenderer::LightTypes::PointLight& light : scene.PointLights)
+		{
+			light.Position = LeviathanTestFixtures::RandomVisiblePosition(random);
+			light.Brightness = brightnessDistribution(random);
+			light.Radius = radiusDistribution(random);
+		}
+
+		scene.SpotLights.resize(InfluenceSpotLightCount);
+		for (LeviathanRenderer::LightTypes::SpotLight& light : scene.SpotLights)
+		{
+			light.Position = LeviathanTestFixtures::RandomVisiblePosition(random);
+			light.Direction = LeviathanCore::MathTypes::Vector3(unitDistribution(random), unitDistribution(random), unitDistribution(random)).AsNormalizedSafe();
+			light.OuterConeAngleRadians = coneAngleDistribution(random);
+			light.Brightness = brightnessDistribution(random);
+			light.Radius = radiusDistribution(random);
+		}
+	}
+
+	// Returns whether the scalar bounding volume tests find the object inside the light's influence volume.
+	static bool IsLitScalar(const LightInfluenceScene& scene, const size_t light, const LeviathanCore::BoundingVolumes::AABB& bounds)
+	{
+		if (light < scene.PointLights.size())
+		{
+			return LeviathanRenderer::GetInfluenceSphere(scene.PointLights[light]).Intersects(bounds);
+		}
+		return LeviathanRenderer::GetInfluenceCone(scene.SpotLights[light - scene.PointLights.size()]).Intersects(bounds);
+	}
+
+	// Returns the number of light object list entries and light batch list entries that differ from testing every light against every object with the
+	// scalar tests. Lists out of ascending order also count as mismatches.
+	static size_t CountInfluenceMismatches(const LightInfluenceScene& scene, const LeviathanRenderer::LightInfluenceCulling& culling)
+	{
+		const size_t lightCount = scene.PointLights.size() + scene.SpotLights.size();
+		const LeviathanCore::BoundingVolumes::AABBSoA worldBounds = scene.World.GetWorldBounds();
+		size_t mismatches = 0;
+
+		std::vector<std::vector<uint8_t>> listed(lightCount, std::vector<uint8_t>(scene.DrawList.GetCount(), 0));
+		for (size_t light = 0; light < lightCount; ++light)
+		{
+			const uint32_t* const draws = culling.GetLightObjects(light);
+			for (size_t i = 0; i < culling.GetLightObjectCount(light); ++i)
+			{
+				listed[light][draws[i]] = 1;
+				mismatches += ((i > 0) && (draws[i - 1] >= draws[i])) ? 1 : 0;
+			}
+		}
+
+		std::vector<std::vector<uint8_t>> litBatches(lightCount, std::vector<uint8_t>(scene.Batches.GetBatchCount(), 0));
+		for (size_t draw = 0; draw < scene.DrawList.GetCount(); ++draw)
+		{
+			const uint32_t renderable = scene.DrawList.Renderables[draw];
+			const LeviathanCore::BoundingVolumes::AABB bounds{
+				LeviathanCore::MathTypes::Vector3(worldBounds.MinX[renderable], worldBounds.MinY[renderable], worldBounds.MinZ[renderable]),
+				LeviathanCore::MathTypes::Vector3(worldBounds.MaxX[renderable], worldBounds.MaxY[renderable], worldBounds.MaxZ[renderable]) };
+
+			for (size_t light = 0; light < lightCount; ++light)
+			{
+				const bool lit = IsLitScalar(scene, light, bounds);
+				mismatches += ((listed[light][draw] != 0) != lit) ? 1 : 0;
+				if (lit)
+				{
+					litBatches[light][scene.Batches.ScratchDrawBatches[draw]] = 1;
+				}
+			}
+		}
+
+		for (size_t light = 0; light < lightCount; ++light)
+		{
+			std::vector<uint8_t> listedBatches(scene.Batches.GetBatchCount(), 0);
+			const uint32_t* const batches = culling.GetLightBatches(light);
+			for (size_t i = 0; i < culling.GetLightBatchCount(light); ++i)
+			{
+				listedBatches[batches[i]] = 1;
+				mismatches += ((i > 0) && (batches[i - 1] >= batches[i])) ? 1 : 0;
+			}
+			for (size_t batch = 0; batch < scene.Batches.GetBatchCount(); ++batch)
+			{
+				mismatches += (listedBatches[batch] != litBatches[light][batch]) ? 1 : 0;
+			}
+		}
+		return mismatches;
+	}
+
+	static void RunInfluenceBuildTests(Tester& tester, const std::string_view threadingName, const LightInfluenceScene& scene)
+	{
+		tester.Run("LightInfluence.Build." + std::string(threadingName), [&]()
+			{
+				LeviathanRenderer::LightInfluenceCulling culling = {};
+				// Building twice checks that retained lists are reset.
+				culling.Build(scene.World, scene.DrawList, scene.Batches, scene.PointLights.data(), scene.PointLights.size(), scene.SpotLights.data(),
+					scene.SpotLights.size());
+				culling.Build(scene.World, scene.DrawList, scene.Batches, scene.PointLights.data(), scene.PointLights.size(), scene.SpotLights.data(),
+					scene.SpotLights.size());
+
+				const LeviathanRenderer::LightInfluenceStats& stats = culling.GetStats();
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, stats.TestedPairs, scene.DrawList.GetCount() * (scene.PointLights.size() + scene.SpotLights.size()));
+				LEVIATHAN_TEST_CHECK(tester, stats.CulledPairs > 0);
+				LEVIATHAN_TEST_CHECK(tester, stats.SkippedDraws > 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountInfluenceMismatches(scene, culling), 0);
+			});
+	}
+
+	void RunLightInfluenceTests(Tester& tester)
+	{
+		LightInfluenceScene scene = {};
+		MakeLightInfluenceScene(scene);
+
+		LeviathanTestFixtures::RunSingleThreadAndJobSystem(JobSystemWorkerCount, [&](const std::string_view threadingName)
+			{
+				RunInfluenceBuildTests(tester, threadingName, scene);
+			});
+	}
+}
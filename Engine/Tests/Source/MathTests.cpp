@@ -0,0 +1,173 @@
+#include "TestSuites.h"
+#include "Test.h"
+#include "MathLibrary.h"
+#include "FastMath.h"
+
+namespace LeviathanTests
+{
+	static constexpr size_t AccuracySweepCount = 1 << 20;
+
+	// Returns the distance between a and b in units in the last place.
+	static double UlpDistance(const float a, const float b)
+	{
+		const auto ordered = [](const float value)
+			{
+				const int32_t bits = std::bit_cast<int32_t>(value);
+				return (bits < 0) ? static_cast<int64_t>(std::numeric_limits<int32_t>::min()) - bits : static_cast<int64_t>(bits);
+			};
+
+		const int64_t difference = ordered(a) - ordered(b);
+		return static_cast<double>((difference < 0) ? -difference : difference);
+	}
+
+	// Fills the array with count values evenly spaced between min and max.
+	static std::vector<float> MakeSweep(const float min, const float max, const size_t count)
+	{
+		std::vector<float> values(count, 0.0f);
+		for (size_t i = 0; i < count; ++i)
+		{
+			values[i] = min + (max - min) * (static_cast<float>(i) / static_cast<float>(count));
+		}
+		return values;
+	}
+
+	// Fills the array with count positive normal floats evenly spaced in bit pattern so that every exponent is covered.
+	static std::vector<float> MakePositiveNormalSweep(const size_t count)
+	{
+		static constexpr uint32_t MinNormalBits = 0x00800000u;
+		static constexpr uint32_t MaxNormalBits = 0x7f7fffffu;
+
+		std::vector<float> values(count, 0.0f);
+		for (size_t i = 0; i < count; ++i)
+		{
+			values[i] = std::bit_cast<float>(static_cast<uint32_t>(MinNormalBits + (static_cast<uint64_t>(MaxNormalBits - MinNormalBits) * i) / count));
+		}
+		return values;
+	}
+
+	// Returns the max ULP error of the approximation against the double precision reference over the inputs.
+	template <typename Approximation, typename Reference>
+	static double MaxUlpError(const std::vector<float>& inputs, Approximation&& approximation, Reference&& reference)
+	{
+		double maxUlp = 0.0;
+		for (const float input : inputs)
+		{
+			maxUlp = std::max(maxUlp, UlpDistance(approximation(input), static_cast<float>(reference(static_cast<double>(input)))));
+		}
+		return maxUlp;
+	}
+
+	// Returns the number of lanes where the array variant output differs from the scalar variant.
+	template <typename Scalar, typename Array>
+	static size_t CountArrayMismatches(const std::vector<float>& inputs, Scalar&& scalar, Array&& array)
+	{
+		std::vector<float> outputs(inputs.size(), 0.0f);
+		array(inputs.data(), outputs.data(), inputs.size());
+
+		size_t mismatches = 0;
+		for (size_t i = 0; i < inputs.size(); ++i)
+		{
+			mismatches += (outputs[i] != scalar(inputs[i])) ? 1 : 0;
+		}
+		return mismatches;
+	}
+
+	// Checks the scalar variant against the documented max ULP error and the array variant against the scalar variant.
+	template <typename ScalarFunction, typename ArrayFunction, typename ReferenceFunction>
+	static void TestUnaryFunction(Tester& tester, const std::string& name, const std::vector<float>& inputs, const double maxUlp, ScalarFunction&& scalar,
+		ArrayFunction&& array, ReferenceFunction&& reference)
+	{
+		tester.Run("FastMath." + name + ".MaxUlpVsLibm", [&]()
+			{
+				LEVIATHAN_TEST_CHECK_LESS_OR_EQUAL(tester, MaxUlpError(inputs, scalar, reference), maxUlp);
+			});
+
+		tester.Run("FastMath." + name + ".ArrayMatchesScalar", [&]()
+			{
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountArrayMismatches(inputs, scalar, array), 0);
+			});
+	}
+
+	void RunMathTests(Tester& tester)
+	{
+		using namespace LeviathanCore;
+
+		const std::vector<float> angleSweep = MakeSweep(-MathLibrary::Pi, MathLibrary::Pi, AccuracySweepCount);
+		const std::vector<float> positiveSweep = MakePositiveNormalSweep(AccuracySweepCount);
+
+		TestUnaryFunction(tester, "Sin", angleSweep, 2.0,
+			[](const float x) { return FastMath::Sin(x); },
+			[](const float* x, float* out, const size_t count) { FastMath::Sin(x, out, count); },
+			[](const double x) { return std::sin(x); });
+
+		TestUnaryFunction(tester, "Cos", angleSweep, 2.0,
+			[](const float x) { return FastMath::Cos(x); },
+			[](const float* x, float* out, const size_t count) { FastMath::Cos(x, out, count); },
+			[](const double x) { return std::cos(x); });
+
+		TestUnaryFunction(tester, "Exp", MakeSweep(-87.0f, 88.0f, AccuracySweepCount), 1.0,
+			[](const float x) { return FastMath::Exp(x); },
+			[](const float* x, float* out, const size_t count) { FastMath::Exp(x, out, count); },
+			[](const double x) { return std::exp(x); });
+
+		TestUnaryFunction(tester, "Log", positiveSweep, 1.0,
+			[](const float x) { return FastMath::Log(x); },
+			[](const float* x, float* out, const size_t count) { FastMath::Log(x, out, count); },
+			[](const double x) { return std::log(x); });
+
+		TestUnaryFunction(tester, "RSqrt", positiveSweep, 4.0,
+			[](const float x) { return FastMath::RSqrt(x); },
+			[](const float* x, float* out, const size_t count) { FastMath::RSqrt(x, out, count); },
+			[](const double x) { return 1.0 / std::sqrt(x); });
+
+		tester.Run("FastMath.SinCos.ArrayMatchesScalar", [&]()
+			{
+				std::vector<float> sinOutputs(angleSweep.size(), 0.0f);
+				std::vector<float> cosOutputs(angleSweep.size(), 0.0f);
+				FastMath::SinCos(angleSweep.data(), sinOutputs.data(), cosOutputs.data(), angleSweep.size());
+
+				size_t mismatches = 0;
+				for (size_t i = 0; i < angleSweep.size(); ++i)
+				{
+					mismatches += ((sinOutputs[i] != FastMath::Sin(angleSweep[i])) || (cosOutputs[i] != FastMath::Cos(angleSweep[i]))) ? 1 : 0;
+				}
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, mismatches, 0);
+			});
+
+		// ATan2 sweeps points on circles of varying radius so that every octant and quadrant is covered.
+		std::vector<float> atanY(AccuracySweepCount, 0.0f);
+		std::vector<float> atanX(AccuracySweepCount, 0.0f);
+		for (size_t i = 0; i < AccuracySweepCount; ++i)
+		{
+			const double angle = MathLibrary::TwoPi * static_cast<double>(i) / static_cast<double>(AccuracySweepCount);
+			const double radius = 0.01 + static_cast<double>(i % 97) * 0.37;
+			atanY[i] = static_cast<float>(radius * std::sin(angle));
+			atanX[i] = static_cast<float>(radius * std::cos(angle));
+		}
+
+		tester.Run("FastMath.ATan2.MaxUlpVsLibm", [&]()
+			{
+				double maxUlp = 0.0;
+				for (size_t i = 0; i < AccuracySweepCount; ++i)
+				{
+					const float reference = static_cast<float>(std::atan2(static_cast<double>(atanY[i]), static_cast<double>(atanX[i])));
+					maxUlp = std::max(maxUlp, UlpDistance(FastMath::ATan2(atanY[i], atanX[i]), reference));
+				}
+				LEVIATHAN_TEST_CHECK_LESS_OR_EQUAL(tester, maxUlp, 3.0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, FastMath::ATan2(0.0f, 0.0f), 0.0f);
+			});
+
+		tester.Run("FastMath.ATan2.ArrayMatchesScalar", [&]()
+			{
+				std::vector<float> outputs(AccuracySweepCount, 0.0f);
+				FastMath::ATan2(atanY.data(), atanX.data(), outputs.data(), AccuracySweepCount);
+
+				size_t mismatches = 0;
+				for (size_t i = 0; i < AccuracySweepCount; ++i)
+				{
+					mismatches += (outputs[i] != FastMath::ATan2(atanY[i], atanX[i])) ? 1 : 0;
+				}
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, mismatches, 0);
+			});
+	}
+}
@@ -0,0 +1,279 @@
+#include "TestSuites.h"
+#include "Test.h"
+#include "MathTypes.h"
+#include "BoundingVolumes.h"
+#include "AssetTypes.h"
+#include "MeshSimplification.h"
+#include "TriangleBVH.h"
+#include "Camera.h"
+#include "LevelOfDetail.h"
+
+namespace LeviathanTests
+{
+	// 2 * 128 * (64 - 1) = 16128 triangles.
+	static constexpr size_t SimplificationSectors = 128;
+	static constexpr size_t SimplificationStacks = 64;
+	static constexpr float SimplificationRadius = 10.0f;
+	static constexpr size_t LODObjectCount = 5000;
+	static constexpr float LODObjectScale = 0.05f;
+	static constexpr float LODViewportHeight = 1080.0f;
+	static constexpr float LODMaxPixelError = 1.0f;
+	// Largest distance between the source and the simplified surface. The bumps rise up to 0.7 units above the sphere.
+	static constexpr double MaxSimplificationDeviation = 0.5;
+
+	// Radius of the bumpy sphere. The bumps vanish at the poles so that the pole vertices meet.
+	static float SimplificationSurfaceRadius(const float theta, const float phi)
+	{
+		return SimplificationRadius + (0.5f * std::sin(8.0f * theta) * std::cos(6.0f * phi)) + (0.2f * std::sin(14.0f * theta) * std::sin(11.0f * phi));
+	}
+
+	// Closed bumpy uv sphere with smooth normals, texture coordinates and tangents. The first and last sector columns share positions but not texture
+	// coordinates, forming a seam, and every pole is a ring of vertices at one position.
+	static LeviathanAssets::AssetTypes::Mesh CreateSimplificationSphere()
+	{
+		constexpr size_t columns = SimplificationSectors + 1;
+		LeviathanAssets::AssetTypes::Mesh mesh = {};
+		for (size_t stack = 0; stack <= SimplificationStacks; ++stack)
+		{
+			const float theta = 3.14159265f * static_cast<float>(stack) / static_cast<float>(SimplificationStacks);
+			for (size_t sector = 0; sector <= SimplificationSectors; ++sector)
+			{
+				// The seam column repeats the angle of the first column so that its positions are bitwise equal.
+				const float phi = 6.28318531f * static_cast<float>(sector % SimplificationSectors) / static_cast<float>(SimplificationSectors);
+				const float radius = SimplificationSurfaceRadius(theta, phi);
+				if ((stack == 0) || (stack == SimplificationStacks))
+				{
+					mesh.Positions.emplace_back(0.0f, (stack == 0) ? SimplificationRadius : -SimplificationRadius, 0.0f);
+				}
+				else
+				{
+					mesh.Positions.emplace_back(radius * std::sin(theta) * std::cos(phi), radius * std::cos(theta), radius * std::sin(theta) * std::sin(phi));
+				}
+				mesh.TextureCoordinates.emplace_back(static_cast<float>(sector) / static_cast<float>(SimplificationSectors),
+					static_cast<float>(stack) / static_cast<float>(SimplificationStacks));
+				mesh.Tangents.emplace_back(-std::sin(phi), 0.0f, std::cos(phi));
+			}
+		}
+
+		for (size_t stack = 0; stack < SimplificationStacks; ++stack)
+		{
+			for (size_t sector = 0; sector < SimplificationSectors; ++sector)
+			{
+				const uint32_t a = static_cast<uint32_t>((stack * columns) + sector);
+				const uint32_t b = a + static_cast<uint32_t>(columns);
+				// The first and last stacks have one triangle per sector.
+				if (stack != 0)
+				{
+					mesh.Indices.insert(mesh.Indices.end(), { a, b, a + 1 });
+				}
+				if (stack != SimplificationStacks - 1)
+				{
+					mesh.Indices.insert(mesh.Indices.end(), { a + 1, b, b + 1 });
+				}
+			}
+		}
+
+		// Smooth normals accumulated per position so that both sides of the seam and every vertex of a pole agree.
+		const auto positionGroup = [](const size_t vertex) -> size_t
+			{
+				const size_t stack = vertex / columns;
+				if (stack == 0)
+				{
+					return 0;
+				}
+				if (stack == SimplificationStacks)
+				{
+					return 1;
+				}
+				return 2 + ((stack - 1) * SimplificationSectors) + ((vertex % columns) % SimplificationSectors);
+			};
+		std::vector<LeviathanCore::MathTypes::Vector3> groupNormals(2 + ((SimplificationStacks - 1) * SimplificationSectors), LeviathanCore::MathTypes::Vector3(0.0f, 0.0f, 0.0f));
+		for (size_t i = 0; i < mesh.Indices.size(); i += 3)
+		{
+			const LeviathanCore::MathTypes::Vector3& p0 = mesh.Positions[mesh.Indices[i]];
+			const LeviathanCore::MathTypes::Vector3 faceNormal = LeviathanCore::MathTypes::Vector3::CrossProduct(mesh.Positions[mesh.Indices[i + 1]] - p0,
+				mesh.Positions[mesh.Indices[i + 2]] - p0);
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				LeviathanCore::MathTypes::Vector3& normal = groupNormals[positionGroup(mesh.Indices[i + corner])];
+				normal = normal + faceNormal;
+			}
+		}
+		for (size_t vertex = 0; vertex < mesh.Positions.size(); ++vertex)
+		{
+			mesh.Normals.push_back(groupNormals[positionGroup(vertex)].AsNormalizedSafe());
+		}
+
+		mesh.CalculateBounds();
+		return mesh;
+	}
+
+	// Returns the number of edges without an opposite edge after welding vertices with equal positions. Cracks along seams show up as open edges.
+	static size_t CountOpenEdges(const LeviathanAssets::AssetTypes::Mesh& mesh)
+	{
+		std::vector<uint32_t> order(mesh.Positions.size());
+		std::iota(order.begin(), order.end(), 0);
+		const auto key = [&mesh](const uint32_t vertex)
+			{
+				const LeviathanCore::MathTypes::Vector3& position = mesh.Positions[vertex];
+				return std::array<float, 3>{ position.X(), position.Y(), position.Z() };
+			};
+		std::sort(order.begin(), order.end(), [&key](const uint32_t a, const uint32_t b) { return key(a) < key(b); });
+
+		std::vector<uint32_t> weld(mesh.Positions.size());
+		for (size_t i = 0; i < order.size(); ++i)
+		{
+			weld[order[i]] = ((i > 0) && (key(order[i]) == key(order[i - 1]))) ? weld[order[i - 1]] : static_cast<uint32_t>(i);
+		}
+
+		std::vector<uint64_t> edges = {};
+		for (size_t i = 0; i < mesh.Indices.size(); i += 3)
+		{
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				const uint64_t from = weld[mesh.Indices[i + corner]];
+				const uint64_t to = weld[mesh.Indices[i + ((corner + 1) % 3)]];
+				edges.push_back((from << 32) | to);
+			}
+		}
+		std::sort(edges.begin(), edges.end());
+
+		size_t openEdges = 0;
+		for (const uint64_t edge : edges)
+		{
+			const uint64_t opposite = (edge << 32) | (edge >> 32);
+			openEdges += std::binary_search(edges.begin(), edges.end(), opposite) ? 0 : 1;
+		}
+		return openEdges;
+	}
+
+	// Returns the largest distance between the source and the simplified surface along the rays from the sphere's center through the center of every
+	// source triangle, and the number of rays missing the simplified surface, e.g. by passing exactly between two of its triangles.
+	static double MeasureMaxDeviation(const LeviathanAssets::AssetTypes::Mesh& source, const LeviathanAssets::AssetTypes::Mesh& simplified, size_t& outMissedRays)
+	{
+		outMissedRays = 0;
+		LeviathanAssets::TriangleBVH bvh = {};
+		if (!bvh.Build(simplified))
+		{
+			outMissedRays = source.Indices.size() / 3;
+			return 0.0;
+		}
+
+		double maxDeviation = 0.0;
+		for (size_t i = 0; i < source.Indices.size(); i += 3)
+		{
+			const LeviathanCore::MathTypes::Vector3 center = (source.Positions[source.Indices[i]] + source.Positions[source.Indices[i + 1]] +
+				source.Positions[source.Indices[i + 2]]) * (1.0f / 3.0f);
+			const LeviathanCore::BoundingVolumes::Ray ray{ LeviathanCore::MathTypes::Vector3(0.0f, 0.0f, 0.0f), center.AsNormalizedSafe() };
+			LeviathanAssets::TriangleBVH::Hit hit = {};
+			if (!bvh.Intersect(ray, 4.0f * SimplificationRadius, hit))
+			{
+				++outMissedRays;
+				continue;
+			}
+			maxDeviation = std::max(maxDeviation, std::abs(static_cast<double>(hit.Distance) - static_cast<double>(center.Length())));
+		}
+		return maxDeviation;
+	}
+
+	static std::vector<LeviathanCore::BoundingVolumes::Sphere> CreateLODObjectBounds(const LeviathanAssets::AssetTypes::Mesh& mesh)
+	{
+		std::mt19937 random(2468);
+		std::uniform_real_distribution<float> depthDistribution(2.0f, 400.0f);
+		std::uniform_real_distribution<float> offsetDistribution(-0.3f, 0.3f);
+		std::vector<LeviathanCore::BoundingVolumes::Sphere> bounds(LODObjectCount);
+		for (LeviathanCore::BoundingVolumes::Sphere& sphere : bounds)
+		{
+			const float z = depthDistribution(random);
+			sphere.Center = LeviathanCore::MathTypes::Vector3(offsetDistribution(random) * z, offsetDistribution(random) * z, z);
+			sphere.Radius = mesh.BoundingSphere.Radius * LODObjectScale;
+		}
+		return bounds;
+	}
+
+	void RunMeshSimplificationTests(Tester& tester)
+	{
+		const LeviathanAssets::AssetTypes::Mesh mesh = CreateSimplificationSphere();
+		const size_t sourceTriangles = mesh.Indices.size() / 3;
+
+		tester.Run("MeshSimplification.SourceIsClosed", [&]()
+			{
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountOpenEdges(mesh), 0);
+			});
+
+		tester.Run("MeshSimplification.Simplify", [&]()
+			{
+				const size_t targetTriangles = sourceTriangles / 4;
+				LeviathanAssets::AssetTypes::Mesh simplified = {};
+				float error = 0.0f;
+				LEVIATHAN_TEST_CHECK(tester, LeviathanAssets::MeshSimplification::Simplify(mesh, targetTriangles, std::numeric_limits<float>::max(),
+					LeviathanAssets::MeshSimplification::Settings{}, simplified, error));
+				LEVIATHAN_TEST_CHECK_LESS_OR_EQUAL(tester, simplified.Indices.size() / 3, targetTriangles);
+				LEVIATHAN_TEST_CHECK(tester, error > 0.0f);
+				// The seam must not open into cracks.
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountOpenEdges(simplified), 0);
+
+				size_t missedRays = 0;
+				const double maxDeviation = MeasureMaxDeviation(mesh, simplified, missedRays);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, missedRays, 0);
+				LEVIATHAN_TEST_CHECK_LESS_OR_EQUAL(tester, maxDeviation, MaxSimplificationDeviation);
+			});
+
+		LeviathanAssets::MeshSimplification::LODChain chain = {};
+		tester.Run("MeshSimplification.BuildLODChain", [&]()
+			{
+				LEVIATHAN_TEST_CHECK(tester, LeviathanAssets::MeshSimplification::BuildLODChain(mesh, LeviathanAssets::MeshSimplification::LODChainSettings{}, chain));
+				LEVIATHAN_TEST_CHECK(tester, chain.Levels.size() > 1);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, chain.Errors.size(), chain.Levels.size());
+				for (size_t level = 1; level < chain.Levels.size(); ++level)
+				{
+					LEVIATHAN_TEST_CHECK(tester, chain.Levels[level].Indices.size() < chain.Levels[level - 1].Indices.size());
+					LEVIATHAN_TEST_CHECK(tester, chain.Errors[level] >= chain.Errors[level - 1]);
+					LEVIATHAN_TEST_CHECK_EQUAL(tester, CountOpenEdges(chain.Levels[level]), 0);
+				}
+			});
+
+		// A ratio of 1 would repeat the source mesh at every level.
+		tester.Run("MeshSimplification.BuildLODChain.InvalidTriangleRatio", [&]()
+			{
+				LeviathanAssets::MeshSimplification::LODChainSettings settings = {};
+				settings.TriangleRatio = 1.0f;
+				LeviathanAssets::MeshSimplification::LODChain invalidChain = {};
+				LEVIATHAN_TEST_CHECK(tester, !LeviathanAssets::MeshSimplification::BuildLODChain(mesh, settings, invalidChain));
+				LEVIATHAN_TEST_CHECK(tester, invalidChain.Levels.empty());
+			});
+
+		// Copies of the mesh scaled to a world radius of 0.5 spread over the view of a camera at the origin looking down +z.
+		tester.Run("MeshSimplification.SelectLevelOfDetail", [&]()
+			{
+				LEVIATHAN_TEST_CHECK(tester, chain.Levels.size() > 1);
+				if (chain.Levels.empty())
+				{
+					return;
+				}
+
+				const std::vector<LeviathanCore::BoundingVolumes::Sphere> bounds = CreateLODObjectBounds(mesh);
+				LeviathanRenderer::Camera camera = {};
+				camera.UpdateViewMatrix();
+				camera.UpdateProjectionMatrix(1920, 1080);
+				camera.UpdateViewProjectionMatrix();
+
+				const uint32_t levelCount = static_cast<uint32_t>(chain.Levels.size());
+				size_t violations = 0;
+				size_t reducedObjects = 0;
+				for (size_t i = 0; i < LODObjectCount; ++i)
+				{
+					const uint32_t level = LeviathanRenderer::SelectLevelOfDetail(camera, bounds[i], LODObjectScale, chain.Errors.data(), levelCount,
+						LODViewportHeight, LODMaxPixelError);
+					LEVIATHAN_TEST_CHECK(tester, level < levelCount);
+					reducedObjects += (level > 0) ? 1 : 0;
+
+					// The selected level's error must stay within the pixel budget.
+					const float errorPixels = LeviathanRenderer::GetProjectedSize(camera, bounds[i], chain.Errors[level] * LODObjectScale, LODViewportHeight);
+					violations += (errorPixels > LODMaxPixelError) ? 1 : 0;
+				}
+				LEVIATHAN_TEST_CHECK(tester, reducedObjects > 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, violations, 0);
+			});
+	}
+}
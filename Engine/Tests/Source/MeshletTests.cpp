@@ -0,0 +1,240 @@
+#include "TestSuites.h"
+#include "Test.h"
+#include "TestFixtures.h"
+#include "MathTypes.h"
+#include "BoundingVolumes.h"
+#include "AssetTypes.h"
+#include "Meshlets.h"
+#include "Camera.h"
+#include "ClusterCulling.h"
+
+namespace LeviathanTests
+{
+	// 2 * 512 * 256 = 262144 triangles, enough meshlets for cluster culling to run on the job system.
+	static constexpr size_t TorusMajorSegments = 512;
+	static constexpr size_t TorusMinorSegments = 256;
+	static constexpr float TorusMajorRadius = 10.0f;
+	static constexpr float TorusMinorRadius = 3.0f;
+	static constexpr size_t JobSystemWorkerCount = 3;
+
+	// Closed bumpy torus around the y axis with triangles facing outwards.
+	static LeviathanAssets::AssetTypes::Mesh CreateMeshletTorus()
+	{
+		LeviathanAssets::AssetTypes::Mesh mesh = {};
+		mesh.Positions.reserve(TorusMajorSegments * TorusMinorSegments);
+		for (size_t major = 0; major < TorusMajorSegments; ++major)
+		{
+			const float u = 6.28318531f * static_cast<float>(major) / static_cast<float>(TorusMajorSegments);
+			for (size_t minor = 0; minor < TorusMinorSegments; ++minor)
+			{
+				const float v = 6.28318531f * static_cast<float>(minor) / static_cast<float>(TorusMinorSegments);
+				const float radius = TorusMinorRadius + (0.3f * std::sin(13.0f * u) * std::cos(7.0f * v)) + (0.1f * std::sin(41.0f * u + 3.0f * v));
+				const float ring = TorusMajorRadius + (radius * std::cos(v));
+				mesh.Positions.emplace_back(ring * std::cos(u), radius * std::sin(v), ring * std::sin(u));
+			}
+		}
+
+		const auto vertex = [](const size_t major, const size_t minor)
+			{
+				return static_cast<uint32_t>(((major % TorusMajorSegments) * TorusMinorSegments) + (minor % TorusMinorSegments));
+			};
+		mesh.Indices.reserve(TorusMajorSegments * TorusMinorSegments * 6);
+		for (size_t major = 0; major < TorusMajorSegments; ++major)
+		{
+			for (size_t minor = 0; minor < TorusMinorSegments; ++minor)
+			{
+				const uint32_t a = vertex(major, minor);
+				const uint32_t b = vertex(major, minor + 1);
+				const uint32_t c = vertex(major + 1, minor);
+				const uint32_t d = vertex(major + 1, minor + 1);
+				mesh.Indices.insert(mesh.Indices.end(), { a, b, c, b, d, c });
+			}
+		}
+
+		mesh.CalculateBounds();
+		return mesh;
+	}
+
+	// Returns the number of source triangles not found exactly once in the meshlets' index buffer, and of meshlet triangles whose local indices do not
+	// resolve to the same vertices as the index buffer or whose meshlet exceeds the limits.
+	static size_t CountMeshletLayoutErrors(const LeviathanAssets::AssetTypes::Mesh& mesh, const LeviathanAssets::Meshlets::MeshletMesh& meshlets,
+		const LeviathanAssets::Meshlets::Settings& settings)
+	{
+		// Triangles rotated to start at their smallest index keep their winding and compare equal regardless of their first corner.
+		const auto canonicalTriangles = [](const std::vector<uint32_t>& indices)
+			{
+				std::vector<std::array<uint32_t, 3>> triangles(indices.size() / 3);
+				for (size_t i = 0; i < triangles.size(); ++i)
+				{
+					const uint32_t a = indices[(i * 3) + 0];
+					const uint32_t b = indices[(i * 3) + 1];
+					const uint32_t c = indices[(i * 3) + 2];
+					triangles[i] = ((a <= b) && (a <= c)) ? std::array<uint32_t, 3>{ a, b, c } : ((b <= c) ? std::array<uint32_t, 3>{ b, c, a } : std::array<uint32_t, 3>{ c, a, b });
+				}
+				std::sort(triangles.begin(), triangles.end());
+				return triangles;
+			};
+		const std::vector<std::array<uint32_t, 3>> sourceTriangles = canonicalTriangles(mesh.Indices);
+		const std::vector<std::array<uint32_t, 3>> meshletTriangles = canonicalTriangles(meshlets.Indices);
+
+		size_t errors = (sourceTriangles.size() > meshletTriangles.size()) ? sourceTriangles.size() - meshletTriangles.size() :
+			meshletTriangles.size() - sourceTriangles.size();
+		for (size_t i = 0; i < std::min(sourceTriangles.size(), meshletTriangles.size()); ++i)
+		{
+			errors += (sourceTriangles[i] != meshletTriangles[i]) ? 1 : 0;
+		}
+
+		for (const LeviathanAssets::Meshlets::Meshlet& meshlet : meshlets.Meshlets)
+		{
+			const bool withinLimits = (meshlet.VertexCount <= settings.MaxVertexCount) && (meshlet.TriangleCount <= settings.MaxTriangleCount);
+			for (size_t corner = 0; corner < static_cast<size_t>(meshlet.TriangleCount) * 3; ++corner)
+			{
+				const size_t index = (static_cast<size_t>(meshlet.TriangleOffset) * 3) + corner;
+				const uint8_t localIndex = meshlets.Triangles[index];
+				const bool resolves = (localIndex < meshlet.VertexCount) && (meshlets.Vertices[meshlet.VertexOffset + localIndex] == meshlets.Indices[index]);
+				errors += (resolves && withinLimits) ? 0 : 1;
+			}
+		}
+		return errors;
+	}
+
+	// Returns the number of meshlet vertices outside their meshlet's bounding sphere.
+	static size_t CountBoundsErrors(const LeviathanAssets::AssetTypes::Mesh& mesh, const LeviathanAssets::Meshlets::MeshletMesh& meshlets)
+	{
+		size_t errors = 0;
+		for (const LeviathanAssets::Meshlets::Meshlet& meshlet : meshlets.Meshlets)
+		{
+			for (uint32_t i = 0; i < meshlet.VertexCount; ++i)
+			{
+				const float distance = (mesh.Positions[meshlets.Vertices[meshlet.VertexOffset + i]] - meshlet.BoundingSphere.Center).Length();
+				errors += (distance > meshlet.BoundingSphere.Radius * 1.0001f) ? 1 : 0;
+			}
+		}
+		return errors;
+	}
+
+	// Counts the triangles of clusters culled as back facing that face the view position, and the clusters whose visibility differs from scalar
+	// sphere and cone tests.
+	static void CheckClusterCulling(const LeviathanRenderer::ClusterCullingStage& stage, const LeviathanAssets::AssetTypes::Mesh& mesh,
+		const LeviathanAssets::Meshlets::MeshletMesh& meshlets, const LeviathanCore::BoundingVolumes::Frustum& objectFrustum,
+		const LeviathanCore::MathTypes::Vector3& objectViewPosition, size_t& outFalselyCulledTriangles, size_t& outMismatches)
+	{
+		std::vector<uint8_t> visible(meshlets.Meshlets.size(), 0);
+		for (size_t i = 0; i < stage.GetVisibleClusterCount(); ++i)
+		{
+			visible[stage.GetVisibleClusters()[i]] = 1;
+		}
+
+		outFalselyCulledTriangles = 0;
+		outMismatches = 0;
+		for (size_t i = 0; i < meshlets.Meshlets.size(); ++i)
+		{
+			const LeviathanAssets::Meshlets::Meshlet& meshlet = meshlets.Meshlets[i];
+			const bool inFrustum = objectFrustum.Intersects(meshlet.BoundingSphere);
+			const LeviathanCore::MathTypes::Vector3 direction = (meshlet.ConeApex - objectViewPosition).AsNormalizedSafe();
+			const bool backFacing = (meshlet.ConeCutoff < 1.0f) && (LeviathanCore::MathTypes::Vector3::DotProduct(direction, meshlet.ConeAxis) > meshlet.ConeCutoff);
+			outMismatches += ((visible[i] != 0) != (inFrustum && !backFacing)) ? 1 : 0;
+
+			if (inFrustum && (visible[i] == 0))
+			{
+				for (uint32_t triangle = meshlet.TriangleOffset; triangle < meshlet.TriangleOffset + meshlet.TriangleCount; ++triangle)
+				{
+					const LeviathanCore::MathTypes::Vector3& p0 = mesh.Positions[meshlets.Indices[(static_cast<size_t>(triangle) * 3) + 0]];
+					const LeviathanCore::MathTypes::Vector3& p1 = mesh.Positions[meshlets.Indices[(static_cast<size_t>(triangle) * 3) + 1]];
+					const LeviathanCore::MathTypes::Vector3& p2 = mesh.Positions[meshlets.Indices[(static_cast<size_t>(triangle) * 3) + 2]];
+					const LeviathanCore::MathTypes::Vector3 normal = LeviathanCore::MathTypes::Vector3::CrossProduct(p1 - p0, p2 - p0);
+					outFalselyCulledTriangles += (LeviathanCore::MathTypes::Vector3::DotProduct(objectViewPosition - p0, normal) > 0.0f) ? 1 : 0;
+				}
+			}
+		}
+	}
+
+	// Returns the number of indices of the compacted index buffer that differ from the visible clusters' index ranges in cluster order.
+	static size_t CountCompactionErrors(const LeviathanRenderer::ClusterCullingStage& stage, const LeviathanAssets::Meshlets::MeshletMesh& meshlets)
+	{
+		std::vector<uint32_t> expected = {};
+		for (size_t i = 0; i < stage.GetVisibleClusterCount(); ++i)
+		{
+			const LeviathanAssets::Meshlets::Meshlet& meshlet = meshlets.Meshlets[stage.GetVisibleClusters()[i]];
+			const size_t first = static_cast<size_t>(meshlet.TriangleOffset) * 3;
+			expected.insert(expected.end(), meshlets.Indices.begin() + first, meshlets.Indices.begin() + first + (static_cast<size_t>(meshlet.TriangleCount) * 3));
+		}
+
+		size_t errors = (expected.size() > stage.GetVisibleIndexCount()) ? expected.size() - stage.GetVisibleIndexCount() : stage.GetVisibleIndexCount() - expected.size();
+		for (size_t i = 0; i < std::min(expected.size(), stage.GetVisibleIndexCount()); ++i)
+		{
+			errors += (expected[i] != stage.GetVisibleIndices()[i]) ? 1 : 0;
+		}
+		for (size_t i = 1; i < stage.GetVisibleClusterCount(); ++i)
+		{
+			errors += (stage.GetVisibleClusters()[i - 1] >= stage.GetVisibleClusters()[i]) ? 1 : 0;
+		}
+		return errors;
+	}
+
+	static void RunClusterCullingTests(Tester& tester, const std::string_view threadingName, const LeviathanAssets::AssetTypes::Mesh& mesh,
+		const LeviathanAssets::Meshlets::MeshletMesh& meshlets)
+	{
+		tester.Run("Meshlets.ClusterCull." + std::string(threadingName), [&]()
+			{
+				std::vector<LeviathanRenderer::ClusterDescription> clusters(meshlets.Meshlets.size());
+				for (size_t i = 0; i < clusters.size(); ++i)
+				{
+					const LeviathanAssets::Meshlets::Meshlet& meshlet = meshlets.Meshlets[i];
+					clusters[i] = LeviathanRenderer::ClusterDescription{ meshlet.BoundingSphere, meshlet.ConeApex, meshlet.ConeAxis, meshlet.ConeCutoff,
+						meshlet.TriangleOffset * 3, meshlet.TriangleCount * 3 };
+				}
+				LeviathanRenderer::ClusterCullingStage stage = {};
+				stage.SetClusters(clusters.data(), clusters.size());
+
+				// The torus is tilted, scaled and moved in front of a camera looking down +z so that part of it is outside the view and half of it faces away.
+				const LeviathanCore::MathTypes::Matrix4x4 transform = LeviathanCore::MathTypes::Matrix4x4::Translation(LeviathanCore::MathTypes::Vector3(4.0f, -2.0f, 24.0f)) *
+					LeviathanCore::MathTypes::Matrix4x4::Rotation(LeviathanCore::MathTypes::Vector3(1.0f, 0.0f, 0.0f), -0.9f) *
+					LeviathanCore::MathTypes::Matrix4x4::Scaling(LeviathanCore::MathTypes::Vector3(1.5f, 1.5f, 1.5f));
+				LeviathanRenderer::Camera camera = {};
+				camera.UpdateViewMatrix();
+				camera.UpdateProjectionMatrix(1920, 1080);
+				camera.UpdateViewProjectionMatrix();
+
+				// Culling twice checks that retained scratch memory does not leak results between calls.
+				stage.Cull(camera, transform, meshlets.Indices.data());
+				stage.Cull(camera, transform, meshlets.Indices.data());
+
+				const LeviathanRenderer::ClusterCullingStats& stats = stage.GetStats();
+				LEVIATHAN_TEST_CHECK(tester, stage.GetVisibleClusterCount() > 0);
+				LEVIATHAN_TEST_CHECK(tester, stats.FrustumCulledClusters > 0);
+				LEVIATHAN_TEST_CHECK(tester, stats.BackFacingClusters > 0);
+
+				const LeviathanCore::BoundingVolumes::Frustum objectFrustum = LeviathanCore::BoundingVolumes::Frustum::FromViewProjection(camera.GetViewProjectionMatrix() * transform);
+				const LeviathanCore::MathTypes::Vector4 objectViewPosition = LeviathanCore::MathTypes::Matrix4x4::Inverse(transform) *
+					LeviathanCore::MathTypes::Vector4(camera.GetPosition(), 1.0f);
+				size_t falselyCulledTriangles = 0;
+				size_t mismatches = 0;
+				CheckClusterCulling(stage, mesh, meshlets, objectFrustum, LeviathanCore::MathTypes::Vector3(objectViewPosition.X(), objectViewPosition.Y(), objectViewPosition.Z()),
+					falselyCulledTriangles, mismatches);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, falselyCulledTriangles, 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, mismatches, 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountCompactionErrors(stage, meshlets), 0);
+			});
+	}
+
+	void RunMeshletTests(Tester& tester)
+	{
+		const LeviathanAssets::AssetTypes::Mesh mesh = CreateMeshletTorus();
+		const LeviathanAssets::Meshlets::Settings settings = {};
+		LeviathanAssets::Meshlets::MeshletMesh meshlets = {};
+		LeviathanAssets::Meshlets::BuildMeshlets(mesh, settings, meshlets);
+
+		tester.Run("Meshlets.Build", [&]()
+			{
+				LEVIATHAN_TEST_CHECK(tester, meshlets.Meshlets.size() > 1);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountMeshletLayoutErrors(mesh, meshlets, settings), 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountBoundsErrors(mesh, meshlets), 0);
+			});
+
+		LeviathanTestFixtures::RunSingleThreadAndJobSystem(JobSystemWorkerCount, [&](const std::string_view threadingName)
+			{
+				RunClusterCullingTests(tester, threadingName, mesh, meshlets);
+			});
+	}
+}
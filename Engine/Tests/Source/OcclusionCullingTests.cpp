@@ -0,0 +1,220 @@
+#include "TestSuites.h"
+#include "Test.h"
+#include "TestFixtures.h"
+#include "MathTypes.h"
+#include "BoundingVolumes.h"
+#include "Camera.h"
+#include "VisibilityCulling.h"
+#include "RenderWorld.h"
+#include "OcclusionCulling.h"
+
+namespace LeviathanTests
+{
+	static constexpr size_t OccludeeCount = 5000;
+	static constexpr size_t OccluderRowCount = 8;
+	// Samples per box face edge when checking occluded objects with rays.
+	static constexpr size_t FaceSampleCount = 5;
+	static constexpr size_t JobSystemWorkerCount = 3;
+
+	struct OcclusionScene
+	{
+		LeviathanRenderer::Camera Camera = {};
+		LeviathanRenderer::RenderWorld World = {};
+		LeviathanRenderer::FrustumCullingStage FrustumCulling = {};
+		LeviathanRenderer::OcclusionCullingStage OcclusionCulling = {};
+		// Boxes of the occluders for ray tests.
+		std::vector<LeviathanCore::BoundingVolumes::AABB> OccluderBoxes = {};
+	};
+
+	static LeviathanRenderer::OccluderDescription MakeBoxOccluder(const LeviathanCore::BoundingVolumes::AABB& box)
+	{
+		LeviathanRenderer::OccluderDescription description = {};
+		for (uint32_t corner = 0; corner < 8; ++corner)
+		{
+			description.Positions.emplace_back((corner & 1) ? box.Max.X() : box.Min.X(), (corner & 2) ? box.Max.Y() : box.Min.Y(),
+				(corner & 4) ? box.Max.Z() : box.Min.Z());
+		}
+		description.Indices = {
+			0, 2, 3, 0, 3, 1,
+			4, 5, 7, 4, 7, 6,
+			0, 1, 5, 0, 5, 4,
+			2, 6, 7, 2, 7, 3,
+			0, 4, 6, 0, 6, 2,
+			1, 3, 7, 1, 7, 5 };
+		description.Transform = LeviathanCore::MathTypes::Matrix4x4::Identity();
+		return description;
+	}
+
+	// Indoor scene seen from a camera at the origin looking down +z. Rows of wall panels with doorway gaps and varying heights stand between 60 and 725
+	// units deep, and a corridor wall on the left runs from behind the camera to beyond the farthest row, crossing the near plane. Unit cubes are
+	// scattered over the view between the walls.
+	static void MakeOcclusionScene(OcclusionScene& scene)
+	{
+		scene.Camera.UpdateViewMatrix();
+		scene.Camera.UpdateProjectionMatrix(1920, 1080);
+		scene.Camera.UpdateViewProjectionMatrix();
+
+		std::mt19937 random(2468);
+		std::uniform_real_distribution<float> unitDistribution(0.0f, 1.0f);
+		for (size_t row = 0; row < OccluderRowCount; ++row)
+		{
+			const float z = 60.0f + 95.0f * static_cast<float>(row);
+			for (float x = -0.8f * z; x < 0.8f * z;)
+			{
+				const float width = z * (0.12f + 0.18f * unitDistribution(random));
+				const float top = z * (0.45f * unitDistribution(random));
+				scene.OccluderBoxes.push_back(LeviathanCore::BoundingVolumes::AABB{ LeviathanCore::MathTypes::Vector3(x, -0.5f * z, z),
+					LeviathanCore::MathTypes::Vector3(x + width, top, z + 2.0f) });
+				x += width + z * (0.02f + 0.03f * unitDistribution(random));
+			}
+		}
+		scene.OccluderBoxes.push_back(LeviathanCore::BoundingVolumes::AABB{ LeviathanCore::MathTypes::Vector3(-40.0f, -400.0f, -20.0f),
+			LeviathanCore::MathTypes::Vector3(-38.0f, 400.0f, 900.0f) });
+
+		for (const LeviathanCore::BoundingVolumes::AABB& box : scene.OccluderBoxes)
+		{
+			scene.OcclusionCulling.CreateOccluder(MakeBoxOccluder(box));
+		}
+
+		std::uniform_real_distribution<float> depthDistribution(20.0f, 800.0f);
+		std::uniform_real_distribution<float> offsetDistribution(-1.0f, 1.0f);
+		const LeviathanCore::BoundingVolumes::AABB localBounds{ LeviathanCore::MathTypes::Vector3(-0.5f, -0.5f, -0.5f), LeviathanCore::MathTypes::Vector3(0.5f, 0.5f, 0.5f) };
+		while (scene.World.GetCount() < OccludeeCount)
+		{
+			const float z = depthDistribution(random);
+			LeviathanRenderer::RenderableDescription description = {};
+			description.Mesh.LocalBounds = localBounds;
+			description.Transform = LeviathanCore::MathTypes::Matrix4x4::Translation(LeviathanCore::MathTypes::Vector3(0.6f * z * offsetDistribution(random),
+				0.35f * z * offsetDistribution(random), z));
+
+			// Cubes are kept out of the walls.
+			const LeviathanCore::BoundingVolumes::AABB bounds = localBounds.Transformed(description.Transform);
+			if (std::none_of(scene.OccluderBoxes.begin(), scene.OccluderBoxes.end(), [&bounds](const LeviathanCore::BoundingVolumes::AABB& box) { return box.Intersects(bounds); }))
+			{
+				scene.World.Create(description);
+			}
+		}
+
+		scene.FrustumCulling.Cull(scene.Camera.GetFrustum(), scene.World.GetWorldBounds());
+	}
+
+	// Returns whether a ray from the camera reaches any of the sample points spread over the faces of the box without hitting an occluder.
+	static bool IsSampleVisible(const OcclusionScene& scene, const LeviathanCore::BoundingVolumes::AABB& box)
+	{
+		const LeviathanCore::MathTypes::Vector3 extent = box.Max - box.Min;
+		for (size_t axis = 0; axis < 3; ++axis)
+		{
+			for (size_t side = 0; side < 2; ++side)
+			{
+				for (size_t u = 0; u < FaceSampleCount; ++u)
+				{
+					for (size_t v = 0; v < FaceSampleCount; ++v)
+					{
+						std::array<float, 3> point = { box.Min.X(), box.Min.Y(), box.Min.Z() };
+						const std::array<float, 3> size = { extent.X(), extent.Y(), extent.Z() };
+						const size_t uAxis = (axis + 1) % 3;
+						const size_t vAxis = (axis + 2) % 3;
+						point[axis] += (side == 0) ? 0.0f : size[axis];
+						point[uAxis] += size[uAxis] * static_cast<float>(u) / static_cast<float>(FaceSampleCount - 1);
+						point[vAxis] += size[vAxis] * static_cast<float>(v) / static_cast<float>(FaceSampleCount - 1);
+
+						const LeviathanCore::BoundingVolumes::Ray ray{ scene.Camera.GetPosition(),
+							LeviathanCore::MathTypes::Vector3(point[0], point[1], point[2]) - scene.Camera.GetPosition() };
+						bool blocked = false;
+						for (const LeviathanCore::BoundingVolumes::AABB& occluder : scene.OccluderBoxes)
+						{
+							float distance = 0.0f;
+							if (ray.Intersects(occluder, 0.999f, distance))
+							{
+								blocked = true;
+								break;
+							}
+						}
+						if (!blocked)
+						{
+							return true;
+						}
+					}
+				}
+			}
+		}
+		return false;
+	}
+
+	// Returns the number of objects culled as occluded although a ray from the camera reaches a point on their bounds.
+	static size_t CountFalseOcclusions(const OcclusionScene& scene)
+	{
+		const LeviathanCore::BoundingVolumes::AABBSoA worldBounds = scene.World.GetWorldBounds();
+		const uint32_t* const tested = scene.FrustumCulling.GetVisibleIndices();
+		const uint32_t* const visible = scene.OcclusionCulling.GetVisibleIndices();
+		size_t visibleCursor = 0;
+		size_t falseOcclusions = 0;
+		for (size_t i = 0; i < scene.FrustumCulling.GetVisibleCount(); ++i)
+		{
+			// Visible indices keep the order of the tested indices.
+			const uint32_t index = tested[i];
+			if ((visibleCursor < scene.OcclusionCulling.GetVisibleCount()) && (visible[visibleCursor] == index))
+			{
+				++visibleCursor;
+				continue;
+			}
+
+			const LeviathanCore::BoundingVolumes::AABB box{ LeviathanCore::MathTypes::Vector3(worldBounds.MinX[index], worldBounds.MinY[index], worldBounds.MinZ[index]),
+				LeviathanCore::MathTypes::Vector3(worldBounds.MaxX[index], worldBounds.MaxY[index], worldBounds.MaxZ[index]) };
+			falseOcclusions += IsSampleVisible(scene, box) ? 1 : 0;
+		}
+		return falseOcclusions;
+	}
+
+	static void RunOcclusionStageTests(Tester& tester, const std::string_view threadingName, OcclusionScene& scene)
+	{
+		tester.Run("OcclusionCulling.Cull." + std::string(threadingName), [&]()
+			{
+				scene.OcclusionCulling.RenderOccluders(scene.Camera);
+				const LeviathanRenderer::OcclusionCullingStage& occlusion = scene.OcclusionCulling;
+				const size_t pixelCount = static_cast<size_t>(occlusion.GetWidth()) * occlusion.GetHeight();
+				const size_t coveredPixels = pixelCount - static_cast<size_t>(std::count(occlusion.GetDepthBuffer(), occlusion.GetDepthBuffer() + pixelCount, 0.0f));
+				LEVIATHAN_TEST_CHECK(tester, coveredPixels > 0);
+
+				const size_t testedCount = scene.FrustumCulling.GetVisibleCount();
+				scene.OcclusionCulling.Cull(scene.World.GetWorldBounds(), scene.FrustumCulling.GetVisibleIndices(), testedCount);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, occlusion.GetStats().TestedObjects, testedCount);
+				LEVIATHAN_TEST_CHECK(tester, occlusion.GetStats().OccludedObjects > 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, occlusion.GetVisibleCount() + occlusion.GetStats().OccludedObjects, testedCount);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountFalseOcclusions(scene), 0);
+			});
+
+		tester.Run("OcclusionCulling.BuildDrawList." + std::string(threadingName), [&]()
+			{
+				LeviathanRenderer::DrawList frustumDrawList = {};
+				LeviathanRenderer::BuildDrawList(scene.World, scene.Camera, scene.FrustumCulling, frustumDrawList);
+				LeviathanRenderer::DrawList occlusionDrawList = {};
+				LeviathanRenderer::BuildDrawList(scene.World, scene.Camera, scene.FrustumCulling, scene.OcclusionCulling, occlusionDrawList);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, occlusionDrawList.GetCount(), scene.OcclusionCulling.GetVisibleCount());
+				LEVIATHAN_TEST_CHECK(tester, occlusionDrawList.GetCount() < frustumDrawList.GetCount());
+			});
+
+		tester.Run("OcclusionCulling.BuildDrawList.Orthographic." + std::string(threadingName), [&]()
+			{
+				LeviathanRenderer::Camera orthographicCamera = scene.Camera;
+				orthographicCamera.SetProjectionMode(LeviathanRenderer::Camera::ProjectionMode::Orthographic);
+				LeviathanRenderer::DrawList frustumDrawList = {};
+				LeviathanRenderer::BuildDrawList(scene.World, orthographicCamera, scene.FrustumCulling, frustumDrawList);
+				LeviathanRenderer::DrawList occlusionDrawList = {};
+				LeviathanRenderer::BuildDrawList(scene.World, orthographicCamera, scene.FrustumCulling, scene.OcclusionCulling, occlusionDrawList);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, occlusionDrawList.GetCount(), frustumDrawList.GetCount());
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, scene.OcclusionCulling.GetStats().TestedObjects, 0);
+			});
+	}
+
+	void RunOcclusionCullingTests(Tester& tester)
+	{
+		OcclusionScene scene = {};
+		MakeOcclusionScene(scene);
+
+		LeviathanTestFixtures::RunSingleThreadAndJobSystem(JobSystemWorkerCount, [&](const std::string_view threadingName)
+			{
+				RunOcclusionStageTests(tester, threadingName, scene);
+			});
+	}
+}
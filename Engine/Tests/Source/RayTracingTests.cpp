@@ -0,0 +1,226 @@
+#include "TestSuites.h"
+#include "Test.h"
+#include "MathTypes.h"
+#include "BoundingVolumes.h"
+#include "JobSystem.h"
+#include "AssetTypes.h"
+#include "TriangleBVH.h"
+
+namespace LeviathanTests
+{
+	// 2 * 200 * (100 - 1) = 39600 triangles.
+	static constexpr size_t MeshSectors = 200;
+	static constexpr size_t MeshStacks = 100;
+	static constexpr size_t ImageWidth = 64;
+	static constexpr size_t ImageHeight = 32;
+	static constexpr size_t JobSystemWorkerCount = 3;
+	static constexpr float RayLength = 1000.0f;
+
+	// Sphere with a bumpy surface so that the hierarchy is not trivially regular.
+	static LeviathanAssets::AssetTypes::Mesh CreateBumpySphere()
+	{
+		LeviathanAssets::AssetTypes::Mesh mesh = {};
+		mesh.Positions.reserve((MeshSectors + 1) * (MeshStacks + 1));
+		for (size_t stack = 0; stack <= MeshStacks; ++stack)
+		{
+			const float theta = 3.14159265f * static_cast<float>(stack) / static_cast<float>(MeshStacks);
+			for (size_t sector = 0; sector <= MeshSectors; ++sector)
+			{
+				const float phi = 6.28318531f * static_cast<float>(sector) / static_cast<float>(MeshSectors);
+				const float radius = 10.0f + (0.5f * std::sin(8.0f * theta) * std::cos(6.0f * phi)) + (0.2f * std::sin((23.0f * theta) + (11.0f * phi)));
+				mesh.Positions.emplace_back(radius * std::sin(theta) * std::cos(phi), radius * std::cos(theta), radius * std::sin(theta) * std::sin(phi));
+			}
+		}
+
+		for (size_t stack = 0; stack < MeshStacks; ++stack)
+		{
+			for (size_t sector = 0; sector < MeshSectors; ++sector)
+			{
+				const uint32_t a = static_cast<uint32_t>((stack * (MeshSectors + 1)) + sector);
+				const uint32_t b = a + static_cast<uint32_t>(MeshSectors + 1);
+				// The first and last stacks have one triangle per sector.
+				if (stack != 0)
+				{
+					mesh.Indices.insert(mesh.Indices.end(), { a, b, a + 1 });
+				}
+				if (stack != MeshStacks - 1)
+				{
+					mesh.Indices.insert(mesh.Indices.end(), { a + 1, b, b + 1 });
+				}
+			}
+		}
+
+		mesh.CalculateBounds();
+		return mesh;
+	}
+
+	// Pinhole camera rays ordered in 2x2 pixel quads so that each packet of 4 rays is coherent.
+	static std::vector<LeviathanCore::BoundingVolumes::Ray> CreatePrimaryRays()
+	{
+		std::vector<LeviathanCore::BoundingVolumes::Ray> rays = {};
+		rays.reserve(ImageWidth * ImageHeight);
+		const LeviathanCore::MathTypes::Vector3 origin(0.0f, 3.0f, -30.0f);
+		const float aspectRatio = static_cast<float>(ImageWidth) / static_cast<float>(ImageHeight);
+		for (size_t y = 0; y < ImageHeight; y += 2)
+		{
+			for (size_t x = 0; x < ImageWidth; x += 2)
+			{
+				for (size_t quad = 0; quad < 4; ++quad)
+				{
+					const float u = ((static_cast<float>(x + (quad & 1)) + 0.5f) / static_cast<float>(ImageWidth)) * 2.0f - 1.0f;
+					const float v = ((static_cast<float>(y + (quad >> 1)) + 0.5f) / static_cast<float>(ImageHeight)) * 2.0f - 1.0f;
+					const LeviathanCore::MathTypes::Vector3 direction(u * aspectRatio * 0.5f, (v * 0.5f) - 0.1f, 1.0f);
+					rays.push_back(LeviathanCore::BoundingVolumes::Ray{ origin, direction.AsNormalizedSafe() });
+				}
+			}
+		}
+		return rays;
+	}
+
+	// Random origins around the mesh with random directions. The count is not a multiple of the packet width so that partial packets are covered.
+	static std::vector<LeviathanCore::BoundingVolumes::Ray> CreateIncoherentRays(const size_t count)
+	{
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> originDistribution(-15.0f, 15.0f);
+		std::uniform_real_distribution<float> directionDistribution(-1.0f, 1.0f);
+
+		std::vector<LeviathanCore::BoundingVolumes::Ray> rays(count);
+		for (LeviathanCore::BoundingVolumes::Ray& ray : rays)
+		{
+			ray.Origin = LeviathanCore::MathTypes::Vector3(originDistribution(random), originDistribution(random), originDistribution(random));
+			ray.Direction = LeviathanCore::MathTypes::Vector3(directionDistribution(random), directionDistribution(random), directionDistribution(random)).AsNormalizedSafe();
+		}
+		return rays;
+	}
+
+	// Closest hit distance of the ray against every triangle of the mesh or a negative value if nothing is hit.
+	static float BruteForceClosestHit(const LeviathanAssets::AssetTypes::Mesh& mesh, const LeviathanCore::BoundingVolumes::Ray& ray, const float maxDistance)
+	{
+		float closest = -1.0f;
+		float limit = maxDistance;
+		const float* const o = ray.Origin.Data();
+		const float* const d = ray.Direction.Data();
+		for (size_t i = 0; i < mesh.Indices.size(); i += 3)
+		{
+			const float* const v0 = mesh.Positions[mesh.Indices[i + 0]].Data();
+			const float* const v1 = mesh.Positions[mesh.Indices[i + 1]].Data();
+			const float* const v2 = mesh.Positions[mesh.Indices[i + 2]].Data();
+			const float e1[3] = { v1[0] - v0[0], v1[1] - v0[1], v1[2] - v0[2] };
+			const float e2[3] = { v2[0] - v0[0], v2[1] - v0[1], v2[2] - v0[2] };
+
+			const float p[3] = { (d[1] * e2[2]) - (d[2] * e2[1]), (d[2] * e2[0]) - (d[0] * e2[2]), (d[0] * e2[1]) - (d[1] * e2[0]) };
+			const float determinant = (e1[0] * p[0]) + (e1[1] * p[1]) + (e1[2] * p[2]);
+			if (determinant == 0.0f)
+			{
+				continue;
+			}
+
+			const float inverseDeterminant = 1.0f / determinant;
+			const float t[3] = { o[0] - v0[0], o[1] - v0[1], o[2] - v0[2] };
+			const float u = ((t[0] * p[0]) + (t[1] * p[1]) + (t[2] * p[2])) * inverseDeterminant;
+			const float q[3] = { (t[1] * e1[2]) - (t[2] * e1[1]), (t[2] * e1[0]) - (t[0] * e1[2]), (t[0] * e1[1]) - (t[1] * e1[0]) };
+			const float v = ((d[0] * q[0]) + (d[1] * q[1]) + (d[2] * q[2])) * inverseDeterminant;
+			const float distance = ((e2[0] * q[0]) + (e2[1] * q[1]) + (e2[2] * q[2])) * inverseDeterminant;
+			if ((u >= 0.0f) && (u <= 1.0f) && (v >= 0.0f) && ((u + v) <= 1.0f) && (distance >= 0.0f) && (distance <= limit))
+			{
+				closest = distance;
+				limit = distance;
+			}
+		}
+		return closest;
+	}
+
+	static bool SameHit(const LeviathanAssets::TriangleBVH::Hit& a, const LeviathanAssets::TriangleBVH::Hit& b)
+	{
+		const bool aHit = (a.TriangleIndex != LeviathanAssets::TriangleBVH::InvalidTriangleIndex);
+		const bool bHit = (b.TriangleIndex != LeviathanAssets::TriangleBVH::InvalidTriangleIndex);
+		return (aHit == bHit) && ((!aHit) || (std::fabs(a.Distance - b.Distance) <= 1e-4f * std::max(1.0f, a.Distance)));
+	}
+
+	static void RunRayQueryTests(Tester& tester, const std::string_view name, const LeviathanAssets::TriangleBVH& bvh, const LeviathanAssets::AssetTypes::Mesh& mesh,
+		const std::vector<LeviathanCore::BoundingVolumes::Ray>& rays)
+	{
+		std::vector<LeviathanAssets::TriangleBVH::Hit> singleHits(rays.size());
+		for (size_t i = 0; i < rays.size(); ++i)
+		{
+			bvh.Intersect(rays[i], RayLength, singleHits[i]);
+		}
+
+		tester.Run("TriangleBVH.Intersect.MatchesBruteForce." + std::string(name), [&]()
+			{
+				size_t hits = 0;
+				size_t mismatches = 0;
+				for (size_t i = 0; i < rays.size(); ++i)
+				{
+					const float bruteForceDistance = BruteForceClosestHit(mesh, rays[i], RayLength);
+					LeviathanAssets::TriangleBVH::Hit bruteForceHit = {};
+					bruteForceHit.Distance = bruteForceDistance;
+					bruteForceHit.TriangleIndex = (bruteForceDistance >= 0.0f) ? 0 : LeviathanAssets::TriangleBVH::InvalidTriangleIndex;
+					mismatches += SameHit(singleHits[i], bruteForceHit) ? 0 : 1;
+					hits += (bruteForceDistance >= 0.0f) ? 1 : 0;
+				}
+				LEVIATHAN_TEST_CHECK(tester, (hits > 0) && (hits < rays.size()));
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, mismatches, 0);
+			});
+
+		tester.Run("TriangleBVH.IntersectPacket.MatchesSingleRay." + std::string(name), [&]()
+			{
+				std::vector<LeviathanAssets::TriangleBVH::Hit> packetHits(rays.size());
+				bvh.IntersectPacket(rays.data(), rays.size(), RayLength, packetHits.data());
+
+				size_t mismatches = 0;
+				for (size_t i = 0; i < rays.size(); ++i)
+				{
+					mismatches += SameHit(singleHits[i], packetHits[i]) ? 0 : 1;
+				}
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, mismatches, 0);
+			});
+
+		// Any hit queries must agree with closest hit queries on whether a ray hits.
+		tester.Run("TriangleBVH.IntersectAny.MatchesClosestHit." + std::string(name), [&]()
+			{
+				std::vector<uint8_t> anyPacketHits(rays.size(), 0);
+				bvh.IntersectAnyPacket(rays.data(), rays.size(), RayLength, anyPacketHits.data());
+
+				size_t mismatches = 0;
+				for (size_t i = 0; i < rays.size(); ++i)
+				{
+					const uint8_t closestHit = (singleHits[i].TriangleIndex != LeviathanAssets::TriangleBVH::InvalidTriangleIndex) ? 1 : 0;
+					mismatches += (closestHit != anyPacketHits[i]) ? 1 : 0;
+					mismatches += (closestHit != (bvh.IntersectAny(rays[i], RayLength) ? 1 : 0)) ? 1 : 0;
+				}
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, mismatches, 0);
+			});
+	}
+
+	void RunRayTracingTests(Tester& tester)
+	{
+		const LeviathanAssets::AssetTypes::Mesh mesh = CreateBumpySphere();
+		const std::vector<LeviathanCore::BoundingVolumes::Ray> primaryRays = CreatePrimaryRays();
+		const std::vector<LeviathanCore::BoundingVolumes::Ray> incoherentRays = CreateIncoherentRays(primaryRays.size() + 3);
+
+		// The build runs on the calling thread while the job system is not initialized.
+		LeviathanAssets::TriangleBVH bvh = {};
+		tester.Run("TriangleBVH.Build.SingleThread", [&]()
+			{
+				bvh.Build(mesh);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, bvh.GetTriangleCount(), mesh.Indices.size() / 3);
+				LEVIATHAN_TEST_CHECK(tester, !bvh.IsEmpty());
+			});
+		RunRayQueryTests(tester, "Primary.SingleThreadBuild", bvh, mesh, primaryRays);
+		RunRayQueryTests(tester, "Incoherent.SingleThreadBuild", bvh, mesh, incoherentRays);
+
+		const bool startedJobSystem = LeviathanCore::JobSystem::Initialize(JobSystemWorkerCount);
+		LeviathanAssets::TriangleBVH parallelBvh = {};
+		tester.Run("TriangleBVH.Build.JobSystem", [&]()
+			{
+				parallelBvh.Build(mesh);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, parallelBvh.GetTriangleCount(), mesh.Indices.size() / 3);
+			});
+		if (startedJobSystem)
+		{
+			LeviathanCore::JobSystem::Shutdown();
+		}
+		RunRayQueryTests(tester, "Primary.JobSystemBuild", parallelBvh, mesh, primaryRays);
+	}
+}
@@ -0,0 +1,525 @@
+#include "TestSuites.h"
+#include "Test.h"
+#include "TestFixtures.h"
+#include "JobSystem.h"
+#include "RenderCommands.h"
+#include "RenderStateFilter.h"
+#include "RendererConstants.h"
+
+namespace LeviathanTests
+{
+	namespace RenderCommands = LeviathanRenderer::RenderCommands;
+
+	static constexpr size_t DrawCount = 10000;
+	static constexpr size_t RecordChunkSize = 1024;
+	static constexpr size_t MaterialCount = 64;
+	static constexpr size_t JobSystemWorkerCount = 3;
+
+	struct Draw
+	{
+		uint64_t SortKey = 0;
+		LeviathanRenderer::RendererResourceId::IdType ColorTexture = LeviathanRenderer::RendererResourceId::InvalidId;
+		LeviathanRenderer::RendererResourceId::IdType NormalTexture = LeviathanRenderer::RendererResourceId::InvalidId;
+		LeviathanRenderer::RendererResourceId::IdType VertexBuffer = LeviathanRenderer::RendererResourceId::InvalidId;
+		LeviathanRenderer::RendererResourceId::IdType IndexBuffer = LeviathanRenderer::RendererResourceId::InvalidId;
+		uint32_t IndexCount = 0;
+		// Same size as the object constant buffer.
+		std::array<float, 48> ObjectData = {};
+	};
+
+	// Backend recording every call with its arguments. Constant buffer data is recorded as a hash.
+	struct RecordingBackend
+	{
+		struct Call
+		{
+			RenderCommands::CommandType Type = RenderCommands::CommandType::UnbindShaderResources;
+			uint8_t Enum = 0;
+			uint64_t A = 0;
+			uint64_t B = 0;
+			uint64_t C = 0;
+
+			inline bool operator==(const Call& other) const
+			{
+				return (Type == other.Type) && (Enum == other.Enum) && (A == other.A) && (B == other.B) && (C == other.C);
+			}
+		};
+
+		std::vector<Call> Calls = {};
+
+		void ClearRenderTarget(const RenderCommands::RenderTarget target, const float* color)
+		{
+			Calls.push_back(Call{ RenderCommands::CommandType::ClearRenderTarget, static_cast<uint8_t>(target), RenderCommands::HashConstantBufferData(color, sizeof(float) * 4), 0, 0 });
+		}
+
+		void ClearDepthStencil(const float depth, const uint8_t stencil)
+		{
+			Calls.push_back(Call{ RenderCommands::CommandType::ClearDepthStencil, stencil, RenderCommands::HashConstantBufferData(&depth, sizeof(depth)), 0, 0 });
+		}
+
+		void SetRenderTarget(const RenderCommands::RenderTarget target)
+		{
+			Calls.push_back(Call{ RenderCommands::CommandType::SetRenderTarget, static_cast<uint8_t>(target), 0, 0, 0 });
+		}
+
+		void SetPipeline(const RenderCommands::Pipeline pipeline, const uint32_t permutation)
+		{
+			Calls.push_back(Call{ RenderCommands::CommandType::SetPipeline, static_cast<uint8_t>(pipeline), permutation, 0, 0 });
+		}
+
+		void SetSkyboxPipeline(const LeviathanRenderer::RendererResourceId::IdType textureCubeId, const LeviathanRenderer::RendererResourceId::IdType samplerId)
+		{
+			Calls.push_back(Call{ RenderCommands::CommandType::SetSkyboxPipeline, 0, textureCubeId, samplerId, 0 });
+		}
+
+		void SetBlendState(const RenderCommands::BlendState state)
+		{
+			Calls.push_back(Call{ RenderCommands::CommandType::SetBlendState, static_cast<uint8_t>(state), 0, 0, 0 });
+		}
+
+		void SetDepthStencilState(const RenderCommands::DepthStencilState state)
+		{
+			Calls.push_back(Call{ RenderCommands::CommandType::SetDepthStencilState, static_cast<uint8_t>(state), 0, 0, 0 });
+		}
+
+		void SetTexture(const RenderCommands::TextureSlot slot, const LeviathanRenderer::RendererResourceId::IdType textureId)
+		{
+			Calls.push_back(Call{ RenderCommands::CommandType::SetTexture, static_cast<uint8_t>(slot), textureId, 0, 0 });
+		}
+
+		void SetSampler(const RenderCommands::TextureSlot slot, const LeviathanRenderer::RendererResourceId::IdType samplerId)
+		{
+			Calls.push_back(Call{ RenderCommands::CommandType::SetSampler, static_cast<uint8_t>(slot), samplerId, 0, 0 });
+		}
+
+		void UpdateConstantBuffer(const RenderCommands::ConstantBuffer buffer, const void* data, const uint32_t byteWidth)
+		{
+			Calls.push_back(Call{ RenderCommands::CommandType::UpdateConstantBuffer, static_cast<uint8_t>(buffer), RenderCommands::HashConstantBufferData(data, byteWidth), byteWidth, 0 });
+		}
+
+		void SetConstantBufferRange(const RenderCommands::ConstantBuffer buffer, const uint32_t offset, const uint32_t byteWidth)
+		{
+			Calls.push_back(Call{ RenderCommands::CommandType::SetConstantBufferRange, static_cast<uint8_t>(buffer), offset, byteWidth, 0 });
+		}
+
+		void DrawIndexed(const uint32_t indexCount, const uint32_t vertexStrideBytes, const LeviathanRenderer::RendererResourceId::IdType vertexBufferId,
+			const LeviathanRenderer::RendererResourceId::IdType indexBufferId)
+		{
+			Calls.push_back(Call{ RenderCommands::CommandType::DrawIndexed, 0, (static_cast<uint64_t>(indexCount) << 32) | vertexStrideBytes, vertexBufferId, indexBufferId });
+		}
+
+		void DrawIndexedInstanced(const uint32_t indexCount, const uint32_t vertexStrideBytes, const LeviathanRenderer::RendererResourceId::IdType vertexBufferId,
+			const LeviathanRenderer::RendererResourceId::IdType indexBufferId, const uint32_t instanceCount, const uint32_t firstInstance)
+		{
+			Calls.push_back(Call{ RenderCommands::CommandType::DrawIndexedInstanced, 0, (static_cast<uint64_t>(indexCount) << 32) | vertexStrideBytes,
+				vertexBufferId ^ (static_cast<uint64_t>(instanceCount) << 32), indexBufferId ^ (static_cast<uint64_t>(firstInstance) << 32) });
+		}
+
+		void UnbindShaderResources()
+		{
+			Calls.push_back(Call{ RenderCommands::CommandType::UnbindShaderResources, 0, 0, 0, 0 });
+		}
+	};
+
+	// Draws with unique sort keys grouped by material. The depth field holds the draw index so that sorted order does not depend on how draws are split
+	// across threads.
+	static std::vector<Draw> CreateDraws()
+	{
+		std::mt19937 random(2468);
+		std::uniform_int_distribution<uint32_t> materialDistribution(1, MaterialCount);
+		std::uniform_int_distribution<uint32_t> indexCountDistribution(36, 30000);
+		std::uniform_real_distribution<float> dataDistribution(-1.0f, 1.0f);
+
+		std::vector<Draw> draws(DrawCount);
+		for (size_t i = 0; i < draws.size(); ++i)
+		{
+			Draw& draw = draws[i];
+			const uint32_t material = materialDistribution(random);
+			draw.SortKey = RenderCommands::MakeSortKey(1, static_cast<uint8_t>(RenderCommands::Pipeline::AmbientLight), material, static_cast<uint32_t>(draws.size() - i));
+			draw.ColorTexture = material * 2;
+			draw.NormalTexture = material * 2 + 1;
+			draw.VertexBuffer = 1000 + (i % 97);
+			draw.IndexBuffer = 2000 + (i % 97);
+			draw.IndexCount = indexCountDistribution(random);
+			for (float& value : draw.ObjectData)
+			{
+				value = dataDistribution(random);
+			}
+		}
+		return draws;
+	}
+
+	static void RecordDraw(RenderCommands::CommandBuffer& commands, const Draw& draw)
+	{
+		commands.BeginPacket(draw.SortKey);
+		commands.SetTexture(RenderCommands::TextureSlot::Color, draw.ColorTexture);
+		commands.SetTexture(RenderCommands::TextureSlot::Normal, draw.NormalTexture);
+		commands.SetSampler(RenderCommands::TextureSlot::Color, 1);
+		commands.UpdateConstantBuffer(RenderCommands::ConstantBuffer::Object, draw.ObjectData.data(), static_cast<uint32_t>(sizeof(draw.ObjectData)));
+		commands.DrawIndexed(draw.IndexCount, 44, draw.VertexBuffer, draw.IndexBuffer);
+	}
+
+	// Records the draws into the buffers of the job system threads.
+	static void RecordDraws(RenderCommands::CommandQueue& queue, const std::vector<Draw>& draws)
+	{
+		queue.Reset(LeviathanCore::JobSystem::GetThreadCount());
+		LeviathanCore::JobSystem::ParallelFor(draws.size(), RecordChunkSize, [&queue, &draws](const size_t first, const size_t count, const size_t threadIndex)
+			{
+				RenderCommands::CommandBuffer& commands = queue.GetBuffer(threadIndex);
+				for (size_t i = first; i < first + count; ++i)
+				{
+					RecordDraw(commands, draws[i]);
+				}
+			});
+	}
+
+	// Lighting frames recorded the same way as LeviathanRenderer::Render with every object drawn once per light.
+	static constexpr size_t FrameObjectCount = 64;
+	static constexpr size_t FrameMaterialCount = 8;
+	static constexpr size_t FrameDirectionalLightCount = 2;
+	static constexpr size_t FramePointLightCount = 16;
+	static constexpr size_t FrameSpotLightCount = 16;
+	static constexpr size_t RandomStreamCommandCount = 20000;
+
+	// Backend modelling the state the renderer api draws with. Texture and sampler tables are bound when a pipeline is set, the skybox pipeline binds
+	// slot 0 directly and unbinding shader resources clears slot 0. Records the state of every draw.
+	struct StateModelBackend
+	{
+		struct DrawState
+		{
+			uint8_t RenderTarget = 0xff;
+			uint8_t BlendState = 0xff;
+			uint8_t DepthStencilState = 0xff;
+			uint8_t Pipeline = 0xff;
+			uint32_t Permutation = 0;
+			std::array<LeviathanRenderer::RendererResourceId::IdType, RenderCommands::TextureSlotCount> BoundTextures = {};
+			std::array<LeviathanRenderer::RendererResourceId::IdType, RenderCommands::TextureSlotCount> BoundSamplers = {};
+			std::array<uint64_t, RenderCommands::ConstantBufferCount> ConstantBuffers = {};
+			uint32_t IndexCount = 0;
+			LeviathanRenderer::RendererResourceId::IdType VertexBuffer = LeviathanRenderer::RendererResourceId::InvalidId;
+			LeviathanRenderer::RendererResourceId::IdType IndexBuffer = LeviathanRenderer::RendererResourceId::InvalidId;
+			uint32_t InstanceCount = 0;
+			uint32_t FirstInstance = 0;
+
+			bool operator==(const DrawState& other) const = default;
+		};
+
+		DrawState Current = {};
+		std::array<LeviathanRenderer::RendererResourceId::IdType, RenderCommands::TextureSlotCount> TextureTable = {};
+		std::array<LeviathanRenderer::RendererResourceId::IdType, RenderCommands::TextureSlotCount> SamplerTable = {};
+		std::vector<DrawState> Draws = {};
+
+		void ClearRenderTarget(RenderCommands::RenderTarget, const float*) {}
+		void ClearDepthStencil(float, uint8_t) {}
+
+		void SetRenderTarget(const RenderCommands::RenderTarget target) { Current.RenderTarget = static_cast<uint8_t>(target); }
+
+		void SetPipeline(const RenderCommands::Pipeline pipeline, const uint32_t permutation)
+		{
+			Current.Pipeline = static_cast<uint8_t>(pipeline);
+			Current.Permutation = permutation;
+			Current.BoundTextures = TextureTable;
+			Current.BoundSamplers = SamplerTable;
+		}
+
+		void SetSkyboxPipeline(const LeviathanRenderer::RendererResourceId::IdType textureCubeId, const LeviathanRenderer::RendererResourceId::IdType samplerId)
+		{
+			Current.Pipeline = 0xfe;
+			Current.Permutation = 0;
+			Current.BoundTextures[0] = textureCubeId;
+			Current.BoundSamplers[0] = samplerId;
+		}
+
+		void SetBlendState(const RenderCommands::BlendState state) { Current.BlendState = static_cast<uint8_t>(state); }
+		void SetDepthStencilState(const RenderCommands::DepthStencilState state) { Current.DepthStencilState = static_cast<uint8_t>(state); }
+
+		void SetTexture(const RenderCommands::TextureSlot slot, const LeviathanRenderer::RendererResourceId::IdType textureId)
+		{
+			TextureTable[static_cast<size_t>(slot)] = textureId;
+		}
+
+		void SetSampler(const RenderCommands::TextureSlot slot, const LeviathanRenderer::RendererResourceId::IdType samplerId)
+		{
+			SamplerTable[static_cast<size_t>(slot)] = samplerId;
+		}
+
+		void UpdateConstantBuffer(const RenderCommands::ConstantBuffer buffer, const void* data, const uint32_t byteWidth)
+		{
+			Current.ConstantBuffers[static_cast<size_t>(buffer)] = RenderCommands::HashConstantBufferData(data, byteWidth);
+		}
+
+		// Ranges are tagged with the top bit to tell them apart from content hashes.
+		void SetConstantBufferRange(const RenderCommands::ConstantBuffer buffer, const uint32_t offset, const uint32_t byteWidth)
+		{
+			Current.ConstantBuffers[static_cast<size_t>(buffer)] = (1ull << 63) | (static_cast<uint64_t>(offset) << 32) | byteWidth;
+		}
+
+		void DrawIndexed(const uint32_t indexCount, uint32_t, const LeviathanRenderer::RendererResourceId::IdType vertexBufferId,
+			const LeviathanRenderer::RendererResourceId::IdType indexBufferId)
+		{
+			Current.IndexCount = indexCount;
+			Current.VertexBuffer = vertexBufferId;
+			Current.IndexBuffer = indexBufferId;
+			Current.InstanceCount = 0;
+			Current.FirstInstance = 0;
+			Draws.push_back(Current);
+		}
+
+		void DrawIndexedInstanced(const uint32_t indexCount, uint32_t, const LeviathanRenderer::RendererResourceId::IdType vertexBufferId,
+			const LeviathanRenderer::RendererResourceId::IdType indexBufferId, const uint32_t instanceCount, const uint32_t firstInstance)
+		{
+			Current.IndexCount = indexCount;
+			Current.VertexBuffer = vertexBufferId;
+			Current.IndexBuffer = indexBufferId;
+			Current.InstanceCount = instanceCount;
+			Current.FirstInstance = firstInstance;
+			Draws.push_back(Current);
+		}
+
+		void UnbindShaderResources() { Current.BoundTextures[0] = LeviathanRenderer::RendererResourceId::InvalidId; }
+	};
+
+	static size_t CountDrawStateMismatches(const std::vector<StateModelBackend::DrawState>& a, const std::vector<StateModelBackend::DrawState>& b)
+	{
+		size_t mismatches = (a.size() > b.size()) ? (a.size() - b.size()) : (b.size() - a.size());
+		for (size_t i = 0; i < std::min(a.size(), b.size()); ++i)
+		{
+			mismatches += (a[i] == b[i]) ? 0 : 1;
+		}
+		return mismatches;
+	}
+
+	static void RecordLightingFrame(RenderCommands::CommandBuffer& commands, const std::vector<Draw>& objects)
+	{
+		static constexpr float clearColor[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		static constexpr LeviathanRenderer::RendererResourceId::IdType skyboxTexture = 900;
+		static constexpr LeviathanRenderer::RendererResourceId::IdType skyboxSampler = 901;
+		static constexpr LeviathanRenderer::RendererResourceId::IdType materialSampler = 902;
+
+		// Lighting pipelines are set per draw after the material's textures with the material's permutation as by the renderer.
+		const auto recordObjectLightingDraw = [&commands](const RenderCommands::Pipeline pipeline, const Draw& object)
+			{
+				const bool normalMapping = (object.NormalTexture != LeviathanRenderer::RendererResourceId::InvalidId);
+				commands.SetTexture(RenderCommands::TextureSlot::Color, object.ColorTexture);
+				commands.SetTexture(RenderCommands::TextureSlot::Metallic, object.ColorTexture + 1000);
+				commands.SetTexture(RenderCommands::TextureSlot::Roughness, object.ColorTexture + 2000);
+				commands.SetSampler(RenderCommands::TextureSlot::Color, materialSampler);
+				commands.SetSampler(RenderCommands::TextureSlot::Roughness, materialSampler);
+				commands.SetSampler(RenderCommands::TextureSlot::Metallic, materialSampler);
+				if (normalMapping)
+				{
+					commands.SetTexture(RenderCommands::TextureSlot::Normal, object.NormalTexture);
+					commands.SetSampler(RenderCommands::TextureSlot::Normal, materialSampler);
+				}
+				commands.SetPipeline(pipeline, normalMapping ? LeviathanRenderer::RendererConstants::NormalMappedLightingPermutation : 0);
+				commands.UpdateConstantBuffer(RenderCommands::ConstantBuffer::Object, object.ObjectData.data(), static_cast<uint32_t>(sizeof(object.ObjectData)));
+				commands.DrawIndexed(object.IndexCount, 44, object.VertexBuffer, object.IndexBuffer);
+			};
+
+		const auto recordLightPass = [&](const uint8_t pass, const RenderCommands::Pipeline pipeline, const RenderCommands::ConstantBuffer lightBuffer,
+			const size_t lightCount)
+			{
+				commands.BeginPacket(RenderCommands::MakeSortKey(pass, 0, 0, 0));
+				commands.SetDepthStencilState(RenderCommands::DepthStencilState::NoWriteDepthDepthFuncEqual);
+				commands.SetBlendState(RenderCommands::BlendState::Additive);
+				for (size_t light = 0; light < lightCount; ++light)
+				{
+					std::array<float, 16> lightData = {};
+					lightData[0] = static_cast<float>(light);
+					lightData[1] = static_cast<float>(pass);
+					commands.UpdateConstantBuffer(lightBuffer, lightData.data(), static_cast<uint32_t>(sizeof(lightData)));
+					for (const Draw& object : objects)
+					{
+						recordObjectLightingDraw(pipeline, object);
+					}
+				}
+			};
+
+		commands.Reset();
+		commands.BeginPacket(RenderCommands::MakeSortKey(0, 0, 0, 0));
+		commands.ClearRenderTarget(RenderCommands::RenderTarget::Screen, clearColor);
+		commands.ClearRenderTarget(RenderCommands::RenderTarget::Scene, clearColor);
+		commands.ClearDepthStencil(1.0f, 0);
+		commands.SetRenderTarget(RenderCommands::RenderTarget::Scene);
+
+		commands.BeginPacket(RenderCommands::MakeSortKey(1, 0, 0, 0));
+		commands.SetBlendState(RenderCommands::BlendState::Disabled);
+		commands.SetDepthStencilState(RenderCommands::DepthStencilState::WriteDepthDepthFuncLess);
+		commands.SetPipeline(RenderCommands::Pipeline::AmbientLight);
+		for (const Draw& object : objects)
+		{
+			commands.SetTexture(RenderCommands::TextureSlot::Environment, skyboxTexture);
+			commands.SetSampler(RenderCommands::TextureSlot::Environment, skyboxSampler);
+			commands.SetTexture(RenderCommands::TextureSlot::Color, object.ColorTexture);
+			commands.SetSampler(RenderCommands::TextureSlot::Color, materialSampler);
+			commands.UpdateConstantBuffer(RenderCommands::ConstantBuffer::Object, object.ObjectData.data(), static_cast<uint32_t>(sizeof(object.ObjectData)));
+			commands.DrawIndexed(object.IndexCount, 44, object.VertexBuffer, object.IndexBuffer);
+		}
+
+		recordLightPass(2, RenderCommands::Pipeline::DirectionalLight, RenderCommands::ConstantBuffer::DirectionalLight, FrameDirectionalLightCount);
+		recordLightPass(3, RenderCommands::Pipeline::PointLight, RenderCommands::ConstantBuffer::PointLight, FramePointLightCount);
+		recordLightPass(4, RenderCommands::Pipeline::SpotLight, RenderCommands::ConstantBuffer::SpotLight, FrameSpotLightCount);
+
+		commands.BeginPacket(RenderCommands::MakeSortKey(5, 0, 0, 0));
+		commands.SetBlendState(RenderCommands::BlendState::Disabled);
+		commands.SetDepthStencilState(RenderCommands::DepthStencilState::WriteDepthDepthFuncLessEqual);
+		commands.SetSkyboxPipeline(skyboxTexture, skyboxSampler);
+		std::array<float, 16> skyboxData = {};
+		commands.UpdateConstantBuffer(RenderCommands::ConstantBuffer::Skybox, skyboxData.data(), static_cast<uint32_t>(sizeof(skyboxData)));
+		commands.DrawIndexed(36, 12, 800, 801);
+
+		commands.BeginPacket(RenderCommands::MakeSortKey(6, 0, 0, 0));
+		commands.SetBlendState(RenderCommands::BlendState::Disabled);
+		commands.SetDepthStencilState(RenderCommands::DepthStencilState::Disabled);
+		commands.SetRenderTarget(RenderCommands::RenderTarget::Screen);
+		commands.SetPipeline(RenderCommands::Pipeline::PostProcess);
+		commands.DrawIndexed(6, 16, 802, 803);
+		commands.UnbindShaderResources();
+	}
+
+	// Random command stream over few distinct values so that most state changes are redundant.
+	static void RecordRandomStream(RenderCommands::CommandBuffer& commands, std::mt19937& random)
+	{
+		std::uniform_int_distribution<uint32_t> commandDistribution(0, static_cast<uint32_t>(RenderCommands::CommandTypeCount) - 1);
+		std::uniform_int_distribution<uint32_t> valueDistribution(0, 2);
+		std::array<float, 4> data = {};
+
+		commands.Reset();
+		for (size_t i = 0; i < RandomStreamCommandCount; ++i)
+		{
+			const uint32_t value = valueDistribution(random);
+			switch (static_cast<RenderCommands::CommandType>(commandDistribution(random)))
+			{
+			case RenderCommands::CommandType::ClearRenderTarget: commands.ClearRenderTarget(RenderCommands::RenderTarget::Scene, data.data()); break;
+			case RenderCommands::CommandType::ClearDepthStencil: commands.ClearDepthStencil(1.0f, 0); break;
+			case RenderCommands::CommandType::SetRenderTarget: commands.SetRenderTarget(static_cast<RenderCommands::RenderTarget>(value % 2)); break;
+			case RenderCommands::CommandType::SetPipeline: commands.SetPipeline(static_cast<RenderCommands::Pipeline>(value), value % 2); break;
+			case RenderCommands::CommandType::SetSkyboxPipeline: commands.SetSkyboxPipeline(10 + value, 20 + (value % 2)); break;
+			case RenderCommands::CommandType::SetBlendState: commands.SetBlendState(static_cast<RenderCommands::BlendState>(value % 2)); break;
+			case RenderCommands::CommandType::SetDepthStencilState: commands.SetDepthStencilState(static_cast<RenderCommands::DepthStencilState>(value)); break;
+			case RenderCommands::CommandType::SetTexture: commands.SetTexture(static_cast<RenderCommands::TextureSlot>(value), 30 + (value + i) % 3); break;
+			case RenderCommands::CommandType::SetSampler: commands.SetSampler(static_cast<RenderCommands::TextureSlot>(value), 40 + (i % 2)); break;
+			case RenderCommands::CommandType::UpdateConstantBuffer:
+				data[0] = static_cast<float>(value);
+				commands.UpdateConstantBuffer(static_cast<RenderCommands::ConstantBuffer>(i % RenderCommands::ConstantBufferCount), data.data(),
+					static_cast<uint32_t>(sizeof(data)));
+				break;
+			case RenderCommands::CommandType::SetConstantBufferRange:
+				commands.SetConstantBufferRange(static_cast<RenderCommands::ConstantBuffer>(i % RenderCommands::ConstantBufferCount), 256 * value, 64);
+				break;
+			case RenderCommands::CommandType::DrawIndexed: commands.DrawIndexed(36, 12, 50 + value, 60 + value); break;
+			case RenderCommands::CommandType::DrawIndexedInstanced: commands.DrawIndexedInstanced(36, 12, 50 + value, 60 + value, 1 + value, static_cast<uint32_t>(i)); break;
+			case RenderCommands::CommandType::UnbindShaderResources: commands.UnbindShaderResources(); break;
+			}
+		}
+	}
+
+	// Executing a sorted queue must issue the same calls in the same order as executing every draw on its own in sort key order.
+	static void RunCommandQueueTests(Tester& tester, const std::string_view threadingName, const std::vector<Draw>& draws,
+		const std::vector<RecordingBackend::Call>& referenceCalls)
+	{
+		tester.Run("RenderCommands.CommandQueue.ExecuteMatchesReference." + std::string(threadingName), [&]()
+			{
+				RenderCommands::CommandQueue queue = {};
+				// Recording twice checks that resetting the queue drops the previous frame.
+				RecordDraws(queue, draws);
+				RecordDraws(queue, draws);
+				queue.Sort();
+
+				const std::vector<RenderCommands::CommandQueue::SortedPacket>& sorted = queue.GetSortedPackets();
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, sorted.size(), draws.size());
+				size_t unsortedPackets = 0;
+				for (size_t i = 1; i < sorted.size(); ++i)
+				{
+					unsortedPackets += (sorted[i].SortKey < sorted[i - 1].SortKey) ? 1 : 0;
+				}
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, unsortedPackets, 0);
+
+				RecordingBackend recordingBackend = {};
+				queue.Execute(recordingBackend);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, recordingBackend.Calls.size(), referenceCalls.size());
+				size_t mismatches = 0;
+				for (size_t i = 0; i < std::min(recordingBackend.Calls.size(), referenceCalls.size()); ++i)
+				{
+					mismatches += (recordingBackend.Calls[i] == referenceCalls[i]) ? 0 : 1;
+				}
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, mismatches, 0);
+			});
+	}
+
+	// Filtering must not change the state any draw is issued with.
+	static void RunLightingFrameTests(Tester& tester, const std::string_view objectsName, const std::vector<Draw>& draws, const size_t objectCount)
+	{
+		tester.Run("RenderCommands.StateFilter.LightingFrame." + std::string(objectsName), [&]()
+			{
+				// Objects of the lighting frame drawn in material order as they would be after sorting.
+				std::vector<Draw> objects(draws.begin(), draws.begin() + objectCount);
+				for (size_t i = 0; i < objects.size(); ++i)
+				{
+					objects[i].ColorTexture = 2 * (1 + (i * FrameMaterialCount) / objects.size());
+					// Every fourth material has no normal texture and draws with the lighting permutation without normal mapping.
+					objects[i].NormalTexture = ((objects[i].ColorTexture % 8) == 0) ? LeviathanRenderer::RendererResourceId::InvalidId : objects[i].ColorTexture + 1;
+				}
+				RenderCommands::CommandBuffer frame = {};
+				RecordLightingFrame(frame, objects);
+
+				StateModelBackend directModel = {};
+				StateModelBackend filteredModel = {};
+				RenderCommands::StateFilteringBackend<StateModelBackend> filteringModel(filteredModel);
+				frame.Execute(directModel);
+				frame.Execute(filteringModel);
+
+				const size_t frameDrawCount = objectCount * (1 + FrameDirectionalLightCount + FramePointLightCount + FrameSpotLightCount) + 2;
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, directModel.Draws.size(), frameDrawCount);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountDrawStateMismatches(directModel.Draws, filteredModel.Draws), 0);
+
+				// Every object after the first of a material repeats its material's textures and samplers.
+				const RenderCommands::StateFilterStats& stats = filteringModel.GetStats();
+				LEVIATHAN_TEST_CHECK(tester, stats.ElidedCalls[static_cast<size_t>(RenderCommands::CommandType::SetSampler)] > 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, stats.IssuedCalls[static_cast<size_t>(RenderCommands::CommandType::DrawIndexed)], frameDrawCount);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, stats.ElidedCalls[static_cast<size_t>(RenderCommands::CommandType::DrawIndexed)], 0);
+			});
+	}
+
+	void RunRenderCommandTests(Tester& tester)
+	{
+		const std::vector<Draw> draws = CreateDraws();
+
+		// Reference call stream from recording the draws one at a time in sort key order.
+		std::vector<size_t> sortedDraws(draws.size());
+		std::iota(sortedDraws.begin(), sortedDraws.end(), static_cast<size_t>(0));
+		std::stable_sort(sortedDraws.begin(), sortedDraws.end(), [&draws](const size_t a, const size_t b) { return draws[a].SortKey < draws[b].SortKey; });
+		RecordingBackend referenceBackend = {};
+		RenderCommands::CommandBuffer referenceCommands = {};
+		for (const size_t drawIndex : sortedDraws)
+		{
+			referenceCommands.Reset();
+			RecordDraw(referenceCommands, draws[drawIndex]);
+			referenceCommands.Execute(referenceBackend);
+		}
+
+		LeviathanTestFixtures::RunSingleThreadAndJobSystem(JobSystemWorkerCount, [&](const std::string_view threadingName)
+			{
+				RunCommandQueueTests(tester, threadingName, draws, referenceBackend.Calls);
+			});
+
+		// A single object matches the scene LeviathanRenderer::Render draws without a level.
+		RunLightingFrameTests(tester, "1Object", draws, 1);
+		RunLightingFrameTests(tester, "64Objects", draws, FrameObjectCount);
+
+		// Random stream with frequent redundant and interleaved state changes.
+		tester.Run("RenderCommands.StateFilter.RandomStream", [&]()
+			{
+				std::mt19937 random(97531);
+				RenderCommands::CommandBuffer randomStream = {};
+				RecordRandomStream(randomStream, random);
+
+				StateModelBackend directModel = {};
+				StateModelBackend filteredModel = {};
+				RenderCommands::StateFilteringBackend<StateModelBackend> filteringModel(filteredModel);
+				randomStream.Execute(directModel);
+				randomStream.Execute(filteringModel);
+				LEVIATHAN_TEST_CHECK(tester, filteringModel.GetStats().GetElidedCallCount() > 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountDrawStateMismatches(directModel.Draws, filteredModel.Draws), 0);
+			});
+	}
+}
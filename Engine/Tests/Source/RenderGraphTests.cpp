@@ -0,0 +1,381 @@
+#include "TestSuites.h"
+#include "Test.h"
+#include "RenderGraph.h"
+
+namespace LeviathanTests
+{
+	static constexpr uint32_t FrameWidth = 1920;
+	static constexpr uint32_t FrameHeight = 1080;
+	static constexpr size_t ShadowCascadeCount = 4;
+	static constexpr size_t HierarchicalDepthLevelCount = 8;
+	static constexpr size_t TransparentPassCount = 37;
+	static constexpr size_t BloomLevelCount = 6;
+	static constexpr size_t ExposureLevelCount = 6;
+	static constexpr size_t DebugViewCount = 12;
+
+	// Declares a deferred frame of 100 passes: shadow cascades, depth prepass, g-buffer, hierarchical depth, ambient occlusion, lighting,
+	// transparent passes blending into the lit scene, volumetric fog, reflections, bloom, temporal anti-aliasing, motion blur, depth of field,
+	// exposure, tone mapping, anti-aliasing and ui into the imported back buffer. Debug views write textures nothing reads and are culled.
+	// Graph is a RenderGraph or a RecordingGraph.
+	template<typename Graph>
+	static void DeclareDeferredFrame(Graph& graph)
+	{
+		using LeviathanRenderer::RenderGraphFormat;
+		using LeviathanRenderer::RenderGraphTextureDescription;
+		using ResourceHandle = decltype(graph.CreateTexture(RenderGraphTextureDescription{}));
+
+		const auto texture = [&graph](const uint32_t width, const uint32_t height, const RenderGraphFormat format)
+			{
+				return graph.CreateTexture(RenderGraphTextureDescription{ std::max(width, 1u), std::max(height, 1u), format });
+			};
+
+		graph.Reset();
+		const ResourceHandle backBuffer = graph.ImportTexture(RenderGraphTextureDescription{ FrameWidth, FrameHeight, RenderGraphFormat::R8G8B8A8Unorm });
+		const ResourceHandle history = graph.ImportTexture(RenderGraphTextureDescription{ FrameWidth, FrameHeight, RenderGraphFormat::R16G16B16A16Float });
+		graph.MarkOutput(backBuffer);
+		graph.MarkOutput(history);
+
+		std::array<ResourceHandle, ShadowCascadeCount> shadowMaps = {};
+		for (size_t cascade = 0; cascade < ShadowCascadeCount; ++cascade)
+		{
+			shadowMaps[cascade] = texture(2048, 2048, RenderGraphFormat::D24UnormS8Uint);
+			graph.AddPass();
+			graph.Write(shadowMaps[cascade]);
+		}
+
+		const ResourceHandle depth = texture(FrameWidth, FrameHeight, RenderGraphFormat::D24UnormS8Uint);
+		graph.AddPass();
+		graph.Write(depth);
+
+		const ResourceHandle albedo = texture(FrameWidth, FrameHeight, RenderGraphFormat::R8G8B8A8Unorm);
+		const ResourceHandle normals = texture(FrameWidth, FrameHeight, RenderGraphFormat::R16G16B16A16Float);
+		const ResourceHandle material = texture(FrameWidth, FrameHeight, RenderGraphFormat::R8G8B8A8Unorm);
+		const ResourceHandle velocity = texture(FrameWidth, FrameHeight, RenderGraphFormat::R16G16B16A16Float);
+		graph.AddPass();
+		graph.Read(depth);
+		graph.Write(depth);
+		graph.Write(albedo);
+		graph.Write(normals);
+		graph.Write(material);
+		graph.Write(velocity);
+
+		std::array<ResourceHandle, HierarchicalDepthLevelCount> depthLevels = {};
+		for (size_t level = 0; level < HierarchicalDepthLevelCount; ++level)
+		{
+			depthLevels[level] = texture((FrameWidth / 2) >> level, (FrameHeight / 2) >> level, RenderGraphFormat::R32Float);
+			graph.AddPass();
+			graph.Read((level == 0) ? depth : depthLevels[level - 1]);
+			graph.Write(depthLevels[level]);
+		}
+
+		const ResourceHandle occlusion = texture(FrameWidth, FrameHeight, RenderGraphFormat::R8Unorm);
+		const ResourceHandle occlusionBlurX = texture(FrameWidth, FrameHeight, RenderGraphFormat::R8Unorm);
+		const ResourceHandle occlusionBlurred = texture(FrameWidth, FrameHeight, RenderGraphFormat::R8Unorm);
+		graph.AddPass();
+		graph.Read(depthLevels[0]);
+		graph.Read(normals);
+		graph.Write(occlusion);
+		graph.AddPass();
+		graph.Read(occlusion);
+		graph.Write(occlusionBlurX);
+		graph.AddPass();
+		graph.Read(occlusionBlurX);
+		graph.Write(occlusionBlurred);
+
+		const ResourceHandle scene = texture(FrameWidth, FrameHeight, RenderGraphFormat::R16G16B16A16Float);
+		graph.AddPass();
+		graph.Read(depth);
+		graph.Read(albedo);
+		graph.Read(normals);
+		graph.Read(material);
+		graph.Read(occlusionBlurred);
+		for (const ResourceHandle shadowMap : shadowMaps)
+		{
+			graph.Read(shadowMap);
+		}
+		graph.Write(scene);
+
+		for (size_t pass = 0; pass < TransparentPassCount; ++pass)
+		{
+			graph.AddPass();
+			graph.Read(depth);
+			graph.Read(scene);
+			graph.Write(scene);
+		}
+
+		const ResourceHandle froxels = texture(160, 90 * 64, RenderGraphFormat::R16G16B16A16Float);
+		const ResourceHandle integratedFroxels = texture(160, 90 * 64, RenderGraphFormat::R16G16B16A16Float);
+		graph.AddPass();
+		graph.Read(shadowMaps[0]);
+		graph.Write(froxels);
+		graph.AddPass();
+		graph.Read(froxels);
+		graph.Write(integratedFroxels);
+		graph.AddPass();
+		graph.Read(integratedFroxels);
+		graph.Read(depth);
+		graph.Read(scene);
+		graph.Write(scene);
+
+		const ResourceHandle reflections = texture(FrameWidth / 2, FrameHeight / 2, RenderGraphFormat::R16G16B16A16Float);
+		graph.AddPass();
+		graph.Read(depthLevels[HierarchicalDepthLevelCount - 1]);
+		graph.Read(normals);
+		graph.Read(scene);
+		graph.Write(reflections);
+		graph.AddPass();
+		graph.Read(reflections);
+		graph.Read(material);
+		graph.Read(scene);
+		graph.Write(scene);
+
+		std::array<ResourceHandle, BloomLevelCount> bloomDown = {};
+		std::array<ResourceHandle, BloomLevelCount> bloomUp = {};
+		for (size_t level = 0; level < BloomLevelCount; ++level)
+		{
+			bloomDown[level] = texture((FrameWidth / 2) >> level, (FrameHeight / 2) >> level, RenderGraphFormat::R16G16B16A16Float);
+			graph.AddPass();
+			graph.Read((level == 0) ? scene : bloomDown[level - 1]);
+			graph.Write(bloomDown[level]);
+		}
+		for (size_t level = BloomLevelCount; level-- > 0;)
+		{
+			bloomUp[level] = texture((FrameWidth / 2) >> level, (FrameHeight / 2) >> level, RenderGraphFormat::R16G16B16A16Float);
+			graph.AddPass();
+			graph.Read(bloomDown[level]);
+			if (level + 1 < BloomLevelCount)
+			{
+				graph.Read(bloomUp[level + 1]);
+			}
+			graph.Write(bloomUp[level]);
+		}
+
+		const ResourceHandle antiAliased = texture(FrameWidth, FrameHeight, RenderGraphFormat::R16G16B16A16Float);
+		graph.AddPass();
+		graph.Read(scene);
+		graph.Read(velocity);
+		graph.Read(history);
+		graph.Write(antiAliased);
+		graph.Write(history);
+
+		const ResourceHandle motionTiles = texture(FrameWidth / 16, FrameHeight / 16, RenderGraphFormat::R16G16B16A16Float);
+		const ResourceHandle motionBlurred = texture(FrameWidth, FrameHeight, RenderGraphFormat::R16G16B16A16Float);
+		graph.AddPass();
+		graph.Read(velocity);
+		graph.Write(motionTiles);
+		graph.AddPass();
+		graph.Read(antiAliased);
+		graph.Read(motionTiles);
+		graph.Write(motionBlurred);
+
+		const ResourceHandle circleOfConfusion = texture(FrameWidth, FrameHeight, RenderGraphFormat::R8Unorm);
+		const ResourceHandle nearField = texture(FrameWidth / 2, FrameHeight / 2, RenderGraphFormat::R16G16B16A16Float);
+		const ResourceHandle farField = texture(FrameWidth / 2, FrameHeight / 2, RenderGraphFormat::R16G16B16A16Float);
+		const ResourceHandle focused = texture(FrameWidth, FrameHeight, RenderGraphFormat::R16G16B16A16Float);
+		graph.AddPass();
+		graph.Read(depth);
+		graph.Write(circleOfConfusion);
+		graph.AddPass();
+		graph.Read(motionBlurred);
+		graph.Read(circleOfConfusion);
+		graph.Write(nearField);
+		graph.AddPass();
+		graph.Read(motionBlurred);
+		graph.Read(circleOfConfusion);
+		graph.Write(farField);
+		graph.AddPass();
+		graph.Read(motionBlurred);
+		graph.Read(nearField);
+		graph.Read(farField);
+		graph.Write(focused);
+
+		ResourceHandle luminance = focused;
+		for (size_t level = 0; level < ExposureLevelCount; ++level)
+		{
+			const ResourceHandle nextLuminance = texture(64 >> level, 64 >> level, RenderGraphFormat::R32Float);
+			graph.AddPass();
+			graph.Read(luminance);
+			graph.Write(nextLuminance);
+			luminance = nextLuminance;
+		}
+
+		const ResourceHandle toneMapped = texture(FrameWidth, FrameHeight, RenderGraphFormat::R8G8B8A8Unorm);
+		graph.AddPass();
+		graph.Read(focused);
+		graph.Read(bloomUp[0]);
+		graph.Read(luminance);
+		graph.Write(toneMapped);
+
+		const ResourceHandle edgeAntiAliased = texture(FrameWidth, FrameHeight, RenderGraphFormat::R8G8B8A8Unorm);
+		graph.AddPass();
+		graph.Read(toneMapped);
+		graph.Write(edgeAntiAliased);
+
+		graph.AddPass();
+		graph.Read(edgeAntiAliased);
+		graph.Write(backBuffer);
+
+		// Debug views of intermediate results nothing presents.
+		const std::array<ResourceHandle, 6> debugSources = { albedo, normals, material, velocity, occlusionBlurred, reflections };
+		for (size_t view = 0; view < DebugViewCount; ++view)
+		{
+			const ResourceHandle debugView = texture(FrameWidth, FrameHeight, RenderGraphFormat::R8G8B8A8Unorm);
+			graph.AddPass();
+			graph.Read(debugSources[view % debugSources.size()]);
+			graph.Write(debugView);
+		}
+	}
+
+	// Records the declarations of a graph for the reference checks. Resource handles are assigned in the same order as by RenderGraph.
+	struct RecordingGraph
+	{
+		std::vector<std::vector<std::pair<uint32_t, bool>>> PassAccesses = {};
+		std::vector<uint32_t> Outputs = {};
+		uint32_t ResourceCount = 0;
+
+		void Reset() { *this = {}; }
+		uint32_t CreateTexture([[maybe_unused]] const LeviathanRenderer::RenderGraphTextureDescription& description) { return ResourceCount++; }
+		uint32_t ImportTexture([[maybe_unused]] const LeviathanRenderer::RenderGraphTextureDescription& description) { return ResourceCount++; }
+		void MarkOutput(const uint32_t resource) { Outputs.push_back(resource); }
+		uint32_t AddPass() { PassAccesses.emplace_back(); return static_cast<uint32_t>(PassAccesses.size() - 1); }
+		void Read(const uint32_t resource) { PassAccesses.back().emplace_back(resource, false); }
+		void Write(const uint32_t resource) { PassAccesses.back().emplace_back(resource, true); }
+	};
+
+	struct RenderGraphValidation
+	{
+		uint64_t CulledPassMismatches = 0;
+		uint64_t LifetimeErrors = 0;
+		uint64_t AliasConflicts = 0;
+		uint64_t Misaligned = 0;
+		uint64_t OutOfBounds = 0;
+		// Largest total size of the resources alive during one pass, the smallest heap any placement can reach.
+		uint64_t PeakLiveBytes = 0;
+	};
+
+	// Checks a compiled graph against its declarations. Reference culling links every read to the closest earlier writer and keeps the passes the
+	// outputs' last writers depend on. Every allocated resource must be alive during each surviving pass accessing it, and resources alive at the same
+	// time must not share memory.
+	static RenderGraphValidation ValidateRenderGraph(const LeviathanRenderer::RenderGraph& graph, const RecordingGraph& declarations)
+	{
+		using LeviathanRenderer::RenderGraph;
+
+		const std::vector<std::vector<std::pair<uint32_t, bool>>>& passAccesses = declarations.PassAccesses;
+		RenderGraphValidation validation = {};
+		const size_t passCount = passAccesses.size();
+		const size_t resourceCount = graph.GetResourceCount();
+
+		std::vector<std::vector<uint32_t>> dependencies(passCount);
+		std::vector<uint32_t> lastWriter(resourceCount, RenderGraph::InvalidPass);
+		for (uint32_t pass = 0; pass < passCount; ++pass)
+		{
+			for (const auto& [resource, write] : passAccesses[pass])
+			{
+				if (!write && (lastWriter[resource] != RenderGraph::InvalidPass))
+				{
+					dependencies[pass].push_back(lastWriter[resource]);
+				}
+			}
+			for (const auto& [resource, write] : passAccesses[pass])
+			{
+				if (write)
+				{
+					lastWriter[resource] = pass;
+				}
+			}
+		}
+		std::vector<uint8_t> live(passCount, 0);
+		std::vector<uint32_t> stack = {};
+		for (const uint32_t output : declarations.Outputs)
+		{
+			if (lastWriter[output] != RenderGraph::InvalidPass)
+			{
+				stack.push_back(lastWriter[output]);
+			}
+		}
+		while (!stack.empty())
+		{
+			const uint32_t pass = stack.back();
+			stack.pop_back();
+			if (live[pass] != 0)
+			{
+				continue;
+			}
+			live[pass] = 1;
+			stack.insert(stack.end(), dependencies[pass].begin(), dependencies[pass].end());
+		}
+		for (uint32_t pass = 0; pass < passCount; ++pass)
+		{
+			validation.CulledPassMismatches += ((live[pass] != 0) == graph.IsPassCulled(pass)) ? 1 : 0;
+		}
+
+		for (size_t compiledPass = 0; compiledPass < graph.GetCompiledPassCount(); ++compiledPass)
+		{
+			for (const auto& [resource, write] : passAccesses[graph.GetCompiledPasses()[compiledPass]])
+			{
+				if (graph.IsImported(resource))
+				{
+					continue;
+				}
+				validation.LifetimeErrors += (!graph.IsAllocated(resource) || (graph.GetFirstUse(resource) > compiledPass) || (graph.GetLastUse(resource) < compiledPass)) ? 1 : 0;
+			}
+		}
+
+		std::vector<uint64_t> liveBytes(graph.GetCompiledPassCount(), 0);
+		for (RenderGraph::ResourceHandle a = 0; a < resourceCount; ++a)
+		{
+			if (graph.IsImported(a) || !graph.IsAllocated(a))
+			{
+				continue;
+			}
+			for (uint32_t compiledPass = graph.GetFirstUse(a); compiledPass <= graph.GetLastUse(a); ++compiledPass)
+			{
+				liveBytes[compiledPass] += graph.GetSizeBytes(a);
+			}
+			validation.Misaligned += ((graph.GetHeapOffset(a) % RenderGraph::PlacementAlignmentBytes) != 0) ? 1 : 0;
+			validation.OutOfBounds += (graph.GetHeapOffset(a) + graph.GetSizeBytes(a) > graph.GetHeapSizeBytes()) ? 1 : 0;
+			for (RenderGraph::ResourceHandle b = a + 1; b < resourceCount; ++b)
+			{
+				if (graph.IsImported(b) || !graph.IsAllocated(b))
+				{
+					continue;
+				}
+				const bool aliveTogether = (graph.GetFirstUse(a) <= graph.GetLastUse(b)) && (graph.GetFirstUse(b) <= graph.GetLastUse(a));
+				const bool shareMemory = (graph.GetHeapOffset(a) < graph.GetHeapOffset(b) + graph.GetSizeBytes(b)) &&
+					(graph.GetHeapOffset(b) < graph.GetHeapOffset(a) + graph.GetSizeBytes(a));
+				validation.AliasConflicts += (aliveTogether && shareMemory) ? 1 : 0;
+			}
+		}
+		validation.PeakLiveBytes = liveBytes.empty() ? 0 : *std::max_element(liveBytes.begin(), liveBytes.end());
+		return validation;
+	}
+
+	void RunRenderGraphTests(Tester& tester)
+	{
+		tester.Run("RenderGraph.Compile.DeferredFrame", [&]()
+			{
+				LeviathanRenderer::RenderGraph graph = {};
+				// Declaring and compiling twice checks that reusing the graph's memory does not leak the previous frame.
+				DeclareDeferredFrame(graph);
+				LEVIATHAN_TEST_CHECK(tester, graph.Compile());
+				DeclareDeferredFrame(graph);
+				LEVIATHAN_TEST_CHECK(tester, graph.Compile());
+
+				RecordingGraph declarations = {};
+				DeclareDeferredFrame(declarations);
+				const RenderGraphValidation validation = ValidateRenderGraph(graph, declarations);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, validation.CulledPassMismatches, 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, validation.LifetimeErrors, 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, validation.AliasConflicts, 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, validation.Misaligned, 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, validation.OutOfBounds, 0);
+
+				// Debug views are culled and aliasing places the transient resources in less memory than their total size.
+				const LeviathanRenderer::RenderGraphStats& stats = graph.GetStats();
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, stats.PassCount, declarations.PassAccesses.size());
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, stats.CulledPassCount, DebugViewCount);
+				LEVIATHAN_TEST_CHECK(tester, stats.HeapBytes < stats.TransientBytes);
+				LEVIATHAN_TEST_CHECK(tester, stats.HeapBytes >= validation.PeakLiveBytes);
+			});
+	}
+}
@@ -0,0 +1,202 @@
+#include "TestSuites.h"
+#include "Test.h"
+#include "TestFixtures.h"
+#include "MathTypes.h"
+#include "Camera.h"
+#include "VisibilityCulling.h"
+#include "RenderWorld.h"
+
+namespace LeviathanTests
+{
+	static constexpr size_t WorldRenderableCount = 20000;
+	static constexpr size_t WorldChangedCount = WorldRenderableCount / 100;
+	static constexpr size_t WorldDestroyedCount = WorldRenderableCount / 10;
+	static constexpr size_t WorldMeshCount = 16;
+	static constexpr size_t WorldMaterialCount = 64;
+	static constexpr float WorldHalfSize = 400.0f;
+	static constexpr float MaxObjectDataError = 1e-3f;
+	static constexpr size_t JobSystemWorkerCount = 3;
+
+	static LeviathanCore::MathTypes::Matrix4x4 RandomTransform(std::mt19937& random)
+	{
+		std::uniform_real_distribution<float> positionDistribution(-WorldHalfSize, WorldHalfSize);
+		std::uniform_real_distribution<float> angleDistribution(-3.14159265f, 3.14159265f);
+		return LeviathanCore::MathTypes::Matrix4x4::Translation(
+			LeviathanCore::MathTypes::Vector3(positionDistribution(random), positionDistribution(random), positionDistribution(random))) *
+			LeviathanCore::MathTypes::Matrix4x4::Rotation(LeviathanCore::MathTypes::Quaternion(LeviathanCore::MathTypes::Euler(0.0f, angleDistribution(random), 0.0f)));
+	}
+
+	static LeviathanRenderer::RenderableDescription RandomRenderable(std::mt19937& random)
+	{
+		std::uniform_int_distribution<uint32_t> meshDistribution(1, WorldMeshCount);
+		std::uniform_int_distribution<uint32_t> materialDistribution(1, WorldMaterialCount);
+		std::uniform_real_distribution<float> sizeDistribution(0.25f, 4.0f);
+
+		const uint32_t mesh = meshDistribution(random);
+		const uint32_t material = materialDistribution(random);
+		const float size = sizeDistribution(random);
+
+		LeviathanRenderer::RenderableDescription description = {};
+		description.Mesh.VertexBuffer = mesh;
+		description.Mesh.IndexBuffer = 1000 + mesh;
+		description.Mesh.IndexCount = 36 * mesh;
+		description.Mesh.VertexStrideBytes = 44;
+		description.Mesh.LocalBounds = LeviathanCore::BoundingVolumes::AABB{ LeviathanCore::MathTypes::Vector3(-size, -size, -size),
+			LeviathanCore::MathTypes::Vector3(size, size, size) };
+		description.Material.ColorTexture = 2000 + material;
+		description.Material.MetallicTexture = 3000 + material;
+		description.Material.RoughnessTexture = 4000 + material;
+		description.Material.NormalTexture = 5000 + material;
+		description.Material.Sampler = 1;
+		description.Transform = RandomTransform(random);
+		return description;
+	}
+
+	// Camera at the origin looking down +z.
+	static LeviathanRenderer::Camera MakeCamera()
+	{
+		LeviathanRenderer::Camera camera = {};
+		camera.UpdateViewMatrix();
+		camera.UpdateProjectionMatrix(1920, 1080);
+		camera.UpdateViewProjectionMatrix();
+		return camera;
+	}
+
+	// Counts renderables whose world bounds or world matrix are not the ones expected for their id.
+	static size_t CountWorldMismatches(const LeviathanRenderer::RenderWorld& world, const std::vector<LeviathanRenderer::RenderableDescription>& expected)
+	{
+		size_t mismatches = 0;
+		for (size_t index = 0; index < world.GetCount(); ++index)
+		{
+			const LeviathanRenderer::RenderableId renderable = world.GetRenderableId(index);
+			const LeviathanRenderer::RenderableDescription& description = expected[renderable];
+			const LeviathanCore::BoundingVolumes::AABB expectedBounds = description.Mesh.LocalBounds.Transformed(description.Transform);
+			const LeviathanCore::BoundingVolumes::AABB bounds = LeviathanCore::BoundingVolumes::AABB{
+				LeviathanCore::MathTypes::Vector3(world.GetWorldBounds().MinX[index], world.GetWorldBounds().MinY[index], world.GetWorldBounds().MinZ[index]),
+				LeviathanCore::MathTypes::Vector3(world.GetWorldBounds().MaxX[index], world.GetWorldBounds().MaxY[index], world.GetWorldBounds().MaxZ[index]) };
+
+			const bool boundsMatch = (bounds.Min.X() == expectedBounds.Min.X()) && (bounds.Min.Y() == expectedBounds.Min.Y()) &&
+				(bounds.Min.Z() == expectedBounds.Min.Z()) && (bounds.Max.X() == expectedBounds.Max.X()) && (bounds.Max.Y() == expectedBounds.Max.Y()) &&
+				(bounds.Max.Z() == expectedBounds.Max.Z());
+			const bool transformMatch = (memcmp(world.GetWorldMatrix(index).Data(), description.Transform.Data(), sizeof(float) * 16) == 0);
+			const bool meshMatch = (world.GetMesh(index).VertexBuffer == description.Mesh.VertexBuffer);
+			mismatches += (boundsMatch && transformMatch && meshMatch) ? 0 : 1;
+		}
+		return mismatches;
+	}
+
+	// Counts draws that are missing, not visible, out of order or whose object data differs from Matrix4x4 products.
+	static size_t CountDrawListMismatches(const LeviathanRenderer::RenderWorld& world, const LeviathanRenderer::Camera& camera,
+		const LeviathanRenderer::DrawList& drawList)
+	{
+		const LeviathanCore::BoundingVolumes::Frustum frustum = camera.GetFrustum();
+		const LeviathanCore::BoundingVolumes::AABBSoA bounds = world.GetWorldBounds();
+
+		size_t expectedCount = 0;
+		for (size_t index = 0; index < world.GetCount(); ++index)
+		{
+			const LeviathanCore::BoundingVolumes::AABB aabb = LeviathanCore::BoundingVolumes::AABB{
+				LeviathanCore::MathTypes::Vector3(bounds.MinX[index], bounds.MinY[index], bounds.MinZ[index]),
+				LeviathanCore::MathTypes::Vector3(bounds.MaxX[index], bounds.MaxY[index], bounds.MaxZ[index]) };
+			expectedCount += frustum.Intersects(aabb) ? 1 : 0;
+		}
+
+		size_t mismatches = (expectedCount > drawList.GetCount()) ? (expectedCount - drawList.GetCount()) : (drawList.GetCount() - expectedCount);
+		std::vector<uint8_t> drawn(world.GetCount(), 0);
+		for (size_t i = 0; i < drawList.GetCount(); ++i)
+		{
+			const uint32_t index = drawList.Renderables[i];
+			mismatches += (drawn[index] != 0) ? 1 : 0;
+			drawn[index] = 1;
+
+			if (i > 0)
+			{
+				mismatches += (drawList.SortKeys[i] < drawList.SortKeys[i - 1]) ? 1 : 0;
+			}
+
+			const LeviathanCore::MathTypes::Matrix4x4 expected = camera.GetViewProjectionMatrix() * world.GetWorldMatrix(index);
+			float maxError = 0.0f;
+			for (size_t element = 0; element < 16; ++element)
+			{
+				maxError = std::max(maxError, std::fabs(expected.Data()[element] - drawList.ObjectData[i].WorldViewProjectionMatrix[element]));
+			}
+			mismatches += (maxError > MaxObjectDataError) ? 1 : 0;
+		}
+		return mismatches;
+	}
+
+	static void RunDrawListTests(Tester& tester, const std::string_view threadingName, const LeviathanRenderer::RenderWorld& world,
+		const LeviathanRenderer::Camera& camera)
+	{
+		tester.Run("RenderWorld.BuildDrawList." + std::string(threadingName), [&]()
+			{
+				LeviathanRenderer::FrustumCullingStage cullingStage = {};
+				LeviathanRenderer::DrawList drawList = {};
+				// Building twice checks that the retained draw list is reset.
+				LeviathanRenderer::BuildDrawList(world, camera, cullingStage, drawList);
+				LeviathanRenderer::BuildDrawList(world, camera, cullingStage, drawList);
+				LEVIATHAN_TEST_CHECK(tester, drawList.GetCount() > 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountDrawListMismatches(world, camera, drawList), 0);
+			});
+	}
+
+	void RunRenderWorldTests(Tester& tester)
+	{
+		std::mt19937 random(8642);
+		std::vector<LeviathanRenderer::RenderableDescription> descriptions(WorldRenderableCount);
+		for (LeviathanRenderer::RenderableDescription& description : descriptions)
+		{
+			description = RandomRenderable(random);
+		}
+
+		// Expected description of every renderable id.
+		LeviathanRenderer::RenderWorld world = {};
+		std::vector<LeviathanRenderer::RenderableDescription> expected(WorldRenderableCount);
+		std::vector<LeviathanRenderer::RenderableId> renderables(WorldRenderableCount);
+		for (size_t i = 0; i < descriptions.size(); ++i)
+		{
+			renderables[i] = world.Create(descriptions[i]);
+			expected[renderables[i]] = descriptions[i];
+		}
+
+		tester.Run("RenderWorld.Create", [&]()
+			{
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, world.GetCount(), WorldRenderableCount);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountWorldMismatches(world, expected), 0);
+			});
+
+		tester.Run("RenderWorld.SetTransform", [&]()
+			{
+				std::uniform_int_distribution<size_t> renderableDistribution(0, WorldRenderableCount - 1);
+				for (size_t i = 0; i < WorldChangedCount; ++i)
+				{
+					const size_t slot = renderableDistribution(random);
+					const LeviathanCore::MathTypes::Matrix4x4 transform = RandomTransform(random);
+					world.SetTransform(renderables[slot], transform);
+					expected[renderables[slot]].Transform = transform;
+				}
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountWorldMismatches(world, expected), 0);
+			});
+
+		// Destroying renderables moves others in storage. Ids must keep referring to the same renderable data.
+		tester.Run("RenderWorld.DestroyCreate", [&]()
+			{
+				for (size_t i = 0; i < WorldDestroyedCount; ++i)
+				{
+					const size_t slot = (i * 7919) % WorldRenderableCount;
+					world.Destroy(renderables[slot]);
+					renderables[slot] = world.Create(descriptions[slot]);
+					expected[renderables[slot]] = descriptions[slot];
+				}
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, world.GetCount(), WorldRenderableCount);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountWorldMismatches(world, expected), 0);
+			});
+
+		const LeviathanRenderer::Camera camera = MakeCamera();
+
+		LeviathanTestFixtures::RunSingleThreadAndJobSystem(JobSystemWorkerCount, [&](const std::string_view threadingName)
+			{
+				RunDrawListTests(tester, threadingName, world, camera);
+			});
+	}
+}
@@ -0,0 +1,352 @@
+#include "TestSuites.h"
+#include "Test.h"
+#include "ShaderCache.h"
+#include "JobSystem.h"
+#include "Serialize.h"
+
+namespace LeviathanTests
+{
+	static constexpr size_t MaterialCount = 128;
+	// Every fourth material is unlit and does not include the lighting header.
+	static constexpr size_t UnlitMaterialInterval = 4;
+	static constexpr size_t JobSystemWorkerCount = 3;
+
+	static constexpr std::string_view MathFile = "Shaders/Common/Math.hlsl";
+	static constexpr std::string_view LightingFile = "Shaders/Common/Lighting.hlsl";
+	static constexpr std::string_view SkinningFile = "Shaders/Common/Animation/Skinning.hlsl";
+
+	// Shader sources held in memory in place of files on disk.
+	struct VirtualShaderFiles
+	{
+		std::unordered_map<std::string, std::string> Files = {};
+	};
+
+	static bool ReadVirtualShaderFile(const std::string_view file, std::string& outSource, void* const userData)
+	{
+		const VirtualShaderFiles& files = *static_cast<const VirtualShaderFiles*>(userData);
+		const auto found = files.Files.find(std::string(file));
+		if (found == files.Files.end())
+		{
+			return false;
+		}
+		outSource = found->second;
+		return true;
+	}
+
+	// Stands in for the shader compiler. Bytecode is the target, entry point, macros and source so that stale bytecode is detected by comparing it to
+	// the bytecode of the current inputs.
+	static void MakeFakeBytecode(const LeviathanRenderer::ShaderCompileDescription& description, const std::string_view source, std::vector<uint8_t>& outBytecode)
+	{
+		std::string bytecode(description.Target);
+		bytecode.append(description.EntryPoint);
+		for (size_t i = 0; i < description.MacroCount; ++i)
+		{
+			bytecode.append(description.Macros[i].Name).append("=").append(description.Macros[i].Definition).append(";");
+		}
+		bytecode.append(source);
+		outBytecode.assign(bytecode.begin(), bytecode.end());
+	}
+
+	static bool FakeCompile(const LeviathanRenderer::ShaderCompileDescription& description, const std::string_view source, std::vector<uint8_t>& outBytecode,
+		void* const userData)
+	{
+		std::atomic<size_t>& compileCount = *static_cast<std::atomic<size_t>*>(userData);
+		++compileCount;
+		MakeFakeBytecode(description, source, outBytecode);
+		return true;
+	}
+
+	static std::string MakeMaterialFile(const size_t material, const bool pixelShader)
+	{
+		return "Shaders/Materials/Material" + std::to_string(material) + (pixelShader ? "PixelShader.hlsl" : "VertexShader.hlsl");
+	}
+
+	static bool IsLitMaterial(const size_t material)
+	{
+		return (material % UnlitMaterialInterval) != (UnlitMaterialInterval - 1);
+	}
+
+	// Shared headers included through relative paths and a vertex and pixel shader per material. Odd materials are skinned. Includes inside comments
+	// name files that do not exist so that treating them as dependencies fails to read them.
+	static void MakeShaderFiles(VirtualShaderFiles& files)
+	{
+		files.Files.clear();
+		files.Files[std::string(MathFile)] = "#ifndef MATH_HLSL\n#define MATH_HLSL\nstatic const float Pi = 3.14159265f;\nfloat Square(float x) { return x * x; }\n#endif\n";
+		files.Files[std::string(LightingFile)] =
+			"#ifndef LIGHTING_HLSL\n#define LIGHTING_HLSL\n#include \"Math.hlsl\"\n"
+			"// #include \"CommentedLine.hlsl\"\n"
+			"float3 Lambert(float3 albedo) { return albedo / Pi; }\n#endif\n";
+		files.Files[std::string(SkinningFile)] =
+			"  #  include \"../Math.hlsl\"\n"
+			"/* Skinning matrices.\n#include \"CommentedBlock.hlsl\"\n*/\n"
+			"float4x4 Skin(float4x4 bones[4], float4 weights) { return bones[0] * weights.x; }\n";
+
+		for (size_t material = 0; material < MaterialCount; ++material)
+		{
+			std::string vertexShader = "#include \"../Common/Math.hlsl\"\n";
+			if ((material % 2) == 1)
+			{
+				vertexShader += "#include <../Common/Animation/Skinning.hlsl>\n";
+			}
+			vertexShader += "float4 main(float3 position : POSITION) : SV_POSITION { return float4(position * " + std::to_string(material) + ".0f, 1.0f); }\n";
+			files.Files[MakeMaterialFile(material, false)] = std::move(vertexShader);
+
+			// A comment marker inside a string literal does not hide the include after it.
+			std::string pixelShader = "static const char* Name = \"/* not a comment\";\n";
+			pixelShader += IsLitMaterial(material) ? "#include \"..\\Common\\.\\Lighting.hlsl\"\n" : "#include \"../Common/Math.hlsl\"\n";
+			pixelShader += "float4 main() : SV_TARGET { return float4(" + std::to_string(material) + ".0f, 0.0f, 0.0f, 1.0f); }\n";
+			files.Files[MakeMaterialFile(material, true)] = std::move(pixelShader);
+		}
+	}
+
+	struct ShaderCacheScene
+	{
+		std::vector<std::string> Files = {};
+		std::array<LeviathanRenderer::ShaderMacro, 2> Macros = {};
+		std::vector<LeviathanRenderer::ShaderCompileDescription> Descriptions = {};
+	};
+
+	// A vertex and pixel shader per material. Pixel shaders of lit materials use the macros.
+	static void MakeShaderCacheScene(ShaderCacheScene& scene)
+	{
+		scene.Files.clear();
+		for (size_t material = 0; material < MaterialCount; ++material)
+		{
+			scene.Files.push_back(MakeMaterialFile(material, false));
+			scene.Files.push_back(MakeMaterialFile(material, true));
+		}
+		scene.Macros[0] = LeviathanRenderer::ShaderMacro{ .Name = "TEXTURE2D_SRV_TABLE_LENGTH", .Definition = "16" };
+		scene.Macros[1] = LeviathanRenderer::ShaderMacro{ .Name = "SHADOW_CASCADE_COUNT", .Definition = "4" };
+
+		scene.Descriptions.clear();
+		for (size_t material = 0; material < MaterialCount; ++material)
+		{
+			const bool lit = IsLitMaterial(material);
+			scene.Descriptions.push_back(LeviathanRenderer::ShaderCompileDescription{ .SourceFile = scene.Files[material * 2], .EntryPoint = "main",
+				.Target = "vs_5_0", .Macros = nullptr, .MacroCount = 0 });
+			scene.Descriptions.push_back(LeviathanRenderer::ShaderCompileDescription{ .SourceFile = scene.Files[(material * 2) + 1], .EntryPoint = "main",
+				.Target = "ps_5_0", .Macros = lit ? scene.Macros.data() : nullptr, .MacroCount = lit ? scene.Macros.size() : 0 });
+		}
+	}
+
+	// Number of descriptions whose bytecode is missing or differs from the bytecode of their current inputs.
+	static size_t CountStaleBytecode(const ShaderCacheScene& scene, LeviathanRenderer::ShaderSourceGraph& sources,
+		const std::vector<const std::vector<uint8_t>*>& bytecode)
+	{
+		size_t staleCount = 0;
+		std::vector<uint8_t> expected = {};
+		for (size_t i = 0; i < scene.Descriptions.size(); ++i)
+		{
+			MakeFakeBytecode(scene.Descriptions[i], sources.GetSource(scene.Descriptions[i].SourceFile), expected);
+			staleCount += ((bytecode[i] == nullptr) || (*bytecode[i] != expected)) ? 1 : 0;
+		}
+		return staleCount;
+	}
+
+	// Shader files, descriptions, a cache and a source graph over the files, warmed by compiling every shader once.
+	struct ShaderCacheFixture
+	{
+		VirtualShaderFiles Files = {};
+		ShaderCacheScene Scene = {};
+		std::atomic<size_t> CompileCount = 0;
+		LeviathanRenderer::ShaderSourceGraph Sources;
+		LeviathanRenderer::ShaderCache Cache = {};
+		std::vector<const std::vector<uint8_t>*> Bytecode = {};
+
+		ShaderCacheFixture()
+			: Sources(ReadVirtualShaderFile, &Files)
+		{
+			MakeShaderFiles(Files);
+			MakeShaderCacheScene(Scene);
+		}
+
+		bool GetOrCompile()
+		{
+			return Cache.GetOrCompile(Sources, Scene.Descriptions.data(), Scene.Descriptions.size(), FakeCompile, &CompileCount, Bytecode);
+		}
+
+		// Returns the number of compiles of a lookup of every shader.
+		size_t CountCompiles()
+		{
+			const size_t compilesBefore = CompileCount;
+			GetOrCompile();
+			return CompileCount - compilesBefore;
+		}
+	};
+
+	static size_t CountLitPixelShaders()
+	{
+		size_t litPixelShaderCount = 0;
+		for (size_t material = 0; material < MaterialCount; ++material)
+		{
+			litPixelShaderCount += IsLitMaterial(material) ? 1 : 0;
+		}
+		return litPixelShaderCount;
+	}
+
+	static std::string MakePackFile(const std::string_view name)
+	{
+		return (std::filesystem::temp_directory_path() / ("LeviathanTests" + std::string(name) + ".pack")).string();
+	}
+
+	void RunShaderCacheTests(Tester& tester)
+	{
+		const bool startedJobSystem = LeviathanCore::JobSystem::Initialize(JobSystemWorkerCount);
+
+		// Cold start compiles every shader once and a warm lookup compiles nothing.
+		tester.Run("ShaderCache.GetOrCompile.ColdThenWarm", [&]()
+			{
+				ShaderCacheFixture fixture = {};
+				const size_t shaderCount = fixture.Scene.Descriptions.size();
+				LEVIATHAN_TEST_CHECK(tester, fixture.GetOrCompile());
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, fixture.CompileCount.load(), shaderCount);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountStaleBytecode(fixture.Scene, fixture.Sources, fixture.Bytecode), 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, fixture.CountCompiles(), 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountStaleBytecode(fixture.Scene, fixture.Sources, fixture.Bytecode), 0);
+			});
+
+		// Includes inside comments are not dependencies. Every dependency must exist.
+		tester.Run("ShaderCache.Dependencies.IgnoreCommentedIncludes", [&]()
+			{
+				ShaderCacheFixture fixture = {};
+				LEVIATHAN_TEST_CHECK(tester, fixture.GetOrCompile());
+				size_t falseDependencies = 0;
+				size_t dependencyCount = 0;
+				std::vector<std::string> dependencies = {};
+				for (const std::string& file : fixture.Scene.Files)
+				{
+					dependencies.clear();
+					fixture.Sources.GetDependencies(file, dependencies);
+					dependencyCount += dependencies.size();
+					for (const std::string& dependency : dependencies)
+					{
+						falseDependencies += (fixture.Files.Files.find(dependency) == fixture.Files.Files.end()) ? 1 : 0;
+					}
+				}
+				LEVIATHAN_TEST_CHECK(tester, dependencyCount > 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, falseDependencies, 0);
+			});
+
+		// Round trip through a pack file. A fresh process loading the pack compiles nothing.
+		tester.Run("ShaderCache.Pack.RoundTrip", [&]()
+			{
+				ShaderCacheFixture fixture = {};
+				LEVIATHAN_TEST_CHECK(tester, fixture.GetOrCompile());
+				const std::string packFile = MakePackFile("ShaderCacheRoundTrip");
+				LEVIATHAN_TEST_CHECK(tester, fixture.Cache.Save(packFile));
+
+				ShaderCacheFixture reloaded = {};
+				LEVIATHAN_TEST_CHECK(tester, reloaded.Cache.Load(packFile));
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, reloaded.Cache.GetEntryCount(), fixture.Cache.GetEntryCount());
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, reloaded.CountCompiles(), 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountStaleBytecode(reloaded.Scene, reloaded.Sources, reloaded.Bytecode), 0);
+
+				std::error_code errorCode = {};
+				std::filesystem::remove(packFile, errorCode);
+			});
+
+		// Saving after a run that looked up only half of the shaders drops the entries of the other half.
+		tester.Run("ShaderCache.Pack.SavesOnlyUsedEntries", [&]()
+			{
+				ShaderCacheFixture fixture = {};
+				LEVIATHAN_TEST_CHECK(tester, fixture.GetOrCompile());
+				const std::string packFile = MakePackFile("ShaderCacheUsedEntries");
+				LEVIATHAN_TEST_CHECK(tester, fixture.Cache.Save(packFile));
+
+				ShaderCacheFixture reloaded = {};
+				LEVIATHAN_TEST_CHECK(tester, reloaded.Cache.Load(packFile));
+				const size_t usedCount = reloaded.Scene.Descriptions.size() / 2;
+				LEVIATHAN_TEST_CHECK(tester, reloaded.Cache.GetOrCompile(reloaded.Sources, reloaded.Scene.Descriptions.data(), usedCount, FakeCompile,
+					&reloaded.CompileCount, reloaded.Bytecode));
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, reloaded.CompileCount.load(), 0);
+				LEVIATHAN_TEST_CHECK(tester, reloaded.Cache.IsDirty());
+				LEVIATHAN_TEST_CHECK(tester, reloaded.Cache.GetUsedEntryCount() < fixture.Cache.GetEntryCount());
+				LEVIATHAN_TEST_CHECK(tester, reloaded.Cache.Save(packFile));
+				LEVIATHAN_TEST_CHECK(tester, !reloaded.Cache.IsDirty());
+
+				LeviathanRenderer::ShaderCache pruned = {};
+				LEVIATHAN_TEST_CHECK(tester, pruned.Load(packFile));
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, pruned.GetEntryCount(), reloaded.Cache.GetUsedEntryCount());
+
+				std::error_code errorCode = {};
+				std::filesystem::remove(packFile, errorCode);
+			});
+
+		// A pack with a flipped bytecode byte is rejected as a whole.
+		tester.Run("ShaderCache.Pack.RejectCorrupt", [&]()
+			{
+				ShaderCacheFixture fixture = {};
+				LEVIATHAN_TEST_CHECK(tester, fixture.GetOrCompile());
+				const std::string packFile = MakePackFile("ShaderCacheCorrupt");
+				LEVIATHAN_TEST_CHECK(tester, fixture.Cache.Save(packFile));
+
+				std::vector<uint8_t> pack = {};
+				LEVIATHAN_TEST_CHECK(tester, LeviathanCore::Serialize::ReadFile(packFile, true, pack));
+				LEVIATHAN_TEST_CHECK(tester, !pack.empty());
+				if (!pack.empty())
+				{
+					pack.back() ^= 0x5a;
+				}
+				LEVIATHAN_TEST_CHECK(tester, LeviathanCore::Serialize::WriteBytesToFile(packFile, pack));
+
+				LeviathanRenderer::ShaderCache corrupted = {};
+				LEVIATHAN_TEST_CHECK(tester, !corrupted.Load(packFile));
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, corrupted.GetEntryCount(), 0);
+
+				std::error_code errorCode = {};
+				std::filesystem::remove(packFile, errorCode);
+			});
+
+		// Editing a header recompiles exactly the shaders including it directly or indirectly.
+		tester.Run("ShaderCache.HeaderEdit.RecompilesDependents", [&]()
+			{
+				ShaderCacheFixture fixture = {};
+				LEVIATHAN_TEST_CHECK(tester, fixture.GetOrCompile());
+				const auto checkEdit = [&](const std::string_view file, const size_t expectedCompiles)
+					{
+						fixture.Files.Files[std::string(file)] += "// Edited.\n";
+						fixture.Sources.Clear();
+						LEVIATHAN_TEST_CHECK_EQUAL(tester, fixture.CountCompiles(), expectedCompiles);
+						LEVIATHAN_TEST_CHECK_EQUAL(tester, CountStaleBytecode(fixture.Scene, fixture.Sources, fixture.Bytecode), 0);
+					};
+				checkEdit(LightingFile, CountLitPixelShaders());
+				checkEdit(SkinningFile, MaterialCount / 2);
+				checkEdit(MathFile, fixture.Scene.Descriptions.size());
+			});
+
+		// Changing a macro definition recompiles the shaders using it.
+		tester.Run("ShaderCache.MacroEdit.RecompilesUsers", [&]()
+			{
+				ShaderCacheFixture fixture = {};
+				LEVIATHAN_TEST_CHECK(tester, fixture.GetOrCompile());
+				fixture.Scene.Macros[1].Definition = "2";
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, fixture.CountCompiles(), CountLitPixelShaders());
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountStaleBytecode(fixture.Scene, fixture.Sources, fixture.Bytecode), 0);
+			});
+
+		// A missing include fails only the shader including it.
+		tester.Run("ShaderCache.MissingInclude.FailsOnlyIncluder", [&]()
+			{
+				ShaderCacheFixture fixture = {};
+				const std::string brokenFile = "Shaders/Materials/Broken.hlsl";
+				fixture.Files.Files[brokenFile] = "#include \"DoesNotExist.hlsl\"\nfloat4 main() : SV_TARGET { return 0.0f; }\n";
+				const size_t shaderCount = fixture.Scene.Descriptions.size();
+				fixture.Scene.Descriptions.push_back(LeviathanRenderer::ShaderCompileDescription{ .SourceFile = brokenFile, .EntryPoint = "main", .Target = "ps_5_0" });
+
+				LEVIATHAN_TEST_CHECK(tester, !fixture.GetOrCompile());
+				LEVIATHAN_TEST_CHECK(tester, fixture.Bytecode.back() == nullptr);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, fixture.Cache.GetStats().SourceErrors, 1);
+				size_t missingBytecode = 0;
+				for (size_t i = 0; i < shaderCount; ++i)
+				{
+					missingBytecode += (fixture.Bytecode[i] == nullptr) ? 1 : 0;
+				}
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, missingBytecode, 0);
+			});
+
+		if (startedJobSystem)
+		{
+			LeviathanCore::JobSystem::Shutdown();
+		}
+	}
+}
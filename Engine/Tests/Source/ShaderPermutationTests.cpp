@@ -0,0 +1,242 @@
+#include "TestSuites.h"
+#include "Test.h"
+#include "ShaderPermutations.h"
+#include "JobSystem.h"
+
+namespace LeviathanTests
+{
+	static constexpr std::string_view LitPixelShaderFile = "Shaders/LitPixelShader.hlsl";
+	static constexpr size_t FrameDrawCount = 4096;
+	static constexpr size_t FrameMaterialCount = 24;
+	static constexpr size_t JobSystemWorkerCount = 3;
+
+	static constexpr std::array<LeviathanRenderer::ShaderFeature, 3> LitFeatures =
+	{
+		LeviathanRenderer::ShaderFeature{ .Name = "NORMAL_MAPPING", .BitCount = 1 },
+		LeviathanRenderer::ShaderFeature{ .Name = "LIGHT_COUNT", .BitCount = 3 },
+		LeviathanRenderer::ShaderFeature{ .Name = "SHADOWS", .BitCount = 1 }
+	};
+	static constexpr size_t NormalMappingFeature = 0;
+	static constexpr size_t LightCountFeature = 1;
+	static constexpr size_t ShadowsFeature = 2;
+	static constexpr size_t LitKeyBitCount = LeviathanRenderer::GetShaderFeatureBitOffset(LitFeatures.data(), LitFeatures.size());
+
+	static constexpr LeviathanRenderer::ShaderPermutationKey MakeLitKey(const uint32_t normalMapping, const uint32_t lightCount, const uint32_t shadows)
+	{
+		LeviathanRenderer::ShaderPermutationKey key = 0;
+		key = LeviathanRenderer::SetShaderFeature(LitFeatures.data(), NormalMappingFeature, key, normalMapping);
+		key = LeviathanRenderer::SetShaderFeature(LitFeatures.data(), LightCountFeature, key, lightCount);
+		return LeviathanRenderer::SetShaderFeature(LitFeatures.data(), ShadowsFeature, key, shadows);
+	}
+
+	// Keys are built at compile time.
+	static_assert(LitKeyBitCount == 5);
+	static_assert(MakeLitKey(1, 5, 1) == 0b11011);
+	static_assert(LeviathanRenderer::GetShaderFeature(LitFeatures.data(), LightCountFeature, MakeLitKey(0, 6, 1)) == 6);
+	static_assert(LeviathanRenderer::SetShaderFeature(LitFeatures.data(), NormalMappingFeature, MakeLitKey(1, 7, 1), 0) == MakeLitKey(0, 7, 1));
+
+	struct VirtualShaderFile
+	{
+		std::string Source = {};
+	};
+
+	static bool ReadLitPixelShaderFile(const std::string_view file, std::string& outSource, void* const userData)
+	{
+		if (file != LitPixelShaderFile)
+		{
+			return false;
+		}
+		outSource = static_cast<const VirtualShaderFile*>(userData)->Source;
+		return true;
+	}
+
+	// Stands in for the shader compiler. Bytecode is the macros followed by the source so that the macros a permutation was compiled with can be
+	// checked.
+	static void MakePermutationBytecode(const LeviathanRenderer::ShaderMacro* const macros, const size_t macroCount, const std::string_view source,
+		std::vector<uint8_t>& outBytecode)
+	{
+		std::string bytecode = {};
+		for (size_t i = 0; i < macroCount; ++i)
+		{
+			bytecode.append(macros[i].Name).append("=").append(macros[i].Definition).append(";");
+		}
+		bytecode.append(source);
+		outBytecode.assign(bytecode.begin(), bytecode.end());
+	}
+
+	static bool FakePermutationCompile(const LeviathanRenderer::ShaderCompileDescription& description, const std::string_view source,
+		std::vector<uint8_t>& outBytecode, void* const userData)
+	{
+		++*static_cast<std::atomic<size_t>*>(userData);
+		MakePermutationBytecode(description.Macros, description.MacroCount, source, outBytecode);
+		return true;
+	}
+
+	// Permutation of every draw of a frame. Materials are spread over a few normal mapping, light count and shadow combinations and draws are in
+	// material order as they would be after sorting.
+	static void MakeFrameKeys(std::vector<LeviathanRenderer::ShaderPermutationKey>& outKeys)
+	{
+		outKeys.resize(FrameDrawCount);
+		for (size_t draw = 0; draw < FrameDrawCount; ++draw)
+		{
+			const uint32_t material = static_cast<uint32_t>((draw * FrameMaterialCount) / FrameDrawCount);
+			outKeys[draw] = MakeLitKey(material % 2, (material / 2) % 4, (material / 8) % 2);
+		}
+	}
+
+	static constexpr std::array<LeviathanRenderer::ShaderMacro, 1> BaseMacros =
+	{
+		LeviathanRenderer::ShaderMacro{ .Name = "TEXTURE2D_SRV_TABLE_LENGTH", .Definition = "16" }
+	};
+
+	// Lit pixel shader file, its permutation set, the frame's keys and a cache and source graph over the file.
+	struct ShaderPermutationFixture
+	{
+		VirtualShaderFile File = { .Source = "#if NORMAL_MAPPING\nfloat3 SampleNormal();\n#endif\nfloat4 main() : SV_TARGET { return LIGHT_COUNT; }\n" };
+		LeviathanRenderer::ShaderCompileDescription Base = { .SourceFile = LitPixelShaderFile, .EntryPoint = "main", .Target = "ps_5_0",
+			.Macros = BaseMacros.data(), .MacroCount = BaseMacros.size() };
+		std::vector<LeviathanRenderer::ShaderPermutationKey> FrameKeys = {};
+		std::vector<LeviathanRenderer::ShaderPermutationKey> DistinctKeys = {};
+		std::atomic<size_t> CompileCount = 0;
+		LeviathanRenderer::ShaderSourceGraph Sources;
+		LeviathanRenderer::ShaderCache Cache = {};
+		LeviathanRenderer::ShaderPermutationSet Permutations;
+
+		ShaderPermutationFixture()
+			: Sources(ReadLitPixelShaderFile, &File)
+			, Permutations("LitPixelShader", Base, LitFeatures.data(), LitFeatures.size())
+		{
+			MakeFrameKeys(FrameKeys);
+			DistinctKeys = FrameKeys;
+			std::sort(DistinctKeys.begin(), DistinctKeys.end());
+			DistinctKeys.erase(std::unique(DistinctKeys.begin(), DistinctKeys.end()), DistinctKeys.end());
+		}
+
+		// Returns the number of draws of the frame without bytecode.
+		size_t DrawFrame(LeviathanRenderer::ShaderPermutationSet& permutations)
+		{
+			size_t missingBytecode = 0;
+			for (const LeviathanRenderer::ShaderPermutationKey key : FrameKeys)
+			{
+				missingBytecode += (permutations.GetPermutation(key, Cache, Sources, FakePermutationCompile, &CompileCount) == nullptr) ? 1 : 0;
+			}
+			return missingBytecode;
+		}
+	};
+
+	void RunShaderPermutationTests(Tester& tester)
+	{
+		const bool startedJobSystem = LeviathanCore::JobSystem::Initialize(JobSystemWorkerCount);
+
+		// Without a usage list every permutation is loaded on first use, once.
+		tester.Run("ShaderPermutations.GetPermutation.LoadsEachOnce", [&]()
+			{
+				ShaderPermutationFixture fixture = {};
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, fixture.DrawFrame(fixture.Permutations), 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, fixture.CompileCount.load(), fixture.DistinctKeys.size());
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, fixture.Permutations.GetStats().FirstUseLoads, fixture.DistinctKeys.size());
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, fixture.Permutations.GetResidentCount(), fixture.DistinctKeys.size());
+
+				const size_t compilesBefore = fixture.CompileCount;
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, fixture.DrawFrame(fixture.Permutations), 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, fixture.CompileCount.load(), compilesBefore);
+			});
+
+		// Every permutation is compiled with the base macros followed by each feature defined to its value.
+		tester.Run("ShaderPermutations.GetPermutation.DefinesFeatures", [&]()
+			{
+				ShaderPermutationFixture fixture = {};
+				std::vector<uint8_t> expected = {};
+				for (const LeviathanRenderer::ShaderPermutationKey key : fixture.DistinctKeys)
+				{
+					const std::array<std::string, 3> values =
+					{
+						std::to_string(LeviathanRenderer::GetShaderFeature(LitFeatures.data(), NormalMappingFeature, key)),
+						std::to_string(LeviathanRenderer::GetShaderFeature(LitFeatures.data(), LightCountFeature, key)),
+						std::to_string(LeviathanRenderer::GetShaderFeature(LitFeatures.data(), ShadowsFeature, key))
+					};
+					const std::array<LeviathanRenderer::ShaderMacro, 4> macros =
+					{
+						BaseMacros[0],
+						LeviathanRenderer::ShaderMacro{ .Name = "NORMAL_MAPPING", .Definition = values[0].c_str() },
+						LeviathanRenderer::ShaderMacro{ .Name = "LIGHT_COUNT", .Definition = values[1].c_str() },
+						LeviathanRenderer::ShaderMacro{ .Name = "SHADOWS", .Definition = values[2].c_str() }
+					};
+					MakePermutationBytecode(macros.data(), macros.size(), fixture.File.Source, expected);
+					const std::vector<uint8_t>* const bytecode = fixture.Permutations.GetPermutation(key, fixture.Cache, fixture.Sources, FakePermutationCompile,
+						&fixture.CompileCount);
+					LEVIATHAN_TEST_CHECK(tester, (bytecode != nullptr) && (*bytecode == expected));
+				}
+			});
+
+		// Keys setting bits outside of the features are rejected.
+		tester.Run("ShaderPermutations.GetPermutation.RejectsInvalidKeys", [&]()
+			{
+				ShaderPermutationFixture fixture = {};
+				LEVIATHAN_TEST_CHECK(tester, fixture.Permutations.GetPermutation(1u << LitKeyBitCount, fixture.Cache, fixture.Sources, FakePermutationCompile,
+					&fixture.CompileCount) == nullptr);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, fixture.Permutations.GetResidentCount(), 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, fixture.CompileCount.load(), 0);
+			});
+
+		// Finding a permutation that is not resident loads nothing. The usage list records it so that the next run prewarms it.
+		tester.Run("ShaderPermutations.FindPermutation.RecordsMisses", [&]()
+			{
+				ShaderPermutationFixture fixture = {};
+				for (const LeviathanRenderer::ShaderPermutationKey key : fixture.FrameKeys)
+				{
+					LEVIATHAN_TEST_CHECK(tester, fixture.Permutations.FindPermutation(key) == nullptr);
+				}
+				LEVIATHAN_TEST_CHECK(tester, fixture.Permutations.FindPermutation(1u << LitKeyBitCount) == nullptr);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, fixture.CompileCount.load(), 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, fixture.Permutations.GetResidentCount(), 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, fixture.Permutations.GetStats().MissedPermutations, fixture.DistinctKeys.size());
+
+				std::vector<LeviathanRenderer::ShaderPermutationKey> usedKeys = {};
+				fixture.Permutations.GetUsedKeys(usedKeys);
+				LEVIATHAN_TEST_CHECK(tester, usedKeys == fixture.DistinctKeys);
+
+				LEVIATHAN_TEST_CHECK(tester, fixture.Permutations.Prewarm(usedKeys.data(), usedKeys.size(), fixture.Cache, fixture.Sources, FakePermutationCompile,
+					&fixture.CompileCount));
+				LEVIATHAN_TEST_CHECK(tester, fixture.Permutations.FindPermutation(fixture.FrameKeys.front()) != nullptr);
+			});
+
+		// Round trip through a usage list. The next run prewarms the recorded permutations in one batch and loads nothing on first use. The list also
+		// holds a key recorded before a feature was removed, another set's permutation and a malformed line, which are skipped.
+		tester.Run("ShaderPermutations.UsageList.Prewarm", [&]()
+			{
+				ShaderPermutationFixture fixture = {};
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, fixture.DrawFrame(fixture.Permutations), 0);
+
+				const std::filesystem::path usagePath = std::filesystem::temp_directory_path() / "LeviathanTestsShaderUsage.txt";
+				const std::string usageFile = usagePath.string();
+				const LeviathanRenderer::ShaderPermutationSet* const sets[] = { &fixture.Permutations };
+				LEVIATHAN_TEST_CHECK(tester, LeviathanRenderer::SaveShaderUsageList(usageFile, sets, 1));
+				{
+					std::ofstream stream(usagePath, std::ios::app | std::ios::binary);
+					stream << "LitPixelShader " << (1u << LitKeyBitCount) << "\nUnlitPixelShader 1\nLitPixelShader\r\nLitPixelShader 1x\n";
+				}
+
+				std::vector<LeviathanRenderer::ShaderUsageRecord> records = {};
+				LEVIATHAN_TEST_CHECK(tester, LeviathanRenderer::LoadShaderUsageList(usageFile, records));
+				std::error_code errorCode = {};
+				std::filesystem::remove(usagePath, errorCode);
+				// Recorded permutations, the stale key and the other set's permutation.
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, records.size(), fixture.DistinctKeys.size() + 2);
+
+				LeviathanRenderer::ShaderPermutationSet nextRun("LitPixelShader", fixture.Base, LitFeatures.data(), LitFeatures.size());
+				const size_t compilesBefore = fixture.CompileCount;
+				LeviathanRenderer::PrewarmFromUsageList(nextRun, records, fixture.Cache, fixture.Sources, FakePermutationCompile, &fixture.CompileCount);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, nextRun.GetStats().PrewarmedPermutations, fixture.DistinctKeys.size());
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, fixture.DrawFrame(nextRun), 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, nextRun.GetStats().FirstUseLoads, 0);
+				// Permutations of the previous run are in the shader cache so prewarming compiles nothing.
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, fixture.CompileCount.load(), compilesBefore);
+			});
+
+		if (startedJobSystem)
+		{
+			LeviathanCore::JobSystem::Shutdown();
+		}
+	}
+}
@@ -0,0 +1,224 @@
+#include "TestSuites.h"
+#include "Test.h"
+#include "TestFixtures.h"
+#include "MathTypes.h"
+#include "BoundingVolumes.h"
+#include "DynamicAABBTree.h"
+
+namespace LeviathanTests
+{
+	static constexpr size_t MovingObjectCount = 20000;
+	static constexpr size_t StepCount = 16;
+	static constexpr size_t QueryCount = 128;
+	static constexpr float WorldHalfSize = 500.0f;
+	static constexpr float MaxSpeed = 2.0f;
+
+	struct MovingObject
+	{
+		LeviathanCore::MathTypes::Vector3 Center = {};
+		LeviathanCore::MathTypes::Vector3 HalfExtents = {};
+		LeviathanCore::MathTypes::Vector3 Velocity = {};
+		LeviathanCore::DataStructures::DynamicAABBTree::ProxyId Proxy = LeviathanCore::DataStructures::DynamicAABBTree::InvalidProxyId;
+
+		inline LeviathanCore::BoundingVolumes::AABB Bounds() const { return LeviathanCore::BoundingVolumes::AABB{ Center - HalfExtents, Center + HalfExtents }; }
+	};
+
+	// Moves every object by its velocity, reflecting off the world bounds, and updates its proxy.
+	static void StepObjects(std::vector<MovingObject>& objects, LeviathanCore::DataStructures::DynamicAABBTree& tree)
+	{
+		for (MovingObject& object : objects)
+		{
+			float* const center = object.Center.Data();
+			float* const velocity = object.Velocity.Data();
+			for (size_t axis = 0; axis < 3; ++axis)
+			{
+				center[axis] += velocity[axis];
+				if (std::fabs(center[axis]) > WorldHalfSize)
+				{
+					velocity[axis] = -velocity[axis];
+				}
+			}
+			tree.MoveProxy(object.Proxy, object.Bounds(), object.Velocity);
+		}
+	}
+
+	// Returns the number of proxies whose enlarged box does not contain the object bounds.
+	static size_t CountUncontainedObjects(const std::vector<MovingObject>& objects, const LeviathanCore::DataStructures::DynamicAABBTree& tree)
+	{
+		size_t uncontained = 0;
+		for (const MovingObject& object : objects)
+		{
+			const LeviathanCore::BoundingVolumes::AABB& fat = tree.GetFatAABB(object.Proxy);
+			const LeviathanCore::BoundingVolumes::AABB bounds = object.Bounds();
+			for (size_t axis = 0; axis < 3; ++axis)
+			{
+				if ((bounds.Min.Data()[axis] < fat.Min.Data()[axis]) || (bounds.Max.Data()[axis] > fat.Max.Data()[axis]))
+				{
+					++uncontained;
+					break;
+				}
+			}
+		}
+		return uncontained;
+	}
+
+	void RunSpatialTests(Tester& tester)
+	{
+		using namespace LeviathanCore;
+		using ProxyId = DataStructures::DynamicAABBTree::ProxyId;
+
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> positionDistribution(-WorldHalfSize, WorldHalfSize);
+		std::uniform_real_distribution<float> sizeDistribution(0.5f, 3.0f);
+		std::uniform_real_distribution<float> velocityDistribution(-MaxSpeed, MaxSpeed);
+
+		std::vector<MovingObject> objects(MovingObjectCount);
+		for (MovingObject& object : objects)
+		{
+			object.Center = MathTypes::Vector3(positionDistribution(random), positionDistribution(random), positionDistribution(random));
+			object.HalfExtents = MathTypes::Vector3(sizeDistribution(random), sizeDistribution(random), sizeDistribution(random));
+			object.Velocity = MathTypes::Vector3(velocityDistribution(random), velocityDistribution(random), velocityDistribution(random));
+		}
+
+		DataStructures::DynamicAABBTree tree(0.5f);
+		for (size_t i = 0; i < objects.size(); ++i)
+		{
+			objects[i].Proxy = tree.CreateProxy(objects[i].Bounds(), i);
+		}
+
+		tester.Run("Spatial.DynamicAABBTree.MoveProxy.StaysValid", [&]()
+			{
+				for (size_t step = 0; step < StepCount; ++step)
+				{
+					StepObjects(objects, tree);
+				}
+				LEVIATHAN_TEST_CHECK(tester, tree.Validate());
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, tree.GetProxyCount(), MovingObjectCount);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountUncontainedObjects(objects, tree), 0);
+				size_t userDataMismatches = 0;
+				for (size_t i = 0; i < objects.size(); ++i)
+				{
+					userDataMismatches += (tree.GetUserData(objects[i].Proxy) != i) ? 1 : 0;
+				}
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, userDataMismatches, 0);
+			});
+
+		// Brute force comparisons test the same enlarged boxes as the tree so that results match exactly.
+		BoundingVolumes::AABBArray fatBoxes = {};
+		for (const MovingObject& object : objects)
+		{
+			fatBoxes.Add(tree.GetFatAABB(object.Proxy));
+		}
+		const BoundingVolumes::AABBSoA fatBoxView = fatBoxes.View();
+		std::vector<uint8_t> bruteForceResults(MovingObjectCount, 0);
+
+		std::vector<BoundingVolumes::AABB> queryBoxes(QueryCount);
+		std::vector<BoundingVolumes::Ray> queryRays(QueryCount);
+		std::vector<MathTypes::Vector3> queryPoints(QueryCount);
+		for (size_t i = 0; i < QueryCount; ++i)
+		{
+			const MathTypes::Vector3 center(positionDistribution(random), positionDistribution(random), positionDistribution(random));
+			queryBoxes[i] = BoundingVolumes::AABB{ center - MathTypes::Vector3(20.0f, 20.0f, 20.0f), center + MathTypes::Vector3(20.0f, 20.0f, 20.0f) };
+			const MathTypes::Vector3 direction(velocityDistribution(random), velocityDistribution(random), velocityDistribution(random));
+			queryRays[i] = BoundingVolumes::Ray{ center, direction.AsNormalizedSafe() };
+			queryPoints[i] = center;
+		}
+
+		tester.Run("Spatial.DynamicAABBTree.QueryOverlap.MatchesBruteForce", [&]()
+			{
+				size_t mismatches = 0;
+				for (size_t q = 0; q < QueryCount; ++q)
+				{
+					std::vector<uint8_t> treeResults(MovingObjectCount, 0);
+					tree.QueryOverlap(queryBoxes[q], [&](const ProxyId proxyId) { ++treeResults[tree.GetUserData(proxyId)]; return true; });
+					BoundingVolumes::TestAABBAABBs(queryBoxes[q], fatBoxView, 0, MovingObjectCount, bruteForceResults.data());
+					mismatches += (treeResults != bruteForceResults) ? 1 : 0;
+				}
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, mismatches, 0);
+			});
+
+		tester.Run("Spatial.DynamicAABBTree.QueryFrustum.MatchesBruteForce", [&]()
+			{
+				const BoundingVolumes::Frustum frustum = LeviathanTestFixtures::MakeFrustum(300.0f);
+
+				std::vector<uint8_t> treeResults(MovingObjectCount, 0);
+				tree.QueryFrustum(frustum, [&](const ProxyId proxyId) { ++treeResults[tree.GetUserData(proxyId)]; return true; });
+				BoundingVolumes::TestFrustumAABBs(frustum, fatBoxView, 0, MovingObjectCount, bruteForceResults.data());
+				LEVIATHAN_TEST_CHECK(tester, treeResults == bruteForceResults);
+			});
+
+		tester.Run("Spatial.DynamicAABBTree.RayCastClosest.MatchesBruteForce", [&]()
+			{
+				static constexpr float RayLength = 2.0f * WorldHalfSize;
+				std::vector<float> bruteDistances(MovingObjectCount, 0.0f);
+				size_t mismatches = 0;
+				for (size_t q = 0; q < QueryCount; ++q)
+				{
+					float treeClosest = RayLength;
+					tree.RayCast(queryRays[q], RayLength, [&](const ProxyId proxyId, const float maxDistance)
+						{
+							float distance = 0.0f;
+							if (queryRays[q].Intersects(tree.GetFatAABB(proxyId), maxDistance, distance))
+							{
+								treeClosest = std::min(treeClosest, distance);
+								return distance;
+							}
+							return maxDistance;
+						});
+
+					BoundingVolumes::TestRayAABBs(queryRays[q], RayLength, fatBoxView, 0, MovingObjectCount, bruteForceResults.data(), bruteDistances.data());
+					float bruteClosest = RayLength;
+					for (size_t i = 0; i < MovingObjectCount; ++i)
+					{
+						bruteClosest = bruteForceResults[i] ? std::min(bruteClosest, bruteDistances[i]) : bruteClosest;
+					}
+
+					mismatches += (std::fabs(treeClosest - bruteClosest) > 1e-3f) ? 1 : 0;
+				}
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, mismatches, 0);
+			});
+
+		tester.Run("Spatial.DynamicAABBTree.FindNearest.MatchesBruteForce", [&]()
+			{
+				size_t mismatches = 0;
+				for (size_t q = 0; q < QueryCount; ++q)
+				{
+					ProxyId nearest = DataStructures::DynamicAABBTree::InvalidProxyId;
+					float treeDistance = std::numeric_limits<float>::max();
+					tree.FindNearest(queryPoints[q], std::numeric_limits<float>::max(), [&](const ProxyId proxyId)
+						{
+							return tree.GetFatAABB(proxyId).SquaredDistance(queryPoints[q]);
+						}, nearest, treeDistance);
+
+					float bestSquaredDistance = std::numeric_limits<float>::max();
+					for (size_t i = 0; i < MovingObjectCount; ++i)
+					{
+						bestSquaredDistance = std::min(bestSquaredDistance, fatBoxes.Get(i).SquaredDistance(queryPoints[q]));
+					}
+
+					mismatches += (treeDistance != std::sqrt(bestSquaredDistance)) ? 1 : 0;
+				}
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, mismatches, 0);
+			});
+
+		tester.Run("Spatial.DynamicAABBTree.DestroyProxy.StaysValid", [&]()
+			{
+				for (size_t i = 0; i < objects.size(); i += 2)
+				{
+					tree.DestroyProxy(objects[i].Proxy);
+				}
+				LEVIATHAN_TEST_CHECK(tester, tree.Validate());
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, tree.GetProxyCount(), MovingObjectCount / 2);
+
+				// Only the remaining proxies are reported.
+				size_t destroyedReported = 0;
+				tree.QueryOverlap(BoundingVolumes::AABB{ MathTypes::Vector3(-2.0f * WorldHalfSize, -2.0f * WorldHalfSize, -2.0f * WorldHalfSize),
+					MathTypes::Vector3(2.0f * WorldHalfSize, 2.0f * WorldHalfSize, 2.0f * WorldHalfSize) }, [&](const ProxyId proxyId)
+					{
+						destroyedReported += ((tree.GetUserData(proxyId) % 2) == 0) ? 1 : 0;
+						return true;
+					});
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, destroyedReported, 0);
+			});
+	}
+}
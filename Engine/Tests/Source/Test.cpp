@@ -0,0 +1,74 @@
+#include "Test.h"
+#include "LeviathanString.h"
+
+namespace LeviathanTests
+{
+	Tester::Tester(const TestSettings& settings)
+		: Settings(settings)
+	{
+	}
+
+	bool Tester::IsEnabled(std::string_view name) const
+	{
+		return (Settings.Filter.empty() || (name.find(Settings.Filter) != std::string_view::npos));
+	}
+
+	bool Tester::Check(const bool condition, const char* expression, const char* file, const int line)
+	{
+		if (!condition)
+		{
+			++CurrentTestFailedChecks;
+			std::cout << LeviathanCore::String::Printf("    %s(%d): check failed: %s", file, line, expression).c_str() << '\n';
+		}
+		return condition;
+	}
+
+	bool Tester::CheckEqual(const double actual, const double expected, const char* expression, const char* file, const int line)
+	{
+		const bool condition = (actual == expected);
+		if (!condition)
+		{
+			++CurrentTestFailedChecks;
+			std::cout << LeviathanCore::String::Printf("    %s(%d): check failed: %s (%g != %g)", file, line, expression, actual, expected).c_str() << '\n';
+		}
+		return condition;
+	}
+
+	bool Tester::CheckLessOrEqual(const double actual, const double limit, const char* expression, const char* file, const int line)
+	{
+		const bool condition = (actual <= limit);
+		if (!condition)
+		{
+			++CurrentTestFailedChecks;
+			std::cout << LeviathanCore::String::Printf("    %s(%d): check failed: %s (%g > %g)", file, line, expression, actual, limit).c_str() << '\n';
+		}
+		return condition;
+	}
+
+	void Tester::PrintSummary() const
+	{
+		std::cout << LeviathanCore::String::Printf("%zu of %zu tests passed.", TestCount - FailedTestCount, TestCount).c_str() << '\n';
+	}
+
+	void Tester::BeginTest(std::string_view name)
+	{
+		CurrentTestName = name;
+		CurrentTestFailedChecks = 0;
+		std::cout << LeviathanCore::String::Printf("[ RUN    ] %s", CurrentTestName.c_str()).c_str() << '\n';
+	}
+
+	void Tester::EndTest()
+	{
+		++TestCount;
+		if (CurrentTestFailedChecks > 0)
+		{
+			++FailedTestCount;
+			std::cout << LeviathanCore::String::Printf("[ FAILED ] %s (%zu failed checks)", CurrentTestName.c_str(), CurrentTestFailedChecks).c_str() << '\n';
+		}
+		else
+		{
+			std::cout << LeviathanCore::String::Printf("[     OK ] %s", CurrentTestName.c_str()).c_str() << '\n';
+		}
+		std::cout.flush();
+	}
+}
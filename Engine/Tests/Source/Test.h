@@ -0,0 +1,59 @@
+#pragma once
+
+namespace LeviathanTests
+{
+	struct TestSettings
+	{
+		// Only tests whose name contains the filter are run. An empty filter runs every test.
+		std::string Filter = {};
+	};
+
+	class Tester
+	{
+	private:
+		TestSettings Settings = {};
+		std::string CurrentTestName = {};
+		size_t CurrentTestFailedChecks = 0;
+		size_t TestCount = 0;
+		size_t FailedTestCount = 0;
+
+	public:
+		Tester(const TestSettings& settings);
+
+		// Returns true if the test name passes the settings filter.
+		bool IsEnabled(std::string_view name) const;
+
+		// Runs the test function and records the test as failed if any check made while it runs fails. Does nothing if the test was filtered out.
+		template <typename Function>
+		void Run(std::string_view name, Function&& function)
+		{
+			if (!IsEnabled(name))
+			{
+				return;
+			}
+
+			BeginTest(name);
+			function();
+			EndTest();
+		}
+
+		// Fails the current test if the condition is false. Use the LEVIATHAN_TEST_CHECK macros to capture the expression and location.
+		bool Check(const bool condition, const char* expression, const char* file, const int line);
+		bool CheckEqual(const double actual, const double expected, const char* expression, const char* file, const int line);
+		bool CheckLessOrEqual(const double actual, const double limit, const char* expression, const char* file, const int line);
+
+		// Prints the number of passed and failed tests to standard output.
+		void PrintSummary() const;
+
+		inline size_t GetTestCount() const { return TestCount; }
+		inline size_t GetFailedTestCount() const { return FailedTestCount; }
+
+	private:
+		void BeginTest(std::string_view name);
+		void EndTest();
+	};
+}
+
+#define LEVIATHAN_TEST_CHECK(tester, condition) (tester).Check((condition), #condition, __FILE__, __LINE__)
+#define LEVIATHAN_TEST_CHECK_EQUAL(tester, actual, expected) (tester).CheckEqual(static_cast<double>(actual), static_cast<double>(expected), #actual " == " #expected, __FILE__, __LINE__)
+#define LEVIATHAN_TEST_CHECK_LESS_OR_EQUAL(tester, actual, limit) (tester).CheckLessOrEqual(static_cast<double>(actual), static_cast<double>(limit), #actual " <= " #limit, __FILE__, __LINE__)
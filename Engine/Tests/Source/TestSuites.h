@@ -0,0 +1,78 @@
+#pragma once
+
+namespace LeviathanTests
+{
+	class Tester;
+
+	// FastMath scalar functions against libm within their documented max ULP errors and array functions against the scalar functions.
+	void RunMathTests(Tester& tester);
+
+	// Serialize byte order and buffer and file round trips.
+	void RunCoreTests(Tester& tester);
+
+	// Frustum plane extraction against clip space and batched bounding volume tests against the scalar tests.
+	void RunBoundingVolumeTests(Tester& tester);
+
+	// Renderer frustum culling stage against scalar frustum tests on the calling thread and on the job system.
+	void RunVisibilityTests(Tester& tester);
+
+	// DynamicAABBTree structure, proxy destruction and overlap, frustum, ray and nearest queries against brute force tests over moving objects.
+	void RunSpatialTests(Tester& tester);
+
+	// TransformHierarchy world matrices against Matrix4x4 products, world changed flags, reparenting and destruction.
+	void RunHierarchyTests(Tester& tester);
+
+	// TriangleBVH closest and any hit single ray and packet queries against brute force on the calling thread and on the job system.
+	void RunRayTracingTests(Tester& tester);
+
+	// Render command queue execution against each draw executed in sort key order and redundant state filtering against a renderer api state model.
+	void RunRenderCommandTests(Tester& tester);
+
+	// Render world storage after transform updates and id stable destruction, and draw lists against brute force frustum tests and Matrix4x4 products.
+	void RunRenderWorldTests(Tester& tester);
+
+	// Instance batches covering every draw once in draw list order with one batch per mesh and material, on the calling thread and on the job system.
+	void RunInstanceBatchingTests(Tester& tester);
+
+	// Upload ring alignment, bounds and data of every frame intact until its fence completes over simulated frames with a lagging gpu.
+	void RunUploadRingTests(Tester& tester);
+
+	// Clustered light assignment against testing every light against every cluster and spot light bounds enclosing their cones.
+	void RunClusteredLightingTests(Tester& tester);
+
+	// Light object lists and light batch lists against scalar sphere and cone tests on the calling thread and on the job system.
+	void RunLightInfluenceTests(Tester& tester);
+
+	// Software occlusion culling with every occluded object checked for visibility by rays against the occluders, and draw lists with occlusion.
+	void RunOcclusionCullingTests(Tester& tester);
+
+	// Quadric simplification and level of detail chains of a bumpy sphere with a texture seam, checked for cracks and deviation from the source surface, and level of detail selection within the pixel error budget.
+	void RunMeshSimplificationTests(Tester& tester);
+
+	// Meshlets checked for triangle coverage, local index layout and bounds, and cluster culling against scalar tests, for culled front faces and index buffer compaction.
+	void RunMeshletTests(Tester& tester);
+
+	// Render graph compilation against reference pass culling by read to writer dependencies, for resource lifetimes covering every access and for aliased resources sharing memory while alive at the same time.
+	void RunRenderGraphTests(Tester& tester);
+
+	// Shader cache recompiling nothing when warm or after a pack round trip, recompiling exactly the shaders affected by a header or macro edit, rejecting a corrupt pack and ignoring includes in comments.
+	void RunShaderCacheTests(Tester& tester);
+
+	// Shader permutations loaded once each, compiled with every feature defined to its value, rejecting keys outside of the features and loading nothing on first use after prewarming from a usage list.
+	void RunShaderPermutationTests(Tester& tester);
+
+	// Upload queue creating each upload once with its data in priority order within the frame budget, when requested from every job thread, creating urgent uploads next frame and reporting cancellation and failure.
+	void RunUploadQueueTests(Tester& tester);
+
+	// Texture streaming keeping the resident mips within the pool and frame limit, evicting least recently demanded textures first, settling at the expected mip and not thrashing between views, and streamable texture mip chains and files.
+	void RunTextureStreamingTests(Tester& tester);
+
+	// Gpu memory tracking matching the resources' sizes, reclaiming only unused resources by priority and recency and reporting each exceeded budget once, and texture sizes of every format.
+	void RunGpuMemoryTests(Tester& tester);
+
+	// Equirectangular to cubemap conversion checked against the environment at every texel's direction and its mean radiance, for matching the single thread conversion, round tripping cubemap files and rounding to the nearest half.
+	void RunEnvironmentCubemapTests(Tester& tester);
+
+	// Image based lighting bakes checked against the analytic irradiance and mirror reflection of the environment, a constant environment and quadrature of the BRDF, for matching the single thread bake and round tripping files.
+	void RunImageBasedLightingTests(Tester& tester);
+}
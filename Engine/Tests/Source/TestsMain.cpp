@@ -0,0 +1,90 @@
+#include "Test.h"
+#include "TestSuites.h"
+#include "Logging.h"
+
+namespace LeviathanTests
+{
+	struct TestSuite
+	{
+		std::string_view Name = {};
+		void(*Run)(Tester&) = nullptr;
+	};
+
+	// Suite names must match the add_test registrations in CMakeLists.txt.
+	static constexpr std::array TestSuites =
+	{
+		TestSuite{ "Math", &RunMathTests },
+		TestSuite{ "Core", &RunCoreTests },
+		TestSuite{ "BoundingVolume", &RunBoundingVolumeTests },
+		TestSuite{ "Visibility", &RunVisibilityTests },
+		TestSuite{ "Spatial", &RunSpatialTests },
+		TestSuite{ "Hierarchy", &RunHierarchyTests },
+		TestSuite{ "RayTracing", &RunRayTracingTests },
+		TestSuite{ "RenderCommand", &RunRenderCommandTests },
+		TestSuite{ "RenderWorld", &RunRenderWorldTests },
+		TestSuite{ "InstanceBatching", &RunInstanceBatchingTests },
+		TestSuite{ "UploadRing", &RunUploadRingTests },
+		TestSuite{ "ClusteredLighting", &RunClusteredLightingTests },
+		TestSuite{ "LightInfluence", &RunLightInfluenceTests },
+		TestSuite{ "OcclusionCulling", &RunOcclusionCullingTests },
+		TestSuite{ "MeshSimplification", &RunMeshSimplificationTests },
+		TestSuite{ "Meshlet", &RunMeshletTests },
+		TestSuite{ "RenderGraph", &RunRenderGraphTests },
+		TestSuite{ "ShaderCache", &RunShaderCacheTests },
+		TestSuite{ "ShaderPermutation", &RunShaderPermutationTests },
+		TestSuite{ "UploadQueue", &RunUploadQueueTests },
+		TestSuite{ "TextureStreaming", &RunTextureStreamingTests },
+		TestSuite{ "GpuMemory", &RunGpuMemoryTests },
+		TestSuite{ "EnvironmentCubemap", &RunEnvironmentCubemapTests },
+		TestSuite{ "ImageBasedLighting", &RunImageBasedLightingTests },
+	};
+}
+
+// Usage: LeviathanTests [--suite <name>] [--filter <substring>]
+// Returns 1 if any test fails.
+int main(int argc, char* argv[])
+{
+	LeviathanTests::TestSettings settings = {};
+	std::string_view suite = {};
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string_view argument = argv[i];
+		const bool hasValue = (i + 1 < argc);
+
+		if ((argument == "--suite") && hasValue)
+		{
+			suite = argv[++i];
+		}
+		else if ((argument == "--filter") && hasValue)
+		{
+			settings.Filter = argv[++i];
+		}
+		else
+		{
+			LEVIATHAN_LOG("Unknown argument %s. Usage: LeviathanTests [--suite <name>] [--filter <substring>]", argv[i]);
+			return 1;
+		}
+	}
+
+	LeviathanTests::Tester tester(settings);
+	bool suiteFound = suite.empty();
+	for (const LeviathanTests::TestSuite& testSuite : LeviathanTests::TestSuites)
+	{
+		if (suite.empty() || (testSuite.Name == suite))
+		{
+			suiteFound = true;
+			testSuite.Run(tester);
+		}
+	}
+
+	if (!suiteFound)
+	{
+		LEVIATHAN_LOG("Unknown test suite %s.", std::string(suite).c_str());
+		return 1;
+	}
+
+	tester.PrintSummary();
+
+	return (tester.GetFailedTestCount() == 0) ? 0 : 1;
+}
@@ -0,0 +1,694 @@
+#include "TestSuites.h"
+#include "Test.h"
+#include "TextureStreaming.h"
+#include "Camera.h"
+#include "StreamableTexture.h"
+#include "AssetTypes.h"
+#include "Serialize.h"
+#include "JobSystem.h"
+
+namespace LeviathanTests
+{
+	static constexpr size_t StreamingTextureCount = 1024;
+	static constexpr size_t StreamingObjectCount = 4096;
+	static constexpr size_t StreamingFrameCount = 300;
+	static constexpr size_t StreamingPoolBytes = 128 * 1024 * 1024;
+	static constexpr size_t StreamingBytesPerFrame = 4 * 1024 * 1024;
+	static constexpr uint32_t StreamingBytesPerPixel = 4;
+	static constexpr uint32_t StreamingHysteresisUpdates = 30;
+	static constexpr float StreamingViewportHeight = 1080.0f;
+	static constexpr float StreamingFovYDegrees = 60.0f;
+	// Texture repeats per world unit of the objects' surfaces.
+	static constexpr float StreamingTextureCoordinateDensity = 0.25f;
+	static constexpr float StreamingCorridorLength = 2000.0f;
+
+	struct StreamingTextureRecord
+	{
+		uint32_t Width = 0;
+		uint32_t Height = 0;
+		uint32_t MipCount = 0;
+	};
+
+	struct StreamingScene
+	{
+		std::vector<StreamingTextureRecord> Textures = {};
+		std::vector<LeviathanCore::BoundingVolumes::Sphere> Bounds = {};
+		std::vector<uint32_t> ObjectTextures = {};
+	};
+
+	static uint32_t GetStreamingMipCount(const uint32_t width, const uint32_t height)
+	{
+		return static_cast<uint32_t>(std::bit_width(std::max(width, height)));
+	}
+
+	static size_t GetStreamingChainBytes(const StreamingTextureRecord& texture, const uint32_t firstMip)
+	{
+		size_t bytes = 0;
+		for (uint32_t mip = firstMip; mip < texture.MipCount; ++mip)
+		{
+			bytes += static_cast<size_t>(std::max(texture.Width >> mip, 1u)) * std::max(texture.Height >> mip, 1u) * StreamingBytesPerPixel;
+		}
+		return bytes;
+	}
+
+	// Textures of 256 to 2048 texels on objects spread along a corridor the camera flies through.
+	static void MakeStreamingScene(StreamingScene& scene)
+	{
+		std::mt19937 random(47);
+		scene.Textures.resize(StreamingTextureCount);
+		for (StreamingTextureRecord& texture : scene.Textures)
+		{
+			texture.Width = 256u << (random() % 4);
+			texture.Height = texture.Width >> (random() % 2);
+			texture.MipCount = GetStreamingMipCount(texture.Width, texture.Height);
+		}
+
+		std::uniform_real_distribution<float> offsetDistribution(-60.0f, 60.0f);
+		std::uniform_real_distribution<float> depthDistribution(0.0f, StreamingCorridorLength);
+		std::uniform_real_distribution<float> radiusDistribution(1.0f, 4.0f);
+		scene.Bounds.resize(StreamingObjectCount);
+		scene.ObjectTextures.resize(StreamingObjectCount);
+		for (size_t i = 0; i < StreamingObjectCount; ++i)
+		{
+			scene.Bounds[i].Center = LeviathanCore::MathTypes::Vector3(offsetDistribution(random), offsetDistribution(random) * 0.25f, depthDistribution(random));
+			scene.Bounds[i].Radius = radiusDistribution(random);
+			scene.ObjectTextures[i] = static_cast<uint32_t>(random() % StreamingTextureCount);
+		}
+	}
+
+	static LeviathanRenderer::Camera MakeStreamingCamera(const float z)
+	{
+		LeviathanRenderer::Camera camera = {};
+		camera.SetFovY(StreamingFovYDegrees);
+		camera.SetPosition(LeviathanCore::MathTypes::Vector3(0.0f, 0.0f, z));
+		camera.UpdateViewMatrix();
+		camera.UpdateProjectionMatrix(1920, static_cast<int>(StreamingViewportHeight));
+		camera.UpdateViewProjectionMatrix();
+		return camera;
+	}
+
+	// Adds the demand of every object in the camera's frustum and records the frame each demanded texture was last demanded in.
+	static void AddStreamingDemand(LeviathanRenderer::TextureStreamer& streamer, const StreamingScene& scene, const std::vector<LeviathanRenderer::StreamedTextureId>& ids,
+		const LeviathanRenderer::Camera& camera, std::vector<size_t>& lastDemandFrames, const size_t frame)
+	{
+		const LeviathanCore::BoundingVolumes::Frustum frustum = camera.GetFrustum();
+		for (size_t i = 0; i < scene.Bounds.size(); ++i)
+		{
+			if (!frustum.Intersects(scene.Bounds[i]))
+			{
+				continue;
+			}
+
+			const uint32_t textureIndex = scene.ObjectTextures[i];
+			const StreamingTextureRecord& texture = scene.Textures[textureIndex];
+			const float texelsPerWorldUnit = static_cast<float>(std::max(texture.Width, texture.Height)) * StreamingTextureCoordinateDensity;
+			streamer.AddDemand(ids[textureIndex], LeviathanRenderer::GetTextureMipDemand(camera, scene.Bounds[i], texelsPerWorldUnit, StreamingViewportHeight));
+			lastDemandFrames[textureIndex] = frame;
+		}
+	}
+
+	struct CountingStreamingBackend
+	{
+		size_t StreamInCount = 0;
+		size_t StreamOutCount = 0;
+
+		LeviathanRenderer::StreamInResult StreamIn(LeviathanRenderer::StreamedTextureId, uint32_t, uint32_t)
+		{
+			++StreamInCount;
+			return LeviathanRenderer::StreamInResult::Loaded;
+		}
+
+		void StreamOut(LeviathanRenderer::StreamedTextureId, uint32_t)
+		{
+			++StreamOutCount;
+		}
+	};
+
+	// Mirrors the resident mips of every texture from the operations it receives and checks each operation against the mirror.
+	struct RecordingStreamingBackend
+	{
+		const StreamingScene* Scene = nullptr;
+		std::vector<uint32_t> ResidentMips = {};
+		// Every FailInterval-th stream in fails when not 0.
+		size_t FailInterval = 0;
+
+		size_t StreamInCount = 0;
+		size_t FailedStreamIns = 0;
+		size_t StreamedInBytes = 0;
+		size_t ProtocolErrors = 0;
+		// Stream in bytes, stream ins and mips of the single stream in of the current frame.
+		size_t FrameStreamInBytes = 0;
+		size_t FrameStreamIns = 0;
+		uint32_t FrameStreamInMips = 0;
+		// Last demand frames of the textures evicted in the current frame, in eviction order.
+		std::vector<size_t> FrameEvictions = {};
+		const std::vector<size_t>* LastDemandFrames = nullptr;
+
+		LeviathanRenderer::StreamInResult StreamIn(const LeviathanRenderer::StreamedTextureId texture, const uint32_t firstMip, const uint32_t residentMip)
+		{
+			ProtocolErrors += ((residentMip != ResidentMips[texture]) || (firstMip >= residentMip)) ? 1 : 0;
+			++StreamInCount;
+			++FrameStreamIns;
+			FrameStreamInMips = residentMip - firstMip;
+			const size_t bytes = GetStreamingChainBytes(Scene->Textures[texture], firstMip) - GetStreamingChainBytes(Scene->Textures[texture], residentMip);
+			FrameStreamInBytes += bytes;
+			if ((FailInterval > 0) && (StreamInCount % FailInterval == 0))
+			{
+				++FailedStreamIns;
+				return LeviathanRenderer::StreamInResult::Failed;
+			}
+			StreamedInBytes += bytes;
+			ResidentMips[texture] = firstMip;
+			return LeviathanRenderer::StreamInResult::Loaded;
+		}
+
+		void StreamOut(const LeviathanRenderer::StreamedTextureId texture, const uint32_t firstMip)
+		{
+			ProtocolErrors += (firstMip <= ResidentMips[texture]) ? 1 : 0;
+			ResidentMips[texture] = firstMip;
+			FrameEvictions.push_back((*LastDemandFrames)[texture]);
+		}
+	};
+
+	// Starts every stream in as a background read of the reader and reports it as loading.
+	struct ReadingStreamingBackend
+	{
+		LeviathanRenderer::TextureMipReader* Reader = nullptr;
+		LeviathanRenderer::TextureMipReader::ReadCallbackType ReadMips = nullptr;
+		void* ReadUserData = nullptr;
+		size_t StreamInCount = 0;
+
+		LeviathanRenderer::StreamInResult StreamIn(const LeviathanRenderer::StreamedTextureId texture, const uint32_t firstMip, const uint32_t residentMip)
+		{
+			++StreamInCount;
+			Reader->Read(texture, firstMip, residentMip, ReadMips, ReadUserData);
+			return LeviathanRenderer::StreamInResult::Loading;
+		}
+
+		void StreamOut(LeviathanRenderer::StreamedTextureId, uint32_t)
+		{
+		}
+	};
+
+	// Read that does not finish until it is released, or gives up after a timeout so that a blocking caller fails the test instead of hanging it.
+	struct GatedMipRead
+	{
+		std::atomic<bool> Released = false;
+		std::atomic<bool> TimedOut = false;
+		std::atomic<size_t> FinishedReads = 0;
+
+		static bool ReadMips(const uint32_t firstMip, const uint32_t mipCount, std::vector<uint8_t>& outMipData, void* userData)
+		{
+			GatedMipRead& read = *static_cast<GatedMipRead*>(userData);
+			const std::chrono::steady_clock::time_point timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+			while (!read.Released.load(std::memory_order_acquire))
+			{
+				if (std::chrono::steady_clock::now() > timeout)
+				{
+					read.TimedOut.store(true, std::memory_order_release);
+					break;
+				}
+				std::this_thread::yield();
+			}
+			outMipData.assign(static_cast<size_t>(mipCount) * 4, static_cast<uint8_t>(firstMip));
+			read.FinishedReads.fetch_add(1, std::memory_order_release);
+			return true;
+		}
+	};
+
+	// Bytes streamed in from the second half of alternating views of two sets of textures that do not fit the pool together at full resolution.
+	static size_t MeasureStreamingThrashBytes(const uint32_t hysteresisUpdates)
+	{
+		static constexpr size_t SetTextureCount = 8;
+		static constexpr uint32_t SetTextureSize = 1024;
+		static constexpr size_t ViewFrames = 8;
+		static constexpr size_t Frames = 240;
+
+		LeviathanRenderer::TextureStreamingSettings settings = {};
+		settings.PoolBytes = 64 * 1024 * 1024;
+		settings.HysteresisUpdates = hysteresisUpdates;
+		LeviathanRenderer::TextureStreamer streamer(settings);
+		std::vector<LeviathanRenderer::StreamedTextureId> ids(2 * SetTextureCount);
+		const uint32_t mipCount = GetStreamingMipCount(SetTextureSize, SetTextureSize);
+		for (LeviathanRenderer::StreamedTextureId& id : ids)
+		{
+			id = streamer.Register(SetTextureSize, SetTextureSize, mipCount, StreamingBytesPerPixel);
+		}
+
+		CountingStreamingBackend backend = {};
+		size_t thrashBytes = 0;
+		for (size_t frame = 0; frame < Frames; ++frame)
+		{
+			const size_t set = (frame / ViewFrames) % 2;
+			for (size_t i = 0; i < SetTextureCount; ++i)
+			{
+				streamer.AddDemand(ids[(set * SetTextureCount) + i], 0.0f);
+			}
+			const uint64_t streamedInBytes = streamer.GetStats().StreamedInBytes;
+			streamer.Update(backend);
+			thrashBytes += (frame >= Frames / 2) ? static_cast<size_t>(streamer.GetStats().StreamedInBytes - streamedInBytes) : 0;
+		}
+		return thrashBytes;
+	}
+
+	// A 1024x384 texture of random texels built into a linear mip chain.
+	struct StreamableTextureFixture
+	{
+		static constexpr uint32_t Width = 1024;
+		static constexpr uint32_t Height = 384;
+
+		std::vector<uint8_t> Pixels = {};
+		LeviathanAssets::AssetTypes::Texture Texture = {};
+		LeviathanAssets::StreamableTexture::Header Header = {};
+		std::vector<uint8_t> MipData = {};
+
+		StreamableTextureFixture()
+		{
+			std::mt19937 random(470);
+			Pixels.resize(static_cast<size_t>(Width) * Height * LeviathanAssets::StreamableTexture::BytesPerPixel);
+			for (uint8_t& value : Pixels)
+			{
+				value = static_cast<uint8_t>(random());
+			}
+			Texture.Width = static_cast<int>(Width);
+			Texture.Height = static_cast<int>(Height);
+			Texture.Num8BitComponentsPerPixel = static_cast<int>(LeviathanAssets::StreamableTexture::BytesPerPixel);
+			Texture.Data = Pixels.data();
+			LeviathanAssets::StreamableTexture::BuildMipChain(Texture, false, Header, MipData);
+		}
+	};
+
+	static std::string MakeStreamableTextureFile(const std::string_view name)
+	{
+		return (std::filesystem::temp_directory_path() / ("LeviathanTests" + std::string(name) + ".lstx")).string();
+	}
+
+	void RunTextureStreamingTests(Tester& tester)
+	{
+		// A camera flying down the corridor with failing stream ins: operations continue from the resident mips, resident bytes stay within the
+		// pool, stream ins stay within the frame limit and evictions are ordered from the least recently demanded texture.
+		tester.Run("TextureStreaming.Update.Flythrough", [&]()
+			{
+				StreamingScene scene = {};
+				MakeStreamingScene(scene);
+
+				LeviathanRenderer::TextureStreamingSettings settings = {};
+				settings.PoolBytes = StreamingPoolBytes;
+				settings.MaxStreamInBytesPerUpdate = StreamingBytesPerFrame;
+				settings.TailSize = 64;
+				settings.HysteresisUpdates = StreamingHysteresisUpdates;
+				LeviathanRenderer::TextureStreamer streamer(settings);
+				std::vector<LeviathanRenderer::StreamedTextureId> ids(scene.Textures.size());
+				for (size_t i = 0; i < scene.Textures.size(); ++i)
+				{
+					ids[i] = streamer.Register(scene.Textures[i].Width, scene.Textures[i].Height, scene.Textures[i].MipCount, StreamingBytesPerPixel);
+				}
+
+				std::vector<size_t> lastDemandFrames(scene.Textures.size(), 0);
+				RecordingStreamingBackend backend = {};
+				backend.Scene = &scene;
+				backend.FailInterval = 13;
+				backend.LastDemandFrames = &lastDemandFrames;
+				backend.ResidentMips.resize(scene.Textures.size());
+				for (size_t i = 0; i < scene.Textures.size(); ++i)
+				{
+					backend.ResidentMips[i] = streamer.GetTailMip(ids[i]);
+				}
+
+				size_t residencyMismatches = 0;
+				size_t poolOverruns = 0;
+				size_t streamLimitViolations = 0;
+				size_t lruOrderViolations = 0;
+				for (size_t frame = 0; frame < StreamingFrameCount; ++frame)
+				{
+					const float z = StreamingCorridorLength * static_cast<float>(frame) / static_cast<float>(StreamingFrameCount);
+					AddStreamingDemand(streamer, scene, ids, MakeStreamingCamera(z), lastDemandFrames, frame);
+					backend.FrameStreamInBytes = 0;
+					backend.FrameStreamIns = 0;
+					backend.FrameEvictions.clear();
+					streamer.Update(backend);
+
+					size_t residentBytes = 0;
+					for (size_t i = 0; i < scene.Textures.size(); ++i)
+					{
+						residencyMismatches += (backend.ResidentMips[i] != streamer.GetResidentMip(ids[i])) ? 1 : 0;
+						residentBytes += GetStreamingChainBytes(scene.Textures[i], backend.ResidentMips[i]);
+					}
+					residencyMismatches += (residentBytes != streamer.GetResidentBytes()) ? 1 : 0;
+					poolOverruns += (residentBytes > StreamingPoolBytes) ? 1 : 0;
+					streamLimitViolations += ((backend.FrameStreamInBytes > StreamingBytesPerFrame) && ((backend.FrameStreamIns > 1) || (backend.FrameStreamInMips > 1))) ? 1 : 0;
+					for (size_t i = 1; i < backend.FrameEvictions.size(); ++i)
+					{
+						lruOrderViolations += (backend.FrameEvictions[i - 1] > backend.FrameEvictions[i]) ? 1 : 0;
+					}
+				}
+
+				const LeviathanRenderer::TextureStreamingStats& stats = streamer.GetStats();
+				LEVIATHAN_TEST_CHECK(tester, backend.StreamedInBytes > 0);
+				LEVIATHAN_TEST_CHECK(tester, stats.EvictedBytes > 0);
+				LEVIATHAN_TEST_CHECK(tester, backend.FailedStreamIns > 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, residencyMismatches, 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, backend.ProtocolErrors, 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, poolOverruns, 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, streamLimitViolations, 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, lruOrderViolations, 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, stats.FailedStreamIns, backend.FailedStreamIns);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, stats.StreamedInBytes, backend.StreamedInBytes);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, stats.ResidentBytes, streamer.GetResidentBytes());
+			});
+
+		// Textures of objects at known distances settle at the mip whose texel density matches the pixel density at the object's nearest point.
+		tester.Run("TextureStreaming.Demand.SettlesAtExpectedMip", [&]()
+			{
+				LeviathanRenderer::TextureStreamingSettings settings = {};
+				settings.PoolBytes = std::numeric_limits<size_t>::max();
+				settings.HysteresisUpdates = 0;
+				LeviathanRenderer::TextureStreamer streamer(settings);
+				const LeviathanRenderer::Camera camera = MakeStreamingCamera(0.0f);
+				const float pixelsPerUnit = 0.5f * StreamingViewportHeight / std::tan(LeviathanCore::MathLibrary::DegreesToRadians(StreamingFovYDegrees) * 0.5f);
+
+				static constexpr uint32_t TextureSize = 2048;
+				static constexpr size_t DistanceCount = 64;
+				const uint32_t mipCount = GetStreamingMipCount(TextureSize, TextureSize);
+				std::vector<LeviathanRenderer::StreamedTextureId> ids(DistanceCount);
+				std::vector<LeviathanCore::BoundingVolumes::Sphere> bounds(DistanceCount);
+				for (size_t i = 0; i < DistanceCount; ++i)
+				{
+					ids[i] = streamer.Register(TextureSize, TextureSize, mipCount, StreamingBytesPerPixel);
+					bounds[i].Center = LeviathanCore::MathTypes::Vector3(0.0f, 0.0f, 2.0f + (1.37f * static_cast<float>(i * i)));
+					bounds[i].Radius = 1.0f;
+				}
+
+				CountingStreamingBackend backend = {};
+				for (size_t update = 0; update < 2; ++update)
+				{
+					for (size_t i = 0; i < DistanceCount; ++i)
+					{
+						streamer.AddDemand(ids[i], LeviathanRenderer::GetTextureMipDemand(camera, bounds[i],
+							static_cast<float>(TextureSize) * StreamingTextureCoordinateDensity, StreamingViewportHeight));
+					}
+					streamer.Update(backend);
+				}
+
+				size_t demandMipMismatches = 0;
+				for (size_t i = 0; i < DistanceCount; ++i)
+				{
+					const float distance = bounds[i].Center.Z() - bounds[i].Radius;
+					const float texelsPerPixel = static_cast<float>(TextureSize) * StreamingTextureCoordinateDensity * distance / pixelsPerUnit;
+					const float mip = std::floor(std::log2(texelsPerPixel));
+					const uint32_t expectedMip = std::min((mip <= 0.0f) ? 0u : static_cast<uint32_t>(mip), streamer.GetTailMip(ids[i]));
+					demandMipMismatches += (streamer.GetResidentMip(ids[i]) != expectedMip) ? 1 : 0;
+				}
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, demandMipMismatches, 0);
+			});
+
+		// Views switching between two sets of textures faster than the hysteresis settle at a budget both sets fit, while streaming without
+		// hysteresis evicts each set for the other on every switch.
+		tester.Run("TextureStreaming.Hysteresis.AvoidsThrashing", [&]()
+			{
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, MeasureStreamingThrashBytes(StreamingHysteresisUpdates), 0);
+				LEVIATHAN_TEST_CHECK(tester, MeasureStreamingThrashBytes(0) > 0);
+			});
+
+		// A stream in that fails after its update releases its mips once, and is ignored after a later update changed the texture's residency.
+		tester.Run("TextureStreaming.RevertStreamIn.ReleasesFailedMips", [&]()
+			{
+				LeviathanRenderer::TextureStreamingSettings settings = {};
+				settings.PoolBytes = std::numeric_limits<size_t>::max();
+				LeviathanRenderer::TextureStreamer streamer(settings);
+				static constexpr uint32_t TextureSize = 1024;
+				LeviathanRenderer::StreamedTextureId id = streamer.Register(TextureSize, TextureSize, GetStreamingMipCount(TextureSize, TextureSize),
+					StreamingBytesPerPixel);
+				const uint32_t tailMip = streamer.GetTailMip(id);
+				const size_t tailBytes = streamer.GetResidentBytes();
+
+				CountingStreamingBackend backend = {};
+				streamer.AddDemand(id, 2.0f);
+				streamer.Update(backend);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, streamer.GetResidentMip(id), 2);
+				streamer.RevertStreamIn(id, 2, tailMip);
+				streamer.RevertStreamIn(id, 2, tailMip);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, streamer.GetResidentMip(id), tailMip);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, streamer.GetResidentBytes(), tailBytes);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, streamer.GetStats().FailedStreamIns, 1);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, streamer.GetStats().StreamedInMips, 0);
+
+				streamer.AddDemand(id, 2.0f);
+				streamer.Update(backend);
+				streamer.AddDemand(id, 0.0f);
+				streamer.Update(backend);
+				streamer.RevertStreamIn(id, 2, tailMip);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, streamer.GetResidentMip(id), 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, streamer.GetStats().FailedStreamIns, 1);
+				streamer.Unregister(id);
+			});
+
+		// A loading stream in keeps the texture at its resident mip with the stream in's memory reserved, is not streamed again while loading and
+		// reaches its mip when completed. A reverted loading stream in releases the reserved memory.
+		tester.Run("TextureStreaming.StreamIn.Loading", [&]()
+			{
+				LeviathanRenderer::TextureStreamingSettings settings = {};
+				settings.PoolBytes = std::numeric_limits<size_t>::max();
+				LeviathanRenderer::TextureStreamer streamer(settings);
+				static constexpr uint32_t TextureSize = 1024;
+				LeviathanRenderer::StreamedTextureId id = streamer.Register(TextureSize, TextureSize, GetStreamingMipCount(TextureSize, TextureSize),
+					StreamingBytesPerPixel);
+				const uint32_t tailMip = streamer.GetTailMip(id);
+				const size_t tailBytes = streamer.GetResidentBytes();
+
+				LeviathanRenderer::TextureMipReader reader = {};
+				GatedMipRead gate = {};
+				gate.Released = true;
+				ReadingStreamingBackend backend = {};
+				backend.Reader = &reader;
+				backend.ReadMips = &GatedMipRead::ReadMips;
+				backend.ReadUserData = &gate;
+
+				streamer.AddDemand(id, 2.0f);
+				streamer.Update(backend);
+				LEVIATHAN_TEST_CHECK(tester, streamer.IsLoading(id));
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, streamer.GetResidentMip(id), tailMip);
+				LEVIATHAN_TEST_CHECK(tester, streamer.GetResidentBytes() > tailBytes);
+				const size_t loadingBytes = streamer.GetResidentBytes();
+
+				streamer.AddDemand(id, 0.0f);
+				streamer.Update(backend);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, backend.StreamInCount, 1);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, streamer.GetResidentBytes(), loadingBytes);
+
+				streamer.CompleteStreamIn(id, 2);
+				LEVIATHAN_TEST_CHECK(tester, !streamer.IsLoading(id));
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, streamer.GetResidentMip(id), 2);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, streamer.GetResidentBytes(), loadingBytes);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, streamer.GetStats().StreamedInMips, tailMip - 2);
+
+				streamer.AddDemand(id, 0.0f);
+				streamer.Update(backend);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, backend.StreamInCount, 2);
+				LEVIATHAN_TEST_CHECK(tester, streamer.IsLoading(id));
+				streamer.RevertStreamIn(id, 0, 2);
+				LEVIATHAN_TEST_CHECK(tester, !streamer.IsLoading(id));
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, streamer.GetResidentMip(id), 2);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, streamer.GetResidentBytes(), loadingBytes);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, streamer.GetStats().FailedStreamIns, 1);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, streamer.GetStats().StreamedInMips, tailMip - 2);
+
+				reader.Clear();
+				streamer.Unregister(id);
+			});
+
+		// A read that is still running holds up neither the update that started it nor later updates, and is collected on a later frame once it
+		// finishes.
+		tester.Run("TextureStreaming.MipReader.SlowReadDoesNotBlockUpdate", [&]()
+			{
+				LeviathanRenderer::TextureStreamingSettings settings = {};
+				settings.PoolBytes = std::numeric_limits<size_t>::max();
+				LeviathanRenderer::TextureStreamer streamer(settings);
+				static constexpr uint32_t TextureSize = 1024;
+				LeviathanRenderer::StreamedTextureId id = streamer.Register(TextureSize, TextureSize, GetStreamingMipCount(TextureSize, TextureSize),
+					StreamingBytesPerPixel);
+				const uint32_t tailMip = streamer.GetTailMip(id);
+
+				const bool startedJobSystem = LeviathanCore::JobSystem::Initialize(1);
+				{
+					LeviathanRenderer::TextureMipReader reader = {};
+					GatedMipRead gate = {};
+					ReadingStreamingBackend backend = {};
+					backend.Reader = &reader;
+					backend.ReadMips = &GatedMipRead::ReadMips;
+					backend.ReadUserData = &gate;
+
+					streamer.AddDemand(id, 2.0f);
+					streamer.Update(backend);
+					streamer.AddDemand(id, 2.0f);
+					streamer.Update(backend);
+					size_t collectedReads = 0;
+					reader.CollectFinished([&](const LeviathanRenderer::TextureMipRead&) { ++collectedReads; });
+					LEVIATHAN_TEST_CHECK_EQUAL(tester, gate.FinishedReads.load(std::memory_order_acquire), 0);
+					LEVIATHAN_TEST_CHECK_EQUAL(tester, collectedReads, 0);
+					LEVIATHAN_TEST_CHECK_EQUAL(tester, reader.GetReadCount(), 1);
+					LEVIATHAN_TEST_CHECK_EQUAL(tester, backend.StreamInCount, 1);
+					LEVIATHAN_TEST_CHECK_EQUAL(tester, streamer.GetResidentMip(id), tailMip);
+
+					gate.Released.store(true, std::memory_order_release);
+					const std::chrono::steady_clock::time_point timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+					while ((collectedReads == 0) && (std::chrono::steady_clock::now() < timeout))
+					{
+						reader.CollectFinished([&](const LeviathanRenderer::TextureMipRead& read)
+							{
+								++collectedReads;
+								LEVIATHAN_TEST_CHECK_EQUAL(tester, read.Texture, id);
+								LEVIATHAN_TEST_CHECK_EQUAL(tester, read.FirstMip, 2);
+								LEVIATHAN_TEST_CHECK_EQUAL(tester, read.PreviousMip, tailMip);
+								LEVIATHAN_TEST_CHECK(tester, read.Read);
+								LEVIATHAN_TEST_CHECK_EQUAL(tester, read.MipData.size(), static_cast<size_t>(tailMip - 2) * 4);
+								streamer.CompleteStreamIn(read.Texture, read.FirstMip);
+							});
+						std::this_thread::yield();
+					}
+					LEVIATHAN_TEST_CHECK_EQUAL(tester, collectedReads, 1);
+					LEVIATHAN_TEST_CHECK(tester, !gate.TimedOut.load(std::memory_order_acquire));
+					LEVIATHAN_TEST_CHECK_EQUAL(tester, reader.GetReadCount(), 0);
+					LEVIATHAN_TEST_CHECK_EQUAL(tester, streamer.GetResidentMip(id), 2);
+				}
+				if (startedJobSystem)
+				{
+					LeviathanCore::JobSystem::Shutdown();
+				}
+				streamer.Unregister(id);
+			});
+
+		// Every texel of a linear texture's mip is the rounded average of its 2x2 source texels.
+		tester.Run("StreamableTexture.BuildMipChain.Linear", [&]()
+			{
+				const StreamableTextureFixture fixture = {};
+				const LeviathanAssets::StreamableTexture::Header& header = fixture.Header;
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, header.MipCount, LeviathanAssets::StreamableTexture::GetMipCount(fixture.Width, fixture.Height));
+
+				size_t mipFilterErrors = 0;
+				for (uint32_t mip = 1; mip < header.MipCount; ++mip)
+				{
+					const LeviathanAssets::StreamableTexture::MipLevel& source = header.Mips[mip - 1];
+					const LeviathanAssets::StreamableTexture::MipLevel& target = header.Mips[mip];
+					for (uint32_t y = 0; y < target.Height; ++y)
+					{
+						for (uint32_t x = 0; x < target.Width; ++x)
+						{
+							for (uint32_t channel = 0; channel < LeviathanAssets::StreamableTexture::BytesPerPixel; ++channel)
+							{
+								float sum = 0.0f;
+								for (uint32_t sample = 0; sample < 4; ++sample)
+								{
+									const uint32_t sourceX = std::min((2 * x) + (sample % 2), source.Width - 1);
+									const uint32_t sourceY = std::min((2 * y) + (sample / 2), source.Height - 1);
+									sum += static_cast<float>(fixture.MipData[source.Offset + ((static_cast<size_t>(sourceY) * source.Width + sourceX) * 4) + channel]);
+								}
+								const float value = static_cast<float>(fixture.MipData[target.Offset + ((static_cast<size_t>(y) * target.Width + x) * 4) + channel]);
+								mipFilterErrors += (std::abs(value - (sum * 0.25f)) > 0.501f) ? 1 : 0;
+							}
+						}
+					}
+				}
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, mipFilterErrors, 0);
+			});
+
+		// Every mip of a constant sRGB texture keeps its color.
+		tester.Run("StreamableTexture.BuildMipChain.sRGBConstant", [&]()
+			{
+				StreamableTextureFixture fixture = {};
+				for (size_t i = 0; i < fixture.Pixels.size(); i += 4)
+				{
+					fixture.Pixels[i] = 200;
+					fixture.Pixels[i + 1] = 90;
+					fixture.Pixels[i + 2] = 17;
+					fixture.Pixels[i + 3] = 128;
+				}
+				LeviathanAssets::StreamableTexture::Header header = {};
+				std::vector<uint8_t> mipData = {};
+				LeviathanAssets::StreamableTexture::BuildMipChain(fixture.Texture, true, header, mipData);
+				LEVIATHAN_TEST_CHECK(tester, header.sRGB);
+
+				size_t mipFilterErrors = 0;
+				for (size_t i = 0; i < mipData.size(); ++i)
+				{
+					mipFilterErrors += (std::abs(static_cast<int>(mipData[i]) - static_cast<int>(fixture.Pixels[i % 4])) > 1) ? 1 : 0;
+				}
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, mipFilterErrors, 0);
+			});
+
+		// Saved files read back any range of mips with the built data and reject ranges past the last mip.
+		tester.Run("StreamableTexture.File.RoundTrip", [&]()
+			{
+				StreamableTextureFixture fixture = {};
+				fixture.Header.Source = { .SizeBytes = 12345, .WriteTime = 678910 };
+				const LeviathanAssets::StreamableTexture::Header& header = fixture.Header;
+				const std::string file = MakeStreamableTextureFile("StreamableTextureRoundTrip");
+				LeviathanAssets::StreamableTexture::Header loadedHeader = {};
+				LEVIATHAN_TEST_CHECK(tester, LeviathanAssets::StreamableTexture::Save(file, header, fixture.MipData));
+				LEVIATHAN_TEST_CHECK(tester, LeviathanAssets::StreamableTexture::LoadHeader(file, loadedHeader));
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, loadedHeader.Width, fixture.Width);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, loadedHeader.Height, fixture.Height);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, loadedHeader.MipCount, header.MipCount);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, loadedHeader.DataOffset, header.DataOffset);
+				LEVIATHAN_TEST_CHECK(tester, !loadedHeader.sRGB);
+				LEVIATHAN_TEST_CHECK(tester, loadedHeader.Source == header.Source);
+
+				size_t roundTripMismatches = 0;
+				std::vector<uint8_t> readData = {};
+				for (uint32_t firstMip = 0; firstMip < loadedHeader.MipCount; ++firstMip)
+				{
+					for (uint32_t mipCount = 1; firstMip + mipCount <= loadedHeader.MipCount; ++mipCount)
+					{
+						const LeviathanAssets::StreamableTexture::MipLevel& last = header.Mips[firstMip + mipCount - 1];
+						const size_t offset = static_cast<size_t>(header.Mips[firstMip].Offset);
+						const size_t sizeBytes = static_cast<size_t>(last.Offset + last.SizeBytes) - offset;
+						const bool read = LeviathanAssets::StreamableTexture::ReadMips(file, loadedHeader, firstMip, mipCount, readData);
+						roundTripMismatches += (read && (readData.size() == sizeBytes) && (memcmp(readData.data(), fixture.MipData.data() + offset, sizeBytes) == 0)) ? 0 : 1;
+					}
+				}
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, roundTripMismatches, 0);
+				LEVIATHAN_TEST_CHECK(tester, !LeviathanAssets::StreamableTexture::ReadMips(file, loadedHeader, header.MipCount - 1, 2, readData));
+
+				std::error_code errorCode = {};
+				std::filesystem::remove(file, errorCode);
+			});
+
+		// Files with a corrupt header or mip table, or truncated within the mip table, are rejected.
+		tester.Run("StreamableTexture.File.RejectCorrupt", [&]()
+			{
+				const StreamableTextureFixture fixture = {};
+				const std::string file = MakeStreamableTextureFile("StreamableTextureCorrupt");
+				std::vector<uint8_t> fileBytes = {};
+				LEVIATHAN_TEST_CHECK(tester, LeviathanAssets::StreamableTexture::Save(file, fixture.Header, fixture.MipData));
+				LEVIATHAN_TEST_CHECK(tester, LeviathanCore::Serialize::ReadFile(file, true, fileBytes));
+
+				// Magic, the mip count and the width of the second mip's table entry.
+				static constexpr size_t FileHeaderSize = (6 * sizeof(uint32_t)) + (2 * sizeof(uint64_t));
+				const std::array<size_t, 3> corruptOffsets = { 0, 4 * sizeof(uint32_t), FileHeaderSize + 24 };
+				size_t corruptFilesAccepted = 0;
+				for (const size_t corruptOffset : corruptOffsets)
+				{
+					if (corruptOffset >= fileBytes.size())
+					{
+						++corruptFilesAccepted;
+						continue;
+					}
+					std::vector<uint8_t> corruptBytes = fileBytes;
+					corruptBytes[corruptOffset] ^= 0x01;
+					LeviathanAssets::StreamableTexture::Header corruptHeader = {};
+					LEVIATHAN_TEST_CHECK(tester, LeviathanCore::Serialize::WriteBytesToFile(file, corruptBytes));
+					corruptFilesAccepted += LeviathanAssets::StreamableTexture::LoadHeader(file, corruptHeader) ? 1 : 0;
+				}
+
+				const size_t truncatedSize = std::min(fileBytes.size(), FileHeaderSize + 40);
+				const std::vector<uint8_t> truncatedBytes(fileBytes.begin(), fileBytes.begin() + truncatedSize);
+				LeviathanAssets::StreamableTexture::Header truncatedHeader = {};
+				LEVIATHAN_TEST_CHECK(tester, LeviathanCore::Serialize::WriteBytesToFile(file, truncatedBytes));
+				corruptFilesAccepted += LeviathanAssets::StreamableTexture::LoadHeader(file, truncatedHeader) ? 1 : 0;
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, corruptFilesAccepted, 0);
+
+				std::error_code errorCode = {};
+				std::filesystem::remove(file, errorCode);
+			});
+	}
+}
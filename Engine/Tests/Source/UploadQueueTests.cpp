@@ -0,0 +1,532 @@
+#include "TestSuites.h"
+#include "Test.h"
+#include "UploadQueue.h"
+#include "JobSystem.h"
+
+namespace LeviathanTests
+{
+	static constexpr size_t JobSystemWorkerCount = 3;
+	static constexpr size_t UploadRequestCount = 512;
+	static constexpr size_t UploadBudgetBytes = 1024 * 1024;
+	static constexpr size_t UploadSourceBytes = 8 * 1024 * 1024;
+	static constexpr uint8_t UploadPriorityCount = 4;
+
+	static uint64_t HashUploadBytes(const void* const data, const size_t sizeBytes, uint64_t hash = 14695981039346656037ull)
+	{
+		// FNV-1a.
+		const uint8_t* const bytes = static_cast<const uint8_t*>(data);
+		for (size_t i = 0; i < sizeBytes; ++i)
+		{
+			hash = (hash ^ bytes[i]) * 1099511628211ull;
+		}
+		return hash;
+	}
+
+	// A resource creation request reading its data from the shared source bytes and the results reported to its callback.
+	struct UploadRequestRecord
+	{
+		LeviathanRenderer::UploadResourceType Type = LeviathanRenderer::UploadResourceType::VertexBuffer;
+		uint8_t Priority = 0;
+		// Vertex or index count or texture or cube face width.
+		uint32_t Count = 0;
+		uint32_t Height = 0;
+		uint32_t StrideBytes = 0;
+		// Offset of the data or of each cube face in the source bytes.
+		std::array<size_t, LeviathanRenderer::UploadQueue::TextureCubeFaceCount> Offsets = {};
+		size_t SizeBytes = 0;
+		uint64_t ExpectedHash = 0;
+
+		LeviathanRenderer::UploadTicket Ticket = LeviathanRenderer::UploadQueue::InvalidTicket;
+		LeviathanRenderer::UploadResult Result = {};
+		uint32_t Callbacks = 0;
+	};
+
+	struct UploadScene
+	{
+		std::vector<uint8_t> Source = {};
+		std::vector<UploadRequestRecord> Requests = {};
+		size_t TotalBytes = 0;
+		// Tickets and priorities in the order callbacks were called.
+		std::vector<std::pair<uint8_t, LeviathanRenderer::UploadTicket>> CompletionOrder = {};
+	};
+
+	static void MakeUploadScene(UploadScene& scene)
+	{
+		std::mt19937 random(46);
+		scene.Source.resize(UploadSourceBytes);
+		for (uint8_t& byte : scene.Source)
+		{
+			byte = static_cast<uint8_t>(random());
+		}
+
+		scene.Requests.resize(UploadRequestCount);
+		scene.TotalBytes = 0;
+		for (UploadRequestRecord& request : scene.Requests)
+		{
+			request.Type = static_cast<LeviathanRenderer::UploadResourceType>(random() % 4);
+			request.Priority = static_cast<uint8_t>(random() % UploadPriorityCount);
+			size_t faceCount = 1;
+			switch (request.Type)
+			{
+			case LeviathanRenderer::UploadResourceType::VertexBuffer:
+				request.StrideBytes = 44;
+				request.Count = 64 + static_cast<uint32_t>(random() % 2048);
+				request.SizeBytes = static_cast<size_t>(request.Count) * request.StrideBytes;
+				break;
+
+			case LeviathanRenderer::UploadResourceType::IndexBuffer:
+				request.StrideBytes = sizeof(uint32_t);
+				request.Count = 96 + static_cast<uint32_t>(random() % 8192);
+				request.SizeBytes = static_cast<size_t>(request.Count) * request.StrideBytes;
+				break;
+
+			case LeviathanRenderer::UploadResourceType::Texture2D:
+				// Mostly small textures and a few larger than the budget.
+				request.Count = 16u << (random() % 7);
+				request.Height = 16u << (random() % 7);
+				request.StrideBytes = request.Count * 4;
+				request.SizeBytes = static_cast<size_t>(request.StrideBytes) * request.Height;
+				break;
+
+			case LeviathanRenderer::UploadResourceType::TextureCube:
+				request.Count = 16u << (random() % 4);
+				request.StrideBytes = request.Count * LeviathanRenderer::UploadQueue::TextureCubeBytesPerPixel;
+				faceCount = LeviathanRenderer::UploadQueue::TextureCubeFaceCount;
+				request.SizeBytes = static_cast<size_t>(request.StrideBytes) * request.Count;
+				break;
+
+			default:
+				break;
+			}
+
+			// Cube faces are read from unrelated offsets and staged back to back.
+			request.ExpectedHash = 14695981039346656037ull;
+			for (size_t face = 0; face < faceCount; ++face)
+			{
+				request.Offsets[face] = random() % (UploadSourceBytes - request.SizeBytes);
+				request.ExpectedHash = HashUploadBytes(scene.Source.data() + request.Offsets[face], request.SizeBytes, request.ExpectedHash);
+			}
+			request.SizeBytes *= faceCount;
+			scene.TotalBytes += request.SizeBytes;
+		}
+	}
+
+	static void OnUploadCompleted(const LeviathanRenderer::UploadResult& result, void* const userData)
+	{
+		UploadRequestRecord& request = *static_cast<UploadRequestRecord*>(userData);
+		request.Result = result;
+		++request.Callbacks;
+	}
+
+	static void OnUploadCompletedInOrder(const LeviathanRenderer::UploadResult& result, void* const userData)
+	{
+		UploadScene& scene = *static_cast<UploadScene*>(userData);
+		UploadRequestRecord& request = *std::find_if(scene.Requests.begin(), scene.Requests.end(),
+			[&result](const UploadRequestRecord& record) { return record.Ticket == result.Ticket; });
+		OnUploadCompleted(result, &request);
+		scene.CompletionOrder.emplace_back(request.Priority, result.Ticket);
+	}
+
+	static LeviathanRenderer::UploadTicket EnqueueUploadRequest(LeviathanRenderer::UploadQueue& queue, const UploadScene& scene, const UploadRequestRecord& request,
+		const LeviathanRenderer::UploadCompletedCallbackType callback, void* const userData)
+	{
+		const LeviathanRenderer::UploadDescription description = { .Priority = request.Priority, .Callback = callback, .UserData = userData };
+		const uint8_t* const data = scene.Source.data() + request.Offsets[0];
+		switch (request.Type)
+		{
+		case LeviathanRenderer::UploadResourceType::VertexBuffer:
+			return queue.EnqueueVertexBuffer(data, request.Count, request.StrideBytes, description);
+
+		case LeviathanRenderer::UploadResourceType::IndexBuffer:
+			return queue.EnqueueIndexBuffer(reinterpret_cast<const uint32_t*>(data), request.Count, description);
+
+		case LeviathanRenderer::UploadResourceType::Texture2D:
+			return queue.EnqueueTexture2D(request.Count, request.Height, data, request.StrideBytes, false, false, false, description);
+
+		case LeviathanRenderer::UploadResourceType::TextureCube:
+		{
+			std::array<const void*, LeviathanRenderer::UploadQueue::TextureCubeFaceCount> faces = {};
+			for (size_t face = 0; face < faces.size(); ++face)
+			{
+				faces[face] = scene.Source.data() + request.Offsets[face];
+			}
+			return queue.EnqueueTextureCube(request.Count, faces.data(), false, false, false, description);
+		}
+
+		default:
+			break;
+		}
+		return LeviathanRenderer::UploadQueue::InvalidTicket;
+	}
+
+	// Backend recording the hash of every created resource's data and the bytes created in the current frame. Creation of every FailInterval-th
+	// resource fails.
+	struct RecordingUploadBackend
+	{
+		size_t FailInterval = 0;
+		size_t CreatedCount = 0;
+		size_t FrameBytes = 0;
+		size_t FrameUploads = 0;
+		std::vector<uint64_t> Hashes = {};
+
+		// Mip updates in the order they were applied.
+		struct MipUpdate
+		{
+			LeviathanRenderer::RendererResourceId::IdType Id = LeviathanRenderer::RendererResourceId::InvalidId;
+			uint32_t MipCount = 0;
+			uint32_t LoadedMipCount = 0;
+			uint64_t Hash = 0;
+		};
+		std::vector<MipUpdate> MipUpdates = {};
+
+		bool Record(const size_t sizeBytes, const uint64_t hash, LeviathanRenderer::RendererResourceId::IdType& outId)
+		{
+			++FrameUploads;
+			FrameBytes += sizeBytes;
+			if ((FailInterval != 0) && ((++CreatedCount % FailInterval) == 0))
+			{
+				return false;
+			}
+			outId = static_cast<LeviathanRenderer::RendererResourceId::IdType>(Hashes.size());
+			Hashes.push_back(hash);
+			return true;
+		}
+
+		bool CreateVertexBuffer(const void* const vertexData, const uint32_t vertexCount, const size_t strideBytes, LeviathanRenderer::RendererResourceId::IdType& outId)
+		{
+			return Record(vertexCount * strideBytes, HashUploadBytes(vertexData, vertexCount * strideBytes), outId);
+		}
+
+		bool CreateIndexBuffer(const uint32_t* const indexData, const uint32_t indexCount, LeviathanRenderer::RendererResourceId::IdType& outId)
+		{
+			return Record(indexCount * sizeof(uint32_t), HashUploadBytes(indexData, indexCount * sizeof(uint32_t)), outId);
+		}
+
+		bool CreateTexture2D(uint32_t, const uint32_t height, const void* const data, const uint32_t rowSizeBytes, bool, bool, bool,
+			LeviathanRenderer::RendererResourceId::IdType& outId)
+		{
+			return Record(static_cast<size_t>(rowSizeBytes) * height, HashUploadBytes(data, static_cast<size_t>(rowSizeBytes) * height), outId);
+		}
+
+		bool CreateTextureCube(const uint32_t faceWidth, const void* const* const faceData, bool, const bool HDR, const bool halfFloat,
+			LeviathanRenderer::RendererResourceId::IdType& outId)
+		{
+			const uint32_t bytesPerPixel = (HDR) ? ((halfFloat) ? LeviathanRenderer::UploadQueue::HalfFloatTextureCubeBytesPerPixel :
+				LeviathanRenderer::UploadQueue::HDRTextureCubeBytesPerPixel) : LeviathanRenderer::UploadQueue::TextureCubeBytesPerPixel;
+			const size_t faceSizeBytes = static_cast<size_t>(faceWidth) * faceWidth * bytesPerPixel;
+			uint64_t hash = 14695981039346656037ull;
+			for (size_t face = 0; face < LeviathanRenderer::UploadQueue::TextureCubeFaceCount; ++face)
+			{
+				hash = HashUploadBytes(faceData[face], faceSizeBytes, hash);
+			}
+			return Record(faceSizeBytes * LeviathanRenderer::UploadQueue::TextureCubeFaceCount, hash, outId);
+		}
+
+		bool SetTexture2DMips(const LeviathanRenderer::RendererResourceId::IdType id, const uint32_t width, const uint32_t height, const uint32_t mipCount,
+			const void* const* const loadedMipData, const uint32_t loadedMipCount)
+		{
+			uint64_t hash = 14695981039346656037ull;
+			size_t sizeBytes = 0;
+			for (uint32_t mip = 0; mip < loadedMipCount; ++mip)
+			{
+				const size_t mipSizeBytes = static_cast<size_t>(std::max(width >> mip, 1u)) * std::max(height >> mip, 1u) *
+					LeviathanRenderer::UploadQueue::Texture2DMipsBytesPerPixel;
+				hash = HashUploadBytes(loadedMipData[mip], mipSizeBytes, hash);
+				sizeBytes += mipSizeBytes;
+			}
+			++FrameUploads;
+			FrameBytes += sizeBytes;
+			MipUpdates.push_back(MipUpdate{ .Id = id, .MipCount = mipCount, .LoadedMipCount = loadedMipCount, .Hash = hash });
+			return true;
+		}
+	};
+
+	// Number of callbacks that are missing, repeated or report a resource whose data differs from the request's.
+	static size_t CountUploadResultErrors(const UploadScene& scene, const RecordingUploadBackend& backend, const LeviathanRenderer::UploadStatus expectedStatus)
+	{
+		size_t errors = 0;
+		for (const UploadRequestRecord& request : scene.Requests)
+		{
+			if ((request.Callbacks != 1) || (request.Result.Ticket != request.Ticket) || (request.Result.Type != request.Type))
+			{
+				++errors;
+				continue;
+			}
+			if (request.Result.Status == LeviathanRenderer::UploadStatus::Created)
+			{
+				errors += ((request.Result.ResourceId >= backend.Hashes.size()) || (backend.Hashes[request.Result.ResourceId] != request.ExpectedHash)) ? 1 : 0;
+			}
+			else
+			{
+				errors += ((expectedStatus == LeviathanRenderer::UploadStatus::Created) ||
+					(request.Result.ResourceId != LeviathanRenderer::RendererResourceId::InvalidId)) ? 1 : 0;
+			}
+		}
+		return errors;
+	}
+
+	void RunUploadQueueTests(Tester& tester)
+	{
+		UploadScene scene = {};
+		MakeUploadScene(scene);
+
+		const auto resetResults = [&scene]()
+			{
+				for (UploadRequestRecord& request : scene.Requests)
+				{
+					request.Ticket = LeviathanRenderer::UploadQueue::InvalidTicket;
+					request.Callbacks = 0;
+					request.Result = {};
+				}
+				scene.CompletionOrder.clear();
+			};
+
+		// Every request enqueued before the first frame is created once with its data, in priority order and then request order, and no frame
+		// exceeds the budget unless it creates a single upload larger than the budget.
+		tester.Run("UploadQueue.Process.PriorityOrderAndBudget", [&]()
+			{
+				resetResults();
+				LeviathanRenderer::UploadQueue queue(UploadBudgetBytes);
+				for (UploadRequestRecord& request : scene.Requests)
+				{
+					request.Ticket = EnqueueUploadRequest(queue, scene, request, OnUploadCompletedInOrder, &scene);
+				}
+
+				RecordingUploadBackend backend = {};
+				size_t budgetViolations = 0;
+				size_t statsMismatches = 0;
+				size_t oversizedUploads = 0;
+				do
+				{
+					backend.FrameBytes = 0;
+					backend.FrameUploads = 0;
+					queue.Process(backend);
+					budgetViolations += ((backend.FrameBytes > UploadBudgetBytes) && (backend.FrameUploads > 1)) ? 1 : 0;
+					oversizedUploads += ((backend.FrameBytes > UploadBudgetBytes) && (backend.FrameUploads == 1)) ? 1 : 0;
+					statsMismatches += ((queue.GetStats().LastFrameBytes != backend.FrameBytes) || (queue.GetStats().LastFrameUploads != backend.FrameUploads)) ? 1 : 0;
+				} while (queue.GetStats().PendingBytes > 0);
+
+				size_t priorityInversions = 0;
+				for (size_t i = 1; i < scene.CompletionOrder.size(); ++i)
+				{
+					const auto& previous = scene.CompletionOrder[i - 1];
+					const auto& current = scene.CompletionOrder[i];
+					priorityInversions += ((previous.first < current.first) || ((previous.first == current.first) && (previous.second > current.second))) ? 1 : 0;
+				}
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountUploadResultErrors(scene, backend, LeviathanRenderer::UploadStatus::Created), 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, scene.CompletionOrder.size(), UploadRequestCount);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, budgetViolations, 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, statsMismatches, 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, priorityInversions, 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, queue.GetStats().OversizedUploads, oversizedUploads);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, queue.GetStats().Created, UploadRequestCount);
+			});
+
+		// A budget of 0 creates a single upload per frame, none of which counts as oversized.
+		tester.Run("UploadQueue.Process.ZeroBudget", [&]()
+			{
+				resetResults();
+				LeviathanRenderer::UploadQueue queue(0);
+				for (UploadRequestRecord& request : scene.Requests)
+				{
+					request.Ticket = EnqueueUploadRequest(queue, scene, request, OnUploadCompletedInOrder, &scene);
+				}
+
+				RecordingUploadBackend backend = {};
+				size_t frames = 0;
+				size_t multipleUploadFrames = 0;
+				do
+				{
+					backend.FrameUploads = 0;
+					queue.Process(backend);
+					multipleUploadFrames += (backend.FrameUploads != 1) ? 1 : 0;
+					++frames;
+				} while (queue.GetStats().PendingBytes > 0);
+
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountUploadResultErrors(scene, backend, LeviathanRenderer::UploadStatus::Created), 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, frames, UploadRequestCount);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, multipleUploadFrames, 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, queue.GetStats().OversizedUploads, 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, queue.GetStats().Created, UploadRequestCount);
+			});
+
+		// Requests staged from every job thread are each created once with their data.
+		tester.Run("UploadQueue.Enqueue.JobSystem", [&]()
+			{
+				resetResults();
+				const bool startedJobSystem = LeviathanCore::JobSystem::Initialize(JobSystemWorkerCount);
+				LeviathanRenderer::UploadQueue queue(UploadBudgetBytes);
+				LeviathanCore::JobSystem::ParallelFor(UploadRequestCount, 16, [&](const size_t first, const size_t count, size_t)
+					{
+						for (size_t i = first; i < first + count; ++i)
+						{
+							scene.Requests[i].Ticket = EnqueueUploadRequest(queue, scene, scene.Requests[i], OnUploadCompleted, &scene.Requests[i]);
+						}
+					});
+				if (startedJobSystem)
+				{
+					LeviathanCore::JobSystem::Shutdown();
+				}
+
+				RecordingUploadBackend backend = {};
+				size_t createdBytes = 0;
+				do
+				{
+					backend.FrameBytes = 0;
+					queue.Process(backend);
+					createdBytes += backend.FrameBytes;
+				} while (queue.GetStats().PendingBytes > 0);
+
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountUploadResultErrors(scene, backend, LeviathanRenderer::UploadStatus::Created), 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, createdBytes, scene.TotalBytes);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, queue.GetStats().Requests, UploadRequestCount);
+			});
+
+		// A request of higher priority made while uploads are waiting is created first in the next frame.
+		tester.Run("UploadQueue.Process.UrgentNextFrame", [&]()
+			{
+				LeviathanRenderer::UploadQueue queue(UploadBudgetBytes);
+				for (const UploadRequestRecord& request : scene.Requests)
+				{
+					EnqueueUploadRequest(queue, scene, request, nullptr, nullptr);
+				}
+				RecordingUploadBackend backend = {};
+				queue.Process(backend);
+				LEVIATHAN_TEST_CHECK(tester, queue.GetStats().PendingBytes > 0);
+
+				UploadRequestRecord urgent = scene.Requests[0];
+				urgent.Priority = UploadPriorityCount;
+				urgent.Callbacks = 0;
+				urgent.Result = {};
+				UploadScene urgentScene = {};
+				urgentScene.Requests.push_back(urgent);
+				urgentScene.Requests[0].Ticket = EnqueueUploadRequest(queue, scene, urgent, OnUploadCompletedInOrder, &urgentScene);
+				const size_t firstFrameResource = backend.Hashes.size();
+				queue.Process(backend);
+
+				const UploadRequestRecord& urgentResult = urgentScene.Requests[0];
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, urgentResult.Callbacks, 1);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, urgentResult.Result.ResourceId, firstFrameResource);
+				LEVIATHAN_TEST_CHECK(tester, (firstFrameResource < backend.Hashes.size()) && (backend.Hashes[firstFrameResource] == urgent.ExpectedHash));
+				queue.Clear();
+			});
+
+		// Cancelled uploads and uploads cleared before they are created are reported as cancelled and never created. Failed creation is reported with
+		// an invalid resource.
+		tester.Run("UploadQueue.Cancel.ReportsCancelledAndFailed", [&]()
+			{
+				resetResults();
+				LeviathanRenderer::UploadQueue queue(UploadBudgetBytes);
+				for (UploadRequestRecord& request : scene.Requests)
+				{
+					request.Ticket = EnqueueUploadRequest(queue, scene, request, OnUploadCompleted, &request);
+				}
+				// Every third upload is cancelled, half of them before the first frame and half while waiting.
+				for (size_t i = 0; i < scene.Requests.size() / 2; i += 3)
+				{
+					queue.Cancel(scene.Requests[i].Ticket);
+				}
+				RecordingUploadBackend backend = {};
+				backend.FailInterval = 7;
+				queue.Process(backend);
+				for (size_t i = scene.Requests.size() / 2; i < scene.Requests.size(); i += 3)
+				{
+					queue.Cancel(scene.Requests[i].Ticket);
+				}
+				for (size_t frame = 0; frame < 4; ++frame)
+				{
+					queue.Process(backend);
+				}
+				queue.Clear();
+
+				size_t cancelledCreated = 0;
+				for (size_t i = 0; i < scene.Requests.size(); i += 3)
+				{
+					const bool cancelledBeforeCreation = (scene.Requests[i].Result.Status == LeviathanRenderer::UploadStatus::Cancelled);
+					cancelledCreated += (cancelledBeforeCreation || (scene.Requests[i].Callbacks == 1)) ? 0 : 1;
+				}
+				const LeviathanRenderer::UploadQueueStats& stats = queue.GetStats();
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, CountUploadResultErrors(scene, backend, LeviathanRenderer::UploadStatus::Cancelled), 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, cancelledCreated, 0);
+				LEVIATHAN_TEST_CHECK(tester, stats.Cancelled > 0);
+				LEVIATHAN_TEST_CHECK(tester, stats.Failed > 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, stats.Created + stats.Failed + stats.Cancelled, stats.Requests);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, stats.Requests, UploadRequestCount);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, stats.Failed, backend.CreatedCount / backend.FailInterval);
+			});
+
+		// Mip updates of a texture, e.g. a stream in followed by a stream out, are applied once each with their mips in request order and report the
+		// updated texture. Updates with more loaded mips than mips are rejected.
+		tester.Run("UploadQueue.Texture2DMips.RequestOrder", [&]()
+			{
+				static constexpr uint32_t TextureSize = 64;
+				static constexpr uint32_t MipCount = 7;
+				static constexpr LeviathanRenderer::RendererResourceId::IdType TextureId = 7;
+				const size_t loadedSizeBytes = (TextureSize * TextureSize + (TextureSize / 2) * (TextureSize / 2)) *
+					LeviathanRenderer::UploadQueue::Texture2DMipsBytesPerPixel;
+				const uint8_t* const loadedMipData = scene.Source.data();
+
+				// A budget of 1 byte applies one update per frame.
+				LeviathanRenderer::UploadQueue queue(1);
+				UploadRequestRecord streamIn = {};
+				UploadRequestRecord streamOut = {};
+				streamIn.Ticket = queue.EnqueueTexture2DMips(TextureId, TextureSize, TextureSize, MipCount, loadedMipData, 2,
+					LeviathanRenderer::UploadDescription{ .Callback = OnUploadCompleted, .UserData = &streamIn });
+				streamOut.Ticket = queue.EnqueueTexture2DMips(TextureId, TextureSize / 4, TextureSize / 4, MipCount - 2, nullptr, 0,
+					LeviathanRenderer::UploadDescription{ .Callback = OnUploadCompleted, .UserData = &streamOut });
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, queue.EnqueueTexture2DMips(TextureId, TextureSize, TextureSize, 1, loadedMipData, 2, {}),
+					LeviathanRenderer::UploadQueue::InvalidTicket);
+
+				RecordingUploadBackend backend = {};
+				queue.Process(backend);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, backend.MipUpdates.size(), 1);
+				queue.Process(backend);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, backend.MipUpdates.size(), 2);
+				if (backend.MipUpdates.size() == 2)
+				{
+					LEVIATHAN_TEST_CHECK_EQUAL(tester, backend.MipUpdates[0].MipCount, MipCount);
+					LEVIATHAN_TEST_CHECK_EQUAL(tester, backend.MipUpdates[0].LoadedMipCount, 2);
+					LEVIATHAN_TEST_CHECK_EQUAL(tester, backend.MipUpdates[0].Hash, HashUploadBytes(loadedMipData, loadedSizeBytes));
+					LEVIATHAN_TEST_CHECK_EQUAL(tester, backend.MipUpdates[1].MipCount, MipCount - 2);
+					LEVIATHAN_TEST_CHECK_EQUAL(tester, backend.MipUpdates[1].LoadedMipCount, 0);
+				}
+				for (const UploadRequestRecord* const request : { &streamIn, &streamOut })
+				{
+					LEVIATHAN_TEST_CHECK_EQUAL(tester, request->Callbacks, 1);
+					LEVIATHAN_TEST_CHECK(tester, request->Result.Status == LeviathanRenderer::UploadStatus::Created);
+					LEVIATHAN_TEST_CHECK_EQUAL(tester, request->Result.ResourceId, TextureId);
+				}
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, queue.GetStats().CreatedBytes, loadedSizeBytes);
+			});
+
+		// Half float HDR cube faces are staged and created at 8 bytes per texel.
+		tester.Run("UploadQueue.TextureCube.HalfFloatFaces", [&]()
+			{
+				static constexpr uint32_t FaceWidth = 32;
+				const size_t faceSizeBytes = static_cast<size_t>(FaceWidth) * FaceWidth * LeviathanRenderer::UploadQueue::HalfFloatTextureCubeBytesPerPixel;
+				std::array<const void*, LeviathanRenderer::UploadQueue::TextureCubeFaceCount> faces = {};
+				uint64_t expectedHash = 14695981039346656037ull;
+				for (size_t face = 0; face < faces.size(); ++face)
+				{
+					faces[face] = scene.Source.data() + (face * faceSizeBytes);
+					expectedHash = HashUploadBytes(faces[face], faceSizeBytes, expectedHash);
+				}
+
+				LeviathanRenderer::UploadQueue queue(faceSizeBytes * faces.size());
+				UploadRequestRecord request = {};
+				request.Ticket = queue.EnqueueTextureCube(FaceWidth, faces.data(), false, true, true,
+					LeviathanRenderer::UploadDescription{ .Callback = OnUploadCompleted, .UserData = &request });
+
+				RecordingUploadBackend backend = {};
+				queue.Process(backend);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, request.Callbacks, 1);
+				LEVIATHAN_TEST_CHECK(tester, request.Result.Status == LeviathanRenderer::UploadStatus::Created);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, backend.FrameBytes, faceSizeBytes * faces.size());
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, backend.Hashes.size(), 1);
+				if (backend.Hashes.size() == 1)
+				{
+					LEVIATHAN_TEST_CHECK_EQUAL(tester, backend.Hashes[0], expectedHash);
+				}
+			});
+	}
+}
@@ -0,0 +1,192 @@
+#include "TestSuites.h"
+#include "Test.h"
+#include "UploadRing.h"
+#include "RendererConstants.h"
+
+namespace LeviathanTests
+{
+	static constexpr size_t SimulatedFrameCount = 4096;
+
+	struct UploadScenario
+	{
+		size_t CapacityBytes = 0;
+		uint32_t MinAllocationsPerFrame = 0;
+		uint32_t MaxAllocationsPerFrame = 0;
+		uint32_t MinSizeBytes = 0;
+		uint32_t MaxSizeBytes = 0;
+		// The simulated gpu completes frames up to this many frames behind the cpu, chosen at random every frame.
+		uint32_t MaxGpuLatencyFrames = 0;
+		uint32_t Seed = 0;
+	};
+
+	struct UploadStats
+	{
+		uint64_t Allocations = 0;
+		uint64_t FailedAllocations = 0;
+		uint64_t Waits = 0;
+		uint64_t Misaligned = 0;
+		uint64_t OutOfBounds = 0;
+		size_t PeakUsedBytes = 0;
+	};
+
+	// Ranges written by every frame of a simulation. A frame's ranges are checked when its fence completes so that any range handed out
+	// again while the gpu could still read it is detected.
+	struct UploadValidation
+	{
+		struct Allocation
+		{
+			size_t Offset = 0;
+			size_t SizeBytes = 0;
+			uint8_t Pattern = 0;
+		};
+
+		std::vector<std::vector<Allocation>> FrameAllocations = {};
+		uint64_t CorruptedAllocations = 0;
+
+		void Verify(const uint64_t fence, const std::vector<uint8_t>& memory)
+		{
+			for (const Allocation& allocation : FrameAllocations[fence])
+			{
+				const uint8_t* const bytes = memory.data() + allocation.Offset;
+				CorruptedAllocations += (std::all_of(bytes, bytes + allocation.SizeBytes, [&allocation](const uint8_t byte) { return byte == allocation.Pattern; })) ? 0 : 1;
+			}
+		}
+	};
+
+	// Records SimulatedFrameCount frames of constant data the way LeviathanRenderer::Render does: allocate, write, end the frame with an increasing
+	// fence value and retire frames the gpu completed. Waits for the oldest frame in flight when the ring is full.
+	static UploadStats SimulateFrames(const UploadScenario& scenario, LeviathanRenderer::UploadRing& ring, std::vector<uint8_t>& memory,
+		UploadValidation* const validation)
+	{
+		std::mt19937 random(scenario.Seed);
+		std::uniform_int_distribution<uint32_t> countDistribution(scenario.MinAllocationsPerFrame, scenario.MaxAllocationsPerFrame);
+		std::uniform_int_distribution<uint32_t> sizeDistribution(scenario.MinSizeBytes, scenario.MaxSizeBytes);
+		std::uniform_int_distribution<uint32_t> latencyDistribution(0, scenario.MaxGpuLatencyFrames);
+
+		ring.Initialize(scenario.CapacityBytes, LeviathanRenderer::RendererConstants::ConstantUploadAlignmentBytes, LeviathanRenderer::RendererConstants::MaxFramesInFlight);
+		if (validation != nullptr)
+		{
+			validation->FrameAllocations.assign(SimulatedFrameCount + 1, {});
+			validation->CorruptedAllocations = 0;
+		}
+
+		UploadStats stats = {};
+		uint64_t signalledFence = 0;
+		uint64_t completedFence = 0;
+		const auto complete = [&](const uint64_t fence)
+			{
+				while (completedFence < fence)
+				{
+					++completedFence;
+					if (validation != nullptr)
+					{
+						validation->Verify(completedFence, memory);
+					}
+				}
+				ring.Retire(completedFence);
+			};
+
+		for (size_t frame = 0; frame < SimulatedFrameCount; ++frame)
+		{
+			const uint32_t latency = latencyDistribution(random);
+			if (signalledFence > latency)
+			{
+				complete(signalledFence - latency);
+			}
+
+			if (!ring.BeginFrame())
+			{
+				++stats.Waits;
+				complete(ring.GetOldestFrameFence());
+				ring.BeginFrame();
+			}
+
+			const uint64_t fence = signalledFence + 1;
+			const uint32_t allocationCount = countDistribution(random);
+			for (uint32_t allocationIndex = 0; allocationIndex < allocationCount; ++allocationIndex)
+			{
+				const size_t sizeBytes = sizeDistribution(random);
+				size_t offset = ring.Allocate(sizeBytes);
+				while ((offset == LeviathanRenderer::UploadRing::InvalidOffset) && (ring.GetFrameInFlightCount() > 0))
+				{
+					++stats.Waits;
+					complete(ring.GetOldestFrameFence());
+					offset = ring.Allocate(sizeBytes);
+				}
+
+				++stats.Allocations;
+				if (offset == LeviathanRenderer::UploadRing::InvalidOffset)
+				{
+					++stats.FailedAllocations;
+					continue;
+				}
+
+				stats.Misaligned += ((offset % ring.GetAlignmentBytes()) != 0) ? 1 : 0;
+				if (offset + sizeBytes > memory.size())
+				{
+					++stats.OutOfBounds;
+					continue;
+				}
+
+				const uint8_t pattern = static_cast<uint8_t>(fence * 31 + allocationIndex);
+				memset(memory.data() + offset, pattern, sizeBytes);
+				if (validation != nullptr)
+				{
+					validation->FrameAllocations[fence].push_back(UploadValidation::Allocation{ offset, sizeBytes, pattern });
+				}
+			}
+
+			stats.PeakUsedBytes = std::max(stats.PeakUsedBytes, ring.GetUsedBytes());
+			ring.EndFrame(fence);
+			signalledFence = fence;
+		}
+
+		complete(signalledFence);
+		return stats;
+	}
+
+	static void RunUploadScenarioTests(Tester& tester, const std::string_view scenarioName, const UploadScenario& scenario)
+	{
+		tester.Run("UploadRing.Frames." + std::string(scenarioName), [&]()
+			{
+				LeviathanRenderer::UploadRing ring = {};
+				std::vector<uint8_t> memory(scenario.CapacityBytes, 0);
+
+				// Every frame's data must be intact when its fence completes.
+				UploadValidation validation = {};
+				const UploadStats stats = SimulateFrames(scenario, ring, memory, &validation);
+				LEVIATHAN_TEST_CHECK(tester, stats.Allocations > 0);
+				LEVIATHAN_TEST_CHECK(tester, ring.GetWrapCount() > 0);
+				LEVIATHAN_TEST_CHECK_LESS_OR_EQUAL(tester, stats.PeakUsedBytes, scenario.CapacityBytes);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, stats.FailedAllocations, 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, stats.Misaligned, 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, stats.OutOfBounds, 0);
+				LEVIATHAN_TEST_CHECK_EQUAL(tester, validation.CorruptedAllocations, 0);
+			});
+	}
+
+	void RunUploadRingTests(Tester& tester)
+	{
+		// Light and skybox constants of a frame with 2 directional, 16 point and 16 spot lights in the renderer's upload buffer.
+		UploadScenario lightConstants = {};
+		lightConstants.CapacityBytes = LeviathanRenderer::RendererConstants::ConstantUploadBufferSizeBytes;
+		lightConstants.MinAllocationsPerFrame = 35;
+		lightConstants.MaxAllocationsPerFrame = 35;
+		lightConstants.MinSizeBytes = 32;
+		lightConstants.MaxSizeBytes = 128;
+		lightConstants.MaxGpuLatencyFrames = 2;
+		lightConstants.Seed = 1357;
+		RunUploadScenarioTests(tester, "LightConstants", lightConstants);
+
+		// Random sizes in a small buffer with a gpu that can fall further behind than the frames in flight, forcing frequent wraps and waits.
+		UploadScenario randomSizes = {};
+		randomSizes.CapacityBytes = 64 * 1024;
+		randomSizes.MinAllocationsPerFrame = 1;
+		randomSizes.MaxAllocationsPerFrame = 16;
+		randomSizes.MinSizeBytes = 1;
+		randomSizes.MaxSizeBytes = 2048;
+		randomSizes.MaxGpuLatencyFrames = 4;
+		randomSizes.Seed = 2468;
+		RunUploadScenarioTests(tester, "RandomSizes", randomSizes);
+	}
+}
@@ -0,0 +1,94 @@
+#include "TestSuites.h"
+#include "Test.h"
+#include "TestFixtures.h"
+#include "MathTypes.h"
+#include "BoundingVolumes.h"
+#include "VisibilityCulling.h"
+
+namespace LeviathanTests
+{
+	// Below and above the culling stage chunk size so that both the calling thread and the parallel paths are covered.
+	static constexpr std::array<size_t, 2> RenderableCounts = { 1000, 50000 };
+	static constexpr size_t JobSystemWorkerCount = 3;
+	static constexpr float SceneHalfSize = 1000.0f;
+	static constexpr float FarPlane = 800.0f;
+
+	// Returns the number of renderables whose visibility differs from the scalar test plus the number of visible indices out of ascending order.
+	template <typename ScalarTest>
+	static size_t CountVisibilityMismatches(const LeviathanRenderer::FrustumCullingStage& stage, const size_t renderableCount, ScalarTest&& scalarTest)
+	{
+		std::vector<uint8_t> visible(renderableCount, 0);
+		for (size_t i = 0; i < stage.GetVisibleCount(); ++i)
+		{
+			visible[stage.GetVisibleIndices()[i]] = 1;
+		}
+
+		size_t mismatches = 0;
+		for (size_t i = 0; i < renderableCount; ++i)
+		{
+			mismatches += ((visible[i] != 0) != scalarTest(i)) ? 1 : 0;
+		}
+
+		for (size_t i = 1; i < stage.GetVisibleCount(); ++i)
+		{
+			mismatches += (stage.GetVisibleIndices()[i - 1] >= stage.GetVisibleIndices()[i]) ? 1 : 0;
+		}
+		return mismatches;
+	}
+
+	static void RunFrustumCullingTests(Tester& tester, const std::string_view threadingName, const LeviathanCore::BoundingVolumes::Frustum& frustum,
+		const std::vector<LeviathanCore::BoundingVolumes::AABBArray>& aabbSets, const std::vector<LeviathanCore::BoundingVolumes::SphereArray>& sphereSets)
+	{
+		for (size_t set = 0; set < RenderableCounts.size(); ++set)
+		{
+			const std::string suffix = std::to_string(RenderableCounts[set]) + "." + std::string(threadingName);
+
+			tester.Run("Visibility.FrustumCull.AABB." + suffix, [&]()
+				{
+					LeviathanRenderer::FrustumCullingStage stage = {};
+					// Culling twice checks that retained scratch memory does not leak results between calls.
+					stage.Cull(frustum, aabbSets[set].View());
+					stage.Cull(frustum, aabbSets[set].View());
+					LEVIATHAN_TEST_CHECK(tester, stage.GetVisibleCount() > 0);
+					LEVIATHAN_TEST_CHECK_EQUAL(tester, CountVisibilityMismatches(stage, RenderableCounts[set],
+						[&](const size_t i) { return frustum.Intersects(aabbSets[set].Get(i)); }), 0);
+				});
+
+			tester.Run("Visibility.FrustumCull.Sphere." + suffix, [&]()
+				{
+					LeviathanRenderer::FrustumCullingStage stage = {};
+					stage.Cull(frustum, sphereSets[set].View());
+					LEVIATHAN_TEST_CHECK(tester, stage.GetVisibleCount() > 0);
+					LEVIATHAN_TEST_CHECK_EQUAL(tester, CountVisibilityMismatches(stage, RenderableCounts[set],
+						[&](const size_t i) { return frustum.Intersects(sphereSets[set].Get(i)); }), 0);
+				});
+		}
+	}
+
+	void RunVisibilityTests(Tester& tester)
+	{
+		std::mt19937 random(1234);
+		std::uniform_real_distribution<float> positionDistribution(-SceneHalfSize, SceneHalfSize);
+		std::uniform_real_distribution<float> sizeDistribution(0.25f, 4.0f);
+
+		std::vector<LeviathanCore::BoundingVolumes::AABBArray> aabbSets(RenderableCounts.size());
+		std::vector<LeviathanCore::BoundingVolumes::SphereArray> sphereSets(RenderableCounts.size());
+		for (size_t set = 0; set < RenderableCounts.size(); ++set)
+		{
+			for (size_t i = 0; i < RenderableCounts[set]; ++i)
+			{
+				const LeviathanCore::MathTypes::Vector3 center(positionDistribution(random), positionDistribution(random), positionDistribution(random));
+				const LeviathanCore::MathTypes::Vector3 halfExtents(sizeDistribution(random), sizeDistribution(random), sizeDistribution(random));
+				aabbSets[set].Add(LeviathanCore::BoundingVolumes::AABB{ center - halfExtents, center + halfExtents });
+				sphereSets[set].Add(LeviathanCore::BoundingVolumes::Sphere{ center, halfExtents.Length() });
+			}
+		}
+
+		const LeviathanCore::BoundingVolumes::Frustum frustum = LeviathanTestFixtures::MakeFrustum(FarPlane);
+
+		LeviathanTestFixtures::RunSingleThreadAndJobSystem(JobSystemWorkerCount, [&](const std::string_view threadingName)
+			{
+				RunFrustumCullingTests(tester, threadingName, frustum, aabbSets, sphereSets);
+			});
+	}
+}